@@ -175,7 +175,8 @@ void app_init(void)
     };
     router_init(&router_cfg);
 
-    // Add default route: BLE Central → USB Device
+    // Add default routes: BT Classic / BLE Central → USB Device
+    router_add_route(INPUT_SOURCE_BT, OUTPUT_TARGET_USB_DEVICE, 0);
     router_add_route(INPUT_SOURCE_BLE_CENTRAL, OUTPUT_TARGET_USB_DEVICE, 0);
 
     // Configure player management
@@ -180,9 +180,10 @@ static void on_code_detected(const char* code_name)
 // Router tap callback - sends local inputs to linked controller via UART
 // Filters out UART-received inputs (dev_addr >= 0xD0) to prevent loops
 static void uart_link_tap(output_target_t output, uint8_t player_index,
-                          const input_event_t* event)
+                          const input_state_t* event, const input_ext_t* ext)
 {
     (void)output;
+    (void)ext;
 
     if (!uart_link_enabled) return;
 
@@ -285,6 +286,12 @@ void app_init(void)
         uart_device_init_pins(PAD_CONFIG.qwiic_tx, PAD_CONFIG.qwiic_rx, UART_PROTOCOL_BAUD_DEFAULT);
         uart_device_set_mode(UART_DEVICE_MODE_ON_CHANGE);
 
+        // The host reads every byte on the shared port: route frame acks out
+        // through the device, and VERSION/acks from the peer into it
+        uart_device_set_rx_enabled(false);
+        uart_host_set_send_callback(uart_device_send_packet);
+        uart_host_set_link_callback(uart_device_handle_link_packet);
+
         uart_link_enabled = true;
         printf("[app:controller] UART link enabled on QWIIC (TX=%d, RX=%d)\n",
                PAD_CONFIG.qwiic_tx, PAD_CONFIG.qwiic_rx);
@@ -423,7 +430,7 @@ void app_task(void)
 
     // Get current button state from router output
     uint32_t buttons = 0xFFFFFFFF;  // All released (active-low)
-    const input_event_t* event = router_get_output(OUTPUT_TARGET_USB_DEVICE, 0);
+    const input_state_t* event = router_get_output(OUTPUT_TARGET_USB_DEVICE, 0);
     if (event) {
         buttons = event->buttons;
     }
@@ -54,8 +54,8 @@ static const profile_t gc_profile_default = {
     .r2_threshold = 250,
     .l2_analog_value = 0,
     .r2_analog_value = 0,
-    .left_stick_sensitivity = 1.0f,
-    .right_stick_sensitivity = 1.0f,
+    .left_stick_sensitivity = ANALOG_SCALE(1.0f),
+    .right_stick_sensitivity = ANALOG_SCALE(1.0f),
     .left_stick_modifiers = NULL,
     .left_stick_modifier_count = 0,
     .right_stick_modifiers = NULL,
@@ -95,8 +95,8 @@ static const profile_t gc_profile_snes = {
     .r2_threshold = 250,
     .l2_analog_value = 0,
     .r2_analog_value = 0,
-    .left_stick_sensitivity = 1.0f,
-    .right_stick_sensitivity = 1.0f,
+    .left_stick_sensitivity = ANALOG_SCALE(1.0f),
+    .right_stick_sensitivity = ANALOG_SCALE(1.0f),
     .left_stick_modifiers = NULL,
     .left_stick_modifier_count = 0,
     .right_stick_modifiers = NULL,
@@ -144,8 +144,8 @@ static const profile_t gc_profile_ssbm = {
     .r2_threshold = 140,
     .l2_analog_value = 43,                // ~17% light shield
     .r2_analog_value = 0,
-    .left_stick_sensitivity = 0.85f,      // 85% for Melee precision
-    .right_stick_sensitivity = 1.0f,
+    .left_stick_sensitivity = ANALOG_SCALE(0.85f),  // 85% for Melee precision
+    .right_stick_sensitivity = ANALOG_SCALE(1.0f),
     .left_stick_modifiers = gc_ssbm_left_modifiers,
     .left_stick_modifier_count = sizeof(gc_ssbm_left_modifiers) / sizeof(gc_ssbm_left_modifiers[0]),
     .right_stick_modifiers = NULL,
@@ -187,8 +187,8 @@ static const profile_t gc_profile_mkwii = {
     .r2_threshold = 10,                   // Instant trigger
     .l2_analog_value = 0,
     .r2_analog_value = 0,
-    .left_stick_sensitivity = 1.0f,
-    .right_stick_sensitivity = 1.0f,
+    .left_stick_sensitivity = ANALOG_SCALE(1.0f),
+    .right_stick_sensitivity = ANALOG_SCALE(1.0f),
     .left_stick_modifiers = NULL,
     .left_stick_modifier_count = 0,
     .right_stick_modifiers = NULL,
@@ -230,8 +230,8 @@ static const profile_t gc_profile_fighting = {
     .r2_threshold = 250,
     .l2_analog_value = 0,
     .r2_analog_value = 0,
-    .left_stick_sensitivity = 1.0f,
-    .right_stick_sensitivity = 0.0f,      // Disabled
+    .left_stick_sensitivity = ANALOG_SCALE(1.0f),
+    .right_stick_sensitivity = ANALOG_SCALE(0.0f),  // Disabled
     .left_stick_modifiers = NULL,
     .left_stick_modifier_count = 0,
     .right_stick_modifiers = NULL,
@@ -54,8 +54,8 @@ static const profile_t loopy_profile_default = {
     .r2_threshold = 128,
     .l2_analog_value = 0,
     .r2_analog_value = 0,
-    .left_stick_sensitivity = 1.0f,
-    .right_stick_sensitivity = 1.0f,
+    .left_stick_sensitivity = ANALOG_SCALE(1.0f),
+    .right_stick_sensitivity = ANALOG_SCALE(1.0f),
     .adaptive_triggers = false,
 };
 
@@ -149,9 +149,10 @@ static void uart_led_handler(uint8_t player_index, uint8_t pattern,
 
 // Called by router when input events occur
 static void uart_router_tap(output_target_t output, uint8_t player_index,
-                            const input_event_t* event)
+                            const input_state_t* event, const input_ext_t* ext)
 {
     (void)output;
+    (void)ext;
 
     // Queue input for UART transmission
     uart_device_queue_input(event, player_index);
@@ -0,0 +1,76 @@
+// bench_util.h - Shared helpers for host benchmarks
+//
+// Timing (wall clock + TSC), stdout silencing while core code logs, and
+// percentile support. Header-only; each benchmark is a single binary.
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t now_cycles(void)
+{
+#ifdef BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Router/profile code logs via printf; silence it while measuring
+static int bench_saved_stdout = -1;
+
+static void quiet_begin(void)
+{
+    fflush(stdout);
+    bench_saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (devnull >= 0) {
+        dup2(devnull, STDOUT_FILENO);
+        close(devnull);
+    }
+}
+
+static void quiet_end(void)
+{
+    fflush(stdout);
+    if (bench_saved_stdout >= 0) {
+        dup2(bench_saved_stdout, STDOUT_FILENO);
+        close(bench_saved_stdout);
+        bench_saved_stdout = -1;
+    }
+}
+
+static int compare_u32(const void* a, const void* b)
+{
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Percentile of a sorted sample array
+static inline uint32_t percentile_u32(const uint32_t* sorted, uint32_t count, uint32_t pct)
+{
+    if (count == 0) return 0;
+    uint64_t idx = (uint64_t)count * pct / 100;
+    if (idx >= count) idx = count - 1;
+    return sorted[idx];
+}
+
+#endif // BENCH_UTIL_H
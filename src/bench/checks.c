@@ -0,0 +1,99 @@
+// checks.c - Host behaviour checks for the pipeline modules
+//
+// Runs every area in checks/ (or the ones named on the command line) and
+// exits non-zero if any check failed.
+//
+// Usage: checks [area...]
+
+#include <stdio.h>
+#include <string.h>
+
+#include "checks/checks.h"
+
+typedef struct {
+    const char* name;
+    void (*run)(void);
+} check_area_t;
+
+static const check_area_t areas[] = {
+    { "profile",         checks_profile },
+    { "analog",          checks_analog },
+    { "hid",             checks_hid },
+    { "uart",            checks_uart },
+    { "uart_host",       checks_uart_host },
+    { "crc",             checks_crc },
+    { "usbd_multi",      checks_usbd_multi },
+    { "report_cache",    checks_report_cache },
+    { "usbd_poll",       checks_usbd_poll },
+    { "flash_log",       checks_flash_log },
+    { "settings",        checks_settings },
+    { "flash_window",    checks_flash_window },
+    { "tdo_chain",       checks_tdo_chain },
+    { "snes_frame",      checks_snes_frame },
+    { "hci_rx_queue",    checks_hci_rx_queue },
+    { "bthid_index",     checks_bthid_index },
+    { "ble_conn_params", checks_ble_conn_params },
+};
+
+#define AREA_COUNT (sizeof(areas) / sizeof(areas[0]))
+
+static uint32_t checks_run;
+static uint32_t checks_failed;
+static uint32_t rng_state;
+
+void check_section(const char* title)
+{
+    printf("  %s\n", title);
+}
+
+void check(const char* what, uint32_t bad, uint32_t total)
+{
+    printf("    %-52s %8u / %-8u %s\n", what, bad, total, bad ? "FAIL" : "ok");
+    checks_run++;
+    if (bad) checks_failed++;
+}
+
+void check_value(const char* what, double value, const char* unit)
+{
+    printf("    %-52s %8.2f %s\n", what, value, unit);
+}
+
+uint32_t check_rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static bool selected(const char* name, int argc, char** argv)
+{
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    for (size_t i = 0; i < AREA_COUNT; i++) {
+        if (!selected(areas[i].name, argc, argv)) continue;
+
+        printf("%s\n", areas[i].name);
+        rng_state = 0x9E3779B9u;
+        areas[i].run();
+        printf("\n");
+    }
+
+    if (checks_run == 0) {
+        printf("No such area\n");
+        return 1;
+    }
+    if (checks_failed) {
+        printf("FAIL: %u of %u checks failed\n", checks_failed, checks_run);
+        return 1;
+    }
+    printf("All %u checks passed\n", checks_run);
+    return 0;
+}
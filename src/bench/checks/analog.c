@@ -0,0 +1,143 @@
+// analog.c - Fixed-point analog helpers vs the float code they replaced
+//
+// Checks core/analog.h bit-for-bit against the original float expressions
+// (profile stick sensitivity, GameCube keyboard scaling, DS5 trigger
+// resistance, keyboard stick offset, deadzones) over every input value.
+
+#include <stdio.h>
+
+#include "core/analog.h"
+#include "checks.h"
+
+// Sensitivities used by shipped profiles and output devices
+static const float tree_scales[] = { 0.0f, 0.5f, 0.61f, 0.85f, 1.0f };
+
+#define TREE_SCALE_COUNT (sizeof(tree_scales) / sizeof(tree_scales[0]))
+
+// Still a constant expression (profile tables are static initializers)
+static const analog_scale_t scale_limit = ANALOG_SCALE(2.0);
+
+// ============================================================================
+// FLOAT REFERENCES (as previously written in the tree)
+// ============================================================================
+
+// profile_apply() stick sensitivity
+static uint8_t ref_profile_scale(uint8_t value, float sens)
+{
+    int16_t rel = (int16_t)value - 128;
+    return (uint8_t)(128 + (int16_t)(rel * sens));
+}
+
+// gamecube_device.c scale_toward_center()
+static uint8_t ref_scale_toward_center(uint8_t val, float scale, uint8_t center)
+{
+    int16_t rel = (int16_t)val - (int16_t)center;
+    int16_t scaled = (int16_t)(rel * scale);
+    int16_t result = scaled + (int16_t)center;
+    if (result < 0) result = 0;
+    if (result > 255) result = 255;
+    return (uint8_t)result;
+}
+
+// pad_input.c apply_deadzone()
+static uint8_t ref_pad_deadzone(uint8_t value, uint8_t deadzone)
+{
+    int16_t centered = (int16_t)value - 128;
+    if (centered > -deadzone && centered < deadzone) return 128;
+    return value;
+}
+
+// sony_ds4.c inline deadzone
+static uint8_t ref_ds4_deadzone(uint8_t value, uint8_t deadzone)
+{
+    if (value > (128 - (deadzone / 2)) && value < (128 + (deadzone / 2))) return 128;
+    return value;
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+static void check_scales(void)
+{
+    for (size_t i = 0; i < TREE_SCALE_COUNT; i++) {
+        float f = tree_scales[i];
+        analog_scale_t q = ANALOG_SCALE(f);
+        uint32_t stick = 0, center = 0;
+
+        for (int v = 0; v < 256; v++) {
+            if (analog_scale_stick((uint8_t)v, q) != ref_profile_scale((uint8_t)v, f)) stick++;
+            for (int c = 0; c < 256; c += 17) {
+                if (analog_scale_center((uint8_t)v, q, (uint8_t)c) !=
+                    ref_scale_toward_center((uint8_t)v, f, (uint8_t)c)) center++;
+            }
+        }
+
+        char label[64];
+        snprintf(label, sizeof(label), "stick scale %.2f (Q1.15 %u)", f, q);
+        check(label, stick, 256);
+        snprintf(label, sizeof(label), "scale toward center %.2f", f);
+        check(label, center, 256 * 16);
+    }
+
+    // Arbitrary sensitivities may differ by 1 LSB where the float product
+    // itself rounds across an integer, never by more
+    uint32_t over = 0;
+    for (int k = 0; k <= 100; k++) {
+        float f = k / 100.0f;
+        analog_scale_t q = ANALOG_SCALE(f);
+        for (int v = 0; v < 256; v++) {
+            int d = (int)analog_scale_stick((uint8_t)v, q) - (int)ref_profile_scale((uint8_t)v, f);
+            if (d > 1 || d < -1) over++;
+        }
+    }
+    check("stick scale 0.00-1.00 grid beyond 1 LSB", over, 101 * 256);
+
+    // Q1.15 tops out just under 2.0; anything at or above saturates
+    static const float limits[] = { 1.5f, 1.99990f, 1.99998f, 2.0f, 3.0f };
+    static const analog_scale_t expect[] = { 49152, 65533, ANALOG_SCALE_MAX, ANALOG_SCALE_MAX, ANALOG_SCALE_MAX };
+    uint32_t wrapped = scale_limit != ANALOG_SCALE_MAX;
+    for (size_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+        if (ANALOG_SCALE(limits[i]) != expect[i]) wrapped++;
+    }
+    check("scales near and above 2.0 saturate", wrapped, 6);
+}
+
+static void check_drivers(void)
+{
+    uint32_t ds5 = 0, kb = 0, pad = 0, ds4 = 0;
+
+    // sony_ds5.c trigger resistance
+    for (int v = 0; v < 256; v++) {
+        uint8_t ref_start = (uint8_t)(0x94 * (v / 255.0));
+        uint8_t ref_force = (uint8_t)((0xb4 - ref_start) * (v / 255.0) + ref_start);
+        uint8_t start = analog_scale_by_u8(0x94, (uint8_t)v);
+        uint8_t force = analog_scale_by_u8(0xb4 - start, (uint8_t)v) + start;
+        if (start != ref_start || force != ref_force) ds5++;
+    }
+    check("ds5 trigger resistance", ds5, 256);
+
+    // hid_keyboard.c calculate_coordinates() offset
+    for (int intensity = 0; intensity <= 128; intensity++) {
+        uint8_t ref = (uint8_t)(int)(127.0 - ((intensity / 100.0) * 127.0));
+        uint8_t fixed = (uint8_t)((127 * (100 - intensity)) / 100);
+        if (ref != fixed) kb++;
+    }
+    check("keyboard stick offset", kb, 129);
+
+    for (int dz = 0; dz < 128; dz++) {
+        for (int v = 0; v < 256; v++) {
+            if (analog_deadzone((uint8_t)v, (uint8_t)dz) != ref_pad_deadzone((uint8_t)v, (uint8_t)dz)) pad++;
+            if (analog_deadzone((uint8_t)v, (uint8_t)(dz * 2) / 2) !=
+                ref_ds4_deadzone((uint8_t)v, (uint8_t)(dz * 2))) ds4++;
+        }
+    }
+    check("pad deadzone", pad, 128 * 256);
+    check("ds4 deadzone", ds4, 128 * 256);
+}
+
+void checks_analog(void)
+{
+    check_scales();
+    check_drivers();
+}
@@ -0,0 +1,277 @@
+// ble_conn_params.c - BLE connection parameter policy and report timing
+//
+// Checks bt/btstack/ble_conn_params.c:
+//   - sanitizing random parameters always lands inside the spec limits with a
+//     supervision timeout longer than (1 + latency) * interval_max * 2, keeps
+//     valid parameters as they are, and is idempotent
+//   - drivers without their own parameters ask for 7.5 ms with no latency,
+//     and a driver's own parameters are used (sanitized)
+//   - report timing over simulated links (jitter, several reports per
+//     connection event, idle gaps, timer wrap) matches a reference: min/max
+//     over the counted gaps, a moving average near the link's true interval,
+//     and exactly one log flag at BLE_REPORT_LOG_AFTER
+//
+// Then models what the interval and latency cost: an input change waits for
+// the next connection event, and a rumble write waits for the next event an
+// idle controller listens to (it may skip `latency` events). Prints mean and
+// p99 delays for the policy against BTstack's default connection setup.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bt/btstack/ble_conn_params.h"
+#include "checks.h"
+#include "../bench_util.h"
+
+#define RANDOM_PARAMS       200000u
+#define TIMING_LINKS        2000u
+#define MODEL_SAMPLES       200000u
+
+// Sink so the compiler can't drop results
+static volatile uint32_t bench_sink;
+
+static bool params_valid(const ble_conn_params_t* p)
+{
+    if (p->interval_min < BLE_CONN_INTERVAL_MIN || p->interval_min > BLE_CONN_INTERVAL_MAX) return false;
+    if (p->interval_max < p->interval_min || p->interval_max > BLE_CONN_INTERVAL_MAX) return false;
+    if (p->latency > BLE_CONN_LATENCY_MAX) return false;
+    if (p->supervision_timeout < BLE_CONN_TIMEOUT_MIN ||
+        p->supervision_timeout > BLE_CONN_TIMEOUT_MAX) return false;
+    // timeout * 10 ms > (1 + latency) * interval_max * 1.25 ms * 2
+    return (uint32_t)p->supervision_timeout * 4u > (1u + p->latency) * p->interval_max;
+}
+
+// ============================================================================
+// PARAMETER CHECKS
+// ============================================================================
+
+static void check_params(void)
+{
+    uint32_t invalid = 0, changed = 0, unstable = 0, valid_inputs = 0;
+
+    for (uint32_t i = 0; i < RANDOM_PARAMS; i++) {
+        ble_conn_params_t p;
+        // Mix of anything-goes and near-the-limits values
+        if (check_rng() & 1) {
+            p.interval_min = (uint16_t)check_rng();
+            p.interval_max = (uint16_t)check_rng();
+            p.latency = (uint16_t)check_rng();
+            p.supervision_timeout = (uint16_t)check_rng();
+        } else {
+            p.interval_min = (uint16_t)(check_rng() % 64);
+            p.interval_max = (uint16_t)(p.interval_min + check_rng() % 64);
+            p.latency = (uint16_t)(check_rng() % 16);
+            p.supervision_timeout = (uint16_t)(check_rng() % 400);
+        }
+
+        ble_conn_params_t s = p;
+        ble_conn_params_sanitize(&s);
+        if (!params_valid(&s)) invalid++;
+        if (params_valid(&p)) {
+            valid_inputs++;
+            if (memcmp(&s, &p, sizeof(p)) != 0) changed++;
+        }
+
+        ble_conn_params_t again = s;
+        ble_conn_params_sanitize(&again);
+        if (memcmp(&again, &s, sizeof(s)) != 0) unstable++;
+    }
+
+    uint32_t scan_bad = 0;
+    for (uint32_t i = 0; i < RANDOM_PARAMS; i++) {
+        uint16_t interval = (uint16_t)check_rng();
+        uint16_t window = (uint16_t)check_rng();
+        ble_scan_params_sanitize(&interval, &window);
+        if (interval < BLE_SCAN_INTERVAL_MIN || interval > BLE_SCAN_INTERVAL_MAX ||
+            window < BLE_SCAN_INTERVAL_MIN || window > interval) {
+            scan_bad++;
+        }
+    }
+
+    uint32_t driver_bad = 0;
+    ble_conn_params_t def = ble_conn_params_for(NULL);
+    if (!params_valid(&def)) driver_bad++;
+    if (def.interval_min != 0x0006 || def.interval_max != 0x0006 || def.latency != 0) driver_bad++;
+
+    static const ble_conn_params_t own = { 0x0008, 0x000C, 2, 0x00C8 };     // 10-15 ms, 2 s
+    ble_conn_params_t p = ble_conn_params_for(&own);
+    if (memcmp(&p, &own, sizeof(p)) != 0) driver_bad++;
+
+    static const ble_conn_params_t broken = { 0x0001, 0x0000, 600, 0 };
+    p = ble_conn_params_for(&broken);
+    if (!params_valid(&p)) driver_bad++;
+
+    uint32_t sat_bad = 0;
+    ble_conn_params_t want = { 6, 9, 0, 100 };
+    if (!ble_conn_params_satisfied(&want, 6, 0)) sat_bad++;
+    if (!ble_conn_params_satisfied(&want, 9, 0)) sat_bad++;
+    if (ble_conn_params_satisfied(&want, 12, 0)) sat_bad++;
+    if (ble_conn_params_satisfied(&want, 6, 4)) sat_bad++;
+
+    check_section("connection parameters");
+    check("sanitized sets outside spec limits", invalid, RANDOM_PARAMS);
+    check("valid sets changed by sanitize", changed, valid_inputs);
+    check("sets changed by a second sanitize", unstable, RANDOM_PARAMS);
+    check("scan interval/window outside limits", scan_bad, RANDOM_PARAMS);
+    check("driver parameter errors", driver_bad, 4);
+    check("satisfied() errors", sat_bad, 4);
+}
+
+// ============================================================================
+// REPORT TIMING CHECKS
+// ============================================================================
+
+static void check_timing(void)
+{
+    uint32_t minmax_bad = 0, avg_bad = 0, log_bad = 0;
+
+    for (uint32_t l = 0; l < TIMING_LINKS; l++) {
+        // 7.5 to 30 ms link, up to 1 ms jitter, sometimes two reports per event
+        uint32_t interval_us = 7500u + 1250u * (check_rng() % 19);
+        uint32_t jitter_us = check_rng() % 1000;
+        bool bursts = (check_rng() % 4) == 0;
+        uint32_t now = (l & 1) ? 0xFFFFFFFFu - 50u * interval_us : check_rng();
+        uint32_t n = 200 + check_rng() % (2 * BLE_REPORT_LOG_AFTER);
+
+        ble_report_timing_t t;
+        ble_report_timing_reset(&t);
+        uint32_t ref_min = UINT32_MAX, ref_max = 0, ref_gaps = 0, logs = 0;
+        uint32_t last = 0;
+
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t gap;
+            if (check_rng() % 50 == 0) {
+                gap = BLE_REPORT_GAP_MAX_US + check_rng() % 500000;   // Idle, no input change
+            } else if (bursts && (check_rng() & 1)) {
+                gap = 100 + check_rng() % 200;                        // Second report in the event
+            } else {
+                gap = interval_us - jitter_us / 2 + (jitter_us ? check_rng() % jitter_us : 0);
+            }
+            now += gap;
+            if (ble_report_timing_add(&t, now)) logs++;
+            if (i > 0) {
+                uint32_t d = now - last;
+                if (d < BLE_REPORT_GAP_MAX_US) {
+                    ref_gaps++;
+                    if (d < ref_min) ref_min = d;
+                    if (d > ref_max) ref_max = d;
+                }
+            }
+            last = now;
+        }
+
+        if (t.reports != n || t.gaps != ref_gaps) minmax_bad++;
+        if (ref_gaps && (t.min_us != ref_min || t.max_us != ref_max)) minmax_bad++;
+        if (logs != (n >= BLE_REPORT_LOG_AFTER ? 1u : 0u)) log_bad++;
+
+        // Without bursts the average tracks the interval; bursts pull it
+        // down to about half, never below the shortest gap
+        if (!bursts) {
+            uint32_t tol = interval_us / 20 + jitter_us;
+            if (t.avg_us + tol < interval_us || t.avg_us > interval_us + tol) avg_bad++;
+        } else if (t.avg_us < ref_min || t.avg_us > ref_max) {
+            avg_bad++;
+        }
+    }
+
+    check_section("report timing");
+    check("count/min/max differing from reference", minmax_bad, TIMING_LINKS);
+    check("average off the link interval", avg_bad, TIMING_LINKS);
+    check("log flag not raised exactly once", log_bad, TIMING_LINKS);
+}
+
+// ============================================================================
+// LATENCY MODEL
+// ============================================================================
+
+typedef struct {
+    const char* name;
+    uint16_t interval;      // 1.25 ms units
+    uint16_t latency;
+} link_model_t;
+
+typedef struct {
+    double input_mean_us;
+    uint32_t input_p99_us;
+    double rumble_mean_us;
+    uint32_t rumble_p99_us;
+} link_delay_t;
+
+// Input: a change at a random time goes out at the next connection event.
+// Rumble: an idle controller only listens every (1 + latency) events.
+static link_delay_t model_link(const link_model_t* m)
+{
+    uint32_t interval_us = ble_conn_interval_us(m->interval);
+    uint32_t listen_us = interval_us * (1u + m->latency);
+    uint32_t* input = malloc(sizeof(uint32_t) * MODEL_SAMPLES);
+    uint32_t* rumble = malloc(sizeof(uint32_t) * MODEL_SAMPLES);
+    double in_sum = 0, ru_sum = 0;
+
+    for (uint32_t i = 0; i < MODEL_SAMPLES; i++) {
+        uint32_t phase = check_rng() % listen_us;
+        input[i] = interval_us - phase % interval_us;
+        rumble[i] = listen_us - phase;
+        in_sum += input[i];
+        ru_sum += rumble[i];
+    }
+
+    link_delay_t d;
+    d.input_mean_us = in_sum / MODEL_SAMPLES;
+    d.rumble_mean_us = ru_sum / MODEL_SAMPLES;
+    qsort(input, MODEL_SAMPLES, sizeof(uint32_t), compare_u32);
+    qsort(rumble, MODEL_SAMPLES, sizeof(uint32_t), compare_u32);
+    d.input_p99_us = percentile_u32(input, MODEL_SAMPLES, 99);
+    d.rumble_p99_us = percentile_u32(rumble, MODEL_SAMPLES, 99);
+    free(input);
+    free(rumble);
+    return d;
+}
+
+static void model_delays(void)
+{
+    ble_conn_params_t policy = ble_conn_params_for(NULL);
+    const link_model_t links[] = {
+        { "policy",                     policy.interval_max, policy.latency },
+        { "BTstack min (10 ms, lat 4)", 0x0008, 4 },
+        { "BTstack max (30 ms, lat 4)", 0x0018, 4 },
+    };
+
+    // One connection event per interval; the dongle and main loop add on top
+    check_section("input and rumble delay model");
+    link_delay_t first = { 0 };
+    for (size_t i = 0; i < sizeof(links) / sizeof(links[0]); i++) {
+        link_delay_t d = model_link(&links[i]);
+        if (i == 0) first = d;
+
+        char label[64];
+        snprintf(label, sizeof(label), "%s input mean / p99", links[i].name);
+        printf("    %-52s %8.0f / %-8u us\n", label, d.input_mean_us, d.input_p99_us);
+        snprintf(label, sizeof(label), "%s rumble mean / p99", links[i].name);
+        printf("    %-52s %8.0f / %-8u us\n", label, d.rumble_mean_us, d.rumble_p99_us);
+    }
+
+    // Cost of tracking on the report path
+    ble_report_timing_t t;
+    ble_report_timing_reset(&t);
+    uint32_t now = 0;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < MODEL_SAMPLES; i++) {
+        now += 7000u + (check_rng() & 1023);
+        bench_sink += ble_report_timing_add(&t, now);
+    }
+    uint64_t t1 = now_ns();
+    check_value("report timing cost", (double)(t1 - t0) / MODEL_SAMPLES, "ns/report");
+
+    uint32_t model_bad = 0;
+    if (first.input_p99_us > ble_conn_interval_us(policy.interval_max)) model_bad++;
+    if (first.rumble_p99_us > ble_conn_interval_us(policy.interval_max) * (1u + policy.latency)) model_bad++;
+    check("policy delays beyond one connection event", model_bad, 2);
+}
+
+void checks_ble_conn_params(void)
+{
+    check_params();
+    check_timing();
+    model_delays();
+}
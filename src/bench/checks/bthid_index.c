@@ -0,0 +1,241 @@
+// bthid_index.c - Bluetooth HID driver VID/PID index
+//
+// Builds random driver registries (overlapping vendors, shared pairs,
+// vendor wildcards) into bt/bthid/bthid_index.c and checks that every
+// lookup returns what a linear scan of the drivers' ID lists in
+// registration order does: the first driver claiming the exact VID/PID,
+// else the first claiming the vendor with BTHID_PID_ANY, else none.
+// Also checks that a full index refuses pairs but still answers, and that
+// vendor ID 0 (no SDP Device ID) never matches.
+//
+// Then times lookups against the linear scan for the registry bthid_registry.c
+// builds today (ID lists copied from the drivers) and for one filling half
+// the index.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bt/bthid/bthid_index.h"
+#include "checks.h"
+#include "../bench_util.h"
+
+#define TIMED_LOOKUPS       2000000u
+#define RANDOM_REGISTRIES   5000u
+#define MAX_DRIVERS         32
+#define MAX_IDS             8
+#define MAX_TOTAL_IDS       (BTHID_INDEX_SIZE / 2)
+
+// Sink so the compiler can't drop results
+static volatile uint32_t bench_sink;
+
+typedef struct {
+    uint8_t count;
+    bthid_device_id_t ids[MAX_DRIVERS][MAX_IDS + 1];   // Each 0-terminated
+} registry_t;
+
+// Reference: linear scan in registration order
+static int linear_find(const registry_t* reg, uint16_t vid, uint16_t pid)
+{
+    if (vid == 0) return -1;
+    for (int d = 0; d < reg->count; d++) {
+        for (const bthid_device_id_t* id = reg->ids[d]; id->vendor_id; id++) {
+            if (id->vendor_id == vid && id->product_id == pid) return d;
+        }
+    }
+    for (int d = 0; d < reg->count; d++) {
+        for (const bthid_device_id_t* id = reg->ids[d]; id->vendor_id; id++) {
+            if (id->vendor_id == vid && id->product_id == BTHID_PID_ANY) return d;
+        }
+    }
+    return -1;
+}
+
+static void build_index(const registry_t* reg, bthid_index_t* index)
+{
+    bthid_index_reset(index);
+    for (uint8_t d = 0; d < reg->count; d++) {
+        bthid_index_add_ids(index, reg->ids[d], d);
+    }
+}
+
+// Drivers registered by bthid_registry.c, in order (IDs from each driver)
+static void current_registry(registry_t* reg)
+{
+    static const bthid_device_id_t drivers[][5] = {
+        { { 0x054C, 0x0268 } },                                             // DS3
+        { { 0x054C, 0x05C4 }, { 0x054C, 0x09CC } },                         // DS4
+        { { 0x054C, 0x0CE6 }, { 0x054C, 0x0DF2 } },                         // DS5
+        { { 0x057E, 0x2006 }, { 0x057E, 0x2007 }, { 0x057E, 0x2009 } },     // Switch
+        { { 0x057E, 0x2066 }, { 0x057E, 0x2067 }, { 0x057E, 0x2069 },
+          { 0x057E, 0x2073 } },                                             // Switch 2
+        { { 0 } },                                                          // Xbox BLE
+        { { 0x045E, BTHID_PID_ANY } },                                      // Xbox BT
+        { { 0x18D1, 0x9400 } },                                             // Stadia
+        { { 0 } },                                                          // Generic
+    };
+    memset(reg, 0, sizeof(*reg));
+    reg->count = sizeof(drivers) / sizeof(drivers[0]);
+    for (uint8_t d = 0; d < reg->count; d++) {
+        memcpy(reg->ids[d], drivers[d], sizeof(drivers[d]));
+    }
+}
+
+// A registry grown to fill half the index: 16 drivers with 2 IDs each
+static void large_registry(registry_t* reg)
+{
+    memset(reg, 0, sizeof(*reg));
+    reg->count = 16;
+    for (uint8_t d = 0; d < reg->count; d++) {
+        for (uint8_t i = 0; i < 2; i++) {
+            reg->ids[d][i].vendor_id = (uint16_t)(0x1000 + d * 0x111);
+            reg->ids[d][i].product_id = (uint16_t)(0x0100 + i * 3);
+        }
+    }
+}
+
+static void random_registry(registry_t* reg)
+{
+    static const uint16_t vendors[] = { 0x054C, 0x057E, 0x045E, 0x18D1, 0x2DC8, 0x0F0D };
+    memset(reg, 0, sizeof(*reg));
+    reg->count = (uint8_t)(1 + check_rng() % MAX_DRIVERS);
+    uint32_t total = 0;
+    for (uint8_t d = 0; d < reg->count; d++) {
+        uint8_t n = (uint8_t)(check_rng() % (MAX_IDS + 1));
+        for (uint8_t i = 0; i < n && total < MAX_TOTAL_IDS; i++, total++) {
+            reg->ids[d][i].vendor_id = vendors[check_rng() % 6];
+            reg->ids[d][i].product_id = (check_rng() % 10 == 0) ? BTHID_PID_ANY
+                                                                : (uint16_t)(0x2000 + check_rng() % 24);
+        }
+    }
+}
+
+static void check_index(void)
+{
+    static const uint16_t vendors[] = { 0x054C, 0x057E, 0x045E, 0x18D1, 0x2DC8, 0x0F0D, 0x1234, 0 };
+    registry_t reg;
+    bthid_index_t index;
+    uint32_t lookups = 0, wrong = 0;
+
+    for (uint32_t r = 0; r < RANDOM_REGISTRIES; r++) {
+        random_registry(&reg);
+        build_index(&reg, &index);
+
+        // Every claimed pair, plus random pairs around them
+        for (uint8_t d = 0; d < reg.count; d++) {
+            for (const bthid_device_id_t* id = reg.ids[d]; id->vendor_id; id++) {
+                lookups++;
+                if (bthid_index_find(&index, id->vendor_id, id->product_id) !=
+                    linear_find(&reg, id->vendor_id, id->product_id)) {
+                    wrong++;
+                }
+            }
+        }
+        for (int i = 0; i < 64; i++) {
+            uint16_t vid = vendors[check_rng() % 8];
+            uint16_t pid = (uint16_t)(0x2000 + check_rng() % 32);
+            lookups++;
+            if (bthid_index_find(&index, vid, pid) != linear_find(&reg, vid, pid)) wrong++;
+        }
+    }
+
+    // Full index: refuses more pairs, lookups still terminate and answer
+    uint32_t full_bad = 0;
+    bthid_index_reset(&index);
+    uint32_t added = 0;
+    for (uint32_t i = 0; i < BTHID_INDEX_SIZE + 8; i++) {
+        if (bthid_index_add(&index, 0x1000, (uint16_t)i, (uint8_t)(i & 0x7F))) added++;
+    }
+    if (added != BTHID_INDEX_SIZE - 1) full_bad++;
+    for (uint32_t i = 0; i < BTHID_INDEX_SIZE + 8; i++) {
+        int expect = (i < BTHID_INDEX_SIZE - 1) ? (int)(i & 0x7F) : -1;
+        if (bthid_index_find(&index, 0x1000, (uint16_t)i) != expect) full_bad++;
+    }
+    if (bthid_index_find(&index, 0x2000, 1) != -1) full_bad++;
+
+    // Vendor 0 never matches, even next to a wildcard
+    uint32_t zero_bad = 0;
+    bthid_index_reset(&index);
+    if (bthid_index_add(&index, 0, BTHID_PID_ANY, 1)) zero_bad++;
+    if (bthid_index_add(&index, 0, 0x1234, 1)) zero_bad++;
+    if (bthid_index_find(&index, 0, 0x1234) != -1) zero_bad++;
+    if (bthid_index_find(&index, 0, 0) != -1) zero_bad++;
+
+    check_section("index");
+    check("lookups differing from the linear scan", wrong, lookups);
+    check("full index errors", full_bad, 2 * (BTHID_INDEX_SIZE + 8) + 2);
+    check("vendor ID 0 matches", zero_bad, 4);
+}
+
+// ============================================================================
+// TIMING
+// ============================================================================
+
+typedef struct {
+    double index_ns;
+    double linear_ns;
+} timing_t;
+
+static timing_t time_lookups(const registry_t* reg, uint32_t lookups)
+{
+    bthid_index_t index;
+    build_index(reg, &index);
+
+    // Half the lookups hit a claimed pair, half are unknown devices
+    uint32_t* keys = malloc(sizeof(uint32_t) * lookups);
+    uint32_t claimed = 0;
+    bthid_device_id_t flat[MAX_DRIVERS * MAX_IDS];
+    for (uint8_t d = 0; d < reg->count; d++) {
+        for (const bthid_device_id_t* id = reg->ids[d]; id->vendor_id; id++) {
+            flat[claimed++] = *id;
+        }
+    }
+    for (uint32_t i = 0; i < lookups; i++) {
+        if ((check_rng() & 1) && claimed) {
+            const bthid_device_id_t* id = &flat[check_rng() % claimed];
+            uint16_t pid = id->product_id == BTHID_PID_ANY ? (uint16_t)check_rng() : id->product_id;
+            keys[i] = ((uint32_t)id->vendor_id << 16) | pid;
+        } else {
+            keys[i] = ((uint32_t)(0x3000 + check_rng() % 64) << 16) | (check_rng() & 0xFFFF);
+        }
+    }
+
+    timing_t t = { 0 };
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < lookups; i++) {
+        int d = bthid_index_find(&index, (uint16_t)(keys[i] >> 16), (uint16_t)keys[i]);
+        bench_sink += (uint32_t)d;
+    }
+    uint64_t t1 = now_ns();
+    for (uint32_t i = 0; i < lookups; i++) {
+        bench_sink += (uint32_t)linear_find(reg, (uint16_t)(keys[i] >> 16), (uint16_t)keys[i]);
+    }
+    uint64_t t2 = now_ns();
+
+    t.index_ns = (double)(t1 - t0) / lookups;
+    t.linear_ns = (double)(t2 - t1) / lookups;
+    free(keys);
+    return t;
+}
+
+// The linear scan covers the ID lists only; the old find_driver() also ran
+// each driver's name and COD checks before reaching a VID/PID match
+static void time_registries(void)
+{
+    registry_t reg;
+    current_registry(&reg);
+    timing_t cur = time_lookups(&reg, TIMED_LOOKUPS);
+    large_registry(&reg);
+    timing_t large = time_lookups(&reg, TIMED_LOOKUPS);
+
+    check_section("lookup time (half hits, half unknown devices)");
+    check_value("current registry (9 drivers): index", cur.index_ns, "ns/lookup");
+    check_value("current registry (9 drivers): linear scan", cur.linear_ns, "ns/lookup");
+    check_value("16 drivers x 2 IDs: index", large.index_ns, "ns/lookup");
+    check_value("16 drivers x 2 IDs: linear scan", large.linear_ns, "ns/lookup");
+}
+
+void checks_bthid_index(void)
+{
+    check_index();
+    time_registries();
+}
@@ -0,0 +1,45 @@
+// checks.h - Shared harness for host behaviour checks
+//
+// Each area (checks/<area>.c) drives one module built for the host against
+// a reference or simulated peripheral and reports through check(). Areas
+// that replace older code also report timings through check_value(). The
+// harness (checks.c) runs every area and exits non-zero if any check failed.
+
+#ifndef CHECKS_H
+#define CHECKS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Print a section title inside an area
+void check_section(const char* title);
+
+// Record one result line; any nonzero bad fails the run
+void check(const char* what, uint32_t bad, uint32_t total);
+
+// Print a measured value (timings, model results); never fails the run
+void check_value(const char* what, double value, const char* unit);
+
+// xorshift32, reseeded before each area so areas are independent
+uint32_t check_rng(void);
+
+// Areas
+void checks_profile(void);
+void checks_analog(void);
+void checks_hid(void);
+void checks_uart(void);
+void checks_uart_host(void);
+void checks_crc(void);
+void checks_usbd_multi(void);
+void checks_report_cache(void);
+void checks_usbd_poll(void);
+void checks_flash_log(void);
+void checks_settings(void);
+void checks_flash_window(void);
+void checks_tdo_chain(void);
+void checks_snes_frame(void);
+void checks_hci_rx_queue(void);
+void checks_bthid_index(void);
+void checks_ble_conn_params(void);
+
+#endif // CHECKS_H
@@ -0,0 +1,254 @@
+// crc.c - Shared CRC tables vs the per-driver CRCs they replaced
+//
+// Checks core/crc.h against the original implementations: the bitwise
+// uart_crc8(), the Nuon lazily-built CRC16 lookup table and the DS5 BT
+// bitwise CRC32. CRC-8/CRC-16 are compared for every (crc, byte) pair,
+// CRC-32 over random buffers, every alignment and the DMA sniffer path
+// (the harness builds core/crc.c with CRC_USE_DMA_SNIFFER=1, and
+// stubs/uart_pipe.c models the RP2040 sniffer). Then prints ns/byte for the
+// bitwise, SRAM table and sniffer-model paths on packet-sized buffers.
+
+#include <string.h>
+
+#include "core/crc.h"
+#include "core/uart/uart_protocol.h"
+#include "uart_pipe.h"
+#include "checks.h"
+#include "../bench_util.h"
+
+#define MAX_BUF             512
+#define UART_PACKET_BYTES   17      // Input event packet incl. header
+#define DS5_REPORT_BYTES    74      // ds5_bt output report CRC span
+#define TIMED_ITERATIONS    200000u
+
+// Sink so the compiler can't drop results
+static volatile uint32_t bench_sink;
+
+static void fill_random(uint8_t* buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) buf[i] = (uint8_t)check_rng();
+}
+
+// ============================================================================
+// REFERENCES (as previously written in the tree)
+// ============================================================================
+
+// uart_protocol.h uart_crc8()
+static uint8_t ref_uart_crc8(const uint8_t* data, uint8_t len)
+{
+    uint8_t crc = 0x00;
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            if (crc & 0x80) {
+                crc = (crc << 1) ^ 0x07;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+    return crc;
+}
+
+// nuon_device.c crc_build_lut() / crc_calc()
+static int ref_crc_lut[256];
+
+static void ref_crc_build_lut(void)
+{
+    int i, j, k;
+    for (i = 0; i < 256; i++) {
+        for (j = i << 8, k = 0; k < 8; k++) {
+            j = (j & 0x8000) ? (j << 1) ^ 0x8005 : (j << 1);
+            ref_crc_lut[i] = j;
+        }
+    }
+}
+
+static int ref_crc_calc(unsigned char data, int crc)
+{
+    if (ref_crc_lut[1] == 0) ref_crc_build_lut();
+    return ((ref_crc_lut[((crc >> 8) ^ data) & 0xff]) ^ (crc << 8)) & 0xffff;
+}
+
+// ds5_bt.c ds5_crc32_raw()
+static uint32_t ref_crc32_raw(uint32_t seed, const uint8_t* data, size_t len)
+{
+    uint32_t crc = seed;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return crc;
+}
+
+static void check_crc8(void)
+{
+    uint32_t bad = 0;
+    for (int crc = 0; crc < 256; crc++) {
+        for (int b = 0; b < 256; b++) {
+            uint8_t ref = ref_uart_crc8((const uint8_t[]){ (uint8_t)(crc ^ b) }, 1);
+            if (crc8_update((uint8_t)crc, (uint8_t)b) != ref) bad++;
+        }
+    }
+    check("crc8 update (crc x byte)", bad, 256 * 256);
+
+    uint8_t buf[256];
+    bad = 0;
+    for (int len = 0; len < 256; len++) {
+        fill_random(buf, (size_t)len);
+        if (uart_crc8(buf, (uint8_t)len) != ref_uart_crc8(buf, (uint8_t)len)) bad++;
+    }
+    check("uart_crc8 buffers (len 0..255)", bad, 256);
+}
+
+static void check_crc16(void)
+{
+    uint32_t bad = 0;
+    for (int crc = 0; crc < 0x10000; crc++) {
+        for (int b = 0; b < 256; b++) {
+            if (crc16_update((uint16_t)crc, (uint8_t)b) != ref_crc_calc((unsigned char)b, crc)) bad++;
+        }
+    }
+    check("crc16 update (crc x byte)", bad, 0x10000 * 256);
+}
+
+static uint32_t ref_ds5_bt_crc32(const uint8_t* report, size_t len)
+{
+    const uint8_t seed = 0xA2;
+    return ~ref_crc32_raw(ref_crc32_raw(0xFFFFFFFF, &seed, 1), report, len);
+}
+
+static uint32_t ds5_bt_crc32(const uint8_t* report, size_t len)
+{
+    const uint8_t seed = 0xA2;
+    return ~crc32_raw(crc32_raw(0xFFFFFFFF, &seed, 1), report, len);
+}
+
+static void check_crc32(void)
+{
+    // Standard CRC-32 check value
+    const char* digits = "123456789";
+    uint32_t check_value = ~crc32_raw_table(0xFFFFFFFF, (const uint8_t*)digits, 9);
+    check("crc32 check value 0xCBF43926", check_value != 0xCBF43926u, 1);
+
+    static uint8_t buf[MAX_BUF + 4];
+    uint32_t bad_table = 0, bad_dma = 0, bad_raw = 0, total = 0;
+    uint32_t sniffed = uart_pipe_dma_sniffed();
+
+    for (size_t len = 0; len <= MAX_BUF; len += (len < 80 ? 1 : 37)) {
+        for (size_t offset = 0; offset < 4; offset++) {
+            fill_random(buf, sizeof(buf));
+            uint32_t seed = check_rng();
+            uint32_t ref = ref_crc32_raw(seed, buf + offset, len);
+            if (crc32_raw_table(seed, buf + offset, len) != ref) bad_table++;
+            if (crc32_raw_dma(seed, buf + offset, len) != ref) bad_dma++;
+            if (crc32_raw(seed, buf + offset, len) != ref) bad_raw++;
+            total++;
+        }
+    }
+    check("crc32 table (len x alignment)", bad_table, total);
+    check("crc32 DMA sniffer (len x alignment)", bad_dma, total);
+    check("crc32_raw dispatch", bad_raw, total);
+    check("crc32 DMA sniffer used", uart_pipe_dma_sniffed() == sniffed, 1);
+
+    uint32_t bad = 0;
+    uint8_t report[DS5_REPORT_BYTES];
+    for (int i = 0; i < 1000; i++) {
+        fill_random(report, sizeof(report));
+        if (ds5_bt_crc32(report, sizeof(report)) != ref_ds5_bt_crc32(report, sizeof(report))) bad++;
+    }
+    check("ds5 BT output report crc", bad, 1000);
+}
+
+// ============================================================================
+// THROUGHPUT
+// ============================================================================
+
+static double ns_per_byte(uint64_t ns, uint64_t bytes)
+{
+    return (double)ns / (double)bytes;
+}
+
+// On RP2040 the bitwise loops cost ~8 shift/xor steps per byte, the tables
+// one SRAM load, and the DMA sniffer one bus cycle per aligned word while
+// the CPU only sets it up. On the host the sniffer figure is the model's
+// cost, so it only shows the setup and head/tail overhead.
+static void time_crcs(void)
+{
+    uint8_t packet[UART_PACKET_BYTES];
+    uint8_t report[DS5_REPORT_BYTES];
+    fill_random(packet, sizeof(packet));
+    fill_random(report, sizeof(report));
+    uint32_t acc = 0;
+
+    quiet_begin();
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < TIMED_ITERATIONS; i++) {
+        packet[0] = (uint8_t)i;
+        acc += ref_uart_crc8(packet, sizeof(packet));
+    }
+    uint64_t t1 = now_ns();
+    for (uint32_t i = 0; i < TIMED_ITERATIONS; i++) {
+        packet[0] = (uint8_t)i;
+        acc += crc8_calc(packet, sizeof(packet));
+    }
+    uint64_t t2 = now_ns();
+    uint64_t packet_bytes = (uint64_t)TIMED_ITERATIONS * sizeof(packet);
+    double crc8_bitwise = ns_per_byte(t1 - t0, packet_bytes);
+    double crc8_table = ns_per_byte(t2 - t1, packet_bytes);
+
+    t0 = now_ns();
+    for (uint32_t i = 0; i < TIMED_ITERATIONS; i++) {
+        int crc = 0;
+        for (size_t b = 0; b < 2; b++) crc = ref_crc_calc((unsigned char)(i >> (8 * b)), crc);
+        acc += (uint32_t)crc;
+    }
+    t1 = now_ns();
+    for (uint32_t i = 0; i < TIMED_ITERATIONS; i++) {
+        uint16_t crc = 0;
+        for (size_t b = 0; b < 2; b++) crc = crc16_update(crc, (uint8_t)(i >> (8 * b)));
+        acc += crc;
+    }
+    t2 = now_ns();
+    double crc16_lazy = ns_per_byte(t1 - t0, (uint64_t)TIMED_ITERATIONS * 2);
+    double crc16_table = ns_per_byte(t2 - t1, (uint64_t)TIMED_ITERATIONS * 2);
+
+    t0 = now_ns();
+    for (uint32_t i = 0; i < TIMED_ITERATIONS; i++) {
+        report[0] = (uint8_t)i;
+        acc += ref_crc32_raw(0xFFFFFFFF, report, sizeof(report));
+    }
+    t1 = now_ns();
+    for (uint32_t i = 0; i < TIMED_ITERATIONS; i++) {
+        report[0] = (uint8_t)i;
+        acc += crc32_raw_table(0xFFFFFFFF, report, sizeof(report));
+    }
+    t2 = now_ns();
+    for (uint32_t i = 0; i < TIMED_ITERATIONS; i++) {
+        report[0] = (uint8_t)i;
+        acc += crc32_raw_dma(0xFFFFFFFF, report, sizeof(report));
+    }
+    uint64_t t3 = now_ns();
+    quiet_end();
+    uint64_t report_bytes = (uint64_t)TIMED_ITERATIONS * sizeof(report);
+
+    bench_sink = acc;
+    check_section("throughput (host)");
+    check_value("crc8 bitwise (17-byte packet)", crc8_bitwise, "ns/byte");
+    check_value("crc8 SRAM table", crc8_table, "ns/byte");
+    check_value("crc16 lazy LUT (2-byte word)", crc16_lazy, "ns/byte");
+    check_value("crc16 SRAM table", crc16_table, "ns/byte");
+    check_value("crc32 bitwise (74-byte report)", ns_per_byte(t1 - t0, report_bytes), "ns/byte");
+    check_value("crc32 SRAM table", ns_per_byte(t2 - t1, report_bytes), "ns/byte");
+    check_value("crc32 DMA sniffer model", ns_per_byte(t3 - t2, report_bytes), "ns/byte");
+}
+
+void checks_crc(void)
+{
+    check_crc8();
+    check_crc16();
+    check_crc32();
+    time_crcs();
+}
@@ -0,0 +1,310 @@
+// flash_log.c - Settings log wear and power-loss safety
+//
+// Runs core/services/storage/flash_log.c against a simulated NOR flash
+// (stubs/flash_sim.c) with the firmware's layout: a 256-byte flash_t image
+// in FLASH_LOG_SECTORS 4 KB sectors.
+//
+// Wear: 10k settings saves (profile, USB mode, poll interval changes, with
+// an occasional bulk change) with the spare sector erased between saves,
+// as flash_task() does when the output allows it, and with it never
+// erased ahead (console always polling). The same saves are replayed on the
+// old single-sector layout (erase the sector, program the image page) as a
+// baseline. Prints erases for both layouts; the log must erase at least
+// 100x less often than the baseline, evenly across sectors.
+//
+// Power loss: cuts the supply at a random point inside appends,
+// compactions and spare erases, then remounts. The image must be exactly
+// the one before or after the interrupted save (after, if the save
+// finished), and the log must keep accepting saves.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "core/services/storage/flash.h"
+#include "core/services/storage/flash_log.h"
+#include "flash_sim.h"
+#include "checks.h"
+
+#define POWER_CUT_TRIALS    20000u
+#define LOG_SECTORS         4       // flash.c FLASH_LOG_SECTORS
+#define WEAR_SAVES          10000u
+
+static flash_log_io_t io = {
+    .base = NULL,   // Set in checks_flash_log() (flash_sim_base())
+    .sector_size = FLASH_SIM_SECTOR_SIZE,
+    .sectors = LOG_SECTORS,
+    .erase = flash_sim_erase,
+    .program = flash_sim_program,
+};
+
+// A settings change as the firmware makes them: one u8 setting record
+// (settings.c updates values in place), now and then a bulk change (records
+// added or removed, future layout)
+#define PROFILE_VALUE   (0 * 4 + 3)     // Value byte of the first records
+#define MODE_VALUE      (1 * 4 + 3)
+#define POLL_VALUE      (2 * 4 + 3)
+
+static void mutate(flash_t* s, bool bulk)
+{
+    s->magic = FLASH_MAGIC;
+    if (bulk) {
+        uint32_t n = 1 + check_rng() % 64;
+        uint32_t at = 16 + check_rng() % (sizeof(s->data) - 16 - n);
+        for (uint32_t i = 0; i < n; i++) {
+            s->data[at + i] = (uint8_t)check_rng();
+        }
+        return;
+    }
+
+    switch (check_rng() % 3) {
+        case 0: s->data[PROFILE_VALUE] = (uint8_t)((s->data[PROFILE_VALUE] + 1 + check_rng() % 3) % 4); break;
+        case 1: s->data[MODE_VALUE] = (uint8_t)((s->data[MODE_VALUE] + 1 + check_rng() % 8) % 9); break;
+        default: {
+            static const uint8_t intervals[] = { 0, 1, 2, 4, 8 };
+            uint8_t v;
+            do { v = intervals[check_rng() % 5]; } while (v == s->data[POLL_VALUE]);
+            s->data[POLL_VALUE] = v;
+            break;
+        }
+    }
+}
+
+static bool remount_matches(const flash_t* expect)
+{
+    flash_log_t log;
+    flash_t image;
+    flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));
+    return memcmp(&image, expect, sizeof(image)) == 0;
+}
+
+// ============================================================================
+// BASICS
+// ============================================================================
+
+static void check_basics(void)
+{
+    flash_log_t log;
+    flash_t image, next;
+    uint32_t bad = 0;
+
+    flash_sim_init(LOG_SECTORS);
+    memset(&image, 0, sizeof(image));
+    bad += flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));   // Blank: no log
+
+    memset(&next, 0, sizeof(next));
+    mutate(&next, false);
+    bad += !flash_log_append(&log, (const uint8_t*)&next);
+    bad += !remount_matches(&next);
+    bad += log.stats.compactions != 1;
+
+    uint32_t pages = log.stats.pages;
+    bad += !flash_log_append(&log, (const uint8_t*)&next);                 // Unchanged
+    bad += log.stats.pages != pages;
+
+    mutate(&next, false);
+    uint32_t bytes = log.stats.bytes;
+    bad += !flash_log_append(&log, (const uint8_t*)&next);
+    bad += log.stats.bytes - bytes > 8;                                     // One field, one small record
+    bad += !remount_matches(&next);
+
+    // Large change still fits one record
+    memset(&next.reserved, 0x5A, sizeof(next.reserved));
+    bad += !flash_log_append(&log, (const uint8_t*)&next);
+    bad += log.stats.compactions != 1;
+
+    // Full sector moves to the next one
+    while (log.stats.compactions == 1) {
+        mutate(&next, false);
+        bad += !flash_log_append(&log, (const uint8_t*)&next);
+    }
+    bad += log.active != 1;
+    bad += !remount_matches(&next);
+
+    check_section("basics");
+    check("mount, append, compaction, remount", bad, 12);
+}
+
+// ============================================================================
+// WEAR
+// ============================================================================
+
+typedef struct {
+    uint32_t erases;
+    uint32_t inline_erases;
+    uint32_t compactions;
+    uint32_t max_sector;
+    uint32_t min_sector;
+    uint64_t bytes;
+    uint64_t pages;
+    bool intact;
+} wear_result_t;
+
+static wear_result_t run_wear(bool pre_erase)
+{
+    flash_log_t log;
+    flash_t image, next;
+    wear_result_t r;
+    memset(&r, 0, sizeof(r));
+
+    flash_sim_init(LOG_SECTORS);
+    memset(&image, 0, sizeof(image));
+    flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));
+    memcpy(&next, &image, sizeof(next));
+
+    for (uint32_t i = 0; i < WEAR_SAVES; i++) {
+        mutate(&next, check_rng() % 100 == 0);
+        flash_log_append(&log, (const uint8_t*)&next);
+        if (pre_erase && flash_log_erase_pending(&log)) {
+            flash_log_erase_spare(&log);
+        }
+    }
+
+    r.erases = log.stats.erases;
+    r.inline_erases = log.stats.inline_erases;
+    r.compactions = log.stats.compactions;
+    r.bytes = log.stats.bytes;
+    r.pages = log.stats.pages;
+    r.min_sector = UINT32_MAX;
+    for (uint8_t s = 0; s < LOG_SECTORS; s++) {
+        uint32_t e = flash_sim_erases(s);
+        if (e > r.max_sector) r.max_sector = e;
+        if (e < r.min_sector) r.min_sector = e;
+    }
+    r.intact = remount_matches(&next);
+    return r;
+}
+
+// The layout before the log: every save erased the one settings sector and
+// programmed the image page (flash_range_erase + flash_range_program)
+static uint32_t run_single_sector(void)
+{
+    flash_t next;
+    memset(&next, 0, sizeof(next));
+    flash_sim_init(1);
+
+    for (uint32_t i = 0; i < WEAR_SAVES; i++) {
+        mutate(&next, check_rng() % 100 == 0);
+        flash_sim_erase(0);
+        flash_sim_program(0, (const uint8_t*)&next, FLASH_SIM_PAGE_SIZE);
+    }
+    return flash_sim_erases(0);
+}
+
+static void print_count(const char* what, uint32_t count, const char* unit)
+{
+    printf("    %-52s %8u %s\n", what, count, unit);
+}
+
+static void check_wear(void)
+{
+    uint32_t single = run_single_sector();
+    wear_result_t pre = run_wear(true);
+    wear_result_t inl = run_wear(false);
+
+    check_section("wear (10k saves)");
+    print_count("single sector erases", single, "erases");
+    print_count("log erases, spare pre-erased", pre.erases, "erases");
+    print_count("log erases, erase inline", inl.erases, "erases");
+    check_value("log bytes per save, spare pre-erased", (double)pre.bytes / WEAR_SAVES, "bytes");
+    check_value("log pages per save, spare pre-erased", (double)pre.pages / WEAR_SAVES, "pages");
+    check("single sector erases once per save", single != WEAR_SAVES, 1);
+    check("at least 100x fewer erases than single sector",
+          pre.erases * 100 > single || inl.erases * 100 > single, 1);
+    check("pre-erased spare: no erase inside a save", pre.inline_erases, pre.compactions);
+    check("erases spread evenly over the sectors",
+          pre.max_sector - pre.min_sector > 1 || inl.max_sector - inl.min_sector > 1, 1);
+    check("image intact after 10k saves", !pre.intact + !inl.intact, 2);
+}
+
+// ============================================================================
+// POWER LOSS
+// ============================================================================
+
+static void check_power_loss(uint32_t trials)
+{
+    flash_log_t log;
+    flash_t image, prev, next;
+    uint32_t bad = 0, dead = 0, stuck = 0;
+
+    flash_sim_init(LOG_SECTORS);
+    memset(&image, 0, sizeof(image));
+    flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));
+
+    for (uint32_t t = 0; t < trials; t++) {
+        memcpy(&prev, &image, sizeof(prev));
+        memcpy(&next, &image, sizeof(next));
+
+        uint32_t kind = check_rng() % 100;
+        if (kind < 15) {
+            // Spare erase cut short: image must not change
+            flash_sim_cut_after((int32_t)(check_rng() % (FLASH_SIM_SECTOR_SIZE + 512)));
+            flash_log_erase_spare(&log);
+        } else {
+            // Small change, or a bulk one that may force a compaction;
+            // leave the spare unerased now and then for inline erases
+            mutate(&next, kind < 35);
+            if (kind < 70 && flash_log_erase_pending(&log)) {
+                flash_log_erase_spare(&log);
+            }
+            flash_sim_cut_after((int32_t)(check_rng() % (kind < 35 ? 4800 : 320)));
+            if (!flash_log_append(&log, (const uint8_t*)&next) && flash_sim_powered()) {
+                stuck++;    // Failed with power on: log refused a save
+            }
+        }
+
+        bool finished = flash_sim_powered();
+        flash_sim_power_on();
+
+        // Reboot
+        flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));
+        bool is_old = memcmp(&image, &prev, sizeof(image)) == 0;
+        bool is_new = memcmp(&image, &next, sizeof(image)) == 0;
+        if (finished ? !is_new : !(is_old || is_new)) {
+            bad++;
+        }
+        if (!log.mounted && t > 0) {
+            dead++;
+        }
+    }
+
+    check_section("power loss");
+    check("image is the old or new one (new if finished)", bad, trials);
+    check("log still mounts after a cut", dead, trials);
+    check("saves with power on succeed", stuck, trials);
+    check("flash operations aligned and in range", flash_sim_errors(), flash_sim_programs());
+}
+
+// ============================================================================
+// MOUNT
+// ============================================================================
+
+static void check_mount_replay(void)
+{
+    flash_log_t log;
+    flash_t image, next;
+
+    flash_sim_init(LOG_SECTORS);
+    memset(&image, 0, sizeof(image));
+    flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));
+    memcpy(&next, &image, sizeof(next));
+
+    // Fill the active sector almost to the end
+    do {
+        mutate(&next, false);
+        flash_log_append(&log, (const uint8_t*)&next);
+    } while (log.head + 16 <= FLASH_SIM_SECTOR_SIZE);
+
+    flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));
+    check_section("mount");
+    check("full sector replays to the saved image", memcmp(&image, &next, sizeof(image)) != 0, 1);
+}
+
+void checks_flash_log(void)
+{
+    io.base = flash_sim_base();
+
+    check_basics();
+    check_wear();
+    check_power_loss(POWER_CUT_TRIALS);
+    check_mount_replay();
+}
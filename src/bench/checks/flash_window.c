@@ -0,0 +1,436 @@
+// flash_window.c - Console polls missed by settings writes
+//
+// Replays console poll timestamps against flash_task()'s scheduling, with
+// the settings log (flash_log.c) on a simulated flash (stubs/flash_sim.c).
+// While a sector erase or page program runs, core 1 is parked and any poll
+// in that time is missed.
+//
+// Traces: GameCube polling once and twice a frame, and a PC Engine
+// multitap scan (a burst of CLK edges each frame), each with and without
+// pauses in polling (resets, loading screens). Settings change every few
+// seconds (profile switches, mode changes) and are debounced as in flash.c.
+//
+// Policies:
+//   due        write as soon as the debounce ends, erase the spare sector
+//              only once polling stops (the previous flash_task())
+//   windowed   flash_window_step(): each erase and write waits for a gap
+//              between polls long enough to hold it (flash_window.c)
+//
+// Checks the poll predictor on its own, prints missed polls per 1000 saves
+// for both policies on every trace, and checks that windowed misses far
+// fewer polls than due and that every save reaches flash.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "core/services/storage/flash.h"
+#include "core/services/storage/flash_log.h"
+#include "core/services/storage/flash_window.h"
+#include "flash_sim.h"
+#include "checks.h"
+
+#define SAVES           2000u
+#define LOG_SECTORS     4           // flash.c FLASH_LOG_SECTORS
+#define DEBOUNCE_US     5000000ull  // flash.c SAVE_DEBOUNCE_MS
+#define LOOP_US         250         // Main loop pass
+#define FRAME_US        16683       // 59.94 Hz
+
+// Real operation times (the scheduler plans with FLASH_WINDOW_*_US)
+#define ERASE_MIN_US    35000
+#define ERASE_MAX_US    55000
+#define PAGE_MIN_US     400
+#define PAGE_MAX_US     800
+#define LOCKOUT_US      50          // flash_safe_execute() entry and exit
+
+// Own generator: both policies replay the same trace and changes
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + rng() % (hi - lo + 1);
+}
+
+// ============================================================================
+// POLL TRACES
+// ============================================================================
+
+typedef struct {
+    const char* name;
+    uint8_t polls_per_frame;        // Bursts per frame
+    uint32_t burst_offset_us;       // Second burst's offset in the frame
+    uint8_t burst_edges;            // Polls per burst
+    uint32_t edge_us;               // Spacing inside a burst
+    bool pauses;                    // Polling stops now and then
+} trace_t;
+
+static const trace_t traces[] = {
+    { "GameCube, 1 poll/frame",          1, 0,    1,  0,  false },
+    { "GameCube, 2 polls/frame",         2, 5200, 1,  0,  false },
+    { "PC Engine, 5-pad scan",           1, 0,    10, 30, false },
+    { "GameCube, 1 poll/frame, pauses",  1, 0,    1,  0,  true  },
+    { "PC Engine, 5-pad scan, pauses",   1, 0,    10, 30, true  },
+};
+#define TRACE_COUNT (sizeof(traces) / sizeof(traces[0]))
+
+typedef struct {
+    const trace_t* trace;
+    uint64_t frame_start;
+    uint64_t next;                  // Next poll
+    uint8_t burst;                  // Burst in this frame
+    uint8_t edge;                   // Edge in this burst
+    uint64_t pause_at;              // Next pause
+} poll_gen_t;
+
+static void gen_frame(poll_gen_t* g)
+{
+    g->burst = 0;
+    g->edge = 0;
+    g->next = g->frame_start + rng_range(0, 40);
+}
+
+static void gen_init(poll_gen_t* g, const trace_t* t)
+{
+    memset(g, 0, sizeof(*g));
+    g->trace = t;
+    g->frame_start = 1000;
+    g->pause_at = t->pauses ? rng_range(30, 120) * 1000000ull : UINT64_MAX;
+    gen_frame(g);
+}
+
+static void gen_advance(poll_gen_t* g)
+{
+    const trace_t* t = g->trace;
+
+    if (++g->edge < t->burst_edges) {
+        g->next += t->edge_us;
+        return;
+    }
+    g->edge = 0;
+    if (++g->burst < t->polls_per_frame) {
+        g->next = g->frame_start + t->burst_offset_us + rng_range(0, 40);
+        return;
+    }
+
+    g->frame_start += FRAME_US;
+    if (g->frame_start >= g->pause_at) {
+        g->frame_start += rng_range(1, 3) * 1000000ull;   // Reset or loading
+        g->pause_at = g->frame_start + rng_range(30, 120) * 1000000ull;
+    }
+    gen_frame(g);
+}
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+typedef enum { POLICY_DUE, POLICY_WINDOWED } policy_t;
+
+typedef struct {
+    uint32_t saves;                 // Writes (changes within a debounce coalesce)
+    uint32_t erases;
+    uint32_t missed;
+    uint32_t saves_missing;         // Saves that missed any poll
+    uint32_t erases_forced;         // Windowed: erases without a window
+    uint32_t writes_forced;
+    bool intact;
+} sim_result_t;
+
+static uint64_t op_us;              // Time spent by the flash operations so far
+
+static void timed_erase(uint32_t offset)
+{
+    op_us += LOCKOUT_US + rng_range(ERASE_MIN_US, ERASE_MAX_US);
+    flash_sim_erase(offset);
+}
+
+static void timed_program(uint32_t offset, const uint8_t* data, uint32_t len)
+{
+    op_us += LOCKOUT_US + rng_range(PAGE_MIN_US, PAGE_MAX_US);
+    flash_sim_program(offset, data, len);
+}
+
+static flash_log_io_t io = {
+    .base = NULL,
+    .sector_size = FLASH_SIM_SECTOR_SIZE,
+    .sectors = LOG_SECTORS,
+    .erase = timed_erase,
+    .program = timed_program,
+};
+
+// Setting changes as in the flash_log checks: one value byte, sometimes more
+static void mutate(flash_t* s)
+{
+    if (rng() % 100 == 0) {
+        uint32_t n = 1 + rng() % 64;
+        uint32_t at = 16 + rng() % (sizeof(s->data) - 16 - n);
+        for (uint32_t i = 0; i < n; i++) {
+            s->data[at + i] = (uint8_t)rng();
+        }
+        return;
+    }
+    s->data[3 + 4 * (rng() % 4)] += 1 + rng() % 3;
+}
+
+typedef struct {
+    poll_gen_t gen;
+    flash_window_t window;
+    uint64_t now;
+    uint64_t last_poll;
+} sim_clock_t;
+
+// Run time forward to t, feeding polls answered on the way
+static void run_until(sim_clock_t* c, uint64_t t)
+{
+    while (c->gen.next <= t) {
+        flash_window_poll(&c->window, (uint32_t)c->gen.next);
+        c->last_poll = c->gen.next;
+        gen_advance(&c->gen);
+    }
+    c->now = t;
+}
+
+// Core 1 parked for op_us from now: count the polls it misses
+static uint32_t run_parked(sim_clock_t* c)
+{
+    uint64_t end = c->now + op_us;
+    uint32_t missed = 0;
+    while (c->gen.next <= end) {
+        missed++;
+        gen_advance(&c->gen);
+    }
+    c->now = end;
+    op_us = 0;
+    return missed;
+}
+
+static sim_result_t simulate(const trace_t* trace, policy_t policy, uint32_t saves)
+{
+    static flash_log_t log;
+    static flash_t image, settings, pending;
+    static sim_clock_t clk;
+    sim_result_t r;
+    memset(&r, 0, sizeof(r));
+
+    rng_state = 0x13572468u;
+    flash_sim_init(LOG_SECTORS);
+    io.base = flash_sim_base();
+
+    // A used part: no sector is blank, so every compaction needs an erase.
+    // The log is set up at boot, before the console polls.
+    uint8_t junk[FLASH_SIM_PAGE_SIZE];
+    for (uint32_t off = 0; off < LOG_SECTORS * FLASH_SIM_SECTOR_SIZE; off += sizeof(junk)) {
+        for (uint32_t i = 0; i < sizeof(junk); i++) junk[i] = (uint8_t)rng();
+        flash_sim_program(off, junk, sizeof(junk));
+    }
+    memset(&image, 0, sizeof(image));
+    flash_log_mount(&log, &io, (uint8_t*)&image, sizeof(image));
+    memset(&settings, 0, sizeof(settings));
+    settings.magic = FLASH_MAGIC;
+    flash_log_append(&log, (const uint8_t*)&settings);
+
+    memset(&clk, 0, sizeof(clk));
+    gen_init(&clk.gen, trace);
+    op_us = 0;
+    uint32_t erases_boot = log.stats.erases;
+
+    bool save_pending = false;
+    bool planned = false;
+    flash_log_plan_t plan;
+    uint64_t last_change = 0;
+    uint64_t wait_start = 0;
+    bool waiting = false;
+    uint64_t next_change = 3000000;
+    uint32_t changes = 0;
+    uint32_t save_missed = 0;
+
+    while (changes < saves || save_pending) {
+        // A settings change (flash_save())
+        if (changes < saves && clk.now >= next_change) {
+            mutate(&settings);
+            memcpy(&pending, &settings, sizeof(pending));
+            save_pending = true;
+            planned = false;
+            last_change = clk.now;
+            changes++;
+            next_change = clk.now + rng_range(1, 20) * 1000000ull + rng_range(0, FRAME_US);
+        }
+
+        // flash_task()
+        bool settled = clk.now >= last_change + DEBOUNCE_US;
+        bool erase_pending = flash_log_erase_pending(&log);
+        if (settled && (save_pending || erase_pending)) {
+            if (save_pending && !planned) {
+                flash_log_plan(&log, (const uint8_t*)&pending, &plan);
+                planned = true;
+            }
+            if (save_pending && !waiting) {
+                waiting = true;
+                wait_start = clk.now;
+            }
+            uint32_t quiet = flash_window_quiet_us(&clk.window, (uint32_t)clk.now);
+            uint64_t waited = waiting ? clk.now - wait_start : 0;
+
+            flash_step_t step;
+            if (policy == POLICY_WINDOWED) {
+                step = flash_window_step(save_pending, &plan, erase_pending, quiet,
+                                         waited > UINT32_MAX ? UINT32_MAX : (uint32_t)waited);
+            } else {
+                step = save_pending ? FLASH_STEP_WRITE :
+                       (quiet == FLASH_WINDOW_FOREVER ? FLASH_STEP_ERASE : FLASH_STEP_NONE);
+            }
+
+            if (step == FLASH_STEP_ERASE) {
+                flash_log_erase_spare(&log);
+                planned = false;
+                uint32_t missed = run_parked(&clk);
+                wait_start = clk.now;
+                r.missed += missed;
+                if (save_pending) {
+                    save_missed += missed;
+                    r.erases_forced += quiet < FLASH_WINDOW_ERASE_US;
+                }
+            } else if (step == FLASH_STEP_WRITE) {
+                if (policy == POLICY_WINDOWED && quiet < (uint32_t)plan.pages * FLASH_WINDOW_PAGE_US) {
+                    r.writes_forced++;
+                }
+                flash_log_append(&log, (const uint8_t*)&pending);
+                uint32_t missed = run_parked(&clk);
+                r.missed += missed;
+                save_missed += missed;
+                r.saves_missing += save_missed != 0;
+                save_missed = 0;
+                r.saves++;
+                save_pending = false;
+                waiting = false;
+                last_change = clk.now;
+            }
+        }
+
+        // Next main loop pass; skip ahead when there is nothing to do
+        uint64_t next = clk.now + LOOP_US + rng_range(0, 50);
+        if (!save_pending && !flash_log_erase_pending(&log) && next < next_change) {
+            next = next_change;
+        } else if (clk.now < last_change + DEBOUNCE_US && next < last_change + DEBOUNCE_US) {
+            next = last_change + DEBOUNCE_US;
+            if (changes < saves && next_change < next) next = next_change;
+        } else if (!save_pending) {
+            // Only an erase ahead waits: the quiet time is longest just after
+            // a burst, or unbounded once polling stops, so check only then
+            uint64_t check_at = clk.gen.next + FLASH_WINDOW_BURST_US + LOOP_US;
+            if (clk.last_poll + FLASH_WINDOW_IDLE_US < check_at) {
+                check_at = clk.last_poll + FLASH_WINDOW_IDLE_US;
+            }
+            if (check_at > next) next = check_at;
+            if (changes < saves && next_change < next) next = next_change;
+        }
+        run_until(&clk, next);
+    }
+
+    r.erases = log.stats.erases - erases_boot;
+    flash_log_t check_log;
+    flash_t mounted;
+    flash_log_mount(&check_log, &io, (uint8_t*)&mounted, sizeof(mounted));
+    r.intact = memcmp(&mounted, &settings, sizeof(mounted)) == 0;
+    return r;
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+static void check_predictor(void)
+{
+    flash_window_t w;
+    uint32_t bad = 0;
+
+    check_section("predictor");
+
+    memset(&w, 0, sizeof(w));
+    bad += flash_window_quiet_us(&w, 1000) != FLASH_WINDOW_FOREVER;     // Never polled
+
+    // Once a frame: right after a poll, the rest of the frame is quiet
+    uint32_t t = 1000;
+    for (int i = 0; i < 20; i++, t += FRAME_US) {
+        flash_window_poll(&w, t);
+    }
+    t -= FRAME_US;
+    uint32_t q = flash_window_quiet_us(&w, t + 2000);
+    bad += q < FRAME_US - 2000 - 2 * FLASH_WINDOW_GUARD_US || q > FRAME_US - 2000;
+    bad += flash_window_quiet_us(&w, t + FRAME_US - 100) != 0;         // Poll due
+    bad += flash_window_quiet_us(&w, t + 200) != 0;                    // Burst may go on
+    bad += flash_window_quiet_us(&w, t + FLASH_WINDOW_IDLE_US) != FLASH_WINDOW_FOREVER;
+    check("one poll per frame", bad, 5);
+
+    // Twice a frame, 5 ms apart: short gap after the first, long after the second
+    memset(&w, 0, sizeof(w));
+    bad = 0;
+    t = 1000;
+    for (int i = 0; i < 20; i++, t += FRAME_US) {
+        flash_window_poll(&w, t);
+        flash_window_poll(&w, t + 5000);
+    }
+    flash_window_poll(&w, t);
+    q = flash_window_quiet_us(&w, t + 1500);                          // After the first poll
+    bad += q > 5000 - 1500 || q < 5000 - 1500 - 2 * FLASH_WINDOW_GUARD_US;
+    flash_window_poll(&w, t + 5000);
+    q = flash_window_quiet_us(&w, t + 6500);                          // After the second
+    bad += q < FRAME_US - 6500 - 2 * FLASH_WINDOW_GUARD_US || q > FRAME_US - 6500;
+    check("two polls per frame (cycle of two gaps)", bad, 2);
+
+    // Resuming after a pause forgets the old pattern
+    t += 2 * FLASH_WINDOW_IDLE_US;
+    flash_window_poll(&w, t);
+    check("relearns after a pause", flash_window_quiet_us(&w, t + 2000) != 0, 1);
+}
+
+static void check_schedule(uint32_t saves)
+{
+    sim_result_t due[TRACE_COUNT], win[TRACE_COUNT];
+
+    for (uint32_t i = 0; i < TRACE_COUNT; i++) {
+        due[i] = simulate(&traces[i], POLICY_DUE, saves);
+        win[i] = simulate(&traces[i], POLICY_WINDOWED, saves);
+    }
+
+    uint32_t lost = 0, worse = 0, unforced = 0, writes_forced = 0;
+    uint32_t paused_missed = 0, paused_erases = 0;
+    for (uint32_t i = 0; i < TRACE_COUNT; i++) {
+        lost += !due[i].intact + !win[i].intact;
+        worse += win[i].missed * 5 > due[i].missed;
+        if (!traces[i].pauses) unforced += win[i].saves_missing > win[i].erases_forced;
+        writes_forced += win[i].writes_forced;
+        if (traces[i].pauses) {
+            paused_missed += win[i].missed;
+            paused_erases += win[i].erases;
+        }
+    }
+    check_section("missed polls (due vs windowed)");
+    for (uint32_t i = 0; i < TRACE_COUNT; i++) {
+        char label[64];
+        snprintf(label, sizeof(label), "%s: due", traces[i].name);
+        check_value(label, 1000.0 * due[i].missed / due[i].saves, "missed/1k saves");
+        snprintf(label, sizeof(label), "%s: windowed", traces[i].name);
+        check_value(label, 1000.0 * win[i].missed / win[i].saves, "missed/1k saves");
+    }
+
+    check("last settings on flash after every run", lost, TRACE_COUNT * 2);
+    check("windowed misses at most 1/5 of due", worse, TRACE_COUNT);
+    check("no pauses: only forced erases miss polls", unforced, TRACE_COUNT - 2);
+    check("page writes always found a window", writes_forced, TRACE_COUNT);
+    // An erase started in a pause can still meet the console resuming
+    check("with pauses: at most one miss per erase", paused_missed > paused_erases, 1);
+}
+
+void checks_flash_window(void)
+{
+    check_predictor();
+    check_schedule(SAVES);
+}
@@ -0,0 +1,470 @@
+// hci_rx_queue.c - USB Bluetooth dongle receive queue
+//
+// Drives usb/usbh/btd/hci_rx_queue.c with random producer/consumer
+// interleavings and checks that packets come out in order with their
+// lengths and contents intact, that a full queue refuses a buffer (and
+// counts the stall), and that depth and counters add up.
+//
+// Order: connections open, send ACL data and close on a few handles while
+// events and ACL packets are queued and delivered as
+// hci_transport_h2_tinyusb_process() does. No ACL packet may reach BTstack
+// outside its connection (before its Connection Complete or after its
+// Disconnection Complete), and no event may be held behind ACL data that
+// arrived after it. Also prints the count for the previous all-events-first
+// delivery.
+//
+// Transport: models the main loop the dongle transport runs in. Controllers
+// send 1 kHz reports into the dongle, which holds a few packets until the
+// host reads them and loses the rest. TinyUSB only reports completions from
+// tuh_task(); hci_transport_h2_tinyusb_process() delivers packets to BTstack
+// later in the same loop pass. For each queue depth and controller count it
+// prints packets lost in the dongle, delivery latency and queue depth.
+// Depth 1 with re-arm on release is the previous single-buffer transport.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "usb/usbh/btd/hci_rx_queue.h"
+#include "checks.h"
+#include "../bench_util.h"
+
+#define QUEUE_OPS           2000000u
+#define BUF_SIZE            64      // Check buffer size (transport uses 1024)
+#define MODEL_SECONDS       10u
+
+#define REPORT_US           1000    // Controller report interval
+#define REPORT_JITTER_US    40
+#define DONGLE_FIFO         3       // Packets the dongle holds for the host
+#define XFER_US             70      // Bulk IN transfer of one HID report
+#define CB_US               4       // tuh_task() per completion
+#define HANDLE_US           25      // BTstack handling of one ACL packet
+#define LOOP_PRE_US         30      // Other tasks between tuh_task() and process()
+#define LOOP_POST_US        50      // Rest of the main loop
+#define LOOP_JITTER_US      40
+#define SLOW_LOOP_US        1500    // Occasional long pass (console, flash)
+#define SLOW_LOOP_EVERY     40
+
+// Sink so the compiler can't drop results
+static volatile uint32_t bench_sink;
+
+static uint8_t queue_bufs[HCI_RX_QUEUE_MAX * BUF_SIZE];
+
+static void fill(uint8_t* buf, uint32_t seq, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(seq * 31u + i);
+    }
+}
+
+static bool intact(const uint8_t* buf, uint32_t seq, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        if (buf[i] != (uint8_t)(seq * 31u + i)) return false;
+    }
+    return true;
+}
+
+static void check_queue(void)
+{
+    static const uint8_t counts[] = { 1, 2, 4, 8 };
+    uint32_t order_bad = 0, data_bad = 0, full_bad = 0, depth_bad = 0, count_bad = 0;
+    uint32_t total = 0;
+
+    for (size_t c = 0; c < sizeof(counts); c++) {
+        hci_rx_queue_t q;
+        hci_rx_queue_init(&q, queue_bufs, BUF_SIZE, counts[c]);
+
+        uint32_t produced = 0, consumed = 0, refused = 0, dropped = 0;
+        uint8_t* armed = NULL;
+
+        for (uint32_t op = 0; op < QUEUE_OPS / sizeof(counts); op++) {
+            uint32_t r = check_rng();
+            total++;
+
+            if (r & 1) {
+                // Producer: complete the armed transfer, re-arm
+                if (armed) {
+                    if ((r & 0x3E) == 0) {
+                        hci_rx_queue_drop(&q);
+                        dropped++;
+                    } else {
+                        uint16_t len = (uint16_t)((r >> 8) % (BUF_SIZE + 1));
+                        fill(armed, produced, len);
+                        hci_rx_queue_commit(&q, len);
+                        produced++;
+                    }
+                    armed = NULL;
+                }
+                bool full = hci_rx_queue_depth(&q) >= counts[c];
+                armed = hci_rx_queue_acquire(&q);
+                if ((armed == NULL) != full) full_bad++;
+                if (!armed) refused++;
+            } else {
+                // Consumer: deliver one packet
+                uint16_t len;
+                uint8_t* pkt = hci_rx_queue_peek(&q, &len);
+                if (!pkt) {
+                    if (consumed != produced) order_bad++;
+                    continue;
+                }
+                if (!intact(pkt, consumed, len)) data_bad++;
+                hci_rx_queue_release(&q);
+                consumed++;
+            }
+
+            if (hci_rx_queue_depth(&q) > counts[c] ||
+                hci_rx_queue_depth(&q) != produced - consumed) {
+                depth_bad++;
+            }
+        }
+
+        if (q.packets != produced || q.drops != dropped || q.stalls != refused ||
+            q.max_depth != counts[c]) {
+            count_bad++;
+        }
+    }
+
+    // Counts that aren't a power of two round down
+    hci_rx_queue_t q;
+    uint32_t round_bad = 0;
+    hci_rx_queue_init(&q, queue_bufs, BUF_SIZE, 6);
+    if (q.count != 4) round_bad++;
+    hci_rx_queue_init(&q, queue_bufs, BUF_SIZE, 100);
+    if (q.count != HCI_RX_QUEUE_MAX) round_bad++;
+
+    check_section("queue");
+    check("packets out of order or lost", order_bad, total);
+    check("packets with wrong length or contents", data_bad, total);
+    check("acquire not refused exactly when full", full_bad, total);
+    check("depth out of range or miscounted", depth_bad, total);
+    check("queues with wrong packet/drop/stall counters", count_bad, sizeof(counts));
+    check("buffer counts not rounded to a power of two", round_bad, 2);
+}
+
+// ============================================================================
+// EVENT / ACL ORDER
+// ============================================================================
+
+#define ORDER_OPS           500000u
+#define ORDER_HANDLES       3
+#define ORDER_DEPTH         4
+#define HCI_CONN_COMPLETE   0x03
+#define HCI_DISCONN_COMPLETE 0x05
+
+// Model packets: HCI header, then the arrival number and the connection
+// (arrival number of its Connection Complete) it belongs to
+#define ORDER_SEQ_AT        5
+#define ORDER_CONN_AT       9
+#define ORDER_LEN           13
+
+typedef struct {
+    hci_rx_queue_t evt;
+    hci_rx_queue_t acl;
+    uint32_t view[ORDER_HANDLES];   // Connection BTstack has on each handle (0 = none)
+    uint32_t last_acl;              // Arrival number of the last ACL delivered
+    uint32_t acls;
+    uint32_t events;
+    uint32_t acl_bad;
+    uint32_t event_bad;
+} order_t;
+
+static uint8_t order_evt_bufs[ORDER_DEPTH * BUF_SIZE];
+static uint8_t order_acl_bufs[ORDER_DEPTH * BUF_SIZE];
+
+static uint32_t get_u32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void put_packet(uint8_t* buf, uint8_t b0, uint8_t b1, uint16_t handle, uint32_t seq, uint32_t conn)
+{
+    memset(buf, 0, ORDER_LEN);
+    buf[0] = b0;
+    buf[1] = b1;
+    memcpy(&buf[ORDER_SEQ_AT], &seq, sizeof(seq));
+    memcpy(&buf[ORDER_CONN_AT], &conn, sizeof(conn));
+    if (b0 == HCI_CONN_COMPLETE || b0 == HCI_DISCONN_COMPLETE) {
+        buf[3] = (uint8_t)handle;               // Event: code, length, status, handle
+        buf[4] = (uint8_t)(handle >> 8);
+    }
+}
+
+static void deliver_event(order_t* o)
+{
+    uint16_t len;
+    const uint8_t* pkt = hci_rx_queue_peek(&o->evt, &len);
+    uint16_t h = (uint16_t)(pkt[3] | (pkt[4] << 8));
+
+    if (get_u32(&pkt[ORDER_SEQ_AT]) < o->last_acl) o->event_bad++;
+    o->view[h] = pkt[0] == HCI_CONN_COMPLETE ? get_u32(&pkt[ORDER_SEQ_AT]) : 0;
+    o->events++;
+    hci_rx_queue_release(&o->evt);
+}
+
+static void deliver_acl(order_t* o)
+{
+    uint16_t len;
+    const uint8_t* pkt = hci_rx_queue_peek(&o->acl, &len);
+    uint16_t h = (uint16_t)((pkt[0] | (pkt[1] << 8)) & 0x0FFF);
+
+    if (o->view[h] != get_u32(&pkt[ORDER_CONN_AT])) o->acl_bad++;
+    o->last_acl = get_u32(&pkt[ORDER_SEQ_AT]);
+    o->acls++;
+    hci_rx_queue_release(&o->acl);
+}
+
+// hci_transport_h2_tinyusb_process()
+static void order_process(order_t* o, bool events_first)
+{
+    uint16_t len;
+    if (events_first) {
+        while (hci_rx_queue_peek(&o->evt, &len)) deliver_event(o);
+        while (hci_rx_queue_peek(&o->acl, &len)) deliver_acl(o);
+        return;
+    }
+    for (;;) {
+        if (hci_rx_queue_peek(&o->evt, &len) && hci_rx_queue_event_may_pass(&o->evt, &o->acl)) {
+            deliver_event(o);
+        } else if (hci_rx_queue_peek(&o->acl, &len)) {
+            deliver_acl(o);
+        } else {
+            break;
+        }
+    }
+}
+
+static void run_order(order_t* o, bool events_first)
+{
+    uint32_t conn[ORDER_HANDLES] = { 0 };   // Open connection per handle (arrival side)
+    uint32_t seq = 0;
+
+    memset(o, 0, sizeof(*o));
+    hci_rx_queue_init(&o->evt, order_evt_bufs, BUF_SIZE, ORDER_DEPTH);
+    hci_rx_queue_init(&o->acl, order_acl_bufs, BUF_SIZE, ORDER_DEPTH);
+
+    for (uint32_t op = 0; op < ORDER_OPS; op++) {
+        uint32_t r = check_rng();
+        if (r % 4 == 0) {
+            order_process(o, events_first);
+            continue;
+        }
+
+        // Arrival; skipped (held in the dongle) if its queue is full
+        uint16_t h = (uint16_t)((r >> 8) % ORDER_HANDLES);
+        bool data = conn[h] && (r >> 16) % 8 != 0;
+        uint8_t* buf = hci_rx_queue_acquire(data ? &o->acl : &o->evt);
+        if (!buf) continue;
+
+        seq++;
+        if (data) {
+            put_packet(buf, (uint8_t)h, (uint8_t)(0x20 | (h >> 8)), h, seq, conn[h]);
+            hci_rx_queue_commit(&o->acl, ORDER_LEN);
+        } else {
+            put_packet(buf, conn[h] ? HCI_DISCONN_COMPLETE : HCI_CONN_COMPLETE, ORDER_LEN - 2, h, seq, 0);
+            conn[h] = conn[h] ? 0 : seq;
+            hci_rx_queue_commit_after(&o->evt, ORDER_LEN, &o->acl);
+        }
+    }
+    order_process(o, events_first);
+}
+
+static void check_order(void)
+{
+    order_t o;
+    run_order(&o, true);
+    uint32_t old_bad = o.acl_bad;
+    run_order(&o, false);
+
+    check_section("event / ACL order");
+    check("ACL delivered outside its connection", o.acl_bad, o.acls);
+    check("events held behind later ACL data", o.event_bad, o.events);
+    check_value("ACL outside its connection, all events first", old_bad, "packets");
+}
+
+// ============================================================================
+// TRANSPORT MODEL
+// ============================================================================
+
+typedef struct {
+    uint32_t arrival;               // Time the report reached the dongle
+} pkt_t;
+
+typedef struct {
+    uint32_t now;
+
+    // Controllers and dongle
+    uint32_t next_report[4];
+    uint8_t  controllers;
+    pkt_t    fifo[DONGLE_FIFO];
+    uint8_t  fifo_len;
+
+    // Bulk IN endpoint
+    uint8_t* xfer_buf;              // Armed into this buffer
+    uint32_t xfer_done_at;          // 0 = not transferring
+    bool     xfer_complete;         // Waiting for tuh_task()
+
+    hci_rx_queue_t queue;
+
+    // Results
+    uint32_t reports;
+    uint32_t lost;
+    uint32_t* latency;
+    uint32_t delivered;
+} sim_t;
+
+static uint8_t sim_bufs[HCI_RX_QUEUE_MAX * BUF_SIZE];
+
+// Let time pass: reports arrive, the armed transfer reads the dongle
+static void sim_advance(sim_t* s, uint32_t us)
+{
+    uint32_t end = s->now + us;
+    for (; s->now < end; s->now++) {
+        for (uint8_t c = 0; c < s->controllers; c++) {
+            if (s->now < s->next_report[c]) continue;
+            s->next_report[c] += REPORT_US - REPORT_JITTER_US + check_rng() % (2 * REPORT_JITTER_US + 1);
+            s->reports++;
+            if (s->fifo_len == DONGLE_FIFO) {
+                s->lost++;
+            } else {
+                s->fifo[s->fifo_len++].arrival = s->now;
+            }
+        }
+
+        if (s->xfer_done_at && s->now >= s->xfer_done_at) {
+            s->xfer_done_at = 0;
+            s->xfer_complete = true;
+        } else if (s->xfer_buf && !s->xfer_done_at && !s->xfer_complete && s->fifo_len) {
+            // Transfer starts: the packet leaves the dongle into the armed buffer
+            memcpy(s->xfer_buf, &s->fifo[0], sizeof(pkt_t));
+            memmove(&s->fifo[0], &s->fifo[1], (s->fifo_len - 1) * sizeof(pkt_t));
+            s->fifo_len--;
+            s->xfer_done_at = s->now + XFER_US;
+        }
+    }
+}
+
+// usb_submit_acl_in_transfer()
+static void sim_arm(sim_t* s)
+{
+    if (s->xfer_buf) return;
+    s->xfer_buf = hci_rx_queue_acquire(&s->queue);
+}
+
+static void sim_run(sim_t* s, uint8_t depth, uint8_t controllers, uint32_t seconds)
+{
+    memset(s->next_report, 0, sizeof(s->next_report));
+    s->now = 1;
+    s->controllers = controllers;
+    for (uint8_t c = 0; c < controllers; c++) {
+        s->next_report[c] = 1 + check_rng() % REPORT_US;
+    }
+    s->fifo_len = 0;
+    s->xfer_buf = NULL;
+    s->xfer_done_at = 0;
+    s->xfer_complete = false;
+    s->reports = s->lost = s->delivered = 0;
+    hci_rx_queue_init(&s->queue, sim_bufs, BUF_SIZE, depth);
+
+    sim_arm(s);
+    uint32_t end = seconds * 1000000u;
+    uint32_t pass = 0;
+
+    while (s->now < end) {
+        // tuh_task(): handle completions until none are waiting
+        while (s->xfer_complete) {
+            s->xfer_complete = false;
+            s->xfer_buf = NULL;
+            hci_rx_queue_commit(&s->queue, sizeof(pkt_t));
+            sim_arm(s);
+            sim_advance(s, CB_US);
+        }
+
+        sim_advance(s, LOOP_PRE_US + check_rng() % LOOP_JITTER_US);
+
+        // hci_transport_h2_tinyusb_process()
+        uint16_t len;
+        uint8_t* pkt;
+        while ((pkt = hci_rx_queue_peek(&s->queue, &len)) != NULL) {
+            pkt_t p;
+            memcpy(&p, pkt, sizeof(p));
+            sim_advance(s, HANDLE_US);
+            s->latency[s->delivered++] = s->now - p.arrival;
+            hci_rx_queue_release(&s->queue);
+            sim_arm(s);
+        }
+
+        uint32_t rest = LOOP_POST_US + check_rng() % LOOP_JITTER_US;
+        if (++pass % SLOW_LOOP_EVERY == 0) rest += SLOW_LOOP_US;
+        sim_advance(s, rest);
+    }
+}
+
+static void model_transport(void)
+{
+    // Queue cost per packet
+    hci_rx_queue_t q;
+    hci_rx_queue_init(&q, queue_bufs, BUF_SIZE, 4);
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < QUEUE_OPS; i++) {
+        uint16_t len;
+        uint8_t* buf = hci_rx_queue_acquire(&q);
+        hci_rx_queue_commit(&q, (uint16_t)i);
+        uint8_t* pkt = hci_rx_queue_peek(&q, &len);
+        bench_sink += (uint32_t)(pkt - buf) + len;
+        hci_rx_queue_release(&q);
+    }
+    double op_ns = (double)(now_ns() - t0) / QUEUE_OPS;
+
+    static const uint8_t depths[] = { 1, 2, 4, 8 };
+    static const uint8_t counts[] = { 1, 2, 4 };
+    sim_t sim;
+    sim.latency = malloc(sizeof(uint32_t) * 4 * 1100u * MODEL_SECONDS);
+
+    uint32_t lost_bad = 0, checked = 0;
+    uint32_t lost_old[sizeof(counts)] = { 0 };
+
+    // lost: reports dropped by the dongle while the host wasn't reading;
+    // latency: dongle arrival to BTstack handler; stalls: completions with
+    // every buffer still queued
+    check_section("transport model, 10 s per run (depth 1 = old single buffer)");
+    printf("    %-6s %-6s %10s %8s %10s %10s %10s %8s %8s\n", "ctrls", "depth",
+           "reports", "lost", "avg us", "p99 us", "max us", "max q", "stalls");
+    for (size_t c = 0; c < sizeof(counts); c++) {
+        for (size_t d = 0; d < sizeof(depths); d++) {
+            sim_run(&sim, depths[d], counts[c], MODEL_SECONDS);
+
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < sim.delivered; i++) sum += sim.latency[i];
+            qsort(sim.latency, sim.delivered, sizeof(uint32_t), compare_u32);
+
+            printf("    %-6u %-6u %10u %7.2f%% %10.0f %10u %10u %8u %8u\n",
+                   counts[c], depths[d], sim.reports, 100.0 * sim.lost / sim.reports,
+                   sim.delivered ? (double)sum / sim.delivered : 0.0,
+                   percentile_u32(sim.latency, sim.delivered, 99),
+                   sim.delivered ? sim.latency[sim.delivered - 1] : 0,
+                   sim.queue.max_depth, sim.queue.stalls);
+
+            // A deeper pool must never lose more than the single buffer
+            if (depths[d] == 1) {
+                lost_old[c] = sim.lost;
+            } else {
+                checked++;
+                if (sim.lost > lost_old[c] + lost_old[c] / 20 + 2) lost_bad++;
+            }
+        }
+    }
+    free(sim.latency);
+
+    check_value("queue cost (acquire, commit, peek, release)", op_ns, "ns/packet");
+    check("pool depths losing more than the single buffer", lost_bad, checked);
+}
+
+void checks_hci_rx_queue(void)
+{
+    check_queue();
+    check_order();
+    model_transport();
+}
@@ -0,0 +1,649 @@
+// hid.c - Generic HID extraction plan vs per-item and legacy decoding
+//
+// Parses representative gamepad report descriptors (DragonRise-style 8-bit
+// pad, 16-bit pad, 10-bit flight stick, signed 8/16-bit pads, multi report
+// ID pad) with the HID parser, compiles them with hid_extract_compile() and:
+//   - checks hid_extract_run() against a per-item reference built on
+//     USB_GetHIDReportItemInfo() over random reports
+//   - checks the DragonRise layout against the previous byteIndex/bitMask
+//     extractor, then times the plan against it and against the per-item
+//     HID_ReportItem walk
+//   - fuzzes report lengths/contents and mutated descriptors for crashes
+//     and plan invariants
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tusb.h"
+#include "usb/usbh/hid/devices/generic/hid_parser.h"
+#include "usb/usbh/hid/devices/generic/hid_extract.h"
+#include "checks.h"
+#include "../bench_util.h"
+
+#define TIMED_REPORTS       5000000u
+#define VERIFY_REPORTS      200000u
+#define FUZZ_DESCRIPTORS    20000u
+#define REPORT_MAX_LEN      64
+#define REPORT_POOL_SIZE    1024u       // Pre-generated reports (power of 2)
+
+// Sink so the compiler can't drop results
+static volatile uint32_t bench_sink;
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+// DragonRise generic USB joystick layout: X,X,X,Z,Rz 8-bit, 4-bit hat,
+// 12 buttons, 8 vendor bits
+static const uint8_t desc_dragonrise[] = {
+    0x05, 0x01, 0x09, 0x04, 0xA1, 0x01, 0xA1, 0x02,
+    0x75, 0x08, 0x95, 0x05, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xFF, 0x00,
+    0x09, 0x30, 0x09, 0x30, 0x09, 0x30, 0x09, 0x32, 0x09, 0x35, 0x81, 0x02,
+    0x75, 0x04, 0x95, 0x01, 0x25, 0x07, 0x46, 0x3B, 0x01, 0x65, 0x14, 0x09, 0x39, 0x81, 0x42,
+    0x65, 0x00, 0x75, 0x01, 0x95, 0x0C, 0x25, 0x01, 0x45, 0x01,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x0C, 0x81, 0x02,
+    0x06, 0x00, 0xFF, 0x75, 0x01, 0x95, 0x08, 0x25, 0x01, 0x45, 0x01, 0x09, 0x01, 0x81, 0x02,
+    0xC0,
+    0xA1, 0x02, 0x75, 0x08, 0x95, 0x07, 0x46, 0xFF, 0x00, 0x26, 0xFF, 0x00, 0x09, 0x02, 0x91, 0x02, 0xC0,
+    0xC0,
+};
+
+// 16 buttons, 1-based hat, 16-bit sticks (0-65535), 16-bit triggers (0-1023)
+static const uint8_t desc_pad16[] = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x10, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x10, 0x81, 0x02,
+    0x05, 0x01, 0x09, 0x39, 0x15, 0x01, 0x25, 0x08, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
+    0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35,
+    0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00, 0x00, 0x75, 0x10, 0x95, 0x04, 0x81, 0x02,
+    0x09, 0x33, 0x09, 0x34, 0x15, 0x00, 0x26, 0xFF, 0x03, 0x75, 0x10, 0x95, 0x02, 0x81, 0x02,
+    0xC0,
+};
+
+// Flight stick: X/Y 10-bit, hat, Rz 8-bit, 12 buttons (fields straddle bytes)
+static const uint8_t desc_stick10[] = {
+    0x05, 0x01, 0x09, 0x04, 0xA1, 0x01,
+    0x09, 0x30, 0x09, 0x31, 0x15, 0x00, 0x26, 0xFF, 0x03, 0x75, 0x0A, 0x95, 0x02, 0x81, 0x02,
+    0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+    0x09, 0x35, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x01, 0x81, 0x02,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x0C, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x0C, 0x81, 0x02,
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
+    0xC0,
+};
+
+// Signed 8-bit sticks (-127..127), hat, 10 buttons
+static const uint8_t desc_signed8[] = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+    0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x04, 0x81, 0x02,
+    0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x0A, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x0A, 0x81, 0x02,
+    0x75, 0x06, 0x95, 0x01, 0x81, 0x03,
+    0xC0,
+};
+
+// Signed 16-bit sticks (-32768..32767), 8 buttons
+static const uint8_t desc_signed16[] = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x08, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x09, 0x32, 0x09, 0x35,
+    0x16, 0x00, 0x80, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x04, 0x81, 0x02,
+    0xC0,
+};
+
+// Report ID 1: sticks, hat, 8 buttons; ID 2: triggers; ID 3: consumer keys
+static const uint8_t desc_multi_id[] = {
+    0x05, 0x01, 0x09, 0x05, 0xA1, 0x01,
+    0x85, 0x01,
+    0x09, 0x30, 0x09, 0x31, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x02, 0x81, 0x02,
+    0x09, 0x39, 0x15, 0x00, 0x25, 0x07, 0x75, 0x04, 0x95, 0x01, 0x81, 0x42,
+    0x75, 0x04, 0x95, 0x01, 0x81, 0x03,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x08, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+    0x85, 0x02,
+    0x05, 0x01, 0x09, 0x33, 0x09, 0x34, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x02, 0x81, 0x02,
+    0x85, 0x03,
+    0x05, 0x0C, 0x09, 0xE9, 0x09, 0xEA, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x02, 0x81, 0x02,
+    0x75, 0x06, 0x95, 0x01, 0x81, 0x03,
+    0xC0,
+};
+
+typedef struct {
+    const char* name;
+    const uint8_t* desc;
+    uint16_t len;
+    bool exact;         // All axes <= 8 bits: plan must match the division exactly
+} bench_desc_t;
+
+#define DESC(name, d, exact) { name, d, sizeof(d), exact }
+
+static const bench_desc_t bench_descs[] = {
+    DESC("dragonrise", desc_dragonrise, true),
+    DESC("pad16",      desc_pad16,      false),
+    DESC("stick10",    desc_stick10,    false),
+    DESC("signed8",    desc_signed8,    true),
+    DESC("signed16",   desc_signed16,   false),
+    DESC("multi_id",   desc_multi_id,   true),
+};
+
+#define BENCH_DESC_COUNT (sizeof(bench_descs) / sizeof(bench_descs[0]))
+
+static void random_bytes(uint8_t* buf, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) buf[i] = (uint8_t)check_rng();
+}
+
+// Parse into an exactly sized heap arena, so a parser write past the size
+// USB_GetHIDReportInfoSize() reported lands outside the allocation (the
+// firmware uses a static HID_PARSER_ARENA_MAX buffer). The report info is
+// the arena's first allocation, so free(info) releases it
+static HID_ReportInfo_t* parse(const uint8_t* desc, uint16_t len)
+{
+    uint32_t size = USB_GetHIDReportInfoSize(1, 0, desc, len);
+    if (size == 0) return NULL;
+
+    void* arena = malloc(size);
+    HID_ReportInfo_t* info = NULL;
+    if (USB_ProcessHIDReport(1, 0, desc, len, arena, size, &info) != HID_PARSE_Successful) {
+        free(arena);
+        return NULL;
+    }
+    return info;
+}
+
+// ============================================================================
+// PER-ITEM REFERENCE (USB_GetHIDReportItemInfo + division scaling)
+// ============================================================================
+
+static uint8_t ref_scale(uint32_t value, uint32_t range)
+{
+    uint32_t mid = range / 2;
+    if (value > range) value = range;
+    if (value <= mid) return (uint8_t)(1 + (value * 127) / mid);
+    return (uint8_t)(128 + ((value - mid) * 127) / (range - mid));
+}
+
+static int ref_axis_field(uint16_t usage)
+{
+    switch (usage) {
+        case HID_USAGE_DESKTOP_X:  return HID_FIELD_X;
+        case HID_USAGE_DESKTOP_Y:  return HID_FIELD_Y;
+        case HID_USAGE_DESKTOP_Z:  return HID_FIELD_Z;
+        case HID_USAGE_DESKTOP_RZ: return HID_FIELD_RZ;
+        case HID_USAGE_DESKTOP_RX: return HID_FIELD_RX;
+        case HID_USAGE_DESKTOP_RY: return HID_FIELD_RY;
+        case HID_USAGE_DESKTOP_HAT_SWITCH: return HID_FIELD_HAT;
+        default: return -1;
+    }
+}
+
+static bool ref_decode(HID_ReportInfo_t* info, const uint8_t* report, uint16_t len,
+                       hid_extract_state_t* state)
+{
+    uint8_t id = 0;
+    if (info->UsingReportIDs) {
+        if (len == 0) return false;
+        id = *report++;
+    }
+
+    bool matched = false;
+    for (HID_ReportItem_t* item = info->FirstReportItem; item; item = item->Next) {
+        if (!USB_GetHIDReportItemInfo(id, report, item)) continue;
+
+        uint8_t bits = item->Attributes.BitSize;
+        uint32_t mask = bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+
+        if (item->Attributes.Usage.Page == HID_USAGE_PAGE_BUTTON) {
+            uint16_t usage = item->Attributes.Usage.Usage;
+            if (usage < 1 || usage > MAX_BUTTONS || bits != 1) continue;
+            state->buttons &= ~(1u << (usage - 1));
+            state->buttons |= (item->Value & 1) << (usage - 1);
+            matched = true;
+            continue;
+        }
+
+        int field = item->Attributes.Usage.Page == HID_USAGE_PAGE_DESKTOP ?
+                    ref_axis_field(item->Attributes.Usage.Usage) : -1;
+        if (field < 0 || bits == 0 || bits > 16) continue;
+
+        int32_t min = (int32_t)item->Attributes.Logical.Minimum;
+        int64_t range = (int64_t)(int32_t)item->Attributes.Logical.Maximum - min;
+        if (range > mask) range = mask;
+        if (range < 2) continue;
+
+        // Sign-extend when the logical range is signed, then offset from min
+        int32_t raw = (int32_t)item->Value;
+        if (min < 0 && (raw & (1 << (bits - 1)))) raw -= (1 << bits);
+        uint32_t value = (uint32_t)((int64_t)raw - min) & mask;
+
+        if (field == HID_FIELD_HAT) {
+            state->hat = (value <= 7 && value <= (uint32_t)range) ? (uint8_t)value : 8;
+        } else {
+            state->axis[field] = ref_scale(value, (uint32_t)range);
+        }
+        matched = true;
+    }
+    return matched;
+}
+
+static void verify_reference(const bench_desc_t* d)
+{
+    HID_ReportInfo_t* info = parse(d->desc, d->len);
+    if (!info) {
+        check(d->name, 1, 1);
+        return;
+    }
+
+    hid_extract_plan_t plan;
+    hid_extract_compile(info, &plan);
+
+    hid_extract_state_t ref, out;
+    hid_extract_reset_state(&ref);
+    hid_extract_reset_state(&out);
+
+    uint32_t mismatches = 0;
+    uint8_t report[REPORT_MAX_LEN];
+
+    for (uint32_t i = 0; i < VERIFY_REPORTS; i++) {
+        random_bytes(report, sizeof(report));
+        if (info->UsingReportIDs) report[0] = (uint8_t)(1 + check_rng() % 4);
+
+        bool ref_ok = ref_decode(info, report, sizeof(report), &ref);
+        bool out_ok = hid_extract_run(&plan, report, sizeof(report), &out);
+
+        bool bad = ref_ok != out_ok || ref.hat != out.hat || ref.buttons != out.buttons;
+        for (int a = 0; a < HID_FIELD_AXIS_COUNT; a++) {
+            int diff = (int)ref.axis[a] - (int)out.axis[a];
+            if (diff == 0) continue;
+            if (!d->exact && (diff == 1 || diff == -1)) {
+                // Wide axes may round 1 LSB apart; don't carry it forward
+                out.axis[a] = ref.axis[a];
+            } else {
+                bad = true;
+            }
+        }
+        if (bad) {
+            mismatches++;
+            out = ref;
+        }
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s (%u ops, %u rpt, %u B arena)", d->name, plan.op_count,
+             plan.report_count, USB_GetHIDReportInfoSize(1, 0, d->desc, d->len));
+    check(label, mismatches, VERIFY_REPORTS);
+
+    free(info);
+}
+
+// Report IDs: unknown IDs and ID-only reports are ignored, partial reports
+// only update their own fields
+static void verify_report_ids(void)
+{
+    HID_ReportInfo_t* info = parse(desc_multi_id, sizeof(desc_multi_id));
+    hid_extract_plan_t plan;
+    hid_extract_compile(info, &plan);
+    free(info);
+
+    hid_extract_state_t st;
+    hid_extract_reset_state(&st);
+    uint32_t bad = 0;
+
+    const uint8_t sticks[] = { 0x01, 0x00, 0xFF, 0x02, 0x05 };
+    const uint8_t triggers[] = { 0x02, 0x80, 0xFF };
+    const uint8_t consumer[] = { 0x03, 0x03 };
+    const uint8_t unknown[] = { 0x09, 0x00, 0x00, 0x00, 0x00 };
+
+    if (!hid_extract_run(&plan, sticks, sizeof(sticks), &st)) bad++;
+    if (st.axis[HID_FIELD_X] != 1 || st.axis[HID_FIELD_Y] != 255 || st.hat != 2 || st.buttons != 0x05) bad++;
+    if (st.axis[HID_FIELD_RX] != 0 || st.axis[HID_FIELD_RY] != 0) bad++;
+
+    if (!hid_extract_run(&plan, triggers, sizeof(triggers), &st)) bad++;
+    if (st.axis[HID_FIELD_RX] != 128 || st.axis[HID_FIELD_RY] != 255) bad++;
+    if (st.axis[HID_FIELD_X] != 1 || st.buttons != 0x05) bad++;
+
+    if (hid_extract_run(&plan, consumer, sizeof(consumer), &st)) bad++;
+    if (hid_extract_run(&plan, unknown, sizeof(unknown), &st)) bad++;
+    if (hid_extract_run(&plan, sticks, 3, &st)) bad++;     // Short report
+    if (hid_extract_run(&plan, sticks, 0, &st)) bad++;
+
+    check("multi report ID routing", bad, 10);
+}
+
+// ============================================================================
+// LEGACY EXTRACTOR (byteIndex/bitMask, as previously in hid_gamepad.c)
+// ============================================================================
+
+typedef struct {
+    uint8_t byteIndex;
+    uint16_t bitMask;
+    uint32_t max;
+} legacy_usage_t;
+
+typedef struct {
+    legacy_usage_t axis[HID_FIELD_AXIS_COUNT];
+    legacy_usage_t hat;
+    legacy_usage_t button[MAX_BUTTONS];
+} legacy_layout_t;
+
+static void legacy_compile(HID_ReportInfo_t* info, legacy_layout_t* l)
+{
+    memset(l, 0, sizeof(*l));
+    uint8_t idOffset = info->FirstReportItem->ReportID ? 8 : 0;
+
+    for (HID_ReportItem_t* item = info->FirstReportItem; item; item = item->Next) {
+        uint8_t bitSize = item->Attributes.BitSize;
+        uint8_t bitOffset = item->BitOffset + idOffset;
+        legacy_usage_t loc = {
+            .byteIndex = bitOffset / 8,
+            .bitMask = (uint16_t)((0xFFFF >> (16 - bitSize)) << bitOffset % 8),
+            .max = item->Attributes.Logical.Maximum,
+        };
+
+        if (item->Attributes.Usage.Page == HID_USAGE_PAGE_BUTTON) {
+            uint8_t usage = item->Attributes.Usage.Usage;
+            if (usage >= 1 && usage <= MAX_BUTTONS) l->button[usage - 1] = loc;
+        } else if (item->Attributes.Usage.Page == HID_USAGE_PAGE_DESKTOP) {
+            int field = ref_axis_field(item->Attributes.Usage.Usage);
+            if (field == HID_FIELD_HAT) l->hat = loc;
+            else if (field >= 0) l->axis[field] = loc;
+        }
+    }
+}
+
+static uint8_t legacy_scale(uint16_t value, uint32_t max_value)
+{
+    int mid_point = max_value / 2;
+    if (value <= mid_point) return 1 + (value * 127) / mid_point;
+    return 128 + ((value - mid_point) * 127) / (max_value - mid_point);
+}
+
+static inline uint8_t legacy_axis(const legacy_usage_t* loc, const uint8_t* report, uint8_t fallback)
+{
+    uint16_t value = 0;
+    if (loc->bitMask > 0xFF) {
+        uint16_t combined = ((uint16_t)report[loc->byteIndex] << 8) | report[loc->byteIndex + 1];
+        value = (combined & loc->bitMask) >> __builtin_ctz(loc->bitMask);
+    } else if (loc->bitMask) {
+        value = report[loc->byteIndex] & loc->bitMask;
+    }
+    return loc->max ? legacy_scale(value, loc->max) : fallback;
+}
+
+static void legacy_process(const legacy_layout_t* l, const uint8_t* report, hid_extract_state_t* st)
+{
+    st->axis[HID_FIELD_X] = legacy_axis(&l->axis[HID_FIELD_X], report, 128);
+    st->axis[HID_FIELD_Y] = legacy_axis(&l->axis[HID_FIELD_Y], report, 128);
+    st->axis[HID_FIELD_Z] = legacy_axis(&l->axis[HID_FIELD_Z], report, 128);
+    st->axis[HID_FIELD_RZ] = legacy_axis(&l->axis[HID_FIELD_RZ], report, 128);
+    st->axis[HID_FIELD_RX] = legacy_axis(&l->axis[HID_FIELD_RX], report, 0);
+    st->axis[HID_FIELD_RY] = legacy_axis(&l->axis[HID_FIELD_RY], report, 0);
+
+    uint8_t hat = report[l->hat.byteIndex] & l->hat.bitMask;
+    st->hat = l->hat.bitMask ? (hat <= 8 ? hat : 8) : 8;
+
+    st->buttons = 0;
+    for (int i = 0; i < MAX_BUTTONS; i++) {
+        if (report[l->button[i].byteIndex] & l->button[i].bitMask) st->buttons |= (1u << i);
+    }
+}
+
+static uint8_t report_pool[REPORT_POOL_SIZE][REPORT_MAX_LEN];
+
+static void verify_and_time_legacy(void)
+{
+    HID_ReportInfo_t* info = parse(desc_dragonrise, sizeof(desc_dragonrise));
+    legacy_layout_t legacy;
+    hid_extract_plan_t plan;
+    legacy_compile(info, &legacy);
+    hid_extract_compile(info, &plan);
+
+    const uint16_t len = 8;  // DragonRise input report size
+    uint32_t mismatches = 0;
+    hid_extract_state_t a, b;
+    hid_extract_reset_state(&b);
+
+    for (uint32_t i = 0; i < VERIFY_REPORTS; i++) {
+        uint8_t report[8];
+        random_bytes(report, len);
+        legacy_process(&legacy, report, &a);
+        hid_extract_run(&plan, report, len, &b);
+        if (memcmp(a.axis, b.axis, sizeof(a.axis)) || a.hat != b.hat || a.buttons != b.buttons) {
+            mismatches++;
+            b = a;
+        }
+    }
+    check("dragonrise: plan vs legacy extractor", mismatches, VERIFY_REPORTS);
+
+    for (uint32_t i = 0; i < REPORT_POOL_SIZE; i++) random_bytes(report_pool[i], len);
+
+    // The item walk is much slower; time it over fewer reports
+    const uint32_t walk_reports = TIMED_REPORTS / 10;
+
+    quiet_begin();
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < walk_reports; i++) {
+        ref_decode(info, report_pool[i & (REPORT_POOL_SIZE - 1)], len, &a);
+        bench_sink ^= a.axis[HID_FIELD_X] ^ a.buttons ^ a.hat;
+    }
+    uint64_t t1 = now_ns();
+    for (uint32_t i = 0; i < TIMED_REPORTS; i++) {
+        legacy_process(&legacy, report_pool[i & (REPORT_POOL_SIZE - 1)], &a);
+        bench_sink ^= a.axis[HID_FIELD_X] ^ a.buttons ^ a.hat;
+    }
+    uint64_t t2 = now_ns();
+    for (uint32_t i = 0; i < TIMED_REPORTS; i++) {
+        hid_extract_run(&plan, report_pool[i & (REPORT_POOL_SIZE - 1)], len, &b);
+        bench_sink ^= b.axis[HID_FIELD_X] ^ b.buttons ^ b.hat;
+    }
+    uint64_t t3 = now_ns();
+    quiet_end();
+    free(info);
+
+    check_section("dragonrise report decode");
+    check_value("HID_ReportItem walk", (double)(t1 - t0) / walk_reports, "ns/report");
+    check_value("legacy byteIndex/bitMask", (double)(t2 - t1) / TIMED_REPORTS, "ns/report");
+    check_value("extraction plan", (double)(t3 - t2) / TIMED_REPORTS, "ns/report");
+}
+
+// ============================================================================
+// FUZZING
+// ============================================================================
+
+// Plan invariants: ops within bounds, per-report slices tile the op array
+static bool plan_valid(const hid_extract_plan_t* plan)
+{
+    if (plan->op_count > HID_EXTRACT_MAX_OPS || plan->report_count > HID_EXTRACT_MAX_REPORTS) return false;
+
+    uint8_t next = 0;
+    for (uint8_t r = 0; r < plan->report_count; r++) {
+        const hid_extract_report_t* rep = &plan->reports[r];
+        if (rep->first_op != next || rep->op_count == 0) return false;
+        if (r > 0 && rep->report_id <= plan->reports[r - 1].report_id) return false;
+        for (uint8_t i = rep->first_op; i < rep->first_op + rep->op_count; i++) {
+            const hid_extract_op_t* op = &plan->ops[i];
+            if (op->bit_size == 0 || op->bit_size > 16) return false;
+            if ((op->bit_offset + op->bit_size + 7) / 8 > rep->min_len) return false;
+            if (op->field == HID_FIELD_BUTTONS && op->shift + op->bit_size > MAX_BUTTONS) return false;
+        }
+        next += rep->op_count;
+    }
+    return next == plan->op_count;
+}
+
+static bool state_valid(const hid_extract_state_t* st)
+{
+    if (st->hat > 8 || (st->buttons >> MAX_BUTTONS)) return false;
+    for (int a = 0; a < HID_FIELD_AXIS_COUNT; a++) {
+        uint8_t def = (a == HID_FIELD_RX || a == HID_FIELD_RY) ? 0 : 128;
+        if (st->axis[a] == 0 && def != 0) return false;
+    }
+    return true;
+}
+
+// Runs random-length reports over a plan; reports are copied into an exact
+// size heap buffer so out-of-bounds reads trip sanitizers/valgrind
+static uint32_t fuzz_reports(const hid_extract_plan_t* plan, uint32_t count)
+{
+    uint32_t bad = 0;
+    hid_extract_state_t st;
+    hid_extract_reset_state(&st);
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t len = (uint16_t)(check_rng() % (REPORT_MAX_LEN + 1));
+        uint8_t* report = malloc(len ? len : 1);
+        random_bytes(report, len);
+        if (len && plan->using_report_ids && (check_rng() & 1) && plan->report_count) {
+            report[0] = plan->reports[check_rng() % plan->report_count].report_id;
+        }
+        hid_extract_run(plan, report, len, &st);
+        if (!state_valid(&st)) bad++;
+        free(report);
+    }
+    return bad;
+}
+
+// Random but well-formed descriptor: a handful of input mains with random
+// report IDs, sizes, counts, pages, usages and logical ranges
+static uint16_t random_descriptor(uint8_t* d)
+{
+    static const uint8_t usages[] = { 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x39, 0x36, 0x90 };
+    uint16_t n = 0;
+    bool ids = check_rng() & 1;
+
+    d[n++] = 0x05; d[n++] = 0x01; d[n++] = 0x09; d[n++] = 0x05; d[n++] = 0xA1; d[n++] = 0x01;
+
+    uint8_t mains = 1 + check_rng() % 6;
+    for (uint8_t m = 0; m < mains; m++) {
+        if (ids) { d[n++] = 0x85; d[n++] = (uint8_t)(1 + check_rng() % 6); }
+
+        uint8_t count = 1 + check_rng() % 4;
+        uint8_t size = 1 + check_rng() % 20;
+        uint32_t page = check_rng() % 3;
+
+        if (page == 0) {
+            d[n++] = 0x05; d[n++] = 0x01;
+            for (uint8_t u = 0; u < count; u++) { d[n++] = 0x09; d[n++] = usages[check_rng() % sizeof(usages)]; }
+        } else if (page == 1) {
+            uint8_t first = 1 + check_rng() % 14;
+            d[n++] = 0x05; d[n++] = 0x09;
+            d[n++] = 0x19; d[n++] = first; d[n++] = 0x29; d[n++] = (uint8_t)(first + count - 1);
+            if (check_rng() & 1) size = 1;
+        } else {
+            d[n++] = 0x06; d[n++] = 0x00; d[n++] = 0xFF; d[n++] = 0x09; d[n++] = 0x01;
+        }
+
+        // Logical min/max with 1, 2 or 4 byte encodings (signed and unsigned)
+        for (int k = 0; k < 2; k++) {
+            uint32_t v = check_rng();
+            switch (check_rng() % 3) {
+                case 0: d[n++] = k ? 0x25 : 0x15; d[n++] = (uint8_t)v; break;
+                case 1: d[n++] = k ? 0x26 : 0x16; d[n++] = (uint8_t)v; d[n++] = (uint8_t)(v >> 8); break;
+                default:
+                    d[n++] = k ? 0x27 : 0x17;
+                    d[n++] = (uint8_t)v; d[n++] = (uint8_t)(v >> 8); d[n++] = (uint8_t)(v >> 16); d[n++] = (uint8_t)(v >> 24);
+                    break;
+            }
+        }
+
+        d[n++] = 0x75; d[n++] = size;
+        d[n++] = 0x95; d[n++] = count;
+        d[n++] = 0x81; d[n++] = (check_rng() % 8) ? 0x02 : 0x03;
+    }
+
+    d[n++] = 0xC0;
+    return n;
+}
+
+static void fuzz(void)
+{
+    uint32_t bad = 0;
+    hid_extract_plan_t plan;
+
+    // Known descriptors, random report lengths and IDs
+    for (size_t i = 0; i < BENCH_DESC_COUNT; i++) {
+        HID_ReportInfo_t* info = parse(bench_descs[i].desc, bench_descs[i].len);
+        hid_extract_compile(info, &plan);
+        free(info);
+        bad += fuzz_reports(&plan, VERIFY_REPORTS / 4);
+    }
+    check("fuzz reports (shipped layouts)", bad, (uint32_t)(BENCH_DESC_COUNT * (VERIFY_REPORTS / 4)));
+
+    // Mutated descriptors
+    uint32_t parsed = 0, invalid = 0;
+    bad = 0;
+    for (uint32_t i = 0; i < FUZZ_DESCRIPTORS; i++) {
+        uint8_t desc[256];
+        uint16_t len = random_descriptor(desc);
+        HID_ReportInfo_t* info = parse(desc, len);
+        if (!info) continue;
+        parsed++;
+
+        hid_extract_compile(info, &plan);
+        free(info);
+        if (!plan_valid(&plan)) invalid++;
+        bad += fuzz_reports(&plan, 32);
+    }
+    check("fuzz descriptors: plan invariants", invalid, parsed);
+    check("fuzz descriptors: decoded state", bad, parsed * 32);
+
+    // Arena sizing: the measured size is exact, one byte less fails cleanly
+    uint32_t sizing = 0;
+    for (size_t i = 0; i < BENCH_DESC_COUNT; i++) {
+        const bench_desc_t* d = &bench_descs[i];
+        uint32_t size = USB_GetHIDReportInfoSize(1, 0, d->desc, d->len);
+        uint8_t* arena = malloc(size);
+        HID_ReportInfo_t* info = NULL;
+        if (USB_ProcessHIDReport(1, 0, d->desc, d->len, arena, size - 1, &info) != HID_PARSE_InsufficientArena) sizing++;
+        if (USB_ProcessHIDReport(1, 0, d->desc, d->len, arena, size, &info) != HID_PARSE_Successful) sizing++;
+        else if ((void*)info != arena) sizing++;
+        free(arena);
+    }
+    check("arena sizing (exact, exact - 1)", sizing, (uint32_t)(BENCH_DESC_COUNT * 2));
+
+    // Raw random bytes and truncated descriptors: must fail or parse cleanly
+    parsed = 0;
+    invalid = 0;
+    for (uint32_t i = 0; i < FUZZ_DESCRIPTORS; i++) {
+        uint8_t desc[256];
+        uint16_t len;
+        if (i & 1) {
+            len = (uint16_t)(check_rng() % sizeof(desc));
+            random_bytes(desc, len);
+        } else {
+            const bench_desc_t* d = &bench_descs[check_rng() % BENCH_DESC_COUNT];
+            len = (uint16_t)(check_rng() % d->len);
+            memcpy(desc, d->desc, len);
+            if (len) desc[check_rng() % len] ^= (uint8_t)(1u << (check_rng() % 8));
+        }
+
+        // Exact-size heap copy so reads past the end trip sanitizers
+        uint8_t* copy = malloc(len ? len : 1);
+        memcpy(copy, desc, len);
+        HID_ReportInfo_t* info = parse(copy, len);
+        free(copy);
+        if (!info) continue;
+        parsed++;
+
+        hid_extract_compile(info, &plan);
+        free(info);
+        if (!plan_valid(&plan)) invalid++;
+    }
+    check("fuzz raw descriptors: plan invariants", invalid, parsed);
+
+    // No descriptor at all (failed parse) must give an empty plan
+    hid_extract_compile(NULL, &plan);
+    uint8_t report[4] = { 0 };
+    hid_extract_state_t st;
+    check("empty plan rejects reports", hid_extract_run(&plan, report, sizeof(report), &st) ? 1 : 0, 1);
+}
+
+void checks_hid(void)
+{
+    for (size_t i = 0; i < BENCH_DESC_COUNT; i++) {
+        verify_reference(&bench_descs[i]);
+    }
+    verify_report_ids();
+    fuzz();
+    verify_and_time_legacy();
+}
@@ -0,0 +1,176 @@
+// profile.c - Compiled vs interpreted profile_apply
+//
+// For each shipped profile, checks that profile_apply_compiled() produces the
+// same profile_output_t as profile_apply_interpreted() over a random input
+// stream, then times both forms. Profiles beyond the compile limits stay
+// interpreted and are skipped. Also checks that a profile switch is served
+// from the replaced table on the other core until that core compiles it.
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "core/services/profiles/profile.h"
+#include "core/services/profiles/profile_compile.h"
+#include "apps/usb2gc/profiles.h"
+#include "apps/usb23do/profiles.h"
+#include "apps/snes2usb/profiles.h"
+#include "checks.h"
+#include "../bench_util.h"
+
+#define VERIFY_APPLIES      200000u     // Random inputs compared per profile
+#define TIMED_APPLIES       2000000u    // Applies per profile and form
+#define INPUT_POOL_SIZE     4096u       // Pre-generated inputs (power of 2)
+
+typedef struct {
+    const char* set;
+    const profile_set_t* profiles;
+} check_set_t;
+
+static const check_set_t check_sets[] = {
+    { "usb2gc",   &gc_profile_set       },
+    { "usb23do",  &tdo_profile_set      },
+    { "snes2usb", &snes2usb_profile_set },
+};
+
+#define CHECK_SET_COUNT (sizeof(check_sets) / sizeof(check_sets[0]))
+
+typedef struct {
+    uint32_t buttons;
+    uint8_t axes[6];
+} check_input_t;
+
+static check_input_t input_pool[INPUT_POOL_SIZE];
+
+// Sink so the compiler can't drop results
+static volatile uint32_t bench_sink;
+
+// Random buttons (including combos and Select) and full-range axes
+static void random_input(check_input_t* in)
+{
+    uint32_t r = check_rng();
+    in->buttons = (r & 0x3) ? (check_rng() & 0x0003FFFF) : (1u << (check_rng() % 18));
+    if ((r & 0xF0) == 0) in->buttons |= check_rng();
+    for (int i = 0; i < 6; i++) {
+        in->axes[i] = (uint8_t)check_rng();
+    }
+}
+
+static bool outputs_equal(const profile_output_t* a, const profile_output_t* b)
+{
+    return a->buttons == b->buttons &&
+           a->left_x == b->left_x && a->left_y == b->left_y &&
+           a->right_x == b->right_x && a->right_y == b->right_y &&
+           a->l2_analog == b->l2_analog && a->r2_analog == b->r2_analog &&
+           a->left_x_override == b->left_x_override &&
+           a->left_y_override == b->left_y_override &&
+           a->right_x_override == b->right_x_override &&
+           a->right_y_override == b->right_y_override &&
+           a->l2_analog_override == b->l2_analog_override &&
+           a->r2_analog_override == b->r2_analog_override;
+}
+
+static uint32_t verify_profile(const profile_t* profile, const profile_compiled_t* compiled)
+{
+    uint32_t mismatches = 0;
+
+    for (uint32_t i = 0; i < VERIFY_APPLIES; i++) {
+        check_input_t in;
+        random_input(&in);
+
+        profile_output_t ref, out;
+        profile_apply_interpreted(profile, in.buttons, in.axes[0], in.axes[1], in.axes[2],
+                                  in.axes[3], in.axes[4], in.axes[5], &ref);
+        profile_apply_compiled(compiled, in.buttons, in.axes[0], in.axes[1], in.axes[2],
+                               in.axes[3], in.axes[4], in.axes[5], &out);
+
+        if (!outputs_equal(&ref, &out)) mismatches++;
+    }
+    return mismatches;
+}
+
+static double time_interpreted(const profile_t* profile)
+{
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < TIMED_APPLIES; i++) {
+        const check_input_t* in = &input_pool[i & (INPUT_POOL_SIZE - 1)];
+        profile_output_t out;
+        profile_apply_interpreted(profile, in->buttons, in->axes[0], in->axes[1], in->axes[2],
+                                  in->axes[3], in->axes[4], in->axes[5], &out);
+        bench_sink ^= out.buttons ^ out.left_x ^ out.right_y;
+    }
+    return (double)(now_ns() - t0) / TIMED_APPLIES;
+}
+
+// What the output devices pay per report: cache lookup + compiled apply
+static double time_compiled(const profile_t* profile)
+{
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < TIMED_APPLIES; i++) {
+        const check_input_t* in = &input_pool[i & (INPUT_POOL_SIZE - 1)];
+        profile_output_t out;
+        profile_apply_compiled(profile_get_compiled(profile), in->buttons,
+                               in->axes[0], in->axes[1], in->axes[2],
+                               in->axes[3], in->axes[4], in->axes[5], &out);
+        bench_sink ^= out.buttons ^ out.left_x ^ out.right_y;
+    }
+    return (double)(now_ns() - t0) / TIMED_APPLIES;
+}
+
+// A switch made on core 0 must not compile on core 1's report path: core 1
+// keeps the replaced profile's table until its output compiles the new one
+static void check_switch(void)
+{
+    const profile_t* from = &gc_profile_set.profiles[1];
+    const profile_t* to = &gc_profile_set.profiles[2];
+    const profile_t* other = &gc_profile_set.profiles[3];
+    uint32_t bad = 0;
+
+    bench_core_num = 1;
+    profile_compile(from);
+    bench_core_num = 0;
+    profile_compile_switch(from, to);
+    bench_core_num = 1;
+
+    const profile_compiled_t* c = profile_get_compiled(to);
+    if (!c || c->source != from) bad++;             // Previous table, no compile
+    if (profile_get_compiled(other) != NULL) bad++; // Not switched to: interpreted
+    profile_compile(to);
+    c = profile_get_compiled(to);
+    if (!c || c->source != to) bad++;
+
+    bench_core_num = 0;
+    check("switch served from the replaced table until compiled", bad, 3);
+}
+
+void checks_profile(void)
+{
+    for (uint32_t i = 0; i < INPUT_POOL_SIZE; i++) {
+        random_input(&input_pool[i]);
+    }
+
+    for (size_t s = 0; s < CHECK_SET_COUNT; s++) {
+        const profile_set_t* set = check_sets[s].profiles;
+
+        for (uint8_t p = 0; p < set->profile_count; p++) {
+            const profile_t* profile = &set->profiles[p];
+            profile_compile(profile);
+            const profile_compiled_t* compiled = profile_get_compiled(profile);
+            if (!compiled) continue;
+
+            char label[64];
+            snprintf(label, sizeof(label), "%s %s", check_sets[s].set, profile->name);
+            check(label, verify_profile(profile, compiled), VERIFY_APPLIES);
+
+            quiet_begin();
+            double interp_ns = time_interpreted(profile);
+            double comp_ns = time_compiled(profile);
+            quiet_end();
+            snprintf(label, sizeof(label), "%s %s interpreted", check_sets[s].set, profile->name);
+            check_value(label, interp_ns, "ns/report");
+            snprintf(label, sizeof(label), "%s %s compiled", check_sets[s].set, profile->name);
+            check_value(label, comp_ns, "ns/report");
+        }
+    }
+
+    check_switch();
+}
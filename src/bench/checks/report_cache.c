@@ -0,0 +1,260 @@
+// report_cache.c - Report change suppression in USB device output
+//
+// Feeds usb/usbd/report_cache.c a 1 kHz controller stream shaped like real
+// play: long idle holds, button presses, bursts of stick movement, stretches
+// with motion data (ext events), and profile switches while the inputs sit
+// still. A DInput-style report is built through profile_apply() on usbd.c's
+// send path: skip the build when the inputs and profile are unchanged, skip
+// the send when the bytes are.
+//
+// Checks that the host always ends up holding the report for the current
+// input (no change lost, profile switches and ext events rebuild), and that
+// an unchanged report still goes out every USBD_REPORT_KEEPALIVE_MS.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "core/services/profiles/profile.h"
+#include "usb/usbd/report_cache.h"
+#include "apps/usb2gc/profiles.h"
+#include "checks.h"
+
+#define STREAM_SECONDS      60u
+#define REPORT_LEN          27      // joypad_hid_report_t
+
+// With the keepalive off, identical reports must never be resent
+#define KEEPALIVE_ON        (USBD_REPORT_KEEPALIVE_MS > 0)
+#define KEEPALIVE_MS        (KEEPALIVE_ON ? USBD_REPORT_KEEPALIVE_MS : 100u)
+
+// ============================================================================
+// INPUT STREAM
+// ============================================================================
+
+typedef struct {
+    input_state_t state;
+    input_ext_t ext;
+    const profile_t* profile;
+} stream_event_t;
+
+static stream_event_t* stream;
+static uint32_t stream_len;
+
+// One event per millisecond
+static void stream_build(uint32_t seconds)
+{
+    stream_len = seconds * 1000u;
+    stream = calloc(stream_len, sizeof(stream_event_t));
+
+    input_state_t s;
+    memset(&s, 0, sizeof(s));
+    for (int i = 0; i < 8; i++) s.analog[i] = (i == 5 || i == 6) ? 0 : 128;
+
+    uint32_t next_button = 200;
+    uint32_t burst_end = 0;
+    uint8_t profile_index = 0;
+
+    for (uint32_t ms = 0; ms < stream_len; ms++) {
+        stream_event_t* e = &stream[ms];
+
+        // Press or release a face button / d-pad direction every 150-400ms
+        if (ms >= next_button) {
+            s.buttons ^= 1u << (check_rng() % 16);
+            next_button = ms + 150 + check_rng() % 250;
+        }
+
+        // Stick movement: ~80ms bursts, a few per second
+        if (ms >= burst_end && check_rng() % 300 == 0) burst_end = ms + 50 + check_rng() % 60;
+        if (ms < burst_end) {
+            s.analog[check_rng() % 4] = (uint8_t)check_rng();
+            if (check_rng() % 4 == 0) s.analog[5] = (uint8_t)check_rng();
+        } else if (ms == burst_end) {
+            for (int i = 0; i < 4; i++) s.analog[i] = 128;  // Sticks recenter
+            s.analog[5] = 0;
+        }
+
+        // Motion for 1s out of every 5: accel/gyro change every report
+        bool motion = (ms / 1000) % 5 == 4;
+        s.flags = motion ? INPUT_STATE_HAS_MOTION : 0;
+        if (motion) {
+            for (int i = 0; i < 3; i++) {
+                e->ext.accel[i] = (int16_t)(check_rng() & 0x3FF);
+                e->ext.gyro[i] = (int16_t)(check_rng() & 0x3FF);
+            }
+        }
+
+        // Profile switch every 7s (inputs usually idle at that moment)
+        if (ms && ms % 7000 == 0) profile_index ^= 1;
+
+        e->state = s;
+        e->profile = &gc_profile_set.profiles[profile_index];
+    }
+}
+
+// ============================================================================
+// REPORT BUILD (shape of usbd_build_hid_report)
+// ============================================================================
+
+static void build_report(uint8_t* report, const stream_event_t* e)
+{
+    profile_output_t out;
+    const input_state_t* s = &e->state;
+    profile_apply(e->profile, s->buttons,
+                  s->analog[0], s->analog[1], s->analog[2], s->analog[3],
+                  s->analog[5], s->analog[6], &out);
+
+    memset(report, 0, REPORT_LEN);
+    memcpy(&report[0], &out.buttons, 3);
+    report[3] = (uint8_t)((out.buttons >> 12) & 0x0F);   // Hat
+    report[4] = out.left_x;
+    report[5] = out.left_y;
+    report[6] = out.right_x;
+    report[7] = out.right_y;
+    report[8] = out.l2_analog;
+    report[9] = out.r2_analog;
+    for (int i = 0; i < 12; i++) {
+        report[10 + i] = (out.buttons & (1u << i)) ? 0xFF : 0x00;  // Pressure axes
+    }
+    if (s->flags & INPUT_STATE_HAS_MOTION) {
+        memcpy(&report[22], e->ext.accel, 4);
+        report[26] = (uint8_t)e->ext.gyro[0];
+    }
+}
+
+// ============================================================================
+// SEND PATH (usbd.c)
+// ============================================================================
+
+// What the USB stack last copied into the endpoint buffer
+static uint8_t host_report[REPORT_LEN];
+
+typedef struct {
+    uint32_t stale;         // Events after which the host holds an old report
+    uint32_t max_gap_ms;    // Longest stretch between sends
+    uint32_t ext_events;
+    uint32_t ext_builds;    // Ext events that rebuilt the report
+} stream_result_t;
+
+static void send_report(const uint8_t* report)
+{
+    memcpy(host_report, report, REPORT_LEN);    // tud_hid_report() copies
+}
+
+static stream_result_t run_stream(void)
+{
+    stream_result_t r = {0};
+    static uint8_t report[REPORT_LEN];     // Persists like the mode's report buffer
+    report_cache_t cache;
+    report_cache_reset(&cache);
+    memset(host_report, 0, sizeof(host_report));
+
+    uint32_t last_send = 0;
+    for (uint32_t ms = 0; ms < stream_len; ms++) {
+        const stream_event_t* e = &stream[ms];
+        bool ext = (e->state.flags & INPUT_STATE_EXT_MASK) != 0;
+
+        if (!report_cache_input_same(&cache, e->profile, &e->state)) {
+            build_report(report, e);
+            if (ext) r.ext_builds++;
+        }
+        if (report_cache_changed(&cache, report, REPORT_LEN, ms)) {
+            send_report(report);
+            report_cache_commit(&cache, report, REPORT_LEN, ms);
+            if (ms - last_send > r.max_gap_ms) r.max_gap_ms = ms - last_send;
+            last_send = ms;
+        }
+
+        uint8_t expected[REPORT_LEN];
+        build_report(expected, e);
+        if (memcmp(expected, host_report, REPORT_LEN) != 0) r.stale++;
+        if (ext) r.ext_events++;
+    }
+
+    return r;
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+// Compare, then commit as if the USB stack accepted the report
+static bool cache_send(report_cache_t* cache, const void* report, uint16_t len, uint32_t ms)
+{
+    if (!report_cache_changed(cache, report, len, ms)) return false;
+    report_cache_commit(cache, report, len, ms);
+    return true;
+}
+
+static void check_cache_unit(void)
+{
+    report_cache_t cache;
+    report_cache_reset(&cache);
+    input_state_t s;
+    memset(&s, 0, sizeof(s));
+    uint8_t a[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    uint8_t big[REPORT_CACHE_MAX + 8] = {0};
+    int p0 = 0, p1 = 0;
+    uint32_t bad = 0;
+
+    bad += report_cache_input_same(&cache, &p0, &s);           // First build
+    bad += !report_cache_input_same(&cache, &p0, &s);          // Unchanged
+    bad += report_cache_input_same(&cache, &p1, &s);           // Profile changed
+    s.analog[7] = 9;
+    bad += report_cache_input_same(&cache, &p1, &s);           // Dial axis changed
+    s.flags = INPUT_STATE_HAS_PRESSURE;
+    bad += report_cache_input_same(&cache, &p1, &s);           // Ext always rebuilds
+    s.flags = 0;
+    bad += report_cache_input_same(&cache, &p1, &s);           // After ext, rebuild once
+    bad += !report_cache_input_same(&cache, &p1, &s);
+    check("input key (profile, buttons, axes, ext)", bad, 7);
+
+    bad = 0;
+    bad += !cache_send(&cache, a, sizeof(a), 1000);   // First report
+    bad += cache_send(&cache, a, sizeof(a), 1001);    // Identical
+    bad += !cache_send(&cache, a, 4, 1002);           // Length changed
+    a[3] ^= 1;
+    bad += !cache_send(&cache, a, 4, 1003);           // Bytes changed
+    bad += cache_send(&cache, a, 4, 1003 + KEEPALIVE_MS - 1);
+    bad += cache_send(&cache, a, 4, 1003 + KEEPALIVE_MS) != KEEPALIVE_ON;
+    bad += !cache_send(&cache, big, sizeof(big), 2000);    // Oversized
+    bad += !cache_send(&cache, big, sizeof(big), 2000);
+    report_cache_reset(&cache);
+    bad += !cache_send(&cache, a, 4, 2001);           // Reset resends
+    check("report compare, keepalive, oversize, reset", bad, 9);
+
+    // A report the USB stack refused is not recorded, so it is retried
+    report_cache_reset(&cache);
+    bad = !cache_send(&cache, a, 4, 3000);
+    a[0] ^= 1;
+    bad += !report_cache_changed(&cache, a, 4, 3001);          // Send refused, no commit
+    bad += !report_cache_changed(&cache, a, 4, 3002);          // Still pending
+    report_cache_commit(&cache, a, 4, 3002);
+    bad += report_cache_changed(&cache, a, 4, 3003);
+    check("refused send retried until committed", bad, 4);
+
+    // Keepalive across the 32-bit millisecond wrap
+    report_cache_reset(&cache);
+    cache_send(&cache, a, 4, 0xFFFFFFF0u);
+    bad = cache_send(&cache, a, 4, 0xFFFFFFF0u + KEEPALIVE_MS / 2);
+    bad += cache_send(&cache, a, 4, 0xFFFFFFF0u + KEEPALIVE_MS) != KEEPALIVE_ON;
+    check("keepalive across millisecond wrap", bad, 2);
+}
+
+void checks_report_cache(void)
+{
+    check_section("cache");
+    check_cache_unit();
+
+    stream_build(STREAM_SECONDS);
+    stream_result_t v = run_stream();
+
+    check_section("1 kHz input stream");
+    check("events leaving the host with a stale report", v.stale, stream_len);
+    check("ext events that skipped the rebuild", v.ext_events - v.ext_builds, v.ext_events);
+    if (KEEPALIVE_ON) {
+        check("longest gap between sends over keepalive (ms)",
+              v.max_gap_ms > KEEPALIVE_MS ? v.max_gap_ms : 0, KEEPALIVE_MS);
+    }
+
+    free(stream);
+}
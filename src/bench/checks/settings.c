@@ -0,0 +1,217 @@
+// settings.c - Key-value settings store checks
+//
+// Runs core/services/storage/settings.c against the host flash stub
+// (flash_save() stores the image in RAM) and feeds every saved image into
+// the settings log (flash_log.c on stubs/flash_sim.c), as flash.c does.
+//
+// Migration: a fixed-field FLASH_MAGIC_V1 image must come back with the
+// same profile, USB mode and poll interval, under FLASH_MAGIC.
+//
+// Records: per-output and per-player values stay separate, values survive
+// a reload, clears restore the fallback, unknown keys from a newer
+// firmware are kept, and a full image refuses new records cleanly.
+//
+// Log cost: an in-place update of one setting should cost one small
+// record in the log, however many settings are stored.
+
+#include <string.h>
+
+#include "core/services/storage/flash.h"
+#include "core/services/storage/flash_log.h"
+#include "core/services/storage/settings.h"
+#include "flash_sim.h"
+#include "../bench_util.h"
+#include "checks.h"
+
+#define LOG_SECTORS     4       // flash.c FLASH_LOG_SECTORS
+#define CHANGES         10000u
+
+// Start over from a given flash image (NULL = blank)
+static void reload(const flash_t* stored)
+{
+    if (stored) {
+        flash_save_now(stored);
+    } else {
+        flash_t blank;
+        memset(&blank, 0, sizeof(blank));
+        blank.magic = FLASH_MAGIC;
+        blank.schema = SETTINGS_SCHEMA;
+        flash_save_now(&blank);
+    }
+    quiet_begin();
+    settings_load();
+    quiet_end();
+}
+
+static void check_migration(void)
+{
+    check_section("migration (fixed-field image)");
+
+    flash_t old;
+    memset(&old, 0, sizeof(old));
+    flash_v1_t* v1 = (flash_v1_t*)&old;
+    v1->magic = FLASH_MAGIC_V1;
+    v1->active_profile_index = 2;
+    v1->usb_output_mode = 5;
+    v1->usb_poll_interval = 4;
+    reload(&old);
+
+    uint32_t bad = 0;
+    for (uint8_t o = 0; o < SETTINGS_MAX_OUTPUTS; o++) {
+        bad += settings_get_u8(SETTING_PROFILE_INDEX, o, 0xFF) != 2;
+    }
+    check("profile index on every output", bad, SETTINGS_MAX_OUTPUTS);
+    check("USB mode and poll interval",
+          (settings_get_u8(SETTING_USB_OUTPUT_MODE, 0, 0xFF) != 5) +
+          (settings_get_u8(SETTING_USB_POLL_INTERVAL, 0, 0xFF) != 4), 2);
+
+    flash_t saved;
+    flash_load(&saved);
+    check("migrated image saved as current schema",
+          saved.magic != FLASH_MAGIC || saved.schema != SETTINGS_SCHEMA, 1);
+
+    // Zero poll interval (mode default) is not stored at all
+    v1->usb_poll_interval = 0;
+    reload(&old);
+    check("default poll interval left unset",
+          settings_get_u8(SETTING_USB_POLL_INTERVAL, 0, 0xEE) != 0xEE, 1);
+}
+
+static void check_records(void)
+{
+    check_section("records");
+    reload(NULL);
+
+    uint32_t bad = 0;
+    for (uint8_t o = 0; o < SETTINGS_MAX_OUTPUTS; o++) {
+        settings_set_u8(SETTING_PROFILE_INDEX, o, o + 10);
+    }
+    for (uint8_t p = 0; p < SETTINGS_MAX_PLAYERS; p++) {
+        settings_set_u8(SETTING_PLAYER_PROFILE, p, p + 20);
+    }
+    settings_set_u8(SETTING_3DO_OUTPUT_MODE, 0, 1);
+    settings_clear(SETTING_PLAYER_PROFILE, 3);
+
+    flash_t saved;
+    flash_load(&saved);
+    reload(&saved);
+    for (uint8_t o = 0; o < SETTINGS_MAX_OUTPUTS; o++) {
+        bad += settings_get_u8(SETTING_PROFILE_INDEX, o, 0xFF) != o + 10;
+    }
+    for (uint8_t p = 0; p < SETTINGS_MAX_PLAYERS; p++) {
+        uint8_t want = (p == 3) ? 0xFF : p + 20;
+        bad += settings_get_u8(SETTING_PLAYER_PROFILE, p, 0xFF) != want;
+    }
+    bad += settings_get_u8(SETTING_3DO_OUTPUT_MODE, 0, 0xFF) != 1;
+    check("per-output / per-player values after reload", bad,
+          SETTINGS_MAX_OUTPUTS + SETTINGS_MAX_PLAYERS + 1);
+
+    check("out-of-range instance rejected",
+          settings_set_u8(SETTING_USB_OUTPUT_MODE, 1, 0) ||
+          settings_set_u8(SETTING_PLAYER_PROFILE, SETTINGS_MAX_PLAYERS, 0), 1);
+
+    // Value of a different length replaces the record
+    uint16_t wide = 0x1234, got = 0;
+    settings_set(SETTING_PROFILE_INDEX, 1, &wide, sizeof(wide));
+    check("resized value replaces record",
+          !settings_get(SETTING_PROFILE_INDEX, 1, &got, sizeof(got)) || got != wide ||
+          settings_get_u8(SETTING_PROFILE_INDEX, 2, 0xFF) != 12, 1);
+
+    // A key from a newer firmware survives loads and edits around it
+    flash_load(&saved);
+    uint16_t used = settings_used();
+    const uint8_t unknown[] = { 200, 0, 3, 0xAA, 0xBB, 0xCC };
+    memcpy(&saved.data[used], unknown, sizeof(unknown));
+    reload(&saved);
+    settings_set_u8(SETTING_USB_OUTPUT_MODE, 0, 7);
+    settings_clear(SETTING_PROFILE_INDEX, 0);
+    flash_load(&saved);
+    bad = 1;
+    for (uint16_t i = 0; i + sizeof(unknown) <= settings_used(); i++) {
+        if (memcmp(&saved.data[i], unknown, sizeof(unknown)) == 0) {
+            bad = 0;
+        }
+    }
+    check("unknown key kept", bad, 1);
+
+    // Fill the image: the store must stop at the end, not overrun it
+    uint8_t big[64];
+    memset(big, 0x5A, sizeof(big));
+    uint32_t stored = 0;
+    quiet_begin();
+    for (uint8_t p = 0; p < SETTINGS_MAX_PLAYERS; p++) {
+        stored += settings_set(SETTING_PLAYER_PROFILE, p, big, sizeof(big));
+    }
+    quiet_end();
+    flash_load(&saved);
+    check("full image refuses records, stays parseable",
+          stored == SETTINGS_MAX_PLAYERS || settings_used() > sizeof(saved.data) ||
+          settings_get_u8(SETTING_USB_OUTPUT_MODE, 0, 0xFF) != 7, 1);
+}
+
+static void check_log_cost(void)
+{
+    static flash_log_t log;
+    static flash_t logged;
+    flash_log_io_t io = {
+        .base = NULL,
+        .sector_size = FLASH_SIM_SECTOR_SIZE,
+        .sectors = LOG_SECTORS,
+        .erase = flash_sim_erase,
+        .program = flash_sim_program,
+    };
+
+    check_section("log cost (single-setting changes, all keys stored)");
+
+    reload(NULL);
+    for (uint8_t o = 0; o < SETTINGS_MAX_OUTPUTS; o++) {
+        settings_set_u8(SETTING_PROFILE_INDEX, o, 1);
+    }
+    for (uint8_t p = 0; p < SETTINGS_MAX_PLAYERS; p++) {
+        settings_set_u8(SETTING_PLAYER_PROFILE, p, 1);
+    }
+    settings_set_u8(SETTING_USB_OUTPUT_MODE, 0, 0);
+    settings_set_u8(SETTING_USB_POLL_INTERVAL, 0, 1);
+    settings_set_u8(SETTING_3DO_OUTPUT_MODE, 0, 0);
+    settings_set_u8(SETTING_3DO_EXTENSION_MODE, 0, 0);
+
+    flash_sim_init(LOG_SECTORS);
+    io.base = flash_sim_base();
+    memset(&logged, 0, sizeof(logged));
+    flash_log_mount(&log, &io, (uint8_t*)&logged, sizeof(logged));
+
+    flash_t next;
+    flash_load(&next);
+    flash_log_append(&log, (const uint8_t*)&next);
+    memset(&log.stats, 0, sizeof(log.stats));
+
+    uint32_t mismatched = 0;
+    uint32_t saves = 0;
+    for (uint32_t i = 0; i < CHANGES; i++) {
+        uint8_t value = (uint8_t)(1 + check_rng() % 200);
+        switch (check_rng() % 4) {
+            case 0: settings_set_u8(SETTING_PROFILE_INDEX, check_rng() % SETTINGS_MAX_OUTPUTS, value); break;
+            case 1: settings_set_u8(SETTING_PLAYER_PROFILE, check_rng() % SETTINGS_MAX_PLAYERS, value); break;
+            case 2: settings_set_u8(SETTING_USB_OUTPUT_MODE, 0, value); break;
+            default: settings_set_u8(SETTING_3DO_OUTPUT_MODE, 0, value); break;
+        }
+        flash_load(&next);
+        if (memcmp(&next, &logged, sizeof(next)) != 0) {
+            flash_log_append(&log, (const uint8_t*)&next);
+            saves++;
+        }
+        mismatched += memcmp(&next, &logged, sizeof(next)) != 0;
+        mismatched += settings_get_u8(SETTING_PLAYER_PROFILE, SETTINGS_MAX_PLAYERS - 1, 0) == 0;
+    }
+
+    double per_save = saves ? (double)log.stats.bytes / saves : 0;
+    check("logged image tracks settings", mismatched, CHANGES);
+    check("in-place update costs one small record", per_save > 16.0, 1);
+}
+
+void checks_settings(void)
+{
+    check_migration();
+    check_records();
+    check_log_cost();
+}
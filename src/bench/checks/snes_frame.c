@@ -0,0 +1,296 @@
+// snes_frame.c - SNES port sample frame decoding and multitap
+//
+// Builds the line samples the SNES host PIO program (snes_host.pio) pushes
+// for a frame, from a model of what sits on the port: nothing, an SNES pad,
+// an NES pad, a mouse, or a multitap with up to four pads on it. Checks:
+//
+//   - snes_frame_decode() returns every port's device type, buttons and
+//     mouse motion for random port contents, with and without a multitap
+//   - replaying 1 kHz sample streams (holds, presses, plugging pads into
+//     the multitap, mouse sweeps repeating one delta) through
+//     snes_frame_update() leaves a router model in the same state after
+//     every frame as submitting every port on every frame
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "native/host/snes/snes_frame.h"
+#include "checks.h"
+
+#define REPLAY_FRAMES       200000u
+#define RANDOM_CASES        100000u
+
+// ============================================================================
+// PORT MODEL
+// ============================================================================
+
+typedef struct {
+    bool multitap;
+    snes_pad_state_t pads[SNES_MAX_PORTS];
+} port_model_t;
+
+// Sign-magnitude mouse axis, direction bit first then magnitude MSB first
+static uint32_t mouse_axis_bits(int8_t v)
+{
+    uint32_t mag = (uint32_t)(v < 0 ? -v : v) & 0x7F;
+    uint32_t bits = v < 0 ? 1u : 0u;
+    for (int i = 0; i < 7; i++) {
+        bits |= ((mag >> (6 - i)) & 1u) << (i + 1);
+    }
+    return bits;
+}
+
+// Bits a device shifts out (1 = pressed/driven low), clock n at bit n
+static uint64_t device_stream(const snes_pad_state_t* pad)
+{
+    switch (pad->type) {
+    case SNES_DEVICE_CONTROLLER:
+        return (pad->buttons & 0x0FFFu) | 0xFFFFFFFFFFFF0000ull;
+    case SNES_DEVICE_NES:
+        return (pad->buttons & 0x00FFu) | 0xFFFFFFFFFFFFFF00ull;
+    case SNES_DEVICE_MOUSE:
+        return (pad->buttons & (SNES_MOUSE_BIT_LEFT | SNES_MOUSE_BIT_RIGHT)) | 0x8000u |
+               (uint64_t)mouse_axis_bits(pad->dy) << 16 |
+               (uint64_t)mouse_axis_bits(pad->dx) << 24;
+    default:
+        return 0;
+    }
+}
+
+// Line samples for one frame, as the PIO program packs them (1 = line high)
+static void frame_encode(const port_model_t* m, uint32_t* words)
+{
+    uint64_t d0 = 0, d1 = 0;
+    int a = SNES_FRAME_DETECT;
+    int b = SNES_FRAME_DETECT + SNES_FRAME_PHASE_A;
+    uint64_t s0 = device_stream(&m->pads[0]);
+
+    // While latched a pad shows its first bit; a multitap pulls DATA1 low
+    for (int i = 0; i < SNES_FRAME_DETECT; i++) {
+        d0 |= (s0 & 1u) << i;
+        if (m->multitap) d1 |= 1ull << i;
+    }
+    if (m->multitap) {
+        d0 |= (s0 & 0xFFFFFFFFull) << a;
+        d1 |= (device_stream(&m->pads[1]) & 0xFFFFFFFFull) << a;
+        d0 |= (device_stream(&m->pads[2]) & 0xFFFFFFull) << b;
+        d1 |= (device_stream(&m->pads[3]) & 0xFFFFFFull) << b;
+    } else {
+        d0 |= s0 << a;      // Keeps shifting through phase B
+    }
+
+    for (int w = 0; w < SNES_FRAME_WORDS; w++) {
+        uint32_t word = 0;
+        for (int k = 0; k < 16; k++) {
+            int n = w * 16 + k;
+            word |= (uint32_t)((~d0 >> n) & 1u) << (2 * k);
+            word |= (uint32_t)((~d1 >> n) & 1u) << (2 * k + 1);
+        }
+        words[w] = word;
+    }
+}
+
+static void random_pad(snes_pad_state_t* pad, bool allow_mouse)
+{
+    memset(pad, 0, sizeof(*pad));
+    uint32_t r = check_rng() % 10;
+    if (r < 2) {
+        pad->type = SNES_DEVICE_NONE;
+    } else if (r < 7) {
+        pad->type = SNES_DEVICE_CONTROLLER;
+        pad->buttons = (uint16_t)(check_rng() & 0x0FFF);
+    } else if (r < 9 || !allow_mouse) {
+        pad->type = SNES_DEVICE_NES;
+        pad->buttons = (uint16_t)(check_rng() & 0x00FF);
+    } else {
+        pad->type = SNES_DEVICE_MOUSE;
+        pad->buttons = (uint16_t)(check_rng() & (SNES_MOUSE_BIT_LEFT | SNES_MOUSE_BIT_RIGHT));
+        pad->dx = (int8_t)((int)(check_rng() % 255) - 127);
+        pad->dy = (int8_t)((int)(check_rng() % 255) - 127);
+    }
+}
+
+static bool pad_equal(const snes_pad_state_t* a, const snes_pad_state_t* b)
+{
+    return a->type == b->type && a->buttons == b->buttons && a->dx == b->dx && a->dy == b->dy;
+}
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+static void check_decode(void)
+{
+    uint32_t bad = 0, bad_tap = 0;
+    for (uint32_t n = 0; n < RANDOM_CASES; n++) {
+        port_model_t m;
+        memset(&m, 0, sizeof(m));
+        m.multitap = (check_rng() & 1) != 0;
+        // Mice need 32 clocks: port 0 always, port 1 on the multitap too
+        random_pad(&m.pads[0], true);
+        for (int i = 1; i < SNES_MAX_PORTS; i++) {
+            if (m.multitap) random_pad(&m.pads[i], i == 1);
+            else m.pads[i].type = SNES_DEVICE_NONE;
+        }
+
+        uint32_t words[SNES_FRAME_WORDS];
+        frame_encode(&m, words);
+
+        snes_pad_state_t pads[SNES_MAX_PORTS];
+        bool tap = snes_frame_decode(words, pads);
+        if (tap != m.multitap) bad_tap++;
+        for (int i = 0; i < SNES_MAX_PORTS; i++) {
+            if (!pad_equal(&pads[i], &m.pads[i])) {
+                bad++;
+                break;
+            }
+        }
+    }
+    check("multitap detected wrong", bad_tap, RANDOM_CASES);
+    check("frames with a port decoded wrong", bad, RANDOM_CASES);
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+typedef struct {
+    int8_t type[SNES_MAX_PORTS];
+    uint16_t buttons[SNES_MAX_PORTS];
+    int32_t mouse_x[SNES_MAX_PORTS];
+    int32_t mouse_y[SNES_MAX_PORTS];
+    uint32_t submits;
+} router_model_t;
+
+static void router_submit(router_model_t* r, int port, const snes_pad_state_t* pad)
+{
+    r->type[port] = pad->type;
+    r->buttons[port] = pad->buttons;
+    r->mouse_x[port] += pad->dx;
+    r->mouse_y[port] += pad->dy;
+    r->submits++;
+}
+
+typedef struct {
+    const char* name;
+    bool multitap;
+    int8_t types[SNES_MAX_PORTS];
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "SNES pad",            false, { SNES_DEVICE_CONTROLLER, -1, -1, -1 } },
+    { "NES pad",             false, { SNES_DEVICE_NES, -1, -1, -1 } },
+    { "mouse",               false, { SNES_DEVICE_MOUSE, -1, -1, -1 } },
+    { "multitap, 2 pads",    true,  { SNES_DEVICE_CONTROLLER, SNES_DEVICE_CONTROLLER, -1, -1 } },
+    { "multitap, 4 pads",    true,  { SNES_DEVICE_CONTROLLER, SNES_DEVICE_CONTROLLER,
+                                      SNES_DEVICE_CONTROLLER, SNES_DEVICE_CONTROLLER } },
+    { "multitap, hotplug",   true,  { SNES_DEVICE_CONTROLLER, SNES_DEVICE_NES,
+                                      SNES_DEVICE_CONTROLLER, -1 } },
+};
+#define NUM_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+// One millisecond of play: holds, with presses and mouse sweeps
+static void model_step(port_model_t* m, const scenario_t* s, int* burst)
+{
+    for (int i = 0; i < SNES_MAX_PORTS; i++) {
+        snes_pad_state_t* pad = &m->pads[i];
+        uint32_t r = check_rng() % 10000;
+        if (s == &scenarios[5] && i == 3 && r < 5) {
+            // Pad 4 plugged in and out of the multitap
+            pad->type = pad->type == SNES_DEVICE_NONE ? SNES_DEVICE_CONTROLLER : SNES_DEVICE_NONE;
+            pad->buttons = 0;
+        }
+        switch (pad->type) {
+        case SNES_DEVICE_CONTROLLER:
+            if (r < 40) pad->buttons = (uint16_t)(check_rng() & 0x0FFF);
+            break;
+        case SNES_DEVICE_NES:
+            if (r < 40) pad->buttons = (uint16_t)(check_rng() & 0x00FF);
+            break;
+        case SNES_DEVICE_MOUSE:
+            if (r < 20) pad->buttons = (uint16_t)(check_rng() & (SNES_MOUSE_BIT_LEFT | SNES_MOUSE_BIT_RIGHT));
+            if (burst[i] == 0 && r >= 9900) burst[i] = 20 + check_rng() % 200;
+            if (burst[i]) {
+                // A steady sweep repeats one delta for many samples
+                burst[i]--;
+                pad->dx = (int8_t)((burst[i] / 50) % 2 ? 2 : -1);
+                pad->dy = (int8_t)(burst[i] % 3 == 0 ? 1 : 0);
+            } else {
+                pad->dx = 0;
+                pad->dy = 0;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Frames after which the changed-only router model differs from submitting
+// every port on every frame
+static uint32_t replay(const scenario_t* s, uint32_t frames)
+{
+    uint32_t mismatches = 0;
+    uint32_t* trace = malloc((size_t)frames * SNES_FRAME_WORDS * sizeof(uint32_t));
+    port_model_t m;
+    int burst[SNES_MAX_PORTS] = { 0 };
+    memset(&m, 0, sizeof(m));
+    m.multitap = s->multitap;
+    for (int i = 0; i < SNES_MAX_PORTS; i++) m.pads[i].type = s->types[i];
+    for (uint32_t f = 0; f < frames; f++) {
+        model_step(&m, s, burst);
+        frame_encode(&m, &trace[(size_t)f * SNES_FRAME_WORDS]);
+    }
+
+    static router_model_t r_every, r_changed;
+    static snes_frame_t frame;
+    memset(&r_every, 0, sizeof(r_every));
+    memset(&r_changed, 0, sizeof(r_changed));
+    for (int i = 0; i < SNES_MAX_PORTS; i++) {
+        r_every.type[i] = SNES_DEVICE_NONE;
+        r_changed.type[i] = SNES_DEVICE_NONE;
+    }
+    snes_frame_reset(&frame);
+
+    for (uint32_t f = 0; f < frames; f++) {
+        const uint32_t* words = &trace[(size_t)f * SNES_FRAME_WORDS];
+
+        // Every port on every frame
+        snes_pad_state_t pads[SNES_MAX_PORTS];
+        snes_frame_decode(words, pads);
+        for (int i = 0; i < SNES_MAX_PORTS; i++) router_submit(&r_every, i, &pads[i]);
+
+        // Changed ports only
+        if (snes_frame_update(&frame, words)) {
+            for (int i = 0; i < SNES_MAX_PORTS; i++) {
+                if (frame.changed & (1u << i)) router_submit(&r_changed, i, &frame.pads[i]);
+            }
+        }
+
+        if (memcmp(r_every.type, r_changed.type, sizeof(r_every.type)) != 0 ||
+            memcmp(r_every.buttons, r_changed.buttons, sizeof(r_every.buttons)) != 0 ||
+            memcmp(r_every.mouse_x, r_changed.mouse_x, sizeof(r_every.mouse_x)) != 0 ||
+            memcmp(r_every.mouse_y, r_changed.mouse_y, sizeof(r_every.mouse_y)) != 0) {
+            mismatches++;
+        }
+    }
+
+    free(trace);
+    return mismatches;
+}
+
+void checks_snes_frame(void)
+{
+    check_section("decode");
+    check_decode();
+
+    uint32_t mismatches = 0;
+    for (size_t i = 0; i < NUM_SCENARIOS; i++) {
+        mismatches += replay(&scenarios[i], REPLAY_FRAMES);
+    }
+
+    check_section("replay");
+    check("frames leaving the router in a different state", mismatches,
+          REPLAY_FRAMES * (uint32_t)NUM_SCENARIOS);
+}
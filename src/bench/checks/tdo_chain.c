@@ -0,0 +1,351 @@
+// tdo_chain.c - 3DO PBUS chain frame replay
+//
+// Replays captured-style chain frames (TDO_CHAIN_FRAME_BYTES each, as the
+// DMA capture in 3do_host.c delivers them) through native/host/3do/3do_chain.c.
+// Chains mix joypads, flightsticks and mice; inputs hold still for long
+// stretches, sticks jitter in bursts and mice move with repeated deltas.
+// Two paths feed a router model that keeps the last submission per slot
+// and sums mouse motion:
+//
+//   previous   parse every frame; submit joypads when their buttons change
+//              and flightsticks and mice every frame
+//   chain      tdo_chain_update(): skip unchanged frames, submit only the
+//              slots it flags
+//
+// After every frame both paths must leave the model in the same state. Also
+// checks a few fixed reports against their expected decode.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "native/host/3do/3do_chain.h"
+#include "checks.h"
+
+#define REPLAY_FRAMES       200000u
+
+// ============================================================================
+// ROUTER MODEL
+// ============================================================================
+
+// What a router submission carries for one slot
+typedef struct {
+    tdo_device_type_t type;
+    uint32_t buttons;
+    uint8_t analog[4];
+} view_t;
+
+typedef struct {
+    view_t slot[TDO_HOST_MAX_CONTROLLERS];
+    int32_t mouse_x[TDO_HOST_MAX_CONTROLLERS];
+    int32_t mouse_y[TDO_HOST_MAX_CONTROLLERS];
+    uint32_t submits;
+} router_model_t;
+
+static uint32_t pack_buttons(const tdo_controller_t* c)
+{
+    return (uint32_t)c->button_a << 0 | (uint32_t)c->button_b << 1 |
+           (uint32_t)c->button_c << 2 | (uint32_t)c->button_l << 3 |
+           (uint32_t)c->button_r << 4 | (uint32_t)c->button_x << 5 |
+           (uint32_t)c->button_p << 6 | (uint32_t)c->dpad_up << 7 |
+           (uint32_t)c->dpad_down << 8 | (uint32_t)c->dpad_left << 9 |
+           (uint32_t)c->dpad_right << 10 | (uint32_t)c->fire << 11;
+}
+
+static void router_submit(router_model_t* r, uint8_t i, const tdo_controller_t* c)
+{
+    view_t* v = &r->slot[i];
+    v->type = c->type;
+    v->buttons = pack_buttons(c);
+    memset(v->analog, 0, sizeof(v->analog));
+    if (c->type == TDO_DEVICE_JOYSTICK) {
+        v->analog[0] = c->analog_x;
+        v->analog[1] = c->analog_y;
+        v->analog[2] = c->analog_z;
+        v->analog[3] = c->throttle;
+    } else if (c->type == TDO_DEVICE_MOUSE) {
+        r->mouse_x[i] += c->mouse_dx;
+        r->mouse_y[i] += c->mouse_dy;
+    }
+    r->submits++;
+}
+
+static bool router_same(const router_model_t* a, const router_model_t* b, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (memcmp(&a->slot[i], &b->slot[i], sizeof(view_t)) != 0) return false;
+        if (a->mouse_x[i] != b->mouse_x[i] || a->mouse_y[i] != b->mouse_y[i]) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// FRAME GENERATION
+// ============================================================================
+
+typedef struct {
+    tdo_device_type_t type;
+    uint8_t report[9];
+    uint8_t len;
+    uint32_t burst;         // Frames left in the current movement burst
+} sim_dev_t;
+
+typedef struct {
+    const char* name;
+    tdo_device_type_t types[TDO_HOST_MAX_CONTROLLERS];
+    uint8_t count;
+} scenario_t;
+
+static const scenario_t scenarios[] = {
+    { "1 joypad",                { TDO_DEVICE_JOYPAD }, 1 },
+    { "4 joypads",               { TDO_DEVICE_JOYPAD, TDO_DEVICE_JOYPAD,
+                                   TDO_DEVICE_JOYPAD, TDO_DEVICE_JOYPAD }, 4 },
+    { "8 joypads",               { TDO_DEVICE_JOYPAD, TDO_DEVICE_JOYPAD,
+                                   TDO_DEVICE_JOYPAD, TDO_DEVICE_JOYPAD,
+                                   TDO_DEVICE_JOYPAD, TDO_DEVICE_JOYPAD,
+                                   TDO_DEVICE_JOYPAD, TDO_DEVICE_JOYPAD }, 8 },
+    { "flightstick + joypad",    { TDO_DEVICE_JOYSTICK, TDO_DEVICE_JOYPAD }, 2 },
+    { "mouse + joypad",          { TDO_DEVICE_MOUSE, TDO_DEVICE_JOYPAD }, 2 },
+    { "2 flightsticks + mouse",  { TDO_DEVICE_JOYSTICK, TDO_DEVICE_JOYSTICK,
+                                   TDO_DEVICE_MOUSE }, 3 },
+};
+#define NUM_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+// Joypad first byte: bit 7 keeps it in the joypad ID range; 0xC0 is arcade
+static uint8_t joypad_byte0(void)
+{
+    uint8_t b;
+    do { b = (uint8_t)(0x80 | (check_rng() & 0x7F)); } while (b == 0xC0);
+    return b;
+}
+
+static void mouse_encode(uint8_t* r, uint8_t buttons, int dx, int dy)
+{
+    uint16_t x = (uint16_t)dx & 0x3FF;
+    uint16_t y = (uint16_t)dy & 0x3FF;
+    r[0] = 0x49;
+    r[1] = (uint8_t)(((y >> 6) & 0x0F) << 4 | (buttons & 0x0F));
+    r[2] = (uint8_t)(((x >> 8) & 0x03) << 6 | (y & 0x3F));
+    r[3] = (uint8_t)(x & 0xFF);
+}
+
+static void dev_init(sim_dev_t* d, tdo_device_type_t type)
+{
+    memset(d, 0, sizeof(*d));
+    d->type = type;
+    switch (type) {
+    case TDO_DEVICE_JOYPAD:
+        d->len = 2;
+        d->report[0] = 0x80;
+        break;
+    case TDO_DEVICE_JOYSTICK:
+        d->len = 9;
+        d->report[0] = 0x01; d->report[1] = 0x7B; d->report[2] = 0x08;
+        d->report[3] = d->report[4] = d->report[5] = d->report[6] = 0x80;
+        break;
+    case TDO_DEVICE_MOUSE:
+        d->len = 4;
+        mouse_encode(d->report, 0, 0, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+// Advance one frame (1/60 s): mostly holds, with press/release events and
+// bursts of stick or mouse movement
+static void dev_step(sim_dev_t* d)
+{
+    uint32_t r = check_rng() % 1000;
+    switch (d->type) {
+    case TDO_DEVICE_JOYPAD:
+        if (r < 30) {
+            d->report[0] = joypad_byte0();
+            d->report[1] = (uint8_t)(check_rng() & 0x3F);
+        }
+        break;
+    case TDO_DEVICE_JOYSTICK:
+        if (d->burst == 0 && r < 20) d->burst = 5 + check_rng() % 40;
+        if (d->burst) {
+            d->burst--;
+            for (int a = 3; a < 7; a++) {
+                if (check_rng() & 1) d->report[a] = (uint8_t)(d->report[a] + (int)(check_rng() % 7) - 3);
+            }
+        }
+        if (r >= 980) d->report[7] = (uint8_t)check_rng();
+        if (r < 10) d->report[8] = (uint8_t)(check_rng() & 0x0F);
+        break;
+    case TDO_DEVICE_MOUSE: {
+        // Bursts repeat one delta for several frames, like a steady sweep
+        static const int steps[] = { 1, -1, 3, -3, 7, -12 };
+        uint8_t buttons = d->report[1] & 0x0F;
+        if (r < 15) buttons = (uint8_t)(check_rng() & 0x07);
+        if (d->burst == 0 && r >= 970) d->burst = 3 + check_rng() % 30;
+        int dx = 0, dy = 0;
+        if (d->burst) {
+            d->burst--;
+            dx = steps[(d->burst / 4) % 6];
+            dy = steps[(d->burst / 7 + 2) % 6];
+        }
+        mouse_encode(d->report, buttons, dx, dy);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void frame_build(uint8_t* frame, const sim_dev_t* devs, uint8_t count)
+{
+    uint8_t n = 0;
+    memset(frame, 0, TDO_CHAIN_FRAME_BYTES);
+    for (uint8_t i = 0; i < count; i++) {
+        memcpy(&frame[n], devs[i].report, devs[i].len);
+        n += devs[i].len;
+    }
+}
+
+// ============================================================================
+// FIXED REPORTS
+// ============================================================================
+
+static void check_decode(void)
+{
+    uint32_t bad = 0;
+    tdo_controller_t c[TDO_HOST_MAX_CONTROLLERS];
+
+    // Joypad: A + Up, then C + P
+    const uint8_t jp[] = { 0x90, 0x06, 0x00, 0x00 };
+    if (tdo_chain_parse(jp, sizeof(jp), c, TDO_HOST_MAX_CONTROLLERS) != 1 ||
+        c[0].type != TDO_DEVICE_JOYPAD || !c[0].button_a || !c[0].dpad_up ||
+        !c[0].button_c || !c[0].button_p || c[0].button_b || c[0].dpad_down) bad++;
+
+    // Flightstick: axes, fire + Left, R
+    const uint8_t js[] = { 0x01, 0x7B, 0x08, 0x10, 0x20, 0x30, 0x40, 0x81, 0x08, 0x00, 0x00 };
+    if (tdo_chain_parse(js, sizeof(js), c, TDO_HOST_MAX_CONTROLLERS) != 1 ||
+        c[0].type != TDO_DEVICE_JOYSTICK || c[0].analog_x != 0x10 ||
+        c[0].analog_y != 0x20 || c[0].analog_z != 0x30 || c[0].throttle != 0x40 ||
+        !c[0].fire || !c[0].dpad_left || !c[0].button_r || c[0].button_l) bad++;
+
+    // Mouse then joypad: negative and positive 10-bit deltas, clamped
+    uint8_t ms[8] = { 0 };
+    mouse_encode(ms, 0x01, -5, 300);
+    ms[4] = 0x80; ms[5] = 0x01;
+    uint8_t n = tdo_chain_parse(ms, sizeof(ms), c, TDO_HOST_MAX_CONTROLLERS);
+    if (n != 2 || c[0].type != TDO_DEVICE_MOUSE || c[0].mouse_dx != -5 ||
+        c[0].mouse_dy != 127 || !c[0].mouse_left || c[1].type != TDO_DEVICE_JOYPAD ||
+        !c[1].button_b || c[2].type != TDO_DEVICE_NONE) bad++;
+
+    // Zero bytes inside reports are not the end of the chain
+    uint8_t still[TDO_CHAIN_FRAME_BYTES] = { 0 };
+    mouse_encode(still, 0, 0, 0);
+    memcpy(&still[4], js, 7);
+    n = tdo_chain_parse(still, sizeof(still), c, TDO_HOST_MAX_CONTROLLERS);
+    if (n != 2 || c[0].type != TDO_DEVICE_MOUSE || c[1].type != TDO_DEVICE_JOYSTICK ||
+        c[1].button_r) bad++;
+
+    check("fixed reports decoded wrong", bad, 4);
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+typedef struct {
+    uint32_t mismatches;
+    uint32_t repeat_moves;      // Frames repeating a non-zero mouse delta
+    uint32_t repeat_missed;     // ... that the chain path did not submit
+} replay_result_t;
+
+// Previous tdo_host_task() submission policy for one frame, on the whole
+// frame
+static uint8_t previous_frame(const uint8_t* frame, tdo_controller_t* ctrls,
+                              uint32_t* prev_buttons, router_model_t* r)
+{
+    uint8_t count = tdo_chain_parse(frame, TDO_CHAIN_FRAME_BYTES, ctrls, TDO_HOST_MAX_CONTROLLERS);
+    for (uint8_t i = 0; i < count; i++) {
+        if (ctrls[i].type == TDO_DEVICE_NONE) continue;
+        uint32_t buttons = pack_buttons(&ctrls[i]);
+        if (buttons == prev_buttons[i] &&
+            ctrls[i].type != TDO_DEVICE_MOUSE &&
+            ctrls[i].type != TDO_DEVICE_JOYSTICK) {
+            continue;
+        }
+        prev_buttons[i] = buttons;
+        router_submit(r, i, &ctrls[i]);
+    }
+    return count;
+}
+
+static void chain_frame(tdo_chain_t* chain, const uint8_t* frame, router_model_t* r)
+{
+    if (!tdo_chain_update(chain, frame, TDO_CHAIN_FRAME_BYTES)) return;
+    for (uint8_t i = 0; i < chain->count; i++) {
+        if (chain->controllers[i].type == TDO_DEVICE_NONE) continue;
+        if (!(chain->changed & (1u << i))) continue;
+        router_submit(r, i, &chain->controllers[i]);
+    }
+}
+
+static replay_result_t replay(const scenario_t* s, uint32_t frames)
+{
+    replay_result_t res = { 0 };
+    uint8_t* trace = malloc((size_t)frames * TDO_CHAIN_FRAME_BYTES);
+    sim_dev_t devs[TDO_HOST_MAX_CONTROLLERS];
+    for (uint8_t i = 0; i < s->count; i++) dev_init(&devs[i], s->types[i]);
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint8_t i = 0; i < s->count; i++) dev_step(&devs[i]);
+        frame_build(&trace[(size_t)f * TDO_CHAIN_FRAME_BYTES], devs, s->count);
+    }
+
+    // Equivalence, frame by frame
+    static router_model_t r_prev, r_chain;
+    static tdo_chain_t chain;
+    tdo_controller_t ctrls[TDO_HOST_MAX_CONTROLLERS];
+    uint32_t prev_buttons[TDO_HOST_MAX_CONTROLLERS];
+    memset(&r_prev, 0, sizeof(r_prev));
+    memset(&r_chain, 0, sizeof(r_chain));
+    for (int i = 0; i < TDO_HOST_MAX_CONTROLLERS; i++) prev_buttons[i] = 0xFFFFFFFF;
+    tdo_chain_reset(&chain);
+
+    for (uint32_t f = 0; f < frames; f++) {
+        const uint8_t* frame = &trace[(size_t)f * TDO_CHAIN_FRAME_BYTES];
+        uint8_t count = previous_frame(frame, ctrls, prev_buttons, &r_prev);
+        uint32_t before = r_chain.submits;
+        chain_frame(&chain, frame, &r_chain);
+        if (!router_same(&r_prev, &r_chain, count)) res.mismatches++;
+
+        if (f > 0) {
+            const uint8_t* last = frame - TDO_CHAIN_FRAME_BYTES;
+            for (uint8_t i = 0; i < count; i++) {
+                if (ctrls[i].type == TDO_DEVICE_MOUSE &&
+                    (ctrls[i].mouse_dx || ctrls[i].mouse_dy) &&
+                    memcmp(frame, last, TDO_CHAIN_FRAME_BYTES) == 0) {
+                    res.repeat_moves++;
+                    if (r_chain.submits == before) res.repeat_missed++;
+                }
+            }
+        }
+    }
+    free(trace);
+    return res;
+}
+
+void checks_tdo_chain(void)
+{
+    check_section("fixed reports");
+    check_decode();
+
+    uint32_t mismatches = 0, repeat_moves = 0, repeat_missed = 0;
+    for (size_t i = 0; i < NUM_SCENARIOS; i++) {
+        replay_result_t res = replay(&scenarios[i], REPLAY_FRAMES);
+        mismatches += res.mismatches;
+        repeat_moves += res.repeat_moves;
+        repeat_missed += res.repeat_missed;
+    }
+
+    check_section("replay");
+    check("frames leaving the router in a different state", mismatches,
+          REPLAY_FRAMES * (uint32_t)NUM_SCENARIOS);
+    check("repeated mouse deltas not submitted", repeat_missed, repeat_moves);
+}
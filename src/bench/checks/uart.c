@@ -0,0 +1,531 @@
+// uart.c - UART bridge transmit over a simulated wire
+//
+// Runs native/device/uart/uart_device.c against the byte pipe in
+// stubs/uart_pipe.c (UART + TX DMA replaced by a baud-paced FIFO and a
+// capture buffer) and decodes what comes out the other end:
+//   - random multi-player traffic mixed with control packets, with the wire
+//     advancing between task calls, in DMA and FIFO-fallback modes: every
+//     packet must arrive whole, in order, with a valid CRC, and every missing
+//     input event must be accounted for by the drop counters
+//   - a stalled wire: backpressure and ring-full drops are counted and the
+//     stream stays intact once it drains
+//   - input frames: negotiation, decoded state over clean and lossy links,
+//     and random payloads that must never corrupt the decoder
+//   - bursts of 1, 4 and 8 players per task call arrive intact
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "native/device/uart/uart_device.h"
+#include "core/uart/uart_frame.h"
+#include "uart_pipe.h"
+#include "../bench_util.h"
+#include "checks.h"
+
+#define STREAM_FRAMES       20000u
+#define BENCH_BAUD          UART_PROTOCOL_BAUD_DEFAULT
+#define BENCH_PLAYERS       8
+
+// ============================================================================
+// RECEIVER (decodes the wire)
+// ============================================================================
+
+typedef struct {
+    uint8_t buf[UART_PROTOCOL_MAX_PAYLOAD + UART_OVERHEAD];
+    uint16_t len;
+
+    uint32_t packets;
+    uint32_t events;
+    uint32_t control;
+    uint32_t garbage;       // Bytes outside a packet, or bad length
+    uint32_t crc_errors;
+    uint32_t reordered;     // Input event older than one already seen
+    uint32_t gaps;          // Input events skipped (sequence jumps)
+    int64_t last_seq[BENCH_PLAYERS];
+
+    // Input frames (peer side of the negotiated protocol)
+    uint32_t versions;
+    uint32_t input_bytes;   // Wire bytes of INPUT_EVENT/INPUT_FRAME packets
+    uart_frame_decoder_t dec;
+    uint32_t frames;
+    uint32_t frames_lost;   // Dropped on purpose (drop_frame_pct)
+    uint32_t frame_rejects; // Not decodable (missing delta base)
+    uint32_t acks_lost;
+    uint32_t mismatches;    // Decoded state differs from what was queued
+    uint32_t drop_frame_pct;
+    uint32_t drop_ack_pct;
+} receiver_t;
+
+// Latest state queued per player, what a decoded frame must reproduce
+static uart_input_event_t expected[BENCH_PLAYERS];
+
+static void receiver_reset(receiver_t* rx)
+{
+    memset(rx, 0, sizeof(*rx));
+    for (int p = 0; p < BENCH_PLAYERS; p++) rx->last_seq[p] = -1;
+    uart_frame_decoder_init(&rx->dec);
+}
+
+// Peer → device: frame a packet into the device's RX
+static void peer_send(uint8_t type, const void* payload, uint8_t len)
+{
+    uint8_t packet[UART_PROTOCOL_MAX_PAYLOAD + UART_OVERHEAD];
+    packet[0] = UART_PROTOCOL_SYNC_BYTE;
+    packet[1] = len;
+    packet[2] = type;
+    memcpy(&packet[UART_HEADER_SIZE], payload, len);
+    packet[UART_HEADER_SIZE + len] = uart_crc8(&packet[1], len + 2);
+    uart_pipe_rx_inject(uart1, packet, len + UART_OVERHEAD);
+}
+
+static void receiver_frame(receiver_t* rx, const uint8_t* payload, uint8_t len)
+{
+    if ((uint32_t)(rand() % 100) < rx->drop_frame_pct) {
+        rx->frames_lost++;
+        return;
+    }
+
+    uart_frame_result_t result;
+    if (!uart_frame_decode(&rx->dec, payload, len, &result)) {
+        rx->frame_rejects++;
+        return;
+    }
+    rx->frames++;
+
+    // KEY/DELTA frames reproduce every player exactly; plain frames only
+    // when nothing was lost before them
+    if (result.ack || rx->drop_frame_pct == 0) {
+        for (int p = 0; p < BENCH_PLAYERS; p++) {
+            if (memcmp(&rx->dec.state[p], &expected[p], sizeof(uart_input_event_t)) != 0) {
+                rx->mismatches++;
+            }
+        }
+    }
+
+    if (result.ack) {
+        if ((uint32_t)(rand() % 100) < rx->drop_ack_pct) {
+            rx->acks_lost++;
+        } else {
+            uart_input_frame_ack_t ack = { .seq = result.seq };
+            peer_send(UART_PKT_INPUT_FRAME_ACK, &ack, sizeof(ack));
+        }
+    }
+}
+
+static void receiver_packet(receiver_t* rx)
+{
+    uint8_t len = rx->buf[1];
+    uint8_t type = rx->buf[2];
+
+    if (uart_crc8(&rx->buf[1], len + 2) != rx->buf[UART_HEADER_SIZE + len]) {
+        rx->crc_errors++;
+        return;
+    }
+    rx->packets++;
+
+    if (type == UART_PKT_VERSION) {
+        rx->versions++;
+        return;
+    }
+    if (type == UART_PKT_INPUT_FRAME) {
+        rx->input_bytes += len + UART_OVERHEAD;
+        receiver_frame(rx, &rx->buf[UART_HEADER_SIZE], len);
+        return;
+    }
+    if (type != UART_PKT_INPUT_EVENT) {
+        rx->control++;
+        return;
+    }
+    rx->input_bytes += len + UART_OVERHEAD;
+
+    uart_input_event_t ev;
+    memcpy(&ev, &rx->buf[UART_HEADER_SIZE], sizeof(ev));
+    rx->events++;
+    if (ev.player_index >= BENCH_PLAYERS) {
+        rx->garbage++;
+        return;
+    }
+
+    // The bench puts a per-player sequence number in the button word
+    int64_t seq = ev.buttons;
+    int64_t last = rx->last_seq[ev.player_index];
+    if (seq <= last) {
+        rx->reordered++;
+    } else {
+        rx->gaps += (uint32_t)(seq - last - 1);
+        rx->last_seq[ev.player_index] = seq;
+    }
+}
+
+static void receiver_feed(receiver_t* rx, const uint8_t* data, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        uint8_t b = data[i];
+
+        if (rx->len == 0 && b != UART_PROTOCOL_SYNC_BYTE) {
+            rx->garbage++;
+            continue;
+        }
+        rx->buf[rx->len++] = b;
+
+        if (rx->len == 2 && b > UART_PROTOCOL_MAX_PAYLOAD) {
+            rx->garbage++;
+            rx->len = 0;
+            continue;
+        }
+        if (rx->len >= UART_HEADER_SIZE && rx->len == rx->buf[1] + UART_OVERHEAD) {
+            receiver_packet(rx);
+            rx->len = 0;
+        }
+    }
+}
+
+static void receiver_pump(receiver_t* rx)
+{
+    uint8_t chunk[1024];
+    size_t n;
+    while ((n = uart_pipe_tx_take(uart1, chunk, sizeof(chunk))) > 0) {
+        receiver_feed(rx, chunk, n);
+    }
+}
+
+// ============================================================================
+// SENDER
+// ============================================================================
+
+static uint32_t next_seq[BENCH_PLAYERS];
+
+static void queue_player(uint8_t player)
+{
+    input_state_t state;
+    init_input_state(&state);
+    state.type = INPUT_TYPE_GAMEPAD;
+    state.buttons = next_seq[player]++;
+    state.analog[ANALOG_X] = (uint8_t)rand();
+    state.analog[ANALOG_Y] = (uint8_t)rand();
+    uart_device_queue_input(&state, player);
+}
+
+static void device_start(int dma_channels)
+{
+    uart_pipe_set_dma_channels(dma_channels);
+    quiet_begin();
+    uart_device_init_pins(UART_DEVICE_TX_PIN, UART_DEVICE_RX_PIN, BENCH_BAUD);
+    quiet_end();
+    uart_device_set_mode(UART_DEVICE_MODE_STREAM);
+    memset(next_seq, 0, sizeof(next_seq));
+}
+
+// Keep calling the task while the wire runs until everything is out
+static void device_flush(receiver_t* rx)
+{
+    for (int guard = 0; guard < 100000; guard++) {
+        uart_device_task();
+        uart_pipe_drain(uart1);
+        receiver_pump(rx);
+        if (uart_device_get_tx_pending() == 0 && uart_pipe_tx_backlog(uart1) == 0) {
+            uart_device_task();
+            if (uart_device_get_tx_pending() == 0) return;
+        }
+    }
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+static void check_stream(int dma_channels, uint32_t frames)
+{
+    receiver_t rx;
+    receiver_reset(&rx);
+    device_start(dma_channels);
+
+    uint32_t queue_drops0 = uart_device_get_queue_drops();
+    uint32_t tx_drops0 = uart_device_get_tx_drops();
+    uint32_t control_sent = 0;
+    uint32_t events_queued = 0;
+
+    srand(1234);
+    for (uint32_t f = 0; f < frames; f++) {
+        uint8_t players = 1 + rand() % BENCH_PLAYERS;
+        for (uint8_t p = 0; p < players; p++) {
+            queue_player(p);
+            events_queued++;
+        }
+
+        // Odd-sized control packets so frames straddle the ring wrap
+        switch (rand() % 8) {
+            case 0:
+                uart_device_send_packet(UART_PKT_PONG, NULL, 0);
+                control_sent++;
+                break;
+            case 1:
+                uart_device_send_connect(rand() % BENCH_PLAYERS, INPUT_TYPE_GAMEPAD, 0x054C, 0x09CC);
+                control_sent++;
+                break;
+            case 2:
+                uart_device_send_disconnect(rand() % BENCH_PLAYERS);
+                control_sent++;
+                break;
+        }
+
+        // Wire time between polls: 100us..1.5ms, task called every 100us
+        uint32_t steps = 1 + rand() % 15;
+        for (uint32_t s = 0; s < steps; s++) {
+            uart_device_task();
+            uart_pipe_advance_ns(uart1, 100000);
+            receiver_pump(&rx);
+        }
+    }
+    device_flush(&rx);
+
+    // Events dropped after a player's last delivered one
+    for (int p = 0; p < BENCH_PLAYERS; p++) {
+        rx.gaps += (uint32_t)((int64_t)next_seq[p] - 1 - rx.last_seq[p]);
+    }
+
+    uint32_t queue_drops = uart_device_get_queue_drops() - queue_drops0;
+    uint32_t tx_drops = uart_device_get_tx_drops() - tx_drops0;
+
+    check("garbage bytes between packets", rx.garbage, rx.packets);
+    check("CRC errors", rx.crc_errors, rx.packets);
+    check("input events out of order", rx.reordered, rx.events);
+    check("lost events not in queue_drops",
+          (rx.gaps > queue_drops) ? rx.gaps - queue_drops : queue_drops - rx.gaps, events_queued);
+    check("events received + dropped != queued",
+          (rx.events + queue_drops == events_queued) ? 0 : 1, 1);
+    check("control received + ring drops != sent",
+          (rx.control + tx_drops == control_sent) ? 0 : 1, 1);
+}
+
+static void check_stall(void)
+{
+    receiver_t rx;
+    receiver_reset(&rx);
+    device_start(12);
+
+    uint32_t queue_drops0 = uart_device_get_queue_drops();
+    uint32_t tx_drops0 = uart_device_get_tx_drops();
+    uint32_t backpressure0 = uart_device_get_tx_backpressure();
+    uint32_t events_queued = 0;
+    uint32_t control_sent = 0;
+
+    // Wire stalled: fill the ring, the event queue, then push control packets
+    for (int f = 0; f < 16; f++) {
+        for (uint8_t p = 0; p < BENCH_PLAYERS; p++) {
+            queue_player(p);
+            events_queued++;
+        }
+        uart_device_task();
+    }
+    for (int i = 0; i < 8; i++) {
+        uart_device_send_packet(UART_PKT_PONG, NULL, 0);
+        control_sent++;
+    }
+
+    uint32_t backpressure = uart_device_get_tx_backpressure() - backpressure0;
+    uint32_t tx_drops = uart_device_get_tx_drops() - tx_drops0;
+    uint16_t pending = uart_device_get_tx_pending();
+
+    device_flush(&rx);
+    uint32_t queue_drops = uart_device_get_queue_drops() - queue_drops0;
+
+    check("backpressure counted", backpressure ? 0 : 1, 1);
+    check("ring-full drops counted", tx_drops ? 0 : 1, 1);
+    check("ring overfilled", pending >= UART_DEVICE_TX_RING_SIZE, 1);
+    check("garbage/CRC after drain", rx.garbage + rx.crc_errors, rx.packets);
+    check("events received + dropped != queued",
+          (rx.events + queue_drops == events_queued) ? 0 : 1, 1);
+    check("control received + ring drops != sent",
+          (rx.control + tx_drops == control_sent) ? 0 : 1, 1);
+}
+
+// ============================================================================
+// INPUT FRAMES
+// ============================================================================
+
+typedef struct {
+    const char* label;
+    uint32_t features;      // Peer VERSION features, 0 = peer never sends one
+} frame_mode_t;
+
+static const frame_mode_t frame_modes[] = {
+    { "input events",  0 },
+    { "plain frames",  UART_FEATURE_INPUT_FRAME },
+    { "delta frames",  UART_FEATURE_INPUT_FRAME | UART_FEATURE_FRAME_DELTA },
+};
+
+#define FRAME_MODE_COUNT (sizeof(frame_modes) / sizeof(frame_modes[0]))
+
+static void queue_expected(uint8_t player)
+{
+    const uart_input_event_t* e = &expected[player];
+    input_state_t state;
+    init_input_state(&state);
+    state.type = e->device_type;
+    state.buttons = e->buttons;
+    state.analog[ANALOG_X] = e->analog[0];
+    state.analog[ANALOG_Y] = e->analog[1];
+    state.analog[ANALOG_Z] = e->analog[2];
+    state.analog[ANALOG_RX] = e->analog[3];
+    state.analog[ANALOG_RZ] = e->analog[4];
+    state.analog[ANALOG_SLIDER] = e->analog[5];
+    uart_device_queue_input(&state, player);
+}
+
+// One poll of an 8-player multitap: a few buttons change, sticks drift
+static void traffic_step(void)
+{
+    for (uint8_t p = 0; p < BENCH_PLAYERS; p++) {
+        uart_input_event_t* e = &expected[p];
+        e->device_type = INPUT_TYPE_GAMEPAD;
+        if (rand() % 100 < 40) e->buttons ^= 1u << (rand() % 16);
+        if (rand() % 100 < 30) {
+            e->analog[0] += (uint8_t)(rand() % 7 - 3);
+            e->analog[1] += (uint8_t)(rand() % 7 - 3);
+        }
+        if (rand() % 100 < 10) e->analog[4] = (uint8_t)rand();
+        queue_expected(p);
+    }
+}
+
+static void frames_start(receiver_t* rx, uint32_t features)
+{
+    receiver_reset(rx);
+    device_start(12);
+    uart_device_set_mode(UART_DEVICE_MODE_ON_CHANGE);
+    for (uint8_t p = 0; p < BENCH_PLAYERS; p++) uart_frame_neutral(&expected[p], p);
+
+    if (features) {
+        uart_version_t ver = { 1, 0, 0, UART_BOARD_ESP32S3, features };
+        peer_send(UART_PKT_VERSION, &ver, sizeof(ver));
+    }
+    quiet_begin();
+    uart_device_task();
+    quiet_end();
+}
+
+// Everything sent this poll reaches the receiver before the next one
+static void frames_poll(receiver_t* rx)
+{
+    device_flush(rx);
+}
+
+static void check_frames(uint32_t frames)
+{
+    receiver_t rx;
+
+    for (size_t m = 0; m < FRAME_MODE_COUNT; m++) {
+        const frame_mode_t* mode = &frame_modes[m];
+        frames_start(&rx, mode->features);
+
+        srand(99);
+        for (uint32_t f = 0; f < frames; f++) {
+            traffic_step();
+            frames_poll(&rx);
+        }
+        device_flush(&rx);
+
+        char label[64];
+        bool frames_on = mode->features & UART_FEATURE_INPUT_FRAME;
+        snprintf(label, sizeof(label), "%s: negotiated", mode->label);
+        check(label, (uart_device_get_peer_features() == mode->features &&
+                      rx.versions == (frames_on ? 2u : 1u) &&
+                      (rx.frames > 0) == frames_on) ? 0 : 1, 1);
+        if (frames_on) {
+            snprintf(label, sizeof(label), "%s: decoded state != queued", mode->label);
+            check(label, rx.mismatches, rx.frames);
+            snprintf(label, sizeof(label), "%s: undecodable frames", mode->label);
+            check(label, rx.frame_rejects + rx.dec.errors, rx.frames);
+        }
+    }
+
+    // Lossy link: frames and acks dropped, the receiver must never apply a
+    // wrong delta and must converge once input goes quiet
+    frames_start(&rx, UART_FEATURE_INPUT_FRAME | UART_FEATURE_FRAME_DELTA);
+    rx.drop_frame_pct = 10;
+    rx.drop_ack_pct = 10;
+    srand(7);
+    for (uint32_t f = 0; f < frames; f++) {
+        traffic_step();
+        frames_poll(&rx);
+    }
+    rx.drop_frame_pct = 0;
+    rx.drop_ack_pct = 0;
+    uint64_t settle_until = now_ns() + 4ull * UART_DEVICE_FRAME_RESEND_MS * 1000000ull;
+    while (now_ns() < settle_until) frames_poll(&rx);
+
+    uint32_t stale = 0;
+    for (int p = 0; p < BENCH_PLAYERS; p++) {
+        if (memcmp(&rx.dec.state[p], &expected[p], sizeof(uart_input_event_t)) != 0) stale++;
+    }
+    check("delta frames: decoded state != queued", rx.mismatches, rx.frames);
+    check("delta frames: stale players after resend", stale, BENCH_PLAYERS);
+
+    // Garbage payloads: rejected ones must leave the decoder state alone
+    uart_frame_decoder_t dec;
+    uart_frame_decoder_init(&dec);
+    uint32_t corrupted = 0;
+    srand(5);
+    for (uint32_t i = 0; i < frames * 50; i++) {
+        uint8_t payload[UART_FRAME_MAX_PAYLOAD];
+        uint8_t len = (uint8_t)(rand() % (sizeof(payload) + 1));
+        for (uint8_t b = 0; b < len; b++) payload[b] = (uint8_t)rand();
+        if (len > 0) payload[0] = (uint8_t)((rand() % 4) << 4 | UART_FRAME_V1);
+
+        uart_input_event_t before[UART_FRAME_PLAYERS];
+        memcpy(before, dec.state, sizeof(before));
+        uart_frame_result_t result;
+        if (!uart_frame_decode(&dec, payload, len, &result) &&
+            memcmp(before, dec.state, sizeof(before)) != 0) {
+            corrupted++;
+        }
+    }
+    check("rejected frame changed decoder state", corrupted, frames * 50);
+}
+
+// ============================================================================
+// BURSTS
+// ============================================================================
+
+static void check_bursts(uint32_t iterations)
+{
+    static const uint8_t burst_sizes[] = { 1, 4, 8 };
+    uint32_t lost = 0, sent = 0;
+    receiver_t rx;
+
+    for (size_t b = 0; b < sizeof(burst_sizes); b++) {
+        uint8_t players = burst_sizes[b];
+        receiver_reset(&rx);
+        device_start(12);
+
+        for (uint32_t i = 0; i < iterations; i++) {
+            for (uint8_t p = 0; p < players; p++) queue_player(p);
+            uart_device_task();
+            uart_pipe_drain(uart1);
+            receiver_pump(&rx);
+        }
+        device_flush(&rx);
+
+        lost += (iterations * players - rx.events) + rx.crc_errors + rx.garbage;
+        sent += iterations * players;
+    }
+    check("burst events lost or corrupted", lost, sent);
+}
+
+void checks_uart(void)
+{
+    // Fallback first: once a channel is claimed, re-init keeps it
+    check_section("FIFO fallback (no DMA channel)");
+    check_stream(0, STREAM_FRAMES / 4);
+    check_section("DMA ring");
+    check_stream(12, STREAM_FRAMES);
+    check_section("stalled wire");
+    check_stall();
+    check_section("input frames, 8 players (ON_CHANGE)");
+    check_frames(STREAM_FRAMES / 4);
+    check_section("bursts");
+    check_bursts(STREAM_FRAMES);
+}
@@ -0,0 +1,471 @@
+// uart_host.c - UART host reception over a simulated wire
+//
+// Runs native/host/uart/uart_host.c against the byte pipe in
+// stubs/uart_pipe.c (UART RX and its DMA channel) and checks what reaches
+// process_packet(), via the link callback (VERSION and INPUT_FRAME_ACK
+// payloads are passed through whole):
+//   - fragmented streams (random 1..97 byte chunks, packets straddling the
+//     ring wrap) in DMA and FIFO-fallback modes: every packet exactly once,
+//     in order, byte for byte
+//   - corrupted streams (bit flips, dropped bytes, truncated packets, garbage
+//     with stray sync bytes): no corrupted packet delivered, and every intact
+//     packet found unless a false CRC-8 match hides it, and never fewer than
+//     the previous byte state machine, which loses the packet after any damage
+//   - a partial packet with a corrupt LEN at the end of a burst gives way to
+//     the packets behind it once the line goes idle
+//   - 1-3 Mbaud with the task called every 1ms (core 0 busy in tud_task):
+//     DMA reception must be lossless. A longer stall overruns the ring,
+//     which must be counted and recovered
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "native/host/uart/uart_host.h"
+#include "uart_pipe.h"
+#include "../bench_util.h"
+#include "checks.h"
+
+#define STREAM_PACKETS      4000u
+#define MAX_LOG             65536
+#define BUSY_NS             1000000ull      // Task period while core 0 is busy
+
+// ============================================================================
+// PACKETS
+// ============================================================================
+
+typedef struct {
+    uint8_t type;
+    uint8_t len;
+    uint8_t payload[UART_PROTOCOL_MAX_PAYLOAD];
+} packet_t;
+
+// Delivered to the link callback, in order
+static packet_t link_log[MAX_LOG];
+static uint32_t link_count;
+
+static void on_link(uint8_t type, const uint8_t* payload, uint8_t len)
+{
+    if (link_count >= MAX_LOG) return;
+    packet_t* p = &link_log[link_count++];
+    p->type = type;
+    p->len = len;
+    memcpy(p->payload, payload, len);
+}
+
+// Bitwise CRC-8/0x07, independent of core/crc.h
+static uint8_t ref_crc8(const uint8_t* data, size_t len)
+{
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// VERSION (any length >= sizeof(uart_version_t)), INPUT_FRAME_ACK (any
+// length) or NOP (empty, not logged)
+static void random_packet(packet_t* p)
+{
+    int kind = rand() % 10;
+    if (kind == 0) {
+        p->type = UART_PKT_NOP;
+        p->len = 0;
+    } else if (kind < 5) {
+        p->type = UART_PKT_VERSION;
+        p->len = (uint8_t)(sizeof(uart_version_t) + rand() % (UART_PROTOCOL_MAX_PAYLOAD - sizeof(uart_version_t) + 1));
+    } else {
+        p->type = UART_PKT_INPUT_FRAME_ACK;
+        p->len = (uint8_t)(1 + rand() % 24);
+    }
+    for (int i = 0; i < p->len; i++) {
+        // Plenty of sync bytes inside payloads
+        p->payload[i] = (rand() % 8 == 0) ? UART_PROTOCOL_SYNC_BYTE : (uint8_t)rand();
+    }
+}
+
+static bool is_logged(const packet_t* p)
+{
+    return p->type != UART_PKT_NOP;
+}
+
+static size_t encode(const packet_t* p, uint8_t* out)
+{
+    out[0] = UART_PROTOCOL_SYNC_BYTE;
+    out[1] = p->len;
+    out[2] = p->type;
+    memcpy(&out[UART_HEADER_SIZE], p->payload, p->len);
+    out[UART_HEADER_SIZE + p->len] = ref_crc8(&out[1], p->len + 2u);
+    return uart_packet_size(p->len);
+}
+
+static bool same_packet(const packet_t* a, const packet_t* b)
+{
+    return a->type == b->type && a->len == b->len && memcmp(a->payload, b->payload, a->len) == 0;
+}
+
+// Stream under construction
+typedef struct {
+    uint8_t* bytes;
+    size_t len;
+    size_t cap;
+    packet_t* sent;         // Logged packets, in order
+    bool* intact;           // Sent without corruption
+    uint32_t count;
+    uint32_t total;         // All packets including NOPs
+} stream_t;
+
+static void stream_put(stream_t* s, const uint8_t* data, size_t len)
+{
+    if (s->len + len > s->cap) {
+        s->cap = (s->len + len) * 2 + 4096;
+        s->bytes = realloc(s->bytes, s->cap);
+    }
+    memcpy(s->bytes + s->len, data, len);
+    s->len += len;
+}
+
+static void stream_free(stream_t* s)
+{
+    free(s->bytes);
+    free(s->sent);
+    free(s->intact);
+    memset(s, 0, sizeof(*s));
+}
+
+// corrupt_pct: share of packets damaged (flip / drop / truncate / garbage)
+static void stream_build(stream_t* s, uint32_t packets, uint32_t corrupt_pct)
+{
+    memset(s, 0, sizeof(*s));
+    s->sent = calloc(packets, sizeof(packet_t));
+    s->intact = calloc(packets, sizeof(bool));
+
+    for (uint32_t i = 0; i < packets; i++) {
+        packet_t p;
+        uint8_t wire[UART_PROTOCOL_MAX_PAYLOAD + UART_OVERHEAD];
+        random_packet(&p);
+        size_t n = encode(&p, wire);
+        bool intact = true;
+
+        if ((uint32_t)(rand() % 100) < corrupt_pct) {
+            switch (rand() % 4) {
+                case 0:     // Single bit flip: CRC-8 always catches it
+                    wire[rand() % n] ^= (uint8_t)(1u << (rand() % 8));
+                    intact = false;
+                    break;
+                case 1: {   // Dropped byte
+                    size_t at = (size_t)(rand() % (int)n);
+                    memmove(&wire[at], &wire[at + 1], n - at - 1);
+                    n--;
+                    intact = false;
+                    break;
+                }
+                case 2:     // Truncated
+                    n = 1 + (size_t)(rand() % (int)(n - 1));
+                    intact = false;
+                    break;
+                default: {  // Line noise before an intact packet
+                    uint8_t noise[24];
+                    size_t k = 1 + (size_t)(rand() % (int)sizeof(noise));
+                    for (size_t j = 0; j < k; j++) {
+                        noise[j] = (rand() % 3 == 0) ? UART_PROTOCOL_SYNC_BYTE : (uint8_t)rand();
+                    }
+                    stream_put(s, noise, k);
+                    break;
+                }
+            }
+        }
+
+        stream_put(s, wire, n);
+        s->total++;
+        if (is_logged(&p)) {
+            s->sent[s->count] = p;
+            s->intact[s->count] = intact;
+            s->count++;
+        }
+    }
+}
+
+typedef struct {
+    uint32_t delivered;
+    uint32_t matched;       // Intact packets delivered, in order
+    uint32_t missed;        // Intact packets not delivered
+    uint32_t corrupted;     // Damaged packets delivered as sent (impossible)
+    uint32_t spurious;      // Deliveries that match nothing sent
+} match_t;
+
+// Walk the log against what was sent. Damaged packets may or may not be
+// matched by a delivery; intact ones must be.
+static match_t match_log(const stream_t* s, const packet_t* log, uint32_t log_count)
+{
+    match_t m = {0};
+    uint32_t next = 0;
+    m.delivered = log_count;
+
+    for (uint32_t i = 0; i < log_count; i++) {
+        uint32_t j = next;
+        while (j < s->count && !same_packet(&log[i], &s->sent[j])) j++;
+        if (j == s->count) {
+            m.spurious++;
+            continue;
+        }
+        for (uint32_t k = next; k < j; k++) {
+            if (s->intact[k]) m.missed++;
+        }
+        if (s->intact[j]) {
+            m.matched++;
+        } else {
+            m.corrupted++;
+        }
+        next = j + 1;
+    }
+    for (uint32_t k = next; k < s->count; k++) {
+        if (s->intact[k]) m.missed++;
+    }
+    return m;
+}
+
+static uint32_t count_intact(const stream_t* s)
+{
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < s->count; i++) n += s->intact[i];
+    return n;
+}
+
+// ============================================================================
+// PREVIOUS PARSER (byte state machine, as previously in uart_host.c)
+// ============================================================================
+
+static packet_t ref_log[MAX_LOG];
+static uint32_t ref_count;
+
+static struct {
+    int state;
+    uint8_t buf[UART_PROTOCOL_MAX_PAYLOAD + UART_OVERHEAD];
+    uint8_t index;
+    uint8_t length;
+    uint8_t type;
+} ref;
+
+static void ref_rx_byte(uint8_t byte)
+{
+    switch (ref.state) {
+        case 0:
+            if (byte == UART_PROTOCOL_SYNC_BYTE) {
+                ref.buf[0] = byte;
+                ref.index = 1;
+                ref.state = 1;
+            }
+            break;
+        case 1:
+            ref.length = byte;
+            ref.buf[ref.index++] = byte;
+            ref.state = (ref.length > UART_PROTOCOL_MAX_PAYLOAD) ? 0 : 2;
+            break;
+        case 2:
+            ref.type = byte;
+            ref.buf[ref.index++] = byte;
+            ref.state = ref.length ? 3 : 4;
+            break;
+        case 3:
+            ref.buf[ref.index++] = byte;
+            if (ref.index >= UART_HEADER_SIZE + ref.length) ref.state = 4;
+            break;
+        case 4:
+            if (byte == ref_crc8(&ref.buf[1], ref.length + 2u) &&
+                (ref.type == UART_PKT_VERSION || ref.type == UART_PKT_INPUT_FRAME_ACK) &&
+                ref_count < MAX_LOG) {
+                if (ref.type != UART_PKT_VERSION || ref.length >= sizeof(uart_version_t)) {
+                    packet_t* p = &ref_log[ref_count++];
+                    p->type = ref.type;
+                    p->len = ref.length;
+                    memcpy(p->payload, &ref.buf[UART_HEADER_SIZE], ref.length);
+                }
+            }
+            ref.state = 0;
+            break;
+    }
+}
+
+// ============================================================================
+// SCENARIOS
+// ============================================================================
+
+static void host_start(bool dma, uint32_t baud)
+{
+    uart_pipe_set_dma_channels(dma ? 12 : 0);
+    quiet_begin();
+    uart_host_init_pins(UART_HOST_TX_PIN, UART_HOST_RX_PIN, baud);
+    quiet_end();
+    uart_host_set_link_callback(on_link);
+    link_count = 0;
+}
+
+static void task_quiet(void)
+{
+    quiet_begin();
+    uart_host_task();
+    quiet_end();
+}
+
+// Feed a stream in random fragments, one task call per fragment
+static void feed_fragmented(const stream_t* s)
+{
+    size_t at = 0;
+    while (at < s->len) {
+        size_t n = 1 + (size_t)(rand() % 97);
+        if (n > s->len - at) n = s->len - at;
+        uart_pipe_rx_inject(UART_HOST_PERIPHERAL, s->bytes + at, n);
+        task_quiet();
+        at += n;
+    }
+}
+
+static void run_fragmented(uint32_t packets, bool dma)
+{
+    stream_t s;
+    stream_build(&s, packets, 0);
+    host_start(dma, UART_PROTOCOL_BAUD_DEFAULT);
+    uint32_t rx0 = uart_host_get_rx_count();
+    uint32_t err0 = uart_host_get_error_count();
+
+    feed_fragmented(&s);
+
+    match_t m = match_log(&s, link_log, link_count);
+    bool in_order = m.matched == s.count && link_count == s.count;
+    check("packets delivered (rx_count)", (uart_host_get_rx_count() - rx0) != s.total, 1);
+    check("payloads delivered exactly, in order", in_order ? 0 : s.count - m.matched, s.count);
+    check("errors on a clean stream", uart_host_get_error_count() - err0, s.total);
+    stream_free(&s);
+}
+
+static void run_corrupted(uint32_t packets)
+{
+    stream_t s;
+    stream_build(&s, packets, 30);
+    host_start(true, UART_PROTOCOL_BAUD_DEFAULT);
+
+    feed_fragmented(&s);
+    // Let a trailing truncated packet time out
+    usleep(UART_HOST_RX_IDLE_US + 1000);
+    task_quiet();
+
+    // Same bytes through the previous state machine
+    memset(&ref, 0, sizeof(ref));
+    ref_count = 0;
+    for (size_t i = 0; i < s.len; i++) ref_rx_byte(s.bytes[i]);
+
+    match_t m = match_log(&s, link_log, link_count);
+    match_t r = match_log(&s, ref_log, ref_count);
+    uint32_t intact = count_intact(&s);
+
+    check("damaged packets delivered", m.corrupted, s.count - intact);
+    // A sync byte in noise or a damaged payload passes CRC-8 1 time in 256,
+    // and the false packet swallows what follows it: allow 1%
+    check("intact packets missed (> 1%)", m.missed * 100 > intact ? m.missed : 0, intact);
+    check("intact packets missed (vs previous parser)", m.missed >= r.missed ? m.missed : 0, intact);
+    stream_free(&s);
+}
+
+static void run_idle_resync(void)
+{
+    host_start(true, UART_PROTOCOL_BAUD_DEFAULT);
+
+    // Claims a 100-byte payload, then three short packets and silence
+    stream_t s;
+    memset(&s, 0, sizeof(s));
+    uint8_t wire[UART_PROTOCOL_MAX_PAYLOAD + UART_OVERHEAD];
+    packet_t bad = { .type = UART_PKT_INPUT_FRAME_ACK, .len = 4, .payload = { 1, 2, 3, 4 } };
+    size_t n = encode(&bad, wire);
+    wire[1] = 100;
+    stream_put(&s, wire, n);
+    for (uint8_t i = 0; i < 3; i++) {
+        packet_t p = { .type = UART_PKT_INPUT_FRAME_ACK, .len = 1, .payload = { i } };
+        stream_put(&s, wire, encode(&p, wire));
+    }
+
+    uart_pipe_rx_inject(UART_HOST_PERIPHERAL, s.bytes, s.len);
+    task_quiet();
+    uint32_t early = link_count;
+    usleep(UART_HOST_RX_IDLE_US + 1000);
+    task_quiet();
+
+    check("packets held while bytes may still come", early, 3);
+    check("packets delivered after idle timeout", link_count != 3, 3);
+    stream_free(&s);
+}
+
+static const uint32_t line_bauds[] = { 1000000, 2000000, 3000000 };
+#define LINE_BAUDS (sizeof(line_bauds) / sizeof(line_bauds[0]))
+
+// Wire-paced stream over DMA with the task called every gap_ns; returns
+// packets lost plus bytes overrun
+static uint32_t run_wire(const stream_t* s, uint32_t baud, uint64_t gap_ns)
+{
+    host_start(true, baud);
+    uint32_t ring0 = uart_host_get_rx_overruns();
+    uint32_t fifo0 = uart_pipe_rx_overruns(UART_HOST_PERIPHERAL);
+    uart_pipe_rx_send(UART_HOST_PERIPHERAL, s->bytes, s->len);
+
+    while (uart_pipe_rx_pending(UART_HOST_PERIPHERAL)) {
+        uart_pipe_advance_ns(UART_HOST_PERIPHERAL, gap_ns);
+        task_quiet();
+    }
+    task_quiet();
+
+    uint32_t delivered = match_log(s, link_log, link_count).matched;
+
+    return (s->count - delivered) + (uart_pipe_rx_overruns(UART_HOST_PERIPHERAL) - fifo0) +
+           (uart_host_get_rx_overruns() - ring0);
+}
+
+static void run_line_rate(const stream_t* s)
+{
+    for (size_t i = 0; i < LINE_BAUDS; i++) {
+        uint32_t lost = run_wire(s, line_bauds[i], BUSY_NS);
+        char label[64];
+        snprintf(label, sizeof(label), "DMA ring lossless at %u baud", line_bauds[i]);
+        check(label, lost, s->count);
+    }
+
+    // 5ms stall at 3Mbaud is ~1500 bytes, more than the ring holds
+    host_start(true, 3000000);
+    uint32_t ring0 = uart_host_get_rx_overruns();
+    uart_pipe_rx_send(UART_HOST_PERIPHERAL, s->bytes, s->len);
+    uart_pipe_advance_ns(UART_HOST_PERIPHERAL, 5 * BUSY_NS);
+    task_quiet();
+    uint32_t overrun = uart_host_get_rx_overruns() - ring0;
+    uint32_t after_stall = link_count;
+    while (uart_pipe_rx_pending(UART_HOST_PERIPHERAL)) {
+        uart_pipe_advance_ns(UART_HOST_PERIPHERAL, BUSY_NS);
+        task_quiet();
+    }
+    task_quiet();
+    uint32_t tail_delivered = link_count - after_stall;
+
+    check("ring overrun counted", overrun == 0, 1);
+    check("reception recovers after overrun", tail_delivered == 0, 1);
+}
+
+void checks_uart_host(void)
+{
+    srand(1);
+
+    stream_t line;
+    stream_build(&line, STREAM_PACKETS, 0);
+
+    // The host keeps its DMA channel once claimed, so the fallback goes first
+    check_section("fragmented stream, FIFO fallback");
+    run_fragmented(STREAM_PACKETS, false);
+    check_section("fragmented stream, DMA ring");
+    run_fragmented(STREAM_PACKETS, true);
+    check_section("corrupted stream");
+    run_corrupted(STREAM_PACKETS);
+    check_section("corrupt LEN then idle line");
+    run_idle_resync();
+    check_section("line rate, task every 1 ms");
+    run_line_rate(&line);
+    stream_free(&line);
+}
@@ -0,0 +1,300 @@
+// usbd_multi.c - Composite multi-pad descriptors and per-pad send scheduling
+//
+// Walks hid_multi_config_descriptor the way a host would at enumeration:
+// total length, interface numbering, one interrupt IN endpoint per pad at
+// bInterval 1, no endpoint shared with CDC, and periodic bandwidth within
+// the full-speed 90% limit. Then runs usb/usbd/usbd_multi.c with four
+// controllers changing every millisecond against a host polling each
+// endpoint once per frame, with the usbd task at main-loop cadence: with
+// one endpoint per pad every pad must keep 1 kHz, and behind one shared
+// endpoint the start rotation must split the frames evenly.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tusb.h"
+#include "usb/usbd/descriptors/hid_multi_descriptors.h"
+#include "usb/usbd/usbd_multi.h"
+#include "usb/usbd/usbd.h"
+#include "checks.h"
+
+#define SIM_SECONDS         10u
+
+#define FRAME_US            1000    // Full-speed frame (SOF interval)
+#define TASK_US             100     // Main loop period between usbd_task() calls
+#define TASK_JITTER_US      150     // Extra main-loop delay (other tasks running)
+#define INPUT_JITTER_US     50      // Controller report jitter (1 ms USB host polling)
+#define POLL_SPACING_US     30      // Spacing of the host's IN tokens within a frame
+
+#define FS_FRAME_BYTES      1500    // Full-speed bytes per frame
+#define FS_PERIODIC_PCT     90      // USB 2.0 5.7.4: periodic transfers <= 90%
+#define FS_INT_OVERHEAD     13      // USB 2.0 5.7.3: interrupt transaction overhead
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+static void check_device_descriptor(void)
+{
+    const tusb_desc_device_t* d = &hid_multi_device_descriptor;
+
+    check("device descriptor length", d->bLength != 18, 1);
+    check("PID differs from single-pad DInput", d->idProduct == USB_HID_PID, 1);
+#if CFG_TUD_CDC > 0
+    check("IAD device class (composite with CDC)",
+          d->bDeviceClass != TUSB_CLASS_MISC || d->bDeviceSubClass != MISC_SUBCLASS_COMMON ||
+          d->bDeviceProtocol != MISC_PROTOCOL_IAD, 1);
+#endif
+}
+
+static void check_config_descriptor(void)
+{
+    const uint8_t* desc = hid_multi_config_descriptor;
+    const size_t size = sizeof(hid_multi_config_descriptor);
+
+    uint16_t total_len = (uint16_t)(desc[2] | (desc[3] << 8));
+    check("wTotalLength matches descriptor size", total_len != size, 1);
+
+    uint8_t seen_itf[32] = {0};
+    uint8_t seen_ep[32] = {0};
+    uint32_t itf_count = 0, hid_count = 0, hid_bad = 0, ep_dupes = 0, ep_bad = 0;
+    uint32_t malformed = 0, periodic_bytes = 0;
+    int current_class = -1;
+    int current_itf = -1;
+    int expected_itf = 0;
+    uint32_t itf_order_bad = 0;
+    uint32_t hid_ep_count = 0;
+
+    size_t pos = 0;
+    while (pos < size) {
+        uint8_t len = desc[pos];
+        if (len < 2 || pos + len > size) {
+            malformed++;
+            break;
+        }
+        uint8_t type = desc[pos + 1];
+
+        if (type == TUSB_DESC_INTERFACE) {
+            uint8_t num = desc[pos + 2];
+            uint8_t alt = desc[pos + 3];
+            current_class = desc[pos + 5];
+            current_itf = num;
+            if (alt == 0 && num < 32 && !seen_itf[num]) {
+                seen_itf[num] = 1;
+                itf_count++;
+                if (num != expected_itf) itf_order_bad++;
+                expected_itf = num + 1;
+            }
+            if (current_class == TUSB_CLASS_HID) {
+                hid_count++;
+                if (desc[pos + 4] != 1) hid_bad++;   // One IN endpoint per pad
+            }
+        } else if (type == HID_DESC_TYPE_HID) {
+            uint16_t report_len = (uint16_t)(desc[pos + 7] | (desc[pos + 8] << 8));
+            if (report_len != sizeof(hid_report_descriptor)) hid_bad++;
+        } else if (type == TUSB_DESC_ENDPOINT) {
+            uint8_t addr = desc[pos + 2];
+            uint8_t attr = desc[pos + 3];
+            uint16_t mps = (uint16_t)(desc[pos + 4] | (desc[pos + 5] << 8));
+            uint8_t interval = desc[pos + 6];
+            uint8_t slot = (uint8_t)((addr & 0x0F) | ((addr & 0x80) ? 0x10 : 0));
+
+            if ((addr & 0x0F) == 0 || (addr & 0x70)) ep_bad++;
+            if (seen_ep[slot]) ep_dupes++;
+            seen_ep[slot] = 1;
+
+            if ((attr & 0x03) == TUSB_XFER_INTERRUPT) {
+                periodic_bytes += mps + FS_INT_OVERHEAD;
+            }
+            if (current_class == TUSB_CLASS_HID) {
+                hid_ep_count++;
+                if (!(addr & 0x80) || (attr & 0x03) != TUSB_XFER_INTERRUPT || interval != 1 ||
+                    mps < sizeof(joypad_hid_report_t)) {
+                    hid_bad++;
+                }
+                if (current_itf >= HID_MULTI_PADS) hid_bad++;
+            }
+        }
+        pos += len;
+    }
+
+    check("descriptor chain well formed", malformed, 1);
+    check("bNumInterfaces matches interfaces", desc[4] != itf_count, 1);
+    check("interface numbers sequential from 0", itf_order_bad, itf_count);
+    check("one HID interface per pad", hid_count != HID_MULTI_PADS, 1);
+    check("pad interfaces: 1 IN EP, 1 ms, fits report", hid_bad, hid_count);
+    check("pad endpoints present", hid_ep_count != HID_MULTI_PADS, 1);
+    check("endpoint addresses unique (pads + CDC)", ep_dupes, 1);
+    check("endpoint numbers 1..15", ep_bad, 1);
+
+    uint32_t limit = FS_FRAME_BYTES * FS_PERIODIC_PCT / 100;
+    check("periodic bandwidth within 90% of frame", periodic_bytes > limit, 1);
+}
+
+// ============================================================================
+// SCHEDULING SIMULATION
+// ============================================================================
+
+typedef struct {
+    bool armed;             // Report queued, waiting for the host's IN token
+    bool done;              // Host collected it; completion not yet processed
+    uint8_t pad;            // Pad whose report is queued
+    uint64_t input_us;      // When the queued input arrived
+    uint32_t input_seq;
+} sim_ep_t;
+
+typedef struct {
+    bool pending;           // Input waiting to be sent (usbd pending_flags)
+    uint64_t input_us;
+    uint32_t seq;           // Inputs produced
+    uint32_t last_delivered_seq;
+    uint64_t input_base_us; // Controller's 1 ms polling grid
+    uint64_t next_input_us;
+
+    uint32_t reports;       // Reports collected by the host
+    uint32_t inputs_seen;   // Distinct inputs that reached the host
+    uint64_t latency_max;
+} sim_pad_t;
+
+typedef struct {
+    sim_ep_t eps[USBD_MULTI_MAX_PADS];
+    sim_pad_t pads[USBD_MULTI_MAX_PADS];
+    uint8_t ep_count;       // 1 = shared endpoint, else one per pad
+} sim_t;
+
+static sim_t sim;
+
+static sim_ep_t* sim_ep(uint8_t pad)
+{
+    return &sim.eps[sim.ep_count == 1 ? 0 : pad];
+}
+
+static bool sim_ready(uint8_t pad)
+{
+    return !sim_ep(pad)->armed;
+}
+
+static bool sim_send(uint8_t pad)
+{
+    sim_pad_t* p = &sim.pads[pad];
+    if (!p->pending) return false;
+
+    sim_ep_t* ep = sim_ep(pad);
+    ep->armed = true;
+    ep->done = false;
+    ep->pad = pad;
+    ep->input_us = p->input_us;
+    ep->input_seq = p->seq;
+    p->pending = false;
+    return true;
+}
+
+typedef struct {
+    const char* name;
+    uint8_t ep_count;
+} sim_case_t;
+
+static void run_case(const sim_case_t* c, uint32_t seconds, sim_pad_t* results)
+{
+    memset(&sim, 0, sizeof(sim));
+    sim.ep_count = c->ep_count;
+
+    usbd_multi_sched_t sched;
+    usbd_multi_init(&sched, HID_MULTI_PADS);
+
+    for (uint8_t p = 0; p < HID_MULTI_PADS; p++) {
+        sim.pads[p].input_base_us = (uint64_t)p * (FRAME_US / HID_MULTI_PADS);
+        sim.pads[p].next_input_us = sim.pads[p].input_base_us;
+    }
+
+    const uint64_t end_us = (uint64_t)seconds * 1000000u;
+    uint64_t next_task_us = 0;
+
+    for (uint64_t t = 0; t < end_us; t++) {
+        // Controllers: a new state every millisecond
+        for (uint8_t p = 0; p < HID_MULTI_PADS; p++) {
+            sim_pad_t* pad = &sim.pads[p];
+            if (t >= pad->next_input_us) {
+                pad->pending = true;
+                pad->input_us = t;
+                pad->seq++;
+                pad->input_base_us += FRAME_US;
+                pad->next_input_us = pad->input_base_us + check_rng() % INPUT_JITTER_US;
+            }
+        }
+
+        // Host: one IN token per interrupt endpoint per frame
+        uint32_t in_frame = (uint32_t)(t % FRAME_US);
+        if (in_frame % POLL_SPACING_US == 0 && in_frame / POLL_SPACING_US < sim.ep_count) {
+            sim_ep_t* ep = &sim.eps[in_frame / POLL_SPACING_US];
+            if (ep->armed && !ep->done) {
+                sim_pad_t* pad = &sim.pads[ep->pad];
+                uint64_t latency = t - ep->input_us;
+                ep->done = true;
+                pad->reports++;
+                if (ep->input_seq != pad->last_delivered_seq) {
+                    pad->inputs_seen++;
+                    pad->last_delivered_seq = ep->input_seq;
+                }
+                if (latency > pad->latency_max) pad->latency_max = latency;
+            }
+        }
+
+        // Device: usbd_task() processes completions, then services the pads
+        if (t >= next_task_us) {
+            for (uint8_t e = 0; e < sim.ep_count; e++) {
+                if (sim.eps[e].done) {
+                    sim.eps[e].armed = false;
+                    sim.eps[e].done = false;
+                }
+            }
+            usbd_multi_service(&sched, sim_ready, sim_send);
+            next_task_us = t + TASK_US + check_rng() % TASK_JITTER_US;
+        }
+    }
+
+    memcpy(results, sim.pads, sizeof(sim.pads));
+}
+
+static void check_scheduling(uint32_t seconds)
+{
+    static const sim_case_t cases[] = {
+        { "Per-pad endpoints (usbd_multi_service)", HID_MULTI_PADS },
+        { "Shared endpoint, round-robin", 1 },
+    };
+    static sim_pad_t results[2][USBD_MULTI_MAX_PADS];
+
+    for (size_t i = 0; i < 2; i++) {
+        run_case(&cases[i], seconds, results[i]);
+    }
+
+    uint32_t slow = 0, late = 0, missed = 0, unfair = 0;
+    uint32_t min_reports = UINT32_MAX, max_reports = 0;
+    for (uint8_t p = 0; p < HID_MULTI_PADS; p++) {
+        const sim_pad_t* pad = &results[0][p];
+        if (pad->reports < 990 * seconds) slow++;
+        if (pad->reports < min_reports) min_reports = pad->reports;
+        if (pad->reports > max_reports) max_reports = pad->reports;
+        if (pad->inputs_seen + pad->seq / 100 < pad->seq) missed++;
+        if (pad->latency_max > 2 * FRAME_US + TASK_US + TASK_JITTER_US) late++;
+
+        // Shared endpoint: one report per frame, split evenly by rotation
+        if (results[1][p].reports * 100 < (1000 / HID_MULTI_PADS) * seconds * 95) unfair++;
+    }
+    check("per-pad endpoints: every pad >= 990 reports/s", slow, HID_MULTI_PADS);
+    check("per-pad endpoints: pads within 1% of each other",
+          (max_reports - min_reports) * 100 > max_reports, 1);
+    check("per-pad endpoints: >= 99% of inputs reach host", missed, HID_MULTI_PADS);
+    check("per-pad endpoints: max latency <= 2 frames + task", late, HID_MULTI_PADS);
+    check("shared endpoint: rotation gives each pad 1/4", unfair, HID_MULTI_PADS);
+}
+
+void checks_usbd_multi(void)
+{
+    check_section("descriptors");
+    check_device_descriptor();
+    check_config_descriptor();
+
+    check_section("scheduling");
+    check_scheduling(SIM_SECONDS);
+}
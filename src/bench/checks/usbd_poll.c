@@ -0,0 +1,321 @@
+// usbd_poll.c - Polling interval override and poll-aligned submission
+//
+// Descriptors: patches every mode's configuration descriptor to 1/2/4/8 ms
+// and checks that only the gamepad interrupt IN endpoints changed (CDC,
+// OUT endpoints and every other byte untouched) and that each fits the
+// RAM copy usbd.c serves.
+//
+// Submission: simulates a controller reporting every millisecond (with
+// jitter), a host polling the IN endpoint once per interval at a fixed
+// offset into the frame, and the usbd task running at main-loop cadence.
+// For each interval it compares:
+//
+//   immediate   queue as soon as the endpoint is idle (previous behaviour)
+//   aligned     usbd_poll_arm_now(): hold until just before the next poll
+//
+// by the true age of the input each collected report carries, and checks
+// the latency the module records against that ground truth. A slow main
+// loop (longer than the arm window) must not starve the endpoint.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tusb.h"
+#include "usb/usbd/descriptors/xbox_og_descriptors.h"
+#include "usb/usbd/descriptors/xinput_descriptors.h"
+#include "usb/usbd/descriptors/switch_descriptors.h"
+#include "usb/usbd/descriptors/ps3_descriptors.h"
+#include "usb/usbd/descriptors/psclassic_descriptors.h"
+#include "usb/usbd/descriptors/ps4_descriptors.h"
+#include "usb/usbd/descriptors/xbone_descriptors.h"
+#include "usb/usbd/descriptors/xac_descriptors.h"
+#include "usb/usbd/descriptors/hid_multi_descriptors.h"
+#include "usb/usbd/usbd_poll.h"
+#include "checks.h"
+
+#define SIM_SECONDS         20u
+#define CONFIG_BUF_SIZE     256     // usbd.c CONFIG_DESC_BUF_SIZE
+
+#define INPUT_PERIOD_US     1000    // Controller report rate
+#define INPUT_JITTER_US     50
+#define TASK_US             100     // Main loop period between usbd_task() calls
+#define TASK_JITTER_US      150     // Extra main-loop delay (other tasks running)
+#define POLL_OFFSET_US      370     // Host's IN token offset into the frame
+
+// Reseeded per simulation so immediate and aligned see the same input
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+typedef struct {
+    const char* mode;
+    const uint8_t* config;
+} mode_config_t;
+
+static const mode_config_t mode_configs[] = {
+    { "Xbox Original", xbox_og_config_descriptor   },
+    { "XInput",        xinput_config_descriptor    },
+    { "Switch",        switch_config_descriptor    },
+    { "PS3",           ps3_config_descriptor       },
+    { "PS Classic",    psclassic_config_descriptor },
+    { "PS4",           ps4_config_descriptor       },
+    { "Xbox One",      xbone_config_descriptor     },
+    { "XAC",           xac_config_descriptor       },
+    { "DInput x4",     hid_multi_config_descriptor },
+};
+
+#define MODE_CONFIGS (sizeof(mode_configs) / sizeof(mode_configs[0]))
+
+static uint16_t total_length(const uint8_t* config)
+{
+    return (uint16_t)(config[2] | (config[3] << 8));
+}
+
+// Independent walk: which byte offsets are gamepad interrupt IN bIntervals
+static uint32_t find_gamepad_intervals(const uint8_t* config, uint16_t* offsets, uint32_t max)
+{
+    uint16_t total = total_length(config);
+    uint32_t count = 0;
+    int itf_class = -1;
+
+    for (uint16_t pos = 0; pos + 2 <= total && config[pos] >= 2; pos += config[pos]) {
+        const uint8_t* d = &config[pos];
+        if (d[1] == TUSB_DESC_INTERFACE) {
+            itf_class = d[5];
+        } else if (d[1] == TUSB_DESC_ENDPOINT && (d[2] & 0x80) &&
+                   (d[3] & 0x03) == TUSB_XFER_INTERRUPT &&
+                   itf_class != TUSB_CLASS_CDC && itf_class != TUSB_CLASS_CDC_DATA) {
+            if (count < max) offsets[count] = (uint16_t)(pos + 6);
+            count++;
+        }
+    }
+    return count;
+}
+
+static void check_descriptors(void)
+{
+    static const uint8_t intervals[] = { 1, 2, 4, 8 };
+    uint8_t buf[CONFIG_BUF_SIZE];
+    uint32_t fit_bad = 0, patch_bad = 0, other_bad = 0, read_bad = 0, none = 0, total = 0;
+
+    for (size_t m = 0; m < MODE_CONFIGS; m++) {
+        const uint8_t* config = mode_configs[m].config;
+        uint16_t len = total_length(config);
+        uint16_t offsets[8];
+        uint32_t eps = find_gamepad_intervals(config, offsets, 8);
+        uint8_t def = usbd_poll_config_interval(config);
+        if (eps == 0) none++;
+        if (eps > 0 && def != config[offsets[0]]) read_bad++;
+
+        for (size_t i = 0; i < sizeof(intervals); i++) {
+            total++;
+            memset(buf, 0xEE, sizeof(buf));
+            if (usbd_poll_patch_config(buf, sizeof(buf), config, intervals[i]) != len) {
+                fit_bad++;
+                continue;
+            }
+            uint32_t hit = 0;
+            for (uint16_t b = 0; b < len; b++) {
+                bool is_interval = false;
+                for (uint32_t e = 0; e < eps && e < 8; e++) is_interval |= (offsets[e] == b);
+                if (is_interval) {
+                    hit += (buf[b] == intervals[i]);
+                } else if (buf[b] != config[b]) {
+                    other_bad++;
+                }
+            }
+            if (hit != eps) patch_bad++;
+            if (usbd_poll_config_interval(buf) != intervals[i]) read_bad++;
+        }
+
+        // Mode default copies unchanged
+        if (usbd_poll_patch_config(buf, sizeof(buf), config, USBD_POLL_INTERVAL_DEFAULT) != len ||
+            memcmp(buf, config, len) != 0) {
+            other_bad++;
+        }
+    }
+
+    uint8_t tiny[16];
+    check("every mode has a gamepad interrupt IN endpoint", none, MODE_CONFIGS);
+    check("descriptor fits the RAM copy", fit_bad, total);
+    check("gamepad IN endpoints set to the interval", patch_bad, total);
+    check("other bytes (CDC, OUT, class) unchanged", other_bad, total);
+    check("interval read back", read_bad, total + MODE_CONFIGS);
+    check("too-small buffer refused",
+          usbd_poll_patch_config(tiny, sizeof(tiny), hid_multi_config_descriptor, 1) != 0, 1);
+    check("interval setting validation",
+          !usbd_poll_interval_valid(0) || !usbd_poll_interval_valid(8) ||
+          usbd_poll_interval_valid(3) || usbd_poll_interval_valid(16), 1);
+}
+
+// ============================================================================
+// SUBMISSION SIMULATION
+// ============================================================================
+
+typedef struct {
+    uint32_t interval_ms;
+    uint32_t task_us;           // Main loop period
+    uint32_t task_jitter_us;
+    bool aligned;
+    uint32_t seconds;
+} sim_config_t;
+
+typedef struct {
+    uint32_t collected;         // Reports the host collected
+    uint32_t polls;             // Host polls
+    uint64_t age_sum;           // True input age at collection
+    usbd_latency_t measured;    // What the module recorded
+    uint32_t held;
+} sim_result_t;
+
+static sim_result_t simulate(const sim_config_t* cfg)
+{
+    sim_result_t r;
+    memset(&r, 0, sizeof(r));
+    rng_state = 0x13579BDFu;    // Same input phase for every variant
+    usbd_poll_sched_t sched;
+    usbd_poll_init(&sched, (uint8_t)cfg->interval_ms, cfg->aligned);
+
+    const uint64_t end = (uint64_t)cfg->seconds * 1000000u;
+    const uint64_t period = cfg->interval_ms * 1000u;
+
+    // Endpoint state: armed report and the input it carries
+    bool armed = false;
+    uint64_t armed_input_us = 0;
+    bool done = false;          // Collected, completion not yet seen by the task
+
+    bool pending = false;
+    uint64_t pending_us = 0;
+
+    uint64_t next_input = rng() % INPUT_PERIOD_US;
+    uint64_t input_base = next_input;
+    uint64_t next_poll = POLL_OFFSET_US;
+    uint64_t next_task = rng() % cfg->task_us;
+
+    // Device clock starts at an arbitrary 32-bit value (wraps during the run)
+    const uint32_t clock_base = 0xFFFFFFFFu - 3000000u;
+
+    while (next_task < end) {
+        uint64_t t = next_input;
+        if (next_poll < t) t = next_poll;
+        if (next_task < t) t = next_task;
+
+        if (t == next_input) {
+            pending = true;
+            pending_us = t;
+            input_base += INPUT_PERIOD_US;
+            next_input = input_base + rng() % INPUT_JITTER_US;
+        } else if (t == next_poll) {
+            r.polls++;
+            if (armed) {
+                uint32_t age = (uint32_t)(t - armed_input_us);
+                r.collected++;
+                r.age_sum += age;
+                armed = false;
+                done = true;
+            }
+            next_poll += period;
+        } else {
+            uint32_t now = clock_base + (uint32_t)t;
+            if (done) {
+                usbd_poll_idle(&sched, 0, now);
+                done = false;
+            }
+            if (pending && !armed && usbd_poll_arm_now(&sched, now)) {
+                armed = true;
+                armed_input_us = pending_us;
+                pending = false;
+                usbd_poll_armed(&sched, 0, clock_base + (uint32_t)pending_us);
+            }
+            next_task = t + cfg->task_us + (cfg->task_jitter_us ? rng() % cfg->task_jitter_us : 0);
+        }
+    }
+
+    r.measured = sched.latency;
+    r.held = sched.held;
+    return r;
+}
+
+static void run_intervals(uint32_t seconds)
+{
+    static const uint32_t intervals[] = { 1, 2, 4, 8 };
+
+    for (size_t i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++) {
+        sim_config_t cfg = { intervals[i], TASK_US, TASK_JITTER_US, false, seconds };
+        sim_result_t imm = simulate(&cfg);
+        cfg.aligned = true;
+        sim_result_t ali = simulate(&cfg);
+
+        char label[64];
+        snprintf(label, sizeof(label), "aligned collects every poll (%u ms)", intervals[i]);
+        check(label, ali.polls - ali.collected > ali.polls / 100 ? ali.polls - ali.collected : 0, ali.polls);
+        // At 1 ms the controller rate matches the poll rate, so there is no
+        // newer input to wait for: aligned must just not be worse
+        uint64_t ali_mean = ali.age_sum / ali.collected;
+        uint64_t imm_mean = imm.age_sum / imm.collected;
+        if (intervals[i] == 1) {
+            check("aligned mean age within 5% of immediate (1 ms)", ali_mean * 100 > imm_mean * 105, 1);
+        } else {
+            snprintf(label, sizeof(label), "aligned mean age below half of immediate (%u ms)", intervals[i]);
+            check(label, ali_mean * 2 >= imm_mean, 1);
+        }
+
+        // Recorded latency trails the true age by at most one task pass
+        uint32_t slack = TASK_US + TASK_JITTER_US;
+        uint64_t true_mean = ali.age_sum / ali.collected;
+        uint64_t meas_mean = ali.measured.sum_us / ali.measured.count;
+        snprintf(label, sizeof(label), "recorded latency tracks true age (%u ms)", intervals[i]);
+        check(label, ali.measured.count != ali.collected ||
+              meas_mean < true_mean || meas_mean > true_mean + slack, 1);
+    }
+}
+
+static void run_slow_loop(uint32_t seconds)
+{
+    // Main loop slower than the arm window: must still make every other poll
+    sim_config_t cfg = { 1, 600, 400, true, seconds };
+    sim_result_t ali = simulate(&cfg);
+    cfg.aligned = false;
+    sim_result_t imm = simulate(&cfg);
+
+    check("aligned delivers as many reports as immediate (-2%)",
+          ali.collected * 100 < imm.collected * 98 ? imm.collected - ali.collected : 0, imm.collected);
+}
+
+static void check_latency_stats(void)
+{
+    usbd_latency_t lat;
+    usbd_latency_reset(&lat);
+    check("empty stats percentile", usbd_latency_percentile(&lat, 50) != 0, 1);
+
+    for (uint32_t i = 0; i < 100; i++) usbd_latency_record(&lat, i * 100);   // 0..9900us
+    uint32_t bad = 0;
+    bad += lat.count != 100 || lat.min_us != 0 || lat.max_us != 9900;
+    bad += usbd_latency_percentile(&lat, 50) != 5000;
+    bad += usbd_latency_percentile(&lat, 99) != 9900;   // Overflow bucket reports max
+    bad += usbd_latency_percentile(&lat, 1) != 250;
+    check("latency min/max/percentiles", bad, 4);
+}
+
+void checks_usbd_poll(void)
+{
+    check_section("descriptor patching");
+    check_descriptors();
+    check_section("latency statistics");
+    check_latency_stats();
+
+    check_section("submission");
+    run_intervals(SIM_SECONDS);
+    run_slow_loop(SIM_SECONDS);
+}
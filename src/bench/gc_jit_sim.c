@@ -0,0 +1,298 @@
+// gc_jit_sim.c - Host simulation of the GameCube joybus poll/response cycle
+//
+// Replays a USB controller (router_submit_input at a fixed report rate)
+// against a console polling at its own rate, and compares:
+//   LEGACY - report built after the previous reply (one poll stale)
+//   JIT    - report built between poll detection and the reply (GC_JIT_REPORT)
+//
+// Report age is measured from the input's arrival to the first reply bit.
+// The JIT window work (router_get_output + gc_report_build_pad) is timed on
+// the host and scaled to RP2040 cycles to check it against GC_JIT_BUDGET_CYCLES.
+// Host ticks are not M0+ cycles, so the budget is only checked when a scale
+// is given; without one the window is reported in host ticks and no verdict
+// is printed. With a scale, exits non-zero if any poll would reply late.
+//
+// Usage: gc_jit_sim [polls] [poll_us] [usb_us] [target_cycles_per_host_tick]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "core/router/router.h"
+#include "core/services/players/manager.h"
+#include "core/services/profiles/profile.h"
+#include "apps/usb2gc/profiles.h"
+#include "native/device/gamecube/gamecube_report.h"
+#include "bench_util.h"
+
+// ============================================================================
+// JOYBUS TIMING MODEL
+// ============================================================================
+
+#define JOYBUS_BIT_NS       4000u                       // 4us per bit
+#define POLL_CMD_NS         (25u * JOYBUS_BIT_NS)       // 24-bit poll + stop bit
+#define REPLY_DELAY_NS      (GC_JIT_BUDGET_US * 1000u)  // Poll detect → first reply bit
+#define REPLY_NS            (65u * JOYBUS_BIT_NS)       // 64-bit report + stop bit
+
+#define DEFAULT_POLLS       20000u
+#define DEFAULT_POLL_US     16683u      // Once per frame (60Hz)
+#define DEFAULT_USB_US      1000u       // 1kHz USB controller
+
+typedef enum {
+    SIM_LEGACY,
+    SIM_JIT,
+} sim_mode_t;
+
+typedef struct {
+    uint32_t polls;
+    uint32_t fresh;
+    uint32_t late;
+    double age_avg_us;
+    uint32_t age_p50_us;
+    uint32_t age_p99_us;
+    uint32_t age_max_us;
+    uint32_t window_p50;
+    uint32_t window_p99;
+    uint32_t window_max;
+} sim_result_t;
+
+static uint32_t polls = DEFAULT_POLLS;
+static uint32_t poll_us = DEFAULT_POLL_US;
+static uint32_t usb_us = DEFAULT_USB_US;
+static double cycle_scale = 0.0;  // RP2040 cycles per host tick, 0 = uncalibrated
+
+static uint32_t* age_samples = NULL;
+static uint32_t* window_samples = NULL;
+
+// Profile under test: "ssbm" exercises button map, sensitivity and modifiers
+static const profile_t* sim_profile = &gc_profiles[2];
+
+static const profile_config_t sim_profile_config = {
+    .output_profiles = {
+        [OUTPUT_TARGET_GAMECUBE] = &gc_profile_set,
+    },
+    .shared_profiles = NULL,
+};
+
+// ============================================================================
+// INPUT SOURCE
+// ============================================================================
+
+static uint32_t rng_state;
+static uint64_t next_input_ns;
+static uint64_t latest_input_ns;
+
+static uint32_t xorshift32(void)
+{
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+// Submit every USB report that has arrived by t_ns
+static void inputs_until(uint64_t t_ns)
+{
+    while (next_input_ns <= t_ns) {
+        input_event_t ev;
+        init_input_event(&ev);
+        ev.dev_addr = 1;
+        ev.instance = 0;
+        ev.type = INPUT_TYPE_GAMEPAD;
+        ev.transport = INPUT_TRANSPORT_USB;
+        ev.buttons = (xorshift32() & 0x0003FFFF) & ~JP_BUTTON_S1;
+        for (int axis = 0; axis < 4; axis++) {
+            ev.analog[axis] = (uint8_t)xorshift32();
+        }
+        ev.analog[ANALOG_RZ] = (uint8_t)xorshift32();
+        ev.analog[ANALOG_SLIDER] = (uint8_t)xorshift32();
+        router_submit_input(&ev);
+
+        latest_input_ns = next_input_ns;
+        // USB frame jitter: +/-125us around the nominal interval
+        next_input_ns += (uint64_t)usb_us * 1000u - 125000u + (xorshift32() % 250000u);
+    }
+}
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+static gc_report_t sim_report;
+static uint64_t report_input_ns;
+
+// Same work core 1 does in the poll-to-reply window (gamepad mode)
+static bool sim_build_report(void)
+{
+    const input_state_t* event = router_get_output(OUTPUT_TARGET_GAMECUBE, 0);
+    if (!event) return false;
+
+    gc_report_t new_report = default_gc_report;
+    gc_report_build_pad(event, sim_profile, &new_report);
+    sim_report = new_report;
+    return true;
+}
+
+static void sim_setup(void)
+{
+    router_config_t cfg = {
+        .mode = ROUTING_MODE_MERGE,
+        .merge_mode = MERGE_BLEND,
+        .max_players_per_output = {
+            [OUTPUT_TARGET_GAMECUBE] = 4,
+        },
+        .merge_all_inputs = true,
+        .transform_flags = TRANSFORM_MOUSE_TO_ANALOG,
+        .mouse_drain_rate = 8,
+    };
+    player_config_t player_cfg = {
+        .slot_mode = PLAYER_SLOT_FIXED,
+        .max_slots = MAX_PLAYERS,
+        .auto_assign_on_press = true,
+    };
+
+    players_init_with_config(&player_cfg);
+    router_init(&cfg);
+    router_add_route(INPUT_SOURCE_USB_HOST, OUTPUT_TARGET_GAMECUBE, 0);
+    profile_init(&sim_profile_config);
+
+    rng_state = 0x9E3779B9u;
+    next_input_ns = 0;
+    latest_input_ns = 0;
+    report_input_ns = 0;
+    sim_report = default_gc_report;
+
+    // Drain anything left in the output slot from a previous run
+    while (router_get_output(OUTPUT_TARGET_GAMECUBE, 0)) {}
+}
+
+static void sim_run(sim_mode_t mode, sim_result_t* result)
+{
+    quiet_begin();
+    sim_setup();
+
+    uint64_t t_poll = 1000000u;  // Console starts polling after 1ms
+    uint64_t age_sum = 0;
+    uint32_t window_count = 0;
+
+    memset(result, 0, sizeof(*result));
+
+    for (uint32_t i = 0; i < polls; i++) {
+        uint64_t t_detect = t_poll + POLL_CMD_NS;
+        uint64_t t_reply = t_detect + REPLY_DELAY_NS;
+
+        if (mode == SIM_JIT) {
+            inputs_until(t_detect);
+
+            uint64_t c0 = now_cycles();
+            bool fresh = sim_build_report();
+            uint64_t c1 = now_cycles();
+
+            uint32_t ticks = (uint32_t)(c1 - c0);
+            window_samples[window_count++] = cycle_scale > 0.0 ? (uint32_t)(ticks * cycle_scale)
+                                                               : ticks;
+
+            if (fresh) {
+                result->fresh++;
+                report_input_ns = latest_input_ns;
+            }
+            uint32_t target_cycles = window_samples[window_count - 1];
+            if (cycle_scale > 0.0 && target_cycles > GC_JIT_BUDGET_CYCLES) {
+                // Reply starts late by the overrun
+                result->late++;
+                t_reply = t_detect + (uint64_t)target_cycles * 1000000u / GC_CPU_KHZ;
+            }
+        }
+
+        uint32_t age_us = (uint32_t)((t_reply - report_input_ns) / 1000u);
+        age_samples[i] = age_us;
+        age_sum += age_us;
+
+        if (mode == SIM_LEGACY) {
+            // update_output() runs after the reply has been clocked out
+            inputs_until(t_reply + REPLY_NS);
+            if (sim_build_report()) {
+                result->fresh++;
+                report_input_ns = latest_input_ns;
+            }
+        }
+
+        // Console poll interval with +/-50us jitter
+        t_poll += (uint64_t)poll_us * 1000u - 50000u + (xorshift32() % 100000u);
+    }
+    quiet_end();
+
+    result->polls = polls;
+    result->age_avg_us = (double)age_sum / polls;
+    qsort(age_samples, polls, sizeof(uint32_t), compare_u32);
+    result->age_p50_us = percentile_u32(age_samples, polls, 50);
+    result->age_p99_us = percentile_u32(age_samples, polls, 99);
+    result->age_max_us = age_samples[polls - 1];
+
+    if (window_count) {
+        qsort(window_samples, window_count, sizeof(uint32_t), compare_u32);
+        result->window_p50 = percentile_u32(window_samples, window_count, 50);
+        result->window_p99 = percentile_u32(window_samples, window_count, 99);
+        result->window_max = window_samples[window_count - 1];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && atol(argv[1]) > 0) polls = (uint32_t)atol(argv[1]);
+    if (argc > 2 && atol(argv[2]) > 0) poll_us = (uint32_t)atol(argv[2]);
+    if (argc > 3 && atol(argv[3]) > 0) usb_us = (uint32_t)atol(argv[3]);
+    if (argc > 4 && atof(argv[4]) > 0) cycle_scale = atof(argv[4]);
+
+    age_samples = malloc((size_t)polls * sizeof(uint32_t));
+    window_samples = malloc((size_t)polls * sizeof(uint32_t));
+    if (!age_samples || !window_samples) {
+        fprintf(stderr, "gc_jit_sim: cannot allocate %u samples\n", polls);
+        return 1;
+    }
+
+    printf("GameCube joybus poll/response simulation\n");
+    printf("  polls: %u, poll interval: %uus, USB interval: %uus, profile: %s\n",
+           polls, poll_us, usb_us, sim_profile->name);
+    printf("  reply window: %uus (%d cycles @ %dMHz), ",
+           GC_JIT_BUDGET_US, GC_JIT_BUDGET_CYCLES, GC_CPU_KHZ / 1000);
+    if (cycle_scale > 0.0) {
+        printf("host tick scale: %.3f\n\n", cycle_scale);
+    } else {
+        printf("host tick scale: uncalibrated\n\n");
+    }
+
+    sim_result_t legacy, jit;
+    sim_run(SIM_LEGACY, &legacy);
+    sim_run(SIM_JIT, &jit);
+
+    printf("%-8s %8s %8s %12s %9s %9s %9s %6s\n",
+           "mode", "polls", "fresh", "age avg us", "p50 us", "p99 us", "max us", "late");
+    printf("%-8s %8u %8u %12.1f %9u %9u %9u %6u\n", "LEGACY",
+           legacy.polls, legacy.fresh, legacy.age_avg_us,
+           legacy.age_p50_us, legacy.age_p99_us, legacy.age_max_us, legacy.late);
+    printf("%-8s %8u %8u %12.1f %9u %9u %9u %6u\n", "JIT",
+           jit.polls, jit.fresh, jit.age_avg_us,
+           jit.age_p50_us, jit.age_p99_us, jit.age_max_us, jit.late);
+
+    int status = 0;
+    if (cycle_scale > 0.0) {
+        bool fits = jit.window_max <= GC_JIT_BUDGET_CYCLES && jit.late == 0;
+        printf("\nJIT window (RP2040 cycles): p50 %u, p99 %u, max %u / budget %d, late %u -> %s\n",
+               jit.window_p50, jit.window_p99, jit.window_max, GC_JIT_BUDGET_CYCLES,
+               jit.late, fits ? "fits" : "EXCEEDS BUDGET");
+        if (!fits) status = 1;
+    } else {
+        printf("\nJIT window (host ticks): p50 %u, p99 %u, max %u\n",
+               jit.window_p50, jit.window_p99, jit.window_max);
+        printf("No budget verdict: pass target_cycles_per_host_tick to check against %d cycles\n",
+               GC_JIT_BUDGET_CYCLES);
+    }
+
+    free(age_samples);
+    free(window_samples);
+    return status;
+}
@@ -0,0 +1,279 @@
+// router_bench.c - Host benchmark for the core input pipeline
+//
+// Pushes synthetic input_event_t reports through
+//   router_submit_input() -> router_get_output() -> profile_apply()
+// in every routing/merge mode and reports events/sec plus per-event
+// p50/p99 latency, so router changes can be compared objectively.
+//
+// Usage: router_bench [events_per_mode]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "core/router/router.h"
+#include "core/services/players/manager.h"
+#include "core/services/profiles/profile.h"
+#include "apps/usb2gc/profiles.h"
+#include "bench_util.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define DEFAULT_EVENTS      2000000u    // Events per mode
+#define EVENT_POOL_SIZE     4096u       // Pre-generated synthetic reports (power of 2)
+#define BENCH_DEVICES       4           // Simulated controllers on a hub
+#define BENCH_OUTPUT        OUTPUT_TARGET_GAMECUBE
+
+typedef struct {
+    const char* name;
+    routing_mode_t mode;
+    merge_mode_t merge_mode;
+} bench_mode_t;
+
+static const bench_mode_t bench_modes[] = {
+    { "SIMPLE",         ROUTING_MODE_SIMPLE,       MERGE_ALL      },
+    { "MERGE/PRIORITY", ROUTING_MODE_MERGE,        MERGE_PRIORITY },
+    { "MERGE/BLEND",    ROUTING_MODE_MERGE,        MERGE_BLEND    },
+    { "MERGE/ALL",      ROUTING_MODE_MERGE,        MERGE_ALL      },
+    { "BROADCAST",      ROUTING_MODE_BROADCAST,    MERGE_ALL      },
+    { "CONFIGURABLE",   ROUTING_MODE_CONFIGURABLE, MERGE_ALL      },
+};
+
+#define BENCH_MODE_COUNT (sizeof(bench_modes) / sizeof(bench_modes[0]))
+
+typedef struct {
+    double events_per_sec;
+    double ns_per_event;
+    double cycles_per_event;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+    uint32_t max_ns;
+    uint64_t outputs_consumed;
+} bench_result_t;
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static input_event_t event_pool[EVENT_POOL_SIZE];
+static uint32_t* latency_samples = NULL;
+
+// Sink so the compiler can't drop profile_apply() results
+static volatile uint32_t bench_sink;
+
+static uint32_t rng_state = 0x2545F491u;
+
+static uint32_t xorshift32(void)
+{
+    uint32_t x = rng_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    rng_state = x;
+    return x;
+}
+
+// Generate a pool of realistic gamepad reports: mostly small stick noise,
+// occasional full deflections, a handful of held buttons, rare mouse deltas.
+static void generate_events(void)
+{
+    for (uint32_t i = 0; i < EVENT_POOL_SIZE; i++) {
+        input_event_t* ev = &event_pool[i];
+        init_input_event(ev);
+
+        ev->dev_addr = 1 + (i % BENCH_DEVICES);
+        ev->instance = 0;
+        ev->type = INPUT_TYPE_GAMEPAD;
+        ev->transport = INPUT_TRANSPORT_USB;
+
+        uint32_t r = xorshift32();
+        ev->buttons = (r & 0x3) ? (xorshift32() & 0x0003FFFF) : 0;
+        // Keep Select out of the stream so the profile switch combo never fires
+        ev->buttons &= ~JP_BUTTON_S1;
+
+        for (int axis = 0; axis < 4; axis++) {
+            uint32_t a = xorshift32();
+            ev->analog[axis] = (a & 0x7) ? (uint8_t)(128 + (int8_t)((a >> 8) & 0x1F) - 16)
+                                         : (uint8_t)(a >> 16);
+        }
+        ev->analog[ANALOG_RZ] = (uint8_t)xorshift32();
+        ev->analog[ANALOG_SLIDER] = (uint8_t)xorshift32();
+
+        if ((xorshift32() & 0xF) == 0) {
+            ev->delta_x = (int8_t)(xorshift32() & 0xF);
+            ev->delta_y = (int8_t)(xorshift32() & 0xF);
+        }
+    }
+}
+
+// ============================================================================
+// PIPELINE SETUP
+// ============================================================================
+
+static const profile_config_t bench_profile_config = {
+    .output_profiles = {
+        [OUTPUT_TARGET_GAMECUBE] = &gc_profile_set,
+    },
+    .shared_profiles = NULL,
+};
+
+// Profile under test: "ssbm" exercises button map, sensitivity and modifiers
+static const profile_t* bench_profile = &gc_profiles[2];
+
+static void setup_mode(const bench_mode_t* m)
+{
+    router_config_t cfg = {
+        .mode = m->mode,
+        .merge_mode = m->merge_mode,
+        .merge_all_inputs = (m->mode == ROUTING_MODE_MERGE),
+        .transform_flags = TRANSFORM_NONE,
+        .mouse_drain_rate = 0,
+        .mouse_target_x = ANALOG_X,
+        .mouse_target_y = MOUSE_AXIS_DISABLED,
+    };
+    for (int i = 0; i < MAX_OUTPUTS; i++) {
+        cfg.max_players_per_output[i] = MAX_PLAYERS_PER_OUTPUT;
+    }
+
+    player_config_t player_cfg = {
+        .slot_mode = PLAYER_SLOT_FIXED,
+        .max_slots = MAX_PLAYERS,
+        .auto_assign_on_press = true,
+    };
+    players_init_with_config(&player_cfg);
+
+    router_init(&cfg);
+    router_add_route(INPUT_SOURCE_USB_HOST, BENCH_OUTPUT, 0);
+
+    output_target_t broadcast[] = { OUTPUT_TARGET_GAMECUBE, OUTPUT_TARGET_USB_DEVICE };
+    router_set_active_outputs(broadcast, (m->mode == ROUTING_MODE_BROADCAST) ? 2 : 0);
+
+    if (m->mode == ROUTING_MODE_CONFIGURABLE) {
+        // Pin each device to a fixed player slot
+        for (uint8_t d = 0; d < BENCH_DEVICES; d++) {
+            route_entry_t route = {
+                .input = INPUT_SOURCE_USB_HOST,
+                .output = BENCH_OUTPUT,
+                .priority = 0,
+                .active = true,
+                .input_dev_addr = 1 + d,
+                .input_instance = 0,
+                .output_player_id = d,
+            };
+            router_add_route_filtered(&route);
+        }
+    }
+
+    profile_init(&bench_profile_config);
+
+    // Warm up: a button press on each device assigns its player slot
+    for (uint8_t d = 0; d < BENCH_DEVICES; d++) {
+        input_event_t ev;
+        init_input_event(&ev);
+        ev.dev_addr = 1 + d;
+        ev.instance = 0;
+        ev.type = INPUT_TYPE_GAMEPAD;
+        ev.transport = INPUT_TRANSPORT_USB;
+        ev.buttons = JP_BUTTON_B1;
+        router_submit_input(&ev);
+    }
+}
+
+// One full pass: submit, then drain every player slot like an output core does
+static inline uint32_t pipeline_step(const input_event_t* ev)
+{
+    uint32_t consumed = 0;
+    router_submit_input(ev);
+
+    for (uint8_t p = 0; p < BENCH_DEVICES; p++) {
+        const input_state_t* out = router_get_output(BENCH_OUTPUT, p);
+        if (!out) continue;
+
+        profile_output_t mapped;
+        profile_apply(bench_profile, out->buttons,
+                      out->analog[ANALOG_X], out->analog[ANALOG_Y],
+                      out->analog[ANALOG_Z], out->analog[ANALOG_RX],
+                      out->analog[ANALOG_RZ], out->analog[ANALOG_SLIDER],
+                      &mapped);
+        bench_sink ^= mapped.buttons ^ mapped.left_x;
+        consumed++;
+    }
+    return consumed;
+}
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+
+static void run_mode(const bench_mode_t* m, uint32_t events, bench_result_t* result)
+{
+    quiet_begin();
+    setup_mode(m);
+
+    // Throughput: untimed inner loop
+    uint64_t consumed = 0;
+    uint64_t c0 = now_cycles();
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < events; i++) {
+        consumed += pipeline_step(&event_pool[i & (EVENT_POOL_SIZE - 1)]);
+    }
+    uint64_t t1 = now_ns();
+    uint64_t c1 = now_cycles();
+
+    // Latency: time each event individually
+    for (uint32_t i = 0; i < events; i++) {
+        uint64_t s = now_ns();
+        pipeline_step(&event_pool[i & (EVENT_POOL_SIZE - 1)]);
+        uint64_t e = now_ns();
+        latency_samples[i] = (uint32_t)(e - s);
+    }
+    quiet_end();
+
+    qsort(latency_samples, events, sizeof(uint32_t), compare_u32);
+
+    double elapsed_ns = (double)(t1 - t0);
+    result->ns_per_event = elapsed_ns / events;
+    result->events_per_sec = events / (elapsed_ns / 1e9);
+    result->cycles_per_event = (double)(c1 - c0) / events;
+    result->p50_ns = percentile_u32(latency_samples, events, 50);
+    result->p99_ns = percentile_u32(latency_samples, events, 99);
+    result->max_ns = latency_samples[events - 1];
+    result->outputs_consumed = consumed;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t events = DEFAULT_EVENTS;
+    if (argc > 1) {
+        long n = strtol(argv[1], NULL, 10);
+        if (n > 0) events = (uint32_t)n;
+    }
+
+    latency_samples = malloc((size_t)events * sizeof(uint32_t));
+    if (!latency_samples) {
+        fprintf(stderr, "router_bench: cannot allocate %u latency samples\n", events);
+        return 1;
+    }
+
+    generate_events();
+
+    printf("Joypad router/profile pipeline benchmark\n");
+    printf("  events/mode: %u, devices: %d, profile: %s\n\n",
+           events, BENCH_DEVICES, bench_profile->name);
+    printf("%-16s %14s %10s %10s %9s %9s %9s %10s\n",
+           "mode", "events/sec", "ns/event", "cyc/event", "p50 ns", "p99 ns", "max ns", "outputs");
+
+    for (size_t i = 0; i < BENCH_MODE_COUNT; i++) {
+        bench_result_t r;
+        run_mode(&bench_modes[i], events, &r);
+        printf("%-16s %14.0f %10.1f %10.1f %9u %9u %9u %10llu\n",
+               bench_modes[i].name, r.events_per_sec, r.ns_per_event, r.cycles_per_event,
+               r.p50_ns, r.p99_ns, r.max_ns, (unsigned long long)r.outputs_consumed);
+    }
+
+    free(latency_samples);
+    return 0;
+}
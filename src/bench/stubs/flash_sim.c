@@ -0,0 +1,142 @@
+// flash_sim.c - RAM-backed NOR flash for host benchmarks
+
+#include "flash_sim.h"
+#include <string.h>
+
+static uint8_t mem[FLASH_SIM_MAX_SECTORS * FLASH_SIM_SECTOR_SIZE];
+static uint8_t sector_count;
+static uint32_t erase_counts[FLASH_SIM_MAX_SECTORS];
+static uint32_t program_count;
+static uint32_t error_count;
+
+static int32_t budget = -1;     // Bytes of work until power fails
+static bool powered = true;
+static uint64_t work;
+static uint32_t noise = 0x2468ACE1u;
+
+static uint8_t noise_byte(void)
+{
+    noise ^= noise << 13;
+    noise ^= noise >> 17;
+    noise ^= noise << 5;
+    return (uint8_t)noise;
+}
+
+// Spend one byte of work; false once the supply has failed
+static bool spend(void)
+{
+    if (!powered) {
+        return false;
+    }
+    if (budget == 0) {
+        powered = false;
+        return false;
+    }
+    if (budget > 0) {
+        budget--;
+    }
+    work++;
+    return true;
+}
+
+void flash_sim_init(uint8_t sectors)
+{
+    sector_count = sectors > FLASH_SIM_MAX_SECTORS ? FLASH_SIM_MAX_SECTORS : sectors;
+    memset(mem, 0xFF, sizeof(mem));
+    memset(erase_counts, 0, sizeof(erase_counts));
+    program_count = 0;
+    error_count = 0;
+    budget = -1;
+    powered = true;
+    work = 0;
+}
+
+const uint8_t* flash_sim_base(void)
+{
+    return mem;
+}
+
+void flash_sim_erase(uint32_t offset)
+{
+    if (offset % FLASH_SIM_SECTOR_SIZE || offset / FLASH_SIM_SECTOR_SIZE >= sector_count) {
+        error_count++;
+        return;
+    }
+    if (!powered) {
+        return;
+    }
+
+    uint8_t* s = &mem[offset];
+    erase_counts[offset / FLASH_SIM_SECTOR_SIZE]++;
+    for (uint32_t i = 0; i < FLASH_SIM_SECTOR_SIZE; i++) {
+        if (!spend()) {
+            // Erase cut short: cells part way to 1 everywhere
+            for (uint32_t j = 0; j < FLASH_SIM_SECTOR_SIZE; j++) {
+                s[j] |= noise_byte() & noise_byte();
+            }
+            return;
+        }
+    }
+    memset(s, 0xFF, FLASH_SIM_SECTOR_SIZE);
+}
+
+void flash_sim_program(uint32_t offset, const uint8_t* data, uint32_t len)
+{
+    if (offset % FLASH_SIM_PAGE_SIZE || len % FLASH_SIM_PAGE_SIZE ||
+        offset + len > (uint32_t)sector_count * FLASH_SIM_SECTOR_SIZE) {
+        error_count++;
+        return;
+    }
+    if (!powered) {
+        return;
+    }
+
+    program_count++;
+    for (uint32_t i = 0; i < len; i++) {
+        if (data[i] == 0xFF) {
+            continue;   // Nothing to clear, no time spent
+        }
+        if (!spend()) {
+            // Byte in progress: some of its bits made it
+            mem[offset + i] &= data[i] | noise_byte();
+            return;
+        }
+        mem[offset + i] &= data[i];
+    }
+}
+
+void flash_sim_cut_after(int32_t bytes)
+{
+    budget = bytes;
+}
+
+bool flash_sim_powered(void)
+{
+    return powered;
+}
+
+void flash_sim_power_on(void)
+{
+    powered = true;
+    budget = -1;
+}
+
+uint64_t flash_sim_work(void)
+{
+    return work;
+}
+
+uint32_t flash_sim_erases(uint8_t sector)
+{
+    return sector < FLASH_SIM_MAX_SECTORS ? erase_counts[sector] : 0;
+}
+
+uint32_t flash_sim_programs(void)
+{
+    return program_count;
+}
+
+uint32_t flash_sim_errors(void)
+{
+    return error_count;
+}
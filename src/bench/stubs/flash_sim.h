@@ -0,0 +1,45 @@
+// flash_sim.h - RAM-backed NOR flash for host benchmarks
+//
+// Models the RP2040's QSPI flash as the settings code sees it: reads are
+// plain memory, an erase sets a whole 4 KB sector to 0xFF, and a program
+// can only clear bits (new = old & data) in page-aligned whole pages.
+//
+// Power loss: flash_sim_cut_after(n) lets n more bytes be erased or
+// programmed, then the supply fails inside the current operation. The byte
+// being programmed gets a random subset of its bits cleared, an erase in
+// progress leaves random bits set across the sector, and every later
+// operation is ignored until flash_sim_power_on().
+
+#ifndef BENCH_FLASH_SIM_H
+#define BENCH_FLASH_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLASH_SIM_SECTOR_SIZE   4096
+#define FLASH_SIM_PAGE_SIZE     256
+#define FLASH_SIM_MAX_SECTORS   16
+
+// Blank flash (all 0xFF) of the given number of sectors; clears counters
+void flash_sim_init(uint8_t sectors);
+
+const uint8_t* flash_sim_base(void);
+
+// Operations (offsets from the base)
+void flash_sim_erase(uint32_t offset);
+void flash_sim_program(uint32_t offset, const uint8_t* data, uint32_t len);
+
+// Fail power after n more bytes of erase/program work (-1 = never)
+void flash_sim_cut_after(int32_t bytes);
+bool flash_sim_powered(void);
+void flash_sim_power_on(void);
+
+// Byte-level work done so far (for picking cut points)
+uint64_t flash_sim_work(void);
+
+// Counters
+uint32_t flash_sim_erases(uint8_t sector);
+uint32_t flash_sim_programs(void);
+uint32_t flash_sim_errors(void);    // Misaligned or out-of-range operations
+
+#endif // BENCH_FLASH_SIM_H
@@ -0,0 +1,89 @@
+// hardware/dma.h - Host stub for benchmark builds
+//
+// Implemented by uart_pipe.c:
+//   - Channels that write to or read from a pipe UART data register. A TX
+//     transfer hands its bytes to the pipe, which moves them into the TX
+//     FIFO as simulated time advances; the channel is busy until the last
+//     byte has left the source buffer, like the real DREQ-paced channel. An
+//     RX transfer takes each byte as it arrives on the wire, honouring the
+//     write-address ring wrap.
+//   - Any other channel is an unpaced memory-to-memory copy that completes
+//     on trigger, plus the CRC sniffer (CRC-32 modes only).
+
+#ifndef BENCH_STUB_HARDWARE_DMA_H
+#define BENCH_STUB_HARDWARE_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+// Sniffer modes (hardware/regs/dma.h)
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32     0x0
+#define DMA_SNIFF_CTRL_CALC_VALUE_CRC32R    0x1
+
+#define BENCH_DMA_CTRL_SNIFF_EN             0x4u
+#define BENCH_DMA_CTRL_INCR_READ            0x8u
+#define BENCH_DMA_CTRL_INCR_WRITE           0x10u
+#define BENCH_DMA_CTRL_RING_SEL             0x20u
+#define BENCH_DMA_CTRL_RING_SIZE_SHIFT      8       // 4 bits, 0 = no ring
+
+typedef struct {
+    uint32_t ctrl;              // Bits 0-1 transfer size, BENCH_DMA_CTRL_* flags
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(unsigned channel);
+dma_channel_config dma_channel_get_default_config(unsigned channel);
+void dma_channel_configure(unsigned channel, const dma_channel_config* config,
+                           volatile void* write_addr, const volatile void* read_addr,
+                           unsigned transfer_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(unsigned channel, const volatile void* read_addr,
+                                          uint32_t transfer_count);
+// Live channel registers (only transfer_count is modelled)
+typedef struct {
+    volatile uint32_t read_addr;
+    volatile uint32_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+dma_channel_hw_t* dma_channel_hw_addr(unsigned channel);
+void dma_channel_set_trans_count(unsigned channel, uint32_t trans_count, bool trigger);
+bool dma_channel_is_busy(unsigned channel);
+void dma_channel_abort(unsigned channel);
+void dma_channel_wait_for_finish_blocking(unsigned channel);
+
+void dma_sniffer_enable(unsigned channel, unsigned mode, bool force_channel_enable);
+void dma_sniffer_disable(void);
+void dma_sniffer_set_data_accumulator(uint32_t seed_value);
+uint32_t dma_sniffer_get_data_accumulator(void);
+void dma_sniffer_set_output_reverse_enabled(bool enable);
+void dma_sniffer_set_output_invert_enabled(bool enable);
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config* c,
+                                                         enum dma_channel_transfer_size size) {
+    c->ctrl = (c->ctrl & ~3u) | (uint32_t)size;
+}
+static inline void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->ctrl = incr ? (c->ctrl | BENCH_DMA_CTRL_INCR_READ) : (c->ctrl & ~BENCH_DMA_CTRL_INCR_READ);
+}
+static inline void channel_config_set_write_increment(dma_channel_config* c, bool incr) {
+    c->ctrl = incr ? (c->ctrl | BENCH_DMA_CTRL_INCR_WRITE) : (c->ctrl & ~BENCH_DMA_CTRL_INCR_WRITE);
+}
+static inline void channel_config_set_sniff_enable(dma_channel_config* c, bool sniff_enable) {
+    c->ctrl = sniff_enable ? (c->ctrl | BENCH_DMA_CTRL_SNIFF_EN) : (c->ctrl & ~BENCH_DMA_CTRL_SNIFF_EN);
+}
+static inline void channel_config_set_ring(dma_channel_config* c, bool write, unsigned size_bits) {
+    c->ctrl = (c->ctrl & ~(BENCH_DMA_CTRL_RING_SEL | (0xFu << BENCH_DMA_CTRL_RING_SIZE_SHIFT))) |
+              (write ? BENCH_DMA_CTRL_RING_SEL : 0) | ((size_bits & 0xFu) << BENCH_DMA_CTRL_RING_SIZE_SHIFT);
+}
+static inline void channel_config_set_dreq(dma_channel_config* c, unsigned dreq) {
+    (void)c; (void)dreq;
+}
+
+#endif // BENCH_STUB_HARDWARE_DMA_H
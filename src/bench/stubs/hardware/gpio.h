@@ -0,0 +1,20 @@
+// hardware/gpio.h - Host stub for benchmark builds
+
+#ifndef BENCH_STUB_HARDWARE_GPIO_H
+#define BENCH_STUB_HARDWARE_GPIO_H
+
+#include <stdint.h>
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+};
+
+static inline void gpio_set_function(unsigned gpio, enum gpio_function fn) {
+    (void)gpio; (void)fn;
+}
+
+#endif // BENCH_STUB_HARDWARE_GPIO_H
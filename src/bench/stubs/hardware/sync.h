@@ -0,0 +1,28 @@
+// hardware/sync.h - Host stub for benchmark builds
+//
+// Barriers and interrupt masking used by the core pipeline. __dmb() maps to
+// an acquire/release fence, which is what the seqlock handoff relies on.
+// The host build has no interrupts, so save/restore are no-ops.
+
+#ifndef BENCH_STUB_HARDWARE_SYNC_H
+#define BENCH_STUB_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_ACQ_REL);
+}
+
+static inline void __compiler_memory_barrier(void) {
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+
+#endif // BENCH_STUB_HARDWARE_SYNC_H
@@ -0,0 +1,45 @@
+// hardware/uart.h - Host stub for benchmark builds
+//
+// UART instances backed by the byte pipe in uart_pipe.c. The TX side drains
+// at the configured baud rate as the harness advances simulated time; the RX
+// side returns whatever the harness injected.
+
+#ifndef BENCH_STUB_HARDWARE_UART_H
+#define BENCH_STUB_HARDWARE_UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    volatile uint32_t dr;
+} uart_hw_t;
+
+typedef struct uart_inst {
+    uint8_t index;
+} uart_inst_t;
+extern uart_inst_t bench_uart_inst[2];
+
+#define uart0 (&bench_uart_inst[0])
+#define uart1 (&bench_uart_inst[1])
+
+typedef enum {
+    UART_PARITY_NONE,
+    UART_PARITY_EVEN,
+    UART_PARITY_ODD,
+} uart_parity_t;
+
+uint32_t uart_init(uart_inst_t* uart, uint32_t baudrate);
+void uart_set_format(uart_inst_t* uart, unsigned data_bits, unsigned stop_bits, uart_parity_t parity);
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled);
+uart_hw_t* uart_get_hw(uart_inst_t* uart);
+unsigned uart_get_dreq(uart_inst_t* uart, bool is_tx);
+
+bool uart_is_writable(uart_inst_t* uart);
+void uart_putc_raw(uart_inst_t* uart, char c);
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len);
+
+bool uart_is_readable(uart_inst_t* uart);
+char uart_getc(uart_inst_t* uart);
+
+#endif // BENCH_STUB_HARDWARE_UART_H
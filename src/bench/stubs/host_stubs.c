@@ -0,0 +1,71 @@
+// host_stubs.c - Host replacements for hardware-backed services
+//
+// The router/profile/player sources call into LED, profile indicator and
+// flash services. On the host those are reduced to no-ops (or a RAM copy
+// for flash) so the benchmark measures only the input pipeline.
+
+#include <string.h>
+#include "pico/stdlib.h"
+#include "core/services/leds/leds.h"
+#include "core/services/profiles/profile_indicator.h"
+#include "core/services/storage/flash.h"
+
+unsigned int bench_core_num = 0;
+
+// ============================================================================
+// LEDS
+// ============================================================================
+
+void leds_init(void) {}
+void leds_task(void) {}
+void leds_indicate_profile(uint8_t profile_index) { (void)profile_index; }
+bool leds_is_indicating(void) { return false; }
+
+// ============================================================================
+// PROFILE INDICATOR
+// ============================================================================
+
+void profile_indicator_init(void) {}
+void profile_indicator_task(void) {}
+void profile_indicator_trigger_player(uint8_t player_index, uint8_t profile_index, uint8_t player_count)
+{
+    (void)player_index; (void)profile_index; (void)player_count;
+}
+void profile_indicator_trigger(uint8_t profile_index, uint8_t player_count)
+{
+    (void)profile_index; (void)player_count;
+}
+uint8_t profile_indicator_get_rumble(void) { return 0; }
+uint8_t profile_indicator_get_player_led(uint8_t player_count) { (void)player_count; return 0; }
+bool profile_indicator_is_active(void) { return false; }
+bool profile_indicator_is_active_for_player(uint8_t player_index) { (void)player_index; return false; }
+int8_t profile_indicator_get_display_player_index(int8_t actual_player_index) { return actual_player_index; }
+
+// ============================================================================
+// FLASH (RAM-backed)
+// ============================================================================
+
+static flash_t ram_settings;
+static bool ram_settings_valid = false;
+
+void flash_init(void) {}
+
+bool flash_load(flash_t* settings)
+{
+    if (!ram_settings_valid) return false;
+    memcpy(settings, &ram_settings, sizeof(flash_t));
+    return true;
+}
+
+void flash_save(const flash_t* settings)
+{
+    flash_save_now(settings);
+}
+
+void flash_save_now(const flash_t* settings)
+{
+    memcpy(&ram_settings, settings, sizeof(flash_t));
+    ram_settings_valid = true;
+}
+
+void flash_task(void) {}
@@ -0,0 +1,58 @@
+// gamecube_definitions.h - Host stub for benchmark builds
+//
+// Mirrors the gc_report_t layout from the joybus-pio submodule so the
+// GameCube report builder compiles without the submodule checked out.
+
+#ifndef BENCH_STUB_GAMECUBE_DEFINITIONS_H
+#define BENCH_STUB_GAMECUBE_DEFINITIONS_H
+
+#include <stdint.h>
+
+typedef union {
+    uint8_t raw8[8];
+    struct {
+        uint8_t a : 1;
+        uint8_t b : 1;
+        uint8_t x : 1;
+        uint8_t y : 1;
+        uint8_t start : 1;
+        uint8_t origin : 1;
+        uint8_t err_latch : 1;
+        uint8_t err_status : 1;
+
+        uint8_t dpad_left : 1;
+        uint8_t dpad_right : 1;
+        uint8_t dpad_down : 1;
+        uint8_t dpad_up : 1;
+        uint8_t z : 1;
+        uint8_t r : 1;
+        uint8_t l : 1;
+        uint8_t high1 : 1;
+
+        uint8_t stick_x;
+        uint8_t stick_y;
+        uint8_t cstick_x;
+        uint8_t cstick_y;
+        uint8_t l_analog;
+        uint8_t r_analog;
+    };
+    struct {
+        uint8_t counter : 4;
+        uint8_t unknown : 4;
+        uint8_t pad[3];
+        uint8_t keypress[3];
+        uint8_t checksum;
+    } keyboard;
+} gc_report_t;
+
+static const gc_report_t default_gc_report = {
+    .high1 = 1,
+    .stick_x = 128,
+    .stick_y = 128,
+    .cstick_x = 128,
+    .cstick_y = 128,
+};
+
+static const gc_report_t default_gc_kb_report = { .raw8 = { 0 } };
+
+#endif // BENCH_STUB_GAMECUBE_DEFINITIONS_H
@@ -0,0 +1,60 @@
+// pico/stdlib.h - Host stub for benchmark builds
+//
+// Provides the small subset of the Pico SDK used by the core pipeline
+// (time base, RAM-placement attributes) so router/profile/player sources
+// compile unmodified on a desktop toolchain.
+
+#ifndef BENCH_STUB_PICO_STDLIB_H
+#define BENCH_STUB_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+// RAM placement attributes are meaningless on the host
+#ifndef __not_in_flash_func
+#define __not_in_flash_func(func_name) func_name
+#endif
+#ifndef __no_inline_not_in_flash_func
+#define __no_inline_not_in_flash_func(func_name) __attribute__((noinline)) func_name
+#endif
+#ifndef __not_in_flash
+#define __not_in_flash(group)
+#endif
+#ifndef __time_critical_func
+#define __time_critical_func(func_name) func_name
+#endif
+
+typedef uint64_t absolute_time_t;
+
+static inline absolute_time_t get_absolute_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000u);
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)get_absolute_time();
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+// Benchmarks run single-threaded, as core 0 unless a check switches
+// bench_core_num to model the other core
+extern unsigned int bench_core_num;
+
+static inline unsigned int get_core_num(void) {
+    return bench_core_num;
+}
+
+#endif // BENCH_STUB_PICO_STDLIB_H
@@ -0,0 +1,146 @@
+// tusb.h - Host stub for benchmark builds
+//
+// Core headers only need TinyUSB's attribute macros; the USB stack
+// itself is not part of the host build. The HID usage constants cover
+// what the generic HID parser/extractor reference. The descriptor types
+// and TUD_*_DESCRIPTOR macros match TinyUSB so device descriptor headers
+// compile to the same bytes on the host.
+
+#ifndef BENCH_STUB_TUSB_H
+#define BENCH_STUB_TUSB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+
+#define TU_ATTR_PACKED      __attribute__((packed))
+#define TU_ATTR_ALIGNED(x)  __attribute__((aligned(x)))
+#define TU_ATTR_UNUSED      __attribute__((unused))
+
+#define CFG_TUD_ENABLED 0
+#define CFG_TUH_ENABLED 0
+
+#define TU_LOG1(...)        do { } while (0)
+
+// Device configuration (mirrors tusb_config.h, CDC debug port off)
+#ifndef CFG_TUD_CDC
+#define CFG_TUD_CDC                 1
+#endif
+#define CFG_TUD_HID                 4
+#define CFG_TUD_HID_EP_BUFSIZE      64
+#define CFG_TUD_ENDPOINT0_SIZE      64
+
+// ============================================================================
+// DESCRIPTORS (common/tusb_types.h, device/usbd.h)
+// ============================================================================
+
+#define TU_BIT(n)               (1UL << (n))
+#define TU_U16_HIGH(u16)        ((uint8_t)(((u16) >> 8) & 0x00ff))
+#define TU_U16_LOW(u16)         ((uint8_t)((u16) & 0x00ff))
+#define U16_TO_U8S_LE(u16)      TU_U16_LOW(u16), TU_U16_HIGH(u16)
+
+enum {
+    TUSB_DESC_DEVICE                = 0x01,
+    TUSB_DESC_CONFIGURATION         = 0x02,
+    TUSB_DESC_STRING                = 0x03,
+    TUSB_DESC_INTERFACE             = 0x04,
+    TUSB_DESC_ENDPOINT              = 0x05,
+    TUSB_DESC_INTERFACE_ASSOCIATION = 0x0B,
+    TUSB_DESC_CS_INTERFACE          = 0x24,
+};
+
+enum {
+    TUSB_XFER_CONTROL = 0,
+    TUSB_XFER_ISOCHRONOUS,
+    TUSB_XFER_BULK,
+    TUSB_XFER_INTERRUPT,
+};
+
+enum {
+    TUSB_CLASS_CDC      = 2,
+    TUSB_CLASS_HID      = 3,
+    TUSB_CLASS_CDC_DATA = 10,
+    TUSB_CLASS_MISC     = 0xEF,
+};
+
+#define MISC_SUBCLASS_COMMON                    2
+#define MISC_PROTOCOL_IAD                       1
+#define TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP      TU_BIT(5)
+
+#define HID_DESC_TYPE_HID                       0x21
+#define HID_DESC_TYPE_REPORT                    0x22
+#define HID_SUBCLASS_BOOT                       1
+#define HID_ITF_PROTOCOL_NONE                   0
+
+#define CDC_COMM_SUBCLASS_ABSTRACT_CONTROL_MODEL        2
+#define CDC_COMM_PROTOCOL_NONE                          0
+#define CDC_FUNC_DESC_HEADER                            0x00
+#define CDC_FUNC_DESC_CALL_MANAGEMENT                   0x01
+#define CDC_FUNC_DESC_ABSTRACT_CONTROL_MANAGEMENT       0x02
+#define CDC_FUNC_DESC_UNION                             0x06
+
+typedef struct TU_ATTR_PACKED {
+    uint8_t  bLength;
+    uint8_t  bDescriptorType;
+    uint16_t bcdUSB;
+    uint8_t  bDeviceClass;
+    uint8_t  bDeviceSubClass;
+    uint8_t  bDeviceProtocol;
+    uint8_t  bMaxPacketSize0;
+    uint16_t idVendor;
+    uint16_t idProduct;
+    uint16_t bcdDevice;
+    uint8_t  iManufacturer;
+    uint8_t  iProduct;
+    uint8_t  iSerialNumber;
+    uint8_t  bNumConfigurations;
+} tusb_desc_device_t;
+
+#define TUD_CONFIG_DESC_LEN     (9)
+#define TUD_CONFIG_DESCRIPTOR(config_num, _itfcount, _stridx, _total_len, _attribute, _power_ma) \
+    9, TUSB_DESC_CONFIGURATION, U16_TO_U8S_LE(_total_len), _itfcount, config_num, _stridx, \
+    TU_BIT(7) | _attribute, (_power_ma) / 2
+
+#define TUD_HID_DESC_LEN        (9 + 9 + 7)
+#define TUD_HID_INOUT_DESC_LEN  (9 + 9 + 7 + 7)
+#define TUD_HID_DESCRIPTOR(_itfnum, _stridx, _boot_protocol, _report_desc_len, _epin, _epsize, _ep_interval) \
+    9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_HID, \
+    (uint8_t)((_boot_protocol) ? (uint8_t)HID_SUBCLASS_BOOT : 0), _boot_protocol, _stridx, \
+    9, HID_DESC_TYPE_HID, U16_TO_U8S_LE(0x0111), 0, 1, HID_DESC_TYPE_REPORT, U16_TO_U8S_LE(_report_desc_len), \
+    7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_epsize), _ep_interval
+
+#define TUD_CDC_DESC_LEN        (8 + 9 + 5 + 5 + 4 + 5 + 7 + 9 + 7 + 7)
+#define TUD_CDC_DESCRIPTOR(_itfnum, _stridx, _ep_notif, _ep_notif_size, _epout, _epin, _epsize) \
+    8, TUSB_DESC_INTERFACE_ASSOCIATION, _itfnum, 2, TUSB_CLASS_CDC, \
+    CDC_COMM_SUBCLASS_ABSTRACT_CONTROL_MODEL, CDC_COMM_PROTOCOL_NONE, 0, \
+    9, TUSB_DESC_INTERFACE, _itfnum, 0, 1, TUSB_CLASS_CDC, \
+    CDC_COMM_SUBCLASS_ABSTRACT_CONTROL_MODEL, CDC_COMM_PROTOCOL_NONE, _stridx, \
+    5, TUSB_DESC_CS_INTERFACE, CDC_FUNC_DESC_HEADER, U16_TO_U8S_LE(0x0120), \
+    5, TUSB_DESC_CS_INTERFACE, CDC_FUNC_DESC_CALL_MANAGEMENT, 0, (uint8_t)((_itfnum) + 1), \
+    4, TUSB_DESC_CS_INTERFACE, CDC_FUNC_DESC_ABSTRACT_CONTROL_MANAGEMENT, 6, \
+    5, TUSB_DESC_CS_INTERFACE, CDC_FUNC_DESC_UNION, _itfnum, (uint8_t)((_itfnum) + 1), \
+    7, TUSB_DESC_ENDPOINT, _ep_notif, TUSB_XFER_INTERRUPT, U16_TO_U8S_LE(_ep_notif_size), 16, \
+    9, TUSB_DESC_INTERFACE, (uint8_t)((_itfnum) + 1), 0, 2, TUSB_CLASS_CDC_DATA, 0, 0, 0, \
+    7, TUSB_DESC_ENDPOINT, _epout, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0, \
+    7, TUSB_DESC_ENDPOINT, _epin, TUSB_XFER_BULK, U16_TO_U8S_LE(_epsize), 0
+
+// HID usage pages and generic desktop usages (class/hid/hid.h)
+#define HID_USAGE_PAGE_DESKTOP          0x01
+#define HID_USAGE_PAGE_BUTTON           0x09
+
+#define HID_USAGE_DESKTOP_MOUSE         0x02
+#define HID_USAGE_DESKTOP_KEYBOARD      0x06
+#define HID_USAGE_DESKTOP_X             0x30
+#define HID_USAGE_DESKTOP_Y             0x31
+#define HID_USAGE_DESKTOP_Z             0x32
+#define HID_USAGE_DESKTOP_RX            0x33
+#define HID_USAGE_DESKTOP_RY            0x34
+#define HID_USAGE_DESKTOP_RZ            0x35
+#define HID_USAGE_DESKTOP_WHEEL         0x38
+#define HID_USAGE_DESKTOP_HAT_SWITCH    0x39
+#define HID_USAGE_DESKTOP_DPAD_UP       0x90
+#define HID_USAGE_DESKTOP_DPAD_DOWN     0x91
+#define HID_USAGE_DESKTOP_DPAD_RIGHT    0x92
+#define HID_USAGE_DESKTOP_DPAD_LEFT     0x93
+
+#endif // BENCH_STUB_TUSB_H
@@ -0,0 +1,548 @@
+// uart_pipe.c - Byte-pipe UART and its DMA for host benchmarks
+//
+// See uart_pipe.h. Single-threaded: time only moves inside
+// uart_pipe_advance_ns(), uart_pipe_drain() and uart_write_blocking().
+//
+// Channels that neither write to nor read from a pipe UART are unpaced
+// memory-to-memory copies that complete on trigger. The sniffer follows the
+// RP2040 datasheet for the CRC-32 modes: each transferred element is shifted
+// MSB-first into the accumulator (CRC32) or bit-reversed first (CRC32R);
+// output reverse and invert apply on read only.
+
+#include <stdlib.h>
+#include <string.h>
+#include "uart_pipe.h"
+#include "hardware/dma.h"
+
+#define PIPE_UARTS          2
+#define PIPE_DMA_CHANNELS   12
+#define PIPE_RX_SIZE        4096
+
+typedef struct {
+    uint32_t baud;
+    uint64_t byte_ns;
+    uint64_t credit_ns;
+
+    uint8_t fifo[UART_PIPE_FIFO_DEPTH];
+    uint8_t fifo_head;
+    uint8_t fifo_count;
+
+    // Running DMA transfer feeding this UART
+    const volatile uint8_t* dma_src;
+    uint32_t dma_remaining;
+    uint32_t dma_transfers;
+
+    uint8_t* out;
+    size_t out_len;
+    size_t out_cap;
+    size_t out_read;
+
+    uint64_t blocked_ns;
+
+    uint8_t rx[PIPE_RX_SIZE];
+    size_t rx_head;
+    size_t rx_tail;
+    uint32_t rx_overruns;
+
+    // Bytes still on the RX wire
+    uint8_t* wire;
+    size_t wire_len;
+    size_t wire_cap;
+    size_t wire_read;
+    uint64_t rx_credit_ns;
+
+    // DMA channel reading this UART's RX, -1 if none (set by uart_init)
+    int rx_dma;
+} pipe_t;
+
+uart_inst_t bench_uart_inst[PIPE_UARTS] = { {0}, {1} };
+static uart_hw_t pipe_hw[PIPE_UARTS];
+static pipe_t pipes[PIPE_UARTS];
+
+static struct {
+    bool claimed;
+    int uart;       // Destination UART index, -1 if not a UART data register
+    int rx_uart;    // Source UART index, -1 if not a UART data register
+    dma_channel_config config;
+    volatile uint8_t* write_addr;
+} dma_chans[PIPE_DMA_CHANNELS];
+static dma_channel_hw_t dma_regs[PIPE_DMA_CHANNELS];
+static int dma_available = PIPE_DMA_CHANNELS;
+
+static struct {
+    bool enabled;
+    unsigned channel;
+    unsigned mode;
+    bool reverse;
+    bool invert;
+    uint32_t accumulator;
+    uint32_t fed;
+} sniff;
+
+static pipe_t* pipe_of(uart_inst_t* uart)
+{
+    return &pipes[uart->index];
+}
+
+// ============================================================================
+// WIRE MODEL
+// ============================================================================
+
+static void fifo_refill(pipe_t* p)
+{
+    while (p->dma_remaining && p->fifo_count < UART_PIPE_FIFO_DEPTH) {
+        p->fifo[(p->fifo_head + p->fifo_count) % UART_PIPE_FIFO_DEPTH] = *p->dma_src++;
+        p->fifo_count++;
+        p->dma_remaining--;
+    }
+}
+
+static void shift_out(pipe_t* p)
+{
+    if (p->fifo_count == 0) return;
+
+    if (p->out_len == p->out_cap) {
+        p->out_cap = p->out_cap ? p->out_cap * 2 : 4096;
+        p->out = realloc(p->out, p->out_cap);
+    }
+    p->out[p->out_len++] = p->fifo[p->fifo_head];
+    p->fifo_head = (p->fifo_head + 1) % UART_PIPE_FIFO_DEPTH;
+    p->fifo_count--;
+    fifo_refill(p);
+}
+
+static size_t rx_fifo_count(pipe_t* p)
+{
+    return (p->rx_head + PIPE_RX_SIZE - p->rx_tail) % PIPE_RX_SIZE;
+}
+
+static void rx_fifo_push(pipe_t* p, uint8_t byte)
+{
+    size_t next = (p->rx_head + 1) % PIPE_RX_SIZE;
+    if (next == p->rx_tail) {
+        p->rx_overruns++;
+        return;
+    }
+    p->rx[p->rx_head] = byte;
+    p->rx_head = next;
+}
+
+// DREQ-paced RX DMA: empties the FIFO into memory while it has count left
+static void rx_dma_pump(pipe_t* p)
+{
+    int ch = p->rx_dma;
+    if (ch < 0 || dma_chans[ch].rx_uart != p - pipes) return;
+
+    uint32_t ctrl = dma_chans[ch].config.ctrl;
+    unsigned ring_bits = (ctrl >> BENCH_DMA_CTRL_RING_SIZE_SHIFT) & 0xFu;
+    bool ring_write = ring_bits && (ctrl & BENCH_DMA_CTRL_RING_SEL);
+    uintptr_t ring_mask = ring_write ? ((uintptr_t)1 << ring_bits) - 1 : 0;
+
+    while (dma_regs[ch].transfer_count && p->rx_tail != p->rx_head) {
+        *dma_chans[ch].write_addr = p->rx[p->rx_tail];
+        p->rx_tail = (p->rx_tail + 1) % PIPE_RX_SIZE;
+        dma_regs[ch].transfer_count--;
+
+        if (ctrl & BENCH_DMA_CTRL_INCR_WRITE) {
+            uintptr_t a = (uintptr_t)dma_chans[ch].write_addr;
+            a = ring_mask ? (a & ~ring_mask) | ((a + 1) & ring_mask) : a + 1;
+            dma_chans[ch].write_addr = (volatile uint8_t*)a;
+        }
+    }
+}
+
+// One byte time on the RX wire
+static void shift_in(pipe_t* p)
+{
+    uint8_t byte = p->wire[p->wire_read++];
+    if (p->wire_read == p->wire_len) {
+        p->wire_read = 0;
+        p->wire_len = 0;
+    }
+
+    if (rx_fifo_count(p) >= UART_PIPE_FIFO_DEPTH) {
+        p->rx_overruns++;
+    } else {
+        rx_fifo_push(p, byte);
+    }
+    rx_dma_pump(p);
+}
+
+void uart_pipe_advance_ns(uart_inst_t* uart, uint64_t ns)
+{
+    pipe_t* p = pipe_of(uart);
+    fifo_refill(p);
+    p->credit_ns += ns;
+    while (p->credit_ns >= p->byte_ns) {
+        p->credit_ns -= p->byte_ns;
+        shift_out(p);
+    }
+    // An idle line doesn't bank time for later bytes
+    if (p->fifo_count == 0) p->credit_ns = 0;
+
+    p->rx_credit_ns += ns;
+    while (p->wire_len && p->rx_credit_ns >= p->byte_ns) {
+        p->rx_credit_ns -= p->byte_ns;
+        shift_in(p);
+    }
+    if (p->wire_len == 0) p->rx_credit_ns = 0;
+}
+
+void uart_pipe_drain(uart_inst_t* uart)
+{
+    pipe_t* p = pipe_of(uart);
+    fifo_refill(p);
+    while (p->fifo_count) {
+        shift_out(p);
+    }
+    p->credit_ns = 0;
+}
+
+void uart_pipe_reset(uart_inst_t* uart)
+{
+    pipe_t* p = pipe_of(uart);
+    uint32_t baud = p->baud;
+    free(p->out);
+    free(p->wire);
+    memset(p, 0, sizeof(*p));
+    p->rx_dma = -1;
+    p->baud = baud ? baud : 115200;
+    p->byte_ns = 10000000000ull / p->baud;   // 8N1: 10 bit times per byte
+}
+
+void uart_pipe_set_dma_channels(int count)
+{
+    dma_available = count < PIPE_DMA_CHANNELS ? count : PIPE_DMA_CHANNELS;
+}
+
+size_t uart_pipe_tx_take(uart_inst_t* uart, uint8_t* out, size_t max)
+{
+    pipe_t* p = pipe_of(uart);
+    size_t n = p->out_len - p->out_read;
+    if (n > max) n = max;
+    memcpy(out, p->out + p->out_read, n);
+    p->out_read += n;
+    if (p->out_read == p->out_len) {
+        p->out_read = 0;
+        p->out_len = 0;
+    }
+    return n;
+}
+
+uint32_t uart_pipe_tx_backlog(uart_inst_t* uart)
+{
+    pipe_t* p = pipe_of(uart);
+    return p->fifo_count + p->dma_remaining;
+}
+
+uint64_t uart_pipe_blocked_ns(uart_inst_t* uart)
+{
+    return pipe_of(uart)->blocked_ns;
+}
+
+uint32_t uart_pipe_dma_transfers(uart_inst_t* uart)
+{
+    return pipe_of(uart)->dma_transfers;
+}
+
+void uart_pipe_rx_inject(uart_inst_t* uart, const uint8_t* data, size_t len)
+{
+    pipe_t* p = pipe_of(uart);
+    for (size_t i = 0; i < len; i++) {
+        rx_fifo_push(p, data[i]);
+        rx_dma_pump(p);
+    }
+}
+
+void uart_pipe_rx_send(uart_inst_t* uart, const uint8_t* data, size_t len)
+{
+    pipe_t* p = pipe_of(uart);
+    if (p->wire_len + len > p->wire_cap) {
+        p->wire_cap = (p->wire_len + len) * 2;
+        p->wire = realloc(p->wire, p->wire_cap);
+    }
+    memcpy(p->wire + p->wire_len, data, len);
+    p->wire_len += len;
+}
+
+size_t uart_pipe_rx_pending(uart_inst_t* uart)
+{
+    pipe_t* p = pipe_of(uart);
+    return p->wire_len - p->wire_read;
+}
+
+uint32_t uart_pipe_rx_overruns(uart_inst_t* uart)
+{
+    return pipe_of(uart)->rx_overruns;
+}
+
+// ============================================================================
+// hardware/uart.h
+// ============================================================================
+
+uint32_t uart_init(uart_inst_t* uart, uint32_t baudrate)
+{
+    pipe_t* p = pipe_of(uart);
+    p->baud = baudrate;
+    uart_pipe_reset(uart);
+    return baudrate;
+}
+
+void uart_set_format(uart_inst_t* uart, unsigned data_bits, unsigned stop_bits, uart_parity_t parity)
+{
+    (void)uart; (void)data_bits; (void)stop_bits; (void)parity;
+}
+
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled)
+{
+    (void)uart; (void)enabled;
+}
+
+uart_hw_t* uart_get_hw(uart_inst_t* uart)
+{
+    return &pipe_hw[uart->index];
+}
+
+unsigned uart_get_dreq(uart_inst_t* uart, bool is_tx)
+{
+    return 20u + uart->index * 2u + (is_tx ? 0u : 1u);
+}
+
+bool uart_is_writable(uart_inst_t* uart)
+{
+    return pipe_of(uart)->fifo_count < UART_PIPE_FIFO_DEPTH;
+}
+
+void uart_putc_raw(uart_inst_t* uart, char c)
+{
+    pipe_t* p = pipe_of(uart);
+    while (p->fifo_count == UART_PIPE_FIFO_DEPTH) {
+        p->blocked_ns += p->byte_ns;
+        shift_out(p);
+    }
+    p->fifo[(p->fifo_head + p->fifo_count) % UART_PIPE_FIFO_DEPTH] = (uint8_t)c;
+    p->fifo_count++;
+}
+
+void uart_write_blocking(uart_inst_t* uart, const uint8_t* src, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        uart_putc_raw(uart, (char)src[i]);
+    }
+}
+
+bool uart_is_readable(uart_inst_t* uart)
+{
+    pipe_t* p = pipe_of(uart);
+    return p->rx_head != p->rx_tail;
+}
+
+char uart_getc(uart_inst_t* uart)
+{
+    pipe_t* p = pipe_of(uart);
+    if (p->rx_head == p->rx_tail) return 0;
+    char c = (char)p->rx[p->rx_tail];
+    p->rx_tail = (p->rx_tail + 1) % PIPE_RX_SIZE;
+    return c;
+}
+
+// ============================================================================
+// hardware/dma.h
+// ============================================================================
+
+int dma_claim_unused_channel(bool required)
+{
+    for (int ch = 0; ch < dma_available; ch++) {
+        if (!dma_chans[ch].claimed) {
+            dma_chans[ch].claimed = true;
+            dma_chans[ch].uart = -1;
+            dma_chans[ch].rx_uart = -1;
+            return ch;
+        }
+    }
+    if (required) abort();
+    return -1;
+}
+
+void dma_channel_unclaim(unsigned channel)
+{
+    dma_channel_abort(channel);
+    dma_chans[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(unsigned channel)
+{
+    (void)channel;
+    dma_channel_config c = { DMA_SIZE_32 };
+    return c;
+}
+
+void dma_channel_configure(unsigned channel, const dma_channel_config* config,
+                           volatile void* write_addr, const volatile void* read_addr,
+                           unsigned transfer_count, bool trigger)
+{
+    dma_chans[channel].config = *config;
+    dma_chans[channel].write_addr = write_addr;
+    dma_chans[channel].uart = -1;
+    dma_chans[channel].rx_uart = -1;
+    for (int i = 0; i < PIPE_UARTS; i++) {
+        if (write_addr == &pipe_hw[i].dr) dma_chans[channel].uart = i;
+        if (read_addr == &pipe_hw[i].dr) dma_chans[channel].rx_uart = i;
+    }
+
+    int rx = dma_chans[channel].rx_uart;
+    if (rx >= 0) {
+        pipes[rx].rx_dma = channel;
+        dma_regs[channel].transfer_count = 0;
+        if (trigger) dma_channel_set_trans_count(channel, transfer_count, true);
+        return;
+    }
+    if (trigger) {
+        dma_channel_transfer_from_buffer_now(channel, read_addr, transfer_count);
+    }
+}
+
+static uint32_t bitrev(uint32_t v, unsigned bits)
+{
+    uint32_t r = 0;
+    for (unsigned i = 0; i < bits; i++) {
+        r = (r << 1) | ((v >> i) & 1);
+    }
+    return r;
+}
+
+static void sniff_feed(uint32_t value, unsigned bits)
+{
+    if (sniff.mode == DMA_SNIFF_CTRL_CALC_VALUE_CRC32R) {
+        value = bitrev(value, bits);
+    } else if (sniff.mode != DMA_SNIFF_CTRL_CALC_VALUE_CRC32) {
+        abort();            // Only the CRC-32 modes are modelled
+    }
+    sniff.fed++;
+    for (int i = (int)bits - 1; i >= 0; i--) {
+        uint32_t top = (sniff.accumulator >> 31) ^ ((value >> i) & 1);
+        sniff.accumulator <<= 1;
+        if (top) sniff.accumulator ^= 0x04C11DB7u;
+    }
+}
+
+static void mem_transfer(unsigned channel, const volatile void* read_addr, uint32_t transfer_count)
+{
+    uint32_t ctrl = dma_chans[channel].config.ctrl;
+    unsigned size = 1u << (ctrl & 3u);
+    const volatile uint8_t* src = read_addr;
+    volatile uint8_t* dst = dma_chans[channel].write_addr;
+    bool sniffing = sniff.enabled && sniff.channel == channel && (ctrl & BENCH_DMA_CTRL_SNIFF_EN);
+
+    for (uint32_t n = 0; n < transfer_count; n++) {
+        uint32_t value = 0;
+        for (unsigned b = 0; b < size; b++) {
+            value |= (uint32_t)src[b] << (8 * b);
+            dst[b] = src[b];
+        }
+        if (sniffing) sniff_feed(value, size * 8);
+        if (ctrl & BENCH_DMA_CTRL_INCR_READ) src += size;
+        if (ctrl & BENCH_DMA_CTRL_INCR_WRITE) dst += size;
+    }
+}
+
+uint32_t uart_pipe_dma_sniffed(void)
+{
+    return sniff.fed;
+}
+
+void dma_channel_transfer_from_buffer_now(unsigned channel, const volatile void* read_addr,
+                                          uint32_t transfer_count)
+{
+    int u = dma_chans[channel].uart;
+    if (u < 0) {
+        mem_transfer(channel, read_addr, transfer_count);
+        return;
+    }
+
+    pipe_t* p = &pipes[u];
+    p->dma_src = read_addr;
+    p->dma_remaining = transfer_count;
+    p->dma_transfers++;
+    fifo_refill(p);
+}
+
+dma_channel_hw_t* dma_channel_hw_addr(unsigned channel)
+{
+    return &dma_regs[channel];
+}
+
+// Only RX channels are re-triggered this way; the write address carries on
+void dma_channel_set_trans_count(unsigned channel, uint32_t trans_count, bool trigger)
+{
+    int rx = dma_chans[channel].rx_uart;
+    if (rx < 0) abort();
+    if (trigger) {
+        dma_regs[channel].transfer_count = trans_count;
+        rx_dma_pump(&pipes[rx]);
+    }
+}
+
+bool dma_channel_is_busy(unsigned channel)
+{
+    if (dma_chans[channel].rx_uart >= 0) return dma_regs[channel].transfer_count > 0;
+    int u = dma_chans[channel].uart;
+    return u >= 0 && pipes[u].dma_remaining > 0;
+}
+
+void dma_channel_abort(unsigned channel)
+{
+    int rx = dma_chans[channel].rx_uart;
+    if (rx >= 0) {
+        dma_regs[channel].transfer_count = 0;
+        pipes[rx].rx_dma = -1;
+    }
+    int u = dma_chans[channel].uart;
+    if (u >= 0) pipes[u].dma_remaining = 0;
+}
+
+void dma_channel_wait_for_finish_blocking(unsigned channel)
+{
+    // UART TX channels finish as time advances; only memory copies wait here
+    if (dma_chans[channel].uart >= 0 || dma_chans[channel].rx_uart >= 0) abort();
+}
+
+// ============================================================================
+// SNIFFER
+// ============================================================================
+
+void dma_sniffer_enable(unsigned channel, unsigned mode, bool force_channel_enable)
+{
+    (void)force_channel_enable;
+    sniff.enabled = true;
+    sniff.channel = channel;
+    sniff.mode = mode;
+}
+
+void dma_sniffer_disable(void)
+{
+    sniff.enabled = false;
+}
+
+void dma_sniffer_set_data_accumulator(uint32_t seed_value)
+{
+    sniff.accumulator = seed_value;
+}
+
+uint32_t dma_sniffer_get_data_accumulator(void)
+{
+    uint32_t v = sniff.accumulator;
+    if (sniff.reverse) v = bitrev(v, 32);
+    if (sniff.invert) v = ~v;
+    return v;
+}
+
+void dma_sniffer_set_output_reverse_enabled(bool enable)
+{
+    sniff.reverse = enable;
+}
+
+void dma_sniffer_set_output_invert_enabled(bool enable)
+{
+    sniff.invert = enable;
+}
@@ -0,0 +1,65 @@
+// uart_pipe.h - Byte-pipe UART for host benchmarks
+//
+// Replaces the RP2040 UART (hardware/uart.h) and its TX DMA channel
+// (hardware/dma.h) with a simulated wire. Nothing moves until the harness
+// advances time: each byte time at the configured baud rate shifts one byte
+// out of the 32-byte TX FIFO into a capture buffer, and a running DMA
+// transfer keeps the FIFO topped up. uart_write_blocking() advances time
+// itself and accounts the wait, which is what a caller would stall for.
+//
+// Other DMA channels are memory-to-memory copies with the CRC sniffer.
+//
+// RX mirrors it: bytes sent with uart_pipe_rx_send() arrive one byte time
+// apart while time advances, into a running RX DMA transfer if there is one,
+// else into the 32-byte RX FIFO, where they are lost if nobody reads it in
+// time. uart_pipe_rx_inject() delivers at once, for protocol-level tests.
+
+#ifndef BENCH_UART_PIPE_H
+#define BENCH_UART_PIPE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "hardware/uart.h"
+
+#define UART_PIPE_FIFO_DEPTH    32
+
+// Clear FIFOs, DMA state, captured output and counters
+void uart_pipe_reset(uart_inst_t* uart);
+
+// Number of DMA channels dma_claim_unused_channel() will hand out (default 12)
+void uart_pipe_set_dma_channels(int count);
+
+// Advance simulated time on the wire
+void uart_pipe_advance_ns(uart_inst_t* uart, uint64_t ns);
+
+// Run the wire until the FIFO and any DMA transfer are empty
+void uart_pipe_drain(uart_inst_t* uart);
+
+// Take bytes that have been shifted out of TX since the last call
+size_t uart_pipe_tx_take(uart_inst_t* uart, uint8_t* out, size_t max);
+
+// Bytes still in the TX FIFO or behind a running DMA transfer
+uint32_t uart_pipe_tx_backlog(uart_inst_t* uart);
+
+// Time uart_write_blocking() callers spent waiting on the FIFO
+uint64_t uart_pipe_blocked_ns(uart_inst_t* uart);
+
+// DMA transfers started towards this UART
+uint32_t uart_pipe_dma_transfers(uart_inst_t* uart);
+
+// Deliver bytes now (to RX DMA if running, else to an unbounded RX FIFO)
+void uart_pipe_rx_inject(uart_inst_t* uart, const uint8_t* data, size_t len);
+
+// Put bytes on the RX wire; they arrive at the baud rate as time advances
+void uart_pipe_rx_send(uart_inst_t* uart, const uint8_t* data, size_t len);
+
+// Bytes still on the RX wire
+size_t uart_pipe_rx_pending(uart_inst_t* uart);
+
+// Bytes that arrived to a full RX FIFO and were dropped
+uint32_t uart_pipe_rx_overruns(uart_inst_t* uart);
+
+// Elements fed through the DMA CRC sniffer since start
+uint32_t uart_pipe_dma_sniffed(void);
+
+#endif // BENCH_UART_PIPE_H
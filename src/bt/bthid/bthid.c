@@ -2,6 +2,7 @@
 // Handles Bluetooth HID devices and routes reports to device-specific drivers
 
 #include "bthid.h"
+#include "bthid_registry.h"
 #include "bt/transport/bt_transport.h"
 #include "devices/generic/bthid_gamepad.h"
 #include "devices/vendors/sony/ds3_bt.h"
@@ -18,11 +19,20 @@
 #define SONY_REPORT_ID_DS4      0x11    // DS4 full BT report
 #define SONY_REPORT_ID_DS5      0x31    // DS5 full BT report
 
+// Input report IDs that identify the controller, whatever it was bound as
+static const struct {
+    uint8_t report_id;
+    const bthid_driver_t* driver;
+} report_id_drivers[] = {
+    { SONY_REPORT_ID_DS4, &ds4_bt_driver },
+    { SONY_REPORT_ID_DS5, &ds5_bt_driver },
+};
+
 // ============================================================================
 // CONFIGURATION
 // ============================================================================
 
-#define BTHID_MAX_DRIVERS       8   // Max registered drivers
+#define BTHID_MAX_DRIVERS       BTHID_DRIVER_COUNT  // Sized by bthid_registry.h
 
 // ============================================================================
 // STATIC DATA
@@ -32,6 +42,21 @@ static bthid_device_t devices[BTHID_MAX_DEVICES];
 static const bthid_driver_t* drivers[BTHID_MAX_DRIVERS];
 static uint8_t driver_count = 0;
 
+// VID/PID -> drivers[] slot, filled from each driver's ids at registration
+static bthid_index_t driver_index;
+
+// Per-device report dispatch, cached when a driver is bound. Input reports
+// go straight to process_report; only Sony/generic bindings look at the
+// report ID, and only when it differs from the last one.
+typedef struct {
+    void (*process_report)(bthid_device_t* device, const uint8_t* data, uint16_t len);
+    uint8_t report_id;          // Last input report ID seen
+    bool have_report_id;        // report_id is valid
+    bool reclassify;            // Report ID may still select another driver
+} bthid_dispatch_t;
+
+static bthid_dispatch_t dispatch[BTHID_MAX_DEVICES];
+
 // ============================================================================
 // FORWARD DECLARATIONS
 // ============================================================================
@@ -40,7 +65,7 @@ static bthid_device_t* find_or_create_device(uint8_t conn_index);
 static const bthid_driver_t* find_driver(const char* name, const uint8_t* cod,
                                           uint16_t vendor_id, uint16_t product_id);
 static bthid_device_type_t classify_device(const uint8_t* class_of_device);
-static bool try_reclassify_sony_device(bthid_device_t* device, uint8_t report_id);
+static bool dispatch_report_id(bthid_device_t* device, bthid_dispatch_t* d, uint8_t report_id);
 
 // ============================================================================
 // INITIALIZATION
@@ -49,7 +74,9 @@ static bool try_reclassify_sony_device(bthid_device_t* device, uint8_t report_id
 void bthid_init(void)
 {
     memset(devices, 0, sizeof(devices));
+    memset(dispatch, 0, sizeof(dispatch));
     driver_count = 0;
+    bthid_index_reset(&driver_index);
     printf("[BTHID] Initialized\n");
 }
 
@@ -60,8 +87,10 @@ void bthid_init(void)
 void bthid_register_driver(const bthid_driver_t* driver)
 {
     if (driver_count < BTHID_MAX_DRIVERS) {
-        drivers[driver_count++] = driver;
-        printf("[BTHID] Registered driver: %s\n", driver->name);
+        uint8_t slot = driver_count++;
+        drivers[slot] = driver;
+        uint8_t ids = bthid_index_add_ids(&driver_index, driver->ids, slot);
+        printf("[BTHID] Registered driver: %s (%u VID/PID)\n", driver->name, ids);
     } else {
         printf("[BTHID] Driver registry full, cannot add: %s\n", driver->name);
     }
@@ -130,6 +159,7 @@ static void remove_device(uint8_t conn_index)
                 }
             }
             memset(&devices[i], 0, sizeof(devices[i]));
+            memset(&dispatch[i], 0, sizeof(dispatch[i]));
             printf("[BTHID] Device removed from slot %d\n", i);
             break;
         }
@@ -157,6 +187,45 @@ uint8_t bthid_get_device_count(void)
     return count;
 }
 
+// ============================================================================
+// DRIVER BINDING
+// ============================================================================
+
+// Bind a driver to a device and cache its report dispatch
+static void bind_driver(bthid_device_t* device, const bthid_driver_t* driver)
+{
+    bthid_dispatch_t* d = &dispatch[device - devices];
+
+    device->driver = driver;
+    d->process_report = driver->process_report;
+    d->have_report_id = false;
+
+    // Only these drivers can be replaced by what the report ID says. Others
+    // (Xbox, Switch...) never are, since their data may contain 0x11/0x31.
+    d->reclassify = (driver == &ds3_bt_driver || driver == &ds4_bt_driver ||
+                     driver == &ds5_bt_driver || driver == &bthid_gamepad_driver);
+
+    if (driver->init) {
+        driver->init(device);
+    }
+}
+
+// Replace a device's driver
+static void rebind_driver(bthid_device_t* device, const bthid_driver_t* driver)
+{
+    const bthid_driver_t* current = (const bthid_driver_t*)device->driver;
+
+    // Disconnect old driver
+    if (current && current->disconnect) {
+        current->disconnect(device);
+    }
+
+    // Clear driver data
+    device->driver_data = NULL;
+
+    bind_driver(device, driver);
+}
+
 // ============================================================================
 // DEVICE INFO UPDATE (VID/PID available after SDP query)
 // ============================================================================
@@ -188,31 +257,15 @@ void bthid_update_device_info(uint8_t conn_index, const char* name,
             const uint8_t* cod = conn ? conn->class_of_device : NULL;
 
             // Try to find a specific driver
-            for (int i = 0; i < driver_count; i++) {
-                if (drivers[i] != &bthid_gamepad_driver &&
-                    drivers[i]->match && drivers[i]->match(device->name, cod, vendor_id, product_id)) {
-                    new_driver = drivers[i];
-                    break;
-                }
+            new_driver = find_driver(device->name, cod, vendor_id, product_id);
+            if (new_driver == &bthid_gamepad_driver) {
+                new_driver = NULL;
             }
 
             if (new_driver) {
                 printf("[BTHID] Re-selecting driver: %s -> %s (VID=0x%04X PID=0x%04X)\n",
                        current->name, new_driver->name, vendor_id, product_id);
-
-                // Disconnect old driver
-                if (current && current->disconnect) {
-                    current->disconnect(device);
-                }
-
-                // Clear driver data
-                device->driver_data = NULL;
-
-                // Initialize new driver
-                device->driver = new_driver;
-                if (new_driver->init) {
-                    new_driver->init(device);
-                }
+                rebind_driver(device, new_driver);
             }
         }
     }
@@ -225,7 +278,13 @@ void bthid_update_device_info(uint8_t conn_index, const char* name,
 static const bthid_driver_t* find_driver(const char* name, const uint8_t* cod,
                                           uint16_t vendor_id, uint16_t product_id)
 {
-    // First try registered drivers
+    // Known VID/PID: one index lookup (VID/PID match has priority)
+    int slot = bthid_index_find(&driver_index, vendor_id, product_id);
+    if (slot >= 0) {
+        return drivers[slot];
+    }
+
+    // Otherwise probe registered drivers by name/COD, in priority order
     for (int i = 0; i < driver_count; i++) {
         if (drivers[i]->match && drivers[i]->match(name, cod, vendor_id, product_id)) {
             return drivers[i];
@@ -234,6 +293,13 @@ static const bthid_driver_t* find_driver(const char* name, const uint8_t* cod,
     return NULL;
 }
 
+const ble_conn_params_t* bthid_conn_params_for(const char* name, uint16_t vendor_id,
+                                               uint16_t product_id)
+{
+    const bthid_driver_t* driver = find_driver(name, NULL, vendor_id, product_id);
+    return driver ? driver->conn_params : NULL;
+}
+
 static bthid_device_type_t classify_device(const uint8_t* class_of_device)
 {
     if (!class_of_device) {
@@ -281,37 +347,27 @@ static bthid_device_type_t classify_device(const uint8_t* class_of_device)
 // Detect DS4 vs DS5 by report ID and swap drivers if needed
 // ============================================================================
 
-static bool try_reclassify_sony_device(bthid_device_t* device, uint8_t report_id)
+// Record a new input report ID for a Sony/generic binding. Returns true if
+// the report ID belongs to another driver and the device was rebound.
+static bool dispatch_report_id(bthid_device_t* device, bthid_dispatch_t* d, uint8_t report_id)
 {
-    const bthid_driver_t* current = (const bthid_driver_t*)device->driver;
-    const bthid_driver_t* new_driver = NULL;
-
-    // Check if reclassification is needed
-    if (report_id == SONY_REPORT_ID_DS5 && current != &ds5_bt_driver) {
-        // Got DS5 report but not using DS5 driver
-        new_driver = &ds5_bt_driver;
-        printf("[BTHID] Reclassify: report 0x%02X -> DS5 driver\n", report_id);
-    } else if (report_id == SONY_REPORT_ID_DS4 && current != &ds4_bt_driver) {
-        // Got DS4 full report but not using DS4 driver
-        new_driver = &ds4_bt_driver;
-        printf("[BTHID] Reclassify: report 0x%02X -> DS4 driver\n", report_id);
-    }
+    d->report_id = report_id;
+    d->have_report_id = true;
 
-    if (new_driver) {
-        // Disconnect old driver
-        if (current && current->disconnect) {
-            current->disconnect(device);
+    for (size_t i = 0; i < sizeof(report_id_drivers) / sizeof(report_id_drivers[0]); i++) {
+        if (report_id != report_id_drivers[i].report_id) {
+            continue;
         }
 
-        // Clear driver data
-        device->driver_data = NULL;
-
-        // Initialize new driver
-        device->driver = new_driver;
-        if (new_driver->init) {
-            new_driver->init(device);
+        const bthid_driver_t* new_driver = report_id_drivers[i].driver;
+        if (device->driver == new_driver) {
+            // Confirmed: stop checking report IDs for this connection
+            d->reclassify = false;
+            return false;
         }
 
+        printf("[BTHID] Reclassify: report 0x%02X -> %s\n", report_id, new_driver->name);
+        rebind_driver(device, new_driver);
         printf("[BTHID] Reclassification complete: now using %s\n", new_driver->name);
         return true;
     }
@@ -359,16 +415,10 @@ void bt_on_hid_ready(uint8_t conn_index)
                                                conn->vendor_id, conn->product_id);
     if (driver) {
         printf("[BTHID] Using driver: %s\n", driver->name);
-        device->driver = driver;
-        if (driver->init) {
-            driver->init(device);
-        }
+        bind_driver(device, driver);
     } else {
         printf("[BTHID] No specific driver found, using generic gamepad\n");
-        device->driver = &bthid_gamepad_driver;
-        if (bthid_gamepad_driver.init) {
-            bthid_gamepad_driver.init(device);
-        }
+        bind_driver(device, &bthid_gamepad_driver);
     }
 
     // Debug: confirm device state directly from array
@@ -416,28 +466,22 @@ void bt_on_hid_report(uint8_t conn_index, const uint8_t* data, uint16_t len)
             uint16_t report_len = len - 1;
 
             if (report_type == BTHID_REPORT_TYPE_INPUT && report_len >= 1) {
-                // Check report ID for Sony device reclassification
-                // Only attempt if currently using a Sony driver or generic gamepad
-                // This prevents Xbox data (which may contain 0x11/0x31 bytes) from triggering reclassification
+                bthid_dispatch_t* d = &dispatch[device - devices];
+
+                // Sony/generic bindings can still be corrected by report ID, but
+                // only a report ID that changed goes back through selection
                 uint8_t report_id = report_data[0];
-                const bthid_driver_t* drv = (const bthid_driver_t*)device->driver;
-                bool is_sony_or_generic = (drv == &ds3_bt_driver || drv == &ds4_bt_driver ||
-                                           drv == &ds5_bt_driver || drv == &bthid_gamepad_driver);
-                if (is_sony_or_generic && (report_id == SONY_REPORT_ID_DS4 || report_id == SONY_REPORT_ID_DS5)) {
-                    // Try to reclassify based on actual report ID
-                    if (try_reclassify_sony_device(device, report_id)) {
-                        // Driver was swapped - it will process this report on next iteration
-                        // after its init sequence completes
+                if (d->reclassify && (!d->have_report_id || d->report_id != report_id)) {
+                    if (dispatch_report_id(device, d, report_id)) {
+                        // Driver was swapped - it will process reports once
+                        // its init sequence completes
                         return;
                     }
                 }
 
-                // Input report - route to driver
-                if (device->driver) {
-                    const bthid_driver_t* drv = (const bthid_driver_t*)device->driver;
-                    if (drv->process_report) {
-                        drv->process_report(device, report_data, report_len);
-                    }
+                // Input report - straight to the bound driver
+                if (d->process_report) {
+                    d->process_report(device, report_data, report_len);
                 }
             }
             break;
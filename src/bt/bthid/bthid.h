@@ -6,12 +6,17 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "bthid_index.h"
+#include "bt/transport/bt_transport.h"
+#include "bt/btstack/ble_conn_params.h"
 
 // ============================================================================
 // CONSTANTS
 // ============================================================================
 
-#define BTHID_MAX_DEVICES       4   // Max simultaneous BT HID devices
+// One device slot per transport connection (Classic and BLE), so every link
+// BTstack accepts can bind a driver. Per-driver data arrays use this too.
+#define BTHID_MAX_DEVICES       BT_MAX_CONNECTIONS
 #define BTHID_MAX_NAME_LEN      32  // Max device name length
 
 // ============================================================================
@@ -85,6 +90,10 @@ typedef struct {
     bool (*match)(const char* device_name, const uint8_t* class_of_device,
                   uint16_t vendor_id, uint16_t product_id);
 
+    // VID/PID pairs this driver claims (terminated by vendor_id 0), or NULL.
+    // Indexed at registration: a known VID/PID binds without calling match().
+    const bthid_device_id_t* ids;
+
     // Initialize driver for a device
     bool (*init)(bthid_device_t* device);
 
@@ -97,6 +106,9 @@ typedef struct {
     // Device disconnected
     void (*disconnect)(bthid_device_t* device);
 
+    // BLE link parameters to request, or NULL for BLE_CONN_PARAMS_LOW_LATENCY
+    const ble_conn_params_t* conn_params;
+
 } bthid_driver_t;
 
 // ============================================================================
@@ -119,6 +131,10 @@ uint8_t bthid_get_device_count(void);
 void bthid_update_device_info(uint8_t conn_index, const char* name,
                                uint16_t vendor_id, uint16_t product_id);
 
+// BLE link parameters of the driver that would bind this device (NULL = default)
+const ble_conn_params_t* bthid_conn_params_for(const char* name, uint16_t vendor_id,
+                                               uint16_t product_id);
+
 // ============================================================================
 // DRIVER REGISTRATION
 // ============================================================================
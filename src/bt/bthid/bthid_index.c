@@ -0,0 +1,95 @@
+// bthid_index.c - VID/PID index for Bluetooth HID driver selection
+
+#include "bthid_index.h"
+#include <string.h>
+
+#define INDEX_MASK  (BTHID_INDEX_SIZE - 1)
+
+static inline uint32_t index_key(uint16_t vendor_id, uint16_t product_id)
+{
+    return ((uint32_t)vendor_id << 16) | product_id;
+}
+
+// Fibonacci hashing: spreads the few bits that differ between PIDs
+static inline uint32_t index_hash(uint32_t key)
+{
+    return (key * 2654435761u) >> 16;
+}
+
+static int index_lookup(const bthid_index_t* index, uint32_t key)
+{
+    uint32_t pos = index_hash(key);
+    for (int i = 0; i < BTHID_INDEX_SIZE; i++) {
+        uint32_t slot = (pos + i) & INDEX_MASK;
+        if (index->key[slot] == key) {
+            return index->driver[slot];
+        }
+        if (index->key[slot] == 0) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+void bthid_index_reset(bthid_index_t* index)
+{
+    memset(index, 0, sizeof(*index));
+}
+
+bool bthid_index_add(bthid_index_t* index, uint16_t vendor_id, uint16_t product_id,
+                     uint8_t driver)
+{
+    if (vendor_id == 0) {
+        return false;
+    }
+
+    uint32_t key = index_key(vendor_id, product_id);
+    uint32_t pos = index_hash(key);
+
+    // Keep one slot empty so lookups always terminate early
+    if (index->count >= BTHID_INDEX_SIZE - 1) {
+        return false;
+    }
+
+    for (int i = 0; i < BTHID_INDEX_SIZE; i++) {
+        uint32_t slot = (pos + i) & INDEX_MASK;
+        if (index->key[slot] == key) {
+            return false;  // Claimed by an earlier (higher priority) driver
+        }
+        if (index->key[slot] == 0) {
+            index->key[slot] = key;
+            index->driver[slot] = driver;
+            index->count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t bthid_index_add_ids(bthid_index_t* index, const bthid_device_id_t* ids,
+                            uint8_t driver)
+{
+    uint8_t added = 0;
+    if (!ids) {
+        return 0;
+    }
+    for (; ids->vendor_id; ids++) {
+        if (bthid_index_add(index, ids->vendor_id, ids->product_id, driver)) {
+            added++;
+        }
+    }
+    return added;
+}
+
+int bthid_index_find(const bthid_index_t* index, uint16_t vendor_id, uint16_t product_id)
+{
+    if (vendor_id == 0 || index->count == 0) {
+        return -1;
+    }
+
+    int driver = index_lookup(index, index_key(vendor_id, product_id));
+    if (driver < 0 && product_id != BTHID_PID_ANY) {
+        driver = index_lookup(index, index_key(vendor_id, BTHID_PID_ANY));
+    }
+    return driver;
+}
@@ -0,0 +1,52 @@
+// bthid_index.h - VID/PID index for Bluetooth HID driver selection
+//
+// Drivers list the VID/PID pairs they claim (bthid_driver_t.ids). bthid.c
+// adds them here at registration, so a connection with a known VID/PID is
+// bound with one hash lookup instead of probing every driver's match().
+// Name and Class of Device matching still go through match().
+//
+// Open addressing over (VID << 16 | PID), linear probing. The first driver
+// to claim a pair keeps it, like the first match() wins in registration
+// order. Pure C with no SDK dependencies (src/bench/checks/bthid_index.c).
+
+#ifndef BTHID_INDEX_H
+#define BTHID_INDEX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Product ID wildcard: claim every product of a vendor
+#define BTHID_PID_ANY           0xFFFF
+
+// Index slots (power of two, keep at least twice the claimed pairs)
+#ifndef BTHID_INDEX_SIZE
+#define BTHID_INDEX_SIZE        64
+#endif
+
+typedef struct {
+    uint16_t vendor_id;         // 0 terminates a list
+    uint16_t product_id;        // Or BTHID_PID_ANY
+} bthid_device_id_t;
+
+typedef struct {
+    uint32_t key[BTHID_INDEX_SIZE];     // VID << 16 | PID, 0 = empty
+    uint8_t  driver[BTHID_INDEX_SIZE];  // Driver table slot
+    uint8_t  count;
+} bthid_index_t;
+
+// Remove all entries
+void bthid_index_reset(bthid_index_t* index);
+
+// Claim one pair for a driver slot. Returns false if it wasn't added: the
+// index is full, vendor_id is 0, or an earlier driver already claimed it.
+bool bthid_index_add(bthid_index_t* index, uint16_t vendor_id, uint16_t product_id,
+                     uint8_t driver);
+
+// Claim a vendor_id 0 terminated list. Returns the number of pairs added.
+uint8_t bthid_index_add_ids(bthid_index_t* index, const bthid_device_id_t* ids,
+                            uint8_t driver);
+
+// Driver slot for an exact VID/PID, else for the vendor's wildcard, else -1
+int bthid_index_find(const bthid_index_t* index, uint16_t vendor_id, uint16_t product_id);
+
+#endif // BTHID_INDEX_H
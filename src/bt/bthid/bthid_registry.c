@@ -21,7 +21,7 @@ void bthid_registry_init(void)
     bthid_init();
 
     // Register vendor-specific drivers first (higher priority)
-    // Order matters - first match wins
+    // Order matters - first match wins (keep bthid_driver_slot_t in sync)
 
     // Sony controllers
     ds3_bt_register();
@@ -4,6 +4,22 @@
 #ifndef BTHID_REGISTRY_H
 #define BTHID_REGISTRY_H
 
+// Registered drivers, in priority order (first match wins).
+// BTHID_DRIVER_COUNT sizes the driver table in bthid.c.
+typedef enum {
+    BTHID_DRIVER_DS3,
+    BTHID_DRIVER_DS4,
+    BTHID_DRIVER_DS5,
+    BTHID_DRIVER_SWITCH_PRO,
+    BTHID_DRIVER_SWITCH2_BLE,
+    BTHID_DRIVER_XBOX_BLE,
+    BTHID_DRIVER_XBOX_BT,
+    BTHID_DRIVER_STADIA,
+    BTHID_DRIVER_GENERIC,
+    // Add more drivers here
+    BTHID_DRIVER_COUNT // Automatically equals the number of drivers
+} bthid_driver_slot_t;
+
 // Initialize BTHID layer and register all drivers
 void bthid_registry_init(void);
 
@@ -94,6 +94,7 @@ static bool stadia_init(bthid_device_t* device)
 
             stadia_data[i].event.type = INPUT_TYPE_GAMEPAD;
             stadia_data[i].event.dev_addr = device->conn_index;
+            stadia_data[i].event.source = INPUT_SOURCE_BT;
             stadia_data[i].event.instance = 0;
             stadia_data[i].event.transport = INPUT_TRANSPORT_BT_BLE;
 
@@ -203,9 +204,15 @@ static void stadia_disconnect(bthid_device_t* device)
 // DRIVER STRUCT
 // ============================================================================
 
+static const bthid_device_id_t stadia_ids[] = {
+    { GOOGLE_VID, STADIA_PID },
+    { 0, 0 }
+};
+
 const bthid_driver_t stadia_bt_driver = {
     .name = "Google Stadia BT",
     .match = stadia_match,
+    .ids = stadia_ids,
     .init = stadia_init,
     .process_report = stadia_process_report,
     .task = stadia_task,
@@ -30,6 +30,12 @@
 #define XBOX_BLE_LEFT_THUMB      0x2000  // L3
 #define XBOX_BLE_RIGHT_THUMB     0x4000  // R3
 
+// BLE link parameters (ble_conn_params.h). Reports arrive once per
+// connection event, so ask for the shortest interval with no latency.
+#ifndef XBOX_BLE_CONN_PARAMS
+#define XBOX_BLE_CONN_PARAMS     BLE_CONN_PARAMS_LOW_LATENCY
+#endif
+
 // ============================================================================
 // DRIVER DATA
 // ============================================================================
@@ -83,6 +89,7 @@ static bool xbox_ble_init(bthid_device_t* device)
             xbox_data[i].event.type = INPUT_TYPE_GAMEPAD;
             xbox_data[i].event.transport = INPUT_TRANSPORT_BT_BLE;
             xbox_data[i].event.dev_addr = device->conn_index;
+            xbox_data[i].event.source = INPUT_SOURCE_BLE_CENTRAL;
             xbox_data[i].event.instance = 0;
             xbox_data[i].event.button_count = 10;
 
@@ -205,6 +212,8 @@ static void xbox_ble_disconnect(bthid_device_t* device)
 // DRIVER STRUCT
 // ============================================================================
 
+static const ble_conn_params_t xbox_ble_conn_params = XBOX_BLE_CONN_PARAMS;
+
 const bthid_driver_t xbox_ble_driver = {
     .name = "Xbox Wireless Controller (BLE)",
     .match = xbox_ble_match,
@@ -212,6 +221,7 @@ const bthid_driver_t xbox_ble_driver = {
     .process_report = xbox_ble_process_report,
     .task = xbox_ble_task,
     .disconnect = xbox_ble_disconnect,
+    .conn_params = &xbox_ble_conn_params,
 };
 
 void xbox_ble_register(void)
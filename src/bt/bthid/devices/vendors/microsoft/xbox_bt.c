@@ -151,6 +151,7 @@ static bool xbox_init(bthid_device_t* device)
 
             xbox_data[i].event.type = INPUT_TYPE_GAMEPAD;
             xbox_data[i].event.dev_addr = device->conn_index;
+            xbox_data[i].event.source = INPUT_SOURCE_BT;
             xbox_data[i].event.instance = 0;
             xbox_data[i].event.button_count = 10;
 
@@ -293,9 +294,15 @@ static void xbox_disconnect(bthid_device_t* device)
 // DRIVER STRUCT
 // ============================================================================
 
+static const bthid_device_id_t xbox_ids[] = {
+    { 0x045E, BTHID_PID_ANY },  // Microsoft: many Xbox controller PIDs
+    { 0, 0 }
+};
+
 const bthid_driver_t xbox_bt_driver = {
     .name = "Xbox Wireless Controller (BT)",
     .match = xbox_match,
+    .ids = xbox_ids,
     .init = xbox_init,
     .process_report = xbox_process_report,
     .task = xbox_task,
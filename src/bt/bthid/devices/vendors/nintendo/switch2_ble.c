@@ -25,6 +25,12 @@
 #define SW2_PRO2_PID    0x2069  // Pro Controller 2
 #define SW2_GC_PID      0x2073  // NSO GameCube Controller
 
+// BLE link parameters (ble_conn_params.h). Reports arrive once per
+// connection event, so ask for the shortest interval with no latency.
+#ifndef SW2_BLE_CONN_PARAMS
+#define SW2_BLE_CONN_PARAMS     BLE_CONN_PARAMS_LOW_LATENCY
+#endif
+
 // Button bit positions in the 32-bit button field
 #define SW2_Y           0
 #define SW2_X           1
@@ -119,6 +125,7 @@ static bool switch2_ble_init(bthid_device_t* device)
             switch2_data[i].event.type = INPUT_TYPE_GAMEPAD;
             switch2_data[i].event.transport = INPUT_TRANSPORT_BT_BLE;
             switch2_data[i].event.dev_addr = device->conn_index;
+            switch2_data[i].event.source = INPUT_SOURCE_BLE_CENTRAL;
             switch2_data[i].event.instance = 0;
             switch2_data[i].event.button_count = 14;
 
@@ -312,13 +319,25 @@ static void switch2_ble_disconnect(bthid_device_t* device)
 // DRIVER STRUCT
 // ============================================================================
 
+static const bthid_device_id_t switch2_ble_ids[] = {
+    { 0x057E, SW2_LJC_PID },
+    { 0x057E, SW2_RJC_PID },
+    { 0x057E, SW2_PRO2_PID },
+    { 0x057E, SW2_GC_PID },
+    { 0, 0 }
+};
+
+static const ble_conn_params_t switch2_ble_conn_params = SW2_BLE_CONN_PARAMS;
+
 const bthid_driver_t switch2_ble_driver = {
     .name = "Nintendo Switch 2 Controller (BLE)",
     .match = switch2_ble_match,
+    .ids = switch2_ble_ids,
     .init = switch2_ble_init,
     .process_report = switch2_ble_process_report,
     .task = switch2_ble_task,
     .disconnect = switch2_ble_disconnect,
+    .conn_params = &switch2_ble_conn_params,
 };
 
 void switch2_ble_register(void)
@@ -243,6 +243,7 @@ static bool switch_init(bthid_device_t* device)
 
             switch_data[i].event.type = INPUT_TYPE_GAMEPAD;
             switch_data[i].event.dev_addr = device->conn_index;
+            switch_data[i].event.source = INPUT_SOURCE_BT;
             switch_data[i].event.instance = 0;
             switch_data[i].event.button_count = 10;
 
@@ -385,9 +386,17 @@ static void switch_disconnect(bthid_device_t* device)
 // DRIVER STRUCT
 // ============================================================================
 
+static const bthid_device_id_t switch_ids[] = {
+    { 0x057E, 0x2006 },     // Joy-Con L
+    { 0x057E, 0x2007 },     // Joy-Con R
+    { 0x057E, 0x2009 },     // Pro Controller
+    { 0, 0 }
+};
+
 const bthid_driver_t switch_pro_bt_driver = {
     .name = "Nintendo Switch Pro (BT)",
     .match = switch_match,
+    .ids = switch_ids,
     .init = switch_init,
     .process_report = switch_process_report,
     .task = switch_task,
@@ -160,6 +160,7 @@ static bool ds3_init(bthid_device_t* device)
             ds3_data[i].event.type = INPUT_TYPE_GAMEPAD;
             ds3_data[i].event.transport = INPUT_TRANSPORT_BT_CLASSIC;
             ds3_data[i].event.dev_addr = device->conn_index;
+            ds3_data[i].event.source = INPUT_SOURCE_BT;
             ds3_data[i].event.instance = 0;
             ds3_data[i].event.button_count = 10;
 
@@ -447,9 +448,15 @@ static void ds3_task(bthid_device_t* device)
 }
 
 // Driver struct
+static const bthid_device_id_t ds3_ids[] = {
+    { 0x054C, 0x0268 },     // DualShock 3 / Sixaxis
+    { 0, 0 }
+};
+
 const bthid_driver_t ds3_bt_driver = {
     .name = "Sony DualShock 3 (BT)",
     .match = ds3_match,
+    .ids = ds3_ids,
     .init = ds3_init,
     .process_report = ds3_process_report,
     .disconnect = ds3_disconnect,
@@ -220,6 +220,7 @@ static bool ds4_init(bthid_device_t* device)
 
             ds4_data[i].event.type = INPUT_TYPE_GAMEPAD;
             ds4_data[i].event.dev_addr = device->conn_index;
+            ds4_data[i].event.source = INPUT_SOURCE_BT;
             ds4_data[i].event.instance = 0;
             ds4_data[i].event.button_count = 14;
             ds4_data[i].event.has_motion = true;  // DS4 has motion
@@ -445,9 +446,16 @@ static void ds4_disconnect(bthid_device_t* device)
 // DRIVER STRUCT
 // ============================================================================
 
+static const bthid_device_id_t ds4_ids[] = {
+    { 0x054C, 0x05C4 },     // DualShock 4 v1
+    { 0x054C, 0x09CC },     // DualShock 4 v2 (Slim)
+    { 0, 0 }
+};
+
 const bthid_driver_t ds4_bt_driver = {
     .name = "Sony DualShock 4 (BT)",
     .match = ds4_match,
+    .ids = ds4_ids,
     .init = ds4_init,
     .process_report = ds4_process_report,
     .task = ds4_task,
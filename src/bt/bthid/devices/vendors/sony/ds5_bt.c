@@ -11,6 +11,7 @@
 #include "core/input_event.h"
 #include "core/router/router.h"
 #include "core/buttons.h"
+#include "core/crc.h"
 #include "core/services/players/manager.h"
 #include "core/services/players/feedback.h"
 #include "pico/time.h"
@@ -131,19 +132,6 @@ typedef struct __attribute__((packed)) {
 // CRC32 for DS5 BT output reports
 // ============================================================================
 
-// Core CRC32 calculation (returns raw CRC, no inversion)
-static uint32_t ds5_crc32_raw(uint32_t seed, const uint8_t* data, size_t len)
-{
-    uint32_t crc = seed;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (int j = 0; j < 8; j++) {
-            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
-        }
-    }
-    return crc;
-}
-
 // DS5 BT output CRC - matches Linux kernel hid-playstation driver
 // Two-step calculation: first hash seed (0xA2), then hash report data
 static uint32_t ds5_bt_crc32(const uint8_t* report_data, size_t len)
@@ -151,10 +139,10 @@ static uint32_t ds5_bt_crc32(const uint8_t* report_data, size_t len)
     const uint8_t seed = 0xA2;  // PS_OUTPUT_CRC32_SEED
 
     // Step 1: Hash the seed byte
-    uint32_t crc = ds5_crc32_raw(0xFFFFFFFF, &seed, 1);
+    uint32_t crc = crc32_raw(0xFFFFFFFF, &seed, 1);
 
     // Step 2: Continue hashing with report data (use intermediate CRC as seed)
-    crc = ds5_crc32_raw(crc, report_data, len);
+    crc = crc32_raw(crc, report_data, len);
 
     // Final inversion
     return ~crc;
@@ -318,6 +306,7 @@ static bool ds5_init(bthid_device_t* device)
 
             ds5_data[i].event.type = INPUT_TYPE_GAMEPAD;
             ds5_data[i].event.dev_addr = device->conn_index;
+            ds5_data[i].event.source = INPUT_SOURCE_BT;
             ds5_data[i].event.instance = 0;
             ds5_data[i].event.button_count = 14;
             ds5_data[i].event.has_motion = true;
@@ -564,9 +553,16 @@ static void ds5_disconnect(bthid_device_t* device)
 // DRIVER STRUCT
 // ============================================================================
 
+static const bthid_device_id_t ds5_ids[] = {
+    { 0x054C, 0x0CE6 },     // DualSense
+    { 0x054C, 0x0DF2 },     // DualSense Edge
+    { 0, 0 }
+};
+
 const bthid_driver_t ds5_bt_driver = {
     .name = "Sony DualSense (BT)",
     .match = ds5_match,
+    .ids = ds5_ids,
     .init = ds5_init,
     .process_report = ds5_process_report,
     .task = ds5_task,
@@ -0,0 +1,77 @@
+// ble_conn_params.c - BLE connection parameter policy for the HID central
+
+#include "ble_conn_params.h"
+#include <string.h>
+
+static const ble_conn_params_t default_params = BLE_CONN_PARAMS_LOW_LATENCY;
+
+static uint16_t clamp_u16(uint16_t value, uint16_t lo, uint16_t hi)
+{
+    if (value < lo) return lo;
+    if (value > hi) return hi;
+    return value;
+}
+
+ble_conn_params_t ble_conn_params_for(const ble_conn_params_t* driver_params)
+{
+    ble_conn_params_t params = driver_params ? *driver_params : default_params;
+    ble_conn_params_sanitize(&params);
+    return params;
+}
+
+void ble_conn_params_sanitize(ble_conn_params_t* params)
+{
+    params->interval_min = clamp_u16(params->interval_min, BLE_CONN_INTERVAL_MIN, BLE_CONN_INTERVAL_MAX);
+    params->interval_max = clamp_u16(params->interval_max, params->interval_min, BLE_CONN_INTERVAL_MAX);
+
+    // timeout * 10 ms > (1 + latency) * interval_max * 1.25 ms * 2
+    uint32_t max_latency = (BLE_CONN_TIMEOUT_MAX * 4u - 1u) / params->interval_max - 1u;
+    if (max_latency > BLE_CONN_LATENCY_MAX) max_latency = BLE_CONN_LATENCY_MAX;
+    if (params->latency > max_latency) params->latency = (uint16_t)max_latency;
+
+    uint32_t min_timeout = (1u + params->latency) * params->interval_max / 4u + 1u;
+    if (min_timeout < BLE_CONN_TIMEOUT_MIN) min_timeout = BLE_CONN_TIMEOUT_MIN;
+    params->supervision_timeout = clamp_u16(params->supervision_timeout, (uint16_t)min_timeout,
+                                            BLE_CONN_TIMEOUT_MAX);
+}
+
+bool ble_conn_params_satisfied(const ble_conn_params_t* want, uint16_t interval,
+                               uint16_t latency)
+{
+    return interval >= want->interval_min && interval <= want->interval_max &&
+           latency <= want->latency;
+}
+
+void ble_scan_params_sanitize(uint16_t* interval, uint16_t* window)
+{
+    *interval = clamp_u16(*interval, BLE_SCAN_INTERVAL_MIN, BLE_SCAN_INTERVAL_MAX);
+    *window = clamp_u16(*window, BLE_SCAN_INTERVAL_MIN, *interval);
+}
+
+void ble_report_timing_reset(ble_report_timing_t* timing)
+{
+    memset(timing, 0, sizeof(*timing));
+}
+
+bool ble_report_timing_add(ble_report_timing_t* timing, uint32_t now_us)
+{
+    if (timing->reports > 0) {
+        uint32_t gap = now_us - timing->last_us;
+        if (gap < BLE_REPORT_GAP_MAX_US) {
+            if (timing->gaps == 0) {
+                timing->avg_us = gap;
+                timing->min_us = gap;
+                timing->max_us = gap;
+            } else {
+                timing->avg_us = (uint32_t)((int32_t)timing->avg_us +
+                                            ((int32_t)gap - (int32_t)timing->avg_us) / 8);
+                if (gap < timing->min_us) timing->min_us = gap;
+                if (gap > timing->max_us) timing->max_us = gap;
+            }
+            timing->gaps++;
+        }
+    }
+    timing->last_us = now_us;
+    timing->reports++;
+    return timing->reports == BLE_REPORT_LOG_AFTER;
+}
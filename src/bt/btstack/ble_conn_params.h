@@ -0,0 +1,85 @@
+// ble_conn_params.h - BLE connection parameter policy for the HID central
+//
+// BTstack creates LE connections with its own defaults (10-30 ms interval,
+// slave latency 4). The controller reports at most once per connection
+// event, so the interval is a floor on input lag, and latency lets it skip
+// events we want to send rumble in. Gamepads are asked for 7.5 ms, the
+// shortest interval the spec allows, with no latency, unless the bthid
+// driver matching the device sets its own (bthid_driver_t.conn_params).
+//
+// Also tracks how far apart reports actually arrive on each link, which is
+// what the controller and dongle made of the request.
+// Pure C with no SDK dependencies (src/bench/checks/ble_conn_params.c).
+
+#ifndef BLE_CONN_PARAMS_H
+#define BLE_CONN_PARAMS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Spec limits (Core Vol 6, Part B, 4.5.1 / 4.5.2)
+#define BLE_CONN_INTERVAL_MIN           0x0006  // 7.5 ms, in 1.25 ms units
+#define BLE_CONN_INTERVAL_MAX           0x0C80  // 4 s
+#define BLE_CONN_LATENCY_MAX            0x01F3  // 499 events
+#define BLE_CONN_TIMEOUT_MIN            0x000A  // 100 ms, in 10 ms units
+#define BLE_CONN_TIMEOUT_MAX            0x0C80  // 32 s
+#define BLE_SCAN_INTERVAL_MIN           0x0004  // 2.5 ms, in 0.625 ms units
+#define BLE_SCAN_INTERVAL_MAX           0x4000  // 10.24 s
+
+// { interval_min, interval_max, latency, supervision_timeout }
+#define BLE_CONN_PARAMS_LOW_LATENCY     { 0x0006, 0x0006, 0, 0x0064 }  // 7.5 ms, 1 s timeout
+
+// Gaps longer than this are idle time (no input change), not report rate
+#ifndef BLE_REPORT_GAP_MAX_US
+#define BLE_REPORT_GAP_MAX_US           100000
+#endif
+
+// Log a link's report timing once after this many reports
+#ifndef BLE_REPORT_LOG_AFTER
+#define BLE_REPORT_LOG_AFTER            500
+#endif
+
+typedef struct {
+    uint16_t interval_min;          // 1.25 ms units
+    uint16_t interval_max;          // 1.25 ms units
+    uint16_t latency;               // Connection events the peripheral may skip
+    uint16_t supervision_timeout;   // 10 ms units
+} ble_conn_params_t;
+
+typedef struct {
+    uint32_t last_us;       // Arrival of the previous report
+    uint32_t avg_us;        // Moving average gap (1/8 weight), idle gaps excluded
+    uint32_t min_us;
+    uint32_t max_us;        // Longest gap under BLE_REPORT_GAP_MAX_US
+    uint32_t reports;
+    uint32_t gaps;          // Gaps counted in avg/min/max
+} ble_report_timing_t;
+
+// Parameters to request, already sanitized: the driver's own, or
+// BLE_CONN_PARAMS_LOW_LATENCY if it has none (NULL)
+ble_conn_params_t ble_conn_params_for(const ble_conn_params_t* driver_params);
+
+// Clamp to spec limits: interval_max >= interval_min, and a supervision
+// timeout longer than (1 + latency) * interval_max * 2
+void ble_conn_params_sanitize(ble_conn_params_t* params);
+
+// True if a link's current parameters meet the request
+bool ble_conn_params_satisfied(const ble_conn_params_t* want, uint16_t interval,
+                               uint16_t latency);
+
+// Clamp scan interval/window (0.625 ms units), window <= interval
+void ble_scan_params_sanitize(uint16_t* interval, uint16_t* window);
+
+// Connection interval in microseconds
+static inline uint32_t ble_conn_interval_us(uint16_t interval)
+{
+    return (uint32_t)interval * 1250u;
+}
+
+void ble_report_timing_reset(ble_report_timing_t* timing);
+
+// Record a report arriving at now_us. Returns true once, when the link
+// reaches BLE_REPORT_LOG_AFTER reports.
+bool ble_report_timing_add(ble_report_timing_t* timing, uint32_t now_us);
+
+#endif // BLE_CONN_PARAMS_H
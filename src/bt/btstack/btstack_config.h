@@ -76,8 +76,14 @@
 // MEMORY POOLS (static allocation)
 // ============================================================================
 
+// Simultaneous BLE HID links (btstack_host.c). BLE devices use conn_index
+// 4 and up, so BT_MAX_CONNECTIONS (bt_transport.h) must cover 4 + this.
+#ifndef BTSTACK_MAX_BLE_CONNECTIONS
+#define BTSTACK_MAX_BLE_CONNECTIONS 4
+#endif
+
 // Number of HCI connections (Classic + BLE)
-#define MAX_NR_HCI_CONNECTIONS 2
+#define MAX_NR_HCI_CONNECTIONS (MAX_NR_HID_HOST_CONNECTIONS + BTSTACK_MAX_BLE_CONNECTIONS)
 
 // Number of L2CAP channels (Classic HID needs Control + Interrupt + SDP per device)
 #define MAX_NR_L2CAP_CHANNELS 8
@@ -86,13 +92,13 @@
 #define MAX_NR_L2CAP_SERVICES 3
 
 // Number of GATT clients (for BLE devices)
-#define MAX_NR_GATT_CLIENTS 1
+#define MAX_NR_GATT_CLIENTS BTSTACK_MAX_BLE_CONNECTIONS
 
 // Number of whitelist entries
-#define MAX_NR_WHITELIST_ENTRIES 2
+#define MAX_NR_WHITELIST_ENTRIES BTSTACK_MAX_BLE_CONNECTIONS
 
 // LE Device DB entries (for bonding storage)
-#define MAX_NR_LE_DEVICE_DB_ENTRIES 2
+#define MAX_NR_LE_DEVICE_DB_ENTRIES BTSTACK_MAX_BLE_CONNECTIONS
 
 // Link keys storage (Classic BT)
 #define NVM_NUM_LINK_KEYS 2
@@ -7,6 +7,7 @@
 
 #include "btstack_host.h"
 #include "btstack_config.h"
+#include "ble_conn_params.h"
 // Include specific BTstack headers instead of umbrella btstack.h
 // (btstack.h pulls in audio codecs which need sbc_encoder.h)
 #include "btstack_defines.h"
@@ -56,9 +57,12 @@ extern void bt_on_disconnect(uint8_t conn_index);
 extern void bt_on_hid_report(uint8_t conn_index, const uint8_t* data, uint16_t len);
 extern void bthid_update_device_info(uint8_t conn_index, const char* name,
                                       uint16_t vendor_id, uint16_t product_id);
+extern const ble_conn_params_t* bthid_conn_params_for(const char* name, uint16_t vendor_id,
+                                                      uint16_t product_id);
 
 #include <stdio.h>
 #include <string.h>
+#include "pico/time.h"
 
 // For rumble feedback passthrough
 // Note: manager.h includes tusb.h which conflicts with BTstack, so forward declare
@@ -69,12 +73,6 @@ extern int find_player_index(int dev_addr, int instance);
 // BLE HID REPORT ROUTING
 // ============================================================================
 
-// Deferred processing to avoid stack overflow in BTstack callback
-static uint8_t pending_ble_report[64];  // 64 bytes for Switch 2 reports
-static uint16_t pending_ble_report_len = 0;
-static uint8_t pending_ble_conn_index = 0;
-static volatile bool ble_report_pending = false;
-
 // Forward declare the function to route BLE reports through bthid layer
 static void route_ble_hid_report(uint8_t conn_index, const uint8_t* data, uint16_t len);
 
@@ -86,9 +84,15 @@ static void switch2_handle_feedback(void);
 // CONFIGURATION
 // ============================================================================
 
-#define MAX_BLE_CONNECTIONS 2
-#define SCAN_INTERVAL 0x00A0  // 100ms
-#define SCAN_WINDOW   0x0050  // 50ms
+#define MAX_BLE_CONNECTIONS BTSTACK_MAX_BLE_CONNECTIONS
+
+// Scan and connection-setup scan timing, 0.625ms units (window <= interval)
+#ifndef BLE_SCAN_INTERVAL
+#define BLE_SCAN_INTERVAL 0x00A0  // 100ms
+#endif
+#ifndef BLE_SCAN_WINDOW
+#define BLE_SCAN_WINDOW   0x0050  // 50ms
+#endif
 
 // ============================================================================
 // STATE
@@ -125,6 +129,25 @@ typedef struct {
     // Connection index for bthid layer (offset by MAX_CLASSIC_CONNECTIONS)
     uint8_t conn_index;
     bool hid_ready;
+
+    // Link parameters (ble_conn_params.h)
+    const ble_conn_params_t* driver_params;  // Matched bthid driver's, NULL = default
+    uint16_t conn_interval;         // 1.25ms units
+    uint16_t conn_latency;
+    uint16_t supervision_timeout;   // 10ms units
+    bool params_requested;          // Update sent after security came up
+    ble_report_timing_t report_timing;
+    bool log_timing;
+
+    // Fast-path report listener (Xbox, Switch 2)
+    gatt_client_notification_t hid_listener;
+    gatt_client_characteristic_t hid_characteristic;
+
+    // Deferred report, processed from the main loop to avoid stack overflow
+    // in the BTstack callback. One per link so links don't overwrite each other.
+    uint8_t pending_report[64];     // 64 bytes for Switch 2 reports
+    uint16_t pending_report_len;
+    volatile bool report_pending;
 } ble_connection_t;
 
 // BLE conn_index offset (BLE devices use conn_index >= this value)
@@ -190,14 +213,9 @@ static uint8_t hid_descriptor_storage[512];
 static btstack_packet_callback_registration_t hci_event_callback_registration;
 static btstack_packet_callback_registration_t sm_event_callback_registration;
 
-// Direct notification listener for Xbox HID reports (bypasses HIDS client)
-static gatt_client_notification_t xbox_hid_notification_listener;
-static gatt_client_characteristic_t xbox_hid_characteristic;  // Fake characteristic for listener
+// Direct notification listeners for Xbox and Switch 2 HID reports (bypass HIDS client)
+// Listener state lives in ble_connection_t so each link keeps its own
 static void xbox_hid_notification_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
-
-// Direct notification listener for Switch 2 HID reports
-static gatt_client_notification_t switch2_hid_notification_listener;
-static gatt_client_characteristic_t switch2_hid_characteristic;
 static void switch2_hid_notification_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
 
 // ============================================================================
@@ -324,6 +342,54 @@ static void start_hids_client(ble_connection_t *conn);
 static void register_ble_hid_listener(hci_con_handle_t con_handle);
 static void register_switch2_hid_listener(hci_con_handle_t con_handle);
 
+// ============================================================================
+// BLE LINK PARAMETERS AND REPORT TIMING
+// ============================================================================
+
+static void log_conn_params(const char* what, const ble_connection_t* conn)
+{
+    uint32_t us = ble_conn_interval_us(conn->conn_interval);
+    printf("[BTSTACK_HOST] %s: handle=0x%04X interval=%lu.%02lums latency=%d timeout=%dms\n",
+           what, conn->handle, (unsigned long)(us / 1000), (unsigned long)(us % 1000 / 10),
+           conn->conn_latency, conn->supervision_timeout * 10);
+}
+
+// Ask for the driver's parameters once security is up. The connection was
+// created with them, but peripherals often renegotiate during pairing.
+static void request_ble_conn_params(ble_connection_t* conn)
+{
+    if (conn->params_requested) return;
+    conn->params_requested = true;
+
+    ble_conn_params_t want = ble_conn_params_for(conn->driver_params);
+    if (ble_conn_params_satisfied(&want, conn->conn_interval, conn->conn_latency)) return;
+
+    printf("[BTSTACK_HOST] Requesting conn params: interval=%d-%d latency=%d timeout=%d\n",
+           want.interval_min, want.interval_max, want.latency, want.supervision_timeout);
+    gap_update_connection_parameters(conn->handle, want.interval_min, want.interval_max,
+                                     want.latency, want.supervision_timeout);
+}
+
+// Count a report towards the link's timing, flag a one-time log
+static void track_ble_report(ble_connection_t* conn)
+{
+    if (ble_report_timing_add(&conn->report_timing, time_us_32())) {
+        conn->log_timing = true;
+    }
+}
+
+// Defer a notification to the main loop (avoids stack overflow in BTstack callback)
+static void defer_ble_report(hci_con_handle_t con_handle, const uint8_t* data, uint16_t len)
+{
+    ble_connection_t* conn = find_connection_by_handle(con_handle);
+    if (!conn || len > sizeof(conn->pending_report)) return;
+
+    memcpy(conn->pending_report, data, len);
+    conn->pending_report_len = len;
+    conn->report_pending = true;
+    track_ble_report(conn);
+}
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -504,7 +570,10 @@ void btstack_host_start_scan(void)
     }
 
     printf("[BTSTACK_HOST] Starting BLE scan...\n");
-    gap_set_scan_params(1, SCAN_INTERVAL, SCAN_WINDOW, 0);
+    uint16_t scan_interval = BLE_SCAN_INTERVAL;
+    uint16_t scan_window = BLE_SCAN_WINDOW;
+    ble_scan_params_sanitize(&scan_interval, &scan_window);
+    gap_set_scan_params(1, scan_interval, scan_window, 0);
     gap_start_scan();
     hid_state.scan_active = true;
     hid_state.state = BLE_STATE_SCANNING;
@@ -548,6 +617,17 @@ void btstack_host_connect_ble(bd_addr_t addr, bd_addr_type_t addr_type)
     hid_state.pending_addr_type = addr_type;
     hid_state.state = BLE_STATE_CONNECTING;
 
+    // Create the link with the matching driver's parameters instead of BTstack's
+    // defaults (10-30ms interval, latency 4)
+    uint16_t scan_interval = BLE_SCAN_INTERVAL;
+    uint16_t scan_window = BLE_SCAN_WINDOW;
+    ble_scan_params_sanitize(&scan_interval, &scan_window);
+    ble_conn_params_t params = ble_conn_params_for(
+        bthid_conn_params_for(hid_state.pending_name, hid_state.pending_vid, hid_state.pending_pid));
+    gap_set_connection_parameters(scan_interval, scan_window,
+                                  params.interval_min, params.interval_max,
+                                  params.latency, params.supervision_timeout, 0, 0);
+
     // Create connection
     uint8_t status = gap_connect(addr, addr_type);
     printf("[BTSTACK_HOST] gap_connect returned status=%d\n", status);
@@ -592,10 +672,21 @@ void btstack_host_process(void)
     }
 #endif
 
-    // Process any pending BLE HID report (deferred from BTstack callback to avoid stack overflow)
-    if (ble_report_pending) {
-        ble_report_pending = false;
-        route_ble_hid_report(pending_ble_conn_index, pending_ble_report, pending_ble_report_len);
+    // Process pending BLE HID reports (deferred from BTstack callback to avoid stack overflow)
+    for (int i = 0; i < MAX_BLE_CONNECTIONS; i++) {
+        ble_connection_t* conn = &hid_state.connections[i];
+        if (conn->report_pending) {
+            conn->report_pending = false;
+            route_ble_hid_report(BLE_CONN_INDEX_OFFSET + i, conn->pending_report, conn->pending_report_len);
+        }
+        if (conn->log_timing) {
+            conn->log_timing = false;
+            const ble_report_timing_t* t = &conn->report_timing;
+            log_conn_params("BLE link", conn);
+            printf("[BTSTACK_HOST] BLE conn %d reports: avg=%luus min=%luus max=%luus (%lu reports)\n",
+                   BLE_CONN_INDEX_OFFSET + i, (unsigned long)t->avg_us, (unsigned long)t->min_us,
+                   (unsigned long)t->max_us, (unsigned long)t->reports);
+        }
     }
 
     // Retry Switch 2 init if stuck (no ACK received)
@@ -1003,13 +1094,21 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
                         conn->is_switch2 = hid_state.pending_is_switch2;
                         conn->vid = hid_state.pending_vid;
                         conn->pid = hid_state.pending_pid;
+                        conn->driver_params = bthid_conn_params_for(conn->name, conn->vid, conn->pid);
+                        conn->conn_interval = hci_subevent_le_connection_complete_get_conn_interval(packet);
+                        conn->conn_latency = hci_subevent_le_connection_complete_get_conn_latency(packet);
+                        conn->supervision_timeout = hci_subevent_le_connection_complete_get_supervision_timeout(packet);
+                        conn->params_requested = false;
+                        ble_report_timing_reset(&conn->report_timing);
 
                         printf("[BTSTACK_HOST] Connection stored: name='%s' switch2=%d vid=0x%04X pid=0x%04X\n",
                                conn->name, conn->is_switch2, conn->vid, conn->pid);
+                        log_conn_params("Link params", conn);
 
                         // Switch 2 uses custom pairing via ATT commands, not standard SM
                         if (conn->is_switch2) {
                             printf("[BTSTACK_HOST] Switch 2: Skipping SM pairing, using direct ATT setup\n");
+                            request_ble_conn_params(conn);
                             register_switch2_hid_listener(handle);
                         } else {
                             // Request pairing (SM will handle Secure Connections)
@@ -1022,9 +1121,31 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
                     break;
                 }
 
-                case HCI_SUBEVENT_LE_CONNECTION_UPDATE_COMPLETE:
-                    printf("[BTSTACK_HOST] Connection update complete\n");
+                case HCI_SUBEVENT_LE_CONNECTION_UPDATE_COMPLETE: {
+                    hci_con_handle_t handle = hci_subevent_le_connection_update_complete_get_connection_handle(packet);
+                    uint8_t status = hci_subevent_le_connection_update_complete_get_status(packet);
+                    ble_connection_t *conn = find_connection_by_handle(handle);
+                    if (status != 0 || !conn) {
+                        printf("[BTSTACK_HOST] Connection update failed: handle=0x%04X status=0x%02X\n",
+                               handle, status);
+                        break;
+                    }
+
+                    conn->conn_interval = hci_subevent_le_connection_update_complete_get_conn_interval(packet);
+                    conn->conn_latency = hci_subevent_le_connection_update_complete_get_conn_latency(packet);
+                    conn->supervision_timeout = hci_subevent_le_connection_update_complete_get_supervision_timeout(packet);
+                    log_conn_params("Connection update complete", conn);
+
+                    ble_conn_params_t want = ble_conn_params_for(conn->driver_params);
+                    if (!ble_conn_params_satisfied(&want, conn->conn_interval, conn->conn_latency)) {
+                        printf("[BTSTACK_HOST] Link slower than requested (interval %d-%d latency %d)\n",
+                               want.interval_min, want.interval_max, want.latency);
+                    }
+
+                    // Report timing restarts at the new interval
+                    ble_report_timing_reset(&conn->report_timing);
                     break;
+                }
             }
             break;
         }
@@ -1073,6 +1194,7 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packe
                 // conn_index for BLE uses BLE_CONN_INDEX_OFFSET to distinguish from Classic
                 printf("[BTSTACK_HOST] BLE disconnect: notifying bthid (conn_index=%d)\n", conn->conn_index);
                 bt_on_disconnect(conn->conn_index);
+                gatt_client_stop_listening_for_characteristic_value_updates(&conn->hid_listener);
                 memset(conn, 0, sizeof(*conn));
             }
 
@@ -1195,6 +1317,8 @@ static void sm_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *pa
                            conn->addr[5], conn->addr[4], conn->addr[3], conn->addr[2], conn->addr[1], conn->addr[0],
                            hid_state.last_connected_name);
 
+                    request_ble_conn_params(conn);
+
                     // Xbox/Switch2 controllers: use fast-path with known handles
                     // Other controllers: do proper GATT discovery
                     bool is_xbox = (strstr(conn->name, "Xbox") != NULL);
@@ -1239,6 +1363,8 @@ static void sm_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *pa
                     }
                     hid_state.has_last_connected = true;
 
+                    request_ble_conn_params(conn);
+
                     bool is_xbox = (strstr(conn->name, "Xbox") != NULL);
                     if (is_xbox) {
                         printf("[BTSTACK_HOST] Xbox detected - using fast-path HID listener\n");
@@ -1403,17 +1529,10 @@ static void ble_hid_notification_handler(uint8_t packet_type, uint16_t channel,
     }
 
     // Accept HID report notifications - filter by reasonable gamepad report length
-    if (value_length < 10 || value_length > sizeof(pending_ble_report)) return;
-
-    // Get conn_index for this BLE connection
-    int conn_index = get_ble_conn_index_by_handle(con_handle);
-    if (conn_index < 0) return;
+    if (value_length < 10) return;
 
     // Defer processing to main loop to avoid stack overflow
-    memcpy(pending_ble_report, value, value_length);
-    pending_ble_report_len = value_length;
-    pending_ble_conn_index = (uint8_t)conn_index;
-    ble_report_pending = true;
+    defer_ble_report(con_handle, value, value_length);
 }
 
 // Register direct listener for BLE HID notifications and notify bthid layer
@@ -1443,16 +1562,16 @@ static void register_ble_hid_listener(hci_con_handle_t con_handle)
 
     // Set up a fake characteristic structure with just the value_handle
     // Xbox BLE HID Report characteristic value handle is 0x001E
-    memset(&xbox_hid_characteristic, 0, sizeof(xbox_hid_characteristic));
-    xbox_hid_characteristic.value_handle = 0x001E;
-    xbox_hid_characteristic.end_handle = 0x001F;  // Approximate
+    memset(&conn->hid_characteristic, 0, sizeof(conn->hid_characteristic));
+    conn->hid_characteristic.value_handle = 0x001E;
+    conn->hid_characteristic.end_handle = 0x001F;  // Approximate
 
     // Register to listen for notifications on the HID report characteristic
     gatt_client_listen_for_characteristic_value_updates(
-        &xbox_hid_notification_listener,
+        &conn->hid_listener,
         ble_hid_notification_handler,
         con_handle,
-        &xbox_hid_characteristic);
+        &conn->hid_characteristic);
 
     printf("[BTSTACK_HOST] BLE HID listener registered, conn_index=%d\n", conn->conn_index);
 
@@ -1528,17 +1647,10 @@ static void switch2_hid_notification_handler(uint8_t packet_type, uint16_t chann
 
     // Switch 2 input reports are 64 bytes on handle 0x000A
     if (value_handle != SW2_INPUT_REPORT_HANDLE) return;
-    if (value_length < 16 || value_length > sizeof(pending_ble_report)) return;
-
-    // Get conn_index for this BLE connection
-    int conn_index = get_ble_conn_index_by_handle(con_handle);
-    if (conn_index < 0) return;
+    if (value_length < 16) return;
 
     // Defer processing to main loop to avoid stack overflow
-    memcpy(pending_ble_report, value, value_length);
-    pending_ble_report_len = value_length;
-    pending_ble_conn_index = (uint8_t)conn_index;
-    ble_report_pending = true;
+    defer_ble_report(con_handle, value, value_length);
 }
 
 // Forward declarations for Switch 2
@@ -2069,15 +2181,15 @@ static void register_switch2_hid_listener(hci_con_handle_t con_handle)
         &switch2_ack_characteristic);
 
     // Set up input report notification listener (handle 0x000A)
-    memset(&switch2_hid_characteristic, 0, sizeof(switch2_hid_characteristic));
-    switch2_hid_characteristic.value_handle = SW2_INPUT_REPORT_HANDLE;
-    switch2_hid_characteristic.end_handle = SW2_INPUT_REPORT_HANDLE + 1;
+    memset(&conn->hid_characteristic, 0, sizeof(conn->hid_characteristic));
+    conn->hid_characteristic.value_handle = SW2_INPUT_REPORT_HANDLE;
+    conn->hid_characteristic.end_handle = SW2_INPUT_REPORT_HANDLE + 1;
 
     gatt_client_listen_for_characteristic_value_updates(
-        &switch2_hid_notification_listener,
+        &conn->hid_listener,
         switch2_hid_notification_handler,
         con_handle,
-        &switch2_hid_characteristic);
+        &conn->hid_characteristic);
 
     printf("[SW2_BLE] Notification listeners registered\n");
 
@@ -2159,6 +2271,7 @@ static void hids_client_handler(uint8_t packet_type, uint16_t channel, uint8_t *
             // Route BLE HID report through bthid layer
             int conn_index = get_ble_conn_index_by_handle(hid_state.gatt_handle);
             if (conn_index >= 0) {
+                track_ble_report(&hid_state.connections[conn_index - BLE_CONN_INDEX_OFFSET]);
                 route_ble_hid_report(conn_index, report, report_len);
             }
 
@@ -2501,6 +2614,27 @@ uint8_t btstack_classic_get_connection_count(void)
     return count;
 }
 
+// ============================================================================
+// BLE LINK INFO
+// ============================================================================
+
+bool btstack_host_get_ble_link_info(uint8_t conn_index, btstack_ble_link_info_t* info)
+{
+    if (!info) return false;
+
+    ble_connection_t* conn = find_ble_connection_by_conn_index(conn_index);
+    if (!conn) return false;
+
+    info->conn_interval = conn->conn_interval;
+    info->conn_latency = conn->conn_latency;
+    info->supervision_timeout = conn->supervision_timeout;
+    info->report_interval_us = conn->report_timing.avg_us;
+    info->report_interval_min_us = conn->report_timing.min_us;
+    info->report_interval_max_us = conn->report_timing.max_us;
+    info->reports = conn->report_timing.reports;
+    return true;
+}
+
 // ============================================================================
 // BOND MANAGEMENT
 // ============================================================================
@@ -98,6 +98,23 @@ bool btstack_classic_send_set_report(uint8_t conn_index, uint8_t report_id,
 bool btstack_classic_send_report(uint8_t conn_index, uint8_t report_id,
                                   const uint8_t* data, uint16_t len);
 
+// ============================================================================
+// BLE LINK INFO
+// ============================================================================
+
+typedef struct {
+    uint16_t conn_interval;         // 1.25ms units
+    uint16_t conn_latency;          // Connection events the device may skip
+    uint16_t supervision_timeout;   // 10ms units
+    uint32_t report_interval_us;    // Average gap between reports (0 until measured)
+    uint32_t report_interval_min_us;
+    uint32_t report_interval_max_us;
+    uint32_t reports;
+} btstack_ble_link_info_t;
+
+// Negotiated parameters and measured report timing for a BLE conn_index
+bool btstack_host_get_ble_link_info(uint8_t conn_index, btstack_ble_link_info_t* info);
+
 // ============================================================================
 // BOND MANAGEMENT
 // ============================================================================
@@ -12,10 +12,10 @@
 // CONSTANTS
 // ============================================================================
 
-// 4 Classic + 2 BLE connections (BLE uses conn_index 4-5)
+// 4 Classic + 4 BLE connections (BLE uses conn_index 4-7, see BTSTACK_MAX_BLE_CONNECTIONS)
 // Apps can override this by defining BT_MAX_CONNECTIONS in app.h before including this header
 #ifndef BT_MAX_CONNECTIONS
-#define BT_MAX_CONNECTIONS      6
+#define BT_MAX_CONNECTIONS      8
 #endif
 #define BT_MAX_NAME_LEN         32
 
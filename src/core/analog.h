@@ -0,0 +1,90 @@
+// analog.h
+// Fixed-point analog helpers for the input/output hot paths
+//
+// The RP2040 has no FPU, so every float multiply is a soft-float call.
+// Analog scale factors are stored as unsigned Q1.15 (1.0 = 32768) and
+// applied with integer multiplies and shifts. Results truncate toward zero
+// like the float code they replace.
+#ifndef ANALOG_H
+#define ANALOG_H
+
+#include <stdint.h>
+
+// ============================================================================
+// SCALE FACTORS (Q1.15)
+// ============================================================================
+
+typedef uint16_t analog_scale_t;
+
+#define ANALOG_SCALE_SHIFT  15
+#define ANALOG_SCALE_ONE    ((analog_scale_t)(1u << ANALOG_SCALE_SHIFT))
+
+// Largest representable scale, 65535 / 32768 (just under 2.0)
+#define ANALOG_SCALE_MAX    ((analog_scale_t)0xFFFF)
+
+// Convert a float constant to Q1.15 at compile time. Range is 0.0 to just
+// under 2.0; larger values saturate to ANALOG_SCALE_MAX instead of wrapping.
+// Rounds up so rel * scale truncates the same way rel * (float)f does.
+#define ANALOG_SCALE_RAW(f) ((double)(f) * (double)ANALOG_SCALE_ONE + 0.999999)
+#define ANALOG_SCALE(f) \
+    (ANALOG_SCALE_RAW(f) >= (double)ANALOG_SCALE_MAX + 1.0 \
+        ? ANALOG_SCALE_MAX : (analog_scale_t)ANALOG_SCALE_RAW(f))
+
+// ============================================================================
+// CLAMPING
+// ============================================================================
+
+static inline uint8_t analog_clamp_u8(int32_t value)
+{
+    if (value < 0) return 0;
+    if (value > 255) return 255;
+    return (uint8_t)value;
+}
+
+// ============================================================================
+// SCALING
+// ============================================================================
+
+// Scale a signed offset from center, truncating toward zero
+static inline int32_t analog_scale_rel(int32_t rel, analog_scale_t scale)
+{
+    if (rel >= 0) {
+        return (int32_t)(((uint32_t)rel * scale) >> ANALOG_SCALE_SHIFT);
+    }
+    return -(int32_t)(((uint32_t)-rel * scale) >> ANALOG_SCALE_SHIFT);
+}
+
+// Scale an axis toward/away from center, clamped to 0-255
+static inline uint8_t analog_scale_center(uint8_t value, analog_scale_t scale, uint8_t center)
+{
+    int32_t rel = (int32_t)value - (int32_t)center;
+    return analog_clamp_u8((int32_t)center + analog_scale_rel(rel, scale));
+}
+
+// Scale an axis around the standard 128 center
+static inline uint8_t analog_scale_stick(uint8_t value, analog_scale_t scale)
+{
+    return analog_scale_center(value, scale, 128);
+}
+
+// value * fraction / 255 (e.g. "fraction of full range" trigger math)
+static inline uint8_t analog_scale_by_u8(uint8_t value, uint8_t fraction)
+{
+    return (uint8_t)(((uint32_t)value * fraction) / 255u);
+}
+
+// ============================================================================
+// DEADZONE
+// ============================================================================
+
+// Snap to center when within radius of 128 (exclusive)
+static inline uint8_t analog_deadzone(uint8_t value, uint8_t radius)
+{
+    int32_t rel = (int32_t)value - 128;
+    if (rel > -(int32_t)radius && rel < (int32_t)radius) {
+        return 128;
+    }
+    return value;
+}
+
+#endif // ANALOG_H
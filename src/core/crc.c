@@ -0,0 +1,152 @@
+// crc.c - Table-driven CRCs shared across the firmware
+//
+// Tables are generated by the preprocessor: each entry expands the
+// polynomial's eight shift/xor steps, so the compiler folds them to
+// constants and nothing runs at boot.
+
+#include "core/crc.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+#if CRC_USE_DMA_SNIFFER
+#include "hardware/dma.h"
+#endif
+
+// ============================================================================
+// TABLES
+// ============================================================================
+
+#define CRC8_STEP(c)    ((uint8_t)(((c) << 1) ^ (((c) & 0x80) ? 0x07 : 0)))
+#define CRC8_ENTRY(i)   CRC8_STEP(CRC8_STEP(CRC8_STEP(CRC8_STEP( \
+                        CRC8_STEP(CRC8_STEP(CRC8_STEP(CRC8_STEP((uint8_t)(i)))))))))
+
+#define CRC16_STEP(c)   ((uint16_t)(((c) << 1) ^ (((c) & 0x8000) ? 0x8005 : 0)))
+#define CRC16_ENTRY(i)  CRC16_STEP(CRC16_STEP(CRC16_STEP(CRC16_STEP( \
+                        CRC16_STEP(CRC16_STEP(CRC16_STEP(CRC16_STEP((uint16_t)((i) << 8)))))))))
+
+#define CRC32_STEP(c)   (((c) >> 1) ^ (((c) & 1) ? 0xEDB88320u : 0))
+#define CRC32_ENTRY(i)  CRC32_STEP(CRC32_STEP(CRC32_STEP(CRC32_STEP( \
+                        CRC32_STEP(CRC32_STEP(CRC32_STEP(CRC32_STEP((uint32_t)(i)))))))))
+
+#define CRC_ROW(E, r) \
+    E((r) + 0x0), E((r) + 0x1), E((r) + 0x2), E((r) + 0x3), \
+    E((r) + 0x4), E((r) + 0x5), E((r) + 0x6), E((r) + 0x7), \
+    E((r) + 0x8), E((r) + 0x9), E((r) + 0xA), E((r) + 0xB), \
+    E((r) + 0xC), E((r) + 0xD), E((r) + 0xE), E((r) + 0xF)
+
+#define CRC_TABLE(E) \
+    CRC_ROW(E, 0x00), CRC_ROW(E, 0x10), CRC_ROW(E, 0x20), CRC_ROW(E, 0x30), \
+    CRC_ROW(E, 0x40), CRC_ROW(E, 0x50), CRC_ROW(E, 0x60), CRC_ROW(E, 0x70), \
+    CRC_ROW(E, 0x80), CRC_ROW(E, 0x90), CRC_ROW(E, 0xA0), CRC_ROW(E, 0xB0), \
+    CRC_ROW(E, 0xC0), CRC_ROW(E, 0xD0), CRC_ROW(E, 0xE0), CRC_ROW(E, 0xF0)
+
+// SRAM copies: lookups in per-byte loops never wait on XIP cache misses
+const uint8_t __not_in_flash("crc") crc8_table[256] = { CRC_TABLE(CRC8_ENTRY) };
+const uint16_t __not_in_flash("crc") crc16_table[256] = { CRC_TABLE(CRC16_ENTRY) };
+const uint32_t __not_in_flash("crc") crc32_table[256] = { CRC_TABLE(CRC32_ENTRY) };
+
+// ============================================================================
+// CRC-8
+// ============================================================================
+
+uint8_t __not_in_flash_func(crc8_calc)(const uint8_t* data, size_t len)
+{
+    uint8_t crc = 0;
+    while (len--) {
+        crc = crc8_table[crc ^ *data++];
+    }
+    return crc;
+}
+
+// ============================================================================
+// CRC-32
+// ============================================================================
+
+uint32_t __not_in_flash_func(crc32_raw_table)(uint32_t crc, const uint8_t* data, size_t len)
+{
+    while (len--) {
+        crc = crc32_table[(uint8_t)(crc ^ *data++)] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if CRC_USE_DMA_SNIFFER
+
+static int sniff_channel = -1;
+static bool sniff_claimed = false;
+static uint32_t sniff_sink;
+
+static uint32_t bitrev32(uint32_t v)
+{
+    v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    v = ((v >> 4) & 0x0F0F0F0Fu) | ((v & 0x0F0F0F0Fu) << 4);
+    v = ((v >> 8) & 0x00FF00FFu) | ((v & 0x00FF00FFu) << 8);
+    return (v >> 16) | (v << 16);
+}
+
+// The sniffer's CRC32R mode shifts each word in LSB-first, which for
+// little-endian words is exactly the byte order the reflected CRC expects.
+// That lets the aligned middle of the buffer go through as 32-bit transfers
+// (a quarter of the bus cycles); the unaligned head and tail use the table.
+// Accumulator is MSB-first: seed it bit-reversed and read it back reversed.
+uint32_t crc32_raw_dma(uint32_t crc, const uint8_t* data, size_t len)
+{
+    if (get_core_num() != 0) {
+        return crc32_raw_table(crc, data, len);
+    }
+
+    if (!sniff_claimed) {
+        sniff_claimed = true;
+        sniff_channel = dma_claim_unused_channel(false);
+        if (sniff_channel < 0) {
+            printf("[crc] No DMA channel for sniffer, using table\n");
+        }
+    }
+    if (sniff_channel < 0) {
+        return crc32_raw_table(crc, data, len);
+    }
+
+    size_t head = (size_t)(-(uintptr_t)data & 3u);
+    if (head > len) head = len;
+    crc = crc32_raw_table(crc, data, head);
+    data += head;
+    len -= head;
+
+    size_t words = len / 4;
+    if (words) {
+        dma_channel_config c = dma_channel_get_default_config(sniff_channel);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_sniff_enable(&c, true);
+
+        dma_sniffer_set_data_accumulator(bitrev32(crc));
+        dma_sniffer_set_output_reverse_enabled(true);
+        dma_sniffer_set_output_invert_enabled(false);
+        dma_sniffer_enable(sniff_channel, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+
+        dma_channel_configure(sniff_channel, &c, &sniff_sink, data, words, true);
+        dma_channel_wait_for_finish_blocking(sniff_channel);
+
+        crc = dma_sniffer_get_data_accumulator();
+        dma_sniffer_disable();
+
+        data += words * 4;
+        len -= words * 4;
+    }
+
+    return crc32_raw_table(crc, data, len);
+}
+
+#endif // CRC_USE_DMA_SNIFFER
+
+uint32_t crc32_raw(uint32_t crc, const uint8_t* data, size_t len)
+{
+#if CRC_USE_DMA_SNIFFER
+    if (len >= CRC_DMA_MIN_LEN) {
+        return crc32_raw_dma(crc, data, len);
+    }
+#endif
+    return crc32_raw_table(crc, data, len);
+}
@@ -0,0 +1,71 @@
+// crc.h - Table-driven CRCs shared across the firmware
+//
+//   CRC-8   poly 0x07, MSB-first, init 0           UART bridge packets
+//   CRC-16  poly 0x8005, MSB-first, init 0         Nuon polyface responses
+//   CRC-32  poly 0xEDB88320, reflected, no xorout  DS5 Bluetooth output reports
+//
+// The 256-entry tables are computed by the preprocessor from the polynomial
+// and placed in SRAM, so there is no lazy init and no flash (XIP) wait in
+// per-byte loops. The per-byte update helpers are inline for hot loops.
+//
+// CRC_USE_DMA_SNIFFER=1 lets crc32_raw() hand buffers of CRC_DMA_MIN_LEN
+// bytes or more to the RP2040 DMA sniffer (target links hardware_dma). The
+// sniffer only implements CRC-32 and CRC-16-CCITT, so CRC-8/0x07 and
+// CRC-16/0x8005 always use the tables. The sniffer is a single shared unit
+// owned by core 0; calls from core 1 use the table.
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef CRC_USE_DMA_SNIFFER
+#define CRC_USE_DMA_SNIFFER 0
+#endif
+
+// Below this the DMA setup costs more than the table loop
+#ifndef CRC_DMA_MIN_LEN
+#define CRC_DMA_MIN_LEN 64
+#endif
+
+extern const uint8_t crc8_table[256];
+extern const uint16_t crc16_table[256];
+extern const uint32_t crc32_table[256];
+
+// ============================================================================
+// CRC-8 (poly 0x07)
+// ============================================================================
+
+static inline uint8_t crc8_update(uint8_t crc, uint8_t byte)
+{
+    return crc8_table[crc ^ byte];
+}
+
+uint8_t crc8_calc(const uint8_t* data, size_t len);
+
+// ============================================================================
+// CRC-16 (poly 0x8005)
+// ============================================================================
+
+static inline uint16_t crc16_update(uint16_t crc, uint8_t byte)
+{
+    return (uint16_t)(crc16_table[(uint8_t)((crc >> 8) ^ byte)] ^ (crc << 8));
+}
+
+// ============================================================================
+// CRC-32 (reflected 0xEDB88320)
+// ============================================================================
+
+// Continue a CRC from crc (no pre/post inversion; callers apply their own)
+uint32_t crc32_raw(uint32_t crc, const uint8_t* data, size_t len);
+
+// Table-only variant, never uses the DMA sniffer
+uint32_t crc32_raw_table(uint32_t crc, const uint8_t* data, size_t len);
+
+#if CRC_USE_DMA_SNIFFER
+// DMA sniffer variant; falls back to the table if no channel is free
+uint32_t crc32_raw_dma(uint32_t crc, const uint8_t* data, size_t len);
+#endif
+
+#endif // CRC_H
@@ -96,6 +96,7 @@ typedef struct {
     int8_t instance;            // Instance number (for multi-controller devices)
     input_device_type_t type;   // Device type classification
     input_transport_t transport; // Connection type (USB, BT, native)
+    uint8_t source;             // Router input source (input_source_t), 0 = USB host
     controller_layout_t layout; // Physical button layout (for 6-button controllers)
 
     // Digital inputs
@@ -148,6 +149,48 @@ typedef struct {
     bool has_pressure;          // Pressure data is valid
 } input_event_t;
 
+// ============================================================================
+// Compact Hot-Path State (router outputs)
+// ============================================================================
+// input_event_t is what input drivers produce. Once inside the router, only
+// the fields every output needs (buttons, axes, deltas, identity) travel as
+// input_state_t. Motion, pressure and chatpad data live in input_ext_t and
+// are copied only when the matching INPUT_STATE_HAS_* flag is set.
+
+#define INPUT_STATE_HAS_MOTION          0x01    // ext.accel/gyro valid
+#define INPUT_STATE_HAS_PRESSURE        0x02    // ext.pressure valid
+#define INPUT_STATE_HAS_CHATPAD         0x04    // ext.chatpad valid
+#define INPUT_STATE_HAS_RUMBLE          0x08    // Device supports rumble
+#define INPUT_STATE_HAS_FORCE_FEEDBACK  0x10    // Device supports force feedback
+
+// Flags that mean input_ext_t carries data
+#define INPUT_STATE_EXT_MASK (INPUT_STATE_HAS_MOTION | INPUT_STATE_HAS_PRESSURE | INPUT_STATE_HAS_CHATPAD)
+
+typedef struct {
+    uint32_t buttons;           // Button bitmap (JP_BUTTON_*)
+    uint32_t keys;              // Keyboard keys (modifier + scancodes)
+    uint8_t analog[8];          // Analog axes (see analog_axis_index_t)
+    int8_t delta_x;             // Relative inputs (mouse, spinner, trackball)
+    int8_t delta_y;
+    int8_t delta_wheel;
+    uint8_t dev_addr;           // Source device address
+    int8_t instance;            // Source device instance
+    uint8_t type;               // input_device_type_t
+    uint8_t transport;          // input_transport_t
+    uint8_t layout;             // controller_layout_t
+    uint8_t button_count;       // Number of face buttons
+    uint8_t flags;              // INPUT_STATE_HAS_* flags
+} input_state_t;
+
+_Static_assert(sizeof(input_state_t) <= 32, "input_state_t must stay within half a cache line");
+
+typedef struct {
+    int16_t accel[3];           // Accelerometer X, Y, Z (INPUT_STATE_HAS_MOTION)
+    int16_t gyro[3];            // Gyroscope X, Y, Z (INPUT_STATE_HAS_MOTION)
+    uint8_t pressure[12];       // DS3 pressure bytes (INPUT_STATE_HAS_PRESSURE)
+    uint8_t chatpad[3];         // Chatpad modifier + keys (INPUT_STATE_HAS_CHATPAD)
+} input_ext_t;
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
@@ -199,6 +242,66 @@ static inline void init_input_event(input_event_t* event) {
     }
 }
 
+// Initialize compact state with the same neutral values as init_input_event()
+static inline void init_input_state(input_state_t* state) {
+    memset(state, 0, sizeof(input_state_t));
+    for (int i = 0; i < 8; i++) {
+        state->analog[i] = (i == 5 || i == 6) ? 0 : 128;
+    }
+    state->type = INPUT_TYPE_NONE;
+    state->layout = LAYOUT_MODERN_4FACE;
+    state->button_count = 4;
+}
+
+// Extract the compact hot-path state from a full input event
+static inline void input_state_from_event(input_state_t* state, const input_event_t* event) {
+    state->buttons = event->buttons;
+    state->keys = event->keys;
+    memcpy(state->analog, event->analog, sizeof(state->analog));
+    state->delta_x = event->delta_x;
+    state->delta_y = event->delta_y;
+    state->delta_wheel = event->delta_wheel;
+    state->dev_addr = event->dev_addr;
+    state->instance = event->instance;
+    state->type = (uint8_t)event->type;
+    state->transport = (uint8_t)event->transport;
+    state->layout = (uint8_t)event->layout;
+    state->button_count = event->button_count;
+    state->flags = (event->has_motion ? INPUT_STATE_HAS_MOTION : 0) |
+                   (event->has_pressure ? INPUT_STATE_HAS_PRESSURE : 0) |
+                   (event->has_chatpad ? INPUT_STATE_HAS_CHATPAD : 0) |
+                   (event->has_rumble ? INPUT_STATE_HAS_RUMBLE : 0) |
+                   (event->has_force_feedback ? INPUT_STATE_HAS_FORCE_FEEDBACK : 0);
+}
+
+// Copy only the extended blocks selected by flags (INPUT_STATE_HAS_*)
+static inline void input_ext_from_event(input_ext_t* ext, const input_event_t* event, uint8_t flags) {
+    if (flags & INPUT_STATE_HAS_MOTION) {
+        memcpy(ext->accel, event->accel, sizeof(ext->accel));
+        memcpy(ext->gyro, event->gyro, sizeof(ext->gyro));
+    }
+    if (flags & INPUT_STATE_HAS_PRESSURE) {
+        memcpy(ext->pressure, event->pressure, sizeof(ext->pressure));
+    }
+    if (flags & INPUT_STATE_HAS_CHATPAD) {
+        memcpy(ext->chatpad, event->chatpad, sizeof(ext->chatpad));
+    }
+}
+
+// Copy extended blocks between two ext buffers (only those flagged)
+static inline void input_ext_copy(input_ext_t* dst, const input_ext_t* src, uint8_t flags) {
+    if (flags & INPUT_STATE_HAS_MOTION) {
+        memcpy(dst->accel, src->accel, sizeof(dst->accel));
+        memcpy(dst->gyro, src->gyro, sizeof(dst->gyro));
+    }
+    if (flags & INPUT_STATE_HAS_PRESSURE) {
+        memcpy(dst->pressure, src->pressure, sizeof(dst->pressure));
+    }
+    if (flags & INPUT_STATE_HAS_CHATPAD) {
+        memcpy(dst->chatpad, src->chatpad, sizeof(dst->chatpad));
+    }
+}
+
 // Convert old post_globals() parameters to input_event_t (for migration)
 static inline void gamepad_to_input_event(
     input_event_t* event,
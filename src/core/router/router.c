@@ -6,6 +6,7 @@
 
 #include "router.h"
 #include "core/services/players/manager.h"
+#include "hardware/sync.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -44,6 +45,24 @@ static inline bool analog_beyond_threshold(const input_event_t* event) {
 // Each output has up to MAX_PLAYERS_PER_OUTPUT player slots
 static output_state_t router_outputs[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
 
+// Seqlock write side (core 0 only). Readers retry while seq is odd or changed.
+static inline void router_write_begin(output_state_t* os) {
+    os->seq = os->seq + 1;
+    __dmb();
+}
+
+static inline void router_write_end(output_state_t* os) {
+    __dmb();
+    os->seq = os->seq + 1;
+}
+
+// Fold this report's relative motion into the running totals so reports
+// arriving between two console polls are summed instead of overwritten
+static inline void router_accumulate_deltas(output_state_t* os) {
+    os->delta_total_x += (uint32_t)(int32_t)os->current_state.delta_x;
+    os->delta_total_y += (uint32_t)(int32_t)os->current_state.delta_y;
+}
+
 // Router configuration (set at init)
 static router_config_t router_config;
 
@@ -62,20 +81,46 @@ static mouse_accumulator_t mouse_accumulators[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPU
 static instance_merge_t instance_merges[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
 
 // ============================================================================
-// MERGE_BLEND STATE - Per-device input tracking for proper blending
+// MERGE_BLEND STATE - Incremental blend engine
 // ============================================================================
+// Each output keeps a compact copy of every contributing device plus the
+// running reductions (button/key OR, per-axis winner, motion/pressure owner).
+// A report only updates its own device's deltas against those reductions;
+// a full re-blend happens only when a winner backs off or a device leaves.
 
 #define MAX_BLEND_DEVICES 8  // Max devices to track for blending
+#define BLEND_NONE (-1)      // No device owns this reduction
 
 typedef struct {
     uint8_t dev_addr;
     int8_t instance;
     bool active;
-    input_event_t state;
+    uint8_t type;               // input_device_type_t
+    uint32_t buttons;
+    uint32_t keys;
+    uint8_t analog[8];
+    bool has_motion;
+    bool has_pressure;
+    int16_t accel[3];
+    int16_t gyro[3];
+    uint8_t pressure[12];
 } blend_device_state_t;
 
+typedef struct {
+    blend_device_state_t devices[MAX_BLEND_DEVICES];
+    int8_t axis_winner[8];      // Slot whose value is output per axis
+    int8_t motion_owner;        // First slot with motion data
+    int8_t pressure_owner;      // First slot with pressure data
+    int8_t first_slot;          // Lowest active slot (supplies metadata)
+} blend_state_t;
+
 // Per-output blend state (tracks each device's contribution)
-static blend_device_state_t blend_devices[MAX_OUTPUTS][MAX_BLEND_DEVICES];
+static blend_state_t blend_states[MAX_OUTPUTS];
+
+// Blended axes: sticks (0-3) use furthest from center, triggers (5-6) use max
+static const uint8_t blend_axes[] = {
+    ANALOG_X, ANALOG_Y, ANALOG_Z, ANALOG_RX, ANALOG_RZ, ANALOG_SLIDER,
+};
 
 // ============================================================================
 // ROUTING TABLE (Phase 6)
@@ -85,12 +130,340 @@ static blend_device_state_t blend_devices[MAX_OUTPUTS][MAX_BLEND_DEVICES];
 static route_entry_t routing_table[MAX_ROUTES];
 static uint8_t route_count = 0;
 
+// ============================================================================
+// COMPILED ROUTE INDEX
+// ============================================================================
+// The routing table is compiled into a flat lookup structure whenever it
+// changes (add/remove/clear), so per-event routing cost is O(matches)
+// instead of a scan over all MAX_ROUTES entries.
+//
+// Active routes are bucketed by (input source, dev_addr filter):
+//   group 0        = dev_addr wildcard (0)
+//   group 1..N     = dev_addr hashed into ROUTE_DEV_BUCKETS
+// route_order[] holds route indices grouped by bucket (table order is
+// preserved inside each bucket), route_group_start[] gives bucket bounds.
+
+#define INPUT_SOURCE_COUNT (INPUT_SOURCE_UART + 1)
+#define ROUTE_DEV_BUCKETS 8     // Must be a power of 2
+#define ROUTE_GROUPS (1 + ROUTE_DEV_BUCKETS)
+
+static uint8_t route_order[MAX_ROUTES];
+static uint8_t route_group_start[INPUT_SOURCE_COUNT * ROUTE_GROUPS + 1];
+static uint8_t route_active_count = 0;
+
+// First active route's output (OUTPUT_TARGET_NONE if no active routes)
+static output_target_t route_primary_output = OUTPUT_TARGET_NONE;
+
+static inline uint8_t route_group(input_source_t input, uint8_t dev_addr) {
+    uint8_t bucket = dev_addr ? (uint8_t)(1 + (dev_addr & (ROUTE_DEV_BUCKETS - 1))) : 0;
+    return (uint8_t)(input * ROUTE_GROUPS + bucket);
+}
+
+// Rebuild route index from routing_table (called only on table changes)
+static void router_rebuild_index(void) {
+    uint8_t counts[INPUT_SOURCE_COUNT * ROUTE_GROUPS] = {0};
+
+    route_primary_output = OUTPUT_TARGET_NONE;
+    route_active_count = 0;
+
+    // Count routes per group
+    for (uint8_t i = 0; i < MAX_ROUTES; i++) {
+        const route_entry_t* route = &routing_table[i];
+        if (!route->active) continue;
+
+        if (route_primary_output == OUTPUT_TARGET_NONE) {
+            route_primary_output = route->output;
+        }
+        route_active_count++;
+
+        if ((unsigned)route->input >= INPUT_SOURCE_COUNT) continue;
+        counts[route_group(route->input, route->input_dev_addr)]++;
+    }
+
+    // Prefix sums give each group's start offset
+    uint8_t offset = 0;
+    for (uint8_t g = 0; g < INPUT_SOURCE_COUNT * ROUTE_GROUPS; g++) {
+        route_group_start[g] = offset;
+        offset += counts[g];
+        counts[g] = route_group_start[g];  // Reuse as fill cursor
+    }
+    route_group_start[INPUT_SOURCE_COUNT * ROUTE_GROUPS] = offset;
+
+    // Stable fill (table order preserved within each group)
+    for (uint8_t i = 0; i < MAX_ROUTES; i++) {
+        const route_entry_t* route = &routing_table[i];
+        if (!route->active || (unsigned)route->input >= INPUT_SOURCE_COUNT) continue;
+        route_order[counts[route_group(route->input, route->input_dev_addr)]++] = i;
+    }
+}
+
+// Resolve the routing table source for an event (set by the submitter)
+static inline input_source_t router_event_source(const input_event_t* event) {
+    return event->source < INPUT_SOURCE_COUNT ? (input_source_t)event->source
+                                              : INPUT_SOURCE_USB_HOST;
+}
+
+// Output used when no route matches (first active route, USB device fallback)
+static inline output_target_t router_default_output(void) {
+    return route_primary_output != OUTPUT_TARGET_NONE ? route_primary_output
+                                                      : OUTPUT_TARGET_USB_DEVICE;
+}
+
 // ============================================================================
 // OUTPUT TAPS (Push-based notification)
 // ============================================================================
 
 static router_tap_callback_t output_taps[MAX_OUTPUTS] = {NULL};
 
+// ============================================================================
+// MERGE_BLEND ENGINE
+// ============================================================================
+
+// Blend weight of an axis value: distance from center for sticks, raw value
+// for triggers. A device only wins an axis with a non-zero weight.
+static inline uint8_t blend_axis_weight(uint8_t axis, uint8_t value) {
+    if (axis >= ANALOG_RZ) return value;
+    int8_t delta = (int8_t)(value - 128);
+    return (uint8_t)(delta < 0 ? -delta : delta);
+}
+
+static inline uint8_t blend_axis_default(uint8_t axis) {
+    return (axis == ANALOG_RZ || axis == ANALOG_SLIDER) ? 0 : 128;
+}
+
+static void blend_clear_device(blend_device_state_t* dev) {
+    memset(dev, 0, sizeof(*dev));
+    dev->instance = -1;
+    for (uint8_t j = 0; j < 8; j++) {
+        dev->analog[j] = blend_axis_default(j);
+    }
+}
+
+static void blend_reset(blend_state_t* bs) {
+    for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
+        blend_clear_device(&bs->devices[i]);
+    }
+    for (uint8_t j = 0; j < 8; j++) {
+        bs->axis_winner[j] = BLEND_NONE;
+    }
+    bs->motion_owner = BLEND_NONE;
+    bs->pressure_owner = BLEND_NONE;
+    bs->first_slot = BLEND_NONE;
+}
+
+// Find slot for device, optionally claiming an empty one
+static int blend_find_slot(blend_state_t* bs, uint8_t dev_addr, int8_t instance, bool create) {
+    int empty = -1;
+    for (int i = 0; i < MAX_BLEND_DEVICES; i++) {
+        blend_device_state_t* dev = &bs->devices[i];
+        if (dev->active) {
+            if (dev->dev_addr == dev_addr && dev->instance == instance) return i;
+        } else if (empty < 0) {
+            empty = i;
+        }
+    }
+    if (!create || empty < 0) return -1;
+
+    blend_device_state_t* dev = &bs->devices[empty];
+    blend_clear_device(dev);
+    dev->active = true;
+    dev->dev_addr = dev_addr;
+    dev->instance = instance;
+    if (bs->first_slot == BLEND_NONE || empty < bs->first_slot) {
+        bs->first_slot = (int8_t)empty;
+    }
+    return empty;
+}
+
+static void blend_rescan_buttons(const blend_state_t* bs, input_state_t* out) {
+    uint32_t buttons = 0;
+    uint32_t keys = 0;
+    for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
+        if (!bs->devices[i].active) continue;
+        buttons |= bs->devices[i].buttons;
+        keys |= bs->devices[i].keys;
+    }
+    out->buttons = buttons;
+    out->keys = keys;
+}
+
+// Winner = first slot with the highest non-zero weight
+static void blend_rescan_axis(blend_state_t* bs, uint8_t axis, input_state_t* out) {
+    int8_t winner = BLEND_NONE;
+    uint8_t best = 0;
+    for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
+        if (!bs->devices[i].active) continue;
+        uint8_t weight = blend_axis_weight(axis, bs->devices[i].analog[axis]);
+        if (weight > best) {
+            best = weight;
+            winner = (int8_t)i;
+        }
+    }
+    bs->axis_winner[axis] = winner;
+    out->analog[axis] = (winner == BLEND_NONE) ? blend_axis_default(axis)
+                                               : bs->devices[winner].analog[axis];
+}
+
+static void blend_rescan_motion(blend_state_t* bs, output_state_t* os) {
+    bs->motion_owner = BLEND_NONE;
+    for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
+        if (bs->devices[i].active && bs->devices[i].has_motion) {
+            bs->motion_owner = (int8_t)i;
+            break;
+        }
+    }
+    if (bs->motion_owner == BLEND_NONE) {
+        os->current_state.flags &= ~INPUT_STATE_HAS_MOTION;
+        memset(os->ext.accel, 0, sizeof(os->ext.accel));
+        memset(os->ext.gyro, 0, sizeof(os->ext.gyro));
+    } else {
+        const blend_device_state_t* dev = &bs->devices[bs->motion_owner];
+        os->current_state.flags |= INPUT_STATE_HAS_MOTION;
+        memcpy(os->ext.accel, dev->accel, sizeof(os->ext.accel));
+        memcpy(os->ext.gyro, dev->gyro, sizeof(os->ext.gyro));
+    }
+}
+
+static void blend_rescan_pressure(blend_state_t* bs, output_state_t* os) {
+    bs->pressure_owner = BLEND_NONE;
+    for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
+        if (bs->devices[i].active && bs->devices[i].has_pressure) {
+            bs->pressure_owner = (int8_t)i;
+            break;
+        }
+    }
+    if (bs->pressure_owner == BLEND_NONE) {
+        os->current_state.flags &= ~INPUT_STATE_HAS_PRESSURE;
+        memset(os->ext.pressure, 0, sizeof(os->ext.pressure));
+    } else {
+        os->current_state.flags |= INPUT_STATE_HAS_PRESSURE;
+        memcpy(os->ext.pressure, bs->devices[bs->pressure_owner].pressure, sizeof(os->ext.pressure));
+    }
+}
+
+static void blend_apply_metadata(const blend_state_t* bs, input_state_t* out) {
+    if (bs->first_slot == BLEND_NONE) return;
+    const blend_device_state_t* dev = &bs->devices[bs->first_slot];
+    out->dev_addr = dev->dev_addr;
+    out->instance = dev->instance;
+    out->type = dev->type;
+}
+
+// Full re-blend of all active devices (device removal, mode changes)
+static void blend_rebuild_output(blend_state_t* bs, output_state_t* os) {
+    input_state_t* out = &os->current_state;
+    init_input_state(out);
+    memset(&os->ext, 0, sizeof(os->ext));
+
+    bs->first_slot = BLEND_NONE;
+    for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
+        if (bs->devices[i].active) {
+            bs->first_slot = (int8_t)i;
+            break;
+        }
+    }
+
+    blend_rescan_buttons(bs, out);
+    for (uint8_t k = 0; k < sizeof(blend_axes); k++) {
+        blend_rescan_axis(bs, blend_axes[k], out);
+    }
+    blend_rescan_motion(bs, os);
+    blend_rescan_pressure(bs, os);
+    blend_apply_metadata(bs, out);
+}
+
+// Remove device from blend tracking (returns true if it was tracked)
+static bool blend_remove_device(blend_state_t* bs, uint8_t dev_addr, int8_t instance) {
+    int slot = blend_find_slot(bs, dev_addr, instance, false);
+    if (slot < 0) return false;
+    blend_clear_device(&bs->devices[slot]);
+    return true;
+}
+
+// Fold one device report into the blended output, touching only what changed.
+// state is the transformed hot-path view; event supplies motion/pressure data.
+static void blend_update(blend_state_t* bs, const input_state_t* state,
+                         const input_event_t* event, output_state_t* os) {
+    int slot = blend_find_slot(bs, state->dev_addr, state->instance, true);
+    if (slot < 0) return;
+
+    input_state_t* out = &os->current_state;
+    blend_device_state_t* dev = &bs->devices[slot];
+
+    // Buttons/keys: OR in new presses, re-reduce only when this device released something
+    uint32_t released = (dev->buttons & ~state->buttons) | (dev->keys & ~state->keys);
+    dev->buttons = state->buttons;
+    dev->keys = state->keys;
+    if (released) {
+        blend_rescan_buttons(bs, out);
+    } else {
+        out->buttons |= state->buttons;
+        out->keys |= state->keys;
+    }
+
+    // Axes: challenge the current winner, re-scan only if the winner backed off
+    for (uint8_t k = 0; k < sizeof(blend_axes); k++) {
+        uint8_t axis = blend_axes[k];
+        uint8_t value = state->analog[axis];
+        uint8_t old_weight = blend_axis_weight(axis, dev->analog[axis]);
+        if (value == dev->analog[axis]) continue;
+        dev->analog[axis] = value;
+
+        uint8_t weight = blend_axis_weight(axis, value);
+        int8_t winner = bs->axis_winner[axis];
+
+        if (winner == slot) {
+            if (weight >= old_weight) {
+                out->analog[axis] = value;
+            } else {
+                blend_rescan_axis(bs, axis, out);
+            }
+        } else {
+            uint8_t best = (winner == BLEND_NONE) ? 0 : blend_axis_weight(axis, out->analog[axis]);
+            if (weight > best || (weight == best && weight > 0 && slot < winner)) {
+                bs->axis_winner[axis] = (int8_t)slot;
+                out->analog[axis] = value;
+            }
+        }
+    }
+
+    // Motion: first device that has motion data
+    dev->has_motion = (state->flags & INPUT_STATE_HAS_MOTION) != 0;
+    if (dev->has_motion) {
+        memcpy(dev->accel, event->accel, sizeof(dev->accel));
+        memcpy(dev->gyro, event->gyro, sizeof(dev->gyro));
+        if (bs->motion_owner == BLEND_NONE || slot <= bs->motion_owner) {
+            bs->motion_owner = (int8_t)slot;
+            out->flags |= INPUT_STATE_HAS_MOTION;
+            memcpy(os->ext.accel, dev->accel, sizeof(os->ext.accel));
+            memcpy(os->ext.gyro, dev->gyro, sizeof(os->ext.gyro));
+        }
+    } else if (bs->motion_owner == slot) {
+        blend_rescan_motion(bs, os);
+    }
+
+    // Pressure: first device that has pressure data
+    dev->has_pressure = (state->flags & INPUT_STATE_HAS_PRESSURE) != 0;
+    if (dev->has_pressure) {
+        memcpy(dev->pressure, event->pressure, sizeof(dev->pressure));
+        if (bs->pressure_owner == BLEND_NONE || slot <= bs->pressure_owner) {
+            bs->pressure_owner = (int8_t)slot;
+            out->flags |= INPUT_STATE_HAS_PRESSURE;
+            memcpy(os->ext.pressure, dev->pressure, sizeof(os->ext.pressure));
+        }
+    } else if (bs->pressure_owner == slot) {
+        blend_rescan_pressure(bs, os);
+    }
+
+    // Mouse deltas: only the reporting device contributes this report's motion
+    out->delta_x = state->delta_x;
+    out->delta_y = state->delta_y;
+
+    // Metadata from first active device
+    dev->type = state->type;
+    blend_apply_metadata(bs, out);
+}
+
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
@@ -120,8 +493,9 @@ void router_init(const router_config_t* config) {
     // Initialize output states
     for (uint8_t output = 0; output < MAX_OUTPUTS; output++) {
         for (uint8_t player = 0; player < MAX_PLAYERS_PER_OUTPUT; player++) {
-            init_input_event(&router_outputs[output][player].current_state);
-            router_outputs[output][player].updated = false;
+            init_input_state(&router_outputs[output][player].current_state);
+            memset(&router_outputs[output][player].ext, 0, sizeof(input_ext_t));
+            // seq and delta totals keep running so core 1's read position stays valid
             router_outputs[output][player].player_id = player;
             router_outputs[output][player].source = INPUT_SOURCE_USB_HOST;  // Default
 
@@ -138,12 +512,7 @@ void router_init(const router_config_t* config) {
         }
 
         // Initialize blend device tracking
-        for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
-            blend_devices[output][i].active = false;
-            blend_devices[output][i].dev_addr = 0;
-            blend_devices[output][i].instance = -1;
-            init_input_event(&blend_devices[output][i].state);
-        }
+        blend_reset(&blend_states[output]);
     }
 
     // Initialize routing table
@@ -172,7 +541,7 @@ void router_init(const router_config_t* config) {
 // - Left stick (default): mouse controls movement
 // - Right stick: mouse controls camera (e.g., mouthpad for accessibility)
 // - drain_rate=0: hold position until input returns to center (no auto-drain)
-static void transform_mouse_to_analog(input_event_t* event, output_target_t output, int player_index) {
+static void transform_mouse_to_analog(input_state_t* event, output_target_t output, int player_index) {
     if (event->type != INPUT_TYPE_MOUSE) return;
     if (player_index < 0 || player_index >= MAX_PLAYERS_PER_OUTPUT) return;
 
@@ -235,7 +604,7 @@ static void transform_mouse_to_analog(input_event_t* event, output_target_t outp
 
 // Instance merging: Merge multi-instance devices (Joy-Con Grip, etc.)
 // TODO Phase 5: Implement Joy-Con Grip merging
-static void transform_merge_instances(input_event_t* event, output_target_t output, int player_index) {
+static void transform_merge_instances(input_state_t* event, output_target_t output, int player_index) {
     if (player_index < 0 || player_index >= MAX_PLAYERS_PER_OUTPUT) return;
 
     // TODO: Detect multi-instance devices (instance == -1 flag from device driver)
@@ -246,8 +615,8 @@ static void transform_merge_instances(input_event_t* event, output_target_t outp
     (void)output;
 }
 
-// Apply transformations to input event (modifies event in-place)
-static void apply_transformations(input_event_t* event, output_target_t output, int player_index) {
+// Apply transformations to output state (modifies state in-place)
+static void apply_transformations(input_state_t* event, output_target_t output, int player_index) {
     if (!router_config.transform_flags) return;  // No transformations enabled
 
     // Apply mouse-to-analog transformation
@@ -283,6 +652,7 @@ bool router_add_route(input_source_t input, output_target_t output, uint8_t prio
     routing_table[route_count].output_player_id = 0xFF; // Auto-assign
 
     route_count++;
+    router_rebuild_index();
     printf(LOG_TAG "Route added: %s → %s (priority=%d)\n",
         input == INPUT_SOURCE_USB_HOST ? "USB" : "?",
         output == OUTPUT_TARGET_GAMECUBE ? "GameCube" :
@@ -305,6 +675,7 @@ bool router_add_route_filtered(const route_entry_t* route) {
     routing_table[route_count] = *route;
     routing_table[route_count].active = true;
     route_count++;
+    router_rebuild_index();
 
     printf(LOG_TAG "Filtered route added (dev_addr=%d, instance=%d, player=%d)\n",
         route->input_dev_addr, route->input_instance, route->output_player_id);
@@ -317,6 +688,7 @@ void router_remove_route(uint8_t route_index) {
     if (route_index >= MAX_ROUTES || !routing_table[route_index].active) return;
 
     routing_table[route_index].active = false;
+    router_rebuild_index();
     printf(LOG_TAG "Route %d removed\n", route_index);
 }
 
@@ -326,16 +698,13 @@ void router_clear_routes(void) {
         routing_table[i].active = false;
     }
     route_count = 0;
+    router_rebuild_index();
     printf(LOG_TAG "All routes cleared\n");
 }
 
 // Get number of active routes
 uint8_t router_get_route_count(void) {
-    uint8_t count = 0;
-    for (uint8_t i = 0; i < MAX_ROUTES; i++) {
-        if (routing_table[i].active) count++;
-    }
-    return count;
+    return route_active_count;
 }
 
 // Get route by index
@@ -347,33 +716,44 @@ const route_entry_t* router_get_route(uint8_t route_index) {
 }
 
 // Find matching routes for an input event
-// Returns number of matches found (fills matches array)
-static uint8_t router_find_routes(const input_event_t* event, route_entry_t* matches, uint8_t max_matches) {
+// Walks only the event's wildcard and dev_addr buckets, merged in table order.
+// Returns number of matches found (fills matches array with table pointers)
+static uint8_t router_find_routes(const input_event_t* event, const route_entry_t** matches, uint8_t max_matches) {
     uint8_t match_count = 0;
 
-    for (uint8_t i = 0; i < MAX_ROUTES && match_count < max_matches; i++) {
-        if (!routing_table[i].active) continue;
+    uint8_t wild_group = route_group(router_event_source(event), 0);
+    uint8_t wi = route_group_start[wild_group];
+    uint8_t we = route_group_start[wild_group + 1];
 
-        // Check if input source matches (wildcard = INPUT_SOURCE_USB_HOST)
-        if (routing_table[i].input != INPUT_SOURCE_USB_HOST) {
-            // TODO: Add other input sources (BLE, GPIO, etc.)
-            continue;
+    uint8_t di = 0, de = 0;
+    if (event->dev_addr != 0) {
+        uint8_t dev_group = route_group(router_event_source(event), event->dev_addr);
+        di = route_group_start[dev_group];
+        de = route_group_start[dev_group + 1];
+    }
+
+    while ((wi < we || di < de) && match_count < max_matches) {
+        uint8_t idx;
+        if (di >= de || (wi < we && route_order[wi] < route_order[di])) {
+            idx = route_order[wi++];
+        } else {
+            idx = route_order[di++];
         }
 
-        // Check device address filter (0 = wildcard)
-        if (routing_table[i].input_dev_addr != 0 &&
-            routing_table[i].input_dev_addr != event->dev_addr) {
+        const route_entry_t* route = &routing_table[idx];
+
+        // Device address filter (bucket may hold other addresses)
+        if (route->input_dev_addr != 0 && route->input_dev_addr != event->dev_addr) {
             continue;
         }
 
         // Check instance filter (-1 = wildcard)
-        if (routing_table[i].input_instance != -1 &&
-            routing_table[i].input_instance != event->instance) {
+        if (route->input_instance != -1 && route->input_instance != event->instance) {
             continue;
         }
 
         // Match found!
-        matches[match_count++] = routing_table[i];
+        matches[match_count++] = route;
     }
 
     return match_count;
@@ -383,6 +763,27 @@ static uint8_t router_find_routes(const input_event_t* event, route_entry_t* mat
 // INPUT SUBMISSION (Core 0 - Event Driven)
 // ============================================================================
 
+// Publish a transformed state to an output slot. Extended data (motion,
+// pressure, chatpad) is copied from the source event only when flagged.
+static inline void router_store_output(output_target_t output, uint8_t player_index,
+                                       const input_state_t* state, const input_event_t* event) {
+    output_state_t* os = &router_outputs[output][player_index];
+
+    router_write_begin(os);
+    os->current_state = *state;
+    if (state->flags & INPUT_STATE_EXT_MASK) {
+        input_ext_from_event(&os->ext, event, state->flags);
+    }
+    router_accumulate_deltas(os);
+    os->source = INPUT_SOURCE_USB_HOST;
+    router_write_end(os);
+
+    // Notify tap if registered (for push-based outputs like UART)
+    if (output_taps[output]) {
+        output_taps[output](output, player_index, &os->current_state, &os->ext);
+    }
+}
+
 // SIMPLE MODE: Direct 1:1 pass-through (zero overhead, can be inlined)
 static inline void router_simple_mode(const input_event_t* event, output_target_t output) {
     // Find or add player
@@ -402,21 +803,15 @@ static inline void router_simple_mode(const input_event_t* event, output_target_
     }
 
     if (player_index >= 0 && player_index < router_config.max_players_per_output[output]) {
-        // Create local copy for transformation
-        input_event_t transformed = *event;
+        // Extract compact state for transformation
+        input_state_t transformed;
+        input_state_from_event(&transformed, event);
 
         // Apply transformations (mouse-to-analog, instance merging, etc.)
         apply_transformations(&transformed, output, player_index);
 
-        // Store transformed event (atomic write)
-        router_outputs[output][player_index].current_state = transformed;
-        router_outputs[output][player_index].updated = true;
-        router_outputs[output][player_index].source = INPUT_SOURCE_USB_HOST;
-
-        // Notify tap if registered (for push-based outputs like UART)
-        if (output_taps[output]) {
-            output_taps[output](output, player_index, &transformed);
-        }
+        // Store transformed state (atomic write)
+        router_store_output(output, (uint8_t)player_index, &transformed, event);
     }
 }
 
@@ -440,145 +835,50 @@ static inline void router_merge_mode(const input_event_t* event, output_target_t
     // Only process if player is registered
     if (player_index < 0) return;
 
-    // Create local copy for transformation
-    input_event_t transformed = *event;
+    // Extract compact state for transformation
+    input_state_t transformed;
+    input_state_from_event(&transformed, event);
 
     // Apply transformations (mouse-to-analog, instance merging, etc.)
     apply_transformations(&transformed, output, 0);  // Always player 0 in merge mode
 
+    output_state_t* os = &router_outputs[output][0];
+
+    router_write_begin(os);
     switch (router_config.merge_mode) {
         case MERGE_ALL:
             // Latest active input wins (overwrites previous state)
-            router_outputs[output][0].current_state = transformed;
+            os->current_state = transformed;
+            input_ext_from_event(&os->ext, event, transformed.flags);
             break;
 
-        case MERGE_BLEND: {
+        case MERGE_BLEND:
             // Blend button states together from ALL active devices
-            // 1. Update this device's state in blend_devices[]
-            // 2. Re-blend all active devices into output
-
-            // Find or create slot for this device
-            int slot = -1;
-            for (int i = 0; i < MAX_BLEND_DEVICES; i++) {
-                if (blend_devices[output][i].active &&
-                    blend_devices[output][i].dev_addr == transformed.dev_addr &&
-                    blend_devices[output][i].instance == transformed.instance) {
-                    slot = i;
-                    break;
-                }
-            }
-            if (slot < 0) {
-                // Find empty slot
-                for (int i = 0; i < MAX_BLEND_DEVICES; i++) {
-                    if (!blend_devices[output][i].active) {
-                        slot = i;
-                        blend_devices[output][i].active = true;
-                        blend_devices[output][i].dev_addr = transformed.dev_addr;
-                        blend_devices[output][i].instance = transformed.instance;
-                        break;
-                    }
-                }
-            }
-
-            if (slot >= 0) {
-                // Update this device's state
-                blend_devices[output][slot].state = transformed;
-
-                // Now re-blend ALL active devices
-                output_state_t* out = &router_outputs[output][0];
-
-                // Start with neutral state (all buttons released)
-                // Note: deltas are cleared here but accumulated fresh from blend devices
-                init_input_event(&out->current_state);
-
-                // Blend all active devices
-                bool first = true;
-                for (int i = 0; i < MAX_BLEND_DEVICES; i++) {
-                    if (!blend_devices[output][i].active) continue;
-
-                    input_event_t* dev = &blend_devices[output][i].state;
-
-                    // Buttons: OR together (active-high, 1 = pressed)
-                    out->current_state.buttons |= dev->buttons;
-
-                    // Keys: OR together (active-high)
-                    out->current_state.keys |= dev->keys;
-
-                    // Analog: use furthest from center for sticks (0-3)
-                    // and max value for triggers (5-6)
-                    for (int j = 0; j < 8; j++) {
-                        if (j == 4 || j == 7) continue;  // Skip unused slots
-                        if (j >= 5) {
-                            // Triggers (5=L2, 6=R2): use max value
-                            if (dev->analog[j] > out->current_state.analog[j]) {
-                                out->current_state.analog[j] = dev->analog[j];
-                            }
-                        } else {
-                            // Sticks (0-3): use furthest from center
-                            int8_t cur_delta = (int8_t)(out->current_state.analog[j] - 128);
-                            int8_t dev_delta = (int8_t)(dev->analog[j] - 128);
-                            if (abs(dev_delta) > abs(cur_delta)) {
-                                out->current_state.analog[j] = dev->analog[j];
-                            }
-                        }
-                    }
-
-                    // Mouse deltas: accumulate from all, then clear device to prevent re-adding
-                    out->current_state.delta_x += dev->delta_x;
-                    out->current_state.delta_y += dev->delta_y;
-                    dev->delta_x = 0;
-                    dev->delta_y = 0;
-
-                    // Motion: use first device that has motion data
-                    if (dev->has_motion && !out->current_state.has_motion) {
-                        out->current_state.has_motion = true;
-                        out->current_state.accel[0] = dev->accel[0];
-                        out->current_state.accel[1] = dev->accel[1];
-                        out->current_state.accel[2] = dev->accel[2];
-                        out->current_state.gyro[0] = dev->gyro[0];
-                        out->current_state.gyro[1] = dev->gyro[1];
-                        out->current_state.gyro[2] = dev->gyro[2];
-                    }
-
-                    // Pressure: use first device that has pressure data
-                    if (dev->has_pressure && !out->current_state.has_pressure) {
-                        out->current_state.has_pressure = true;
-                        for (int j = 0; j < 12; j++) {
-                            out->current_state.pressure[j] = dev->pressure[j];
-                        }
-                    }
-
-                    // Use metadata from first active device
-                    if (first) {
-                        out->current_state.dev_addr = dev->dev_addr;
-                        out->current_state.instance = dev->instance;
-                        out->current_state.type = dev->type;
-                        first = false;
-                    }
-                }
-            }
+            // (incremental: only this device's contribution is re-evaluated)
+            blend_update(&blend_states[output], &transformed, event, os);
             break;
-        }
 
         case MERGE_PRIORITY:
             // High priority input wins, low priority fallback
             // Used by Super3D0USB (USB priority, SNES fallback)
             // Check if this source has higher priority than current
-            if (router_outputs[output][0].source <= INPUT_SOURCE_USB_HOST) {
+            if (os->source <= INPUT_SOURCE_USB_HOST) {
                 // USB has highest priority (0), always wins
-                router_outputs[output][0].current_state = transformed;
+                os->current_state = transformed;
+                input_ext_from_event(&os->ext, event, transformed.flags);
             }
             // Lower priority sources only update if no USB input active
             // TODO: Track activity timeout for priority fallback
             break;
     }
 
-    router_outputs[output][0].updated = true;
-    router_outputs[output][0].source = INPUT_SOURCE_USB_HOST;
+    router_accumulate_deltas(os);
+    os->source = INPUT_SOURCE_USB_HOST;
+    router_write_end(os);
 
     // Notify tap if registered (for push-based outputs like UART)
     if (output_taps[output]) {
-        output_taps[output](output, 0, &router_outputs[output][0].current_state);
+        output_taps[output](output, 0, &os->current_state, &os->ext);
     }
 }
 
@@ -587,14 +887,8 @@ void router_submit_input(const input_event_t* event) {
     if (!event) return;
     if (route_count == 0) return;
 
-    // Find first active route to determine output target
-    output_target_t output = OUTPUT_TARGET_USB_DEVICE;
-    for (uint8_t i = 0; i < MAX_ROUTES; i++) {
-        if (routing_table[i].active) {
-            output = routing_table[i].output;
-            break;
-        }
-    }
+    // First active route determines output target (precompiled)
+    output_target_t output = router_default_output();
 
     // Route based on mode
     switch (router_config.mode) {
@@ -618,27 +912,22 @@ void router_submit_input(const input_event_t* event) {
 
         case ROUTING_MODE_CONFIGURABLE:
             {
-                route_entry_t matches[MAX_ROUTES];
+                const route_entry_t* matches[MAX_ROUTES];
                 uint8_t match_count = router_find_routes(event, matches, MAX_ROUTES);
 
                 if (match_count == 0) {
                     router_simple_mode(event, output);
                 } else {
                     for (uint8_t i = 0; i < match_count; i++) {
-                        output_target_t target = matches[i].output;
-                        uint8_t target_player = matches[i].output_player_id;
+                        output_target_t target = matches[i]->output;
+                        uint8_t target_player = matches[i]->output_player_id;
 
                         if (target_player != 0xFF && target_player < MAX_PLAYERS_PER_OUTPUT) {
-                            input_event_t transformed = *event;
+                            input_state_t transformed;
+                            input_state_from_event(&transformed, event);
                             apply_transformations(&transformed, target, target_player);
 
-                            router_outputs[target][target_player].current_state = transformed;
-                            router_outputs[target][target_player].updated = true;
-                            router_outputs[target][target_player].source = INPUT_SOURCE_USB_HOST;
-
-                            if (output_taps[target]) {
-                                output_taps[target](target, target_player, &transformed);
-                            }
+                            router_store_output(target, target_player, &transformed, event);
                         } else {
                             router_simple_mode(event, target);
                         }
@@ -653,36 +942,90 @@ void router_submit_input(const input_event_t* event) {
 // OUTPUT RETRIEVAL (Core 1 - Poll or Event Driven)
 // ============================================================================
 
-// Static buffer for returning copies (so we can clear original deltas)
-static input_event_t router_output_copy[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
+// Reader-side state (core 1 only). The router never writes these, so the
+// seqlock stays single-writer: consumed deltas are tracked here instead of
+// being cleared in the shared slot.
+static input_state_t router_output_copy[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
+static input_ext_t router_output_ext_copy[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
+static uint32_t router_read_seq[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
+static uint32_t router_delta_read_x[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
+static uint32_t router_delta_read_y[MAX_OUTPUTS][MAX_PLAYERS_PER_OUTPUT];
+
+// Take up to one int8 report worth of pending relative motion; the rest
+// stays pending for the next read
+static inline int8_t router_consume_delta(uint32_t total, uint32_t* read) {
+    int32_t pending = (int32_t)(total - *read);
+    if (pending > 127) pending = 127;
+    if (pending < -127) pending = -127;
+    *read += (uint32_t)pending;
+    return (int8_t)pending;
+}
 
-const input_event_t* __not_in_flash_func(router_get_output)(output_target_t output, uint8_t player_id) {
+const input_state_t* __not_in_flash_func(router_get_output)(output_target_t output, uint8_t player_id) {
     if (output >= MAX_OUTPUTS || player_id >= MAX_PLAYERS_PER_OUTPUT) {
         return NULL;
     }
 
-    if (router_outputs[output][player_id].updated) {
-        router_outputs[output][player_id].updated = false;  // Mark as read
-        
-        // Copy to static buffer so caller gets the deltas
-        router_output_copy[output][player_id] = router_outputs[output][player_id].current_state;
-        
-        // Clear deltas from original (they've been consumed)
-        router_outputs[output][player_id].current_state.delta_x = 0;
-        router_outputs[output][player_id].current_state.delta_y = 0;
-        
-        return &router_output_copy[output][player_id];
+    const output_state_t* os = &router_outputs[output][player_id];
+    input_state_t* copy = &router_output_copy[output][player_id];
+    uint32_t* read_x = &router_delta_read_x[output][player_id];
+    uint32_t* read_y = &router_delta_read_y[output][player_id];
+    uint32_t total_x, total_y;
+    uint32_t seq;
+
+    for (;;) {
+        seq = os->seq;
+        if (seq & 1) continue;  // Writer mid-update on core 0
+
+        __dmb();
+        total_x = os->delta_total_x;
+        total_y = os->delta_total_y;
+
+        if (seq == router_read_seq[output][player_id]) {
+            // No new state. Re-deliver the last copy only while clamped motion is pending.
+            __dmb();
+            if (os->seq != seq) continue;
+            if (total_x == *read_x && total_y == *read_y) {
+                return NULL;  // Nothing new (don't re-process same state)
+            }
+            break;
+        }
+
+        *copy = os->current_state;
+        if (copy->flags & INPUT_STATE_EXT_MASK) {
+            input_ext_copy(&router_output_ext_copy[output][player_id], &os->ext, copy->flags);
+        }
+        __dmb();
+        if (os->seq == seq) break;  // Consistent snapshot
     }
 
-    // No update - return NULL (don't re-process same deltas)
-    return NULL;
+    router_read_seq[output][player_id] = seq;
+
+    // Deliver everything accumulated since the last read, not just the last report
+    copy->delta_x = router_consume_delta(total_x, read_x);
+    copy->delta_y = router_consume_delta(total_y, read_y);
+
+    return copy;
+}
+
+const input_ext_t* router_get_output_ext(output_target_t output, uint8_t player_id) {
+    if (output >= MAX_OUTPUTS || player_id >= MAX_PLAYERS_PER_OUTPUT) {
+        return NULL;
+    }
+    if (!(router_output_copy[output][player_id].flags & INPUT_STATE_EXT_MASK)) {
+        return NULL;
+    }
+    return &router_output_ext_copy[output][player_id];
 }
 
 bool router_has_updates(output_target_t output) {
     if (output >= MAX_OUTPUTS) return false;
 
     for (uint8_t player = 0; player < MAX_PLAYERS_PER_OUTPUT; player++) {
-        if (router_outputs[output][player].updated) {
+        const output_state_t* os = &router_outputs[output][player];
+        if (os->seq != router_read_seq[output][player] ||
+            os->delta_total_x != router_delta_read_x[output][player] ||
+            os->delta_total_y != router_delta_read_y[output][player]) {
             return true;
         }
     }
@@ -702,12 +1045,46 @@ uint8_t router_get_player_count(output_target_t output) {
 // ============================================================================
 
 void router_set_merge_mode(output_target_t output, merge_mode_t mode) {
+    // Blended output is maintained incrementally - resync it when blending starts
+    if (mode == MERGE_BLEND && router_config.merge_mode != MERGE_BLEND &&
+        output >= 0 && output < MAX_OUTPUTS) {
+        router_write_begin(&router_outputs[output][0]);
+        blend_rebuild_output(&blend_states[output], &router_outputs[output][0]);
+        router_write_end(&router_outputs[output][0]);
+    }
+
     router_config.merge_mode = mode;
     printf(LOG_TAG "Merge mode set: %s\n",
         mode == MERGE_PRIORITY ? "PRIORITY" :
         mode == MERGE_BLEND ? "BLEND" : "ALL");
 }
 
+void router_set_routing_mode(routing_mode_t mode) {
+    if (mode == router_config.mode) return;
+
+    // Blended output is maintained incrementally - resync it when merging starts
+    if (mode == ROUTING_MODE_MERGE && router_config.merge_mode == MERGE_BLEND) {
+        for (uint8_t output = 0; output < MAX_OUTPUTS; output++) {
+            router_write_begin(&router_outputs[output][0]);
+            blend_rebuild_output(&blend_states[output], &router_outputs[output][0]);
+            router_write_end(&router_outputs[output][0]);
+        }
+    }
+
+    router_config.mode = mode;
+    printf(LOG_TAG "Routing mode set: %s\n",
+        mode == ROUTING_MODE_SIMPLE ? "SIMPLE" :
+        mode == ROUTING_MODE_MERGE ? "MERGE" :
+        mode == ROUTING_MODE_BROADCAST ? "BROADCAST" : "CONFIGURABLE");
+}
+
+void router_set_max_players(output_target_t output, uint8_t count) {
+    if (output < 0 || output >= MAX_OUTPUTS) return;
+    if (count > MAX_PLAYERS_PER_OUTPUT) count = MAX_PLAYERS_PER_OUTPUT;
+    router_config.max_players_per_output[output] = count;
+    printf(LOG_TAG "Output %d max players: %d\n", output, count);
+}
+
 void router_set_active_outputs(output_target_t* outputs, uint8_t count) {
     if (!outputs || count > MAX_OUTPUTS) return;
 
@@ -726,13 +1103,7 @@ output_target_t router_get_primary_output(void) {
     }
 
     // Fall back to first active route's output (used by SIMPLE/MERGE modes)
-    for (uint8_t i = 0; i < MAX_ROUTES; i++) {
-        if (routing_table[i].active) {
-            return routing_table[i].output;
-        }
-    }
-
-    return OUTPUT_TARGET_NONE;
+    return route_primary_output;
 }
 
 // ============================================================================
@@ -763,17 +1134,14 @@ void router_reset_outputs(void) {
     // Reset all output states
     for (uint8_t output = 0; output < MAX_OUTPUTS; output++) {
         for (uint8_t player = 0; player < MAX_PLAYERS_PER_OUTPUT; player++) {
-            init_input_event(&router_outputs[output][player].current_state);
-            router_outputs[output][player].updated = true;  // Signal that state changed
+            output_state_t* os = &router_outputs[output][player];
+            router_write_begin(os);  // Bumping seq signals that state changed
+            init_input_state(&os->current_state);
+            router_write_end(os);
         }
 
         // Clear blend device tracking
-        for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
-            blend_devices[output][i].active = false;
-            blend_devices[output][i].dev_addr = 0;
-            blend_devices[output][i].instance = -1;
-            init_input_event(&blend_devices[output][i].state);
-        }
+        blend_reset(&blend_states[output]);
     }
 }
 
@@ -784,81 +1152,48 @@ void router_device_disconnected(uint8_t dev_addr, int8_t instance) {
     // Find the player index for this device
     int player_index = find_player_index(dev_addr, instance);
 
-    // Find first active route to determine output target
-    output_target_t output = OUTPUT_TARGET_USB_DEVICE;
-    for (uint8_t i = 0; i < MAX_ROUTES; i++) {
-        if (routing_table[i].active) {
-            output = routing_table[i].output;
-            break;
-        }
-    }
+    // First active route determines output target
+    output_target_t output = router_default_output();
 
     // Clear blend device tracking for this device (MERGE_BLEND mode)
     for (uint8_t out = 0; out < MAX_OUTPUTS; out++) {
-        for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
-            if (blend_devices[out][i].active &&
-                blend_devices[out][i].dev_addr == dev_addr &&
-                blend_devices[out][i].instance == instance) {
-                blend_devices[out][i].active = false;
-                blend_devices[out][i].dev_addr = 0;
-                blend_devices[out][i].instance = -1;
-                init_input_event(&blend_devices[out][i].state);
-                printf(LOG_TAG "Cleared blend device slot %d for output %d\n", i, out);
-            }
+        if (blend_remove_device(&blend_states[out], dev_addr, instance)) {
+            router_write_begin(&router_outputs[out][0]);
+            blend_rebuild_output(&blend_states[out], &router_outputs[out][0]);
+            router_write_end(&router_outputs[out][0]);
+            printf(LOG_TAG "Cleared blend device for output %d\n", out);
         }
     }
 
     // For MERGE mode, all inputs go to player 0 - re-blend remaining devices
     if (router_config.mode == ROUTING_MODE_MERGE) {
         output_state_t* out_state = &router_outputs[output][0];
-        init_input_event(&out_state->current_state);
 
+        router_write_begin(out_state);
         if (router_config.merge_mode == MERGE_BLEND) {
-            // Re-blend all remaining active devices
-            for (uint8_t i = 0; i < MAX_BLEND_DEVICES; i++) {
-                if (!blend_devices[output][i].active) continue;
-
-                input_event_t* dev = &blend_devices[output][i].state;
-
-                // Buttons: OR together
-                out_state->current_state.buttons |= dev->buttons;
-                out_state->current_state.keys |= dev->keys;
-
-                // Analog: use furthest from center for sticks, max for triggers
-                for (int j = 0; j < 8; j++) {
-                    if (j == 4 || j == 7) continue;
-                    if (j >= 5) {
-                        if (dev->analog[j] > out_state->current_state.analog[j]) {
-                            out_state->current_state.analog[j] = dev->analog[j];
-                        }
-                    } else {
-                        int8_t cur_delta = (int8_t)(out_state->current_state.analog[j] - 128);
-                        int8_t dev_delta = (int8_t)(dev->analog[j] - 128);
-                        if (abs(dev_delta) > abs(cur_delta)) {
-                            out_state->current_state.analog[j] = dev->analog[j];
-                        }
-                    }
-                }
-            }
+            blend_rebuild_output(&blend_states[output], out_state);
+        } else {
+            init_input_state(&out_state->current_state);
         }
-
-        out_state->updated = true;
+        router_write_end(out_state);
 
         // Always notify tap with current state (zeroed or re-blended)
         if (output_taps[output]) {
-            output_taps[output](output, 0, &out_state->current_state);
+            output_taps[output](output, 0, &out_state->current_state, &out_state->ext);
         }
 
         printf(LOG_TAG "Updated merged output (player 0)\n");
     } else {
         // SIMPLE/BROADCAST mode: clear this player's specific output state
         if (player_index >= 0 && player_index < MAX_PLAYERS_PER_OUTPUT) {
-            init_input_event(&router_outputs[output][player_index].current_state);
-            router_outputs[output][player_index].updated = true;
+            router_write_begin(&router_outputs[output][player_index]);
+            init_input_state(&router_outputs[output][player_index].current_state);
+            router_write_end(&router_outputs[output][player_index]);
 
             // Notify tap if registered (sends zeroed state to USB/UART output)
             if (output_taps[output]) {
-                output_taps[output](output, player_index, &router_outputs[output][player_index].current_state);
+                output_taps[output](output, player_index, &router_outputs[output][player_index].current_state,
+                                    &router_outputs[output][player_index].ext);
             }
 
             printf(LOG_TAG "Cleared output state for player %d\n", player_index);
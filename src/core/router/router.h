@@ -32,13 +32,16 @@ typedef enum {
 // INPUT/OUTPUT SOURCES
 // ============================================================================
 
+// Submitters set input_event_t.source; USB host drivers leave it 0
 typedef enum {
-    INPUT_SOURCE_USB_HOST,
-    INPUT_SOURCE_BLE_CENTRAL,
+    INPUT_SOURCE_USB_HOST = 0,
+    INPUT_SOURCE_BLE_CENTRAL,   // BLE HID host (HOGP)
+    INPUT_SOURCE_BT,            // Bluetooth Classic HID host
     INPUT_SOURCE_NATIVE_SNES,
     INPUT_SOURCE_NATIVE_3DO,
     INPUT_SOURCE_GPIO,
     INPUT_SOURCE_SENSORS,
+    INPUT_SOURCE_UART,          // UART bridge peer
 } input_source_t;
 
 typedef enum {
@@ -126,8 +129,13 @@ void router_submit_input(const input_event_t* event);
 // ============================================================================
 
 // Get latest input state for this output+player (returns NULL if no update)
-// Lock-free read, zero-copy (returns pointer to internal state)
-const input_event_t* router_get_output(output_target_t output, uint8_t player_id);
+// Lock-free seqlock read, returns pointer to a per-slot copy of the compact state.
+// delta_x/delta_y hold all relative motion reported since the previous read.
+const input_state_t* router_get_output(output_target_t output, uint8_t player_id);
+
+// Extended data (motion/pressure/chatpad) for the state last returned by
+// router_get_output(). Returns NULL unless state->flags has INPUT_STATE_EXT_MASK bits.
+const input_ext_t* router_get_output_ext(output_target_t output, uint8_t player_id);
 
 // Check if any player has new data (fast scan for multi-player outputs)
 bool router_has_updates(output_target_t output);
@@ -182,6 +190,12 @@ const route_entry_t* router_get_route(uint8_t route_index);
 // Set merge mode for output
 void router_set_merge_mode(output_target_t output, merge_mode_t mode);
 
+// Switch routing mode at runtime (e.g. an output that exposes one device per player)
+void router_set_routing_mode(routing_mode_t mode);
+
+// Set the player slot limit for an output (clamped to MAX_PLAYERS_PER_OUTPUT)
+void router_set_max_players(output_target_t output, uint8_t count);
+
 // Set active outputs (for broadcast mode)
 void router_set_active_outputs(output_target_t* outputs, uint8_t count);
 
@@ -205,9 +219,10 @@ void router_device_disconnected(uint8_t dev_addr, int8_t instance);
 // Tap callback - called when router updates output state
 // output: which output target
 // player_index: which player slot (0-based)
-// event: the updated input event
+// state: the updated compact input state
+// ext: extended data, valid for blocks flagged in state->flags
 typedef void (*router_tap_callback_t)(output_target_t output, uint8_t player_index,
-                                       const input_event_t* event);
+                                       const input_state_t* state, const input_ext_t* ext);
 
 // Set tap callback for an output (NULL to disable)
 void router_set_tap(output_target_t output, router_tap_callback_t callback);
@@ -217,9 +232,14 @@ void router_set_tap(output_target_t output, router_tap_callback_t callback);
 // ============================================================================
 
 // Output state structure (replaces players[] array)
+// Written only by core 0 (router), read by core 1 (output) under a seqlock:
+// seq is odd while a write is in progress and advances by 2 per update.
 typedef struct {
-    input_event_t current_state;    // Latest event (atomic write)
-    volatile bool updated;           // New data flag
+    volatile uint32_t seq;           // Seqlock sequence (odd = write in progress)
+    input_state_t current_state;    // Latest compact state
+    input_ext_t ext;                 // Motion/pressure/chatpad (valid per current_state.flags)
+    uint32_t delta_total_x;          // Running sum of relative X (accumulate-on-write)
+    uint32_t delta_total_y;          // Running sum of relative Y (accumulate-on-write)
     uint8_t player_id;               // Player slot assignment
     input_source_t source;           // Source of this input (for priority)
 } output_state_t;
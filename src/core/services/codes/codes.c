@@ -63,7 +63,7 @@ void codes_set_callback(codes_callback_t callback)
 // ============================================================================
 
 // Internal function that processes button state for sequence detection
-static void codes_process_buttons(const input_event_t* event)
+static void codes_process_buttons(const input_state_t* event)
 {
     if (!event) return;
 
@@ -90,7 +90,7 @@ static void codes_process_buttons(const input_event_t* event)
 void codes_task(void)
 {
     // Get current button state from router (player 0)
-    const input_event_t* event = router_get_output(OUTPUT_TARGET_GAMECUBE, 0);
+    const input_state_t* event = router_get_output(OUTPUT_TARGET_GAMECUBE, 0);
 
     // Fallback to other outputs if GameCube returns NULL
     if (!event) event = router_get_output(OUTPUT_TARGET_PCENGINE, 0);
@@ -106,7 +106,7 @@ void codes_task(void)
 // Task with explicit output target (for controller app)
 void codes_task_for_output(output_target_t output)
 {
-    const input_event_t* event = router_get_output(output, 0);
+    const input_state_t* event = router_get_output(output, 0);
     codes_process_buttons(event);
 }
 
@@ -4,6 +4,7 @@
 // Supports per-output-target profile sets with shared fallback.
 
 #include "profile.h"
+#include "profile_compile.h"
 #include "pico/stdlib.h"
 #include <stdio.h>
 #include <string.h>
@@ -13,8 +14,12 @@
 #include "core/services/profiles/profile_indicator.h"
 #include "core/services/players/feedback.h"
 
-// Flash storage
-#include "core/services/storage/flash.h"
+// Persistent settings
+#include "core/services/storage/settings.h"
+
+#if MAX_PLAYERS > SETTINGS_MAX_PLAYERS || MAX_OUTPUT_TARGETS > SETTINGS_MAX_OUTPUTS
+#error "Settings store needs an instance per player and per output"
+#endif
 
 // ============================================================================
 // PROFILE SYSTEM STATE
@@ -116,6 +121,18 @@ void profile_init(const profile_config_t* cfg)
             active_index[primary] = config->shared_profiles->default_index;
         }
     }
+
+    // Per-player indices (players without one start on the output's profile)
+    const profile_set_t* primary_set = (primary != OUTPUT_TARGET_NONE) ? get_profile_set(primary) : NULL;
+    for (uint8_t p = 0; p < MAX_PLAYERS && primary_set; p++) {
+        uint8_t idx = settings_get_u8(SETTING_PLAYER_PROFILE, p, active_index[primary]);
+        player_profiles[p].profile_index = (idx < primary_set->profile_count) ? idx : active_index[primary];
+    }
+
+    // Compile the startup profile so the first report doesn't pay for it
+    if (primary != OUTPUT_TARGET_NONE) {
+        profile_compile(profile_get_active(primary));
+    }
 }
 
 void profile_set_player_count_callback(uint8_t (*callback)(void))
@@ -187,10 +204,13 @@ void profile_set_active(output_target_t output, uint8_t index)
         return;
     }
 
+    const profile_t* previous = profile_get_active(output);
     if (output >= 0 && output < MAX_OUTPUT_TARGETS) {
         active_index[output] = index;
     }
 
+    profile_compile_switch(previous, &set->profiles[index]);
+
     // Notify device of switch
     if (on_switch_callback) {
         on_switch_callback(output, index);
@@ -265,6 +285,7 @@ void profile_set_player_active(output_target_t output, uint8_t player_index, uin
         return;
     }
 
+    const profile_t* previous = profile_get_active_for_player(output, player_index);
     player_profiles[player_index].profile_index = profile_index;
     player_profiles[player_index].dirty = true;
 
@@ -273,6 +294,8 @@ void profile_set_player_active(output_target_t output, uint8_t player_index, uin
         active_index[output] = profile_index;
     }
 
+    profile_compile_switch(previous, &set->profiles[profile_index]);
+
     // Notify callbacks
     if (on_player_switch_callback) {
         on_player_switch_callback(output, player_index, profile_index);
@@ -288,7 +311,8 @@ void profile_set_player_active(output_target_t output, uint8_t player_index, uin
     // Also trigger NeoPixel for visual indication (global)
     leds_indicate_profile(profile_index);
 
-    // Save to flash (for now, just save player 0's profile)
+    // Save to flash (debounced; player 0 is also the output's index)
+    settings_set_u8(SETTING_PLAYER_PROFILE, player_index, profile_index);
     if (player_index == 0) {
         profile_save_to_flash(output);
     }
@@ -552,23 +576,16 @@ bool profile_switch_combo_active(void)
 
 uint8_t profile_load_from_flash(output_target_t output, uint8_t default_index)
 {
-    flash_t settings;
-    if (flash_load(&settings)) {
-        // For now, use single stored index for all outputs
-        // TODO: Store per-output indices if needed
-        return settings.active_profile_index;
+    if (output < 0 || output >= SETTINGS_MAX_OUTPUTS) {
+        return default_index;
     }
-    return default_index;
+    return settings_get_u8(SETTING_PROFILE_INDEX, (uint8_t)output, default_index);
 }
 
 void profile_save_to_flash(output_target_t output)
 {
-    flash_t settings;
-    // For now, save primary output's index
-    // TODO: Store per-output indices if needed
     if (output >= 0 && output < MAX_OUTPUT_TARGETS) {
-        settings.active_profile_index = active_index[output];
-        flash_save(&settings);
+        settings_set_u8(SETTING_PROFILE_INDEX, (uint8_t)output, active_index[output]);
     }
 }
 
@@ -634,12 +651,32 @@ static void apply_analog_target(analog_target_t target, uint8_t value, profile_o
     }
 }
 
-void profile_apply(const profile_t* profile,
-                   uint32_t input_buttons,
-                   uint8_t lx, uint8_t ly,
-                   uint8_t rx, uint8_t ry,
-                   uint8_t l2, uint8_t r2,
-                   profile_output_t* output)
+void __not_in_flash_func(profile_apply)(const profile_t* profile,
+                                        uint32_t input_buttons,
+                                        uint8_t lx, uint8_t ly,
+                                        uint8_t rx, uint8_t ry,
+                                        uint8_t l2, uint8_t r2,
+                                        profile_output_t* output)
+{
+    // Combo-only profiles are already a flat loop; only mapped profiles gain
+    const profile_compiled_t* compiled = NULL;
+    if (profile && profile->button_map && profile->button_map_count > 0) {
+        compiled = profile_get_compiled(profile);
+    }
+    if (compiled) {
+        profile_apply_compiled(compiled, input_buttons, lx, ly, rx, ry, l2, r2, output);
+        return;
+    }
+
+    profile_apply_interpreted(profile, input_buttons, lx, ly, rx, ry, l2, r2, output);
+}
+
+void profile_apply_interpreted(const profile_t* profile,
+                               uint32_t input_buttons,
+                               uint8_t lx, uint8_t ly,
+                               uint8_t rx, uint8_t ry,
+                               uint8_t l2, uint8_t r2,
+                               profile_output_t* output)
 {
     // Suppress combo buttons when profile switch is active
     // This prevents Select + D-pad from being output during switching
@@ -737,7 +774,7 @@ void profile_apply(const profile_t* profile,
     output->buttons = output_buttons;
 
     // Determine effective left stick sensitivity (check modifiers first)
-    float left_sens = profile->left_stick_sensitivity;
+    analog_scale_t left_sens = profile->left_stick_sensitivity;
     for (uint8_t i = 0; i < profile->left_stick_modifier_count; i++) {
         const stick_modifier_t* mod = &profile->left_stick_modifiers[i];
         if (input_buttons & mod->trigger) {
@@ -750,7 +787,7 @@ void profile_apply(const profile_t* profile,
     }
 
     // Determine effective right stick sensitivity (check modifiers first)
-    float right_sens = profile->right_stick_sensitivity;
+    analog_scale_t right_sens = profile->right_stick_sensitivity;
     for (uint8_t i = 0; i < profile->right_stick_modifier_count; i++) {
         const stick_modifier_t* mod = &profile->right_stick_modifiers[i];
         if (input_buttons & mod->trigger) {
@@ -762,27 +799,23 @@ void profile_apply(const profile_t* profile,
         }
     }
 
-    // Apply left stick sensitivity scaling
-    if (left_sens != 1.0f) {
+    // Apply left stick sensitivity scaling (fixed-point, see core/analog.h)
+    if (left_sens != ANALOG_SCALE_ONE) {
         if (!output->left_x_override) {
-            int16_t rel_x = (int16_t)output->left_x - 128;
-            output->left_x = (uint8_t)(128 + (int16_t)(rel_x * left_sens));
+            output->left_x = analog_scale_stick(output->left_x, left_sens);
         }
         if (!output->left_y_override) {
-            int16_t rel_y = (int16_t)output->left_y - 128;
-            output->left_y = (uint8_t)(128 + (int16_t)(rel_y * left_sens));
+            output->left_y = analog_scale_stick(output->left_y, left_sens);
         }
     }
 
     // Apply right stick sensitivity scaling
-    if (right_sens != 1.0f) {
+    if (right_sens != ANALOG_SCALE_ONE) {
         if (!output->right_x_override) {
-            int16_t rel_x = (int16_t)output->right_x - 128;
-            output->right_x = (uint8_t)(128 + (int16_t)(rel_x * right_sens));
+            output->right_x = analog_scale_stick(output->right_x, right_sens);
         }
         if (!output->right_y_override) {
-            int16_t rel_y = (int16_t)output->right_y - 128;
-            output->right_y = (uint8_t)(128 + (int16_t)(rel_y * right_sens));
+            output->right_y = analog_scale_stick(output->right_y, right_sens);
         }
     }
 
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "core/buttons.h"
+#include "core/analog.h"
 #include "core/router/router.h"
 
 // ============================================================================
@@ -84,7 +85,7 @@ typedef struct {
 
 typedef struct {
     uint32_t trigger;           // Button that activates modifier (e.g., JP_BUTTON_L3)
-    float sensitivity;          // Sensitivity when modifier active (0.0-1.0)
+    analog_scale_t sensitivity; // Sensitivity when modifier active (Q1.15, see ANALOG_SCALE)
     bool consume_trigger;       // If true, remove trigger button from output
 } stick_modifier_t;
 
@@ -133,8 +134,8 @@ typedef struct {
     uint8_t r2_analog_value;    // Custom analog value for TRIGGER_LIGHT_PRESS
 
     // Analog stick settings
-    float left_stick_sensitivity;   // 0.0-1.0 (1.0 = 100%)
-    float right_stick_sensitivity;  // 0.0-1.0 (0.0 = disabled)
+    analog_scale_t left_stick_sensitivity;   // ANALOG_SCALE(0.0-1.0) (1.0 = 100%)
+    analog_scale_t right_stick_sensitivity;  // ANALOG_SCALE(0.0-1.0) (0.0 = disabled)
 
     // Stick modifiers (button-triggered sensitivity changes)
     const stick_modifier_t* left_stick_modifiers;
@@ -313,6 +314,7 @@ void profile_save_to_flash(output_target_t output);
 
 // Apply profile to input event and get output state
 // This is the main function output devices call
+// Uses the compiled form of the profile (see profile_compile.h) when available
 void profile_apply(const profile_t* profile,
                    uint32_t input_buttons,
                    uint8_t lx, uint8_t ly,
@@ -320,6 +322,15 @@ void profile_apply(const profile_t* profile,
                    uint8_t l2, uint8_t r2,
                    profile_output_t* output);
 
+// Reference implementation: walks the profile tables directly
+// Used for profiles that exceed the compile limits and for verification
+void profile_apply_interpreted(const profile_t* profile,
+                               uint32_t input_buttons,
+                               uint8_t lx, uint8_t ly,
+                               uint8_t rx, uint8_t ry,
+                               uint8_t l2, uint8_t r2,
+                               profile_output_t* output);
+
 // Simple button-only mapping (for basic use cases)
 uint32_t profile_apply_button_map(const profile_t* profile, uint32_t input_buttons);
 
@@ -362,11 +373,11 @@ uint32_t profile_apply_button_map(const profile_t* profile, uint32_t input_butto
 
 // Stick modifier: button → reduced sensitivity (consumes trigger by default)
 #define STICK_MODIFIER(btn, sens) \
-    { .trigger = (btn), .sensitivity = (sens), .consume_trigger = true }
+    { .trigger = (btn), .sensitivity = ANALOG_SCALE(sens), .consume_trigger = true }
 
 // Stick modifier: button → reduced sensitivity (keeps trigger in output)
 #define STICK_MODIFIER_KEEP(btn, sens) \
-    { .trigger = (btn), .sensitivity = (sens), .consume_trigger = false }
+    { .trigger = (btn), .sensitivity = ANALOG_SCALE(sens), .consume_trigger = false }
 
 // Standard trigger settings
 #define PROFILE_TRIGGERS_DEFAULT \
@@ -379,8 +390,8 @@ uint32_t profile_apply_button_map(const profile_t* profile, uint32_t input_butto
 
 // Standard analog settings
 #define PROFILE_ANALOG_DEFAULT \
-    .left_stick_sensitivity = 1.0f, \
-    .right_stick_sensitivity = 1.0f, \
+    .left_stick_sensitivity = ANALOG_SCALE_ONE, \
+    .right_stick_sensitivity = ANALOG_SCALE_ONE, \
     .left_stick_modifiers = NULL, \
     .left_stick_modifier_count = 0, \
     .right_stick_modifiers = NULL, \
@@ -0,0 +1,381 @@
+// profile_compile.c - Profile compiler and compiled apply
+//
+// Turns a profile_t into lookup tables once, so profile_apply() costs a
+// handful of loads and ORs per report instead of walking mapping tables and
+// scaling each stick axis.
+
+#include "profile_compile.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <string.h>
+
+// Buttons suppressed while the profile switch combo is held
+#define PROFILE_SWITCH_COMBO_MASK \
+    (JP_BUTTON_S1 | JP_BUTTON_DU | JP_BUTTON_DD | JP_BUTTON_DL | JP_BUTTON_DR)
+
+#define PROFILE_COMPILE_CORES 2
+
+// Per-core cache: each core only writes the slots it reads
+static profile_compiled_t compiled_cache[PROFILE_COMPILE_CORES][PROFILE_COMPILED_SLOTS];
+static uint32_t compiled_clock[PROFILE_COMPILE_CORES];
+static uint8_t compiled_mru[PROFILE_COMPILE_CORES];
+
+// Last profile switch. A core that hasn't compiled the new profile yet keeps
+// serving the table of the profile it replaced. Written by the switching
+// core: to is cleared first, so a reader never pairs a new to with an old from.
+static const profile_t* volatile switch_from;
+static const profile_t* volatile switch_to;
+
+// ============================================================================
+// COMPILER
+// ============================================================================
+
+// Find or allocate a sensitivity table for sens. Returns table index,
+// PROFILE_SENS_IDENTITY for 1.0, or -1 if out of tables.
+static int compile_sens_table(profile_compiled_t* c, analog_scale_t* sens_values, analog_scale_t sens)
+{
+    if (sens == ANALOG_SCALE_ONE) return PROFILE_SENS_IDENTITY;
+
+    for (uint8_t i = 0; i < c->sens_count; i++) {
+        if (sens_values[i] == sens) return i;
+    }
+    if (c->sens_count >= PROFILE_MAX_SENS_TABLES) return -1;
+
+    uint8_t index = c->sens_count++;
+    sens_values[index] = sens;
+
+    // Same arithmetic as the interpreted path, evaluated once per value
+    for (int v = 0; v < 256; v++) {
+        c->sens_lut[index][v] = analog_scale_stick((uint8_t)v, sens);
+    }
+    return index;
+}
+
+static bool compile_modifiers(profile_compiled_t* c, analog_scale_t* sens_values,
+                              const stick_modifier_t* mods, uint8_t count,
+                              compiled_modifier_t* out)
+{
+    if (count > PROFILE_MAX_STICK_MODIFIERS) return false;
+
+    for (uint8_t i = 0; i < count; i++) {
+        int table = compile_sens_table(c, sens_values, mods[i].sensitivity);
+        if (table < 0) return false;
+        out[i].trigger = mods[i].trigger;
+        out[i].consumed = mods[i].consume_trigger ? mods[i].trigger : 0;
+        out[i].table = (uint8_t)table;
+    }
+    return true;
+}
+
+static bool compile_analog_target(analog_target_t target, uint8_t custom, compiled_analog_t* out)
+{
+    switch (target) {
+        case ANALOG_TARGET_LX_MIN:    out->axis = PROFILE_AXIS_LX; out->value = 0;      break;
+        case ANALOG_TARGET_LX_MAX:    out->axis = PROFILE_AXIS_LX; out->value = 255;    break;
+        case ANALOG_TARGET_LY_MIN:    out->axis = PROFILE_AXIS_LY; out->value = 0;      break;
+        case ANALOG_TARGET_LY_MAX:    out->axis = PROFILE_AXIS_LY; out->value = 255;    break;
+        case ANALOG_TARGET_RX_MIN:    out->axis = PROFILE_AXIS_RX; out->value = 0;      break;
+        case ANALOG_TARGET_RX_MAX:    out->axis = PROFILE_AXIS_RX; out->value = 255;    break;
+        case ANALOG_TARGET_RY_MIN:    out->axis = PROFILE_AXIS_RY; out->value = 0;      break;
+        case ANALOG_TARGET_RY_MAX:    out->axis = PROFILE_AXIS_RY; out->value = 255;    break;
+        case ANALOG_TARGET_L2_FULL:   out->axis = PROFILE_AXIS_L2; out->value = 255;    break;
+        case ANALOG_TARGET_R2_FULL:   out->axis = PROFILE_AXIS_R2; out->value = 255;    break;
+        case ANALOG_TARGET_L2_CUSTOM: out->axis = PROFILE_AXIS_L2; out->value = custom; break;
+        case ANALOG_TARGET_R2_CUSTOM: out->axis = PROFILE_AXIS_R2; out->value = custom; break;
+        case ANALOG_TARGET_NONE:
+        default:
+            return false;
+    }
+    return true;
+}
+
+static bool compile_profile(profile_compiled_t* c, const profile_t* p)
+{
+    analog_scale_t sens_values[PROFILE_MAX_SENS_TABLES];
+
+    memset(c, 0, sizeof(*c));
+    c->source = p;
+
+    // Combos
+    if (p->combo_map && p->combo_map_count > 0) {
+        if (p->combo_map_count > MAX_BUTTON_COMBOS) return false;
+        for (uint8_t i = 0; i < p->combo_map_count; i++) {
+            const button_combo_entry_t* combo = &p->combo_map[i];
+            c->combos[i].inputs = combo->inputs;
+            c->combos[i].output = combo->output;
+            c->combos[i].consumed = combo->consume_inputs ? combo->inputs : 0;
+            c->combos[i].exclusive = combo->exclusive;
+        }
+        c->combo_count = p->combo_map_count;
+    }
+
+    c->has_map = (p->button_map && p->button_map_count > 0);
+    if (!c->has_map) {
+        c->valid = true;
+        return true;
+    }
+
+    // Button map: per-bit output masks, folded into nibble tables
+    uint32_t bit_output[32];
+    uint32_t mapped_inputs = 0;
+    memset(bit_output, 0, sizeof(bit_output));
+
+    for (uint8_t i = 0; i < p->button_map_count; i++) {
+        const button_map_entry_t* entry = &p->button_map[i];
+
+        // An entry fires when any of its input bits is pressed
+        for (uint8_t bit = 0; bit < 32; bit++) {
+            if (entry->input & (1u << bit)) {
+                bit_output[bit] |= entry->output;
+            }
+        }
+        mapped_inputs |= entry->input;
+
+        if (entry->analog != ANALOG_TARGET_NONE) {
+            compiled_analog_t* action = &c->analog[c->analog_count];
+            if (c->analog_count >= MAX_BUTTON_MAPPINGS) return false;
+            if (compile_analog_target(entry->analog, entry->analog_value, action)) {
+                action->mask = entry->input;
+                c->analog_count++;
+            }
+        }
+    }
+
+    // Unmapped buttons pass through as themselves
+    for (uint8_t bit = 0; bit < 32; bit++) {
+        if (!(mapped_inputs & (1u << bit))) {
+            bit_output[bit] = 1u << bit;
+        }
+    }
+
+    for (uint8_t nibble = 0; nibble < 8; nibble++) {
+        for (uint8_t v = 0; v < 16; v++) {
+            uint32_t out = 0;
+            for (uint8_t b = 0; b < 4; b++) {
+                if (v & (1u << b)) out |= bit_output[nibble * 4 + b];
+            }
+            c->button_lut[nibble][v] = out;
+        }
+    }
+
+    // Stick sensitivity tables
+    int table = compile_sens_table(c, sens_values, p->left_stick_sensitivity);
+    if (table < 0) return false;
+    c->left_table = (uint8_t)table;
+
+    table = compile_sens_table(c, sens_values, p->right_stick_sensitivity);
+    if (table < 0) return false;
+    c->right_table = (uint8_t)table;
+
+    if (!compile_modifiers(c, sens_values, p->left_stick_modifiers,
+                           p->left_stick_modifier_count, c->left_mods)) return false;
+    c->left_mod_count = p->left_stick_modifier_count;
+
+    if (!compile_modifiers(c, sens_values, p->right_stick_modifiers,
+                           p->right_stick_modifier_count, c->right_mods)) return false;
+    c->right_mod_count = p->right_stick_modifier_count;
+
+    // Triggers
+    c->l2_behavior = (uint8_t)p->l2_behavior;
+    c->r2_behavior = (uint8_t)p->r2_behavior;
+    c->l2_analog_value = p->l2_analog_value;
+    c->r2_analog_value = p->r2_analog_value;
+
+    c->valid = true;
+    return true;
+}
+
+// ============================================================================
+// CACHE
+// ============================================================================
+
+// Cached slot for profile on this core, or NULL
+static profile_compiled_t* cache_find(uint32_t core, const profile_t* profile)
+{
+    profile_compiled_t* slots = compiled_cache[core];
+
+    // Fast path: same profile as last time
+    profile_compiled_t* c = &slots[compiled_mru[core]];
+    if (c->source == profile) return c;
+
+    // Recency only changes when the MRU slot changes, so stamp it here
+    for (uint8_t i = 0; i < PROFILE_COMPILED_SLOTS; i++) {
+        if (slots[i].source == profile) {
+            slots[i].last_used = ++compiled_clock[core];
+            compiled_mru[core] = i;
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+// Compile profile into this core's least recently used slot
+static void cache_fill(uint32_t core, const profile_t* profile)
+{
+    profile_compiled_t* slots = compiled_cache[core];
+    profile_compiled_t* victim = &slots[0];
+
+    for (uint8_t i = 1; i < PROFILE_COMPILED_SLOTS; i++) {
+        if (!victim->source) break;
+        if (!slots[i].source || slots[i].last_used < victim->last_used) {
+            victim = &slots[i];
+        }
+    }
+
+    if (!compile_profile(victim, profile)) {
+        printf("[profile] %s exceeds compile limits, using interpreted path\n",
+               profile->name ? profile->name : "(unnamed)");
+    }
+    victim->last_used = ++compiled_clock[core];
+    compiled_mru[core] = (uint8_t)(victim - slots);
+}
+
+void profile_compile(const profile_t* profile)
+{
+    if (!profile) return;
+
+    uint32_t core = get_core_num() % PROFILE_COMPILE_CORES;
+    if (!cache_find(core, profile)) {
+        cache_fill(core, profile);
+    }
+}
+
+void profile_compile_switch(const profile_t* from, const profile_t* to)
+{
+    switch_to = NULL;
+    switch_from = from;
+    switch_to = to;
+    profile_compile(to);
+}
+
+const profile_compiled_t* __not_in_flash_func(profile_get_compiled)(const profile_t* profile)
+{
+    if (!profile) return NULL;
+
+    uint32_t core = get_core_num() % PROFILE_COMPILE_CORES;
+    const profile_compiled_t* c = cache_find(core, profile);
+    if (!c) {
+        // Not compiled on this core yet (the owning output compiles it outside
+        // its response loop); keep serving the profile it replaced
+        const profile_t* from = switch_from;
+        if (switch_to != profile || !from) return NULL;
+        c = cache_find(core, from);
+        if (!c) return NULL;
+    }
+    return c->valid ? c : NULL;
+}
+
+// ============================================================================
+// COMPILED APPLY
+// ============================================================================
+
+static inline uint8_t select_sens_table(const compiled_modifier_t* mods, uint8_t count,
+                                        uint8_t base, uint32_t input_buttons, uint32_t* buttons)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        if (input_buttons & mods[i].trigger) {
+            *buttons &= ~mods[i].consumed;
+            return mods[i].table;  // First matching modifier wins
+        }
+    }
+    return base;
+}
+
+static inline uint8_t apply_trigger(uint8_t behavior, uint8_t value, uint8_t custom, bool pressed)
+{
+    switch (behavior) {
+        case TRIGGER_DIGITAL_ONLY:
+            return 0;
+        case TRIGGER_FULL_PRESS:
+            return pressed ? 255 : value;
+        case TRIGGER_LIGHT_PRESS:
+            return pressed ? custom : value;
+        default:
+            return value;
+    }
+}
+
+void __not_in_flash_func(profile_apply_compiled)(const profile_compiled_t* c,
+                                                 uint32_t input_buttons,
+                                                 uint8_t lx, uint8_t ly,
+                                                 uint8_t rx, uint8_t ry,
+                                                 uint8_t l2, uint8_t r2,
+                                                 profile_output_t* output)
+{
+    if (profile_switch_combo_active()) {
+        input_buttons &= ~PROFILE_SWITCH_COMBO_MASK;
+    }
+
+    uint8_t axes[PROFILE_AXIS_COUNT] = { lx, ly, rx, ry, l2, r2 };
+    uint8_t overrides = 0;
+    uint32_t buttons;
+
+    if (!c->has_map) {
+        // Combos + passthrough
+        uint32_t consumed = 0;
+        buttons = input_buttons;
+        for (uint8_t i = 0; i < c->combo_count; i++) {
+            const compiled_combo_t* combo = &c->combos[i];
+            if ((input_buttons & combo->inputs) != combo->inputs) continue;
+            if (combo->exclusive && input_buttons != combo->inputs) continue;
+            buttons |= combo->output;
+            consumed |= combo->consumed;
+        }
+        buttons &= ~consumed;
+    } else {
+        // Mapped buttons replace combo results (matches the interpreted path)
+        const uint32_t (*lut)[16] = c->button_lut;
+        buttons = lut[0][input_buttons & 0xF]         | lut[1][(input_buttons >> 4) & 0xF] |
+                  lut[2][(input_buttons >> 8) & 0xF]  | lut[3][(input_buttons >> 12) & 0xF] |
+                  lut[4][(input_buttons >> 16) & 0xF] | lut[5][(input_buttons >> 20) & 0xF] |
+                  lut[6][(input_buttons >> 24) & 0xF] | lut[7][input_buttons >> 28];
+
+        // Button → analog actions, in table order (later entries win)
+        for (uint8_t i = 0; i < c->analog_count; i++) {
+            if (input_buttons & c->analog[i].mask) {
+                axes[c->analog[i].axis] = c->analog[i].value;
+                overrides |= 1u << c->analog[i].axis;
+            }
+        }
+
+        uint8_t left = select_sens_table(c->left_mods, c->left_mod_count, c->left_table,
+                                         input_buttons, &buttons);
+        uint8_t right = select_sens_table(c->right_mods, c->right_mod_count, c->right_table,
+                                          input_buttons, &buttons);
+
+        if (left != PROFILE_SENS_IDENTITY) {
+            const uint8_t* table = c->sens_lut[left];
+            if (!(overrides & (1u << PROFILE_AXIS_LX))) axes[PROFILE_AXIS_LX] = table[axes[PROFILE_AXIS_LX]];
+            if (!(overrides & (1u << PROFILE_AXIS_LY))) axes[PROFILE_AXIS_LY] = table[axes[PROFILE_AXIS_LY]];
+        }
+        if (right != PROFILE_SENS_IDENTITY) {
+            const uint8_t* table = c->sens_lut[right];
+            if (!(overrides & (1u << PROFILE_AXIS_RX))) axes[PROFILE_AXIS_RX] = table[axes[PROFILE_AXIS_RX]];
+            if (!(overrides & (1u << PROFILE_AXIS_RY))) axes[PROFILE_AXIS_RY] = table[axes[PROFILE_AXIS_RY]];
+        }
+
+        if (!(overrides & (1u << PROFILE_AXIS_L2))) {
+            axes[PROFILE_AXIS_L2] = apply_trigger(c->l2_behavior, axes[PROFILE_AXIS_L2],
+                                                  c->l2_analog_value, (input_buttons & JP_BUTTON_L2) != 0);
+        }
+        if (!(overrides & (1u << PROFILE_AXIS_R2))) {
+            axes[PROFILE_AXIS_R2] = apply_trigger(c->r2_behavior, axes[PROFILE_AXIS_R2],
+                                                  c->r2_analog_value, (input_buttons & JP_BUTTON_R2) != 0);
+        }
+    }
+
+    memset(output, 0, sizeof(profile_output_t));
+    output->buttons = buttons;
+    output->left_x = axes[PROFILE_AXIS_LX];
+    output->left_y = axes[PROFILE_AXIS_LY];
+    output->right_x = axes[PROFILE_AXIS_RX];
+    output->right_y = axes[PROFILE_AXIS_RY];
+    output->l2_analog = axes[PROFILE_AXIS_L2];
+    output->r2_analog = axes[PROFILE_AXIS_R2];
+    output->left_x_override = (overrides & (1u << PROFILE_AXIS_LX)) != 0;
+    output->left_y_override = (overrides & (1u << PROFILE_AXIS_LY)) != 0;
+    output->right_x_override = (overrides & (1u << PROFILE_AXIS_RX)) != 0;
+    output->right_y_override = (overrides & (1u << PROFILE_AXIS_RY)) != 0;
+    output->l2_analog_override = (overrides & (1u << PROFILE_AXIS_L2)) != 0;
+    output->r2_analog_override = (overrides & (1u << PROFILE_AXIS_R2)) != 0;
+}
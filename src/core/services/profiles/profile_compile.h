@@ -0,0 +1,128 @@
+// profile_compile.h - Compiled profile form for the per-report hot path
+//
+// profile_apply() used to walk combo_map/button_map and do float stick
+// scaling on every report. A compiled profile replaces that with:
+//   - nibble lookup tables giving the mapped output mask for any input
+//   - flat combo masks
+//   - 256-entry stick sensitivity tables (no float math per report)
+// Profiles are compiled and cached per core, so a slot is only ever written
+// by the core that reads it. The hot path never compiles: each output calls
+// profile_compile() for its profile outside its response loop (housekeeping
+// or task hook), and until then a switched-to profile is served from the
+// table of the profile it replaced.
+
+#ifndef CORE_PROFILE_COMPILE_H
+#define CORE_PROFILE_COMPILE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "profile.h"
+
+// ============================================================================
+// LIMITS
+// ============================================================================
+// Profiles beyond these limits stay on the interpreted path.
+
+// Each slot is a profile_compiled_t, about 1.9 KB (mostly button_lut and
+// sens_lut), and both cores get their own slots: 1 slot costs ~3.9 KB of
+// SRAM, 2 slots ~7.8 KB. One slot per core covers the usual single output
+// profile. Apps that apply two different profiles on the same core (e.g.
+// two output targets) should set 2, or each switch recompiles the tables.
+#ifndef PROFILE_COMPILED_SLOTS
+#define PROFILE_COMPILED_SLOTS 1        // Cached compiled profiles per core
+#endif
+#define PROFILE_MAX_SENS_TABLES 4       // Distinct stick sensitivities (besides 1.0)
+#define PROFILE_MAX_STICK_MODIFIERS 4   // Modifiers per stick
+#define PROFILE_SENS_IDENTITY 0xFF      // Sensitivity 1.0 - no table lookup
+
+// ============================================================================
+// COMPILED PROFILE
+// ============================================================================
+
+// Axis indices used by compiled analog actions
+typedef enum {
+    PROFILE_AXIS_LX = 0,
+    PROFILE_AXIS_LY,
+    PROFILE_AXIS_RX,
+    PROFILE_AXIS_RY,
+    PROFILE_AXIS_L2,
+    PROFILE_AXIS_R2,
+    PROFILE_AXIS_COUNT,
+} profile_axis_t;
+
+typedef struct {
+    uint32_t inputs;            // All must be pressed
+    uint32_t output;            // Added when active
+    uint32_t consumed;          // Removed when active (inputs or 0)
+    bool exclusive;             // Inputs must be the only buttons pressed
+} compiled_combo_t;
+
+typedef struct {
+    uint32_t mask;              // Any of these pressed fires the action
+    uint8_t axis;               // profile_axis_t
+    uint8_t value;              // Forced analog value
+} compiled_analog_t;
+
+typedef struct {
+    uint32_t trigger;           // Button that activates the modifier
+    uint32_t consumed;          // Removed from output when active (trigger or 0)
+    uint8_t table;              // Sensitivity table index or PROFILE_SENS_IDENTITY
+} compiled_modifier_t;
+
+typedef struct {
+    const profile_t* source;    // Profile this was compiled from (cache key)
+    uint32_t last_used;         // LRU stamp
+    bool valid;                 // False if the profile exceeds compile limits
+
+    bool has_map;               // button_map present (else combos + passthrough only)
+    uint8_t combo_count;
+    uint8_t analog_count;
+    uint8_t left_mod_count;
+    uint8_t right_mod_count;
+    uint8_t left_table;         // Base left stick sensitivity table
+    uint8_t right_table;        // Base right stick sensitivity table
+    uint8_t sens_count;
+
+    uint8_t l2_behavior;        // trigger_behavior_t
+    uint8_t r2_behavior;
+    uint8_t l2_analog_value;
+    uint8_t r2_analog_value;
+
+    compiled_combo_t combos[MAX_BUTTON_COMBOS];
+    compiled_analog_t analog[MAX_BUTTON_MAPPINGS];
+    compiled_modifier_t left_mods[PROFILE_MAX_STICK_MODIFIERS];
+    compiled_modifier_t right_mods[PROFILE_MAX_STICK_MODIFIERS];
+
+    // Output buttons for each input nibble (mapped outputs + unmapped passthrough)
+    uint32_t button_lut[8][16];
+
+    // Stick value → scaled stick value, one table per distinct sensitivity
+    uint8_t sens_lut[PROFILE_MAX_SENS_TABLES][256];
+} profile_compiled_t;
+
+// ============================================================================
+// API
+// ============================================================================
+
+// Compile profile into the calling core's cache unless already cached
+// (outputs call this outside their timing-critical loop)
+void profile_compile(const profile_t* profile);
+
+// Record a profile switch and compile the new profile on the calling core
+void profile_compile_switch(const profile_t* from, const profile_t* to);
+
+// Get compiled form for profile from the calling core's cache. Never
+// compiles: on a miss returns the table of the profile it replaced (last
+// profile_compile_switch()) if cached, else NULL.
+// Returns NULL if profile is NULL or exceeds compile limits
+const profile_compiled_t* profile_get_compiled(const profile_t* profile);
+
+// Apply a compiled profile (same results as profile_apply_interpreted)
+void profile_apply_compiled(const profile_compiled_t* compiled,
+                            uint32_t input_buttons,
+                            uint8_t lx, uint8_t ly,
+                            uint8_t rx, uint8_t ry,
+                            uint8_t l2, uint8_t r2,
+                            profile_output_t* output);
+
+#endif // CORE_PROFILE_COMPILE_H
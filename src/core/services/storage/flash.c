@@ -1,6 +1,8 @@
 // core/services/storage/flash.c - Persistent settings storage in flash memory
 
 #include "core/services/storage/flash.h"
+#include "core/services/storage/flash_log.h"
+#include "core/services/storage/flash_window.h"
 #include "pico/stdlib.h"
 #include "hardware/flash.h"
 #include "hardware/sync.h"
@@ -24,37 +26,154 @@ static void flush_output(void)
 
 // Flash memory layout
 // - RP2040 flash is memory-mapped at XIP_BASE (0x10000000)
-// - We use the last 4KB sector for settings storage
+// - The SDK's BTstack TLV bank (pico_btstack_flash_bank) defaults to the
+//   last 2 sectors (PICO_FLASH_BANK_STORAGE_OFFSET)
+// - Settings are an append-only log (flash_log.c) over FLASH_LOG_SECTORS
+//   sectors directly below that bank
+// - The last sector held the settings before the log; it is read once for
+//   migration and otherwise left alone
 // - Flash writes require erasing entire 4KB sectors
 // - Flash writes must be 256-byte aligned
 
-#define SETTINGS_MAGIC 0x47435052  // "GCPR" - GameCube Profile
 #define FLASH_TARGET_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
 #define SAVE_DEBOUNCE_MS 5000  // Wait 5 seconds after last change before writing
 
+#ifndef FLASH_LOG_SECTORS
+#define FLASH_LOG_SECTORS 4
+#endif
+#define FLASH_BT_BANK_SIZE (FLASH_SECTOR_SIZE * 2)
+#define FLASH_BT_BANK_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_BT_BANK_SIZE)
+#define FLASH_LOG_OFFSET (FLASH_BT_BANK_OFFSET - FLASH_LOG_SECTORS * FLASH_SECTOR_SIZE)
+
 // Pending save state
 static bool save_pending = false;
 static absolute_time_t last_change_time;
 static flash_t pending_settings;
 
+// Settings log and its RAM image
+static void flash_io_erase(uint32_t offset);
+static void flash_io_program(uint32_t offset, const uint8_t* data, uint32_t len);
+
+static const flash_log_io_t flash_io = {
+    .base = (const uint8_t*)(XIP_BASE + FLASH_LOG_OFFSET),
+    .sector_size = FLASH_SECTOR_SIZE,
+    .sectors = FLASH_LOG_SECTORS,
+    .erase = flash_io_erase,
+    .program = flash_io_program,
+};
+
+static flash_log_t settings_log;
+static flash_t settings_image;
+static bool settings_mounted = false;
+
+// Console quiet time from the active output (NULL = no console timing)
+static uint32_t (*quiet_source)(void) = NULL;
+
+// Cost of writing pending_settings, worked out once it is due
+static flash_log_plan_t pending_plan;
+static bool pending_planned = false;
+
+// When the pending save became due (or its erase step ran); kept across
+// changes that restart the debounce, so waiting for a window is bounded
+static absolute_time_t wait_start;
+static bool waiting = false;
+
+// ============================================================================
+// FLASH ACCESS
+// ============================================================================
+
+typedef struct {
+    uint32_t offset;        // From the start of flash
+    const uint8_t* data;    // NULL = erase one sector
+    uint32_t len;
+} flash_op_t;
+
+// Flash operation executed in RAM (safe from XIP conflicts)
+static void __no_inline_not_in_flash_func(flash_op_worker)(void* param)
+{
+    const flash_op_t* op = (const flash_op_t*)param;
+    if (op->data) {
+        flash_range_program(op->offset, op->data, op->len);
+    } else {
+        flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+    }
+}
+
+static void flash_run(flash_op_t* op)
+{
+    // Try flash_safe_execute first (handles multicore safely)
+    int result = flash_safe_execute(flash_op_worker, op, UINT32_MAX);
+
+    if (result != PICO_OK) {
+        printf("[flash] flash_safe_execute failed (%d), trying direct write...\n", result);
+        flush_output();
+
+        // Fallback: direct flash write with interrupts disabled
+        // Safe when Core 1 is not running or not accessing flash
+        uint32_t ints = save_and_disable_interrupts();
+        flash_op_worker(op);
+        restore_interrupts(ints);
+    }
+}
+
+static void flash_io_erase(uint32_t offset)
+{
+    flash_op_t op = { FLASH_LOG_OFFSET + offset, NULL, 0 };
+    flash_run(&op);
+}
+
+static void flash_io_program(uint32_t offset, const uint8_t* data, uint32_t len)
+{
+    flash_op_t op = { FLASH_LOG_OFFSET + offset, data, len };
+    flash_run(&op);
+}
+
+// Mount the log once; without one, start from the pre-log settings sector
+static void flash_mount(void)
+{
+    if (settings_mounted) {
+        return;
+    }
+    settings_mounted = true;
+
+    if (flash_log_mount(&settings_log, &flash_io, (uint8_t*)&settings_image, sizeof(flash_t))) {
+        printf("[flash] Settings log: sector %d, seq %lu, %lu bytes used\n",
+               settings_log.active, (unsigned long)settings_log.seq,
+               (unsigned long)settings_log.head);
+        return;
+    }
+
+    const flash_t* legacy = (const flash_t*)(XIP_BASE + FLASH_TARGET_OFFSET);
+    if (legacy->magic == FLASH_MAGIC_V1) {
+        printf("[flash] Migrating settings from single-sector layout\n");
+        memcpy(&settings_image, legacy, sizeof(flash_t));
+    } else {
+        memset(&settings_image, 0, sizeof(flash_t));
+    }
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
 void flash_init(void)
 {
     save_pending = false;
+    flash_mount();
 }
 
 // Load settings from flash (returns true if valid settings found)
 bool flash_load(flash_t* settings)
 {
-    // Flash is memory-mapped at XIP_BASE, so we can read it directly
-    const flash_t* flash_settings = (const flash_t*)(XIP_BASE + FLASH_TARGET_OFFSET);
+    flash_mount();
 
-    // Validate magic number
-    if (flash_settings->magic != SETTINGS_MAGIC) {
+    // Validate magic number (either layout; settings.c migrates)
+    if (settings_image.magic != FLASH_MAGIC && settings_image.magic != FLASH_MAGIC_V1) {
         return false;  // No valid settings in flash
     }
 
-    // Copy settings from flash to RAM
-    memcpy(settings, flash_settings, sizeof(flash_t));
+    // Copy settings from the log's RAM image
+    memcpy(settings, &settings_image, sizeof(flash_t));
     return true;
 }
 
@@ -63,76 +182,108 @@ void flash_save(const flash_t* settings)
 {
     // Store settings and mark as pending
     memcpy(&pending_settings, settings, sizeof(flash_t));
-    pending_settings.magic = SETTINGS_MAGIC;  // Ensure magic is set
+    pending_settings.magic = FLASH_MAGIC;  // Ensure magic is set
     save_pending = true;
+    pending_planned = false;
     last_change_time = get_absolute_time();
 }
 
-// Flash write function executed in RAM (safe from XIP conflicts)
-static void __no_inline_not_in_flash_func(flash_write_worker)(void* param)
-{
-    flash_t* write_settings = (flash_t*)param;
-
-    // Erase the settings sector (4KB)
-    flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
-
-    // Write settings (must be 256-byte aligned)
-    flash_range_program(FLASH_TARGET_OFFSET, (const uint8_t*)write_settings, FLASH_PAGE_SIZE);
-}
-
-// Force immediate save (bypasses debouncing - use sparingly)
-void flash_save_now(const flash_t* settings)
+// Append the image to the log; nothing is printed until the write is done,
+// so a scheduled write starts inside the window it was given
+static void flash_write(const flash_t* settings)
 {
     // Use static to ensure it persists during flash operations
     static flash_t write_settings;
     memcpy(&write_settings, settings, sizeof(flash_t));
-    write_settings.magic = SETTINGS_MAGIC;
+    write_settings.magic = FLASH_MAGIC;
 
-    printf("[flash] Saving to flash at offset 0x%X...\n", FLASH_TARGET_OFFSET);
-    printf("[flash] magic=0x%08X, profile=%d, usb_mode=%d\n",
-           write_settings.magic, write_settings.active_profile_index,
-           write_settings.usb_output_mode);
-    flush_output();  // Flush debug output before flash operation
-
-    // Try flash_safe_execute first (handles multicore safely)
-    int result = flash_safe_execute(flash_write_worker, &write_settings, UINT32_MAX);
-
-    if (result != PICO_OK) {
-        printf("[flash] flash_safe_execute failed (%d), trying direct write...\n", result);
-        flush_output();
+    // Appends only the changed bytes; compacts into the spare sector when full
+    uint32_t compactions = settings_log.stats.compactions;
+    bool ok = flash_log_append(&settings_log, (const uint8_t*)&write_settings);
 
-        // Fallback: direct flash write with interrupts disabled
-        // Safe when Core 1 is not running or not accessing flash
-        uint32_t ints = save_and_disable_interrupts();
-        flash_range_erase(FLASH_TARGET_OFFSET, FLASH_SECTOR_SIZE);
-        flash_range_program(FLASH_TARGET_OFFSET, (const uint8_t*)&write_settings, FLASH_PAGE_SIZE);
-        restore_interrupts(ints);
+    save_pending = false;
+    pending_planned = false;
+    waiting = false;
+    last_change_time = get_absolute_time();
 
-        printf("[flash] Direct write complete\n");
+    if (ok) {
+        printf("[flash] Write complete (sector %d, %lu bytes used%s)\n",
+               settings_log.active, (unsigned long)settings_log.head,
+               settings_log.stats.compactions != compactions ? ", compacted" : "");
     } else {
-        printf("[flash] Write complete\n");
+        printf("[flash] Write FAILED\n");
     }
+    printf("[flash] Verify: magic=0x%08X, schema=%d\n", settings_image.magic, settings_image.schema);
+}
 
-    // Verify the write
-    const flash_t* verify = (const flash_t*)(XIP_BASE + FLASH_TARGET_OFFSET);
-    printf("[flash] Verify: magic=0x%08X, profile=%d, usb_mode=%d\n",
-           verify->magic, verify->active_profile_index, verify->usb_output_mode);
+// Force immediate save (bypasses debouncing - use sparingly)
+void flash_save_now(const flash_t* settings)
+{
+    flash_mount();
+    printf("[flash] Saving to settings log at offset 0x%X...\n", FLASH_LOG_OFFSET);
+    printf("[flash] magic=0x%08X, schema=%d\n", FLASH_MAGIC, settings->schema);
+    flush_output();  // Flush debug output before flash operation
+
+    flash_write(settings);
     flush_output();
+}
 
-    save_pending = false;
+void flash_set_quiet_source(uint32_t (*quiet_us)(void))
+{
+    quiet_source = quiet_us;
 }
 
 // Task function to handle debounced flash writes (call from main loop)
+// Erases and writes run as separate steps, each when the console leaves a
+// long enough gap between polls (flash_window.h)
 void flash_task(void)
 {
-    if (!save_pending) {
+    absolute_time_t now = get_absolute_time();
+    int64_t time_since_change = absolute_time_diff_us(last_change_time, now);
+
+    // Let settings settle before writing, or erasing ahead of the next save
+    if (time_since_change < (SAVE_DEBOUNCE_MS * 1000) || (!save_pending && !settings_mounted)) {
+        return;
+    }
+
+    if (save_pending && !pending_planned) {
+        flash_mount();
+        flash_log_plan(&settings_log, (const uint8_t*)&pending_settings, &pending_plan);
+        pending_planned = true;
+    }
+    if (save_pending && !waiting) {
+        waiting = true;
+        wait_start = now;
+    }
+
+    bool erase_pending = flash_log_erase_pending(&settings_log);
+    if (!save_pending && !erase_pending) {
         return;
     }
 
-    // Check if debounce time has elapsed
-    int64_t time_since_change = absolute_time_diff_us(last_change_time, get_absolute_time());
-    if (time_since_change >= (SAVE_DEBOUNCE_MS * 1000)) {
-        // Debounce period elapsed - perform the write
-        flash_save_now(&pending_settings);
+    uint32_t quiet_us = quiet_source ? quiet_source() : FLASH_WINDOW_FOREVER;
+    int64_t waited_us = waiting ? absolute_time_diff_us(wait_start, now) : 0;
+    uint32_t waited = waited_us > UINT32_MAX ? UINT32_MAX : (uint32_t)waited_us;
+    switch (flash_window_step(save_pending, &pending_plan, erase_pending, quiet_us, waited)) {
+        case FLASH_STEP_ERASE:
+            flash_log_erase_spare(&settings_log);
+            pending_planned = false;
+            wait_start = get_absolute_time();  // The write gets its own wait
+            if (quiet_us < FLASH_WINDOW_ERASE_US) {
+                printf("[flash] No quiet window for %lu ms, erased anyway\n",
+                       (unsigned long)(waited / 1000));
+            }
+            break;
+
+        case FLASH_STEP_WRITE:
+            if (quiet_us < (uint32_t)pending_plan.pages * FLASH_WINDOW_PAGE_US) {
+                printf("[flash] No quiet window for %lu ms, writing anyway\n",
+                       (unsigned long)(waited / 1000));
+            }
+            flash_write(&pending_settings);
+            break;
+
+        default:
+            break;
     }
 }
@@ -1,6 +1,7 @@
 // core/services/storage/flash.h - Persistent settings storage in flash memory
 //
-// Stores user settings (like active profile index) in the last sector of flash.
+// Stores user settings (like active profile index) in an append-only log near
+// the end of flash (see flash_log.h): a save writes only the changed bytes.
 // Settings persist across power cycles and firmware updates (unless flash is erased).
 
 #ifndef FLASH_H
@@ -9,27 +10,48 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Image magic: identifies the layout of the image
+#define FLASH_MAGIC     0x3253504A  // "JPS2" - key-value records (settings.c)
+#define FLASH_MAGIC_V1  0x47435052  // "GCPR" - fixed fields (flash_v1_t)
+
 // Settings structure stored in flash
 typedef struct {
-    uint32_t magic;              // Validation magic number (0x47435052 = "GCPR")
-    uint8_t active_profile_index; // Currently selected profile (0-N)
-    uint8_t usb_output_mode;     // USB device output mode (0=HID, 1=XboxOG, etc.)
-    uint8_t reserved[250];        // Reserved for future settings (padding to 256 bytes)
+    uint32_t magic;              // Validation magic number (FLASH_MAGIC)
+    uint8_t schema;              // Record schema version (SETTINGS_SCHEMA)
+    uint8_t reserved[3];
+    uint8_t data[248];           // Key-value records, see settings.h (padding to 256 bytes)
 } flash_t;
 
+// First layout (FLASH_MAGIC_V1), read only for migration
+typedef struct {
+    uint32_t magic;
+    uint8_t active_profile_index; // Selected profile (same for every output)
+    uint8_t usb_output_mode;     // USB device output mode (0=HID, 1=XboxOG, etc.)
+    uint8_t usb_poll_interval;   // USB device poll interval override (0=mode default, 1/2/4/8 ms)
+} flash_v1_t;
+
 // Initialize flash settings system
 void flash_init(void);
 
-// Load settings from flash (returns true if valid settings found)
+// Load settings from flash (returns true if valid settings found; check
+// magic for the layout)
 bool flash_load(flash_t* settings);
 
 // Save settings to flash (debounced - actual write happens after delay)
+// Saved images are stamped FLASH_MAGIC
 void flash_save(const flash_t* settings);
 
 // Force immediate save (bypasses debouncing - use sparingly)
 void flash_save_now(const flash_t* settings);
 
 // Task function to handle debounced flash writes (call from main loop)
+// Also erases the log's spare sector ahead of time when allowed
 void flash_task(void);
 
+// Outputs whose console polls must not be stalled by flash work register
+// how long the console is expected to stay quiet (usually
+// flash_window_quiet_us()); flash_task() only starts an erase or write
+// that fits. NULL = no console timing, write when due.
+void flash_set_quiet_source(uint32_t (*quiet_us)(void));
+
 #endif // FLASH_H
@@ -0,0 +1,403 @@
+// core/services/storage/flash_log.c - Append-only settings log over flash sectors
+
+#include "core/services/storage/flash_log.h"
+#include "core/crc.h"
+#include <string.h>
+
+#define SECTOR_MAGIC    0x474C504A  // "JPLG"
+#define RECORD_TAG      0xA5
+#define SEGMENT_HEADER  3           // offset (2), length (1)
+#define MAX_SEGMENT     (FLASH_LOG_MAX_PAYLOAD - SEGMENT_HEADER)
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static uint16_t rd16(const uint8_t* p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t rd32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void wr16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void wr32(uint8_t* p, uint32_t v)
+{
+    wr16(p, (uint16_t)v);
+    wr16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t crc16_buf(uint16_t crc, const uint8_t* data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        crc = crc16_update(crc, data[i]);
+    }
+    return crc;
+}
+
+static uint32_t sector_offset(const flash_log_t* log, uint8_t sector)
+{
+    return (uint32_t)sector * log->io->sector_size;
+}
+
+static uint8_t spare_sector(const flash_log_t* log)
+{
+    return log->mounted ? (uint8_t)((log->active + 1) % log->io->sectors) : 0;
+}
+
+static bool is_blank(const uint8_t* p, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Program len bytes at offset through whole-page writes (0xFF elsewhere in
+// the page leaves already programmed bytes alone), then read them back
+static bool write_bytes(flash_log_t* log, uint32_t offset, const uint8_t* data, uint32_t len)
+{
+    const flash_log_io_t* io = log->io;
+    uint32_t done = 0;
+
+    while (done < len) {
+        uint32_t page_start = (offset + done) & ~(uint32_t)(FLASH_LOG_PAGE_SIZE - 1);
+        uint32_t in_page = (offset + done) - page_start;
+        uint32_t chunk = FLASH_LOG_PAGE_SIZE - in_page;
+        if (chunk > len - done) {
+            chunk = len - done;
+        }
+
+        memset(log->page, 0xFF, sizeof(log->page));
+        memcpy(&log->page[in_page], data + done, chunk);
+        io->program(page_start, log->page, FLASH_LOG_PAGE_SIZE);
+        log->stats.pages++;
+        done += chunk;
+    }
+
+    log->stats.bytes += len;
+    return memcmp(io->base + offset, data, len) == 0;
+}
+
+// ============================================================================
+// RECORDS
+// ============================================================================
+
+// Encode the bytes of next that differ from old (NULL = all zero) as
+// segments, starting at *cursor. Runs separated by fewer unchanged bytes
+// than a segment header are merged. Stops when the payload is full, leaving
+// *cursor at the first byte not encoded (state_size when done).
+static uint16_t encode_segments(const uint8_t* old, const uint8_t* next, uint16_t size,
+                                uint16_t* cursor, uint8_t* out)
+{
+    uint16_t n = 0;
+    uint16_t i = *cursor;
+
+    while (i < size) {
+        if ((old ? old[i] : 0) == next[i]) {
+            i++;
+            continue;
+        }
+
+        uint16_t start = i;
+        uint16_t end = i + 1;
+        for (uint16_t j = i + 1; j < size && j - start < MAX_SEGMENT; j++) {
+            if ((old ? old[j] : 0) != next[j]) {
+                end = j + 1;
+            } else if (j + 1 - end > SEGMENT_HEADER) {
+                break;
+            }
+        }
+
+        uint16_t len = end - start;
+        if (n + SEGMENT_HEADER + len > FLASH_LOG_MAX_PAYLOAD) {
+            break;
+        }
+        wr16(&out[n], start);
+        out[n + 2] = (uint8_t)len;
+        memcpy(&out[n + SEGMENT_HEADER], &next[start], len);
+        n += SEGMENT_HEADER + len;
+        i = end;
+    }
+
+    *cursor = i;
+    return n;
+}
+
+static void finish_record(uint8_t* rec, uint16_t payload_len)
+{
+    rec[0] = RECORD_TAG;
+    rec[1] = (uint8_t)payload_len;
+    wr16(&rec[2], crc16_buf(crc16_update(0, rec[1]), &rec[FLASH_LOG_RECORD_HEADER], payload_len));
+}
+
+static bool record_valid(const uint8_t* rec, uint32_t room)
+{
+    if (rec[0] != RECORD_TAG || FLASH_LOG_RECORD_HEADER + rec[1] > room) {
+        return false;
+    }
+    uint16_t crc = crc16_buf(crc16_update(0, rec[1]), &rec[FLASH_LOG_RECORD_HEADER], rec[1]);
+    if (rd16(&rec[2]) != crc) {
+        return false;
+    }
+
+    // Segments must tile the payload exactly
+    const uint8_t* p = &rec[FLASH_LOG_RECORD_HEADER];
+    uint16_t pos = 0;
+    while (pos < rec[1]) {
+        if (pos + SEGMENT_HEADER > rec[1] || pos + SEGMENT_HEADER + p[pos + 2] > rec[1]) {
+            return false;
+        }
+        pos += SEGMENT_HEADER + p[pos + 2];
+    }
+    return true;
+}
+
+static void apply_record(flash_log_t* log, const uint8_t* rec)
+{
+    const uint8_t* p = &rec[FLASH_LOG_RECORD_HEADER];
+    uint16_t pos = 0;
+    while (pos < rec[1]) {
+        uint16_t offset = rd16(&p[pos]);
+        uint8_t len = p[pos + 2];
+        // Bytes past the image belong to a larger (newer) layout
+        if (offset < log->state_size) {
+            uint16_t n = (offset + len > log->state_size) ? log->state_size - offset : len;
+            memcpy(&log->state[offset], &p[pos + SEGMENT_HEADER], n);
+        }
+        pos += SEGMENT_HEADER + len;
+    }
+}
+
+// ============================================================================
+// SECTORS
+// ============================================================================
+
+static bool header_valid(const flash_log_t* log, uint8_t sector, uint32_t* seq)
+{
+    const uint8_t* h = log->io->base + sector_offset(log, sector);
+    if (rd32(h) != SECTOR_MAGIC || rd16(&h[8]) != crc16_buf(0, h, 8)) {
+        return false;
+    }
+    *seq = rd32(&h[4]);
+    return true;
+}
+
+// Replay the active sector's records into the image and find the head. A
+// damaged record ends the log; the sector is then treated as full so the
+// next save compacts into a clean one.
+static void replay(flash_log_t* log)
+{
+    const uint32_t size = log->io->sector_size;
+    const uint8_t* s = log->io->base + sector_offset(log, log->active);
+    uint32_t pos = FLASH_LOG_HEADER_SIZE;
+
+    memset(log->state, 0, log->state_size);
+    while (pos + FLASH_LOG_RECORD_HEADER <= size) {
+        if (s[pos] == 0xFF) {
+            break;
+        }
+        if (!record_valid(&s[pos], size - pos)) {
+            log->stats.torn++;
+            log->head = size;
+            return;
+        }
+        apply_record(log, &s[pos]);
+        pos += FLASH_LOG_RECORD_HEADER + s[pos + 1];
+    }
+
+    // Anything programmed after the last record is a torn write
+    if (!is_blank(&s[pos], size - pos)) {
+        log->stats.torn++;
+        log->head = size;
+        return;
+    }
+    log->head = pos;
+}
+
+// Write the whole image as a snapshot into the spare sector, header last
+static bool compact(flash_log_t* log, const uint8_t* next)
+{
+    const flash_log_io_t* io = log->io;
+    uint8_t target = spare_sector(log);
+    uint32_t base = sector_offset(log, target);
+    uint8_t rec[FLASH_LOG_RECORD_HEADER + FLASH_LOG_MAX_PAYLOAD];
+
+    if (!log->spare_erased || !is_blank(io->base + base, io->sector_size)) {
+        io->erase(base);
+        log->stats.erases++;
+        log->stats.inline_erases++;
+    }
+    log->spare_erased = false;
+
+    uint32_t pos = FLASH_LOG_HEADER_SIZE;
+    uint16_t cursor = 0;
+    while (cursor < log->state_size) {
+        uint16_t len = encode_segments(NULL, next, log->state_size, &cursor, &rec[FLASH_LOG_RECORD_HEADER]);
+        if (len == 0) {
+            break;
+        }
+        if (pos + FLASH_LOG_RECORD_HEADER + len > io->sector_size) {
+            return false;  // Image larger than a sector
+        }
+        finish_record(rec, len);
+        if (!write_bytes(log, base + pos, rec, FLASH_LOG_RECORD_HEADER + len)) {
+            return false;
+        }
+        pos += FLASH_LOG_RECORD_HEADER + len;
+    }
+
+    uint8_t header[FLASH_LOG_HEADER_SIZE];
+    memset(header, 0xFF, sizeof(header));
+    wr32(&header[0], SECTOR_MAGIC);
+    wr32(&header[4], log->seq + 1);
+    wr16(&header[8], crc16_buf(0, header, 8));
+    if (!write_bytes(log, base, header, sizeof(header))) {
+        return false;
+    }
+
+    log->mounted = true;
+    log->active = target;
+    log->seq++;
+    log->head = pos;
+    memcpy(log->state, next, log->state_size);
+    log->stats.compactions++;
+
+    uint8_t spare = spare_sector(log);
+    log->spare_erased = is_blank(io->base + sector_offset(log, spare), io->sector_size);
+    return true;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+bool flash_log_mount(flash_log_t* log, const flash_log_io_t* io,
+                     uint8_t* state, uint16_t state_size)
+{
+    memset(log, 0, sizeof(*log));
+    log->io = io;
+    log->state = state;
+    log->state_size = state_size;
+
+    bool found = false;
+    for (uint8_t s = 0; s < io->sectors; s++) {
+        uint32_t seq;
+        if (header_valid(log, s, &seq) && (!found || (int32_t)(seq - log->seq) > 0)) {
+            found = true;
+            log->active = s;
+            log->seq = seq;
+        }
+    }
+
+    if (found) {
+        log->mounted = true;
+        replay(log);
+    }
+
+    uint8_t spare = spare_sector(log);
+    log->spare_erased = is_blank(io->base + sector_offset(log, spare), io->sector_size);
+    return found;
+}
+
+bool flash_log_append(flash_log_t* log, const uint8_t* next)
+{
+    uint8_t rec[FLASH_LOG_RECORD_HEADER + FLASH_LOG_MAX_PAYLOAD];
+    uint16_t cursor = 0;
+    uint16_t len = encode_segments(log->state, next, log->state_size, &cursor,
+                                   &rec[FLASH_LOG_RECORD_HEADER]);
+    if (len == 0 && cursor >= log->state_size) {
+        return true;  // Nothing changed
+    }
+
+    // Too many changes for one record, or no room: start a new sector
+    if (!log->mounted || cursor < log->state_size ||
+        log->head + FLASH_LOG_RECORD_HEADER + len > log->io->sector_size) {
+        return compact(log, next);
+    }
+
+    finish_record(rec, len);
+    if (!write_bytes(log, sector_offset(log, log->active) + log->head, rec,
+                     FLASH_LOG_RECORD_HEADER + len)) {
+        // Bad bytes in the tail: move the image to a clean sector
+        log->head = log->io->sector_size;
+        return compact(log, next);
+    }
+
+    log->head += FLASH_LOG_RECORD_HEADER + len;
+    memcpy(log->state, next, log->state_size);
+    log->stats.appends++;
+    return true;
+}
+
+// Page programs write_bytes() makes for len bytes at offset
+static uint16_t pages_spanned(uint32_t offset, uint32_t len)
+{
+    uint32_t first = offset / FLASH_LOG_PAGE_SIZE;
+    uint32_t last = (offset + len - 1) / FLASH_LOG_PAGE_SIZE;
+    return (uint16_t)(last - first + 1);
+}
+
+void flash_log_plan(const flash_log_t* log, const uint8_t* next, flash_log_plan_t* plan)
+{
+    uint8_t payload[FLASH_LOG_MAX_PAYLOAD];
+    uint16_t cursor = 0;
+    uint16_t len = encode_segments(log->state, next, log->state_size, &cursor, payload);
+
+    memset(plan, 0, sizeof(*plan));
+    if (len == 0 && cursor >= log->state_size) {
+        return;
+    }
+
+    // Same decision as flash_log_append()
+    if (log->mounted && cursor >= log->state_size &&
+        log->head + FLASH_LOG_RECORD_HEADER + len <= log->io->sector_size) {
+        plan->pages = pages_spanned(log->head, FLASH_LOG_RECORD_HEADER + len);
+        return;
+    }
+
+    plan->compact = true;
+    plan->erase = !log->spare_erased;
+
+    // Snapshot records one by one, then the header page
+    uint32_t pos = FLASH_LOG_HEADER_SIZE;
+    cursor = 0;
+    while (cursor < log->state_size) {
+        len = encode_segments(NULL, next, log->state_size, &cursor, payload);
+        if (len == 0) {
+            break;
+        }
+        plan->pages += pages_spanned(pos, FLASH_LOG_RECORD_HEADER + len);
+        pos += FLASH_LOG_RECORD_HEADER + len;
+    }
+    plan->pages++;
+}
+
+bool flash_log_erase_pending(const flash_log_t* log)
+{
+    return !log->spare_erased;
+}
+
+void flash_log_erase_spare(flash_log_t* log)
+{
+    if (log->spare_erased) {
+        return;
+    }
+
+    uint32_t offset = sector_offset(log, spare_sector(log));
+    if (!is_blank(log->io->base + offset, log->io->sector_size)) {
+        log->io->erase(offset);
+        log->stats.erases++;
+    }
+    log->spare_erased = true;
+}
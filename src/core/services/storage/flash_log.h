@@ -0,0 +1,110 @@
+// core/services/storage/flash_log.h - Append-only settings log over flash sectors
+//
+// Settings used to live in one sector that was erased and reprogrammed on
+// every save. The log instead keeps a RAM image of the settings and appends
+// a small record holding only the bytes that changed:
+//
+//   sector:  header (magic, sequence, crc) | record | record | ... | 0xFF
+//   record:  tag, payload length, crc16 | segments (offset, length, bytes)
+//
+// Records are programmed into the erased tail of a page (NOR flash only
+// clears bits, so the 0xFF bytes around a record leave the page as it was).
+// When the active sector is full the current image is compacted into the
+// next sector as a snapshot, and that sector's header is programmed last:
+// until it is, the old sector stays the newest valid one. Sectors are used
+// in turn, so wear is spread over all of them.
+//
+// Power loss: a torn record fails its crc and is dropped on mount, along
+// with anything after it; a torn compaction has no header and is ignored.
+// Either way the image is the one before the interrupted save.
+//
+// The sector after the active one (the spare) is erased ahead of time by
+// flash_log_erase_spare(), which the caller runs when erasing is harmless.
+// A compaction then only programs. If the spare is not ready it is erased
+// inline.
+//
+// Flash access goes through flash_log_io_t, so this runs on the host
+// against a simulated flash (see bench/checks/flash_log.c).
+
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Program granularity (RP2040: flash_range_program() takes whole pages)
+#define FLASH_LOG_PAGE_SIZE     256
+
+// Largest settings image (segment offsets are 16-bit)
+#define FLASH_LOG_MAX_STATE     1024
+
+// Sector header size; records start right after it
+#define FLASH_LOG_HEADER_SIZE   12
+
+// Record header size and largest payload
+#define FLASH_LOG_RECORD_HEADER 4
+#define FLASH_LOG_MAX_PAYLOAD   255
+
+typedef struct {
+    const uint8_t* base;        // Log region, readable in place (XIP on target)
+    uint32_t sector_size;
+    uint8_t sectors;            // At least 2
+
+    // Offsets are relative to base. erase: one whole sector. program: whole
+    // pages, page aligned, data in RAM.
+    void (*erase)(uint32_t offset);
+    void (*program)(uint32_t offset, const uint8_t* data, uint32_t len);
+} flash_log_io_t;
+
+typedef struct {
+    uint32_t appends;           // Records written
+    uint32_t compactions;       // Snapshots into a new sector
+    uint32_t erases;            // Sector erases (spare + inline)
+    uint32_t inline_erases;     // Erases a compaction had to do itself
+    uint32_t pages;             // Page programs
+    uint32_t bytes;             // Record and snapshot bytes written
+    uint32_t torn;              // Damaged records or headers found on mount
+} flash_log_stats_t;
+
+typedef struct {
+    const flash_log_io_t* io;
+    uint8_t* state;             // RAM image (caller's buffer)
+    uint16_t state_size;
+
+    bool mounted;               // A valid sector exists
+    uint8_t active;             // Sector holding the newest records
+    uint32_t seq;               // Its sequence number
+    uint32_t head;              // Next free byte in the active sector
+    bool spare_erased;          // Sector after active is blank
+
+    uint8_t page[FLASH_LOG_PAGE_SIZE];  // Program buffer (RAM)
+    flash_log_stats_t stats;
+} flash_log_t;
+
+// Find the newest valid sector and replay its records into state. Returns
+// false (state untouched) if the region holds no log yet.
+bool flash_log_mount(flash_log_t* log, const flash_log_io_t* io,
+                     uint8_t* state, uint16_t state_size);
+
+// Write the bytes of next that differ from the current image and make next
+// the current image. Returns false if the flash could not be written (the
+// image is left as it was).
+bool flash_log_append(flash_log_t* log, const uint8_t* next);
+
+// Flash work the next flash_log_append() of next would do, so a caller can
+// wait for a moment when it is harmless (see flash_window.h)
+typedef struct {
+    uint16_t pages;             // Page programs (0 = nothing changed)
+    bool compact;               // Snapshot into the spare sector
+    bool erase;                 // ...which must be erased first
+} flash_log_plan_t;
+
+void flash_log_plan(const flash_log_t* log, const uint8_t* next, flash_log_plan_t* plan);
+
+// True if the spare sector still needs erasing
+bool flash_log_erase_pending(const flash_log_t* log);
+
+// Erase the spare sector now (one sector erase, or none if already blank)
+void flash_log_erase_spare(flash_log_t* log);
+
+#endif // FLASH_LOG_H
@@ -0,0 +1,130 @@
+// core/services/storage/flash_window.c - Quiet windows for flash writes
+
+#include "core/services/storage/flash_window.h"
+#include "pico/stdlib.h"
+
+// ============================================================================
+// POLL HISTORY (core 1)
+// ============================================================================
+
+void __not_in_flash_func(flash_window_poll)(flash_window_t* w, uint32_t now_us)
+{
+    uint32_t gap = now_us - w->last_us;
+
+    w->seq++;
+    if (!w->started || gap >= FLASH_WINDOW_IDLE_US) {
+        // First poll, or polling resumed: old gaps no longer apply
+        w->started = true;
+        w->count = 0;
+    } else if (gap >= FLASH_WINDOW_BURST_US) {
+        w->gaps[w->count % FLASH_WINDOW_HISTORY] = gap;
+        w->count++;
+    }
+    w->last_us = now_us;
+    w->seq++;
+}
+
+// ============================================================================
+// PREDICTION (core 0)
+// ============================================================================
+
+static bool gaps_match(uint32_t a, uint32_t b)
+{
+    uint32_t diff = a > b ? a - b : b - a;
+    uint32_t tolerance = (a > b ? a : b) / 8;
+    return diff <= (tolerance > 200 ? tolerance : 200);
+}
+
+// Next gap from the history (oldest first)
+static uint32_t predict_gap(const uint32_t* gaps, uint32_t n)
+{
+    for (uint32_t k = 1; k <= FLASH_WINDOW_MAX_CYCLE && 2 * k <= n; k++) {
+        bool cycle = true;
+        for (uint32_t i = k; i < n && cycle; i++) {
+            cycle = gaps_match(gaps[i], gaps[i - k]);
+        }
+        if (!cycle) {
+            continue;
+        }
+
+        // The next gap sits k back in the cycle
+        uint32_t next = UINT32_MAX;
+        for (int i = (int)(n - k); i >= 0; i -= (int)k) {
+            if (gaps[i] < next) next = gaps[i];
+        }
+        return next;
+    }
+
+    uint32_t next = UINT32_MAX;
+    for (uint32_t i = 0; i < n; i++) {
+        if (gaps[i] < next) next = gaps[i];
+    }
+    return next;
+}
+
+uint32_t flash_window_quiet_us(const flash_window_t* w, uint32_t now_us)
+{
+    uint32_t gaps[FLASH_WINDOW_HISTORY];
+    uint32_t last, count, seq;
+    bool started;
+
+    // Copy a consistent snapshot (core 1 may be mid-update)
+    do {
+        seq = w->seq;
+        started = w->started;
+        last = w->last_us;
+        count = w->count;
+        for (uint32_t i = 0; i < FLASH_WINDOW_HISTORY; i++) {
+            gaps[i] = w->gaps[i];
+        }
+    } while ((seq & 1) || seq != w->seq);
+
+    if (!started) {
+        return FLASH_WINDOW_FOREVER;
+    }
+    uint32_t elapsed = now_us - last;
+    if (elapsed >= FLASH_WINDOW_IDLE_US) {
+        return FLASH_WINDOW_FOREVER;
+    }
+    if (elapsed < FLASH_WINDOW_BURST_US || count < FLASH_WINDOW_MIN_GAPS) {
+        return 0;  // Mid-burst, or no pattern yet
+    }
+
+    // Unroll the ring, oldest first
+    uint32_t n = count < FLASH_WINDOW_HISTORY ? count : FLASH_WINDOW_HISTORY;
+    uint32_t ordered[FLASH_WINDOW_HISTORY];
+    for (uint32_t i = 0; i < n; i++) {
+        ordered[i] = gaps[(count - n + i) % FLASH_WINDOW_HISTORY];
+    }
+
+    uint32_t next = predict_gap(ordered, n);
+    if (elapsed + FLASH_WINDOW_GUARD_US >= next) {
+        return 0;  // Poll due
+    }
+    return next - elapsed - FLASH_WINDOW_GUARD_US;
+}
+
+// ============================================================================
+// SCHEDULING
+// ============================================================================
+
+flash_step_t flash_window_step(bool save_due, const flash_log_plan_t* plan,
+                               bool erase_pending, uint32_t quiet_us, uint32_t waited_us)
+{
+    bool overdue = waited_us >= FLASH_WINDOW_MAX_WAIT_MS * 1000u;
+
+    if (save_due) {
+        // A compaction into an unerased sector erases first, as its own step
+        if (plan->erase) {
+            return (quiet_us >= FLASH_WINDOW_ERASE_US || overdue) ? FLASH_STEP_ERASE : FLASH_STEP_NONE;
+        }
+        uint32_t cost = (uint32_t)plan->pages * FLASH_WINDOW_PAGE_US;
+        return (quiet_us >= cost || overdue) ? FLASH_STEP_WRITE : FLASH_STEP_NONE;
+    }
+
+    // Erasing ahead is never urgent
+    if (erase_pending && quiet_us >= FLASH_WINDOW_ERASE_US) {
+        return FLASH_STEP_ERASE;
+    }
+    return FLASH_STEP_NONE;
+}
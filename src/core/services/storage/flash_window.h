@@ -0,0 +1,85 @@
+// core/services/storage/flash_window.h - Quiet windows for flash writes
+//
+// Erasing or programming flash stops core 1: flash_safe_execute() parks it
+// for the whole operation, and core 1 runs the console protocol loops. A
+// console poll that arrives meanwhile goes unanswered. A page program takes
+// under a millisecond, a sector erase tens of milliseconds.
+//
+// Outputs feed their console polls into a flash_window_t from the core that
+// answers them, and register flash_window_quiet_us() with
+// flash_set_quiet_source(). flash_task() then runs the spare sector erase
+// and each save's page programs as separate steps, each only when the
+// console is expected to stay quiet long enough (flash_window_step()).
+//
+// Prediction: polls less than FLASH_WINDOW_BURST_US apart are one burst (a
+// PCE scan clocks several reads). The gaps between bursts repeat every
+// frame, possibly as a cycle of several gaps (a game polling twice a
+// frame). The shortest cycle of up to FLASH_WINDOW_MAX_CYCLE gaps that
+// matches the history gives the next gap: the smallest one seen at that
+// position. Without a cycle the smallest recent gap is used.
+//
+// A sector can't be erased in smaller pieces, and a console polling every
+// frame never leaves a window long enough for it. The erase is done ahead
+// of need whenever the console pauses (boot, reset, menus that stop
+// polling); a save that needs it sooner waits up to FLASH_WINDOW_MAX_WAIT_MS
+// and then erases anyway, missing a few polls.
+
+#ifndef FLASH_WINDOW_H
+#define FLASH_WINDOW_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/services/storage/flash_log.h"
+
+// Operation costs, including the core 1 lockout (W25Q16: page program
+// 0.4-0.8 ms, 4 KB sector erase 45 ms typical)
+#define FLASH_WINDOW_PAGE_US    1000
+#define FLASH_WINDOW_ERASE_US   60000
+
+// Margin kept before a predicted poll
+#define FLASH_WINDOW_GUARD_US   300
+
+// Polls closer than this are one burst
+#define FLASH_WINDOW_BURST_US   1000
+
+// No poll for this long: console stopped, any operation fits
+#define FLASH_WINDOW_IDLE_US    500000
+
+// A due save stops waiting for a window after this long
+#define FLASH_WINDOW_MAX_WAIT_MS 30000
+
+#define FLASH_WINDOW_HISTORY    16      // Gaps kept
+#define FLASH_WINDOW_MAX_CYCLE  4       // Longest repeating gap pattern
+#define FLASH_WINDOW_MIN_GAPS   4       // Gaps needed before predicting
+
+// Quiet time when nothing polls
+#define FLASH_WINDOW_FOREVER    UINT32_MAX
+
+typedef struct {
+    volatile uint32_t seq;              // Odd while being updated
+    volatile uint32_t last_us;          // Last poll
+    volatile uint32_t count;            // Gaps recorded since polling (re)started
+    volatile bool started;
+    volatile uint32_t gaps[FLASH_WINDOW_HISTORY];   // Ring, by count
+} flash_window_t;
+
+typedef enum {
+    FLASH_STEP_NONE,                    // Wait
+    FLASH_STEP_ERASE,                   // Erase the spare sector
+    FLASH_STEP_WRITE,                   // Write the pending save
+} flash_step_t;
+
+// Record a console poll (core 1, from RAM)
+void flash_window_poll(flash_window_t* w, uint32_t now_us);
+
+// Microseconds the console is expected to stay quiet from now (0 = a poll
+// may come any moment, FLASH_WINDOW_FOREVER = not polling)
+uint32_t flash_window_quiet_us(const flash_window_t* w, uint32_t now_us);
+
+// Next flash step. save_due: a save is pending and debounced (plan is its
+// cost); waited_us: how long since it became due. erase_pending: the spare
+// sector is not blank yet.
+flash_step_t flash_window_step(bool save_due, const flash_log_plan_t* plan,
+                               bool erase_pending, uint32_t quiet_us, uint32_t waited_us);
+
+#endif // FLASH_WINDOW_H
@@ -0,0 +1,265 @@
+// settings.c - Typed key-value settings on top of flash storage
+
+#include "core/services/storage/settings.h"
+#include "core/services/storage/flash.h"
+#include <stdio.h>
+#include <string.h>
+
+// Record layout in flash_t.data
+#define RECORD_HEADER   3           // key, instance, length
+#define DATA_SIZE       sizeof(((flash_t*)0)->data)
+
+// Instances per key (0 = key unused). The per-output and per-player keys
+// come first; every key after them has a single instance.
+static const uint8_t key_instances[SETTING_KEY_COUNT] = {
+    [SETTING_PROFILE_INDEX]      = SETTINGS_MAX_OUTPUTS,
+    [SETTING_PLAYER_PROFILE]     = SETTINGS_MAX_PLAYERS,
+    [SETTING_USB_OUTPUT_MODE]    = 1,
+    [SETTING_USB_POLL_INTERVAL]  = 1,
+    [SETTING_3DO_OUTPUT_MODE]    = 1,
+    [SETTING_3DO_EXTENSION_MODE] = 1,
+};
+
+_Static_assert(SETTING_PROFILE_INDEX == SETTING_NONE + 1 &&
+               SETTING_PLAYER_PROFILE == SETTING_PROFILE_INDEX + 1 &&
+               SETTING_USB_OUTPUT_MODE == SETTING_PLAYER_PROFILE + 1,
+               "multi-instance keys must precede the single-instance keys");
+
+// Sum of key_instances, plus slot 0 (unused, slot_base starts at 1)
+#define SINGLE_INSTANCE_KEYS (SETTING_KEY_COUNT - SETTING_USB_OUTPUT_MODE)
+#define INDEX_SLOTS (1 + SETTINGS_MAX_OUTPUTS + SETTINGS_MAX_PLAYERS + SINGLE_INSTANCE_KEYS)
+
+static flash_t image;
+static bool loaded = false;
+static uint8_t slot_base[SETTING_KEY_COUNT];    // First index slot of each key
+static uint8_t slot_pos[INDEX_SLOTS];           // Record offset + 1 (0 = not stored)
+static uint16_t used;                           // Bytes of records in image.data
+
+// ============================================================================
+// INDEX
+// ============================================================================
+
+static int slot_of(setting_key_t key, uint8_t instance)
+{
+    if (key <= SETTING_NONE || key >= SETTING_KEY_COUNT || instance >= key_instances[key]) {
+        return -1;
+    }
+    return slot_base[key] + instance;
+}
+
+// One pass over the records: index known keys, find the end, cut off a
+// damaged tail
+static void build_index(void)
+{
+    memset(slot_pos, 0, sizeof(slot_pos));
+
+    uint16_t pos = 0;
+    while (pos + RECORD_HEADER <= DATA_SIZE && image.data[pos] != SETTING_NONE) {
+        const uint8_t* r = &image.data[pos];
+        if (pos + RECORD_HEADER + r[2] > DATA_SIZE) {
+            break;
+        }
+        int slot = slot_of((setting_key_t)r[0], r[1]);
+        if (slot >= 0) {
+            slot_pos[slot] = (uint8_t)(pos + 1);
+        }
+        pos += RECORD_HEADER + r[2];
+    }
+
+    used = pos;
+    memset(&image.data[used], 0, DATA_SIZE - used);
+}
+
+// ============================================================================
+// MIGRATION
+// ============================================================================
+
+static void append_record(setting_key_t key, uint8_t instance, const void* value, uint8_t len)
+{
+    if (used + RECORD_HEADER + len > DATA_SIZE) {
+        return;
+    }
+    uint8_t* r = &image.data[used];
+    r[0] = (uint8_t)key;
+    r[1] = instance;
+    r[2] = len;
+    memcpy(&r[RECORD_HEADER], value, len);
+    used += RECORD_HEADER + len;
+}
+
+// Fixed-field layout: one profile index for every output, USB mode, poll
+static void migrate_v1(void)
+{
+    flash_v1_t v1;
+    memcpy(&v1, &image, sizeof(v1));
+
+    memset(&image, 0, sizeof(image));
+    used = 0;
+    for (uint8_t i = 0; i < SETTINGS_MAX_OUTPUTS; i++) {
+        append_record(SETTING_PROFILE_INDEX, i, &v1.active_profile_index, 1);
+    }
+    append_record(SETTING_USB_OUTPUT_MODE, 0, &v1.usb_output_mode, 1);
+    if (v1.usb_poll_interval) {
+        append_record(SETTING_USB_POLL_INTERVAL, 0, &v1.usb_poll_interval, 1);
+    }
+    image.magic = FLASH_MAGIC;
+    image.schema = 1;
+}
+
+// Bring the image up to SETTINGS_SCHEMA; returns true if it changed
+static bool migrate(void)
+{
+    bool changed = false;
+
+    if (image.magic == FLASH_MAGIC_V1) {
+        printf("[settings] Migrating fixed-field settings to schema 1\n");
+        migrate_v1();
+        changed = true;
+    }
+
+    // Later schemas step forward from here: case N upgrades N to N+1
+    switch (image.schema) {
+        case SETTINGS_SCHEMA:
+        default:
+            break;  // Current, or newer (unknown keys are kept)
+    }
+
+    return changed;
+}
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+void settings_init(void)
+{
+    if (!loaded) {
+        settings_load();
+    }
+}
+
+void settings_load(void)
+{
+    loaded = true;
+
+    uint8_t slot = 1;
+    for (int k = SETTING_NONE + 1; k < SETTING_KEY_COUNT; k++) {
+        slot_base[k] = slot;
+        slot += key_instances[k];
+    }
+
+    if (!flash_load(&image)) {
+        memset(&image, 0, sizeof(image));
+        image.magic = FLASH_MAGIC;
+        image.schema = SETTINGS_SCHEMA;
+    }
+
+    bool migrated = migrate();
+    build_index();
+    printf("[settings] Schema %d, %d of %d bytes used\n", image.schema, used, (int)DATA_SIZE);
+
+    if (migrated) {
+        flash_save(&image);
+    }
+}
+
+bool settings_get(setting_key_t key, uint8_t instance, void* value, uint8_t len)
+{
+    settings_init();
+
+    int slot = slot_of(key, instance);
+    if (slot < 0 || slot_pos[slot] == 0) {
+        return false;
+    }
+    const uint8_t* r = &image.data[slot_pos[slot] - 1];
+    if (r[2] != len) {
+        return false;
+    }
+    memcpy(value, &r[RECORD_HEADER], len);
+    return true;
+}
+
+uint8_t settings_get_u8(setting_key_t key, uint8_t instance, uint8_t fallback)
+{
+    uint8_t value;
+    return settings_get(key, instance, &value, 1) ? value : fallback;
+}
+
+// Remove a record, closing the gap and shifting the index
+static void remove_record(int slot)
+{
+    uint16_t pos = slot_pos[slot] - 1;
+    uint16_t size = RECORD_HEADER + image.data[pos + 2];
+
+    memmove(&image.data[pos], &image.data[pos + size], used - pos - size);
+    used -= size;
+    memset(&image.data[used], 0, size);
+
+    slot_pos[slot] = 0;
+    for (int i = 0; i < INDEX_SLOTS; i++) {
+        if (slot_pos[i] > pos + 1) {
+            slot_pos[i] -= size;
+        }
+    }
+}
+
+bool settings_set(setting_key_t key, uint8_t instance, const void* value, uint8_t len)
+{
+    settings_init();
+
+    int slot = slot_of(key, instance);
+    if (slot < 0) {
+        return false;
+    }
+
+    if (slot_pos[slot]) {
+        uint8_t* r = &image.data[slot_pos[slot] - 1];
+        if (r[2] == len) {
+            if (memcmp(&r[RECORD_HEADER], value, len) == 0) {
+                return true;  // Unchanged, nothing to write
+            }
+            // Same size: update in place so only the value bytes change
+            memcpy(&r[RECORD_HEADER], value, len);
+            flash_save(&image);
+            return true;
+        }
+        remove_record(slot);
+    }
+
+    if (used + RECORD_HEADER + len > DATA_SIZE) {
+        printf("[settings] No room for key %d[%d] (%d bytes used)\n", key, instance, used);
+        return false;
+    }
+    slot_pos[slot] = (uint8_t)(used + 1);
+    append_record(key, instance, value, len);
+    flash_save(&image);
+    return true;
+}
+
+bool settings_set_u8(setting_key_t key, uint8_t instance, uint8_t value)
+{
+    return settings_set(key, instance, &value, 1);
+}
+
+void settings_clear(setting_key_t key, uint8_t instance)
+{
+    settings_init();
+
+    int slot = slot_of(key, instance);
+    if (slot < 0 || slot_pos[slot] == 0) {
+        return;
+    }
+    remove_record(slot);
+    flash_save(&image);
+}
+
+void settings_commit_now(void)
+{
+    settings_init();
+    flash_save_now(&image);
+}
+
+uint16_t settings_used(void)
+{
+    return used;
+}
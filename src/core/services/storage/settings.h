@@ -0,0 +1,70 @@
+// settings.h - Typed key-value settings on top of flash storage
+//
+// Settings are records in flash_t.data: key, instance, length, value. Keys
+// with per-output or per-player values store one record per instance
+// (instance = output target or player index). A RAM index maps every
+// (key, instance) to its record, so lookups are O(1); it is built in one
+// pass over the 248-byte image at boot.
+//
+// Changes update the RAM image and go through flash_save(), so a burst of
+// changes within SAVE_DEBOUNCE_MS is one commit, and the flash log only
+// writes the bytes that changed. A record that keeps its length is updated
+// in place for that reason.
+//
+// Records with keys this firmware doesn't know (written by a newer one) are
+// kept as they are. The image's schema byte versions the key set;
+// settings_init() migrates older images (including the fixed-field
+// FLASH_MAGIC_V1 layout) forward before building the index.
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Current record schema
+#define SETTINGS_SCHEMA 1
+
+// Instances for per-output and per-player keys
+#define SETTINGS_MAX_OUTPUTS 8      // MAX_OUTPUT_TARGETS
+#define SETTINGS_MAX_PLAYERS 8      // MAX_PLAYERS_PER_OUTPUT
+
+// Keys (values are stored in the record, never renumber)
+typedef enum {
+    SETTING_NONE = 0,               // End of records
+    SETTING_PROFILE_INDEX,          // u8, per output target: active profile
+    SETTING_PLAYER_PROFILE,         // u8, per player: profile index
+    SETTING_USB_OUTPUT_MODE,        // u8: USB device output mode
+    SETTING_USB_POLL_INTERVAL,      // u8: USB poll interval override (0 = mode default)
+    SETTING_3DO_OUTPUT_MODE,        // u8: 3DO normal / silly pad
+    SETTING_3DO_EXTENSION_MODE,     // u8: 3DO extension passthrough / managed
+    SETTING_KEY_COUNT
+} setting_key_t;
+
+// Load (and migrate) settings and build the index; safe to call again
+void settings_init(void);
+
+// Reload from flash, dropping changes not yet handed to flash_save()
+void settings_load(void);
+
+// Copy a value of exactly len bytes; false if not stored
+bool settings_get(setting_key_t key, uint8_t instance, void* value, uint8_t len);
+
+// u8 value, or fallback if not stored
+uint8_t settings_get_u8(setting_key_t key, uint8_t instance, uint8_t fallback);
+
+// Store a value and schedule a commit (debounced). False if the key or
+// instance is out of range or the image is full.
+bool settings_set(setting_key_t key, uint8_t instance, const void* value, uint8_t len);
+bool settings_set_u8(setting_key_t key, uint8_t instance, uint8_t value);
+
+// Drop a value (the default applies again)
+void settings_clear(setting_key_t key, uint8_t instance);
+
+// Write pending changes now (before a reset)
+void settings_commit_now(void);
+
+// Bytes of flash_t.data in use
+uint16_t settings_used(void);
+
+#endif // SETTINGS_H
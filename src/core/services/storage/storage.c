@@ -4,10 +4,12 @@
 
 #include "storage.h"
 #include "flash.h"
+#include "settings.h"
 
 void storage_init(void)
 {
     flash_init();
+    settings_init();
 }
 
 void storage_task(void)
@@ -0,0 +1,287 @@
+// uart_frame.c - Batched multi-player input frames for the UART bridge
+//
+// See uart_frame.h for the wire format. Both sides keep the last
+// UART_FRAME_HISTORY KEY/DELTA frames by sequence number; a DELTA frame is
+// only encoded against a frame the receiver acked, so sender and receiver
+// reconstruct the same state from it.
+
+#include "uart_frame.h"
+#include <string.h>
+
+#define HISTORY_MASK (UART_FRAME_HISTORY - 1)
+
+// ============================================================================
+// SHARED
+// ============================================================================
+
+void uart_frame_neutral(uart_input_event_t* event, uint8_t player_index)
+{
+    memset(event, 0, sizeof(*event));
+    event->player_index = player_index;
+    event->analog[0] = 128;
+    event->analog[1] = 128;
+    event->analog[2] = 128;
+    event->analog[3] = 128;
+}
+
+static void neutral_frame(uart_input_event_t* players)
+{
+    for (uint8_t p = 0; p < UART_FRAME_PLAYERS; p++) {
+        uart_frame_neutral(&players[p], p);
+    }
+}
+
+// Record layout matches uart_input_event_t from device_type onwards
+static inline const uint8_t* record_of(const uart_input_event_t* event)
+{
+    return (const uint8_t*)event + 1;
+}
+
+static uint8_t delta_fields(const uart_input_event_t* cur, const uart_input_event_t* base)
+{
+    uint8_t fields = 0;
+    if (cur->buttons != base->buttons) fields |= UART_FRAME_FIELD_BUTTONS;
+    for (uint8_t i = 0; i < 6; i++) {
+        if (cur->analog[i] != base->analog[i]) fields |= UART_FRAME_FIELD_ANALOG(i);
+    }
+    if (cur->device_type != base->device_type ||
+        cur->delta_x != base->delta_x || cur->delta_y != base->delta_y) {
+        fields |= UART_FRAME_FIELD_EXTRA;
+    }
+    return fields;
+}
+
+static inline int8_t add_delta(int8_t a, int8_t b)
+{
+    int16_t sum = (int16_t)a + b;
+    if (sum > 127) return 127;
+    if (sum < -128) return -128;
+    return (int8_t)sum;
+}
+
+// ============================================================================
+// ENCODER
+// ============================================================================
+
+void uart_frame_encoder_init(uart_frame_encoder_t* enc, bool acks)
+{
+    memset(enc, 0, sizeof(*enc));
+    neutral_frame(enc->current);
+    enc->acks = acks;
+}
+
+void uart_frame_encoder_update(uart_frame_encoder_t* enc, const uart_input_event_t* event)
+{
+    if (event->player_index >= UART_FRAME_PLAYERS) return;
+
+    uart_input_event_t* cur = &enc->current[event->player_index];
+    int8_t dx = add_delta(cur->delta_x, event->delta_x);
+    int8_t dy = add_delta(cur->delta_y, event->delta_y);
+    *cur = *event;
+    cur->delta_x = dx;
+    cur->delta_y = dy;
+
+    enc->dirty |= (uint8_t)(1u << event->player_index);
+    enc->active |= (uint8_t)(1u << event->player_index);
+}
+
+void uart_frame_encoder_ack(uart_frame_encoder_t* enc, uint8_t seq)
+{
+    uint8_t slot = seq & HISTORY_MASK;
+    uint8_t age = (uint8_t)(enc->seq - seq);
+
+    // Only frames still in history, and only forward
+    if (!(enc->history_valid & (1u << slot)) || enc->history_seq[slot] != seq) return;
+    if (age == 0 || age > UART_FRAME_HISTORY) return;
+    if (enc->base_valid && (int8_t)(seq - enc->base_seq) <= 0) return;
+
+    enc->base_seq = seq;
+    enc->base_valid = true;
+}
+
+bool uart_frame_encoder_unacked(const uart_frame_encoder_t* enc)
+{
+    if (!enc->acks || enc->frames == 0) return false;
+    return !enc->base_valid || enc->base_seq != (uint8_t)(enc->seq - 1);
+}
+
+uint8_t uart_frame_encode(uart_frame_encoder_t* enc, uint8_t* out)
+{
+    const uart_input_event_t* base = NULL;
+    uint8_t mask = enc->dirty;
+    uint8_t format = UART_FRAME_V1;
+
+    if (enc->acks) {
+        // A base is usable while its history slot can't have been reused
+        if (enc->base_valid && (uint8_t)(enc->seq - enc->base_seq) < UART_FRAME_HISTORY) {
+            base = enc->history[enc->base_seq & HISTORY_MASK];
+            for (uint8_t p = 0; p < UART_FRAME_PLAYERS; p++) {
+                if (memcmp(&enc->current[p], &base[p], sizeof(uart_input_event_t)) != 0) {
+                    mask |= (uint8_t)(1u << p);
+                }
+            }
+            format |= UART_FRAME_FLAG_DELTA;
+        } else {
+            mask |= enc->active;
+            format |= UART_FRAME_FLAG_KEY;
+        }
+    }
+    if (mask == 0) return 0;
+
+    uart_input_frame_header_t* hdr = (uart_input_frame_header_t*)out;
+    hdr->format = format;
+    hdr->seq = enc->seq;
+    hdr->base_seq = base ? enc->base_seq : 0;
+    hdr->player_mask = mask;
+    uint8_t len = UART_FRAME_HEADER_SIZE;
+
+    for (uint8_t p = 0; p < UART_FRAME_PLAYERS; p++) {
+        if (!(mask & (1u << p))) continue;
+        const uart_input_event_t* cur = &enc->current[p];
+
+        if (!base) {
+            memcpy(&out[len], record_of(cur), UART_FRAME_RECORD_SIZE);
+            len += UART_FRAME_RECORD_SIZE;
+            continue;
+        }
+
+        uint8_t fields = delta_fields(cur, &base[p]);
+        out[len++] = fields;
+        if (fields & UART_FRAME_FIELD_BUTTONS) {
+            memcpy(&out[len], &cur->buttons, sizeof(cur->buttons));
+            len += sizeof(cur->buttons);
+        }
+        for (uint8_t i = 0; i < 6; i++) {
+            if (fields & UART_FRAME_FIELD_ANALOG(i)) out[len++] = cur->analog[i];
+        }
+        if (fields & UART_FRAME_FIELD_EXTRA) {
+            out[len++] = cur->device_type;
+            out[len++] = (uint8_t)cur->delta_x;
+            out[len++] = (uint8_t)cur->delta_y;
+        }
+    }
+
+    if (enc->acks) {
+        uint8_t slot = enc->seq & HISTORY_MASK;
+        memcpy(enc->history[slot], enc->current, sizeof(enc->current));
+        enc->history_seq[slot] = enc->seq;
+        enc->history_valid |= (uint8_t)(1u << slot);
+        if (base) enc->delta_frames++;
+        else enc->keyframes++;
+    }
+
+    // Mouse motion has been handed to the receiver
+    for (uint8_t p = 0; p < UART_FRAME_PLAYERS; p++) {
+        enc->current[p].delta_x = 0;
+        enc->current[p].delta_y = 0;
+    }
+
+    enc->dirty = 0;
+    enc->seq++;
+    enc->frames++;
+    return len;
+}
+
+// ============================================================================
+// DECODER
+// ============================================================================
+
+void uart_frame_decoder_init(uart_frame_decoder_t* dec)
+{
+    memset(dec, 0, sizeof(*dec));
+    neutral_frame(dec->state);
+}
+
+bool uart_frame_decode(uart_frame_decoder_t* dec, const uint8_t* payload, uint8_t len,
+                       uart_frame_result_t* result)
+{
+    if (len < UART_FRAME_HEADER_SIZE) {
+        dec->errors++;
+        return false;
+    }
+
+    uart_input_frame_header_t hdr;
+    memcpy(&hdr, payload, sizeof(hdr));
+    if ((hdr.format & UART_FRAME_VERSION_MASK) != UART_FRAME_V1 ||
+        (hdr.format & UART_FRAME_FLAG_KEY && hdr.format & UART_FRAME_FLAG_DELTA)) {
+        dec->errors++;
+        return false;
+    }
+
+    bool delta = hdr.format & UART_FRAME_FLAG_DELTA;
+    bool stored = hdr.format & (UART_FRAME_FLAG_KEY | UART_FRAME_FLAG_DELTA);
+    uart_input_event_t next[UART_FRAME_PLAYERS];
+
+    if (delta) {
+        uint8_t slot = hdr.base_seq & HISTORY_MASK;
+        if (!(dec->history_valid & (1u << slot)) || dec->history_seq[slot] != hdr.base_seq) {
+            dec->missing_base++;
+            return false;
+        }
+        memcpy(next, dec->history[slot], sizeof(next));
+    } else if (stored) {
+        neutral_frame(next);
+    } else {
+        memcpy(next, dec->state, sizeof(next));
+    }
+
+    const uint8_t* p = payload + UART_FRAME_HEADER_SIZE;
+    const uint8_t* end = payload + len;
+
+    for (uint8_t player = 0; player < UART_FRAME_PLAYERS; player++) {
+        if (!(hdr.player_mask & (1u << player))) continue;
+        uart_input_event_t* ev = &next[player];
+
+        if (!delta) {
+            if (end - p < (int)UART_FRAME_RECORD_SIZE) goto malformed;
+            memcpy((uint8_t*)ev + 1, p, UART_FRAME_RECORD_SIZE);
+            p += UART_FRAME_RECORD_SIZE;
+            continue;
+        }
+
+        if (p >= end) goto malformed;
+        uint8_t fields = *p++;
+        uint8_t need = ((fields & UART_FRAME_FIELD_BUTTONS) ? 4 : 0) +
+                       ((fields & UART_FRAME_FIELD_EXTRA) ? 3 : 0);
+        for (uint8_t i = 0; i < 6; i++) {
+            if (fields & UART_FRAME_FIELD_ANALOG(i)) need++;
+        }
+        if (end - p < need) goto malformed;
+
+        if (fields & UART_FRAME_FIELD_BUTTONS) {
+            memcpy(&ev->buttons, p, sizeof(ev->buttons));
+            p += sizeof(ev->buttons);
+        }
+        for (uint8_t i = 0; i < 6; i++) {
+            if (fields & UART_FRAME_FIELD_ANALOG(i)) ev->analog[i] = *p++;
+        }
+        if (fields & UART_FRAME_FIELD_EXTRA) {
+            ev->device_type = *p++;
+            ev->delta_x = (int8_t)*p++;
+            ev->delta_y = (int8_t)*p++;
+        }
+    }
+    if (p != end) goto malformed;
+
+    for (uint8_t player = 0; player < UART_FRAME_PLAYERS; player++) {
+        next[player].player_index = player;
+    }
+    memcpy(dec->state, next, sizeof(next));
+
+    if (stored) {
+        uint8_t slot = hdr.seq & HISTORY_MASK;
+        memcpy(dec->history[slot], next, sizeof(next));
+        dec->history_seq[slot] = hdr.seq;
+        dec->history_valid |= (uint8_t)(1u << slot);
+    }
+
+    dec->frames++;
+    result->players = hdr.player_mask;
+    result->ack = stored;
+    result->seq = hdr.seq;
+    return true;
+
+malformed:
+    dec->errors++;
+    return false;
+}
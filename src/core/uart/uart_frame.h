@@ -0,0 +1,143 @@
+// uart_frame.h - Batched multi-player input frames for the UART bridge
+//
+// A UART_PKT_INPUT_FRAME carries every player that changed since the last
+// frame in one packet, instead of one UART_PKT_INPUT_EVENT per player.
+// Only sent once the peer advertises UART_FEATURE_INPUT_FRAME in its
+// UART_PKT_VERSION; older peers keep receiving input events.
+//
+// Payload:
+//   [FORMAT][SEQ][BASE_SEQ][PLAYER_MASK][record per set mask bit, in order]
+//
+//   FORMAT low nibble is the frame version (UART_FRAME_V1), high bits flags:
+//     (none)  Plain: records are absolute, players not in the mask keep
+//             their last received state. Nothing is acknowledged.
+//     KEY     Keyframe: records are absolute, players not in the mask are
+//             neutral. Receiver stores the result and acks SEQ.
+//     DELTA   Records are field-masked against the receiver's stored frame
+//             BASE_SEQ (a frame it acked). Receiver stores and acks SEQ.
+//
+//   Absolute record (13 bytes): uart_input_event_t without player_index.
+//   Delta record: [FIELDS] then the fields whose bit is set:
+//     BUTTONS (4 bytes), ANALOG(0..5) (1 byte each), EXTRA (device_type,
+//     delta_x, delta_y).
+//
+// Keyframes and delta frames need UART_FEATURE_FRAME_DELTA on both sides.
+// The sender falls back to a keyframe whenever it has no acked frame within
+// UART_FRAME_HISTORY, so lost frames or acks never leave the receiver stale.
+// Mouse deltas are per-frame: the sender clears them once a frame is built.
+
+#ifndef UART_FRAME_H
+#define UART_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/uart/uart_protocol.h"
+
+// ============================================================================
+// WIRE FORMAT
+// ============================================================================
+
+#define UART_FRAME_PLAYERS          8
+#define UART_FRAME_HISTORY          8       // Frames kept as delta bases (power of 2)
+
+#define UART_FRAME_V1               0x01
+#define UART_FRAME_VERSION_MASK     0x0F
+#define UART_FRAME_FLAG_KEY         0x10
+#define UART_FRAME_FLAG_DELTA       0x20
+
+#define UART_FRAME_FIELD_BUTTONS    0x01
+#define UART_FRAME_FIELD_ANALOG(n)  (0x02 << (n))   // n = 0..5
+#define UART_FRAME_FIELD_EXTRA      0x80
+
+typedef struct __attribute__((packed)) {
+    uint8_t  format;            // UART_FRAME_V1 | UART_FRAME_FLAG_*
+    uint8_t  seq;               // Frame sequence number
+    uint8_t  base_seq;          // Delta base (DELTA frames only)
+    uint8_t  player_mask;       // Players with a record
+} uart_input_frame_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  seq;               // Frame applied by the receiver
+} uart_input_frame_ack_t;
+
+#define UART_FRAME_HEADER_SIZE      sizeof(uart_input_frame_header_t)
+#define UART_FRAME_RECORD_SIZE      (sizeof(uart_input_event_t) - 1)
+#define UART_FRAME_MAX_PAYLOAD      (UART_FRAME_HEADER_SIZE + \
+                                     UART_FRAME_PLAYERS * (1 + UART_FRAME_RECORD_SIZE))
+
+_Static_assert(UART_FRAME_MAX_PAYLOAD <= UART_PROTOCOL_MAX_PAYLOAD,
+               "input frame must fit in one packet");
+_Static_assert((UART_FRAME_HISTORY & (UART_FRAME_HISTORY - 1)) == 0,
+               "UART_FRAME_HISTORY must be a power of 2");
+
+// ============================================================================
+// ENCODER (sender side)
+// ============================================================================
+
+typedef struct {
+    uart_input_event_t current[UART_FRAME_PLAYERS];     // Latest state per player
+    uint8_t dirty;              // Players updated since the last frame
+    uint8_t active;             // Players updated at least once
+    uint8_t seq;                // Next frame sequence number
+    bool acks;                  // Peer acks frames: send KEY/DELTA frames
+
+    bool base_valid;
+    uint8_t base_seq;           // Newest frame the peer acked
+    uint8_t history_valid;      // Bit per history slot
+    uint8_t history_seq[UART_FRAME_HISTORY];
+    uart_input_event_t history[UART_FRAME_HISTORY][UART_FRAME_PLAYERS];
+
+    uint32_t frames;
+    uint32_t keyframes;
+    uint32_t delta_frames;
+} uart_frame_encoder_t;
+
+// Reset to no players; acks selects KEY/DELTA (true) or plain frames
+void uart_frame_encoder_init(uart_frame_encoder_t* enc, bool acks);
+
+// Record a player's latest state. Mouse deltas accumulate until sent.
+void uart_frame_encoder_update(uart_frame_encoder_t* enc, const uart_input_event_t* event);
+
+// Peer acked a frame; newer acks move the delta base forward
+void uart_frame_encoder_ack(uart_frame_encoder_t* enc, uint8_t seq);
+
+// True if the newest frame hasn't been acked yet (KEY/DELTA mode only).
+// Encoding again without new updates resends whatever the peer may lack.
+bool uart_frame_encoder_unacked(const uart_frame_encoder_t* enc);
+
+// Build the next frame into out (UART_FRAME_MAX_PAYLOAD bytes): updated
+// players, plus in KEY/DELTA mode any player that differs from the acked
+// base. Returns the payload length, 0 if no player needs sending.
+uint8_t uart_frame_encode(uart_frame_encoder_t* enc, uint8_t* out);
+
+// ============================================================================
+// DECODER (receiver side)
+// ============================================================================
+
+typedef struct {
+    uart_input_event_t state[UART_FRAME_PLAYERS];       // Latest state per player
+    uint8_t history_valid;
+    uint8_t history_seq[UART_FRAME_HISTORY];
+    uart_input_event_t history[UART_FRAME_HISTORY][UART_FRAME_PLAYERS];
+
+    uint32_t frames;
+    uint32_t errors;            // Malformed or unknown-version frames
+    uint32_t missing_base;      // DELTA frames whose base isn't stored
+} uart_frame_decoder_t;
+
+typedef struct {
+    uint8_t players;            // Players whose state in dec->state is new
+    bool ack;                   // Send UART_PKT_INPUT_FRAME_ACK with seq
+    uint8_t seq;
+} uart_frame_result_t;
+
+void uart_frame_decoder_init(uart_frame_decoder_t* dec);
+
+// Apply a received frame. Returns false (state untouched) if it can't be used.
+bool uart_frame_decode(uart_frame_decoder_t* dec, const uint8_t* payload, uint8_t len,
+                       uart_frame_result_t* result);
+
+// State a keyframe gives players it doesn't carry
+void uart_frame_neutral(uart_input_event_t* event, uint8_t player_index);
+
+#endif // UART_FRAME_H
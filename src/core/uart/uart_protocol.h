@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "core/crc.h"
 
 // ============================================================================
 // UART CONFIGURATION
@@ -30,7 +31,10 @@
 
 #define UART_PROTOCOL_BAUD_DEFAULT  1000000     // 1Mbaud
 #define UART_PROTOCOL_SYNC_BYTE     0xAA
-#define UART_PROTOCOL_MAX_PAYLOAD   64
+// Largest payload accepted. Packets up to 64 bytes work with every peer;
+// only input frames (uart_frame.h) are longer, and those are only sent to
+// peers that advertise UART_FEATURE_INPUT_FRAME.
+#define UART_PROTOCOL_MAX_PAYLOAD   128
 
 // ============================================================================
 // PACKET TYPES
@@ -50,6 +54,8 @@ typedef enum {
     UART_PKT_INPUT_EVENT    = 0x10,     // Controller input event
     UART_PKT_INPUT_CONNECT  = 0x11,     // Controller connected
     UART_PKT_INPUT_DISCONNECT = 0x12,   // Controller disconnected
+    UART_PKT_INPUT_FRAME    = 0x13,     // Batched multi-player input (uart_frame.h)
+    UART_PKT_INPUT_FRAME_ACK = 0x14,    // Input frame applied by receiver
 
     // Feedback (0x20-0x2F)
     UART_PKT_RUMBLE         = 0x20,     // Rumble command
@@ -103,7 +109,7 @@ typedef struct __attribute__((packed)) {
     int8_t   delta_y;           // Mouse delta Y
 } uart_input_event_t;
 
-#define UART_INPUT_EVENT_SIZE   sizeof(uart_input_event_t)  // 12 bytes
+#define UART_INPUT_EVENT_SIZE   sizeof(uart_input_event_t)  // 14 bytes
 
 // ============================================================================
 // CONNECT/DISCONNECT PACKETS
@@ -204,25 +210,16 @@ typedef struct __attribute__((packed)) {
 #define UART_FEATURE_DISPLAY    0x0010
 #define UART_FEATURE_AUDIO      0x0020
 #define UART_FEATURE_AI         0x0040
+#define UART_FEATURE_INPUT_FRAME 0x0080     // Sends/decodes UART_PKT_INPUT_FRAME
+#define UART_FEATURE_FRAME_DELTA 0x0100     // Acks frames, decodes KEY/DELTA frames
 
 // ============================================================================
 // CRC-8 CALCULATION
 // ============================================================================
 
-// CRC-8 polynomial: x^8 + x^2 + x + 1 (0x07)
+// CRC-8 polynomial: x^8 + x^2 + x + 1 (0x07), table-driven (core/crc.h)
 static inline uint8_t uart_crc8(const uint8_t* data, uint8_t len) {
-    uint8_t crc = 0x00;
-    while (len--) {
-        crc ^= *data++;
-        for (uint8_t i = 0; i < 8; i++) {
-            if (crc & 0x80) {
-                crc = (crc << 1) ^ 0x07;
-            } else {
-                crc <<= 1;
-            }
-        }
-    }
-    return crc;
+    return crc8_calc(data, len);
 }
 
 // ============================================================================
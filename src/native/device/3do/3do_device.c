@@ -5,9 +5,11 @@
 #include "3do_device.h"
 #include "3do_buttons.h"
 #include "core/services/storage/flash.h"
+#include "core/services/storage/settings.h"
 #include "core/router/router.h"
 #include "core/input_event.h"
 #include "core/services/profiles/profile.h"
+#include "core/services/profiles/profile_compile.h"
 #include "core/services/profiles/profile_indicator.h"
 #include "core/services/leds/leds.h"
 #include "hardware/clocks.h"
@@ -273,6 +275,7 @@ tdo_output_mode_t tdo_get_output_mode(void) {
 
 void tdo_set_output_mode(tdo_output_mode_t mode) {
   output_mode = mode;
+  settings_set_u8(SETTING_3DO_OUTPUT_MODE, 0, (uint8_t)mode);
   #if CFG_TUSB_DEBUG >= 1
   printf("[3DO] Output mode set to: %s\n", mode == TDO_MODE_SILLY ? "SILLY" : "NORMAL");
   #endif
@@ -312,6 +315,7 @@ tdo_extension_mode_t tdo_get_extension_mode(void) {
 
 void tdo_set_extension_mode(tdo_extension_mode_t mode) {
   extension_mode = mode;
+  settings_set_u8(SETTING_3DO_EXTENSION_MODE, 0, (uint8_t)mode);
   #if CFG_TUSB_DEBUG >= 1
   printf("[3DO] Extension mode set to: %s\n",
          mode == TDO_EXT_MANAGED ? "MANAGED" : "PASSTHROUGH");
@@ -426,6 +430,7 @@ static uint8_t parse_extension_to_router(uint8_t* buffer, size_t buffer_size) {
     input_event_t event;
     init_input_event(&event);
     event.dev_addr = 0xE0 + count;  // 3DO extension range
+    event.source = INPUT_SOURCE_NATIVE_3DO;
     event.instance = 0;
 
     uint8_t id_nibble = (byte0 >> 4) & 0x0F;
@@ -653,6 +658,14 @@ void _3do_init(void) {
   pio_gpio_init(pio1, DATA_OUT_PIN);
   pio_sm_set_consecutive_pindirs(pio1, sm_output, DATA_OUT_PIN, 1, true);
 
+  // Restore pad and extension modes from settings
+  if (settings_get_u8(SETTING_3DO_OUTPUT_MODE, 0, TDO_MODE_NORMAL) == TDO_MODE_SILLY) {
+    output_mode = TDO_MODE_SILLY;
+  }
+  if (settings_get_u8(SETTING_3DO_EXTENSION_MODE, 0, TDO_EXT_PASSTHROUGH) == TDO_EXT_MANAGED) {
+    extension_mode = TDO_EXT_MANAGED;
+  }
+
   // Profile system is initialized by app_init() - we just set up the callbacks
   profile_set_player_count_callback(tdo_get_player_count_for_profile);
   profile_set_output_mode_callback(tdo_output_mode_switch_callback);
@@ -773,6 +786,9 @@ void _3do_task() {
     }
   }
 
+  // Compile a switched profile before the reports apply it
+  profile_compile(profile_get_active(OUTPUT_TARGET_3DO));
+
   // Update all player reports from router
   // This replaces the old post_globals() call chain
   for (int i = 0; i < MAX_PLAYERS; i++) {
@@ -780,7 +796,7 @@ void _3do_task() {
   }
 
   // Check for profile/mode switching combo (delegated to core)
-  const input_event_t* event = router_get_output(OUTPUT_TARGET_3DO, 0);
+  const input_state_t* event = router_get_output(OUTPUT_TARGET_3DO, 0);
   if (event) {
     profile_check_switch_combo(event->buttons);
   }
@@ -806,7 +822,7 @@ void __not_in_flash_func(update_3do_report)(uint8_t player_index) {
   if (player_index >= MAX_PLAYERS) return;
 
   // Get input from router (3DO supports up to 8 players)
-  const input_event_t* event = router_get_output(OUTPUT_TARGET_3DO, player_index);
+  const input_state_t* event = router_get_output(OUTPUT_TARGET_3DO, player_index);
   if (!event) return;  // No input for this player slot
 
   // Skip slots without an actual controller attached
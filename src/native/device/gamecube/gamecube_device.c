@@ -5,14 +5,18 @@
 
 #include "gamecube_device.h"
 #include "gamecube_buttons.h"
+#include "gamecube_report.h"
 #include "joybus.pio.h"
 #include "GamecubeConsole.h"
 #include "pico/bootrom.h"
 #include "pico/stdlib.h"
 #include "pico/flash.h"
+#include "hardware/structs/systick.h"
 #include "tusb.h"
 #include "core/services/storage/flash.h"
+#include "core/services/storage/flash_window.h"
 #include "core/services/profiles/profile.h"
+#include "core/services/profiles/profile_compile.h"
 #include "core/services/players/manager.h"
 #include "core/services/codes/codes.h"
 #include "core/router/router.h"
@@ -29,6 +33,14 @@ static uint8_t gc_kb_led = 0;
 static uint8_t gc_get_rumble(void) { return gc_rumble; }
 static uint8_t gc_get_kb_led(void) { return gc_kb_led; }
 
+// Console poll times (core 1); flash work waits for a gap between polls
+static flash_window_t gc_flash_window;
+
+static uint32_t gc_flash_quiet_us(void)
+{
+  return flash_window_quiet_us(&gc_flash_window, time_us_32());
+}
+
 // ============================================================================
 // PROFILE SYSTEM ACCESSORS (for OutputInterface)
 // ============================================================================
@@ -77,16 +89,10 @@ uint8_t hid_to_gc_key[256] = {[0 ... 255] = GC_KEY_NOT_FOUND};
 uint8_t gc_last_rumble = 0;
 uint8_t gc_kb_counter = 0;
 
-// Helper function to scale analog values relative to center (128)
-static inline uint8_t scale_toward_center(uint8_t val, float scale, uint8_t center)
-{
-  int16_t rel = (int16_t)val - (int16_t)center;
-  int16_t scaled = (int16_t)(rel * scale);
-  int16_t result = scaled + (int16_t)center;
-  if (result < 0) result = 0;
-  if (result > 255) result = 255;
-  return (uint8_t)result;
-}
+// JIT window state: profile is resolved outside the window (gc_housekeeping)
+static const profile_t* gc_profile = NULL;
+static uint32_t gc_last_buttons = 0;  // Last button state for combo detection
+static gc_jit_stats_t gc_jit_stats;
 
 // init hid key to gc key lookup table
 void gc_kb_key_lookup_init()
@@ -181,7 +187,7 @@ void gc_kb_key_lookup_init()
 void ngc_init()
 {
   // over clock CPU for correct timing with GC
-  set_sys_clock_khz(130000, true);
+  set_sys_clock_khz(GC_CPU_KHZ, true);
 
   // Configure custom UART pins (12=TX, 13=RX)
   gpio_set_function(UART_TX_PIN, GPIO_FUNC_UART);
@@ -192,6 +198,7 @@ void ngc_init()
 
   // Initialize flash settings system
   flash_init();
+  flash_set_quiet_source(gc_flash_quiet_us);
 
   // Profile system is initialized by app - just set up callbacks
   profile_set_player_count_callback(gc_get_player_count_for_profile);
@@ -230,10 +237,18 @@ void ngc_init()
   GamecubeConsole_init(&gc, GC_DATA_PIN, pio, sm, offset);
   gc_report = default_gc_report;
 
-  const profile_t* profile = profile_get_active(OUTPUT_TARGET_GAMECUBE);
-  if (profile) {
-    printf("[gc] Active profile: %s\n", profile->name);
+  gc_profile = profile_get_active(OUTPUT_TARGET_GAMECUBE);
+  if (gc_profile) {
+    printf("[gc] Active profile: %s\n", gc_profile->name);
   }
+
+#if GC_JIT_REPORT
+  // Free-running 24-bit SysTick at CPU clock for poll-to-reply window timing
+  systick_hw->rvr = M0PLUS_SYST_RVR_BITS;
+  systick_hw->cvr = 0;
+  systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+  printf("[gc] JIT report assembly enabled (budget %d cycles)\n", GC_JIT_BUDGET_CYCLES);
+#endif
 }
 
 uint8_t gc_kb_key_lookup(uint8_t hid_key)
@@ -252,89 +267,26 @@ uint8_t furthest_from_center(uint8_t a, uint8_t b, uint8_t center)
   }
 }
 
-// core1_task - inner-loop for the second core
-void __not_in_flash_func(core1_task)(void)
-{
-  // Initialize Core 1 for safe flash writes (required for flash_safe_execute)
-  flash_safe_execute_core_init();
-
-  while (1)
-  {
-    // Wait for GameCube console to poll controller
-    gc_rumble = GamecubeConsole_WaitForPoll(&gc) ? 255 : 0;
-
-    // Send GameCube controller button report
-    GamecubeConsole_SendReport(&gc, &gc_report);
-
-    gc_kb_counter++;
-    gc_kb_counter &= 15;
-
-    update_output();
-  }
-}
-
 // ============================================================================
-// USBR → GAMECUBE BUTTON MAPPING
+// REPORT ASSEMBLY
 // ============================================================================
-// Maps profile output (USBR format) to GameCube gc_report_t
-
-static void map_usbr_to_gc_report(const profile_output_t* output, gc_report_t* report)
-{
-    uint32_t buttons = output->buttons;
-
-    // D-pad (always direct mapping)
-    report->dpad_up    = ((buttons & JP_BUTTON_DU) != 0) ? 1 : 0;
-    report->dpad_down  = ((buttons & JP_BUTTON_DD) != 0) ? 1 : 0;
-    report->dpad_left  = ((buttons & JP_BUTTON_DL) != 0) ? 1 : 0;
-    report->dpad_right = ((buttons & JP_BUTTON_DR) != 0) ? 1 : 0;
-
-    // Face buttons (USBR → GC mapping via aliases)
-    // GC_BUTTON_A = JP_BUTTON_B1, GC_BUTTON_B = JP_BUTTON_B2, etc.
-    report->a = ((buttons & GC_BUTTON_A) != 0) ? 1 : 0;
-    report->b = ((buttons & GC_BUTTON_B) != 0) ? 1 : 0;
-    report->x = ((buttons & GC_BUTTON_X) != 0) ? 1 : 0;
-    report->y = ((buttons & GC_BUTTON_Y) != 0) ? 1 : 0;
-
-    // Shoulder buttons
-    report->z = ((buttons & GC_BUTTON_Z) != 0) ? 1 : 0;
-    report->l = ((buttons & GC_BUTTON_L) != 0) ? 1 : 0;
-    report->r = ((buttons & GC_BUTTON_R) != 0) ? 1 : 0;
-
-    // Start
-    report->start = ((buttons & GC_BUTTON_START) != 0) ? 1 : 0;
-
-    // Analog sticks (invert Y: HID uses 0=up, GameCube uses 0=down)
-    report->stick_x = output->left_x;
-    report->stick_y = 255 - output->left_y;
-    report->cstick_x = output->right_x;
-    report->cstick_y = 255 - output->right_y;
-
-    // Trigger analog values
-    report->l_analog = output->l2_analog;
-    report->r_analog = output->r2_analog;
-}
 
-// update_output - updates gc_report output data for output to GameCube
-void __not_in_flash_func(update_output)(void)
+// Build gc_report from the freshest router state. Returns true if new input
+// was consumed. Only the work that depends on that input happens here so it
+// fits the poll-to-reply window in GC_JIT_REPORT mode.
+static bool __not_in_flash_func(gc_build_report)(void)
 {
   static bool kbModeButtonHeld = false;
-  static uint32_t last_buttons = 0;  // Remember last button state for combo detection
 
   // Get input from router (GameCube uses MERGE mode, all inputs merged to player 0)
-  const input_event_t* event = router_get_output(OUTPUT_TARGET_GAMECUBE, 0);
+  const input_state_t* event = router_get_output(OUTPUT_TARGET_GAMECUBE, 0);
 
-  // Update last_buttons when we have new input
+  // Update last buttons when we have new input
   if (event) {
-    last_buttons = event->buttons;
+    gc_last_buttons = event->buttons;
   }
 
-  // Always check profile switching combo with last known state
-  // This ensures combo detection works even when controller doesn't send updates while buttons held
-  if (playersCount > 0) {
-    profile_check_switch_combo(last_buttons);
-  }
-
-  if (!event || playersCount == 0) return;  // No new input to process
+  if (!event || playersCount == 0) return false;  // No new input to process
 
   // Build report locally to avoid Core 1 reading partial updates
   gc_report_t new_report;
@@ -378,41 +330,8 @@ void __not_in_flash_func(update_output)(void)
 
   if (gc_state.button_mode != BUTTON_MODE_KB)
   {
-    // ======================================================================
-    // PROFILE-BASED BUTTON MAPPING
-    // ======================================================================
-
-    // Get active profile and apply it
-    const profile_t* profile = profile_get_active(OUTPUT_TARGET_GAMECUBE);
-
-    profile_output_t output;
-    profile_apply(profile,
-                  event->buttons,
-                  event->analog[0], event->analog[1],  // left stick
-                  event->analog[2], event->analog[3],  // right stick
-                  event->analog[5], event->analog[6],  // triggers
-                  &output);
-
-    // Map profile output to GameCube report
-    map_usbr_to_gc_report(&output, &new_report);
-
-    // Keyboard-specific transforms for GameCube
-    if (event->type == INPUT_TYPE_KEYBOARD) {
-      // Scale keyboard analog values to GameCube's smaller range
-      const float gc_kb_scale = 0.61f;  // 78/128 ≈ 0.61
-      new_report.stick_x  = scale_toward_center(new_report.stick_x, gc_kb_scale, 128);
-      new_report.stick_y  = scale_toward_center(new_report.stick_y, gc_kb_scale, 128);
-      new_report.cstick_x = scale_toward_center(new_report.cstick_x, gc_kb_scale, 128);
-      new_report.cstick_y = scale_toward_center(new_report.cstick_y, gc_kb_scale, 128);
-
-      // A1 (Home/Ctrl+Alt+Del) → gc-swiss IGR combo (Select+D-down+B+R)
-      if ((event->buttons & JP_BUTTON_A1) != 0) {
-        new_report.dpad_down = 1;
-        new_report.b = 1;
-        new_report.r = 1;
-        new_report.z = 1;  // Z acts as select equivalent for IGR
-      }
-    }
+    // Profile-based button mapping (profile resolved outside the window)
+    gc_report_build_pad(event, gc_profile, &new_report);
   }
   else
   {
@@ -427,10 +346,83 @@ void __not_in_flash_func(update_output)(void)
     new_report.keyboard.counter = gc_kb_counter;
   }
 
-  codes_task();
-
   // Atomically update global report
   gc_report = new_report;
+  return true;
+}
+
+// Work that doesn't need to be in the poll-to-reply window
+static void __not_in_flash_func(gc_housekeeping)(bool fresh)
+{
+  // Always check profile switching combo with last known state
+  // This ensures combo detection works even when controller doesn't send updates while buttons held
+  if (playersCount > 0) {
+    profile_check_switch_combo(gc_last_buttons);
+  }
+
+  // Re-resolve profile for the next window (may have been switched above)
+  // and compile it on this core now rather than inside the window
+  gc_profile = profile_get_active(OUTPUT_TARGET_GAMECUBE);
+  profile_compile(gc_profile);
+
+  if (fresh) {
+    codes_task();
+  }
+}
+
+// update_output - updates gc_report output data for output to GameCube
+void __not_in_flash_func(update_output)(void)
+{
+  bool fresh = gc_build_report();
+  gc_housekeeping(fresh);
+}
+
+const gc_jit_stats_t* gc_get_jit_stats(void)
+{
+  return &gc_jit_stats;
+}
+
+// core1_task - inner-loop for the second core
+void __not_in_flash_func(core1_task)(void)
+{
+  // Initialize Core 1 for safe flash writes (required for flash_safe_execute)
+  flash_safe_execute_core_init();
+
+  while (1)
+  {
+    // Wait for GameCube console to poll controller
+    gc_rumble = GamecubeConsole_WaitForPoll(&gc) ? 255 : 0;
+    flash_window_poll(&gc_flash_window, time_us_32());
+
+#if GC_JIT_REPORT
+    // Assemble the reply from the freshest input inside the reply window
+    uint32_t window_start = systick_hw->cvr;
+    bool fresh = gc_build_report();
+    uint32_t window_cycles = (window_start - systick_hw->cvr) & M0PLUS_SYST_CVR_BITS;
+
+    // Send GameCube controller button report
+    GamecubeConsole_SendReport(&gc, &gc_report);
+
+    gc_jit_stats.polls++;
+    if (fresh) gc_jit_stats.fresh++;
+    gc_jit_stats.last_cycles = window_cycles;
+    if (window_cycles > gc_jit_stats.max_cycles) gc_jit_stats.max_cycles = window_cycles;
+    if (window_cycles > GC_JIT_BUDGET_CYCLES) gc_jit_stats.over_budget++;
+
+    gc_kb_counter++;
+    gc_kb_counter &= 15;
+
+    gc_housekeeping(fresh);
+#else
+    // Send GameCube controller button report
+    GamecubeConsole_SendReport(&gc, &gc_report);
+
+    gc_kb_counter++;
+    gc_kb_counter &= 15;
+
+    update_output();
+#endif
+  }
 }
 
 // ============================================================================
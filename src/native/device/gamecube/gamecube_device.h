@@ -25,6 +25,12 @@
 #define GC_DATA_PIN 7
 #define GC_3V3_PIN 6
 
+// Assemble the report between poll detection and the reply (freshest input)
+// instead of after sending (one poll stale). Opt-in until timed on hardware.
+#ifndef GC_JIT_REPORT
+#define GC_JIT_REPORT 0
+#endif
+
 // NGC button modes
 #define BUTTON_MODE_0  0x00
 #define BUTTON_MODE_1  0x01
@@ -46,6 +52,15 @@
 // The profile system uses JP_BUTTON_* constants with GameCube-specific aliases
 // (GC_BUTTON_A, GC_BUTTON_B, etc.) for readable profile definitions.
 
+// Poll-to-reply window timing (GC_JIT_REPORT), in CPU cycles
+typedef struct {
+    uint32_t polls;             // Polls answered
+    uint32_t fresh;             // Polls answered with input newer than the last poll
+    uint32_t last_cycles;       // Last window duration
+    uint32_t max_cycles;        // Worst window duration
+    uint32_t over_budget;       // Windows longer than GC_JIT_BUDGET_CYCLES
+} gc_jit_stats_t;
+
 // Global variables
 extern PIO pio;
 
@@ -54,5 +69,6 @@ void ngc_init(void);
 
 void __not_in_flash_func(core1_task)(void);
 void __not_in_flash_func(update_output)(void);
+const gc_jit_stats_t* gc_get_jit_stats(void);
 
 #endif // GAMECUBE_DEVICE_H
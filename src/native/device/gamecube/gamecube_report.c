@@ -0,0 +1,84 @@
+// gamecube_report.c - GameCube controller report builder
+//
+// Profile application and USBR → GameCube mapping, split out of
+// gamecube_device.c so the same code runs on core 1 and in host benches.
+
+#include "gamecube_report.h"
+#include "gamecube_buttons.h"
+#include "pico/stdlib.h"
+#include "core/analog.h"
+
+// Keyboard analog scale for GameCube's smaller stick range (78/128 ≈ 0.61)
+#define GC_KB_SCALE ANALOG_SCALE(0.61f)
+
+// ============================================================================
+// USBR → GAMECUBE BUTTON MAPPING
+// ============================================================================
+// Maps profile output (USBR format) to GameCube gc_report_t
+
+static void map_usbr_to_gc_report(const profile_output_t* output, gc_report_t* report)
+{
+    uint32_t buttons = output->buttons;
+
+    // D-pad (always direct mapping)
+    report->dpad_up    = ((buttons & JP_BUTTON_DU) != 0) ? 1 : 0;
+    report->dpad_down  = ((buttons & JP_BUTTON_DD) != 0) ? 1 : 0;
+    report->dpad_left  = ((buttons & JP_BUTTON_DL) != 0) ? 1 : 0;
+    report->dpad_right = ((buttons & JP_BUTTON_DR) != 0) ? 1 : 0;
+
+    // Face buttons (USBR → GC mapping via aliases)
+    // GC_BUTTON_A = JP_BUTTON_B1, GC_BUTTON_B = JP_BUTTON_B2, etc.
+    report->a = ((buttons & GC_BUTTON_A) != 0) ? 1 : 0;
+    report->b = ((buttons & GC_BUTTON_B) != 0) ? 1 : 0;
+    report->x = ((buttons & GC_BUTTON_X) != 0) ? 1 : 0;
+    report->y = ((buttons & GC_BUTTON_Y) != 0) ? 1 : 0;
+
+    // Shoulder buttons
+    report->z = ((buttons & GC_BUTTON_Z) != 0) ? 1 : 0;
+    report->l = ((buttons & GC_BUTTON_L) != 0) ? 1 : 0;
+    report->r = ((buttons & GC_BUTTON_R) != 0) ? 1 : 0;
+
+    // Start
+    report->start = ((buttons & GC_BUTTON_START) != 0) ? 1 : 0;
+
+    // Analog sticks (invert Y: HID uses 0=up, GameCube uses 0=down)
+    report->stick_x = output->left_x;
+    report->stick_y = 255 - output->left_y;
+    report->cstick_x = output->right_x;
+    report->cstick_y = 255 - output->right_y;
+
+    // Trigger analog values
+    report->l_analog = output->l2_analog;
+    report->r_analog = output->r2_analog;
+}
+
+void __not_in_flash_func(gc_report_build_pad)(const input_state_t* event, const profile_t* profile, gc_report_t* report)
+{
+  profile_output_t output;
+  profile_apply(profile,
+                event->buttons,
+                event->analog[0], event->analog[1],  // left stick
+                event->analog[2], event->analog[3],  // right stick
+                event->analog[5], event->analog[6],  // triggers
+                &output);
+
+  // Map profile output to GameCube report
+  map_usbr_to_gc_report(&output, report);
+
+  // Keyboard-specific transforms for GameCube
+  if (event->type == INPUT_TYPE_KEYBOARD) {
+    // Scale keyboard analog values to GameCube's smaller range
+    report->stick_x  = analog_scale_stick(report->stick_x, GC_KB_SCALE);
+    report->stick_y  = analog_scale_stick(report->stick_y, GC_KB_SCALE);
+    report->cstick_x = analog_scale_stick(report->cstick_x, GC_KB_SCALE);
+    report->cstick_y = analog_scale_stick(report->cstick_y, GC_KB_SCALE);
+
+    // A1 (Home/Ctrl+Alt+Del) → gc-swiss IGR combo (Select+D-down+B+R)
+    if ((event->buttons & JP_BUTTON_A1) != 0) {
+      report->dpad_down = 1;
+      report->b = 1;
+      report->r = 1;
+      report->z = 1;  // Z acts as select equivalent for IGR
+    }
+  }
+}
@@ -0,0 +1,31 @@
+// gamecube_report.h - GameCube controller report builder
+//
+// Turns router state into a gc_report_t via the active profile. Kept free of
+// PIO/joybus dependencies so it can run inside the poll-to-response window
+// (see GC_JIT_REPORT) and be exercised by the host joybus simulation.
+
+#ifndef GAMECUBE_REPORT_H
+#define GAMECUBE_REPORT_H
+
+#include <stdint.h>
+#include "lib/joybus-pio/include/gamecube_definitions.h"
+#include "core/input_event.h"
+#include "core/services/profiles/profile.h"
+
+// ============================================================================
+// JIT TIMING BUDGET
+// ============================================================================
+// With GC_JIT_REPORT the report is assembled after the poll is detected and
+// before the reply starts. Joybus runs at 4us per bit and joybus-pio begins
+// the reply roughly one bit period after the poll's stop bit, so that is all
+// the time the window work (router read + profile + mapping) may take.
+
+#define GC_CPU_KHZ              130000  // Overclocked for joybus timing (ngc_init)
+#define GC_JIT_BUDGET_US        4
+#define GC_JIT_BUDGET_CYCLES    (GC_JIT_BUDGET_US * (GC_CPU_KHZ / 1000))
+
+// Build a gamepad-mode report from input state using profile
+// (report must be pre-filled with default_gc_report)
+void gc_report_build_pad(const input_state_t* event, const profile_t* profile, gc_report_t* report);
+
+#endif // GAMECUBE_REPORT_H
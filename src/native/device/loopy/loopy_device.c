@@ -11,6 +11,7 @@
 #include "core/router/router.h"
 #include "core/services/codes/codes.h"
 #include "core/services/profiles/profile.h"
+#include "core/services/profiles/profile_compile.h"
 #include "core/uart.h"
 
 PIO pio;
@@ -93,10 +94,10 @@ void __not_in_flash_func(core1_task)(void)
     // TODO: implement gamepad, mouse, multi-tap output with PIO.
 
     // Get input from router (Loopy uses SIMPLE mode, 1:1 per player slot)
-    const input_event_t* event1 = router_get_output(OUTPUT_TARGET_LOOPY, 0);
-    const input_event_t* event2 = router_get_output(OUTPUT_TARGET_LOOPY, 1);
-    const input_event_t* event3 = router_get_output(OUTPUT_TARGET_LOOPY, 2);
-    const input_event_t* event4 = router_get_output(OUTPUT_TARGET_LOOPY, 3);
+    const input_state_t* event1 = router_get_output(OUTPUT_TARGET_LOOPY, 0);
+    const input_state_t* event2 = router_get_output(OUTPUT_TARGET_LOOPY, 1);
+    const input_state_t* event3 = router_get_output(OUTPUT_TARGET_LOOPY, 2);
+    const input_state_t* event4 = router_get_output(OUTPUT_TARGET_LOOPY, 3);
 
     // Apply profile mapping to each player's input
     const profile_t* profile = profile_get_active(OUTPUT_TARGET_LOOPY);
@@ -259,6 +260,9 @@ void __not_in_flash_func(core1_task)(void)
     gpio_put(BIT7_PIN, (loopy_byte & LOOPY_BIT7) ? 1 : 0);
 
     update_output();
+
+    // Outputs are set: compile a switched profile for the next pass
+    profile_compile(profile);
   }
 }
 
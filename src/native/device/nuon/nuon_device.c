@@ -5,11 +5,14 @@
 #include "core/services/codes/codes.h"
 #include "core/services/hotkeys/hotkeys.h"
 #include "core/services/profiles/profile.h"
+#include "core/services/profiles/profile_compile.h"
+#include "core/crc.h"
+#include "core/services/storage/flash.h"
+#include "core/services/storage/flash_window.h"
 #include <math.h>
 
 PIO pio;
 uint sm1, sm2;
-int crc_lut[256]; // crc look up table
 
 // Definition of global variables
 uint32_t output_buttons_0 = 0;
@@ -38,6 +41,14 @@ static int16_t last_stick_angle[MAX_PLAYERS] = {0};  // Track last angle per pla
 // Forward declaration for GPIO trigger function
 static void trigger_button_press(uint8_t pin);
 
+// Polyface packet times (core 1); flash work waits for a gap between them
+static flash_window_t nuon_flash_window;
+
+static uint32_t nuon_flash_quiet_us(void)
+{
+  return flash_window_quiet_us(&nuon_flash_window, time_us_32());
+}
+
 // IGR callback for long hold (power button)
 static void nuon_igr_power_callback(uint8_t player, uint32_t held_ms) {
     (void)player;
@@ -106,6 +117,8 @@ void nuon_init(void)
   sm1 = pio_claim_unused_sm(pio1, true);
   polyface_send_program_init(pio1, sm1, offset1, DATAIO_PIN);
 
+  flash_set_quiet_source(nuon_flash_quiet_us);
+
   // queue_init(&packet_queue, sizeof(int64_t), 1000);
 
   // Register IGR hotkeys for internal Nuon reset mod
@@ -186,23 +199,10 @@ uint32_t crc_data_packet(int32_t value, int8_t size)
   return (packet);
 }
 
-int crc_build_lut()
-{
-	int i,j,k;
-	for (i=0; i<256; i++)
-  {
-		for(j=i<<8,k=0; k<8; k++)
-    {
-			j=(j&0x8000) ? (j<<1)^CRC16 : (j<<1); crc_lut[i]=j;
-		}
-	}
-	return(0);
-}
-
+// CRC16 (0x8005) via the shared SRAM table; no lazy build on the hot path
 int crc_calc(unsigned char data, int crc)
 {
-	if (crc_lut[1]==0) crc_build_lut();
-	return(((crc_lut[((crc>>8)^data)&0xff])^(crc<<8))&0xffff);
+	return crc16_update((uint16_t)crc, data);
 }
 
 static void trigger_button_press(uint8_t pin)
@@ -224,7 +224,7 @@ static void trigger_button_press(uint8_t pin)
 void nuon_task()
 {
   // Get input from router (Nuon uses MERGE mode, all inputs merged to player 0)
-  const input_event_t* event = router_get_output(OUTPUT_TARGET_NUON, 0);
+  const input_state_t* event = router_get_output(OUTPUT_TARGET_NUON, 0);
   if (!event) return;
 
   // Check IGR hotkeys (internal Nuon reset mod)
@@ -253,6 +253,8 @@ void __not_in_flash_func(core1_task)(void)
       packet = ((packet) << 32) | (rxdata & 0xFFFFFFFF);
     }
 
+    flash_window_poll(&nuon_flash_window, time_us_32());
+
     // queue_try_add(&packet_queue, &packet);
 
     uint8_t dataA = ((packet>>17) & 0b11111111);
@@ -457,6 +459,10 @@ void __not_in_flash_func(core1_task)(void)
       id = dataC;
       branded = true;
     }
+
+    // Reply is out: compile a switched profile here rather than on the
+    // first update_output() that applies it
+    profile_compile(profile_get_active(OUTPUT_TARGET_NUON));
   }
 }
 
@@ -466,7 +472,7 @@ void __not_in_flash_func(core1_task)(void)
 void __not_in_flash_func(update_output)(void)
 {
   // Get input from router (Nuon uses MERGE mode, all inputs merged to player 0)
-  const input_event_t* event = router_get_output(OUTPUT_TARGET_NUON, 0);
+  const input_state_t* event = router_get_output(OUTPUT_TARGET_NUON, 0);
   if (!event || playersCount == 0) return;
 
   // Apply profile remapping
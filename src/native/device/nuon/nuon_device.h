@@ -68,7 +68,6 @@
 extern PIO pio;
 extern uint sm1, sm2; // sm1 = send; sm2 = read
 
-extern int crc_lut[256]; // crc look up table
 // queue_t packet_queue;
 
 // Function declarations
@@ -80,6 +80,8 @@ static const int64_t reset_period = 600; // at 600us of no CLK edges, scan is co
 #include "core/input_event.h"
 #include "core/services/players/manager.h"
 #include "core/services/codes/codes.h"
+#include "core/services/storage/flash.h"
+#include "core/services/storage/flash_window.h"
 
 static struct {
     volatile int button_mode[MAX_PLAYERS];  // Button mode per player (6-button, 2-button, etc.)
@@ -103,6 +105,14 @@ static struct {
 
 // No timers needed - state cycles event-driven on CLK edges
 
+// Console scan times (core 1); flash work waits for the gap between scans
+static flash_window_t pce_flash_window;
+
+static uint32_t pce_flash_quiet_us(void)
+{
+  return flash_window_quiet_us(&pce_flash_window, time_us_32());
+}
+
 // Forward declarations
 void read_inputs(void);
 void assemble_output(void);
@@ -168,6 +178,8 @@ void pce_init()
   
   // Initialize timing (like PCEMouse)
   init_time = get_absolute_time();
+
+  flash_set_quiet_source(pce_flash_quiet_us);
 }
 
 // init turbo button timings
@@ -211,6 +223,7 @@ void __not_in_flash_func(core1_task)(void)
   {
     // wait for CLK rising edge (from clock.pio via sm2)
     rx_bit = pio_sm_get_blocking(pio, sm2);
+    flash_window_poll(&pce_flash_window, time_us_32());
 
     // Lock output values during scan (like PCEMouse)
     output_exclude = true;
@@ -267,7 +280,7 @@ void __not_in_flash_func(read_inputs)(void)
 
   for (unsigned short int i = 0; i < MAX_PLAYERS; ++i)
   {
-    const input_event_t* event = router_get_output(OUTPUT_TARGET_PCENGINE, i);
+    const input_state_t* event = router_get_output(OUTPUT_TARGET_PCENGINE, i);
 
     // Player slot out of range - reset to neutral (including mouse state)
     if (i >= playersCount) {
@@ -5,12 +5,14 @@
 
 #include "uart_device.h"
 #include "core/uart/uart_protocol.h"
+#include "core/uart/uart_frame.h"
 #include "core/router/router.h"
 #include "core/input_event.h"
 #include "core/services/players/manager.h"
 #include "core/services/profiles/profile.h"
 #include "hardware/uart.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
 #include "pico/stdlib.h"
 #include <string.h>
 #include <stdio.h>
@@ -29,6 +31,26 @@ static uart_input_event_t tx_queue[TX_QUEUE_SIZE];
 static volatile uint8_t tx_queue_head = 0;
 static volatile uint8_t tx_queue_tail = 0;
 
+// Transmit byte ring, drained to the UART by DMA. Framed packets are appended
+// here and go out back-to-back; the in-flight DMA run is [tail, tail+dma_len).
+#define TX_RING_MASK (UART_DEVICE_TX_RING_SIZE - 1)
+_Static_assert((UART_DEVICE_TX_RING_SIZE & TX_RING_MASK) == 0,
+               "UART_DEVICE_TX_RING_SIZE must be a power of 2");
+static uint8_t tx_ring[UART_DEVICE_TX_RING_SIZE];
+static volatile uint16_t tx_ring_head = 0;
+static volatile uint16_t tx_ring_tail = 0;
+static uint16_t tx_dma_len = 0;
+static int tx_dma_chan = -1;
+
+// Batched input frames, used once the peer advertises UART_FEATURE_INPUT_FRAME
+static uint32_t peer_features = 0;
+static bool peer_version_seen = false;
+
+// False when another module (uart_host) reads this UART's RX FIFO
+static bool rx_enabled = true;
+static uart_frame_encoder_t frame_encoder;
+static uint32_t last_frame_ms = 0;
+
 // Previous state for change detection
 #define UART_MAX_PLAYERS 8  // Maximum players tracked by UART device
 static uint32_t prev_buttons[UART_MAX_PLAYERS];
@@ -54,6 +76,8 @@ static uint32_t tx_count = 0;
 static uint32_t rx_count = 0;
 static uint32_t error_count = 0;
 static uint32_t queue_drops = 0;
+static uint32_t tx_drops = 0;
+static uint32_t tx_backpressure = 0;
 static uint32_t last_rx_time = 0;
 
 // Callbacks
@@ -64,11 +88,63 @@ static uart_device_led_callback_t led_callback = NULL;
 // TRANSMIT HELPERS
 // ============================================================================
 
-// Send a raw packet with header and CRC
-void uart_device_send_packet(uint8_t type, const void* payload, uint8_t len)
+static inline uint16_t tx_ring_used(void)
 {
-    if (!initialized) return;
-    if (len > UART_PROTOCOL_MAX_PAYLOAD) return;
+    return (tx_ring_head - tx_ring_tail) & TX_RING_MASK;
+}
+
+static inline uint16_t tx_ring_free(void)
+{
+    return TX_RING_MASK - tx_ring_used();
+}
+
+static void tx_ring_write(const uint8_t* data, uint16_t len)
+{
+    uint16_t head = tx_ring_head;
+    uint16_t first = UART_DEVICE_TX_RING_SIZE - head;
+    if (first > len) first = len;
+
+    memcpy(&tx_ring[head], data, first);
+    memcpy(&tx_ring[0], data + first, len - first);
+    tx_ring_head = (head + len) & TX_RING_MASK;
+}
+
+// Retire the finished DMA run and start the next one. Never blocks: if the
+// previous transfer is still running this returns and the bytes wait.
+static void tx_ring_kick(void)
+{
+    if (tx_dma_chan < 0) {
+        // No DMA channel available: top up the hardware FIFO instead
+        while (tx_ring_used() && uart_is_writable(uart_port)) {
+            uart_putc_raw(uart_port, tx_ring[tx_ring_tail]);
+            tx_ring_tail = (tx_ring_tail + 1) & TX_RING_MASK;
+        }
+        return;
+    }
+
+    if (dma_channel_is_busy(tx_dma_chan)) return;
+
+    tx_ring_tail = (tx_ring_tail + tx_dma_len) & TX_RING_MASK;
+    tx_dma_len = 0;
+
+    // One transfer per contiguous run; a wrapped ring takes two kicks
+    uint16_t used = tx_ring_used();
+    if (used == 0) return;
+    uint16_t run = UART_DEVICE_TX_RING_SIZE - tx_ring_tail;
+    if (run > used) run = used;
+
+    tx_dma_len = run;
+    dma_channel_transfer_from_buffer_now(tx_dma_chan, &tx_ring[tx_ring_tail], run);
+}
+
+// Frame a packet into the TX ring. Returns false (and counts a drop) if the
+// ring can't hold the whole packet; partial packets are never written.
+static bool tx_frame_packet(uint8_t type, const void* payload, uint8_t len)
+{
+    if (tx_ring_free() < (uint16_t)len + UART_OVERHEAD) {
+        tx_drops++;
+        return false;
+    }
 
     uint8_t packet[UART_PROTOCOL_MAX_PAYLOAD + UART_OVERHEAD];
     uint8_t idx = 0;
@@ -88,9 +164,20 @@ void uart_device_send_packet(uint8_t type, const void* payload, uint8_t len)
     uint8_t crc = uart_crc8(&packet[1], len + 2);
     packet[idx++] = crc;
 
-    // Send packet
-    uart_write_blocking(uart_port, packet, idx);
+    tx_ring_write(packet, idx);
     tx_count++;
+    return true;
+}
+
+// Send a raw packet with header and CRC (queued to the TX ring, non-blocking)
+void uart_device_send_packet(uint8_t type, const void* payload, uint8_t len)
+{
+    if (!initialized) return;
+    if (len > UART_PROTOCOL_MAX_PAYLOAD) return;
+
+    if (tx_frame_packet(type, payload, len)) {
+        tx_ring_kick();
+    }
 }
 
 // ============================================================================
@@ -149,6 +236,11 @@ static void process_rx_packet(uint8_t type, const uint8_t* payload, uint8_t len)
             uart_device_send_packet(UART_PKT_PONG, NULL, 0);
             break;
 
+        case UART_PKT_VERSION:
+        case UART_PKT_INPUT_FRAME_ACK:
+            uart_device_handle_link_packet(type, payload, len);
+            break;
+
         case UART_PKT_GET_STATUS:
             uart_device_send_status();
             break;
@@ -261,7 +353,7 @@ void uart_device_init(void)
 void uart_device_init_pins(uint8_t tx_pin, uint8_t rx_pin, uint32_t baud)
 {
     printf("[uart_device] Initializing UART device\n");
-    printf("[uart_device]   TX=%d, RX=%d, BAUD=%lu\n", tx_pin, rx_pin, baud);
+    printf("[uart_device]   TX=%d, RX=%d, BAUD=%lu\n", tx_pin, rx_pin, (unsigned long)baud);
 
     // Initialize UART
     uart_init(uart_port, baud);
@@ -276,32 +368,93 @@ void uart_device_init_pins(uint8_t tx_pin, uint8_t rx_pin, uint32_t baud)
     // Enable FIFO
     uart_set_fifo_enabled(uart_port, true);
 
+    // TX DMA: ring bytes → UART data register, paced by the TX DREQ
+    if (tx_dma_chan < 0) {
+        tx_dma_chan = dma_claim_unused_channel(false);
+        if (tx_dma_chan < 0) {
+            printf("[uart_device]   No free DMA channel, using FIFO polling for TX\n");
+        }
+    }
+    if (tx_dma_chan >= 0) {
+        dma_channel_abort(tx_dma_chan);
+        dma_channel_config cfg = dma_channel_get_default_config(tx_dma_chan);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_8);
+        channel_config_set_read_increment(&cfg, true);
+        channel_config_set_write_increment(&cfg, false);
+        channel_config_set_dreq(&cfg, uart_get_dreq(uart_port, true));
+        dma_channel_configure(tx_dma_chan, &cfg, &uart_get_hw(uart_port)->dr,
+                              NULL, 0, false);
+    }
+
     // Initialize state
     memset(prev_buttons, 0xFF, sizeof(prev_buttons));  // All released
     memset(prev_analog, 128, sizeof(prev_analog));     // Centered
     tx_queue_head = 0;
     tx_queue_tail = 0;
+    tx_ring_head = 0;
+    tx_ring_tail = 0;
+    tx_dma_len = 0;
     rx_state = RX_STATE_SYNC;
 
+    // Input events until the peer says it takes frames
+    peer_features = 0;
+    peer_version_seen = false;
+    uart_frame_encoder_init(&frame_encoder, false);
+
     initialized = true;
     printf("[uart_device] Initialization complete\n");
+
+    uart_device_send_version();
 }
 
 void uart_device_task(void)
 {
     if (!initialized) return;
 
-    // Process incoming bytes (feedback commands)
-    while (uart_is_readable(uart_port)) {
+    // Process incoming bytes (feedback commands). Skipped when uart_host owns
+    // RX: its DMA ring drains the FIFO, and a byte taken between the readable
+    // check and uart_getc() would block here and corrupt both parsers.
+    while (rx_enabled && uart_is_readable(uart_port)) {
         uint8_t byte = uart_getc(uart_port);
         process_rx_byte(byte);
     }
 
-    // Send queued input events
+    // Retire the last transfer so its bytes count as free space
+    tx_ring_kick();
+
+    // Frame every queued input event into the ring, then start a single
+    // transfer for the batch. Events that don't fit stay queued.
     uart_input_event_t event;
-    while (tx_queue_pop(&event)) {
-        uart_device_send_packet(UART_PKT_INPUT_EVENT, &event, sizeof(event));
+    while (!tx_queue_empty()) {
+        if (tx_ring_free() < UART_INPUT_EVENT_SIZE + UART_OVERHEAD) {
+            tx_backpressure++;
+            break;
+        }
+        tx_queue_pop(&event);
+        tx_frame_packet(UART_PKT_INPUT_EVENT, &event, sizeof(event));
+    }
+
+    // All updated players in one frame; resend if the last one wasn't acked
+    if (peer_features & UART_FEATURE_INPUT_FRAME) {
+        uint32_t now = to_ms_since_boot(get_absolute_time());
+        bool resend = uart_frame_encoder_unacked(&frame_encoder) &&
+                      (now - last_frame_ms) >= UART_DEVICE_FRAME_RESEND_MS;
+
+        if (frame_encoder.dirty || resend) {
+            if (tx_ring_free() < UART_FRAME_MAX_PAYLOAD + UART_OVERHEAD) {
+                tx_backpressure++;
+            } else {
+                uint8_t frame[UART_FRAME_MAX_PAYLOAD];
+                uint8_t len = uart_frame_encode(&frame_encoder, frame);
+                if (len) {
+                    tx_frame_packet(UART_PKT_INPUT_FRAME, frame, len);
+                    last_frame_ms = now;
+                }
+            }
+        }
     }
+
+    tx_ring_kick();
 }
 
 void uart_device_set_mode(uart_device_mode_t mode)
@@ -314,7 +467,7 @@ uart_device_mode_t uart_device_get_mode(void)
     return device_mode;
 }
 
-void uart_device_queue_input(const input_event_t* event, uint8_t player_index)
+void uart_device_queue_input(const input_state_t* event, uint8_t player_index)
 {
     if (!initialized) return;
     if (device_mode == UART_DEVICE_MODE_OFF) return;
@@ -362,7 +515,11 @@ void uart_device_queue_input(const input_event_t* event, uint8_t player_index)
     uart_event.delta_x = event->delta_x;
     uart_event.delta_y = event->delta_y;
 
-    tx_queue_push(&uart_event);
+    if (peer_features & UART_FEATURE_INPUT_FRAME) {
+        uart_frame_encoder_update(&frame_encoder, &uart_event);
+    } else {
+        tx_queue_push(&uart_event);
+    }
 }
 
 void uart_device_send_connect(uint8_t player_index, uint8_t device_type,
@@ -412,11 +569,65 @@ void uart_device_send_version(void)
     ver.minor = 0;
     ver.patch = 0;
     ver.board_type = UART_BOARD_RP2040;
-    ver.features = UART_FEATURE_USB_HOST;
+    ver.features = UART_FEATURE_USB_HOST | UART_FEATURE_INPUT_FRAME | UART_FEATURE_FRAME_DELTA;
 
     uart_device_send_packet(UART_PKT_VERSION, &ver, sizeof(ver));
 }
 
+void uart_device_set_rx_enabled(bool enabled)
+{
+    rx_enabled = enabled;
+    if (!enabled) {
+        rx_state = RX_STATE_SYNC;
+    }
+}
+
+void uart_device_handle_link_packet(uint8_t type, const uint8_t* payload, uint8_t len)
+{
+    if (!initialized) return;
+
+    switch (type) {
+        case UART_PKT_VERSION: {
+            if (len < sizeof(uart_version_t)) break;
+
+            const uart_version_t* ver = (const uart_version_t*)payload;
+            uint32_t frame_bits = UART_FEATURE_INPUT_FRAME | UART_FEATURE_FRAME_DELTA;
+            bool first = !peer_version_seen;
+
+            if (first || (ver->features & frame_bits) != (peer_features & frame_bits)) {
+                uart_frame_encoder_init(&frame_encoder,
+                                        (ver->features & UART_FEATURE_FRAME_DELTA) != 0);
+                printf("[uart_device] Peer features 0x%08lX, sending %s\n",
+                       (unsigned long)ver->features,
+                       (ver->features & UART_FEATURE_INPUT_FRAME) ? "input frames" : "input events");
+            }
+            peer_features = ver->features;
+            peer_version_seen = true;
+
+            // Answer the first VERSION so the peer learns ours too
+            if (first) {
+                uart_device_send_version();
+            }
+            break;
+        }
+
+        case UART_PKT_INPUT_FRAME_ACK:
+            if (len >= sizeof(uart_input_frame_ack_t)) {
+                const uart_input_frame_ack_t* ack = (const uart_input_frame_ack_t*)payload;
+                uart_frame_encoder_ack(&frame_encoder, ack->seq);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+uint32_t uart_device_get_peer_features(void)
+{
+    return peer_features;
+}
+
 bool uart_device_is_connected(void)
 {
     if (!initialized) return false;
@@ -429,6 +640,9 @@ uint32_t uart_device_get_tx_count(void) { return tx_count; }
 uint32_t uart_device_get_rx_count(void) { return rx_count; }
 uint32_t uart_device_get_error_count(void) { return error_count; }
 uint32_t uart_device_get_queue_drops(void) { return queue_drops; }
+uint32_t uart_device_get_tx_drops(void) { return tx_drops; }
+uint32_t uart_device_get_tx_backpressure(void) { return tx_backpressure; }
+uint16_t uart_device_get_tx_pending(void) { return tx_ring_used(); }
 
 void uart_device_set_rumble_callback(uart_device_rumble_callback_t callback)
 {
@@ -37,6 +37,18 @@
 #define UART_DEVICE_PERIPHERAL    uart1   // UART peripheral
 #endif
 
+// Transmit ring (bytes, power of 2). Packets are framed into the ring and
+// sent by DMA, so senders never wait on the wire. 512 bytes holds 28 input
+// event packets (~5ms at 1Mbaud).
+#ifndef UART_DEVICE_TX_RING_SIZE
+#define UART_DEVICE_TX_RING_SIZE  512
+#endif
+
+// Resend interval for an unacknowledged input frame (uart_frame.h)
+#ifndef UART_DEVICE_FRAME_RESEND_MS
+#define UART_DEVICE_FRAME_RESEND_MS  20
+#endif
+
 // ============================================================================
 // UART DEVICE MODES
 // ============================================================================
@@ -72,7 +84,7 @@ uart_device_mode_t uart_device_get_mode(void);
 
 // Queue an input event for transmission
 // Called by router tap when input events occur
-void uart_device_queue_input(const input_event_t* event, uint8_t player_index);
+void uart_device_queue_input(const input_state_t* event, uint8_t player_index);
 
 // Send player connect notification
 void uart_device_send_connect(uint8_t player_index, uint8_t device_type,
@@ -110,18 +122,35 @@ uint32_t uart_device_get_tx_count(void);
 uint32_t uart_device_get_rx_count(void);
 uint32_t uart_device_get_error_count(void);
 uint32_t uart_device_get_queue_drops(void);
+uint32_t uart_device_get_tx_drops(void);         // Packets dropped, TX ring full
+uint32_t uart_device_get_tx_backpressure(void);  // Task passes that left events queued
+uint16_t uart_device_get_tx_pending(void);       // Bytes in the TX ring not yet sent
 
 // ============================================================================
 // PACKET SENDING (for advanced use)
 // ============================================================================
 
-// Send a raw packet (type + payload)
+// Send a raw packet (type + payload). Queued to the TX ring and returns
+// immediately; dropped (see uart_device_get_tx_drops) if the ring is full.
 void uart_device_send_packet(uint8_t type, const void* payload, uint8_t len);
 
 // Send status response
 void uart_device_send_status(void);
 
-// Send version info
+// Send version info (also sent at init to advertise input frame support)
 void uart_device_send_version(void);
 
+// Stop (or resume) reading the UART's RX FIFO. Call with false when
+// uart_host receives on the same port; link packets then arrive only through
+// uart_device_handle_link_packet().
+void uart_device_set_rx_enabled(bool enabled);
+
+// Handle link packets from the peer: VERSION (selects input events or
+// batched input frames) and INPUT_FRAME_ACK. Called for packets this module
+// receives; when uart_host shares the UART, wire it as the host's link callback.
+void uart_device_handle_link_packet(uint8_t type, const uint8_t* payload, uint8_t len);
+
+// Features from the peer's last VERSION packet (0 if none yet)
+uint32_t uart_device_get_peer_features(void);
+
 #endif // UART_DEVICE_H
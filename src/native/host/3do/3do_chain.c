@@ -0,0 +1,298 @@
+// 3do_chain.c - 3DO PBUS daisy-chain frame decoding
+//
+// Device parsers moved here from 3do_host.c so the host driver and the
+// host replay checks share them.
+
+#include "3do_chain.h"
+#include <string.h>
+
+// ============================================================================
+// 3DO PBUS DEVICE IDS
+// ============================================================================
+
+// Device ID is in upper nibble of first byte for joypads
+// Joypad: bits 7:5 = 0b100 (value 4 in upper 3 bits)
+#define TDO_ID_JOYPAD_MASK    0xE0
+#define TDO_ID_JOYPAD_VALUE   0x80  // 0b100xxxxx
+
+// Joystick: 3-byte ID header
+#define TDO_ID_JOYSTICK_0     0x01
+#define TDO_ID_JOYSTICK_1     0x7B
+#define TDO_ID_JOYSTICK_2     0x08
+
+// Mouse ID
+#define TDO_ID_MOUSE          0x49
+
+// Lightgun ID
+#define TDO_ID_LIGHTGUN       0x4D
+
+// Arcade/JAMMA ID
+#define TDO_ID_ARCADE         0xC0
+
+// ============================================================================
+// CONTROLLER PARSING
+// ============================================================================
+
+// Parse joypad report (2 bytes)
+// Byte 0: [A][Left][Right][Up][Down][ID2][ID1][ID0]
+// Byte 1: [Tail1][Tail0][L][R][X][P][C][B]
+static void parse_joypad(tdo_controller_t* ctrl, const uint8_t* data) {
+    ctrl->type = TDO_DEVICE_JOYPAD;
+    ctrl->raw_report_size = 2;
+    memcpy(ctrl->raw_report, data, 2);
+
+    uint8_t byte0 = data[0];
+    uint8_t byte1 = data[1];
+
+    // Byte 0 - buttons and D-pad (active HIGH in 3DO protocol)
+    ctrl->button_a   = (byte0 & 0x80) != 0;
+    ctrl->dpad_left  = (byte0 & 0x40) != 0;
+    ctrl->dpad_right = (byte0 & 0x20) != 0;
+    ctrl->dpad_up    = (byte0 & 0x10) != 0;
+    ctrl->dpad_down  = (byte0 & 0x08) != 0;
+
+    // Byte 1 - more buttons
+    ctrl->button_l = (byte1 & 0x20) != 0;
+    ctrl->button_r = (byte1 & 0x10) != 0;
+    ctrl->button_x = (byte1 & 0x08) != 0;
+    ctrl->button_p = (byte1 & 0x04) != 0;
+    ctrl->button_c = (byte1 & 0x02) != 0;
+    ctrl->button_b = (byte1 & 0x01) != 0;
+
+    // Clear analog/mouse fields
+    ctrl->analog_x = 128;
+    ctrl->analog_y = 128;
+    ctrl->analog_z = 128;
+    ctrl->throttle = 128;
+    ctrl->mouse_dx = 0;
+    ctrl->mouse_dy = 0;
+    ctrl->fire = false;
+}
+
+// Parse joystick report (9 bytes)
+// Bytes 0-2: ID (0x01, 0x7B, 0x08)
+// Bytes 3-6: Analog axes
+// Byte 7: D-pad and buttons
+// Byte 8: More buttons
+static void parse_joystick(tdo_controller_t* ctrl, const uint8_t* data) {
+    ctrl->type = TDO_DEVICE_JOYSTICK;
+    ctrl->raw_report_size = 9;
+    memcpy(ctrl->raw_report, data, 9);
+
+    // Skip 3-byte ID header
+    ctrl->analog_x = data[3];   // X axis
+    ctrl->analog_y = data[4];   // Y axis
+    ctrl->analog_z = data[5];   // Z/Twist
+    ctrl->throttle = data[6];   // Throttle
+
+    uint8_t byte7 = data[7];
+    uint8_t byte8 = data[8];
+
+    // Byte 7 - D-pad and face buttons
+    ctrl->dpad_left  = (byte7 & 0x80) != 0;
+    ctrl->dpad_right = (byte7 & 0x40) != 0;
+    ctrl->dpad_down  = (byte7 & 0x20) != 0;
+    ctrl->dpad_up    = (byte7 & 0x10) != 0;
+    ctrl->button_c   = (byte7 & 0x08) != 0;
+    ctrl->button_b   = (byte7 & 0x04) != 0;
+    ctrl->button_a   = (byte7 & 0x02) != 0;
+    ctrl->fire       = (byte7 & 0x01) != 0;
+
+    // Byte 8 - shoulder and system buttons
+    ctrl->button_r = (byte8 & 0x08) != 0;
+    ctrl->button_l = (byte8 & 0x04) != 0;
+    ctrl->button_x = (byte8 & 0x02) != 0;
+    ctrl->button_p = (byte8 & 0x01) != 0;
+
+    // Clear mouse fields
+    ctrl->mouse_dx = 0;
+    ctrl->mouse_dy = 0;
+    ctrl->mouse_left = false;
+    ctrl->mouse_right = false;
+    ctrl->mouse_middle = false;
+}
+
+// Parse mouse report (4 bytes)
+// Byte 0: ID (0x49)
+// Byte 1: [dy_up:4][shift][right][middle][left]
+// Byte 2: [dx_up:2][dy_low:6]
+// Byte 3: dx_low
+static void parse_mouse(tdo_controller_t* ctrl, const uint8_t* data) {
+    ctrl->type = TDO_DEVICE_MOUSE;
+    ctrl->raw_report_size = 4;
+    memcpy(ctrl->raw_report, data, 4);
+
+    uint8_t byte1 = data[1];
+    uint8_t byte2 = data[2];
+    uint8_t byte3 = data[3];
+
+    // Buttons
+    ctrl->mouse_left   = (byte1 & 0x01) != 0;
+    ctrl->mouse_middle = (byte1 & 0x02) != 0;
+    ctrl->mouse_right  = (byte1 & 0x04) != 0;
+    // shift button at bit 3 - could map to a modifier
+
+    // Delta Y (10-bit signed)
+    int16_t dy = ((byte1 >> 4) & 0x0F) << 6 | (byte2 & 0x3F);
+    if (dy & 0x200) dy |= 0xFC00;  // Sign extend
+    ctrl->mouse_dy = (int8_t)(dy > 127 ? 127 : (dy < -128 ? -128 : dy));
+
+    // Delta X (10-bit signed)
+    int16_t dx = ((byte2 >> 6) & 0x03) << 8 | byte3;
+    if (dx & 0x200) dx |= 0xFC00;  // Sign extend
+    ctrl->mouse_dx = (int8_t)(dx > 127 ? 127 : (dx < -128 ? -128 : dx));
+
+    // Clear other fields
+    ctrl->button_a = ctrl->mouse_left;
+    ctrl->button_b = ctrl->mouse_right;
+    ctrl->button_c = ctrl->mouse_middle;
+    ctrl->analog_x = 128;
+    ctrl->analog_y = 128;
+}
+
+// ============================================================================
+// CHAIN PARSING
+// ============================================================================
+
+uint8_t tdo_chain_parse(const uint8_t* buffer, uint8_t buffer_size,
+                        tdo_controller_t* controllers, uint8_t max) {
+    uint8_t count = 0;
+    uint8_t offset = 0;
+
+    while (offset < buffer_size && count < max) {
+        uint8_t byte0 = buffer[offset];
+
+        // Check for end of chain
+        if (byte0 == 0x00) {
+            bool is_end = true;
+            for (uint8_t i = offset; i < buffer_size && i < offset + 4; i++) {
+                if (buffer[i] != 0x00) {
+                    is_end = false;
+                    break;
+                }
+            }
+            if (is_end) break;
+        }
+
+        tdo_controller_t* ctrl = &controllers[count];
+        memset(ctrl, 0, sizeof(tdo_controller_t));
+
+        // Check device type by ID
+        uint8_t id_nibble = (byte0 >> 4) & 0x0F;
+
+        // Joystick: 3-byte ID header
+        if (byte0 == TDO_ID_JOYSTICK_0 &&
+                 offset + 2 < buffer_size &&
+                 buffer[offset + 1] == TDO_ID_JOYSTICK_1 &&
+                 buffer[offset + 2] == TDO_ID_JOYSTICK_2) {
+            if (offset + 9 <= buffer_size) {
+                parse_joystick(ctrl, &buffer[offset]);
+                offset += 9;
+                count++;
+            } else break;
+        }
+        // Mouse
+        else if (byte0 == TDO_ID_MOUSE) {
+            if (offset + 4 <= buffer_size) {
+                parse_mouse(ctrl, &buffer[offset]);
+                offset += 4;
+                count++;
+            } else break;
+        }
+        // Lightgun
+        else if (byte0 == TDO_ID_LIGHTGUN) {
+            // Skip for now - 4 bytes
+            ctrl->type = TDO_DEVICE_LIGHTGUN;
+            offset += 4;
+            count++;
+        }
+        // Arcade
+        else if (byte0 == TDO_ID_ARCADE) {
+            // Skip for now - 2 bytes
+            ctrl->type = TDO_DEVICE_ARCADE;
+            offset += 2;
+            count++;
+        }
+        // Joypad: upper 3 bits of first nibble are non-zero. Tested after
+        // the exact IDs above, which would otherwise all match here.
+        else if ((id_nibble & 0x0C) != 0) {
+            if (offset + 2 <= buffer_size) {
+                parse_joypad(ctrl, &buffer[offset]);
+                offset += 2;
+                count++;
+            } else break;
+        }
+        // Unknown - skip 1 byte
+        else {
+            offset++;
+        }
+    }
+
+    // Mark remaining slots as empty
+    for (uint8_t i = count; i < max; i++) {
+        controllers[i].type = TDO_DEVICE_NONE;
+    }
+
+    return count;
+}
+
+// ============================================================================
+// FRAME CHANGE TRACKING
+// ============================================================================
+
+void tdo_chain_reset(tdo_chain_t* chain) {
+    memset(chain, 0, sizeof(*chain));
+    for (int i = 0; i < TDO_HOST_MAX_CONTROLLERS; i++) {
+        chain->controllers[i].type = TDO_DEVICE_NONE;
+        chain->controllers[i].analog_x = 128;
+        chain->controllers[i].analog_y = 128;
+        chain->controllers[i].analog_z = 128;
+        chain->controllers[i].throttle = 128;
+    }
+}
+
+// Report bytes or device type differ from the previous parse
+static bool slot_changed(const tdo_controller_t* prev, const tdo_controller_t* cur) {
+    if (prev->type != cur->type) return true;
+    if (prev->raw_report_size != cur->raw_report_size) return true;
+    return memcmp(prev->raw_report, cur->raw_report, cur->raw_report_size) != 0;
+}
+
+bool tdo_chain_update(tdo_chain_t* chain, const uint8_t* frame, uint8_t len) {
+    if (len > TDO_CHAIN_FRAME_BYTES) len = TDO_CHAIN_FRAME_BYTES;
+    chain->frames++;
+    chain->changed = 0;
+
+    // Same bytes as last time: nothing moved unless a mouse is moving
+    if (chain->prev_valid && !chain->motion &&
+        len == chain->prev_len &&
+        memcmp(frame, chain->prev_frame, len) == 0) {
+        return false;
+    }
+
+    memcpy(chain->prev_frame, frame, len);
+    chain->prev_len = len;
+    chain->prev_valid = true;
+    chain->parses++;
+
+    tdo_controller_t parsed[TDO_HOST_MAX_CONTROLLERS];
+    memset(parsed, 0, sizeof(parsed));
+    // The whole frame is parsed: zero bytes inside a report (a still mouse,
+    // a released flightstick) are not the end of the chain
+    uint8_t count = tdo_chain_parse(frame, len, parsed, TDO_HOST_MAX_CONTROLLERS);
+
+    chain->motion = false;
+    for (uint8_t i = 0; i < count; i++) {
+        bool moving = parsed[i].type == TDO_DEVICE_MOUSE &&
+                      (parsed[i].mouse_dx != 0 || parsed[i].mouse_dy != 0);
+        if (moving) chain->motion = true;
+        if (moving || i >= chain->count ||
+            slot_changed(&chain->controllers[i], &parsed[i])) {
+            chain->changed |= (uint8_t)(1u << i);
+        }
+    }
+
+    memcpy(chain->controllers, parsed, sizeof(parsed));
+    chain->count = count;
+    return true;
+}
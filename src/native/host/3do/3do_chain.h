@@ -0,0 +1,59 @@
+// 3do_chain.h - 3DO PBUS daisy-chain frame decoding
+//
+// The host driver captures the whole chain as one fixed-size frame (PIO
+// clocks it, DMA stores it). This module turns captured frames into
+// controller state and works out which slots need a router submission:
+//
+//   - a frame whose bytes match the previous one is not parsed again
+//   - after a parse, only slots whose report bytes (or device type)
+//     changed are flagged, plus mice reporting motion, since a mouse
+//     repeating the same non-zero delta is still moving
+//
+// Pure C with no SDK dependencies, so captured frames can be replayed on
+// the host (src/bench/checks/tdo_chain.c).
+
+#ifndef TDO_CHAIN_H
+#define TDO_CHAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "3do_host.h"
+
+// Bytes captured per chain frame (enough for 8 joysticks = 72 bytes)
+#ifndef TDO_CHAIN_FRAME_BYTES
+#define TDO_CHAIN_FRAME_BYTES 80
+#endif
+
+typedef struct {
+    // Decoded chain
+    tdo_controller_t controllers[TDO_HOST_MAX_CONTROLLERS];
+    uint8_t count;
+
+    // Slots to submit after the last tdo_chain_update() (bit per slot)
+    uint8_t changed;
+
+    // Previous frame, for change detection
+    uint8_t prev_frame[TDO_CHAIN_FRAME_BYTES];
+    uint8_t prev_len;
+    bool prev_valid;
+    bool motion;            // Last parse had a mouse with non-zero delta
+
+    // Counters
+    uint32_t frames;        // Frames passed to tdo_chain_update()
+    uint32_t parses;        // Frames that were parsed
+} tdo_chain_t;
+
+// Clear all slots and forget the previous frame
+void tdo_chain_reset(tdo_chain_t* chain);
+
+// Parse len bytes of chain data into out[0..max-1], stopping at four zero
+// bytes on a report boundary. Slots past the returned count are marked
+// TDO_DEVICE_NONE.
+uint8_t tdo_chain_parse(const uint8_t* data, uint8_t len,
+                        tdo_controller_t* out, uint8_t max);
+
+// Feed one captured frame. Returns true if it was parsed; chain->changed
+// then holds the slots to submit (0 when the frame was skipped).
+bool tdo_chain_update(tdo_chain_t* chain, const uint8_t* frame, uint8_t len);
+
+#endif // TDO_CHAIN_H
@@ -12,8 +12,12 @@
 //   # Sources
 //   target_sources(joypad_<app> PUBLIC
 //       ${CMAKE_CURRENT_SOURCE_DIR}/native/host/3do/3do_host.c
+//       ${CMAKE_CURRENT_SOURCE_DIR}/native/host/3do/3do_chain.c
 //   )
 //
+//   # Frame capture uses a DMA channel
+//   target_link_libraries(joypad_<app> hardware_pio hardware_dma)
+//
 //   # PIO header generation
 //   pico_generate_pio_header(joypad_<app>
 //       ${CMAKE_CURRENT_LIST_DIR}/native/host/3do/3do_host.pio
@@ -52,6 +56,12 @@
 #define TDO_CLK_HALF_PERIOD_US  1   // 500kHz clock (conservative)
 #define TDO_LATCH_DELAY_US      2   // Delay after frame start
 
+// Minimum time between chain frame captures. A frame of
+// TDO_CHAIN_FRAME_BYTES takes ~1.4ms to clock at the PIO rate below.
+#ifndef TDO_HOST_FRAME_INTERVAL_US
+#define TDO_HOST_FRAME_INTERVAL_US  2000
+#endif
+
 // ============================================================================
 // DEVICE TYPES
 // ============================================================================
@@ -118,8 +128,8 @@ void tdo_host_init(void);
 // Initialize with custom pin configuration
 void tdo_host_init_pins(uint8_t clk_pin, uint8_t data_pin);
 
-// Poll all controllers and submit events to router
-// Call this regularly from main loop
+// Collect finished chain frames and submit changed controllers to router
+// Call this regularly from main loop (returns at once while DMA captures)
 void tdo_host_task(void);
 
 // Get detected device type for a slot
@@ -135,6 +145,9 @@ bool tdo_host_is_connected(void);
 // Get number of detected controllers
 uint8_t tdo_host_get_controller_count(void);
 
+// Chain frames captured, and how many of them differed and were parsed
+void tdo_host_get_frame_stats(uint32_t* captured, uint32_t* parsed);
+
 // ============================================================================
 // HOST INTERFACE
 // ============================================================================
@@ -0,0 +1,150 @@
+// snes_frame.c - SNES port sample frame decoding
+
+#include "snes_frame.h"
+#include <string.h>
+
+// ============================================================================
+// LINE STREAMS
+// ============================================================================
+
+// Gather the even bits of x into the low 16 bits
+static uint32_t even_bits(uint32_t x)
+{
+    x &= 0x55555555u;
+    x = (x | (x >> 1)) & 0x33333333u;
+    x = (x | (x >> 2)) & 0x0F0F0F0Fu;
+    x = (x | (x >> 4)) & 0x00FF00FFu;
+    x = (x | (x >> 8)) & 0x0000FFFFu;
+    return x;
+}
+
+// Split a frame into one 64-bit stream per data line, sample n at bit n.
+// Lines are active-low, so the streams are inverted: 1 = pressed/driven.
+static void split_lines(const uint32_t* words, uint64_t* d0, uint64_t* d1)
+{
+    *d0 = 0;
+    *d1 = 0;
+    for (int i = 0; i < SNES_FRAME_WORDS; i++) {
+        uint32_t w = ~words[i];
+        *d0 |= (uint64_t)even_bits(w) << (16 * i);
+        *d1 |= (uint64_t)even_bits(w >> 1) << (16 * i);
+    }
+}
+
+// ============================================================================
+// PAD DECODING
+// ============================================================================
+
+// 7-bit magnitude shifted MSB first, with a leading direction bit
+static int8_t mouse_axis(uint32_t bits8)
+{
+    uint8_t mag = 0;
+    for (int i = 1; i < 8; i++) {
+        mag = (uint8_t)((mag << 1) | ((bits8 >> i) & 1));
+    }
+    return (bits8 & 1) ? (int8_t)-mag : (int8_t)mag;
+}
+
+// Decode the pad behind clocks [offset, offset + clocks) of one line.
+// A pad keeps shifting out 1s after its 16 bits; an empty line reads 0s.
+static void decode_pad(uint64_t line, int offset, int clocks, snes_pad_state_t* pad)
+{
+    uint16_t bits = (uint16_t)(line >> offset);
+    uint32_t tail_len = (uint32_t)(clocks - 16);
+    uint32_t tail_mask = (1u << tail_len) - 1;
+    uint32_t tail = (uint32_t)(line >> (offset + 16)) & tail_mask;
+    uint8_t id = bits >> 12;
+
+    pad->dx = 0;
+    pad->dy = 0;
+    pad->buttons = bits;
+
+    if (id == 0x0 && tail == tail_mask) {
+        pad->type = SNES_DEVICE_CONTROLLER;
+        pad->buttons &= 0x0FFF;
+    } else if (id == 0xF && (bits & 0x0F00) == 0x0F00 && tail == tail_mask) {
+        pad->type = SNES_DEVICE_NES;
+        pad->buttons &= 0x00FF;
+    } else if (id == 0x8 && clocks >= 32) {
+        // Mouse: signature 0001 in bits 12-15, Y then X displacement
+        pad->type = SNES_DEVICE_MOUSE;
+        pad->buttons &= SNES_MOUSE_BIT_LEFT | SNES_MOUSE_BIT_RIGHT;
+        pad->dy = mouse_axis(tail & 0xFF);
+        pad->dx = mouse_axis((tail >> 8) & 0xFF);
+    } else {
+        // Empty port, or a device this driver doesn't read (keyboard)
+        pad->type = SNES_DEVICE_NONE;
+        pad->buttons = 0;
+    }
+}
+
+bool snes_frame_decode(const uint32_t* words, snes_pad_state_t* pads)
+{
+    uint64_t d0, d1;
+    split_lines(words, &d0, &d1);
+
+    // A multitap drives DATA1 low for as long as LATCH is high
+    uint32_t detect_mask = (1u << SNES_FRAME_DETECT) - 1;
+    bool multitap = ((uint32_t)d1 & detect_mask) == detect_mask;
+
+    int a = SNES_FRAME_DETECT;
+    int b = SNES_FRAME_DETECT + SNES_FRAME_PHASE_A;
+
+    decode_pad(d0, a, SNES_FRAME_PHASE_A, &pads[0]);
+    if (multitap) {
+        decode_pad(d1, a, SNES_FRAME_PHASE_A, &pads[1]);
+        decode_pad(d0, b, SNES_FRAME_PHASE_B, &pads[2]);
+        decode_pad(d1, b, SNES_FRAME_PHASE_B, &pads[3]);
+    } else {
+        for (int i = 1; i < SNES_MAX_PORTS; i++) {
+            memset(&pads[i], 0, sizeof(pads[i]));
+            pads[i].type = SNES_DEVICE_NONE;
+        }
+    }
+    return multitap;
+}
+
+// ============================================================================
+// FRAME CHANGE TRACKING
+// ============================================================================
+
+void snes_frame_reset(snes_frame_t* frame)
+{
+    memset(frame, 0, sizeof(*frame));
+    for (int i = 0; i < SNES_MAX_PORTS; i++) {
+        frame->pads[i].type = SNES_DEVICE_NONE;
+    }
+}
+
+bool snes_frame_update(snes_frame_t* frame, const uint32_t* words)
+{
+    frame->frames++;
+    frame->changed = 0;
+
+    // Same samples as last time: nothing changed unless a mouse is moving
+    if (frame->prev_valid && !frame->motion &&
+        memcmp(words, frame->prev_words, sizeof(frame->prev_words)) == 0) {
+        return false;
+    }
+
+    memcpy(frame->prev_words, words, sizeof(frame->prev_words));
+    frame->prev_valid = true;
+    frame->decodes++;
+
+    snes_pad_state_t pads[SNES_MAX_PORTS];
+    frame->multitap = snes_frame_decode(words, pads);
+
+    frame->motion = false;
+    for (int i = 0; i < SNES_MAX_PORTS; i++) {
+        const snes_pad_state_t* prev = &frame->pads[i];
+        bool moving = pads[i].type == SNES_DEVICE_MOUSE &&
+                      (pads[i].dx != 0 || pads[i].dy != 0);
+        if (moving) frame->motion = true;
+        if (moving || pads[i].type != prev->type || pads[i].buttons != prev->buttons) {
+            frame->changed |= (uint8_t)(1u << i);
+        }
+    }
+
+    memcpy(frame->pads, pads, sizeof(pads));
+    return true;
+}
@@ -0,0 +1,95 @@
+// snes_frame.h - SNES port sample frame decoding
+//
+// The SNES host PIO program (snes_host.pio) latches the port and clocks
+// both data lines on its own, pushing one frame of line samples per poll:
+//
+//   samples  0-7    LATCH high, IOBIT high: a multitap pulls DATA1 low
+//   samples  8-39   IOBIT high: pad on DATA0 (32 bits, enough for a mouse),
+//                   multitap pads 1 (DATA0) and 2 (DATA1)
+//   samples 40-63   IOBIT low: multitap pads 3 (DATA0) and 4 (DATA1)
+//
+// Each sample is two bits (DATA0 in the low bit), packed LSB first into
+// SNES_FRAME_WORDS words. This module decodes frames into pad state and,
+// like the 3DO chain decoder, skips frames identical to the previous one
+// and flags only the ports whose state changed (plus a moving mouse).
+//
+// Pure C with no SDK dependencies, so frames can be replayed on the host
+// (src/bench/checks/snes_frame.c).
+
+#ifndef SNES_FRAME_H
+#define SNES_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "snes_host.h"
+
+#define SNES_FRAME_WORDS        4
+#define SNES_FRAME_DETECT       8       // Samples with LATCH high
+#define SNES_FRAME_PHASE_A      32      // Clocks with IOBIT high
+#define SNES_FRAME_PHASE_B      24      // Clocks with IOBIT low
+
+// Device types (values returned by snes_host_get_device_type())
+#define SNES_DEVICE_NONE        -1
+#define SNES_DEVICE_CONTROLLER  0
+#define SNES_DEVICE_NES         1
+#define SNES_DEVICE_MOUSE       2
+
+// Button bits, in shift order (active-high after decoding)
+#define SNES_BIT_B              (1u << 0)
+#define SNES_BIT_Y              (1u << 1)
+#define SNES_BIT_SELECT         (1u << 2)
+#define SNES_BIT_START          (1u << 3)
+#define SNES_BIT_UP             (1u << 4)
+#define SNES_BIT_DOWN           (1u << 5)
+#define SNES_BIT_LEFT           (1u << 6)
+#define SNES_BIT_RIGHT          (1u << 7)
+#define SNES_BIT_A              (1u << 8)
+#define SNES_BIT_X              (1u << 9)
+#define SNES_BIT_L              (1u << 10)
+#define SNES_BIT_R              (1u << 11)
+
+// NES pads shift A first, then B (the rest match)
+#define NES_BIT_A               (1u << 0)
+#define NES_BIT_B               (1u << 1)
+
+// Mouse buttons
+#define SNES_MOUSE_BIT_RIGHT    (1u << 8)
+#define SNES_MOUSE_BIT_LEFT     (1u << 9)
+
+typedef struct {
+    int8_t type;            // SNES_DEVICE_*
+    uint16_t buttons;       // First 16 bits, 1 = pressed
+    int8_t dx;              // Mouse motion (right/down positive)
+    int8_t dy;
+} snes_pad_state_t;
+
+typedef struct {
+    snes_pad_state_t pads[SNES_MAX_PORTS];
+    bool multitap;
+
+    // Ports to submit after the last snes_frame_update() (bit per port)
+    uint8_t changed;
+
+    // Previous frame, for change detection
+    uint32_t prev_words[SNES_FRAME_WORDS];
+    bool prev_valid;
+    bool motion;            // Last decode had a mouse with non-zero motion
+
+    // Counters
+    uint32_t frames;        // Frames passed to snes_frame_update()
+    uint32_t decodes;       // Frames that were decoded
+} snes_frame_t;
+
+// Clear all ports and forget the previous frame
+void snes_frame_reset(snes_frame_t* frame);
+
+// Decode raw line samples (1 = line high) into pads[0..SNES_MAX_PORTS-1].
+// Without a multitap only port 0 is used. Returns true if a multitap
+// answered during the latch.
+bool snes_frame_decode(const uint32_t* words, snes_pad_state_t* pads);
+
+// Feed one sampled frame. Returns true if it was decoded; frame->changed
+// then holds the ports to submit (0 when the frame was skipped).
+bool snes_frame_update(snes_frame_t* frame, const uint32_t* words);
+
+#endif // SNES_FRAME_H
@@ -1,25 +1,62 @@
 // snes_host.c - Native SNES/NES Controller Host Driver
 //
-// Polls native SNES/NES controllers via the SNESpad library and submits
-// input events to the router.
+// Samples native SNES/NES controllers (directly or through a multitap) and
+// submits input events to the router.
+//
+// A PIO program latches and clocks the port at SNES_HOST_SAMPLE_US without
+// CPU help. A DMA channel stores each frame of line samples into a ring and
+// chains to a second channel that stores the timer value next to it, then
+// chains back. snes_host_task() walks the frames that arrived since its last
+// call and submits ports whose state changed, with the sample time of the
+// frame that changed them.
 
 #include "snes_host.h"
+#include "snes_frame.h"
+#include "snes_host.pio.h"
 #include "native/host/host_interface.h"
-#include "snespad_c.h"
 #include "core/router/router.h"
 #include "core/input_event.h"
 #include "core/buttons.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/timer.h"
+#include "pico/stdlib.h"
 #include <stdio.h>
 
 // ============================================================================
 // INTERNAL STATE
 // ============================================================================
 
-static snespad_t snes_pads[SNES_MAX_PORTS];
+static PIO snes_pio = pio1;
+static uint snes_sm = 0;
 static bool initialized = false;
 
-// Track previous state for edge detection
-static uint32_t prev_buttons[SNES_MAX_PORTS] = {0};
+// Decoded ports and frame change tracking
+static snes_frame_t snes_frame;
+
+// Sample ring: SNES_SAMPLE_RING frames written by the DMA pair. Both
+// buffers wrap through the DMA write-address ring, so they are aligned to
+// their size.
+#define SNES_SAMPLE_RING        16      // Frames (power of two)
+static uint32_t sample_ring[SNES_SAMPLE_RING * SNES_FRAME_WORDS]
+    __attribute__((aligned(SNES_SAMPLE_RING * SNES_FRAME_WORDS * 4)));
+static uint32_t stamp_ring[SNES_SAMPLE_RING]
+    __attribute__((aligned(SNES_SAMPLE_RING * 4)));
+
+static int sample_dma_chan = -1;
+static int stamp_dma_chan = -1;
+
+static uint32_t next_frame = 0;         // Next ring slot to read (free running)
+static uint32_t last_stamp_us = 0;      // End time of the last frame read
+static uint32_t frame_period_us = 0;
+static uint32_t frames_lost = 0;
+
+// Sample time (LATCH) of the frame that last changed each port
+static uint32_t port_sample_us[SNES_MAX_PORTS];
+
+// Sample-to-submit age of the last submission
+static uint32_t last_age_us = 0;
+static uint32_t max_age_us = 0;
 
 // ============================================================================
 // BUTTON MAPPING: SNES → USBR
@@ -27,54 +64,159 @@ static uint32_t prev_buttons[SNES_MAX_PORTS] = {0};
 
 // Map SNES controller state to USBR button format
 // Uses Switch-style layout (matches GP2040-CE Switch column)
-static uint32_t map_snes_to_usbr(const snespad_t* pad)
+static uint32_t map_snes_to_usbr(uint16_t bits)
 {
     uint32_t buttons = 0x00000000;  // USBR uses active-high
 
     // Face buttons - Switch layout
-    if (pad->button_b)      buttons |= JP_BUTTON_B1;  // SNES B → B1 (Switch B)
-    if (pad->button_a)      buttons |= JP_BUTTON_B2;  // SNES A → B2 (Switch A)
-    if (pad->button_y)      buttons |= JP_BUTTON_B3;  // SNES Y → B3 (Switch Y)
-    if (pad->button_x)      buttons |= JP_BUTTON_B4;  // SNES X → B4 (Switch X)
+    if (bits & SNES_BIT_B)      buttons |= JP_BUTTON_B1;  // SNES B → B1 (Switch B)
+    if (bits & SNES_BIT_A)      buttons |= JP_BUTTON_B2;  // SNES A → B2 (Switch A)
+    if (bits & SNES_BIT_Y)      buttons |= JP_BUTTON_B3;  // SNES Y → B3 (Switch Y)
+    if (bits & SNES_BIT_X)      buttons |= JP_BUTTON_B4;  // SNES X → B4 (Switch X)
 
     // Shoulder buttons
-    if (pad->button_l)      buttons |= JP_BUTTON_L1;  // SNES L → L1
-    if (pad->button_r)      buttons |= JP_BUTTON_R1;  // SNES R → R1
+    if (bits & SNES_BIT_L)      buttons |= JP_BUTTON_L1;  // SNES L → L1
+    if (bits & SNES_BIT_R)      buttons |= JP_BUTTON_R1;  // SNES R → R1
 
     // System buttons
-    if (pad->button_start)  buttons |= JP_BUTTON_S2;  // Start → S2 (Plus)
-    if (pad->button_select) buttons |= JP_BUTTON_S1;  // Select → S1 (Minus)
+    if (bits & SNES_BIT_START)  buttons |= JP_BUTTON_S2;  // Start → S2 (Plus)
+    if (bits & SNES_BIT_SELECT) buttons |= JP_BUTTON_S1;  // Select → S1 (Minus)
 
     // D-pad
-    if (pad->direction_up)    buttons |= JP_BUTTON_DU;
-    if (pad->direction_down)  buttons |= JP_BUTTON_DD;
-    if (pad->direction_left)  buttons |= JP_BUTTON_DL;
-    if (pad->direction_right) buttons |= JP_BUTTON_DR;
+    if (bits & SNES_BIT_UP)     buttons |= JP_BUTTON_DU;
+    if (bits & SNES_BIT_DOWN)   buttons |= JP_BUTTON_DD;
+    if (bits & SNES_BIT_LEFT)   buttons |= JP_BUTTON_DL;
+    if (bits & SNES_BIT_RIGHT)  buttons |= JP_BUTTON_DR;
 
     return buttons;
 }
 
 // Map NES controller state to USBR button format
 // Uses Switch-style layout (matches GP2040-CE Switch column)
-static uint32_t map_nes_to_usbr(const snespad_t* pad)
+static uint32_t map_nes_to_usbr(uint16_t bits)
 {
     uint32_t buttons = 0x00000000;  // USBR uses active-high
 
     // NES has only A, B, Start, Select, D-pad
-    if (pad->button_b)      buttons |= JP_BUTTON_B1;  // NES B → B1 (Switch B)
-    if (pad->button_a)      buttons |= JP_BUTTON_B2;  // NES A → B2 (Switch A)
+    if (bits & NES_BIT_B)       buttons |= JP_BUTTON_B1;  // NES B → B1 (Switch B)
+    if (bits & NES_BIT_A)       buttons |= JP_BUTTON_B2;  // NES A → B2 (Switch A)
 
-    if (pad->button_start)  buttons |= JP_BUTTON_S2;
-    if (pad->button_select) buttons |= JP_BUTTON_S1;
+    if (bits & SNES_BIT_START)  buttons |= JP_BUTTON_S2;
+    if (bits & SNES_BIT_SELECT) buttons |= JP_BUTTON_S1;
 
-    if (pad->direction_up)    buttons |= JP_BUTTON_DU;
-    if (pad->direction_down)  buttons |= JP_BUTTON_DD;
-    if (pad->direction_left)  buttons |= JP_BUTTON_DL;
-    if (pad->direction_right) buttons |= JP_BUTTON_DR;
+    if (bits & SNES_BIT_UP)     buttons |= JP_BUTTON_DU;
+    if (bits & SNES_BIT_DOWN)   buttons |= JP_BUTTON_DD;
+    if (bits & SNES_BIT_LEFT)   buttons |= JP_BUTTON_DL;
+    if (bits & SNES_BIT_RIGHT)  buttons |= JP_BUTTON_DR;
 
     return buttons;
 }
 
+// ============================================================================
+// SAMPLE CAPTURE
+// ============================================================================
+
+// Start the DMA pair and the PIO program. The sample channel takes one
+// frame from the RX FIFO and chains to the stamp channel, which copies the
+// timer into stamp_ring and chains back; each trigger reloads the transfer
+// count, and both write addresses wrap through their rings.
+static void sample_start(uint32_t interval_us)
+{
+    sample_dma_chan = dma_claim_unused_channel(true);
+    stamp_dma_chan = dma_claim_unused_channel(true);
+
+    for (int i = 0; i < SNES_SAMPLE_RING; i++) stamp_ring[i] = 0;
+
+    dma_channel_config c = dma_channel_get_default_config(stamp_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(sizeof(stamp_ring)));
+    channel_config_set_chain_to(&c, sample_dma_chan);
+    dma_channel_configure(stamp_dma_chan, &c, stamp_ring, &timer_hw->timerawl, 1, false);
+
+    c = dma_channel_get_default_config(sample_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(sizeof(sample_ring)));
+    channel_config_set_dreq(&c, pio_get_dreq(snes_pio, snes_sm, false));
+    channel_config_set_chain_to(&c, stamp_dma_chan);
+    dma_channel_configure(sample_dma_chan, &c, sample_ring, &snes_pio->rxf[snes_sm],
+                          SNES_FRAME_WORDS, true);
+
+    uint32_t idle = snes_host_sample_idle_count(interval_us);
+    frame_period_us = (SNES_PIO_FRAME_CYCLES + SNES_PIO_IDLE_CYCLES * idle) /
+                      (SNES_PIO_HZ / 1000000u);
+
+    next_frame = 0;
+    last_stamp_us = time_us_32();
+    pio_sm_put(snes_pio, snes_sm, idle);
+    pio_sm_set_enabled(snes_pio, snes_sm, true);
+}
+
+// Returns the next finished frame and its sample time, or NULL. A slot is
+// finished once its stamp is newer than the last frame read.
+static const uint32_t* sample_next(uint32_t* sample_us)
+{
+    uint32_t slot = next_frame & (SNES_SAMPLE_RING - 1);
+    uint32_t stamp = stamp_ring[slot];
+    if ((int32_t)(stamp - last_stamp_us) <= 0) return NULL;
+
+    // More than a frame period since the previous one: the ring lapped us
+    if (next_frame > 0 && stamp - last_stamp_us > frame_period_us * 3 / 2) {
+        frames_lost += (stamp - last_stamp_us) / frame_period_us - 1;
+    }
+
+    last_stamp_us = stamp;
+    next_frame++;
+    *sample_us = stamp - SNES_PIO_ACTIVE_CYCLES / (SNES_PIO_HZ / 1000000u);
+    return &sample_ring[slot * SNES_FRAME_WORDS];
+}
+
+// ============================================================================
+// SUBMISSION
+// ============================================================================
+
+static void submit_port(uint8_t port, const snes_pad_state_t* pad)
+{
+    input_event_t event;
+    init_input_event(&event);
+
+    event.dev_addr = 0xF0 + port;  // Use 0xF0+ range for native inputs
+    event.source = INPUT_SOURCE_NATIVE_SNES;
+    event.instance = 0;
+    event.type = INPUT_TYPE_GAMEPAD;
+    event.analog[ANALOG_X] = 128;
+    event.analog[ANALOG_Y] = 128;
+    event.analog[ANALOG_Z] = 128;
+    event.analog[ANALOG_RX] = 128;
+
+    switch (pad->type) {
+        case SNES_DEVICE_CONTROLLER:
+            event.buttons = map_snes_to_usbr(pad->buttons);
+            break;
+
+        case SNES_DEVICE_NES:
+            event.buttons = map_nes_to_usbr(pad->buttons);
+            break;
+
+        case SNES_DEVICE_MOUSE:
+            event.type = INPUT_TYPE_MOUSE;
+            if (pad->buttons & SNES_MOUSE_BIT_LEFT)  event.buttons |= JP_BUTTON_B1;
+            if (pad->buttons & SNES_MOUSE_BIT_RIGHT) event.buttons |= JP_BUTTON_B2;
+            event.delta_x = pad->dx;
+            event.delta_y = pad->dy;
+            break;
+
+        default:
+            // Unplugged: release everything it was holding
+            break;
+    }
+
+    router_submit_input(&event);
+}
+
 // ============================================================================
 // PUBLIC API
 // ============================================================================
@@ -95,98 +237,46 @@ void snes_host_init_pins(uint8_t clock, uint8_t latch, uint8_t data0,
     printf("[snes_host]   CLK=%d, LATCH=%d, D0=%d, D1=%d, IOBIT=%d\n",
            clock, latch, data0, data1, iobit);
 
-    // Initialize SNESpad for port 0 (direct connection or multitap port 1)
-    // TODO: Add multitap support - ports 1-3 would use different data pins
-    //   Port 0: DATA0 (controller 1 or multitap 1)
-    //   Port 1: DATA1 (controller 2 or multitap 2) - needs IOBIT toggle
-    //   Port 2: DATA0 after IOBIT toggle (multitap 3)
-    //   Port 3: DATA1 after IOBIT toggle (multitap 4)
-    snespad_init(&snes_pads[0], clock, latch, data0, data1, iobit);
-    snespad_begin(&snes_pads[0]);
-    snespad_start(&snes_pads[0]);
-    prev_buttons[0] = 0xFFFFFFFF;
-
-    // Mark other ports as not initialized until multitap support is added
-    for (int i = 1; i < SNES_MAX_PORTS; i++) {
-        snes_pads[i].type = SNESPAD_NONE;
-        prev_buttons[i] = 0xFFFFFFFF;
+    // The PIO program drives CLK/LATCH as one sideset pair and samples
+    // DATA0/DATA1 with one IN instruction
+    if (latch != clock + 1 || data1 != data0 + 1) {
+        printf("[snes_host] ERROR: LATCH must follow CLK and D1 must follow D0\n");
+        return;
     }
 
+    snes_frame_reset(&snes_frame);
+    for (int i = 0; i < SNES_MAX_PORTS; i++) port_sample_us[i] = 0;
+
+    snes_sm = pio_claim_unused_sm(snes_pio, true);
+    uint offset = pio_add_program(snes_pio, &snes_host_sample_program);
+    snes_host_sample_program_init(snes_pio, snes_sm, offset, clock, data0, iobit);
+    sample_start(SNES_HOST_SAMPLE_US);
+
     initialized = true;
-    printf("[snes_host] Initialization complete (port 0 active, ports 1-3 reserved for multitap)\n");
+    printf("[snes_host] Initialization complete (sampling every %lu us, multitap auto-detect)\n",
+           (unsigned long)frame_period_us);
 }
 
 void snes_host_task(void)
 {
     if (!initialized) return;
 
-    // Currently only port 0 is active (direct connection)
-    // TODO: Expand when multitap support is added
-    for (int port = 0; port < 1; port++) {  // Only poll port 0 for now
-        snespad_t* pad = &snes_pads[port];
+    // Frames that arrived since the last call, oldest first
+    uint32_t sample_us;
+    const uint32_t* words;
+    while ((words = sample_next(&sample_us)) != NULL) {
+        // Unchanged frames are not decoded again
+        if (!snes_frame_update(&snes_frame, words)) continue;
 
-        // Poll the controller
-        snespad_poll(pad);
-
-        // Skip if no device connected
-        if (pad->type == SNESPAD_NONE) {
-            continue;
-        }
+        for (uint8_t port = 0; port < SNES_MAX_PORTS; port++) {
+            if (!(snes_frame.changed & (1u << port))) continue;
 
-        // Map buttons based on device type
-        uint32_t buttons;
-        uint8_t analog_1x = 128;  // Center
-        uint8_t analog_1y = 128;
-        uint8_t analog_2x = 128;
-        uint8_t analog_2y = 128;
-
-        switch (pad->type) {
-            case SNESPAD_CONTROLLER:
-                buttons = map_snes_to_usbr(pad);
-                break;
-
-            case SNESPAD_NES:
-                buttons = map_nes_to_usbr(pad);
-                break;
-
-            case SNESPAD_MOUSE:
-                // Mouse: use mouse_x/y as analog stick position
-                buttons = 0x00000000;
-                if (pad->button_a) buttons |= JP_BUTTON_B1;
-                if (pad->button_b) buttons |= JP_BUTTON_B2;
-                analog_1x = pad->mouse_x;
-                analog_1y = pad->mouse_y;
-                break;
-
-            case SNESPAD_KEYBOARD:
-                // Keyboard: could map to buttons, but skip for now
-                continue;
-
-            default:
-                continue;
-        }
+            port_sample_us[port] = sample_us;
+            submit_port(port, &snes_frame.pads[port]);
 
-        // Only submit if state changed
-        if (buttons == prev_buttons[port]) {
-            continue;
+            last_age_us = time_us_32() - sample_us;
+            if (last_age_us > max_age_us) max_age_us = last_age_us;
         }
-        prev_buttons[port] = buttons;
-
-        // Build input event
-        input_event_t event;
-        init_input_event(&event);
-
-        event.dev_addr = 0xF0 + port;  // Use 0xF0+ range for native inputs
-        event.instance = 0;
-        event.type = INPUT_TYPE_GAMEPAD;
-        event.buttons = buttons;
-        event.analog[ANALOG_X] = analog_1x;
-        event.analog[ANALOG_Y] = analog_1y;
-        event.analog[ANALOG_Z] = analog_2x;
-        event.analog[ANALOG_RX] = analog_2y;
-
-        // Submit to router
-        router_submit_input(&event);
     }
 }
 
@@ -195,7 +285,28 @@ int8_t snes_host_get_device_type(uint8_t port)
     if (!initialized || port >= SNES_MAX_PORTS) {
         return -1;
     }
-    return snes_pads[port].type;
+    return snes_frame.pads[port].type;
+}
+
+uint32_t snes_host_get_sample_time(uint8_t port)
+{
+    if (!initialized || port >= SNES_MAX_PORTS) return 0;
+    return port_sample_us[port];
+}
+
+bool snes_host_has_multitap(void)
+{
+    return initialized && snes_frame.multitap;
+}
+
+void snes_host_get_stats(snes_host_stats_t* stats)
+{
+    stats->frames = snes_frame.frames;
+    stats->decodes = snes_frame.decodes;
+    stats->frames_lost = frames_lost;
+    stats->period_us = frame_period_us;
+    stats->last_age_us = last_age_us;
+    stats->max_age_us = max_age_us;
 }
 
 bool snes_host_is_connected(void)
@@ -203,7 +314,7 @@ bool snes_host_is_connected(void)
     if (!initialized) return false;
 
     for (int i = 0; i < SNES_MAX_PORTS; i++) {
-        if (snes_pads[i].type != SNESPAD_NONE) {
+        if (snes_frame.pads[i].type != SNES_DEVICE_NONE) {
             return true;
         }
     }
@@ -248,7 +359,7 @@ static uint8_t snes_get_device_count(void)
 {
     uint8_t count = 0;
     for (int i = 0; i < SNES_MAX_PORTS; i++) {
-        if (snes_pads[i].type != SNESPAD_NONE) {
+        if (snes_frame.pads[i].type != SNES_DEVICE_NONE) {
             count++;
         }
     }
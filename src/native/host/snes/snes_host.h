@@ -1,8 +1,9 @@
 // snes_host.h - Native SNES/NES Controller Host Driver
 //
-// Polls native SNES/NES controllers via the SNESpad library and submits
-// input events to the router. Supports SNES controllers, NES controllers,
-// SNES mouse, and Xband keyboard.
+// Samples native SNES/NES controllers with a PIO program and submits input
+// events to the router. Supports SNES controllers, NES controllers, SNES
+// mouse, and a multitap with up to four pads.
+
 
 #ifndef SNES_HOST_H
 #define SNES_HOST_H
@@ -37,32 +38,56 @@
 #define SNES_PIN_IOBIT  6   // I/O bit (for mouse/keyboard)
 #endif
 
+// LATCH must be CLOCK + 1 and DATA1 must be DATA0 + 1 (PIO pin groups)
+
 // Maximum number of SNES ports
 // Port 0: DATA0 directly (single controller or multitap port 1)
-// Ports 1-3: Reserved for future multitap support
-// Note: Actual multitap support requires SNESpad library extension
+// Ports 1-3: Multitap ports 2-4 (DATA1, then DATA0/DATA1 with IOBIT low)
 #define SNES_MAX_PORTS 4
 
+// Time between samples of the port (latch + clocking is ~220us)
+#ifndef SNES_HOST_SAMPLE_US
+#define SNES_HOST_SAMPLE_US 1000
+#endif
+
+typedef struct {
+    uint32_t frames;        // Frames sampled and read
+    uint32_t decodes;       // Frames that differed and were decoded
+    uint32_t frames_lost;   // Frames overwritten before the task read them
+    uint32_t period_us;     // Actual sample period
+    uint32_t last_age_us;   // Sample to router submission, last change
+    uint32_t max_age_us;
+} snes_host_stats_t;
+
 // ============================================================================
 // PUBLIC API
 // ============================================================================
 
 // Initialize SNES host driver
-// Sets up GPIO pins and initializes SNESpad library
+// Sets up GPIO pins and starts the PIO/DMA sampler
 void snes_host_init(void);
 
 // Initialize with custom pin configuration
 void snes_host_init_pins(uint8_t clock, uint8_t latch, uint8_t data0,
                          uint8_t data1, uint8_t iobit);
 
-// Poll SNES controllers and submit events to router
+// Read sampled frames and submit changed ports to router
 // Call this regularly from main loop (typically from app's task function)
 void snes_host_task(void);
 
 // Get detected device type for a port
-// Returns: -1=none, 0=SNES controller, 1=NES, 2=mouse, 3=keyboard
+// Returns: -1=none, 0=SNES controller, 1=NES, 2=mouse
 int8_t snes_host_get_device_type(uint8_t port);
 
+// time_us_32() at which the frame that last changed a port was latched
+uint32_t snes_host_get_sample_time(uint8_t port);
+
+// True while a multitap answers on the port
+bool snes_host_has_multitap(void);
+
+// Sampling and latency counters
+void snes_host_get_stats(snes_host_stats_t* stats);
+
 // Check if any SNES controller is connected
 bool snes_host_is_connected(void);
 
@@ -3,13 +3,18 @@
 // Receives controller inputs from a remote device over UART and submits
 // them to the router. Supports both normal mode (inputs go to router)
 // and AI blend mode (inputs can blend with existing player inputs).
+//
+// Reception runs on DMA into a ring buffer, so bytes keep landing while
+// core 0 is busy elsewhere; the task parses whole packets in place.
 
 #include "uart_host.h"
 #include "core/uart/uart_protocol.h"
+#include "core/uart/uart_frame.h"
 #include "core/router/router.h"
 #include "core/input_event.h"
 #include "hardware/uart.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
 #include "pico/stdlib.h"
 #include <string.h>
 #include <stdio.h>
@@ -22,20 +27,23 @@ static bool initialized = false;
 static uart_inst_t* uart_port = UART_HOST_PERIPHERAL;
 static uart_host_mode_t host_mode = UART_HOST_MODE_NORMAL;
 
-// Receive state machine
-typedef enum {
-    RX_STATE_SYNC,              // Waiting for sync byte
-    RX_STATE_LENGTH,            // Reading length byte
-    RX_STATE_TYPE,              // Reading packet type
-    RX_STATE_PAYLOAD,           // Reading payload
-    RX_STATE_CRC,               // Reading CRC
-} rx_state_t;
-
-static rx_state_t rx_state = RX_STATE_SYNC;
-static uint8_t rx_buffer[UART_PROTOCOL_MAX_PAYLOAD + UART_OVERHEAD];
-static uint8_t rx_index = 0;
-static uint8_t rx_length = 0;
-static uint8_t rx_type = 0;
+// Receive ring. DMA (or the FIFO fallback) appends at rx_head and the
+// parser consumes from rx_tail. Both are free-running byte counts; the ring
+// index is their low bits, which the DMA write-address wrap keeps in step.
+#define RX_RING_MASK            (UART_HOST_RX_RING_SIZE - 1)
+#define RX_AT(pos)              rx_ring[(pos) & RX_RING_MASK]
+#define RX_DMA_COUNT            0xFFFFFFFFu
+
+static uint8_t rx_ring[UART_HOST_RX_RING_SIZE] __attribute__((aligned(UART_HOST_RX_RING_SIZE)));
+static uint32_t rx_head = 0;
+static uint32_t rx_tail = 0;
+static int rx_dma_chan = -1;
+static uint32_t rx_dma_base = 0;        // rx_head when the channel was last triggered
+static uint32_t rx_idle_head = 0;       // rx_head when a partial packet was last seen
+static uint32_t rx_idle_since = 0;
+
+// Payload of a packet that straddles the ring wrap (the only copy made)
+static uint8_t rx_wrap_payload[UART_PROTOCOL_MAX_PAYLOAD];
 
 // AI injection state per player
 typedef struct {
@@ -47,20 +55,57 @@ typedef struct {
 
 static ai_injection_t ai_injections[UART_HOST_MAX_PLAYERS];
 
+// Batched input frame state (delta bases)
+static uart_frame_decoder_t frame_decoder;
+
 // Statistics
 static uint32_t rx_count = 0;
 static uint32_t error_count = 0;
 static uint32_t crc_errors = 0;
+static uint32_t rx_overruns = 0;
 static uint32_t last_rx_time = 0;
 
 // Callbacks
 static uart_host_profile_callback_t profile_callback = NULL;
 static uart_host_mode_callback_t output_mode_callback = NULL;
+static uart_host_send_callback_t send_callback = NULL;
+static uart_host_link_callback_t link_callback = NULL;
 
 // ============================================================================
 // PACKET PROCESSING
 // ============================================================================
 
+// Submit one remote player's state (INPUT_EVENT or a player from an INPUT_FRAME)
+static void submit_remote_input(const uart_input_event_t* evt)
+{
+    if (evt->player_index >= UART_HOST_MAX_PLAYERS) return;
+
+    // Build input event
+    input_event_t event;
+    init_input_event(&event);
+
+    // Use 0xD0+ range for UART inputs (0xD0-0xD7)
+    event.dev_addr = 0xD0 + evt->player_index;
+    event.source = INPUT_SOURCE_UART;
+    event.instance = 0;
+    event.type = evt->device_type;
+    event.buttons = evt->buttons;
+    event.analog[ANALOG_X] = evt->analog[0];
+    event.analog[ANALOG_Y] = evt->analog[1];
+    event.analog[ANALOG_Z] = evt->analog[2];
+    event.analog[ANALOG_RX] = evt->analog[3];
+    event.analog[ANALOG_RZ] = evt->analog[4];
+    event.analog[ANALOG_SLIDER] = evt->analog[5];
+    event.delta_x = evt->delta_x;
+    event.delta_y = evt->delta_y;
+
+    if (host_mode == UART_HOST_MODE_NORMAL) {
+        // Submit directly to router like USB/native inputs
+        router_submit_input(&event);
+    }
+    // In AI_BLEND mode, inputs are stored and retrieved via uart_host_get_injection()
+}
+
 // Process a complete received packet
 static void process_packet(uint8_t type, const uint8_t* payload, uint8_t len)
 {
@@ -77,35 +122,36 @@ static void process_packet(uint8_t type, const uint8_t* payload, uint8_t len)
             if (len < sizeof(uart_input_event_t)) break;
 
             const uart_input_event_t* evt = (const uart_input_event_t*)payload;
+            submit_remote_input(evt);
+            break;
+        }
 
-            if (evt->player_index >= UART_HOST_MAX_PLAYERS) break;
-
-            // Build input event
-            input_event_t event;
-            init_input_event(&event);
-
-            // Use 0xD0+ range for UART inputs (0xD0-0xD7)
-            event.dev_addr = 0xD0 + evt->player_index;
-            event.instance = 0;
-            event.type = evt->device_type;
-            event.buttons = evt->buttons;
-            event.analog[ANALOG_X] = evt->analog[0];
-            event.analog[ANALOG_Y] = evt->analog[1];
-            event.analog[ANALOG_Z] = evt->analog[2];
-            event.analog[ANALOG_RX] = evt->analog[3];
-            event.analog[ANALOG_RZ] = evt->analog[4];
-            event.analog[ANALOG_SLIDER] = evt->analog[5];
-            event.delta_x = evt->delta_x;
-            event.delta_y = evt->delta_y;
-
-            if (host_mode == UART_HOST_MODE_NORMAL) {
-                // Submit directly to router like USB/native inputs
-                router_submit_input(&event);
+        case UART_PKT_INPUT_FRAME: {
+            uart_frame_result_t result;
+            if (!uart_frame_decode(&frame_decoder, payload, len, &result)) {
+                error_count++;
+                break;
+            }
+
+            for (uint8_t i = 0; i < UART_FRAME_PLAYERS; i++) {
+                if (result.players & (1u << i)) {
+                    submit_remote_input(&frame_decoder.state[i]);
+                }
+            }
+
+            if (result.ack && send_callback) {
+                uart_input_frame_ack_t ack = { .seq = result.seq };
+                send_callback(UART_PKT_INPUT_FRAME_ACK, &ack, sizeof(ack));
             }
-            // In AI_BLEND mode, inputs are stored and retrieved via uart_host_get_injection()
             break;
         }
 
+        case UART_PKT_INPUT_FRAME_ACK:
+            if (link_callback) {
+                link_callback(type, payload, len);
+            }
+            break;
+
         case UART_PKT_INPUT_CONNECT: {
             if (len < sizeof(uart_connect_event_t)) break;
 
@@ -186,7 +232,10 @@ static void process_packet(uint8_t type, const uint8_t* payload, uint8_t len)
             if (len >= sizeof(uart_version_t)) {
                 const uart_version_t* ver = (const uart_version_t*)payload;
                 printf("[uart_host] Remote version: %d.%d.%d (board=%d, features=0x%08lX)\n",
-                       ver->major, ver->minor, ver->patch, ver->board_type, ver->features);
+                       ver->major, ver->minor, ver->patch, ver->board_type, (unsigned long)ver->features);
+                if (link_callback) {
+                    link_callback(type, payload, len);
+                }
             }
             break;
         }
@@ -199,71 +248,148 @@ static void process_packet(uint8_t type, const uint8_t* payload, uint8_t len)
 }
 
 // ============================================================================
-// RECEIVE STATE MACHINE
+// RECEIVE RING
 // ============================================================================
 
-// Process a single received byte through the state machine
-static void process_rx_byte(uint8_t byte)
+// Start DMA from the UART RX FIFO into the ring. Without a free channel the
+// task polls the FIFO into the same ring instead.
+static void rx_dma_start(void)
 {
-    switch (rx_state) {
-        case RX_STATE_SYNC:
-            if (byte == UART_PROTOCOL_SYNC_BYTE) {
-                rx_buffer[0] = byte;
-                rx_index = 1;
-                rx_state = RX_STATE_LENGTH;
-            }
-            break;
+    if (rx_dma_chan < 0) {
+        rx_dma_chan = dma_claim_unused_channel(false);
+        if (rx_dma_chan < 0) {
+            printf("[uart_host] No DMA channel, polling RX FIFO\n");
+            return;
+        }
+    } else {
+        dma_channel_abort(rx_dma_chan);
+    }
 
-        case RX_STATE_LENGTH:
-            rx_length = byte;
-            rx_buffer[rx_index++] = byte;
-            if (rx_length > UART_PROTOCOL_MAX_PAYLOAD) {
-                // Invalid length, reset
-                error_count++;
-                rx_state = RX_STATE_SYNC;
-            } else {
-                rx_state = RX_STATE_TYPE;
-            }
-            break;
+    dma_channel_config c = dma_channel_get_default_config(rx_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, UART_HOST_RX_RING_BITS);
+    channel_config_set_dreq(&c, uart_get_dreq(uart_port, false));
 
-        case RX_STATE_TYPE:
-            rx_type = byte;
-            rx_buffer[rx_index++] = byte;
-            if (rx_length == 0) {
-                // No payload, go straight to CRC
-                rx_state = RX_STATE_CRC;
-            } else {
-                rx_state = RX_STATE_PAYLOAD;
-            }
-            break;
+    rx_dma_base = rx_head;
+    dma_channel_configure(rx_dma_chan, &c, &rx_ring[rx_head & RX_RING_MASK],
+                          &uart_get_hw(uart_port)->dr, RX_DMA_COUNT, true);
+}
 
-        case RX_STATE_PAYLOAD:
-            rx_buffer[rx_index++] = byte;
-            if (rx_index >= UART_HEADER_SIZE + rx_length) {
-                rx_state = RX_STATE_CRC;
-            }
-            break;
+// Bring rx_head up to date with what has arrived
+static void rx_fill(void)
+{
+    if (rx_dma_chan >= 0) {
+        uint32_t remaining = dma_channel_hw_addr(rx_dma_chan)->transfer_count;
+        rx_head = rx_dma_base + (RX_DMA_COUNT - remaining);
+        if (remaining == 0) {
+            // Count exhausted (every 4G bytes): carry on from the same ring
+            // position; anything arriving meanwhile waits in the UART FIFO
+            rx_dma_base = rx_head;
+            dma_channel_set_trans_count(rx_dma_chan, RX_DMA_COUNT, true);
+        }
+    } else {
+        while (uart_is_readable(uart_port) &&
+               rx_head - rx_tail < UART_HOST_RX_RING_SIZE) {
+            RX_AT(rx_head) = (uint8_t)uart_getc(uart_port);
+            rx_head++;
+        }
+    }
 
-        case RX_STATE_CRC: {
-            uint8_t received_crc = byte;
+    // DMA lapped the parser: the oldest bytes were overwritten
+    if (rx_head - rx_tail > UART_HOST_RX_RING_SIZE) {
+        rx_overruns += rx_head - rx_tail - UART_HOST_RX_RING_SIZE;
+        rx_tail = rx_head - UART_HOST_RX_RING_SIZE;
+    }
+}
 
-            // Calculate CRC over length + type + payload
-            uint8_t calculated_crc = uart_crc8(&rx_buffer[1], rx_length + 2);
+// CRC over ring bytes [pos, pos + len), across the wrap if needed
+static uint8_t rx_crc(uint32_t pos, uint32_t len)
+{
+    uint32_t idx = pos & RX_RING_MASK;
+    uint32_t first = UART_HOST_RX_RING_SIZE - idx;
+    if (len <= first) {
+        return crc8_calc(&rx_ring[idx], len);
+    }
 
-            if (received_crc == calculated_crc) {
-                // Valid packet
-                rx_count++;
-                last_rx_time = to_ms_since_boot(get_absolute_time());
-                process_packet(rx_type, &rx_buffer[UART_HEADER_SIZE], rx_length);
-            } else {
-                // CRC mismatch
-                crc_errors++;
-                error_count++;
+    uint8_t crc = crc8_calc(&rx_ring[idx], first);
+    for (uint32_t i = 0; i < len - first; i++) {
+        crc = crc8_update(crc, rx_ring[i]);
+    }
+    return crc;
+}
+
+// Pointer to len payload bytes at pos: in place unless they wrap
+static const uint8_t* rx_payload(uint32_t pos, uint8_t len)
+{
+    uint32_t idx = pos & RX_RING_MASK;
+    if (idx + len <= UART_HOST_RX_RING_SIZE) {
+        return &rx_ring[idx];
+    }
+
+    uint32_t first = UART_HOST_RX_RING_SIZE - idx;
+    memcpy(rx_wrap_payload, &rx_ring[idx], first);
+    memcpy(rx_wrap_payload + first, rx_ring, len - first);
+    return rx_wrap_payload;
+}
+
+// Parse every complete packet between rx_tail and rx_head. A bad length or
+// CRC only skips the sync byte, so a packet hidden behind a corrupt or
+// truncated one is still found.
+static void rx_parse(void)
+{
+    while (rx_tail != rx_head) {
+        uint32_t avail = rx_head - rx_tail;
+
+        if (RX_AT(rx_tail) != UART_PROTOCOL_SYNC_BYTE) {
+            uint32_t idx = rx_tail & RX_RING_MASK;
+            uint32_t run = UART_HOST_RX_RING_SIZE - idx;
+            if (run > avail) run = avail;
+            const uint8_t* sync = memchr(&rx_ring[idx], UART_PROTOCOL_SYNC_BYTE, run);
+            rx_tail += sync ? (uint32_t)(sync - &rx_ring[idx]) : run;
+            continue;
+        }
+
+        if (avail < UART_HEADER_SIZE) break;
+
+        uint8_t length = RX_AT(rx_tail + 1);
+        if (length > UART_PROTOCOL_MAX_PAYLOAD) {
+            error_count++;
+            rx_tail++;
+            continue;
+        }
+
+        uint32_t size = uart_packet_size(length);
+        if (avail < size) {
+            // Wait for the rest unless the line has gone quiet
+            uint32_t now = time_us_32();
+            if (rx_head != rx_idle_head) {
+                rx_idle_head = rx_head;
+                rx_idle_since = now;
+                break;
             }
+            if (now - rx_idle_since < UART_HOST_RX_IDLE_US) break;
+            error_count++;
+            rx_tail++;
+            continue;
+        }
 
-            rx_state = RX_STATE_SYNC;
-            break;
+        // CRC covers length + type + payload
+        if (rx_crc(rx_tail + 1, length + 2) != RX_AT(rx_tail + size - 1)) {
+            crc_errors++;
+            error_count++;
+            rx_tail++;
+            continue;
         }
+
+        uint8_t type = RX_AT(rx_tail + 2);
+        const uint8_t* payload = rx_payload(rx_tail + UART_HEADER_SIZE, length);
+        rx_tail += size;
+
+        rx_count++;
+        last_rx_time = to_ms_since_boot(get_absolute_time());
+        process_packet(type, payload, length);
     }
 }
 
@@ -279,7 +405,7 @@ void uart_host_init(void)
 void uart_host_init_pins(uint8_t tx_pin, uint8_t rx_pin, uint32_t baud)
 {
     printf("[uart_host] Initializing UART host\n");
-    printf("[uart_host]   TX=%d, RX=%d, BAUD=%lu\n", tx_pin, rx_pin, baud);
+    printf("[uart_host]   TX=%d, RX=%d, BAUD=%lu\n", tx_pin, rx_pin, (unsigned long)baud);
 
     // Initialize UART
     uart_init(uart_port, baud);
@@ -296,8 +422,9 @@ void uart_host_init_pins(uint8_t tx_pin, uint8_t rx_pin, uint32_t baud)
 
     // Initialize state
     memset(ai_injections, 0, sizeof(ai_injections));
-    rx_state = RX_STATE_SYNC;
-    rx_index = 0;
+    uart_frame_decoder_init(&frame_decoder);
+    rx_tail = rx_head;
+    rx_dma_start();
 
     initialized = true;
     printf("[uart_host] Initialization complete\n");
@@ -307,11 +434,9 @@ void uart_host_task(void)
 {
     if (!initialized) return;
 
-    // Process all available bytes from UART
-    while (uart_is_readable(uart_port)) {
-        uint8_t byte = uart_getc(uart_port);
-        process_rx_byte(byte);
-    }
+    // Parse everything received since the last call, in place
+    rx_fill();
+    rx_parse();
 
     // Decrement injection duration counters
     for (int i = 0; i < UART_HOST_MAX_PLAYERS; i++) {
@@ -369,6 +494,7 @@ bool uart_host_is_connected(void)
 uint32_t uart_host_get_rx_count(void) { return rx_count; }
 uint32_t uart_host_get_error_count(void) { return error_count; }
 uint32_t uart_host_get_crc_errors(void) { return crc_errors; }
+uint32_t uart_host_get_rx_overruns(void) { return rx_overruns; }
 
 void uart_host_set_profile_callback(uart_host_profile_callback_t callback)
 {
@@ -380,6 +506,16 @@ void uart_host_set_output_mode_callback(uart_host_mode_callback_t callback)
     output_mode_callback = callback;
 }
 
+void uart_host_set_send_callback(uart_host_send_callback_t callback)
+{
+    send_callback = callback;
+}
+
+void uart_host_set_link_callback(uart_host_link_callback_t callback)
+{
+    link_callback = callback;
+}
+
 // ============================================================================
 // HOST INTERFACE
 // ============================================================================
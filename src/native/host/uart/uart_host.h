@@ -40,6 +40,20 @@
 // Maximum players that can be received from UART
 #define UART_HOST_MAX_PLAYERS   8
 
+// Receive ring: DMA copies every byte from the UART into it, and the task
+// parses packets in place. 1 << bits bytes, max 15 (DMA ring wrap limit).
+// 1KB holds ~3.4ms of 3Mbaud traffic between task calls.
+#ifndef UART_HOST_RX_RING_BITS
+#define UART_HOST_RX_RING_BITS  10
+#endif
+#define UART_HOST_RX_RING_SIZE  (1u << UART_HOST_RX_RING_BITS)
+
+// A partial packet is given up (resync past its sync byte) once the line
+// has been idle this long, so a corrupt LEN can't hold back later packets
+#ifndef UART_HOST_RX_IDLE_US
+#define UART_HOST_RX_IDLE_US    2000
+#endif
+
 // ============================================================================
 // UART HOST MODES
 // ============================================================================
@@ -85,6 +99,7 @@ bool uart_host_is_connected(void);
 uint32_t uart_host_get_rx_count(void);
 uint32_t uart_host_get_error_count(void);
 uint32_t uart_host_get_crc_errors(void);
+uint32_t uart_host_get_rx_overruns(void);  // Bytes lost: task fell a full ring behind
 
 // ============================================================================
 // CALLBACKS
@@ -98,6 +113,18 @@ void uart_host_set_profile_callback(uart_host_profile_callback_t callback);
 typedef void (*uart_host_mode_callback_t)(uint8_t mode);
 void uart_host_set_output_mode_callback(uart_host_mode_callback_t callback);
 
+// Transmit path for input frame acks (e.g. uart_device_send_packet when
+// uart_device shares this UART). Without one, frames are never acked and the
+// peer keeps sending keyframes.
+typedef void (*uart_host_send_callback_t)(uint8_t type, const void* payload, uint8_t len);
+void uart_host_set_send_callback(uart_host_send_callback_t callback);
+
+// Link packets meant for the transmitter on this UART (peer VERSION and
+// INPUT_FRAME_ACK). The host reads every byte, so a uart_device sharing the
+// port gets them through here (uart_device_handle_link_packet).
+typedef void (*uart_host_link_callback_t)(uint8_t type, const uint8_t* payload, uint8_t len);
+void uart_host_set_link_callback(uart_host_link_callback_t callback);
+
 // ============================================================================
 // HOST INTERFACE (for generic host system)
 // ============================================================================
@@ -8,6 +8,7 @@
 #include "pad_input.h"
 #include "core/buttons.h"
 #include "core/input_event.h"
+#include "core/analog.h"
 #include "core/router/router.h"
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
@@ -180,17 +181,6 @@ static uint8_t pad_read_adc(int8_t channel, bool invert) {
     return value;
 }
 
-// Apply deadzone to analog value (centered at 128)
-static uint8_t apply_deadzone(uint8_t value, uint8_t deadzone) {
-    int16_t centered = (int16_t)value - 128;
-
-    if (centered > -deadzone && centered < deadzone) {
-        return 128;  // In deadzone, return center
-    }
-
-    return value;
-}
-
 // Check if config uses I2C expanders
 static bool config_uses_i2c(const pad_device_config_t* config) {
     return (config->dpad_up >= 100 || config->dpad_down >= 100 ||
@@ -356,19 +346,19 @@ static void pad_poll_device(uint8_t device_index) {
     uint8_t dz = config->deadzone;
 
     if (config->adc_lx >= 0) {
-        event->analog[ANALOG_X] = apply_deadzone(
+        event->analog[ANALOG_X] = analog_deadzone(
             pad_read_adc(config->adc_lx, config->invert_lx), dz);
     }
     if (config->adc_ly >= 0) {
-        event->analog[ANALOG_Y] = apply_deadzone(
+        event->analog[ANALOG_Y] = analog_deadzone(
             pad_read_adc(config->adc_ly, config->invert_ly), dz);
     }
     if (config->adc_rx >= 0) {
-        event->analog[ANALOG_Z] = apply_deadzone(
+        event->analog[ANALOG_Z] = analog_deadzone(
             pad_read_adc(config->adc_rx, config->invert_rx), dz);
     }
     if (config->adc_ry >= 0) {
-        event->analog[ANALOG_RX] = apply_deadzone(
+        event->analog[ANALOG_RX] = analog_deadzone(
             pad_read_adc(config->adc_ry, config->invert_ry), dz);
     }
 }
@@ -390,6 +380,7 @@ int pad_input_add_device(const pad_device_config_t* config) {
     pad_events[index].dev_addr = 0xF0 + index;  // Virtual address for pad devices
     pad_events[index].instance = index;
     pad_events[index].type = INPUT_TYPE_GAMEPAD;
+    pad_events[index].source = INPUT_SOURCE_GPIO;
 
     pad_prev_buttons[index] = 0;
 
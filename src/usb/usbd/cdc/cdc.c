@@ -5,6 +5,7 @@
 #include "cdc.h"
 #include "../usbd.h"
 #include "core/services/storage/flash.h"
+#include "core/services/storage/settings.h"
 #include "tusb.h"
 #include "pico/stdio.h"
 #include "pico/stdio/driver.h"
@@ -86,7 +87,7 @@ void cdc_init(void)
 // Process a complete command line
 static void cdc_process_command(const char* cmd)
 {
-    char response[128];
+    char response[160];
 
     // MODE? - Query current mode
     if (strcmp(cmd, "MODE?") == 0) {
@@ -115,6 +116,9 @@ static void cdc_process_command(const char* cmd)
         else if (strcasecmp(value, "XAC") == 0 || strcasecmp(value, "ADAPTIVE") == 0) {
             mode_num = USB_OUTPUT_MODE_XAC;
         }
+        else if (strcasecmp(value, "MULTI") == 0 || strcasecmp(value, "DINPUT4") == 0) {
+            mode_num = USB_OUTPUT_MODE_HID_MULTI;
+        }
 
         if (mode_num >= 0 && mode_num < USB_OUTPUT_MODE_COUNT) {
             usb_output_mode_t current = usbd_get_mode();
@@ -147,6 +151,66 @@ static void cdc_process_command(const char* cmd)
         cdc_data_write_str("  6: PS Classic\r\n");
         cdc_data_write_str("  7: Xbox One\r\n");
         cdc_data_write_str("  8: XAC Compat (not in toggle)\r\n");
+        cdc_data_write_str("  9: DInput x4 (not in toggle)\r\n");
+    }
+    // POLL? - Query USB polling interval
+    else if (strcmp(cmd, "POLL?") == 0) {
+        uint8_t setting = usbd_get_poll_interval_setting();
+        snprintf(response, sizeof(response), "POLL=%d ms (%s)\r\n",
+                 usbd_get_poll_interval(), setting ? "override" : "mode default");
+        cdc_data_write_str(response);
+    }
+    // POLL=N - Set polling interval (1/2/4/8 ms, 0 or DEFAULT = mode default)
+    else if (strncmp(cmd, "POLL=", 5) == 0) {
+        const char* value = cmd + 5;
+        int interval = -1;
+
+        if (value[0] >= '0' && value[0] <= '9') {
+            interval = atoi(value);
+        } else if (strcasecmp(value, "DEFAULT") == 0) {
+            interval = 0;
+        }
+
+        if (interval >= 0 && interval <= 255 && usbd_poll_interval_valid((uint8_t)interval)) {
+            if ((uint8_t)interval == usbd_get_poll_interval_setting()) {
+                snprintf(response, sizeof(response), "OK: Poll interval already %d\r\n", interval);
+                cdc_data_write_str(response);
+            } else {
+                snprintf(response, sizeof(response), "OK: Setting poll interval %d, re-enumerating...\r\n",
+                         interval);
+                cdc_data_write_str(response);
+                cdc_data_flush();
+                // This will trigger a device reset
+                usbd_set_poll_interval((uint8_t)interval);
+            }
+        } else {
+            snprintf(response, sizeof(response), "ERR: Invalid poll interval '%s' (1, 2, 4, 8 or DEFAULT)\r\n",
+                     value);
+            cdc_data_write_str(response);
+        }
+    }
+    // LATENCY? - Input event to USB IN collection latency
+    else if (strcmp(cmd, "LATENCY?") == 0) {
+        usbd_latency_t lat;
+        usbd_get_latency(&lat);
+        if (lat.count == 0) {
+            cdc_data_write_str("LATENCY: no reports collected\r\n");
+        } else {
+            snprintf(response, sizeof(response),
+                     "LATENCY: n=%lu avg=%luus min=%luus max=%luus p50<=%luus p99<=%luus poll=%dms aligned=%d\r\n",
+                     (unsigned long)lat.count,
+                     (unsigned long)(lat.sum_us / lat.count),
+                     (unsigned long)lat.min_us, (unsigned long)lat.max_us,
+                     (unsigned long)usbd_latency_percentile(&lat, 50),
+                     (unsigned long)usbd_latency_percentile(&lat, 99),
+                     usbd_get_poll_interval(), usbd_poll_aligned() ? 1 : 0);
+            cdc_data_write_str(response);
+        }
+    }
+    // LATENCY=0 - Reset latency counters
+    else if (strcmp(cmd, "LATENCY=0") == 0 || strcasecmp(cmd, "LATENCY=RESET") == 0) {
+        usbd_reset_latency();
+        cdc_data_write_str("OK: Latency counters reset\r\n");
     }
     // VERSION or VER? - Query firmware version
     else if (strcmp(cmd, "VERSION") == 0 || strcmp(cmd, "VER?") == 0) {
@@ -157,10 +221,11 @@ static void cdc_process_command(const char* cmd)
         flash_t flash_data;
         if (flash_load(&flash_data)) {
             snprintf(response, sizeof(response),
-                     "Flash: magic=0x%08X, profile=%d, usb_mode=%d\r\n",
-                     (unsigned int)flash_data.magic,
-                     flash_data.active_profile_index,
-                     flash_data.usb_output_mode);
+                     "Flash: magic=0x%08X, schema=%d, %d bytes used, profile=%d, usb_mode=%d, poll=%d\r\n",
+                     (unsigned int)flash_data.magic, flash_data.schema, settings_used(),
+                     settings_get_u8(SETTING_PROFILE_INDEX, OUTPUT_TARGET_USB_DEVICE, 0),
+                     settings_get_u8(SETTING_USB_OUTPUT_MODE, 0, 0),
+                     settings_get_u8(SETTING_USB_POLL_INTERVAL, 0, 0));
             cdc_data_write_str(response);
         } else {
             cdc_data_write_str("Flash: No valid data (magic mismatch)\r\n");
@@ -172,6 +237,10 @@ static void cdc_process_command(const char* cmd)
         cdc_data_write_str("  MODE?     - Query current output mode\r\n");
         cdc_data_write_str("  MODE=N    - Set output mode (0-5 or name)\r\n");
         cdc_data_write_str("  MODES     - List available modes\r\n");
+        cdc_data_write_str("  POLL?     - Query USB polling interval\r\n");
+        cdc_data_write_str("  POLL=N    - Set polling interval (1/2/4/8 ms or DEFAULT)\r\n");
+        cdc_data_write_str("  LATENCY?  - Input to USB IN latency stats\r\n");
+        cdc_data_write_str("  LATENCY=0 - Reset latency stats\r\n");
         cdc_data_write_str("  VERSION   - Show firmware version\r\n");
         cdc_data_write_str("  HELP      - Show this help\r\n");
     }
@@ -0,0 +1,135 @@
+// hid_multi_descriptors.h - Composite multi-pad HID descriptors
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// One DInput gamepad interface per player slot, so controllers merged
+// through a hub show up on the PC as independent pads. Every pad has its
+// own interrupt IN endpoint polled at bInterval 1, so each keeps the full
+// 1 kHz rate instead of sharing one endpoint's frame budget.
+//
+// The pads reuse the single-pad HID report layout (hid_descriptors.h).
+// CDC interfaces follow the pads and keep their HID-mode endpoints, so
+// the data port (and MODE= switching) still works in this mode.
+
+#ifndef HID_MULTI_DESCRIPTORS_H
+#define HID_MULTI_DESCRIPTORS_H
+
+#include <stdint.h>
+#include "tusb.h"
+#include "hid_descriptors.h"
+
+// ============================================================================
+// USB IDENTIFIERS
+// ============================================================================
+
+// Distinct PID so hosts don't reuse a cached single-pad configuration
+#define HID_MULTI_VID           0x2563  // SHANWAN (same as HID mode)
+#define HID_MULTI_PID           0x0577  // Different PID from DInput/XAC
+#define HID_MULTI_BCD           0x0100  // v1.00
+#define HID_MULTI_MANUFACTURER  "Joypad"
+#define HID_MULTI_PRODUCT       "Joypad (DInput x4)"
+
+// One HID class instance per pad (CFG_TUD_HID bounds the class driver)
+#define HID_MULTI_PADS          4
+
+#if HID_MULTI_PADS > CFG_TUD_HID
+#error "HID_MULTI_PADS exceeds CFG_TUD_HID"
+#endif
+
+// ============================================================================
+// INTERFACE AND ENDPOINT NUMBERS
+// ============================================================================
+
+enum {
+    HID_MULTI_ITF_PAD_0 = 0,
+    HID_MULTI_ITF_PAD_1,
+    HID_MULTI_ITF_PAD_2,
+    HID_MULTI_ITF_PAD_3,
+#if CFG_TUD_CDC >= 1
+    HID_MULTI_ITF_CDC_0,        // CDC 0 control interface (data port)
+    HID_MULTI_ITF_CDC_0_DATA,   // CDC 0 data interface
+#endif
+#if CFG_TUD_CDC >= 2
+    HID_MULTI_ITF_CDC_1,        // CDC 1 control interface (debug port)
+    HID_MULTI_ITF_CDC_1_DATA,   // CDC 1 data interface
+#endif
+    HID_MULTI_ITF_TOTAL
+};
+
+// Pad 0 keeps the HID-mode endpoint; EP2-EP5 belong to CDC, so the other
+// pads take EP6-EP8 (RP2040 has 15 non-control endpoints)
+#define HID_MULTI_EPNUM_PAD_0       0x81
+#define HID_MULTI_EPNUM_PAD_1       0x86
+#define HID_MULTI_EPNUM_PAD_2       0x87
+#define HID_MULTI_EPNUM_PAD_3       0x88
+
+#define HID_MULTI_EPNUM_CDC_0_NOTIF 0x82
+#define HID_MULTI_EPNUM_CDC_0_OUT   0x03
+#define HID_MULTI_EPNUM_CDC_0_IN    0x83
+#define HID_MULTI_EPNUM_CDC_1_NOTIF 0x84
+#define HID_MULTI_EPNUM_CDC_1_OUT   0x05
+#define HID_MULTI_EPNUM_CDC_1_IN    0x85
+
+// ============================================================================
+// DEVICE DESCRIPTOR
+// ============================================================================
+
+static const tusb_desc_device_t hid_multi_device_descriptor = {
+    .bLength            = sizeof(tusb_desc_device_t),
+    .bDescriptorType    = TUSB_DESC_DEVICE,
+    .bcdUSB             = 0x0200,  // USB 2.0
+#if CFG_TUD_CDC > 0
+    // Use IAD for composite device with CDC
+    .bDeviceClass       = TUSB_CLASS_MISC,
+    .bDeviceSubClass    = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol    = MISC_PROTOCOL_IAD,
+#else
+    .bDeviceClass       = 0x00,
+    .bDeviceSubClass    = 0x00,
+    .bDeviceProtocol    = 0x00,
+#endif
+    .bMaxPacketSize0    = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor           = HID_MULTI_VID,
+    .idProduct          = HID_MULTI_PID,
+    .bcdDevice          = HID_MULTI_BCD,
+    .iManufacturer      = 0x01,
+    .iProduct           = 0x02,
+    .iSerialNumber      = 0x03,
+    .bNumConfigurations = 0x01
+};
+
+// ============================================================================
+// CONFIGURATION DESCRIPTOR
+// ============================================================================
+
+#define HID_MULTI_CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + (HID_MULTI_PADS * TUD_HID_DESC_LEN) + \
+                                    (CFG_TUD_CDC * TUD_CDC_DESC_LEN))
+
+#define HID_MULTI_PAD_DESCRIPTOR(itf, ep) \
+    TUD_HID_DESCRIPTOR(itf, 0, HID_ITF_PROTOCOL_NONE, sizeof(hid_report_descriptor), ep, CFG_TUD_HID_EP_BUFSIZE, 1)
+
+static const uint8_t hid_multi_config_descriptor[] = {
+    // Config: bus powered, max 100mA
+    TUD_CONFIG_DESCRIPTOR(1, HID_MULTI_ITF_TOTAL, 0, HID_MULTI_CONFIG_TOTAL_LEN,
+                          TUSB_DESC_CONFIG_ATT_REMOTE_WAKEUP, 100),
+
+    // Interfaces 0-3: one HID gamepad per player
+    HID_MULTI_PAD_DESCRIPTOR(HID_MULTI_ITF_PAD_0, HID_MULTI_EPNUM_PAD_0),
+    HID_MULTI_PAD_DESCRIPTOR(HID_MULTI_ITF_PAD_1, HID_MULTI_EPNUM_PAD_1),
+    HID_MULTI_PAD_DESCRIPTOR(HID_MULTI_ITF_PAD_2, HID_MULTI_EPNUM_PAD_2),
+    HID_MULTI_PAD_DESCRIPTOR(HID_MULTI_ITF_PAD_3, HID_MULTI_EPNUM_PAD_3),
+
+#if CFG_TUD_CDC >= 1
+    // CDC 0: Data port (commands, config)
+    TUD_CDC_DESCRIPTOR(HID_MULTI_ITF_CDC_0, 4, HID_MULTI_EPNUM_CDC_0_NOTIF, 8,
+                       HID_MULTI_EPNUM_CDC_0_OUT, HID_MULTI_EPNUM_CDC_0_IN, 64),
+#endif
+
+#if CFG_TUD_CDC >= 2
+    // CDC 1: Debug port (logging)
+    TUD_CDC_DESCRIPTOR(HID_MULTI_ITF_CDC_1, 5, HID_MULTI_EPNUM_CDC_1_NOTIF, 8,
+                       HID_MULTI_EPNUM_CDC_1_OUT, HID_MULTI_EPNUM_CDC_1_IN, 64),
+#endif
+};
+
+#endif // HID_MULTI_DESCRIPTORS_H
@@ -0,0 +1,69 @@
+// report_cache.c - Last-sent report cache for USB device output modes
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "report_cache.h"
+#include <string.h>
+
+void report_cache_reset(report_cache_t* cache)
+{
+    memset(cache, 0, sizeof(*cache));
+}
+
+bool report_cache_input_same(report_cache_t* cache, const void* profile,
+                             const input_state_t* state)
+{
+    // Motion/pressure change nearly every report and feed the report directly
+    if (state->flags & INPUT_STATE_EXT_MASK) {
+        cache->input_valid = false;
+        cache->builds++;
+        return false;
+    }
+
+    if (cache->input_valid &&
+        cache->profile == profile &&
+        cache->buttons == state->buttons &&
+        memcmp(cache->analog, state->analog, sizeof(cache->analog)) == 0) {
+        cache->input_hits++;
+        return true;
+    }
+
+    cache->profile = profile;
+    cache->buttons = state->buttons;
+    memcpy(cache->analog, state->analog, sizeof(cache->analog));
+    cache->input_valid = true;
+    cache->builds++;
+    return false;
+}
+
+bool report_cache_changed(report_cache_t* cache, const void* report, uint16_t len,
+                          uint32_t now_ms)
+{
+    if (len > REPORT_CACHE_MAX) {
+        return true;  // Too large to cache - always send
+    }
+
+    if (cache->report_valid && cache->len == len &&
+        memcmp(cache->report, report, len) == 0) {
+        bool keepalive = USBD_REPORT_KEEPALIVE_MS > 0 &&
+                         (uint32_t)(now_ms - cache->sent_ms) >= USBD_REPORT_KEEPALIVE_MS;
+        if (!keepalive) {
+            cache->suppressed++;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void report_cache_commit(report_cache_t* cache, const void* report, uint16_t len,
+                         uint32_t now_ms)
+{
+    cache->sends++;
+    if (len > REPORT_CACHE_MAX) return;
+
+    memcpy(cache->report, report, len);
+    cache->len = len;
+    cache->report_valid = true;
+    cache->sent_ms = now_ms;
+}
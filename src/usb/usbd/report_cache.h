@@ -0,0 +1,75 @@
+// report_cache.h - Last-sent report cache for USB device output modes
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// Controllers re-report an unchanged state every poll, and in the 1 kHz
+// modes each pending event used to rebuild the report and queue it even
+// when the bytes matched the previous one. A cache sits on each report
+// buffer and short-circuits both steps:
+//
+//   report_cache_input_same()  the inputs apply_usbd_profile() reads (and
+//                              the active profile) are unchanged, so the
+//                              report buffer already holds the result
+//   report_cache_changed()     the serialized bytes match the last report
+//                              sent, so the USB transfer is skipped
+//   report_cache_commit()      the transfer was queued; record the bytes
+//                              as the last report sent
+//
+// An unchanged report still goes out every USBD_REPORT_KEEPALIVE_MS while
+// input keeps arriving (0 disables the keepalive).
+
+#ifndef REPORT_CACHE_H
+#define REPORT_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "core/input_event.h"
+
+#ifndef USBD_REPORT_KEEPALIVE_MS
+#define USBD_REPORT_KEEPALIVE_MS 100
+#endif
+
+// Largest report any mode sends (full-speed interrupt packet)
+#define REPORT_CACHE_MAX 64
+
+typedef struct {
+    // Input key: what the report was last built from
+    const void* profile;
+    uint32_t buttons;
+    uint8_t analog[8];
+    bool input_valid;
+
+    // Last report handed to the USB stack
+    uint8_t report[REPORT_CACHE_MAX];
+    uint16_t len;
+    uint32_t sent_ms;
+    bool report_valid;
+
+    // Counters
+    uint32_t builds;        // Reports rebuilt (profile applied)
+    uint32_t input_hits;    // Builds skipped, inputs unchanged
+    uint32_t sends;         // Reports handed to the USB stack
+    uint32_t suppressed;    // Identical reports not sent
+} report_cache_t;
+
+// Forget the cached input and report (next event rebuilds and sends)
+void report_cache_reset(report_cache_t* cache);
+
+// True if state and profile match what the cached report was built from.
+// Otherwise records them as the new key and counts a build; the caller
+// must then rebuild the report. States carrying ext data always rebuild.
+bool report_cache_input_same(report_cache_t* cache, const void* profile,
+                             const input_state_t* state);
+
+// True if the report should be sent: its bytes differ from the last one
+// sent, or the keepalive interval has elapsed. Does not record it; a
+// report the USB stack refuses is retried on the next event.
+// Callers mask per-report counters out of the bytes before calling.
+bool report_cache_changed(report_cache_t* cache, const void* report, uint16_t len,
+                          uint32_t now_ms);
+
+// Record a report the USB stack accepted as the last one sent
+void report_cache_commit(report_cache_t* cache, const void* report, uint16_t len,
+                         uint32_t now_ms);
+
+#endif // REPORT_CACHE_H
@@ -8,7 +8,8 @@
 // Supports multiple output modes:
 // - HID (DInput/PS3-compatible) - default
 // - Xbox Original (XID protocol)
-// - Future: XInput, PS4, Switch, etc.
+// - XInput, PS3, PS4, Switch, PS Classic, Xbox One, XAC
+// - DInput x4 (composite, one HID interface per player)
 //
 // Mode is stored in flash and can be changed via CDC commands.
 // Mode changes require USB re-enumeration (device reset).
@@ -23,6 +24,10 @@
 #include "descriptors/ps4_descriptors.h"
 #include "descriptors/xbone_descriptors.h"
 #include "descriptors/xac_descriptors.h"
+#include "descriptors/hid_multi_descriptors.h"
+#include "usbd_multi.h"
+#include "report_cache.h"
+#include "usbd_poll.h"
 #include "tud_xid.h"
 #include "tud_xinput.h"
 #include "tud_xbone.h"
@@ -31,8 +36,10 @@
 #include "core/input_event.h"
 #include "core/buttons.h"
 #include "core/services/storage/flash.h"
+#include "core/services/storage/settings.h"
 #include "core/services/button/button.h"
 #include "core/services/profiles/profile.h"
+#include "core/services/profiles/profile_compile.h"
 #ifndef DISABLE_USB_HOST
 #include "usb/usbh/hid/devices/vendors/sony/sony_ds4.h"
 #endif
@@ -48,8 +55,8 @@
 // STATE
 // ============================================================================
 
-// Current HID report (for HID mode)
-static joypad_hid_report_t hid_report;
+// Current HID reports (HID mode uses [0], multi-pad mode one per pad)
+static joypad_hid_report_t hid_reports[HID_MULTI_PADS];
 
 // Current XID report (for Xbox OG mode)
 static xbox_og_in_report_t xid_report;
@@ -85,22 +92,39 @@ static gip_input_report_t xbone_report;
 // Current XAC report (for Xbox Adaptive Controller compatible mode)
 static xac_in_report_t xac_report;
 
+// Last-sent report per report buffer (HID modes index by instance, others use [0])
+static report_cache_t report_caches[HID_MULTI_PADS];
+
+// Host poll alignment and input-to-IN latency (slot = endpoint, pad in multi mode)
+static usbd_poll_sched_t poll_sched;
+static uint8_t poll_interval = USBD_POLL_INTERVAL_DEFAULT;  // 0 = mode's descriptor value
+
+// Per-pad send scheduling (for multi-pad HID mode)
+static usbd_multi_sched_t multi_sched;
+static bool usbd_hid_multi_ready(uint8_t pad);
+static bool usbd_hid_multi_send(uint8_t pad);
+
 // ============================================================================
 // EVENT-DRIVEN OUTPUT STATE
 // ============================================================================
 
-// Pending input events (queued by tap callback, sent when USB ready)
+// Pending input states (queued by tap callback, sent when USB ready)
 #define USB_MAX_PLAYERS 4
-static input_event_t pending_events[USB_MAX_PLAYERS];
+static input_state_t pending_states[USB_MAX_PLAYERS];
+static input_ext_t pending_ext[USB_MAX_PLAYERS];
 static bool pending_flags[USB_MAX_PLAYERS] = {false};
+static uint32_t pending_us[USB_MAX_PLAYERS];  // When each pending state arrived
+
+#if HID_MULTI_PADS > USB_MAX_PLAYERS
+#error "Multi-pad mode needs a pending slot per pad"
+#endif
 
 // Serial number from board unique ID (12 hex chars + null)
 #define USB_SERIAL_LEN 12
 static char usb_serial_str[USB_SERIAL_LEN + 1];
 
-// Current output mode (persisted to flash)
+// Current output mode (persisted in settings)
 static usb_output_mode_t output_mode = USB_OUTPUT_MODE_HID;
-static flash_t flash_settings;
 
 // Mode names for display
 static const char* mode_names[] = {
@@ -113,15 +137,17 @@ static const char* mode_names[] = {
     [USB_OUTPUT_MODE_PSCLASSIC] = "PS Classic",
     [USB_OUTPUT_MODE_XBONE] = "Xbox One",
     [USB_OUTPUT_MODE_XAC] = "XAC Compat",
+    [USB_OUTPUT_MODE_HID_MULTI] = "DInput x4",
 };
 
 // ============================================================================
 // PROFILE PROCESSING
 // ============================================================================
 
-// Apply profile mapping (combos, button remaps) to input event
+// Apply profile mapping (combos, button remaps) to input state
 // Returns the processed buttons; analog values are updated in-place in profile_out
-static uint32_t apply_usbd_profile(const input_event_t* event, profile_output_t* profile_out)
+static uint32_t apply_usbd_profile(const input_state_t* event, const input_ext_t* ext,
+                                   profile_output_t* profile_out)
 {
     const profile_t* profile = profile_get_active(OUTPUT_TARGET_USB_DEVICE);
 
@@ -133,27 +159,48 @@ static uint32_t apply_usbd_profile(const input_event_t* event, profile_output_t*
                   profile_out);
 
     // Copy motion data through (no remapping)
-    profile_out->has_motion = event->has_motion;
-    if (event->has_motion) {
-        profile_out->accel[0] = event->accel[0];
-        profile_out->accel[1] = event->accel[1];
-        profile_out->accel[2] = event->accel[2];
-        profile_out->gyro[0] = event->gyro[0];
-        profile_out->gyro[1] = event->gyro[1];
-        profile_out->gyro[2] = event->gyro[2];
+    profile_out->has_motion = (event->flags & INPUT_STATE_HAS_MOTION) != 0;
+    if (profile_out->has_motion) {
+        profile_out->accel[0] = ext->accel[0];
+        profile_out->accel[1] = ext->accel[1];
+        profile_out->accel[2] = ext->accel[2];
+        profile_out->gyro[0] = ext->gyro[0];
+        profile_out->gyro[1] = ext->gyro[1];
+        profile_out->gyro[2] = ext->gyro[2];
     }
 
     // Copy pressure data through (no remapping)
-    profile_out->has_pressure = event->has_pressure;
-    if (event->has_pressure) {
+    profile_out->has_pressure = (event->flags & INPUT_STATE_HAS_PRESSURE) != 0;
+    if (profile_out->has_pressure) {
         for (int i = 0; i < 12; i++) {
-            profile_out->pressure[i] = event->pressure[i];
+            profile_out->pressure[i] = ext->pressure[i];
         }
     }
 
     return profile_out->buttons;
 }
 
+// ============================================================================
+// REPORT CACHE
+// ============================================================================
+
+static inline uint32_t usbd_now_ms(void)
+{
+    return to_ms_since_boot(get_absolute_time());
+}
+
+// True if the cached report was built from this input under the active profile.
+// While the profile switch combo is held, profile_apply() masks buttons based
+// on hold time, so those reports are always rebuilt.
+static bool usbd_input_unchanged(report_cache_t* cache, const input_state_t* event)
+{
+    if (profile_switch_combo_active()) {
+        cache->input_valid = false;
+        return false;
+    }
+    return report_cache_input_same(cache, profile_get_active(OUTPUT_TARGET_USB_DEVICE), event);
+}
+
 // ============================================================================
 // CONVERSION HELPERS
 // ============================================================================
@@ -272,7 +319,7 @@ bool usbd_set_mode(usb_output_mode_t mode)
         return false;
     }
 
-    // Supported modes: HID, Xbox OG, XInput, PS3, PS4, Switch, PS Classic, Xbox One, XAC
+    // Supported modes: HID, Xbox OG, XInput, PS3, PS4, Switch, PS Classic, Xbox One, XAC, DInput x4
     if (mode != USB_OUTPUT_MODE_HID &&
         mode != USB_OUTPUT_MODE_XBOX_ORIGINAL &&
         mode != USB_OUTPUT_MODE_XINPUT &&
@@ -281,7 +328,8 @@ bool usbd_set_mode(usb_output_mode_t mode)
         mode != USB_OUTPUT_MODE_SWITCH &&
         mode != USB_OUTPUT_MODE_PSCLASSIC &&
         mode != USB_OUTPUT_MODE_XBONE &&
-        mode != USB_OUTPUT_MODE_XAC) {
+        mode != USB_OUTPUT_MODE_XAC &&
+        mode != USB_OUTPUT_MODE_HID_MULTI) {
         printf("[usbd] Mode %d not yet supported\n", mode);
         return false;
     }
@@ -295,22 +343,18 @@ bool usbd_set_mode(usb_output_mode_t mode)
     flush_debug_output();
 
     // Save mode to flash immediately (we're about to reset)
-    printf("[usbd] Setting flash_settings.usb_output_mode = %d\n", mode);
-    flush_debug_output();
-    flash_settings.usb_output_mode = (uint8_t)mode;
-    printf("[usbd] Calling flash_save_now...\n");
-    flush_debug_output();
-    flash_save_now(&flash_settings);
-    printf("[usbd] Mode saved to flash (mode=%d)\n", flash_settings.usb_output_mode);
+    settings_set_u8(SETTING_USB_OUTPUT_MODE, 0, (uint8_t)mode);
+    settings_commit_now();
+    printf("[usbd] Mode saved to flash (mode=%d)\n", mode);
     flush_debug_output();
 
-    // Verify the write by reading it back
-    flash_t verify_settings;
-    if (flash_load(&verify_settings)) {
-        printf("[usbd] Verify: mode=%d (expected %d)\n",
-               verify_settings.usb_output_mode, mode);
+    // Verify the write: reload settings from flash and read the mode back
+    settings_load();
+    uint8_t saved = settings_get_u8(SETTING_USB_OUTPUT_MODE, 0, 0xFF);
+    if (saved == (uint8_t)mode) {
+        printf("[usbd] Verify: mode=%d read back from flash\n", saved);
     } else {
-        printf("[usbd] Verify FAILED: flash_load returned false!\n");
+        printf("[usbd] Verify FAILED: read back mode=%d, expected %d\n", saved, mode);
     }
     flush_debug_output();
 
@@ -336,21 +380,92 @@ const char* usbd_get_mode_name(usb_output_mode_t mode)
     return "Unknown";
 }
 
+// ============================================================================
+// POLLING INTERVAL AND LATENCY API
+// ============================================================================
+
+static const uint8_t* usbd_mode_config_descriptor(void);
+
+uint8_t usbd_get_poll_interval(void)
+{
+    if (poll_interval != USBD_POLL_INTERVAL_DEFAULT) {
+        return poll_interval;
+    }
+    uint8_t interval = usbd_poll_config_interval(usbd_mode_config_descriptor());
+    return interval ? interval : 1;
+}
+
+uint8_t usbd_get_poll_interval_setting(void)
+{
+    return poll_interval;
+}
+
+bool usbd_set_poll_interval(uint8_t interval_ms)
+{
+    if (!usbd_poll_interval_valid(interval_ms)) {
+        return false;
+    }
+    if (interval_ms == poll_interval) {
+        return false;  // Same interval, no change needed
+    }
+
+    printf("[usbd] Changing poll interval from %d to %d ms\n", poll_interval, interval_ms);
+    if (interval_ms == USBD_POLL_INTERVAL_DEFAULT) {
+        settings_clear(SETTING_USB_POLL_INTERVAL, 0);
+    } else {
+        settings_set_u8(SETTING_USB_POLL_INTERVAL, 0, interval_ms);
+    }
+    settings_commit_now();
+    printf("[usbd] Poll interval saved to flash\n");
+    flush_debug_output();
+
+    poll_interval = interval_ms;
+    sleep_ms(50);
+
+    // New bInterval only takes effect on re-enumeration
+    printf("[usbd] Resetting device for re-enumeration...\n");
+    flush_debug_output();
+    watchdog_enable(100, false);  // Reset in 100ms
+    while(1);  // Wait for watchdog reset
+
+    return true;  // Never reached
+}
+
+void usbd_get_latency(usbd_latency_t* out)
+{
+    *out = poll_sched.latency;
+}
+
+void usbd_reset_latency(void)
+{
+    usbd_latency_reset(&poll_sched.latency);
+}
+
+bool usbd_poll_aligned(void)
+{
+    return poll_sched.aligned && poll_sched.locked;
+}
+
 // ============================================================================
 // EVENT-DRIVEN TAP CALLBACK
 // ============================================================================
 
 // Called by router immediately when input arrives (push-based notification)
-static void usbd_on_input(output_target_t output, uint8_t player_index, const input_event_t* event)
+static void usbd_on_input(output_target_t output, uint8_t player_index,
+                          const input_state_t* state, const input_ext_t* ext)
 {
     (void)output;  // Always USB_DEVICE
 
-    if (player_index >= USB_MAX_PLAYERS || !event) {
+    if (player_index >= USB_MAX_PLAYERS || !state) {
         return;
     }
 
-    // Queue the event for sending when USB is ready
-    pending_events[player_index] = *event;
+    // Queue the state for sending when USB is ready
+    pending_states[player_index] = *state;
+    if (state->flags & INPUT_STATE_EXT_MASK) {
+        input_ext_copy(&pending_ext[player_index], ext, state->flags);
+    }
+    pending_us[player_index] = time_us_32();
     pending_flags[player_index] = true;
 }
 
@@ -364,32 +479,34 @@ void usbd_init(void)
 
     // Initialize and load settings from flash
     flash_init();
+    settings_init();
     printf("[usbd] Loading settings from flash...\n");
-    if (flash_load(&flash_settings)) {
-        printf("[usbd] Flash load success! usb_output_mode=%d, active_profile=%d\n",
-               flash_settings.usb_output_mode, flash_settings.active_profile_index);
-        // Validate loaded mode
-        if (flash_settings.usb_output_mode < USB_OUTPUT_MODE_COUNT) {
-            // Only accept supported modes
-            if (flash_settings.usb_output_mode == USB_OUTPUT_MODE_HID ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_XINPUT ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_PS3 ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_PS4 ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_SWITCH ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_PSCLASSIC ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_XBONE ||
-                flash_settings.usb_output_mode == USB_OUTPUT_MODE_XAC) {
-                output_mode = (usb_output_mode_t)flash_settings.usb_output_mode;
-                printf("[usbd] Loaded mode from flash: %s\n", mode_names[output_mode]);
-            } else {
-                printf("[usbd] Unsupported mode %d in flash, using default\n",
-                       flash_settings.usb_output_mode);
-            }
+    uint8_t stored_mode = settings_get_u8(SETTING_USB_OUTPUT_MODE, 0, output_mode);
+    // Validate loaded mode
+    if (stored_mode < USB_OUTPUT_MODE_COUNT) {
+        // Only accept supported modes
+        if (stored_mode == USB_OUTPUT_MODE_HID ||
+            stored_mode == USB_OUTPUT_MODE_XBOX_ORIGINAL ||
+            stored_mode == USB_OUTPUT_MODE_XINPUT ||
+            stored_mode == USB_OUTPUT_MODE_PS3 ||
+            stored_mode == USB_OUTPUT_MODE_PS4 ||
+            stored_mode == USB_OUTPUT_MODE_SWITCH ||
+            stored_mode == USB_OUTPUT_MODE_PSCLASSIC ||
+            stored_mode == USB_OUTPUT_MODE_XBONE ||
+            stored_mode == USB_OUTPUT_MODE_XAC ||
+            stored_mode == USB_OUTPUT_MODE_HID_MULTI) {
+            output_mode = (usb_output_mode_t)stored_mode;
+            printf("[usbd] Loaded mode from flash: %s\n", mode_names[output_mode]);
+        } else {
+            printf("[usbd] Unsupported mode %d in flash, using default\n", stored_mode);
         }
+    }
+    // Validate polling interval (not stored = mode default)
+    uint8_t stored_interval = settings_get_u8(SETTING_USB_POLL_INTERVAL, 0, USBD_POLL_INTERVAL_DEFAULT);
+    if (usbd_poll_interval_valid(stored_interval)) {
+        poll_interval = stored_interval;
     } else {
-        printf("[usbd] No valid flash settings (magic mismatch), using defaults\n");
-        memset(&flash_settings, 0, sizeof(flash_settings));
+        printf("[usbd] Invalid poll interval %d in flash, using mode default\n", stored_interval);
     }
 
     printf("[usbd] Mode: %s\n", mode_names[output_mode]);
@@ -410,6 +527,16 @@ void usbd_init(void)
     };
     tusb_init(0, &dev_init);
 
+    // First report in every mode is built and sent
+    for (uint8_t i = 0; i < HID_MULTI_PADS; i++) {
+        report_cache_reset(&report_caches[i]);
+    }
+
+    // Reports are held for the host's poll window once its phase is known
+    usbd_poll_init(&poll_sched, usbd_get_poll_interval(), USBD_POLL_ALIGN);
+    printf("[usbd] Poll interval: %d ms%s\n", usbd_get_poll_interval(),
+           poll_interval == USBD_POLL_INTERVAL_DEFAULT ? " (mode default)" : "");
+
     // Initialize reports based on mode
     switch (output_mode) {
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
@@ -477,20 +604,30 @@ void usbd_init(void)
             xac_init_report(&xac_report);
             break;
 
+        case USB_OUTPUT_MODE_HID_MULTI:
+            // One pad per player: route each player to its own pad
+            router_set_routing_mode(ROUTING_MODE_SIMPLE);
+            router_set_max_players(OUTPUT_TARGET_USB_DEVICE, HID_MULTI_PADS);
+            usbd_multi_init(&multi_sched, HID_MULTI_PADS);
+            // fall through - same neutral reports as HID mode
+
         case USB_OUTPUT_MODE_HID:
         default:
-            // Initialize HID report to neutral state
-            memset(&hid_report, 0, sizeof(joypad_hid_report_t));
-            hid_report.lx = 128;  // Center
-            hid_report.ly = 128;
-            hid_report.rx = 128;
-            hid_report.ry = 128;
-            hid_report.hat = HID_HAT_CENTER;
+            // Initialize HID reports to neutral state
+            for (uint8_t i = 0; i < HID_MULTI_PADS; i++) {
+                memset(&hid_reports[i], 0, sizeof(joypad_hid_report_t));
+                hid_reports[i].lx = 128;  // Center
+                hid_reports[i].ly = 128;
+                hid_reports[i].rx = 128;
+                hid_reports[i].ry = 128;
+                hid_reports[i].hat = HID_HAT_CENTER;
+            }
             break;
     }
 
-    // Initialize CDC subsystem (only for HID and Switch modes)
-    if (output_mode == USB_OUTPUT_MODE_HID || output_mode == USB_OUTPUT_MODE_SWITCH) {
+    // Initialize CDC subsystem (only for HID, multi-pad HID and Switch modes)
+    if (output_mode == USB_OUTPUT_MODE_HID || output_mode == USB_OUTPUT_MODE_HID_MULTI ||
+        output_mode == USB_OUTPUT_MODE_SWITCH) {
         cdc_init();
     }
 
@@ -500,11 +637,47 @@ void usbd_init(void)
     printf("[usbd] Initialization complete\n");
 }
 
+// True if the slot's endpoint can take a report (host collected the last one)
+static bool usbd_endpoint_ready(uint8_t slot)
+{
+    switch (output_mode) {
+        case USB_OUTPUT_MODE_XBOX_ORIGINAL:
+            return slot == 0 && tud_xid_ready();
+#if CFG_TUD_XINPUT
+        case USB_OUTPUT_MODE_XINPUT:
+            return slot == 0 && tud_xinput_ready();
+#endif
+        case USB_OUTPUT_MODE_XBONE:
+            return slot == 0 && tud_xbone_ready();
+        case USB_OUTPUT_MODE_HID_MULTI:
+            return slot < HID_MULTI_PADS && tud_hid_n_ready(slot);
+        default:
+            return slot == 0 && tud_hid_ready();
+    }
+}
+
+// True if the player's pending report should be queued now (poll alignment)
+static bool usbd_poll_due(uint8_t player_index)
+{
+    return pending_flags[player_index] && usbd_poll_arm_now(&poll_sched, time_us_32());
+}
+
 void usbd_task(void)
 {
     // TinyUSB device task - runs from core0 main loop
     tud_task();
 
+    // Compile a switched profile before the next report applies it
+    profile_compile(profile_get_active(OUTPUT_TARGET_USB_DEVICE));
+
+    // Reports the host collected since the last pass (latency, poll phase)
+    uint32_t now_us = time_us_32();
+    for (uint8_t slot = 0; slot < USBD_POLL_SLOTS; slot++) {
+        if (poll_sched.in_flight[slot] && usbd_endpoint_ready(slot)) {
+            usbd_poll_idle(&poll_sched, slot, now_us);
+        }
+    }
+
     switch (output_mode) {
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
             // Xbox OG mode: check for rumble updates
@@ -512,7 +685,7 @@ void usbd_task(void)
                 xid_rumble_available = true;
             }
             // Send XID report if ready
-            if (tud_xid_ready()) {
+            if (tud_xid_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
@@ -524,7 +697,7 @@ void usbd_task(void)
                 xinput_output_available = true;
             }
             // Send XInput report if ready
-            if (tud_xinput_ready()) {
+            if (tud_xinput_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
@@ -533,28 +706,28 @@ void usbd_task(void)
         case USB_OUTPUT_MODE_SWITCH:
             // Switch mode: process CDC tasks, send HID report
             cdc_task();
-            if (tud_hid_ready()) {
+            if (tud_hid_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
 
         case USB_OUTPUT_MODE_PS3:
             // PS3 mode: send HID report (no CDC - PS3 doesn't use it)
-            if (tud_hid_ready()) {
+            if (tud_hid_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
 
         case USB_OUTPUT_MODE_PSCLASSIC:
             // PS Classic mode: send HID report (no CDC)
-            if (tud_hid_ready()) {
+            if (tud_hid_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
 
         case USB_OUTPUT_MODE_PS4:
             // PS4 mode: send HID report (no CDC)
-            if (tud_hid_ready()) {
+            if (tud_hid_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
@@ -562,48 +735,42 @@ void usbd_task(void)
         case USB_OUTPUT_MODE_XBONE:
             // Xbox One mode: update driver and send report
             tud_xbone_update();
-            if (xbone_is_powered_on() && tud_xbone_ready()) {
+            if (xbone_is_powered_on() && tud_xbone_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
 
         case USB_OUTPUT_MODE_XAC:
             // XAC mode: send HID report (no CDC)
-            if (tud_hid_ready()) {
+            if (tud_hid_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
 
+        case USB_OUTPUT_MODE_HID_MULTI:
+            // Multi-pad mode: each pad sends on its own endpoint when idle
+            cdc_task();
+            usbd_multi_service(&multi_sched, usbd_hid_multi_ready, usbd_hid_multi_send);
+            break;
+
         case USB_OUTPUT_MODE_HID:
         default:
             // HID mode: process CDC tasks
             cdc_task();
             // Send HID report if device is ready
-            if (tud_hid_ready()) {
+            if (tud_hid_ready() && usbd_poll_due(0)) {
                 usbd_send_report(0);
             }
             break;
     }
 }
 
-// Send XID report (Xbox Original mode)
-static bool usbd_send_xid_report(uint8_t player_index)
+// Build XID report from an input state
+static void usbd_build_xid_report(const input_state_t* event, const input_ext_t* ext)
 {
-    if (!tud_xid_ready()) {
-        return false;
-    }
-
-    // Check for pending event (event-driven from tap callback)
-    if (player_index >= USB_MAX_PLAYERS || !pending_flags[player_index]) {
-        return false;
-    }
-
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
-
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Digital buttons (DPAD, Start, Back, L3, R3)
     xid_report.buttons = convert_xid_digital_buttons(buttons);
@@ -628,14 +795,12 @@ static bool usbd_send_xid_report(uint8_t player_index)
     xid_report.stick_ly = convert_axis_to_s16(profile_out.left_y);
     xid_report.stick_rx = convert_axis_to_s16(profile_out.right_x);
     xid_report.stick_ry = convert_axis_to_s16(profile_out.right_y);
-
-    return tud_xid_send_report(&xid_report);
 }
 
-// Send HID report (DInput mode)
-static bool usbd_send_hid_report(uint8_t player_index)
+// Send XID report (Xbox Original mode)
+static bool usbd_send_xid_report(uint8_t player_index)
 {
-    if (!tud_hid_ready()) {
+    if (!tud_xid_ready()) {
         return false;
     }
 
@@ -644,49 +809,66 @@ static bool usbd_send_hid_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
     pending_flags[player_index] = false;  // Clear after consumption
 
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_xid_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, &xid_report, sizeof(xid_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    if (!tud_xid_send_report(&xid_report)) return false;
+    report_cache_commit(cache, &xid_report, sizeof(xid_report), now_ms);
+    return true;
+}
+
+// Build DInput report from an input state
+static void usbd_build_hid_report(joypad_hid_report_t* hid_report, const input_state_t* event,
+                                  const input_ext_t* ext)
+{
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t processed_buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t processed_buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Convert processed buttons to HID report (18 buttons across 3 bytes)
     uint32_t buttons = convert_buttons(processed_buttons);
-    hid_report.buttons_lo = buttons & 0xFF;           // Buttons 1-8
-    hid_report.buttons_mid = (buttons >> 8) & 0xFF;   // Buttons 9-16
-    hid_report.buttons_hi = (buttons >> 16) & 0x03;   // Buttons 17-18 (L4, R4)
-    hid_report.hat = convert_dpad_to_hat(processed_buttons);
+    hid_report->buttons_lo = buttons & 0xFF;           // Buttons 1-8
+    hid_report->buttons_mid = (buttons >> 8) & 0xFF;   // Buttons 9-16
+    hid_report->buttons_hi = (buttons >> 16) & 0x03;   // Buttons 17-18 (L4, R4)
+    hid_report->hat = convert_dpad_to_hat(processed_buttons);
 
     // Analog sticks (HID convention: 0=up, 255=down - no inversion needed)
-    hid_report.lx = profile_out.left_x;
-    hid_report.ly = profile_out.left_y;
-    hid_report.rx = profile_out.right_x;
-    hid_report.ry = profile_out.right_y;
+    hid_report->lx = profile_out.left_x;
+    hid_report->ly = profile_out.left_y;
+    hid_report->rx = profile_out.right_x;
+    hid_report->ry = profile_out.right_y;
 
     // PS3 pressure axes (0x00 = released, 0xFF = fully pressed)
-    hid_report.pressure_dpad_right = (processed_buttons & JP_BUTTON_DR) ? 0xFF : 0x00;
-    hid_report.pressure_dpad_left  = (processed_buttons & JP_BUTTON_DL) ? 0xFF : 0x00;
-    hid_report.pressure_dpad_up    = (processed_buttons & JP_BUTTON_DU) ? 0xFF : 0x00;
-    hid_report.pressure_dpad_down  = (processed_buttons & JP_BUTTON_DD) ? 0xFF : 0x00;
-    hid_report.pressure_triangle   = (buttons & USB_GAMEPAD_MASK_B4) ? 0xFF : 0x00;
-    hid_report.pressure_circle     = (buttons & USB_GAMEPAD_MASK_B2) ? 0xFF : 0x00;
-    hid_report.pressure_cross      = (buttons & USB_GAMEPAD_MASK_B1) ? 0xFF : 0x00;
-    hid_report.pressure_square     = (buttons & USB_GAMEPAD_MASK_B3) ? 0xFF : 0x00;
-    hid_report.pressure_l1         = (buttons & USB_GAMEPAD_MASK_L1) ? 0xFF : 0x00;
-    hid_report.pressure_r1         = (buttons & USB_GAMEPAD_MASK_R1) ? 0xFF : 0x00;
+    hid_report->pressure_dpad_right = (processed_buttons & JP_BUTTON_DR) ? 0xFF : 0x00;
+    hid_report->pressure_dpad_left  = (processed_buttons & JP_BUTTON_DL) ? 0xFF : 0x00;
+    hid_report->pressure_dpad_up    = (processed_buttons & JP_BUTTON_DU) ? 0xFF : 0x00;
+    hid_report->pressure_dpad_down  = (processed_buttons & JP_BUTTON_DD) ? 0xFF : 0x00;
+    hid_report->pressure_triangle   = (buttons & USB_GAMEPAD_MASK_B4) ? 0xFF : 0x00;
+    hid_report->pressure_circle     = (buttons & USB_GAMEPAD_MASK_B2) ? 0xFF : 0x00;
+    hid_report->pressure_cross      = (buttons & USB_GAMEPAD_MASK_B1) ? 0xFF : 0x00;
+    hid_report->pressure_square     = (buttons & USB_GAMEPAD_MASK_B3) ? 0xFF : 0x00;
+    hid_report->pressure_l1         = (buttons & USB_GAMEPAD_MASK_L1) ? 0xFF : 0x00;
+    hid_report->pressure_r1         = (buttons & USB_GAMEPAD_MASK_R1) ? 0xFF : 0x00;
     // Use analog values for L2/R2 triggers
-    hid_report.pressure_l2         = profile_out.l2_analog;
-    hid_report.pressure_r2         = profile_out.r2_analog;
-
-    return tud_hid_report(0, &hid_report, sizeof(hid_report));
+    hid_report->pressure_l2         = profile_out.l2_analog;
+    hid_report->pressure_r2         = profile_out.r2_analog;
 }
 
-#if CFG_TUD_XINPUT
-// Send XInput report (Xbox 360 mode)
-static bool usbd_send_xinput_report(uint8_t player_index)
+// Send HID report for a player on a HID instance (DInput modes)
+static bool usbd_send_hid_report_on(uint8_t instance, uint8_t player_index)
 {
-    if (!tud_xinput_ready()) {
+    if (!tud_hid_n_ready(instance)) {
         return false;
     }
 
@@ -695,12 +877,57 @@ static bool usbd_send_xinput_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
     pending_flags[player_index] = false;  // Clear after consumption
 
+    joypad_hid_report_t* hid_report = &hid_reports[instance];
+    report_cache_t* cache = &report_caches[instance];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_hid_report(hid_report, event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, hid_report, sizeof(*hid_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    if (!tud_hid_n_report(instance, 0, hid_report, sizeof(*hid_report))) return false;
+    report_cache_commit(cache, hid_report, sizeof(*hid_report), now_ms);
+    return true;
+}
+
+// Send HID report (DInput mode)
+static bool usbd_send_hid_report(uint8_t player_index)
+{
+    return usbd_send_hid_report_on(0, player_index);
+}
+
+// Multi-pad scheduler callbacks: pad N is HID instance N and player N
+static bool usbd_hid_multi_ready(uint8_t pad)
+{
+    return tud_hid_n_ready(pad);
+}
+
+static bool usbd_hid_multi_send(uint8_t pad)
+{
+    if (!usbd_poll_due(pad)) {
+        return false;
+    }
+    if (!usbd_send_hid_report_on(pad, pad)) {
+        return false;
+    }
+    usbd_poll_armed(&poll_sched, pad, pending_us[pad]);
+    return true;
+}
+
+#if CFG_TUD_XINPUT
+// Build XInput report from an input state
+static void usbd_build_xinput_report(const input_state_t* event, const input_ext_t* ext)
+{
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Digital buttons byte 0 (DPAD, Start, Back, L3, R3)
     xinput_report.buttons0 = 0;
@@ -736,15 +963,12 @@ static bool usbd_send_xinput_report(uint8_t player_index)
     xinput_report.stick_ly = convert_axis_to_s16_inverted(profile_out.left_y);
     xinput_report.stick_rx = convert_axis_to_s16(profile_out.right_x);
     xinput_report.stick_ry = convert_axis_to_s16_inverted(profile_out.right_y);
-
-    return tud_xinput_send_report(&xinput_report);
 }
-#endif
 
-// Send Switch report (Nintendo Switch mode)
-static bool usbd_send_switch_report(uint8_t player_index)
+// Send XInput report (Xbox 360 mode)
+static bool usbd_send_xinput_report(uint8_t player_index)
 {
-    if (!tud_hid_ready()) {
+    if (!tud_xinput_ready()) {
         return false;
     }
 
@@ -753,12 +977,32 @@ static bool usbd_send_switch_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
     pending_flags[player_index] = false;  // Clear after consumption
 
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_xinput_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, &xinput_report, sizeof(xinput_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    if (!tud_xinput_send_report(&xinput_report)) return false;
+    report_cache_commit(cache, &xinput_report, sizeof(xinput_report), now_ms);
+    return true;
+}
+#endif
+
+// Build Switch report from an input state
+static void usbd_build_switch_report(const input_state_t* event, const input_ext_t* ext)
+{
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Buttons (16-bit) - position-based mapping (matches GP2040-CE)
     switch_report.buttons = 0;
@@ -787,12 +1031,10 @@ static bool usbd_send_switch_report(uint8_t player_index)
     switch_report.ry = profile_out.right_y;
 
     switch_report.vendor = 0;
-
-    return tud_hid_report(0, &switch_report, sizeof(switch_report));
 }
 
-// Send PS3 report (PlayStation 3 DualShock 3 mode)
-static bool usbd_send_ps3_report(uint8_t player_index)
+// Send Switch report (Nintendo Switch mode)
+static bool usbd_send_switch_report(uint8_t player_index)
 {
     if (!tud_hid_ready()) {
         return false;
@@ -803,12 +1045,31 @@ static bool usbd_send_ps3_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
     pending_flags[player_index] = false;  // Clear after consumption
 
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_switch_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, &switch_report, sizeof(switch_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    if (!tud_hid_report(0, &switch_report, sizeof(switch_report))) return false;
+    report_cache_commit(cache, &switch_report, sizeof(switch_report), now_ms);
+    return true;
+}
+
+// Build PS3 report from an input state
+static void usbd_build_ps3_report(const input_state_t* event, const input_ext_t* ext)
+{
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Digital buttons byte 0
     ps3_report.buttons[0] = 0;
@@ -876,11 +1137,11 @@ static bool usbd_send_ps3_report(uint8_t player_index)
     }
 
     // Motion data (SIXAXIS) - big-endian 16-bit values
-    if (event->has_motion) {
-        ps3_report.accel_x = __builtin_bswap16((uint16_t)event->accel[0]);
-        ps3_report.accel_y = __builtin_bswap16((uint16_t)event->accel[1]);
-        ps3_report.accel_z = __builtin_bswap16((uint16_t)event->accel[2]);
-        ps3_report.gyro_z  = __builtin_bswap16((uint16_t)event->gyro[2]);
+    if (event->flags & INPUT_STATE_HAS_MOTION) {
+        ps3_report.accel_x = __builtin_bswap16((uint16_t)ext->accel[0]);
+        ps3_report.accel_y = __builtin_bswap16((uint16_t)ext->accel[1]);
+        ps3_report.accel_z = __builtin_bswap16((uint16_t)ext->accel[2]);
+        ps3_report.gyro_z  = __builtin_bswap16((uint16_t)ext->gyro[2]);
     } else {
         // Neutral motion (center at 512 = 0x0200, big-endian = 0x0002)
         ps3_report.accel_x = PS3_SIXAXIS_MID_BE;
@@ -890,15 +1151,10 @@ static bool usbd_send_ps3_report(uint8_t player_index)
     }
 
     // Send full report including report_id
-    return tud_hid_report(0, &ps3_report, sizeof(ps3_report));
 }
 
-// Send PS Classic report (PlayStation Classic mode)
-// GP2040-CE compatible 2-byte format:
-// Bits 0-9: 10 buttons
-// Bits 10-13: D-pad encoded
-// Bits 14-15: Padding
-static bool usbd_send_psclassic_report(uint8_t player_index)
+// Send PS3 report (PlayStation 3 DualShock 3 mode)
+static bool usbd_send_ps3_report(uint8_t player_index)
 {
     if (!tud_hid_ready()) {
         return false;
@@ -909,12 +1165,35 @@ static bool usbd_send_psclassic_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
     pending_flags[player_index] = false;  // Clear after consumption
 
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_ps3_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, &ps3_report, sizeof(ps3_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    if (!tud_hid_report(0, &ps3_report, sizeof(ps3_report))) return false;
+    report_cache_commit(cache, &ps3_report, sizeof(ps3_report), now_ms);
+    return true;
+}
+
+// Build PS Classic report from an input state
+// GP2040-CE compatible 2-byte format:
+// Bits 0-9: 10 buttons
+// Bits 10-13: D-pad encoded
+// Bits 14-15: Padding
+static void usbd_build_psclassic_report(const input_state_t* event, const input_ext_t* ext)
+{
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Start with D-pad centered
     psclassic_report.buttons = PSCLASSIC_DPAD_CENTER;
@@ -946,11 +1225,40 @@ static bool usbd_send_psclassic_report(uint8_t player_index)
         | (buttons & JP_BUTTON_R2 ? PSCLASSIC_MASK_R2       : 0)
         | (buttons & JP_BUTTON_S1 ? PSCLASSIC_MASK_SELECT   : 0)
         | (buttons & JP_BUTTON_S2 ? PSCLASSIC_MASK_START    : 0);
+}
+
+// Send PS Classic report (PlayStation Classic mode)
+static bool usbd_send_psclassic_report(uint8_t player_index)
+{
+    if (!tud_hid_ready()) {
+        return false;
+    }
+
+    // Check for pending event (event-driven from tap callback)
+    if (player_index >= USB_MAX_PLAYERS || !pending_flags[player_index]) {
+        return false;
+    }
+
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
+    pending_flags[player_index] = false;  // Clear after consumption
+
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_psclassic_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, &psclassic_report, sizeof(psclassic_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
 
-    return tud_hid_report(0, &psclassic_report, sizeof(psclassic_report));
+    if (!tud_hid_report(0, &psclassic_report, sizeof(psclassic_report))) return false;
+    report_cache_commit(cache, &psclassic_report, sizeof(psclassic_report), now_ms);
+    return true;
 }
 
-// Send PS4 report (PlayStation 4 DualShock 4 mode)
+// Build PS4 report from an input state
 // Uses raw byte array approach to avoid struct bitfield packing issues
 //
 // PS4 Report Layout (64 bytes):
@@ -965,23 +1273,11 @@ static bool usbd_send_psclassic_report(uint8_t player_index)
 //   Byte 8:    Left trigger analog (0x00-0xFF)
 //   Byte 9:    Right trigger analog (0x00-0xFF)
 //   Bytes 10-63: Timestamp, sensor data, touchpad data, padding
-static bool usbd_send_ps4_report(uint8_t player_index)
+static void usbd_build_ps4_report(const input_state_t* event, const input_ext_t* ext)
 {
-    if (!tud_hid_ready()) {
-        return false;
-    }
-
-    // Check for pending event (event-driven from tap callback)
-    if (player_index >= USB_MAX_PLAYERS || !pending_flags[player_index]) {
-        return false;
-    }
-
-    const input_event_t* event = &pending_events[player_index];
-    pending_flags[player_index] = false;  // Clear after consumption
-
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Byte 0: Report ID
     ps4_report_buffer[0] = 0x01;
@@ -1029,11 +1325,10 @@ static bool usbd_send_ps4_report(uint8_t player_index)
     if (buttons & JP_BUTTON_R3) byte6 |= 0x80;  // R3
     ps4_report_buffer[6] = byte6;
 
-    // Byte 7: PS + Touchpad + Counter (6-bit)
+    // Byte 7: PS + Touchpad (counter bits 2-7 are stamped at send)
     uint8_t byte7 = 0;
     if (buttons & JP_BUTTON_A1) byte7 |= 0x01;  // PS button
     if (buttons & JP_BUTTON_A2) byte7 |= 0x02;  // Touchpad click
-    byte7 |= ((ps4_report_counter++ & 0x3F) << 2);       // Counter in bits 2-7
     ps4_report_buffer[7] = byte7;
 
     // Bytes 8-9: Analog triggers
@@ -1042,16 +1337,12 @@ static bool usbd_send_ps4_report(uint8_t player_index)
 
     // Bytes 10-11: Timestamp (we can just increment)
     // Bytes 12-63: Leave as initialized (sensor data, touchpad, padding)
-
-    // Send with report_id=0x01, letting TinyUSB prepend it
-    // Skip byte 0 of buffer (our report_id) and send 63 bytes of data
-    return tud_hid_report(0x01, &ps4_report_buffer[1], 63);
 }
 
-// Send Xbox One report (GIP protocol)
-static bool usbd_send_xbone_report(uint8_t player_index)
+// Send PS4 report (PlayStation 4 DualShock 4 mode)
+static bool usbd_send_ps4_report(uint8_t player_index)
 {
-    if (!tud_xbone_ready()) {
+    if (!tud_hid_ready()) {
         return false;
     }
 
@@ -1060,15 +1351,44 @@ static bool usbd_send_xbone_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
     pending_flags[player_index] = false;  // Clear after consumption
 
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_ps4_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+
+    // The counter changes every report - compare without it
+    ps4_report_buffer[7] &= 0x03;
+    if (!report_cache_changed(cache, ps4_report_buffer, sizeof(ps4_report_buffer), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    ps4_report_buffer[7] |= (uint8_t)((ps4_report_counter++ & 0x3F) << 2);  // Counter in bits 2-7
+
+    // Send with report_id=0x01, letting TinyUSB prepend it
+    // Skip byte 0 of buffer (our report_id) and send 63 bytes of data
+    if (!tud_hid_report(0x01, &ps4_report_buffer[1], 63)) return false;
+
+    // TinyUSB copied the report; cache it without the counter
+    ps4_report_buffer[7] &= 0x03;
+    report_cache_commit(cache, ps4_report_buffer, sizeof(ps4_report_buffer), now_ms);
+    return true;
+}
+
+// Build Xbox One report from an input state
+static void usbd_build_xbone_report(const input_state_t* event, const input_ext_t* ext)
+{
     // Clear report
     memset(&xbone_report, 0, sizeof(gip_input_report_t));
 
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Buttons
     xbone_report.a = (buttons & JP_BUTTON_B1) ? 1 : 0;
@@ -1110,14 +1430,12 @@ static bool usbd_send_xbone_report(uint8_t player_index)
     xbone_report.left_stick_y = -convert_axis_to_s16(profile_out.left_y);
     xbone_report.right_stick_x = convert_axis_to_s16(profile_out.right_x);
     xbone_report.right_stick_y = -convert_axis_to_s16(profile_out.right_y);
-
-    return tud_xbone_send_report(&xbone_report);
 }
 
-// Send XAC report (Xbox Adaptive Controller compatible mode)
-static bool usbd_send_xac_report(uint8_t player_index)
+// Send Xbox One report (GIP protocol)
+static bool usbd_send_xbone_report(uint8_t player_index)
 {
-    if (!tud_hid_ready()) {
+    if (!tud_xbone_ready()) {
         return false;
     }
 
@@ -1126,12 +1444,31 @@ static bool usbd_send_xac_report(uint8_t player_index)
         return false;
     }
 
-    const input_event_t* event = &pending_events[player_index];
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
     pending_flags[player_index] = false;  // Clear after consumption
 
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_xbone_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, &xbone_report, sizeof(xbone_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    if (!tud_xbone_send_report(&xbone_report)) return false;
+    report_cache_commit(cache, &xbone_report, sizeof(xbone_report), now_ms);
+    return true;
+}
+
+// Build XAC report from an input state
+static void usbd_build_xac_report(const input_state_t* event, const input_ext_t* ext)
+{
     // Apply profile (combos, button remaps)
     profile_output_t profile_out;
-    uint32_t buttons = apply_usbd_profile(event, &profile_out);
+    uint32_t buttons = apply_usbd_profile(event, ext, &profile_out);
 
     // Analog sticks (HID convention: 0=up, 255=down - no inversion needed)
     xac_report.lx = profile_out.left_x;
@@ -1159,35 +1496,89 @@ static bool usbd_send_xac_report(uint8_t player_index)
 
     xac_report.buttons_lo = xac_buttons & 0x0F;
     xac_report.buttons_hi = (xac_buttons >> 4) & 0xFF;
+}
 
-    return tud_hid_report(0, &xac_report, sizeof(xac_report));
+// Send XAC report (Xbox Adaptive Controller compatible mode)
+static bool usbd_send_xac_report(uint8_t player_index)
+{
+    if (!tud_hid_ready()) {
+        return false;
+    }
+
+    // Check for pending event (event-driven from tap callback)
+    if (player_index >= USB_MAX_PLAYERS || !pending_flags[player_index]) {
+        return false;
+    }
+
+    const input_state_t* event = &pending_states[player_index];
+    const input_ext_t* ext = &pending_ext[player_index];
+    pending_flags[player_index] = false;  // Clear after consumption
+
+    report_cache_t* cache = &report_caches[0];
+    if (!usbd_input_unchanged(cache, event)) {
+        usbd_build_xac_report(event, ext);
+    }
+
+    uint32_t now_ms = usbd_now_ms();
+    if (!report_cache_changed(cache, &xac_report, sizeof(xac_report), now_ms)) {
+        return false;  // Same as the last report sent
+    }
+
+    if (!tud_hid_report(0, &xac_report, sizeof(xac_report))) return false;
+    report_cache_commit(cache, &xac_report, sizeof(xac_report), now_ms);
+    return true;
 }
 
 bool usbd_send_report(uint8_t player_index)
 {
+    bool sent;
+    uint8_t slot = 0;
+
     switch (output_mode) {
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
-            return usbd_send_xid_report(player_index);
+            sent = usbd_send_xid_report(player_index);
+            break;
 #if CFG_TUD_XINPUT
         case USB_OUTPUT_MODE_XINPUT:
-            return usbd_send_xinput_report(player_index);
+            sent = usbd_send_xinput_report(player_index);
+            break;
 #endif
         case USB_OUTPUT_MODE_SWITCH:
-            return usbd_send_switch_report(player_index);
+            sent = usbd_send_switch_report(player_index);
+            break;
         case USB_OUTPUT_MODE_PS3:
-            return usbd_send_ps3_report(player_index);
+            sent = usbd_send_ps3_report(player_index);
+            break;
         case USB_OUTPUT_MODE_PSCLASSIC:
-            return usbd_send_psclassic_report(player_index);
+            sent = usbd_send_psclassic_report(player_index);
+            break;
         case USB_OUTPUT_MODE_PS4:
-            return usbd_send_ps4_report(player_index);
+            sent = usbd_send_ps4_report(player_index);
+            break;
         case USB_OUTPUT_MODE_XBONE:
-            return usbd_send_xbone_report(player_index);
+            sent = usbd_send_xbone_report(player_index);
+            break;
         case USB_OUTPUT_MODE_XAC:
-            return usbd_send_xac_report(player_index);
+            sent = usbd_send_xac_report(player_index);
+            break;
+        case USB_OUTPUT_MODE_HID_MULTI:
+            if (player_index >= HID_MULTI_PADS) {
+                return false;
+            }
+            sent = usbd_send_hid_report_on(player_index, player_index);
+            slot = player_index;
+            break;
         case USB_OUTPUT_MODE_HID:
         default:
-            return usbd_send_hid_report(player_index);
+            sent = usbd_send_hid_report(player_index);
+            break;
+    }
+
+    // Track it until the host collects it (latency, poll phase)
+    if (sent) {
+        usbd_poll_armed(&poll_sched, slot, pending_us[player_index]);
     }
+    return sent;
 }
 
 // Get rumble value from USB host (for feedback to input controllers)
@@ -1385,6 +1776,8 @@ uint8_t const *tud_descriptor_device_cb(void)
             return (uint8_t const *)&xbone_device_descriptor;
         case USB_OUTPUT_MODE_XAC:
             return (uint8_t const *)&xac_device_descriptor;
+        case USB_OUTPUT_MODE_HID_MULTI:
+            return (uint8_t const *)&hid_multi_device_descriptor;
         case USB_OUTPUT_MODE_HID:
         default:
             return (uint8_t const *)&desc_device_hid;
@@ -1416,9 +1809,9 @@ static const uint8_t desc_configuration_hid[] = {
 #endif
 };
 
-uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
+// Mode's configuration descriptor as built (descriptor bInterval values)
+static const uint8_t* usbd_mode_config_descriptor(void)
 {
-    (void)index;
     switch (output_mode) {
         case USB_OUTPUT_MODE_XBOX_ORIGINAL:
             return xbox_og_config_descriptor;
@@ -1436,12 +1829,33 @@ uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
             return xbone_config_descriptor;
         case USB_OUTPUT_MODE_XAC:
             return xac_config_descriptor;
+        case USB_OUTPUT_MODE_HID_MULTI:
+            return hid_multi_config_descriptor;
         case USB_OUTPUT_MODE_HID:
         default:
             return desc_configuration_hid;
     }
 }
 
+// Largest configuration descriptor served with a patched poll interval
+#define CONFIG_DESC_BUF_SIZE 256
+static uint8_t config_desc_buf[CONFIG_DESC_BUF_SIZE];
+
+uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
+{
+    (void)index;
+    const uint8_t* config = usbd_mode_config_descriptor();
+    if (poll_interval == USBD_POLL_INTERVAL_DEFAULT) {
+        return config;
+    }
+
+    // Serve a RAM copy with the gamepad endpoints' bInterval overridden
+    if (usbd_poll_patch_config(config_desc_buf, sizeof(config_desc_buf), config, poll_interval) == 0) {
+        return config;
+    }
+    return config_desc_buf;
+}
+
 // ============================================================================
 // STRING DESCRIPTORS
 // ============================================================================
@@ -1529,6 +1943,8 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
                 str = PS4_MANUFACTURER;
             } else if (output_mode == USB_OUTPUT_MODE_XAC) {
                 str = XAC_MANUFACTURER;
+            } else if (output_mode == USB_OUTPUT_MODE_HID_MULTI) {
+                str = HID_MULTI_MANUFACTURER;
             } else {
                 str = USB_HID_MANUFACTURER;
             }
@@ -1547,6 +1963,8 @@ uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
                 str = PS4_PRODUCT;
             } else if (output_mode == USB_OUTPUT_MODE_XAC) {
                 str = XAC_PRODUCT;
+            } else if (output_mode == USB_OUTPUT_MODE_HID_MULTI) {
+                str = HID_MULTI_PRODUCT;
             } else {
                 str = USB_HID_PRODUCT;
             }
@@ -1606,8 +2024,6 @@ uint8_t const *tud_hid_descriptor_report_cb(uint8_t itf)
 
 uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t report_type, uint8_t *buffer, uint16_t reqlen)
 {
-    (void)itf;
-
     // PS3 feature reports
     if (output_mode == USB_OUTPUT_MODE_PS3 && report_type == HID_REPORT_TYPE_FEATURE) {
         uint16_t len = 0;
@@ -1710,9 +2126,10 @@ uint16_t tud_hid_get_report_cb(uint8_t itf, uint8_t report_id, hid_report_type_t
     // Default: return current input report
     (void)report_id;
     (void)report_type;
+    uint8_t pad = (output_mode == USB_OUTPUT_MODE_HID_MULTI && itf < HID_MULTI_PADS) ? itf : 0;
     uint16_t len = sizeof(joypad_hid_report_t);
     if (reqlen < len) len = reqlen;
-    memcpy(buffer, &hid_report, len);
+    memcpy(buffer, &hid_reports[pad], len);
     return len;
 }
 
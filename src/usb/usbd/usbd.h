@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "core/output_interface.h"
+#include "usbd_poll.h"
 
 // ============================================================================
 // OUTPUT MODES
@@ -27,6 +28,7 @@ typedef enum {
     USB_OUTPUT_MODE_PSCLASSIC,          // PlayStation Classic (PS1 Mini)
     USB_OUTPUT_MODE_XBONE,              // Xbox One (GIP protocol)
     USB_OUTPUT_MODE_XAC,                // Xbox Adaptive Controller compatible
+    USB_OUTPUT_MODE_HID_MULTI,          // Composite: one DInput pad per player
     USB_OUTPUT_MODE_COUNT
 } usb_output_mode_t;
 
@@ -109,6 +111,28 @@ bool usbd_set_mode(usb_output_mode_t mode);
 // Get mode name string
 const char* usbd_get_mode_name(usb_output_mode_t mode);
 
+// ============================================================================
+// POLLING INTERVAL AND LATENCY API
+// ============================================================================
+
+// Effective interrupt IN polling interval in ms (override or mode default)
+uint8_t usbd_get_poll_interval(void);
+
+// Stored override: 0 = mode default, else 1/2/4/8 ms
+uint8_t usbd_get_poll_interval_setting(void);
+
+// Set polling interval override (0 = mode default, 1/2/4/8 ms)
+// Returns false if invalid or unchanged; otherwise saves and resets
+// the device so the host re-reads the descriptors
+bool usbd_set_poll_interval(uint8_t interval_ms);
+
+// Input-to-USB-IN latency since boot or the last reset
+void usbd_get_latency(usbd_latency_t* out);
+void usbd_reset_latency(void);
+
+// True while reports are being held for the host's poll window
+bool usbd_poll_aligned(void);
+
 // Output interface for app integration
 extern const OutputInterface usbd_output_interface;
 
@@ -0,0 +1,46 @@
+// usbd_multi.c - Per-pad report scheduling for composite multi-pad modes
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "usbd_multi.h"
+#include <string.h>
+
+void usbd_multi_init(usbd_multi_sched_t* sched, uint8_t pad_count)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->pad_count = (pad_count > USBD_MULTI_MAX_PADS) ? USBD_MULTI_MAX_PADS : pad_count;
+}
+
+uint8_t usbd_multi_service(usbd_multi_sched_t* sched,
+                           usbd_multi_pad_fn_t ready, usbd_multi_pad_fn_t send)
+{
+    uint8_t count = sched->pad_count;
+    if (count == 0) {
+        return 0;
+    }
+
+    uint8_t queued = 0;
+    uint8_t start = sched->next;
+    uint8_t last_sent = start;
+    uint8_t pad = start;
+    for (uint8_t i = 0; i < count; i++) {
+        if (!ready(pad)) {
+            sched->busy[pad]++;
+        } else if (send(pad)) {
+            sched->sent[pad]++;
+            last_sent = pad;
+            queued++;
+        }
+        pad = (pad + 1 < count) ? pad + 1 : 0;
+    }
+
+    // Next pass starts after the last pad served; if every pad was served
+    // that is the same start again, so step it to keep the order rotating
+    if (queued == count) {
+        last_sent = start;
+    }
+    if (queued) {
+        sched->next = (last_sent + 1 < count) ? last_sent + 1 : 0;
+    }
+    return queued;
+}
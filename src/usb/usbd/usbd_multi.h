@@ -0,0 +1,41 @@
+// usbd_multi.h - Per-pad report scheduling for composite multi-pad modes
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// In multi-pad mode every pad is its own HID interface with its own
+// interrupt IN endpoint, so the host collects one report per pad per frame.
+// Each service pass offers every pad whose endpoint is idle a send; pads
+// still busy with an unread report are skipped, never waited on. The next
+// pass starts after the last pad served, so pads sharing a limited send
+// budget get equal turns and pad 0 is not always armed first.
+//
+// The scheduler only sequences callbacks; the USB stack calls live in
+// usbd.c, which keeps this testable on the host.
+
+#ifndef USBD_MULTI_H
+#define USBD_MULTI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define USBD_MULTI_MAX_PADS 4
+
+// Per-pad callback: ready = endpoint can take a report,
+// send = build and queue the pad's pending report (false if none)
+typedef bool (*usbd_multi_pad_fn_t)(uint8_t pad);
+
+typedef struct {
+    uint8_t pad_count;
+    uint8_t next;                           // Pad offered first on the next pass
+    uint32_t sent[USBD_MULTI_MAX_PADS];     // Reports queued per pad
+    uint32_t busy[USBD_MULTI_MAX_PADS];     // Passes that found the endpoint busy
+} usbd_multi_sched_t;
+
+// Reset counters and set the number of pads (clamped to USBD_MULTI_MAX_PADS)
+void usbd_multi_init(usbd_multi_sched_t* sched, uint8_t pad_count);
+
+// Run one pass over all pads; returns the number of reports queued
+uint8_t usbd_multi_service(usbd_multi_sched_t* sched,
+                           usbd_multi_pad_fn_t ready, usbd_multi_pad_fn_t send);
+
+#endif // USBD_MULTI_H
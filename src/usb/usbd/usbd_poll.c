@@ -0,0 +1,221 @@
+// usbd_poll.c - Host polling interval, poll-aligned submission and latency
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+
+#include "usbd_poll.h"
+#include <string.h>
+
+// Standard descriptor constants (kept local so this builds without tusb.h)
+#define DESC_INTERFACE      0x04
+#define DESC_ENDPOINT       0x05
+#define CLASS_CDC           0x02
+#define CLASS_CDC_DATA      0x0A
+#define XFER_INTERRUPT      0x03
+#define EP_DIR_IN           0x80
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+bool usbd_poll_interval_valid(uint8_t interval_ms)
+{
+    return interval_ms == USBD_POLL_INTERVAL_DEFAULT ||
+           interval_ms == 1 || interval_ms == 2 || interval_ms == 4 || interval_ms == 8;
+}
+
+static uint16_t config_total_length(const uint8_t* config)
+{
+    return (uint16_t)(config[2] | (config[3] << 8));
+}
+
+// Walk the descriptors after the configuration header, calling back on
+// every interrupt IN endpoint that belongs to a non-CDC interface
+typedef bool (*endpoint_fn_t)(uint8_t* ep, void* ctx);
+
+static void for_each_gamepad_in_endpoint(uint8_t* config, endpoint_fn_t fn, void* ctx)
+{
+    uint16_t total = config_total_length(config);
+    uint16_t pos = config[0];
+    bool cdc = false;
+
+    while (pos + 2 <= total) {
+        uint8_t* d = &config[pos];
+        if (d[0] < 2 || pos + d[0] > total) {
+            break;  // Malformed - stop rather than run off the end
+        }
+        if (d[1] == DESC_INTERFACE && d[0] >= 9) {
+            cdc = (d[5] == CLASS_CDC || d[5] == CLASS_CDC_DATA);
+        } else if (d[1] == DESC_ENDPOINT && d[0] >= 7 && !cdc &&
+                   (d[2] & EP_DIR_IN) && (d[3] & 0x03) == XFER_INTERRUPT) {
+            if (!fn(d, ctx)) {
+                return;
+            }
+        }
+        pos += d[0];
+    }
+}
+
+static bool set_interval(uint8_t* ep, void* ctx)
+{
+    ep[6] = *(const uint8_t*)ctx;
+    return true;
+}
+
+uint16_t usbd_poll_patch_config(uint8_t* dst, uint16_t dst_size,
+                                const uint8_t* config, uint8_t interval_ms)
+{
+    uint16_t total = config_total_length(config);
+    if (total > dst_size) {
+        return 0;
+    }
+
+    memcpy(dst, config, total);
+    if (interval_ms != USBD_POLL_INTERVAL_DEFAULT) {
+        for_each_gamepad_in_endpoint(dst, set_interval, &interval_ms);
+    }
+    return total;
+}
+
+static bool get_interval(uint8_t* ep, void* ctx)
+{
+    *(uint8_t*)ctx = ep[6];
+    return false;  // First one only
+}
+
+uint8_t usbd_poll_config_interval(const uint8_t* config)
+{
+    uint8_t interval = 0;
+    // Read-only walk: the callback never writes through the pointer
+    for_each_gamepad_in_endpoint((uint8_t*)config, get_interval, &interval);
+    return interval;
+}
+
+// ============================================================================
+// LATENCY
+// ============================================================================
+
+void usbd_latency_reset(usbd_latency_t* lat)
+{
+    memset(lat, 0, sizeof(*lat));
+    lat->min_us = UINT32_MAX;
+}
+
+void usbd_latency_record(usbd_latency_t* lat, uint32_t age_us)
+{
+    uint32_t bucket = age_us / USBD_LATENCY_BUCKET_US;
+    if (bucket >= USBD_LATENCY_BUCKETS) {
+        bucket = USBD_LATENCY_BUCKETS - 1;
+    }
+    lat->hist[bucket]++;
+    lat->count++;
+    lat->sum_us += age_us;
+    if (age_us < lat->min_us) lat->min_us = age_us;
+    if (age_us > lat->max_us) lat->max_us = age_us;
+}
+
+uint32_t usbd_latency_percentile(const usbd_latency_t* lat, uint8_t pct)
+{
+    if (lat->count == 0) {
+        return 0;
+    }
+
+    uint64_t target = ((uint64_t)lat->count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < USBD_LATENCY_BUCKETS - 1; i++) {
+        seen += lat->hist[i];
+        if (seen >= target) {
+            return (i + 1) * USBD_LATENCY_BUCKET_US;
+        }
+    }
+    return lat->max_us;  // Overflow bucket
+}
+
+// ============================================================================
+// POLL ALIGNMENT
+// ============================================================================
+
+void usbd_poll_init(usbd_poll_sched_t* sched, uint8_t interval_ms, bool aligned)
+{
+    memset(sched, 0, sizeof(*sched));
+    sched->period_us = (interval_ms ? interval_ms : 1) * 1000u;
+    sched->lead_us = USBD_POLL_LEAD_US;
+    sched->aligned = aligned;
+    usbd_latency_reset(&sched->latency);
+}
+
+bool usbd_poll_arm_now(usbd_poll_sched_t* sched, uint32_t now_us)
+{
+    if (!sched->aligned || !sched->locked) {
+        return true;
+    }
+
+    uint32_t since = now_us - sched->last_poll_us;
+    if (since > USBD_POLL_LOCK_TIMEOUT_US) {
+        sched->locked = false;  // Idle too long to trust the phase
+        return true;
+    }
+
+    // Time between calls while holding is one main loop pass; the window
+    // must be wider than the longest recent pass or it can be stepped over
+    if (sched->holding) {
+        uint32_t gap = now_us - sched->hold_check_us;
+        sched->pass_us -= sched->pass_us >> 8;
+        if (gap > sched->pass_us) {
+            sched->pass_us = gap;
+        }
+    }
+
+    uint32_t phase = since % sched->period_us;
+    if (sched->period_us - phase <= sched->pass_us + sched->lead_us) {
+        sched->holding = false;
+        return true;
+    }
+
+    // A slow main loop can step over the whole window; once a poll has gone
+    // by while holding, send now rather than wait another interval
+    if (sched->holding && phase < now_us - sched->hold_check_us) {
+        sched->holding = false;
+        return true;
+    }
+
+    sched->holding = true;
+    sched->hold_check_us = now_us;
+    sched->held++;
+    return false;
+}
+
+void usbd_poll_armed(usbd_poll_sched_t* sched, uint8_t slot, uint32_t input_us)
+{
+    if (slot >= USBD_POLL_SLOTS) {
+        return;
+    }
+    sched->in_flight[slot] = true;
+    sched->input_us[slot] = input_us;
+}
+
+void usbd_poll_idle(usbd_poll_sched_t* sched, uint8_t slot, uint32_t now_us)
+{
+    if (slot >= USBD_POLL_SLOTS || !sched->in_flight[slot]) {
+        return;
+    }
+    sched->in_flight[slot] = false;
+    usbd_latency_record(&sched->latency, now_us - sched->input_us[slot]);
+
+    if (!sched->locked) {
+        sched->last_poll_us = now_us;
+        sched->locked = true;
+        return;
+    }
+
+    // Collections are seen some time after the poll (whenever the main loop
+    // gets there), never before it. An observation earlier than predicted
+    // is the better estimate; a later one only nudges the phase, which
+    // follows clock drift between host and device.
+    uint32_t period = sched->period_us;
+    uint32_t phase = (now_us - sched->last_poll_us) % period;
+    if (phase > period / 2) {
+        sched->last_poll_us = now_us;
+    } else {
+        sched->last_poll_us = now_us - phase + phase / 256;
+    }
+}
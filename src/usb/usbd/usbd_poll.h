@@ -0,0 +1,133 @@
+// usbd_poll.h - Host polling interval, poll-aligned submission and latency
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2024 Robert Dale Smith
+//
+// Polling interval: the mode descriptors carry their own bInterval. A
+// stored override (1/2/4/8 ms) is patched into a RAM copy of the
+// configuration descriptor, on the gamepad interrupt IN endpoints only
+// (CDC endpoints and OUT endpoints keep theirs).
+//
+// Poll alignment: the host polls an interrupt IN endpoint once every
+// bInterval frames, at a fixed offset from SOF. A report queued as soon as
+// the endpoint goes idle waits out most of that interval in the endpoint
+// buffer while newer input piles up behind it. The scheduler learns the
+// poll phase from the moments the host collects a report and holds the
+// next one until one main loop pass (measured) plus USBD_POLL_LEAD_US
+// before the predicted poll, so it carries the freshest router state.
+// Until the phase is known (or after USBD_POLL_LOCK_TIMEOUT_US without a
+// collection) reports go out at once.
+//
+// The phase comes from collections rather than tud_sof_cb(): TinyUSB runs
+// that callback from tud_task() too, so its timestamps carry the same main
+// loop delay, and it would add an event every frame. Host polls are locked
+// to SOF, so the collection phase is the SOF phase plus the host's fixed
+// offset into the frame.
+//
+// Latency: every collected report records how old its input was, from the
+// router tap to the host picking it up (time spent in the endpoint buffer
+// included). Exposed over CDC as LATENCY?.
+//
+// Everything here takes timestamps as arguments; the USB stack calls live
+// in usbd.c, which keeps this testable on the host.
+
+#ifndef USBD_POLL_H
+#define USBD_POLL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Interval setting: 0 keeps the mode's descriptor value
+#define USBD_POLL_INTERVAL_DEFAULT  0
+
+// Hold reports for the host's poll window (0 = queue as soon as idle)
+#ifndef USBD_POLL_ALIGN
+#define USBD_POLL_ALIGN             1
+#endif
+
+// Margin beyond one main loop pass when arming before the predicted poll
+#ifndef USBD_POLL_LEAD_US
+#define USBD_POLL_LEAD_US           100
+#endif
+
+// Phase is dropped after this long without a collection
+#define USBD_POLL_LOCK_TIMEOUT_US   500000
+
+// Report slots tracked in flight (one per endpoint; multi-pad uses 4)
+#define USBD_POLL_SLOTS             4
+
+// Latency histogram: 250us buckets up to 8ms, last bucket is overflow
+#define USBD_LATENCY_BUCKET_US      250
+#define USBD_LATENCY_BUCKETS        33
+
+// ============================================================================
+// DESCRIPTORS
+// ============================================================================
+
+// True for 0 (mode default) and 1/2/4/8 ms
+bool usbd_poll_interval_valid(uint8_t interval_ms);
+
+// Copy a configuration descriptor into dst with the gamepad interrupt IN
+// endpoints set to interval_ms. Returns the length copied, 0 if dst is
+// too small (caller keeps the original).
+uint16_t usbd_poll_patch_config(uint8_t* dst, uint16_t dst_size,
+                                const uint8_t* config, uint8_t interval_ms);
+
+// bInterval of the first gamepad interrupt IN endpoint (0 if none)
+uint8_t usbd_poll_config_interval(const uint8_t* config);
+
+// ============================================================================
+// LATENCY
+// ============================================================================
+
+typedef struct {
+    uint32_t count;
+    uint64_t sum_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t hist[USBD_LATENCY_BUCKETS];
+} usbd_latency_t;
+
+void usbd_latency_reset(usbd_latency_t* lat);
+void usbd_latency_record(usbd_latency_t* lat, uint32_t age_us);
+
+// Upper bound of the histogram bucket holding the pct-th percentile
+uint32_t usbd_latency_percentile(const usbd_latency_t* lat, uint8_t pct);
+
+// ============================================================================
+// POLL ALIGNMENT
+// ============================================================================
+
+typedef struct {
+    uint32_t period_us;                     // Poll interval
+    uint32_t lead_us;
+    uint32_t pass_us;                       // Longest recent main loop pass (decaying)
+    uint32_t last_poll_us;                  // Last observed collection
+    bool locked;                            // Phase known
+    bool aligned;                           // Hold reports for the poll window
+    bool holding;                           // Last call held a report back
+    uint32_t hold_check_us;                 // Time of that call
+    uint32_t held;                          // Calls that held a report back
+
+    bool in_flight[USBD_POLL_SLOTS];        // Report queued, not yet collected
+    uint32_t input_us[USBD_POLL_SLOTS];     // Arrival of the input it carries
+
+    usbd_latency_t latency;
+} usbd_poll_sched_t;
+
+// Reset for a poll interval; aligned = false sends as soon as the
+// endpoint is idle (previous behaviour) but still measures latency
+void usbd_poll_init(usbd_poll_sched_t* sched, uint8_t interval_ms, bool aligned);
+
+// Call when a report is waiting and its endpoint is idle. True if it should
+// be queued now: the next poll is within a pass plus lead_us, a poll went
+// by since the last call held it, the phase is unknown, or alignment is off.
+bool usbd_poll_arm_now(usbd_poll_sched_t* sched, uint32_t now_us);
+
+// A report carrying input that arrived at input_us was queued on slot
+void usbd_poll_armed(usbd_poll_sched_t* sched, uint8_t slot, uint32_t input_us);
+
+// The slot's endpoint is idle again: if a report was in flight the host
+// collected it (at about now_us). Records latency and the poll phase.
+void usbd_poll_idle(usbd_poll_sched_t* sched, uint8_t slot, uint32_t now_us);
+
+#endif // USBD_POLL_H
@@ -0,0 +1,96 @@
+// hci_rx_queue.c - Receive buffer pool for the USB Bluetooth dongle transport
+
+#include "hci_rx_queue.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+void hci_rx_queue_init(hci_rx_queue_t* q, uint8_t* bufs, uint16_t buf_size, uint8_t count)
+{
+    memset(q, 0, sizeof(*q));
+    if (count > HCI_RX_QUEUE_MAX) count = HCI_RX_QUEUE_MAX;
+    // Free-running 8-bit indices need a power-of-two ring
+    while (count & (count - 1)) count &= (uint8_t)(count - 1);
+    q->bufs = bufs;
+    q->buf_size = buf_size;
+    q->count = count ? count : 1;
+}
+
+void hci_rx_queue_flush(hci_rx_queue_t* q)
+{
+    q->tail = q->head;
+}
+
+uint8_t* hci_rx_queue_acquire(hci_rx_queue_t* q)
+{
+    if (hci_rx_queue_depth(q) >= q->count) {
+        q->stalls++;
+        return NULL;
+    }
+    return q->bufs + (size_t)(q->head & (q->count - 1)) * q->buf_size;
+}
+
+void hci_rx_queue_commit(hci_rx_queue_t* q, uint16_t len)
+{
+    q->len[q->head & (q->count - 1)] = len;
+    q->packets++;
+    __dmb();                    // Length and data visible before the packet is published to the consumer
+    q->head = q->head + 1;
+
+    uint8_t depth = hci_rx_queue_depth(q);
+    if (depth > q->max_depth) q->max_depth = depth;
+}
+
+void hci_rx_queue_commit_after(hci_rx_queue_t* q, uint16_t len, const hci_rx_queue_t* other)
+{
+    q->mark[q->head & (q->count - 1)] = other->head;
+    hci_rx_queue_commit(q, len);
+}
+
+void hci_rx_queue_drop(hci_rx_queue_t* q)
+{
+    q->drops++;
+}
+
+uint8_t* hci_rx_queue_peek(hci_rx_queue_t* q, uint16_t* len)
+{
+    if (q->head == q->tail) {
+        return NULL;
+    }
+    __dmb();
+    uint8_t slot = q->tail & (q->count - 1);
+    *len = q->len[slot];
+    return q->bufs + (size_t)slot * q->buf_size;
+}
+
+void hci_rx_queue_release(hci_rx_queue_t* q)
+{
+    __dmb();                    // Done reading before the buffer is reused
+    q->tail = q->tail + 1;
+}
+
+bool hci_rx_queue_event_may_pass(const hci_rx_queue_t* evt, const hci_rx_queue_t* acl)
+{
+    if (evt->head == evt->tail) {
+        return true;
+    }
+    __dmb();
+    uint8_t slot = evt->tail & (evt->count - 1);
+    const uint8_t* event = evt->bufs + (size_t)slot * evt->buf_size;
+
+    // Disconnection Complete: event code, length, status, handle
+    if (evt->len[slot] < 5 || event[0] != 0x05) {
+        return true;
+    }
+    uint16_t handle = (uint16_t)((event[3] | (event[4] << 8)) & 0x0FFF);
+
+    // ACL packets committed before the event
+    uint8_t mark = evt->mark[slot];
+    for (uint8_t i = acl->tail; (int8_t)(mark - i) > 0; i++) {
+        uint8_t acl_slot = i & (acl->count - 1);
+        const uint8_t* pkt = acl->bufs + (size_t)acl_slot * acl->buf_size;
+        if (acl->len[acl_slot] >= 2 && ((pkt[0] | (pkt[1] << 8)) & 0x0FFF) == handle) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+// hci_rx_queue.h - Receive buffer pool for the USB Bluetooth dongle transport
+//
+// Each IN endpoint (HCI events, ACL data) gets a small ring of receive
+// buffers shared between the TinyUSB completion callback (producer) and
+// hci_transport_h2_tinyusb_process() (consumer):
+//
+//   producer  hci_rx_queue_acquire()  buffer for the next IN transfer
+//             hci_rx_queue_commit()   transfer done, hand it to the consumer
+//   consumer  hci_rx_queue_peek()     oldest received packet
+//             hci_rx_queue_release()  packet delivered, buffer free again
+//
+// The callback re-arms the endpoint into the next free buffer as soon as a
+// transfer completes, so the dongle keeps being read while BTstack works
+// through earlier packets. Only when every buffer is waiting for BTstack
+// is the endpoint left idle (a stall); the consumer re-arms it on release.
+//
+// head is written only by the producer and tail only by the consumer, so
+// no locking is needed. Pure C with no TinyUSB/BTstack dependencies, so it
+// can be driven on the host (src/bench/checks/hci_rx_queue.c).
+
+#ifndef HCI_RX_QUEUE_H
+#define HCI_RX_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Upper bound on buffers per queue (count must be a power of two)
+#define HCI_RX_QUEUE_MAX    8
+
+typedef struct {
+    uint8_t* bufs;                      // count * buf_size bytes
+    uint16_t buf_size;
+    uint8_t  count;
+
+    volatile uint8_t head;              // Packets committed (free-running)
+    volatile uint8_t tail;              // Packets released (free-running)
+    uint16_t len[HCI_RX_QUEUE_MAX];     // Received length per buffer
+    uint8_t  mark[HCI_RX_QUEUE_MAX];    // Other queue's head at commit (hci_rx_queue_commit_after())
+
+    // Counters
+    uint32_t packets;                   // Packets committed
+    uint32_t drops;                     // Transfers lost (failed or discarded)
+    uint32_t stalls;                    // Completions that found every buffer in use
+    uint8_t  max_depth;                 // High-water mark of queued packets
+} hci_rx_queue_t;
+
+// Set up a queue over count buffers of buf_size bytes each
+void hci_rx_queue_init(hci_rx_queue_t* q, uint8_t* bufs, uint16_t buf_size, uint8_t count);
+
+// Forget queued packets (keeps counters)
+void hci_rx_queue_flush(hci_rx_queue_t* q);
+
+// Producer: buffer for the next transfer, or NULL (and a stall) if all are queued
+uint8_t* hci_rx_queue_acquire(hci_rx_queue_t* q);
+
+// Producer: the acquired buffer now holds len bytes
+void hci_rx_queue_commit(hci_rx_queue_t* q, uint16_t len);
+
+// Producer: as hci_rx_queue_commit(), also noting how many packets other
+// had received by then, so the consumer can tell arrival order across queues
+void hci_rx_queue_commit_after(hci_rx_queue_t* q, uint16_t len, const hci_rx_queue_t* other);
+
+// Producer: the acquired buffer's transfer was lost
+void hci_rx_queue_drop(hci_rx_queue_t* q);
+
+// Consumer: oldest queued packet (NULL if empty)
+uint8_t* hci_rx_queue_peek(hci_rx_queue_t* q, uint16_t* len);
+
+// Consumer: done with the packet returned by hci_rx_queue_peek()
+void hci_rx_queue_release(hci_rx_queue_t* q);
+
+// Consumer: whether the oldest HCI event in evt may be delivered ahead of
+// the ACL data queued in acl. Events normally go first, so a Connection
+// Complete reaches BTstack before the link's data; a Disconnection Complete
+// waits until the ACL data for its handle that arrived before it (evt
+// committed with hci_rx_queue_commit_after()) has been delivered.
+bool hci_rx_queue_event_may_pass(const hci_rx_queue_t* evt, const hci_rx_queue_t* acl);
+
+// Packets waiting for the consumer
+static inline uint8_t hci_rx_queue_depth(const hci_rx_queue_t* q) {
+    return (uint8_t)(q->head - q->tail);
+}
+
+#endif // HCI_RX_QUEUE_H
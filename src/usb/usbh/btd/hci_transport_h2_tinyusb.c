@@ -10,9 +10,15 @@
 // - Bulk IN (0x82): ACL Data (controller->host)
 // - Bulk OUT (0x02): ACL Data (host->controller)
 //
+// Received events and ACL packets go through a small pool of buffers per
+// endpoint (hci_rx_queue.h). The completion callback queues each packet and
+// re-arms the endpoint straight away; hci_transport_h2_tinyusb_process()
+// delivers queued packets to BTstack in order.
+//
 // Uses BTstack for full Bluetooth stack integration.
 
 #include "hci_transport_h2_tinyusb.h"
+#include "hci_rx_queue.h"
 #include "tusb.h"
 #include "host/usbh_pvt.h"
 
@@ -44,8 +50,6 @@ typedef struct {
 
     // Buffers
     uint8_t  cmd_buf[HCI_USB_CMD_BUF_SIZE];
-    uint8_t  evt_buf[HCI_USB_EVT_BUF_SIZE];
-    uint8_t  acl_in_buf[HCI_USB_ACL_BUF_SIZE];
     uint8_t  acl_out_buf[HCI_USB_ACL_BUF_SIZE];
 
     // State flags
@@ -56,12 +60,6 @@ typedef struct {
     bool     cmd_pending;       // Command transfer pending
     bool     acl_out_pending;   // ACL OUT transfer pending
 
-    // Received packet info (for deferred processing)
-    bool     evt_ready;         // Event packet ready for processing
-    uint16_t evt_len;           // Event packet length
-    bool     acl_ready;         // ACL packet ready for processing
-    uint16_t acl_len;           // ACL packet length
-
     // BTstack packet handler
     void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
 
@@ -69,6 +67,13 @@ typedef struct {
 
 static hci_usb_state_t usb_state;
 
+// Receive buffers, queued from the completion callback until BTstack takes them.
+// Kept outside usb_state so the counters survive transport init.
+static uint8_t evt_bufs[HCI_USB_EVT_QUEUE_DEPTH][HCI_USB_EVT_BUF_SIZE];
+static uint8_t acl_in_bufs[HCI_USB_ACL_QUEUE_DEPTH][HCI_USB_ACL_BUF_SIZE];
+static hci_rx_queue_t evt_queue;
+static hci_rx_queue_t acl_in_queue;
+
 #if USE_BTSTACK
 // Data source for BTstack run loop integration
 static btstack_data_source_t transport_data_source;
@@ -173,6 +178,10 @@ static int hci_transport_h2_open(void)
     btstack_run_loop_add_data_source(&transport_data_source);
 #endif
 
+    // Packets left over from a previous session are stale
+    hci_rx_queue_flush(&evt_queue);
+    hci_rx_queue_flush(&acl_in_queue);
+
     // Start receiving events and ACL data
     usb_submit_event_transfer();
     usb_submit_acl_in_transfer();
@@ -350,50 +359,47 @@ static void hci_transport_h2_process_data_source(btstack_data_source_t *ds,
 
 void hci_transport_h2_tinyusb_process(void)
 {
-    // Deliver any received event packets
-    if (usb_state.evt_ready && usb_state.packet_handler) {
-        usb_state.evt_ready = false;
-        // printf("[HCI_USB] Delivering event: %d bytes [%02X %02X %02X %02X %02X %02X]\n",
-        //        usb_state.evt_len,
-        //        usb_state.evt_buf[0], usb_state.evt_buf[1], usb_state.evt_buf[2],
-        //        usb_state.evt_buf[3], usb_state.evt_buf[4], usb_state.evt_buf[5]);
-        usb_state.packet_handler(HCI_EVENT_PACKET, usb_state.evt_buf, usb_state.evt_len);
-        // printf("[HCI_USB] Event delivered OK\n");
-
-        // Submit next event transfer
-        usb_submit_event_transfer();
-
-#if USE_BTSTACK
-        // After delivering event, trigger BTstack to process (may want to send next command)
-        btstack_run_loop_embedded_execute_once();
-#endif
-    }
-
-    // Deliver any received ACL packets
-    if (usb_state.acl_ready && usb_state.packet_handler) {
-        usb_state.acl_ready = false;
-
-        // Debug: Show ACL packet with L2CAP/ATT header
-        if (usb_state.acl_len >= 9) {
-            // Debug disabled - too much output causes buffer issues
-            // uint16_t handle = usb_state.acl_in_buf[0] | ((usb_state.acl_in_buf[1] & 0x0F) << 8);
-            // uint16_t l2cap_len = usb_state.acl_in_buf[4] | (usb_state.acl_in_buf[5] << 8);
-            // uint16_t l2cap_cid = usb_state.acl_in_buf[6] | (usb_state.acl_in_buf[7] << 8);
-            // uint8_t att_opcode = usb_state.acl_in_buf[8];
-            // printf("[HCI_USB] ACL h=0x%04X L2CAP len=%d cid=0x%04X ATT=0x%02X\n",
-            //        handle, l2cap_len, l2cap_cid, att_opcode);
+    uint8_t* packet;
+    uint16_t len;
+    bool delivered = false;
+
+    // Events and ACL data come in on separate endpoints, so arrival order
+    // between the two queues is not the dongle's order anyway. Events go
+    // first, so a connection's Connection Complete reaches BTstack before
+    // its data, except a Disconnection Complete waits for the ACL data for
+    // its handle that arrived before it (hci_rx_queue_event_may_pass()).
+    // Within each queue packets stay in order.
+    while (usb_state.packet_handler) {
+        packet = hci_rx_queue_peek(&evt_queue, &len);
+        if (packet && hci_rx_queue_event_may_pass(&evt_queue, &acl_in_queue)) {
+            usb_state.packet_handler(HCI_EVENT_PACKET, packet, len);
+            hci_rx_queue_release(&evt_queue);
+
+            // Re-arm the endpoint if every buffer was queued
+            usb_submit_event_transfer();
+            delivered = true;
+            continue;
         }
 
-        usb_state.packet_handler(HCI_ACL_DATA_PACKET, usb_state.acl_in_buf, usb_state.acl_len);
+        packet = hci_rx_queue_peek(&acl_in_queue, &len);
+        if (packet == NULL) {
+            break;
+        }
+        usb_state.packet_handler(HCI_ACL_DATA_PACKET, packet, len);
+        hci_rx_queue_release(&acl_in_queue);
 
-        // Submit next ACL transfer
         usb_submit_acl_in_transfer();
+        delivered = true;
+    }
 
 #if USE_BTSTACK
-        // After delivering ACL, trigger BTstack to process (GATT notifications, etc.)
+    // After delivering, trigger BTstack to process (next command, GATT notifications, etc.)
+    if (delivered) {
         btstack_run_loop_embedded_execute_once();
-#endif
     }
+#else
+    (void)delivered;
+#endif
 
 #if !USE_BTSTACK
     // Process queued test commands (standalone mode)
@@ -411,6 +417,20 @@ bool hci_transport_h2_tinyusb_is_connected(void)
     return usb_state.connected;
 }
 
+void hci_transport_h2_tinyusb_get_stats(hci_usb_stats_t* stats)
+{
+    stats->evt_packets = evt_queue.packets;
+    stats->evt_drops = evt_queue.drops;
+    stats->evt_stalls = evt_queue.stalls;
+    stats->evt_depth = hci_rx_queue_depth(&evt_queue);
+    stats->evt_max_depth = evt_queue.max_depth;
+    stats->acl_packets = acl_in_queue.packets;
+    stats->acl_drops = acl_in_queue.drops;
+    stats->acl_stalls = acl_in_queue.stalls;
+    stats->acl_depth = hci_rx_queue_depth(&acl_in_queue);
+    stats->acl_max_depth = acl_in_queue.max_depth;
+}
+
 // ============================================================================
 // STANDALONE TEST MODE
 // ============================================================================
@@ -722,11 +742,16 @@ static void usb_submit_event_transfer(void)
         return;
     }
 
+    // All buffers waiting for BTstack: process() re-arms after delivering one
+    uint8_t* buf = hci_rx_queue_acquire(&evt_queue);
+    if (!buf) {
+        return;
+    }
+
     usb_state.evt_pending = true;
-    memset(usb_state.evt_buf, 0, sizeof(usb_state.evt_buf));
 
     bool ok = usbh_edpt_xfer(usb_state.dev_addr, usb_state.ep_evt_in,
-                             usb_state.evt_buf, sizeof(usb_state.evt_buf));
+                             buf, HCI_USB_EVT_BUF_SIZE);
     // printf("[HCI_USB] Submit event xfer: %s\n", ok ? "OK" : "FAIL");
     if (!ok) {
         usb_state.evt_pending = false;
@@ -739,11 +764,15 @@ static void usb_submit_acl_in_transfer(void)
         return;
     }
 
+    uint8_t* buf = hci_rx_queue_acquire(&acl_in_queue);
+    if (!buf) {
+        return;
+    }
+
     usb_state.acl_in_pending = true;
-    memset(usb_state.acl_in_buf, 0, sizeof(usb_state.acl_in_buf));
 
     if (!usbh_edpt_xfer(usb_state.dev_addr, usb_state.ep_acl_in,
-                        usb_state.acl_in_buf, sizeof(usb_state.acl_in_buf))) {
+                        buf, HCI_USB_ACL_BUF_SIZE)) {
         usb_state.acl_in_pending = false;
         printf("[HCI_USB] Failed to submit ACL IN transfer\n");
     }
@@ -759,6 +788,10 @@ bool btstack_driver_init(void)
     void (*saved_handler)(uint8_t, uint8_t*, uint16_t) = usb_state.packet_handler;
     memset(&usb_state, 0, sizeof(usb_state));
     usb_state.packet_handler = saved_handler;
+    hci_rx_queue_init(&evt_queue, &evt_bufs[0][0], HCI_USB_EVT_BUF_SIZE,
+                      HCI_USB_EVT_QUEUE_DEPTH);
+    hci_rx_queue_init(&acl_in_queue, &acl_in_bufs[0][0], HCI_USB_ACL_BUF_SIZE,
+                      HCI_USB_ACL_QUEUE_DEPTH);
     printf("[HCI_USB] Driver initialized (handler=%p)\n", (void*)saved_handler);
     return true;
 }
@@ -910,11 +943,13 @@ bool btstack_driver_xfer_cb(uint8_t dev_addr, uint8_t ep_addr,
     if (result != XFER_RESULT_SUCCESS) {
         printf("[HCI_USB] Transfer failed on EP 0x%02X: %d\n", ep_addr, result);
 
-        // Clear pending flags
+        // Clear pending flags (the packet in flight is lost)
         if (ep_addr == usb_state.ep_evt_in) {
             usb_state.evt_pending = false;
+            hci_rx_queue_drop(&evt_queue);
         } else if (ep_addr == usb_state.ep_acl_in) {
             usb_state.acl_in_pending = false;
+            hci_rx_queue_drop(&acl_in_queue);
         } else if (ep_addr == usb_state.ep_acl_out) {
             usb_state.acl_out_pending = false;
         }
@@ -926,8 +961,10 @@ bool btstack_driver_xfer_cb(uint8_t dev_addr, uint8_t ep_addr,
         // HCI Event received
         // printf("[HCI_USB] HCI Event: %d bytes\n", (int)xferred_bytes);
         usb_state.evt_pending = false;
-        usb_state.evt_len = (uint16_t)xferred_bytes;
-        usb_state.evt_ready = true;
+        hci_rx_queue_commit_after(&evt_queue, (uint16_t)xferred_bytes, &acl_in_queue);
+
+        // Keep reading while BTstack catches up
+        usb_submit_event_transfer();
 
 #if USE_BTSTACK
         // Trigger BTstack run loop
@@ -937,8 +974,9 @@ bool btstack_driver_xfer_cb(uint8_t dev_addr, uint8_t ep_addr,
     else if (ep_addr == usb_state.ep_acl_in) {
         // ACL Data received
         usb_state.acl_in_pending = false;
-        usb_state.acl_len = (uint16_t)xferred_bytes;
-        usb_state.acl_ready = true;
+        hci_rx_queue_commit(&acl_in_queue, (uint16_t)xferred_bytes);
+
+        usb_submit_acl_in_transfer();
 
 #if USE_BTSTACK
         // Trigger BTstack run loop
@@ -990,6 +1028,10 @@ void btstack_driver_close(uint8_t dev_addr)
     usb_state.acl_in_pending = false;
     usb_state.cmd_pending = false;
     usb_state.acl_out_pending = false;
+
+    // Dropped with the dongle: don't deliver packets to a reconnected one
+    hci_rx_queue_flush(&evt_queue);
+    hci_rx_queue_flush(&acl_in_queue);
 }
 
 // ============================================================================
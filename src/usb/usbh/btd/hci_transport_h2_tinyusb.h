@@ -118,6 +118,31 @@ const hci_transport_t* hci_transport_h2_tinyusb_instance(void);
 #define HCI_USB_EVT_BUF_SIZE        264     // HCI event buffer
 #define HCI_USB_ACL_BUF_SIZE        1024    // ACL data buffer (larger for GATT)
 
+// Receive buffers per IN endpoint (power of two, max HCI_RX_QUEUE_MAX).
+// Two let the completion callback re-arm while BTstack still holds the last
+// packet. TinyUSB only reports completions from tuh_task(), so more help
+// only if tuh_task() runs several times between process() calls.
+#ifndef HCI_USB_EVT_QUEUE_DEPTH
+#define HCI_USB_EVT_QUEUE_DEPTH     2
+#endif
+#ifndef HCI_USB_ACL_QUEUE_DEPTH
+#define HCI_USB_ACL_QUEUE_DEPTH     2
+#endif
+
+// Receive path counters (see hci_rx_queue.h)
+typedef struct {
+    uint32_t evt_packets;       // HCI events received
+    uint32_t evt_drops;         // Event transfers lost
+    uint32_t evt_stalls;        // Times every event buffer was waiting for BTstack
+    uint8_t  evt_depth;         // Events queued now
+    uint8_t  evt_max_depth;     // Most events ever queued at once
+    uint32_t acl_packets;       // ACL packets received
+    uint32_t acl_drops;         // ACL transfers lost
+    uint32_t acl_stalls;        // Times every ACL buffer was waiting for BTstack
+    uint8_t  acl_depth;         // ACL packets queued now
+    uint8_t  acl_max_depth;     // Most ACL packets ever queued at once
+} hci_usb_stats_t;
+
 // TinyUSB class driver interface - register with usbh_app_driver_get_cb()
 #include "tusb.h"
 #include "host/usbh_pvt.h"
@@ -140,6 +165,9 @@ void hci_transport_h2_tinyusb_process(void);
 // Check if a Bluetooth dongle is connected
 bool hci_transport_h2_tinyusb_is_connected(void);
 
+// Snapshot of the receive queue counters (logged by usbh_task() on loss/stalls)
+void hci_transport_h2_tinyusb_get_stats(hci_usb_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
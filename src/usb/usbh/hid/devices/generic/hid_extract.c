@@ -0,0 +1,319 @@
+// hid_extract.c
+// Compiles parsed HID report items into an extraction plan and runs it
+#include "hid_extract.h"
+#include "tusb.h"
+#include <string.h>
+
+#define HID_EXTRACT_MAX_FIELD_BITS 16
+
+// ============================================================================
+// PLAN COMPILER
+// ============================================================================
+
+// Compiler state: the plan being built and the report ID of each op
+// (ops are grouped by ID afterwards)
+typedef struct {
+  hid_extract_plan_t* plan;
+  uint8_t op_report_ids[HID_EXTRACT_MAX_OPS];
+} compile_ctx_t;
+
+static hid_extract_op_t* find_op(compile_ctx_t* ctx, uint8_t report_id, uint8_t field)
+{
+  hid_extract_plan_t* plan = ctx->plan;
+  for (uint8_t i = 0; i < plan->op_count; i++) {
+    if (ctx->op_report_ids[i] == report_id && plan->ops[i].field == field) {
+      return &plan->ops[i];
+    }
+  }
+  return NULL;
+}
+
+static hid_extract_op_t* new_op(compile_ctx_t* ctx, uint8_t report_id)
+{
+  hid_extract_plan_t* plan = ctx->plan;
+  if (plan->op_count >= HID_EXTRACT_MAX_OPS) {
+    TU_LOG1("HID extract: op limit reached, ignoring item\r\n");
+    return NULL;
+  }
+  ctx->op_report_ids[plan->op_count] = report_id;
+  hid_extract_op_t* op = &plan->ops[plan->op_count++];
+  memset(op, 0, sizeof(*op));
+  return op;
+}
+
+// Axis or hat: later items for the same field and report ID replace earlier ones
+static void add_value_op(compile_ctx_t* ctx, const HID_ReportItem_t* item, uint8_t field)
+{
+  uint8_t bit_size = item->Attributes.BitSize;
+  if (bit_size == 0 || bit_size > HID_EXTRACT_MAX_FIELD_BITS) return;
+
+  uint32_t mask = (1u << bit_size) - 1;
+  int32_t min = (int32_t)item->Attributes.Logical.Minimum;
+  int64_t range = (int64_t)(int32_t)item->Attributes.Logical.Maximum - min;
+  if (range > mask) range = mask;
+  if (range < 2) return;
+
+  hid_extract_op_t* op = find_op(ctx, item->ReportID, field);
+  if (!op) op = new_op(ctx, item->ReportID);
+  if (!op) return;
+
+  op->bit_offset = item->BitOffset;
+  op->bit_size = bit_size;
+  op->field = field;
+  op->bias = (uint16_t)((uint32_t)min & mask);
+  op->range = (uint16_t)range;
+  op->mid = (uint16_t)(range / 2);
+
+  // Rounded-up reciprocals: exact against the division for ranges up to 8 bits
+  op->scale_lo = ((127u << 16) + op->mid - 1) / op->mid;
+  op->scale_hi = ((127u << 16) + (op->range - op->mid) - 1) / (op->range - op->mid);
+}
+
+// Buttons: consecutive bits with consecutive usages merge into one op
+static void add_button_op(compile_ctx_t* ctx, const HID_ReportItem_t* item, uint8_t button)
+{
+  hid_extract_plan_t* plan = ctx->plan;
+  uint8_t bit_size = item->Attributes.BitSize;
+  if (bit_size != 1) return;
+
+  if (plan->op_count > 0) {
+    hid_extract_op_t* last = &plan->ops[plan->op_count - 1];
+    if (last->field == HID_FIELD_BUTTONS &&
+        ctx->op_report_ids[plan->op_count - 1] == item->ReportID &&
+        last->bit_offset + last->bit_size == item->BitOffset &&
+        last->shift + last->bit_size == button &&
+        last->bit_size < HID_EXTRACT_MAX_FIELD_BITS) {
+      last->bit_size++;
+      return;
+    }
+  }
+
+  hid_extract_op_t* op = new_op(ctx, item->ReportID);
+  if (!op) return;
+
+  op->bit_offset = item->BitOffset;
+  op->bit_size = 1;
+  op->field = HID_FIELD_BUTTONS;
+  op->shift = button;
+}
+
+// Stable sort ops by report ID and build the per-report index
+static void build_report_index(compile_ctx_t* ctx)
+{
+  hid_extract_plan_t* plan = ctx->plan;
+  uint8_t* op_report_ids = ctx->op_report_ids;
+  for (uint8_t i = 1; i < plan->op_count; i++) {
+    hid_extract_op_t op = plan->ops[i];
+    uint8_t id = op_report_ids[i];
+    int8_t j = i - 1;
+    while (j >= 0 && op_report_ids[j] > id) {
+      plan->ops[j + 1] = plan->ops[j];
+      op_report_ids[j + 1] = op_report_ids[j];
+      j--;
+    }
+    plan->ops[j + 1] = op;
+    op_report_ids[j + 1] = id;
+  }
+
+  plan->report_count = 0;
+  for (uint8_t i = 0; i < plan->op_count; i++) {
+    hid_extract_report_t* rep = plan->report_count ? &plan->reports[plan->report_count - 1] : NULL;
+
+    if (!rep || rep->report_id != op_report_ids[i]) {
+      if (plan->report_count >= HID_EXTRACT_MAX_REPORTS) {
+        TU_LOG1("HID extract: report ID limit reached, ignoring ID %d\r\n", op_report_ids[i]);
+        plan->op_count = i;
+        break;
+      }
+      rep = &plan->reports[plan->report_count++];
+      rep->report_id = op_report_ids[i];
+      rep->first_op = i;
+      rep->op_count = 0;
+      rep->min_len = 0;
+    }
+
+    const hid_extract_op_t* op = &plan->ops[i];
+    uint16_t end = (uint16_t)((op->bit_offset + op->bit_size + 7u) / 8u);
+    if (end > rep->min_len) {
+      rep->min_len = end;
+    }
+    rep->op_count++;
+  }
+}
+
+void hid_extract_compile(const HID_ReportInfo_t* info, hid_extract_plan_t* plan)
+{
+  memset(plan, 0, sizeof(*plan));
+  if (!info) return;
+
+  compile_ctx_t ctx = { .plan = plan };
+
+  plan->using_report_ids = info->UsingReportIDs;
+
+  for (const HID_ReportItem_t* item = info->FirstReportItem; item; item = item->Next) {
+    // Type follows the last item seen (mouse/keyboard usages mark non-gamepads)
+    plan->type = HID_GAMEPAD;
+
+    switch (item->Attributes.Usage.Page)
+    {
+      case HID_USAGE_PAGE_DESKTOP:
+        switch (item->Attributes.Usage.Usage)
+        {
+          case HID_USAGE_DESKTOP_WHEEL:
+          case HID_USAGE_DESKTOP_MOUSE:
+            plan->type = HID_MOUSE;
+            break;
+          case HID_USAGE_DESKTOP_KEYBOARD:
+            plan->type = HID_KEYBOARD;
+            break;
+          case HID_USAGE_DESKTOP_X:  add_value_op(&ctx, item, HID_FIELD_X);  break;
+          case HID_USAGE_DESKTOP_Y:  add_value_op(&ctx, item, HID_FIELD_Y);  break;
+          case HID_USAGE_DESKTOP_Z:  add_value_op(&ctx, item, HID_FIELD_Z);  break;
+          case HID_USAGE_DESKTOP_RZ: add_value_op(&ctx, item, HID_FIELD_RZ); break;
+          case HID_USAGE_DESKTOP_RX: add_value_op(&ctx, item, HID_FIELD_RX); break;
+          case HID_USAGE_DESKTOP_RY: add_value_op(&ctx, item, HID_FIELD_RY); break;
+          case HID_USAGE_DESKTOP_HAT_SWITCH:
+            add_value_op(&ctx, item, HID_FIELD_HAT);
+            break;
+          default:
+            break;
+        }
+        break;
+
+      case HID_USAGE_PAGE_BUTTON:
+      {
+        uint16_t usage = item->Attributes.Usage.Usage;
+        if (usage >= 1 && usage <= MAX_BUTTONS) {
+          add_button_op(&ctx, item, (uint8_t)(usage - 1));
+        }
+        if (plan->button_count < 255) plan->button_count++;
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  build_report_index(&ctx);
+
+  TU_LOG1("HID extract: %d ops, %d report(s)%s\r\n", plan->op_count, plan->report_count,
+          plan->using_report_ids ? " with IDs" : "");
+}
+
+// Called from the parser: keep only input items the plan can use
+bool CALLBACK_HIDParser_FilterHIDReportItem(uint8_t dev_addr, uint8_t instance, HID_ReportItem_t *const CurrentItem)
+{
+  if (CurrentItem->ItemType != HID_REPORT_ITEM_In)
+    return false;
+
+  TU_LOG1("ITEM_PAGE: 0x%x", CurrentItem->Attributes.Usage.Page);
+  TU_LOG1(" USAGE: 0x%x\n", CurrentItem->Attributes.Usage.Usage);
+  switch (CurrentItem->Attributes.Usage.Page)
+  {
+    case HID_USAGE_PAGE_DESKTOP:
+      switch (CurrentItem->Attributes.Usage.Usage)
+      {
+        case HID_USAGE_DESKTOP_X:
+        case HID_USAGE_DESKTOP_Y:
+        case HID_USAGE_DESKTOP_Z:
+        case HID_USAGE_DESKTOP_RZ:
+        case HID_USAGE_DESKTOP_RX:
+        case HID_USAGE_DESKTOP_RY:
+        case HID_USAGE_DESKTOP_HAT_SWITCH:
+        case HID_USAGE_DESKTOP_DPAD_UP:
+        case HID_USAGE_DESKTOP_DPAD_DOWN:
+        case HID_USAGE_DESKTOP_DPAD_LEFT:
+        case HID_USAGE_DESKTOP_DPAD_RIGHT:
+        case HID_USAGE_DESKTOP_WHEEL:
+        case HID_USAGE_DESKTOP_MOUSE:
+        case HID_USAGE_DESKTOP_KEYBOARD:
+          return true;
+      }
+      return false;
+    case HID_USAGE_PAGE_BUTTON:
+      return true;
+  }
+  return false;
+}
+
+// ============================================================================
+// PLAN EXECUTION
+// ============================================================================
+
+void hid_extract_reset_state(hid_extract_state_t* state)
+{
+  state->axis[HID_FIELD_X] = 128;
+  state->axis[HID_FIELD_Y] = 128;
+  state->axis[HID_FIELD_Z] = 128;
+  state->axis[HID_FIELD_RZ] = 128;
+  state->axis[HID_FIELD_RX] = 0;
+  state->axis[HID_FIELD_RY] = 0;
+  state->hat = 8;
+  state->buttons = 0;
+}
+
+// 0..range -> 1..255 with the midpoint at 128
+static inline uint8_t scale_axis(const hid_extract_op_t* op, uint32_t value)
+{
+  if (value > op->range) value = op->range;
+  if (value <= op->mid) {
+    return (uint8_t)(1 + ((value * op->scale_lo) >> 16));
+  }
+  return (uint8_t)(128 + (((value - op->mid) * op->scale_hi) >> 16));
+}
+
+bool __not_in_flash_func(hid_extract_run)(const hid_extract_plan_t* plan, const uint8_t* report,
+                                          uint16_t len, hid_extract_state_t* state)
+{
+  uint8_t report_id = 0;
+  if (plan->using_report_ids) {
+    if (len == 0) return false;
+    report_id = report[0];
+    report++;
+    len--;
+  }
+
+  const hid_extract_report_t* rep = NULL;
+  for (uint8_t i = 0; i < plan->report_count; i++) {
+    if (plan->reports[i].report_id == report_id) {
+      rep = &plan->reports[i];
+      break;
+    }
+  }
+  if (!rep || len < rep->min_len) return false;
+
+  const hid_extract_op_t* op = &plan->ops[rep->first_op];
+  const hid_extract_op_t* end = op + rep->op_count;
+
+  for (; op < end; op++) {
+    const uint8_t* p = &report[op->bit_offset >> 3];
+    uint32_t shift = op->bit_offset & 7;
+    uint32_t mask = (1u << op->bit_size) - 1;
+
+    // At most 3 bytes: 16-bit field starting at bit 7
+    uint32_t raw = p[0];
+    if (shift + op->bit_size > 8)  raw |= (uint32_t)p[1] << 8;
+    if (shift + op->bit_size > 16) raw |= (uint32_t)p[2] << 16;
+    raw = (raw >> shift) & mask;
+
+    // Subtracting the logical minimum modulo the field width handles signed fields
+    uint32_t value = (raw - op->bias) & mask;
+
+    switch (op->field)
+    {
+      case HID_FIELD_BUTTONS:
+        state->buttons = (uint16_t)((state->buttons & ~(mask << op->shift)) | (raw << op->shift));
+        break;
+      case HID_FIELD_HAT:
+        // Out of range values are the null (released) state
+        state->hat = (value <= 7 && value <= op->range) ? (uint8_t)value : 8;
+        break;
+      default:
+        state->axis[op->field] = scale_axis(op, value);
+        break;
+    }
+  }
+
+  return true;
+}
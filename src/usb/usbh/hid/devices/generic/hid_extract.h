@@ -0,0 +1,85 @@
+// hid_extract.h
+// Compiled extraction plan for generic (DirectInput) HID gamepads
+//
+// The parsed report descriptor (HID_ReportInfo_t) is turned once, at mount,
+// into a short list of extraction ops per report ID:
+//   (bit offset, bit width, logical range -> 0-255 scale, destination)
+// Processing a report is then a single loop over the ops for that report ID.
+#ifndef HID_EXTRACT_H
+#define HID_EXTRACT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hid_parser.h"
+
+#define HID_EXTRACT_MAX_OPS      10  // Axes + hat + button runs per instance
+#define HID_EXTRACT_MAX_REPORTS  4   // Distinct input report IDs per instance
+#define MAX_BUTTONS 12 // max generic HID buttons to map
+
+// Device type detected from descriptor usages
+#define HID_GAMEPAD  0x00
+#define HID_MOUSE    0x01
+#define HID_KEYBOARD 0x02
+
+// Op destinations
+typedef enum {
+  HID_FIELD_X = 0,    // Left analog X
+  HID_FIELD_Y,        // Left analog Y
+  HID_FIELD_Z,        // Right analog X
+  HID_FIELD_RZ,       // Right analog Y
+  HID_FIELD_RX,       // Left analog trigger
+  HID_FIELD_RY,       // Right analog trigger
+  HID_FIELD_AXIS_COUNT,
+  HID_FIELD_HAT = HID_FIELD_AXIS_COUNT,
+  HID_FIELD_BUTTONS,
+} hid_field_t;
+
+typedef struct {
+  uint16_t bit_offset;  // Bit offset in report data (after report ID byte)
+  uint8_t bit_size;     // Field width (1-16)
+  uint8_t field;        // hid_field_t
+  uint8_t shift;        // HID_FIELD_BUTTONS: destination bit of first button
+  uint8_t reserved;
+  uint16_t bias;        // Logical minimum, modulo field width
+  uint16_t range;       // Logical maximum - logical minimum
+  uint16_t mid;         // range / 2
+  uint32_t scale_lo;    // ceil(127 * 2^16 / mid)
+  uint32_t scale_hi;    // ceil(127 * 2^16 / (range - mid))
+} hid_extract_op_t;
+
+typedef struct {
+  uint8_t report_id;    // 0 when the device doesn't use report IDs
+  uint8_t first_op;
+  uint8_t op_count;
+  uint16_t min_len;     // Report data bytes needed by these ops
+} hid_extract_report_t;
+
+typedef struct {
+  hid_extract_op_t ops[HID_EXTRACT_MAX_OPS];
+  hid_extract_report_t reports[HID_EXTRACT_MAX_REPORTS];
+  uint8_t op_count;
+  uint8_t report_count;
+  uint8_t button_count;   // Button usages in descriptor (including unmapped)
+  uint8_t type;           // HID_GAMEPAD, HID_MOUSE or HID_KEYBOARD
+  bool using_report_ids;  // Reports are prefixed with a report ID byte
+} hid_extract_plan_t;
+
+// Decoded gamepad state, updated in place by each report
+typedef struct {
+  uint8_t axis[HID_FIELD_AXIS_COUNT];  // Indexed by hid_field_t (1-255 once reported)
+  uint8_t hat;                          // 0-7 = N..NW, 8 = released
+  uint16_t buttons;                     // Bit n = HID button n+1
+} hid_extract_state_t;
+
+// Build an extraction plan from a parsed report descriptor
+void hid_extract_compile(const HID_ReportInfo_t* info, hid_extract_plan_t* plan);
+
+// Reset state to defaults (sticks centered, triggers and hat released)
+void hid_extract_reset_state(hid_extract_state_t* state);
+
+// Run the plan over an input report (including the report ID byte, if any).
+// Returns false if no ops match the report ID or the report is too short.
+bool hid_extract_run(const hid_extract_plan_t* plan, const uint8_t* report, uint16_t len,
+                     hid_extract_state_t* state);
+
+#endif // HID_EXTRACT_H
@@ -4,16 +4,18 @@
 
 #include "../../hid_device.h"
 #include "../../hid_utils.h"
+#include "hid_extract.h"
 #include "tusb.h"
 
 #define INVALID_REPORT_ID -1 // means 1/X of half range of analog would be dead zone
 #define DEAD_ZONE 4U
-#define MAX_BUTTONS 12 // max generic HID buttons to map
 #define HID_DEBUG 1
 
-#define HID_GAMEPAD  0x00
-#define HID_MOUSE    0x01
-#define HID_KEYBOARD 0x02
+// Size of the static parser arena shared by all mounts; descriptors that
+// need more are rejected (only filtered input items are stored)
+#ifndef HID_PARSER_ARENA_MAX
+#define HID_PARSER_ARENA_MAX 4096
+#endif
 
 typedef union
 {
@@ -37,7 +37,7 @@ static uint8_t const keycode2ascii[128][2] =  { HID_KEYCODE_TO_ASCII };
 
 void calculate_coordinates(uint32_t stick_keys, int intensity, uint8_t *x_value, uint8_t *y_value) {
   uint16_t angle_degrees = 0;
-  uint8_t offset = (127.0 - ((intensity/100.0) * 127.0));
+  uint8_t offset = (uint8_t)((127 * (100 - intensity)) / 100);
 
   if (stick_keys && intensity) {
     if (stick_keys <= 0x000f) {
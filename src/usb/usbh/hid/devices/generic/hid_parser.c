@@ -27,75 +27,66 @@
 #include "hid_parser.h"
 #include <string.h>
 #include <stdbool.h>
-#include <assert.h>
-
-#ifdef DYNAMIC
-#include <malloc.h>
-#define ACQUIRE_AND_RELEASE(structure, size) \
-__attribute__ ((always_inline)) static inline structure##_t* acquire_##structure() { return malloc(sizeof(structure##_t)); } \
-__attribute__ ((always_inline)) static inline void release_##structure(structure##_t* pointer) { free(pointer); }
-#else
-#define ACQUIRE_AND_RELEASE(structure, size) \
-enum { MAX_##structure =  size }; \
-static structure##_t structure##s[MAX_##structure]; \
-static bool structure##sAcquired[MAX_##structure]; \
-static structure##_t* acquire_##structure() \
-{\
-	for(uint8_t i=0; i < MAX_##structure; i++) \
-	{\
-	if(!structure##sAcquired[i])\
-		{\
-			structure##sAcquired[i] = true;\
-			return &structure##s[i];\
-		}\
-	}\
-	assert(false);\
-	return NULL;\
-}\
-static void release_##structure(structure##_t* pointer)\
-{\
-	structure##sAcquired[pointer - structure##s] = false;\
-}
-#endif
 
-ACQUIRE_AND_RELEASE(HID_ReportSizeInfo, 100);
-ACQUIRE_AND_RELEASE(HID_CollectionPath, 25);
-ACQUIRE_AND_RELEASE(HID_ReportInfo, 1);
-ACQUIRE_AND_RELEASE(HID_ReportItem, 50);
+/* Bump allocator over a caller-provided buffer. With a NULL buffer it only
+ * measures, so USB_GetHIDReportInfoSize() can size the real parse exactly. */
+typedef struct
+{
+	uint8_t *Buffer;
+	uint32_t Size;
+	uint32_t Used;
+} HID_Arena_t;
+
+static void *HID_ArenaAlloc(HID_Arena_t *Arena, uint32_t Size)
+{
+	uint32_t Offset = (Arena->Used + (HID_ARENA_ALIGN - 1)) & ~(uint32_t)(HID_ARENA_ALIGN - 1);
+
+	if (Offset + Size > Arena->Size)
+		return NULL;
 
-void USB_FreeReportInfo(HID_ReportInfo_t *ReportInfo)
+	Arena->Used = Offset + Size;
+	return Arena->Buffer ? &Arena->Buffer[Offset] : (void *)Arena;
+}
+
+// Sign-extend short item data to 32 bits (returned as two's complement)
+static uint32_t HID_SignExtendItemData(uint8_t HIDReportItem, uint32_t ReportItemData)
 {
-	if (ReportInfo)
+	switch (HIDReportItem & HID_RI_DATA_SIZE_MASK)
 	{
-		HID_ReportItem_t *item = ReportInfo->FirstReportItem;
-		while (item)
-		{
-			HID_ReportItem_t *current = item;
-			item = item->Next;
-			release_HID_ReportItem(current);
-		}
-		release_HID_ReportInfo(ReportInfo);
+		case HID_RI_DATA_BITS_8:
+			return (uint32_t)(int32_t)(int8_t)ReportItemData;
+		case HID_RI_DATA_BITS_16:
+			return (uint32_t)(int32_t)(int16_t)ReportItemData;
+		default:
+			return ReportItemData;
 	}
 }
 
-uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
-							 uint8_t instance,
-							 const uint8_t *ReportData,
-							 uint16_t ReportSize,
-							 HID_ReportInfo_t **ParserDataOut)
+static uint8_t HID_Parse(uint8_t dev_addr,
+						 uint8_t instance,
+						 const uint8_t *ReportData,
+						 uint16_t ReportSize,
+						 HID_Arena_t *Arena,
+						 HID_ReportInfo_t **ParserDataOut)
 {
-	HID_ReportSizeInfo_t *FirstReportIDSize = acquire_HID_ReportSizeInfo();
-	HID_CollectionPath_t *FirstCollectionPath = acquire_HID_CollectionPath();
-	memset(FirstCollectionPath, 0, sizeof(HID_CollectionPath_t));
-	HID_ReportInfo_t *ParserData = acquire_HID_ReportInfo();
+	bool Measuring = (Arena->Buffer == NULL);
+	HID_ReportInfo_t MeasureData;
+	HID_ReportInfo_t *ParserData = HID_ArenaAlloc(Arena, sizeof(HID_ReportInfo_t));
 	HID_StateTable_t StateTable[HID_STATETABLE_STACK_DEPTH];
 	HID_StateTable_t *CurrStateTable = &StateTable[0];
-	HID_CollectionPath_t *CurrCollectionPath = NULL;
-	HID_ReportSizeInfo_t *CurrReportIDInfo = FirstReportIDSize;
+	HID_ReportSizeInfo_t ReportIDSizes[HID_MAX_REPORT_IDS];
+	uint8_t ReportIDCount = 1;
+	HID_ReportSizeInfo_t *CurrReportIDInfo = &ReportIDSizes[0];
+	uint8_t CollectionDepth = 0;
 	uint16_t UsageList[HID_USAGE_STACK_DEPTH];
 	uint8_t UsageListSize = 0;
 	HID_MinMax_t UsageMinMax = {0, 0};
 
+	if (ParserData == NULL)
+		return HID_PARSE_InsufficientArena;
+	if (Measuring)
+		ParserData = &MeasureData;
+
 	memset(ParserData, 0x00, sizeof(HID_ReportInfo_t));
 	memset(CurrStateTable, 0x00, sizeof(HID_StateTable_t));
 	memset(CurrReportIDInfo, 0x00, sizeof(HID_ReportSizeInfo_t));
@@ -111,25 +102,27 @@ uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
 		ReportData++;
 		ReportSize--;
 
+		static const uint8_t ItemDataBytes[] = {0, 1, 2, 4};
+		uint8_t DataBytes = ItemDataBytes[HIDReportItem & HID_RI_DATA_SIZE_MASK];
+		if (DataBytes > ReportSize)
+		{
+			Result = HID_PARSE_UnexpectedEndOfDescriptor;
+			break;
+		}
+
 		switch (HIDReportItem & HID_RI_DATA_SIZE_MASK)
 		{
 			case HID_RI_DATA_BITS_32:
 				ReportItemData = (((uint32_t)ReportData[3] << 24) | ((uint32_t)ReportData[2] << 16) |
 								((uint16_t)ReportData[1] << 8) | ReportData[0]);
-				ReportSize -= 4;
-				ReportData += 4;
 				break;
 
 			case HID_RI_DATA_BITS_16:
 				ReportItemData = (((uint16_t)ReportData[1] << 8) | (ReportData[0]));
-				ReportSize -= 2;
-				ReportData += 2;
 				break;
 
 			case HID_RI_DATA_BITS_8:
 				ReportItemData = ReportData[0];
-				ReportSize -= 1;
-				ReportData += 1;
 				break;
 
 			default:
@@ -137,6 +130,9 @@ uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
 				break;
 		}
 
+		ReportSize -= DataBytes;
+		ReportData += DataBytes;
+
 		switch (HIDReportItem & (HID_RI_TYPE_MASK | HID_RI_TAG_MASK))
 		{
 			case HID_RI_PUSH(0):
@@ -162,17 +158,22 @@ uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
 
 				CurrStateTable--;
 				break;
-
 			case HID_RI_USAGE_PAGE(0):
 				CurrStateTable->Attributes.Usage.Page = ReportItemData;
 				break;
 
 			case HID_RI_LOGICAL_MINIMUM(0):
-				CurrStateTable->Attributes.Logical.Minimum = ReportItemData;
+				// Logical minimum is signed per the HID spec
+				CurrStateTable->Attributes.Logical.Minimum = HID_SignExtendItemData(HIDReportItem, ReportItemData);
 				break;
 
 			case HID_RI_LOGICAL_MAXIMUM(0):
-				CurrStateTable->Attributes.Logical.Maximum = ReportItemData;
+				// Signed only when the minimum is negative; many devices encode
+				// 0..255 as a single 0xFF byte
+				if ((int32_t)CurrStateTable->Attributes.Logical.Minimum < 0)
+					CurrStateTable->Attributes.Logical.Maximum = HID_SignExtendItemData(HIDReportItem, ReportItemData);
+				else
+					CurrStateTable->Attributes.Logical.Maximum = ReportItemData;
 				break;
 
 			case HID_RI_PHYSICAL_MINIMUM(0):
@@ -205,23 +206,24 @@ uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
 				if (ParserData->UsingReportIDs)
 				{
 					CurrReportIDInfo = NULL;
-					HID_ReportSizeInfo_t *iterator = FirstReportIDSize;
-					while (true)
+					for (uint8_t i = 0; i < ReportIDCount; i++)
 					{
-						if (iterator->ReportID == CurrStateTable->ReportID)
+						if (ReportIDSizes[i].ReportID == CurrStateTable->ReportID)
 						{
-							CurrReportIDInfo = iterator;
+							CurrReportIDInfo = &ReportIDSizes[i];
 							break;
 						}
-						if (!iterator->Next)
-							break;
-						iterator = iterator->Next;
 					}
 
 					if (CurrReportIDInfo == NULL)
 					{
+						if (ReportIDCount == HID_MAX_REPORT_IDS)
+						{
+							Result = HID_PARSE_InsufficientReportIDItems;
+							break;
+						}
 						ParserData->TotalDeviceReports++;
-						iterator->Next = CurrReportIDInfo = acquire_HID_ReportSizeInfo();
+						CurrReportIDInfo = &ReportIDSizes[ReportIDCount++];
 						memset(CurrReportIDInfo, 0x00, sizeof(HID_ReportSizeInfo_t));
 					}
 				}
@@ -253,57 +255,16 @@ uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
 				break;
 
 			case HID_RI_COLLECTION(0):
-				if (CurrCollectionPath == NULL)
-				{
-					CurrCollectionPath = FirstCollectionPath;
-				}
-				else
-				{
-					HID_CollectionPath_t *ParentCollectionPath = CurrCollectionPath;
-
-					CurrCollectionPath = FirstCollectionPath;
-					while (CurrCollectionPath->Next)
-					{
-						CurrCollectionPath = CurrCollectionPath->Next;
-					}
-					HID_CollectionPath_t *NewCollectionPath = acquire_HID_CollectionPath();
-					CurrCollectionPath->Next = NewCollectionPath;
-					CurrCollectionPath = NewCollectionPath;
-					memset(CurrCollectionPath, 0, sizeof(HID_CollectionPath_t));
-					CurrCollectionPath->Parent = ParentCollectionPath;
-				}
-
-				CurrCollectionPath->Type = ReportItemData;
-				CurrCollectionPath->Usage.Page = CurrStateTable->Attributes.Usage.Page;
-
-				if (UsageListSize)
-				{
-					CurrCollectionPath->Usage.Usage = UsageList[0];
-
-					for (uint8_t i = 1; i < UsageListSize; i++)
-						UsageList[i - 1] = UsageList[i];
-
-					UsageListSize--;
-				}
-				else if (UsageMinMax.Minimum <= UsageMinMax.Maximum)
-				{
-					CurrCollectionPath->Usage.Usage = UsageMinMax.Minimum++;
-				}
-
+				CollectionDepth++;
 				break;
 
 			case HID_RI_END_COLLECTION(0):
-				if (CurrCollectionPath == NULL)
+				if (CollectionDepth == 0)
 				{
 					Result = HID_PARSE_UnexpectedEndCollection;
 					break;
 				}
-				CurrCollectionPath = CurrCollectionPath->Parent;
-				if (CurrCollectionPath)
-				{
-					release_HID_CollectionPath(CurrCollectionPath->Next);
-					CurrCollectionPath->Next = NULL;
-				}
+				CollectionDepth--;
 				break;
 
 			case HID_RI_INPUT(0):
@@ -351,19 +312,24 @@ uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
 
 					if (!(ReportItemData & HID_IOF_CONSTANT) && CALLBACK_HIDParser_FilterHIDReportItem(dev_addr, instance, &NewReportItem))
 					{
-						if (!ParserData->FirstReportItem)
-						{
-							ParserData->FirstReportItem = acquire_HID_ReportItem();
-							ParserData->LastReportItem = ParserData->FirstReportItem;
-						}
-						else
+						HID_ReportItem_t *StoredItem = HID_ArenaAlloc(Arena, sizeof(HID_ReportItem_t));
+						if (StoredItem == NULL)
 						{
-							ParserData->LastReportItem->Next = acquire_HID_ReportItem();
-							ParserData->LastReportItem = ParserData->LastReportItem->Next;
+							Result = HID_PARSE_InsufficientArena;
+							break;
 						}
-						memcpy(ParserData->LastReportItem, &NewReportItem, sizeof(HID_ReportItem_t));
-						ParserData->LastReportItem->Next = NULL;
+
 						ParserData->TotalReportItems++;
+						if (Measuring)
+							continue;
+
+						memcpy(StoredItem, &NewReportItem, sizeof(HID_ReportItem_t));
+						StoredItem->Next = NULL;
+						if (!ParserData->FirstReportItem)
+							ParserData->FirstReportItem = StoredItem;
+						else
+							ParserData->LastReportItem->Next = StoredItem;
+						ParserData->LastReportItem = StoredItem;
 					}
 				}
 				break;
@@ -386,33 +352,40 @@ uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
 
 	if (!(ParserData->TotalReportItems))
 		Result = HID_PARSE_NoUnfilteredReportItems;
-	if (Result != HID_PARSE_Successful)
-	{
-		USB_FreeReportInfo(ParserData);
-	}
-	else
-	{
+	if (Result == HID_PARSE_Successful && !Measuring)
 		*ParserDataOut = ParserData;
-	}
 
-	HID_ReportSizeInfo_t *iteratorReportIDSizes = FirstReportIDSize;
-	while (iteratorReportIDSizes)
-	{
-		HID_ReportSizeInfo_t *temp = iteratorReportIDSizes->Next;
-		release_HID_ReportSizeInfo(iteratorReportIDSizes);
-		iteratorReportIDSizes = temp;
-	}
-
-	HID_CollectionPath_t *iteratorCollectionPaths = FirstCollectionPath;
-	while (iteratorCollectionPaths)
-	{
-		HID_CollectionPath_t *temp = iteratorCollectionPaths->Next;
-		release_HID_CollectionPath(iteratorCollectionPaths);
-		iteratorCollectionPaths = temp;
-	}
 	return Result;
 }
 
+uint32_t USB_GetHIDReportInfoSize(uint8_t dev_addr,
+								  uint8_t instance,
+								  const uint8_t *ReportData,
+								  uint16_t ReportSize)
+{
+	HID_Arena_t Arena = {NULL, UINT32_MAX, 0};
+
+	if (HID_Parse(dev_addr, instance, ReportData, ReportSize, &Arena, NULL) != HID_PARSE_Successful)
+		return 0;
+
+	return Arena.Used;
+}
+
+uint8_t USB_ProcessHIDReport(uint8_t dev_addr,
+							 uint8_t instance,
+							 const uint8_t *ReportData,
+							 uint16_t ReportSize,
+							 void *ArenaBuffer,
+							 uint32_t ArenaSize,
+							 HID_ReportInfo_t **ParserData)
+{
+	HID_Arena_t Arena = {ArenaBuffer, ArenaSize, 0};
+
+	if (ArenaBuffer == NULL)
+		return HID_PARSE_InsufficientArena;
+
+	return HID_Parse(dev_addr, instance, ReportData, ReportSize, &Arena, ParserData);
+}
 bool USB_GetHIDReportItemInfo(uint16_t report_id, const uint8_t *ReportData,
 							  HID_ReportItem_t *const ReportItem)
 {
@@ -93,6 +93,19 @@ extern "C"
 #define HID_USAGE_STACK_DEPTH 16
 #endif
 
+#if !defined(HID_MAX_REPORT_IDS) || defined(__DOXYGEN__)
+/** Constant indicating the maximum number of unique report IDs that can be processed in the report item
+ *  descriptor. Report ID offsets are tracked on the parser's stack, so a larger value costs stack space
+ *  only while parsing. Descriptors with more report IDs fail with \ref HID_PARSE_InsufficientReportIDItems.
+ */
+#define HID_MAX_REPORT_IDS 16
+#endif
+
+#if !defined(HID_ARENA_ALIGN) || defined(__DOXYGEN__)
+/** Alignment in bytes of every allocation the parser makes from the caller's arena buffer. */
+#define HID_ARENA_ALIGN 4
+#endif
+
 /** Returns the value a given HID report item (once its value has been fetched via \ref USB_GetHIDReportItemInfo())
  *  left-aligned to the given data type. This allows for signed data to be interpreted correctly, by shifting the data
  *  leftwards until the data's sign bit is in the correct position.
@@ -163,6 +176,9 @@ extern "C"
 		HID_PARSE_UnexpectedEndCollection = 3,	   /**< An END COLLECTION item found without matching COLLECTION item. */
 		HID_PARSE_UsageListOverflow = 4,		   /**< More than \ref HID_USAGE_STACK_DEPTH usages listed in a row. */
 		HID_PARSE_NoUnfilteredReportItems = 5,	   /**< All report items from the device were filtered by the filtering callback routine. */
+		HID_PARSE_InsufficientReportIDItems = 6,   /**< More than \ref HID_MAX_REPORT_IDS report IDs in the device. */
+		HID_PARSE_InsufficientArena = 7,		   /**< The arena passed to \ref USB_ProcessHIDReport() is too small. */
+		HID_PARSE_UnexpectedEndOfDescriptor = 8,   /**< The descriptor ends in the middle of an item's data. */
 	};
 
 	/* Private Interface - For use in library only: */
@@ -274,19 +290,6 @@ extern "C"
 		uint16_t Usage; /**< Usage of the report item. */
 	} HID_Usage_t;
 
-	/** \brief HID Parser Report Item Collection Path Structure.
-	 *
-	 *  Type define for a COLLECTION object. Contains the collection attributes and a reference to the
-	 *  parent collection if any.
-	 */
-	typedef struct HID_CollectionPath
-	{
-		uint8_t Type;					   /**< Collection type (e.g. "Generic Desktop"). */
-		HID_Usage_t Usage;				   /**< Collection usage. */
-		struct HID_CollectionPath *Parent; /**< Reference to parent collection, or \c NULL if root collection. */
-		struct HID_CollectionPath *Next; /**< Reference to parent collection, or \c NULL if root collection. */
-	} HID_CollectionPath_t;
-
 	/** \brief HID Parser Report Item Attributes Structure.
 	 *
 	 *  Type define for all the data attributes of a report item, except flags.
@@ -329,7 +332,6 @@ extern "C"
 		uint16_t ReportSizeBits[3]; /**< Total number of bits in each report type for the given Report ID,
 									 *   indexed by the \ref HID_ReportItemTypes_t enum.
 									 */
-		struct HID_ReportSizeInfo_s* Next;
 	} HID_ReportSizeInfo_t;
 
 	/** \brief HID Parser State Structure.
@@ -339,7 +341,7 @@ extern "C"
 	
 	typedef struct 
 	{
-		uint8_t TotalReportItems;								   /**< Total number of report items stored in the \c ReportItems array. */
+		uint16_t TotalReportItems;								   /**< Total number of report items stored in the \c ReportItems array. */
 		HID_ReportItem_t* FirstReportItem;		   /**< Report items array, including all IN, OUT
 																	*   and FEATURE items.
 																	*/
@@ -352,12 +354,31 @@ extern "C"
 	} HID_ReportInfo_t;
 
 	/* Function Prototypes: */
-	/** Function to process a given HID report returned from an attached device, and store it into a given
-	 *  \ref HID_ReportInfo_t structure.
+	/** Function to determine the arena size \ref USB_ProcessHIDReport() needs for a given HID report
+	 *  descriptor. The descriptor is parsed (and the filter callback invoked) without storing anything.
 	 *
 	 *  \param[in]  ReportData  Buffer containing the device's HID report table.
 	 *  \param[in]  ReportSize  Size in bytes of the HID report table.
-	 *  \param[out] ParserData  Pointer to a \ref HID_ReportInfo_t instance for the parser output.
+	 *
+	 *  \return Required arena size in bytes, or 0 if the descriptor cannot be parsed.
+	 */
+	uint32_t USB_GetHIDReportInfoSize(uint8_t dev_addr,
+									  uint8_t instance,
+									  const uint8_t *ReportData,
+									  uint16_t ReportSize);
+
+	/** Function to process a given HID report returned from an attached device, and store it into a given
+	 *  \ref HID_ReportInfo_t structure.
+	 *
+	 *  All parser output (the \ref HID_ReportInfo_t and its report items) is allocated from the caller's
+	 *  arena buffer; the parser keeps no state between calls. The result stays valid until the caller
+	 *  reuses or frees the arena.
+	 *
+	 *  \param[in]  ReportData   Buffer containing the device's HID report table.
+	 *  \param[in]  ReportSize   Size in bytes of the HID report table.
+	 *  \param[in]  ArenaBuffer  Buffer for the parser output (see \ref USB_GetHIDReportInfoSize()).
+	 *  \param[in]  ArenaSize    Size in bytes of \c ArenaBuffer.
+	 *  \param[out] ParserData   Pointer to a \ref HID_ReportInfo_t instance for the parser output.
 	 *
 	 *  \return A value in the \ref HID_Parse_ErrorCodes_t enum.
 	 */
@@ -365,10 +386,10 @@ extern "C"
 								 uint8_t instance,
 								 const uint8_t *ReportData,
 								 uint16_t ReportSize,
+								 void *ArenaBuffer,
+								 uint32_t ArenaSize,
 								 HID_ReportInfo_t **ParserData);
 
-	void USB_FreeReportInfo(HID_ReportInfo_t *ReportInfo);
-
 	/** Extracts the given report item's value out of the given HID report and places it into the Value
 	 *  member of the report item's \ref HID_ReportItem_t structure.
 	 *
@@ -3,6 +3,7 @@
 #include "core/buttons.h"
 #include "core/router/router.h"
 #include "core/input_event.h"
+#include "core/analog.h"
 #include "pico/time.h"
 #include "app_config.h"
 #include <string.h>
@@ -224,10 +225,10 @@ void input_sony_ds4(uint8_t dev_addr, uint8_t instance, uint8_t const* report, u
 
       // adds deadzone
       uint8_t deadzone = 40;
-      if (analog_1x > (128-(deadzone/2)) && analog_1x < (128+(deadzone/2))) analog_1x = 128;
-      if (analog_1y > (128-(deadzone/2)) && analog_1y < (128+(deadzone/2))) analog_1y = 128;
-      if (analog_2x > (128-(deadzone/2)) && analog_2x < (128+(deadzone/2))) analog_2x = 128;
-      if (analog_2y > (128-(deadzone/2)) && analog_2y < (128+(deadzone/2))) analog_2y = 128;
+      analog_1x = analog_deadzone(analog_1x, deadzone/2);
+      analog_1y = analog_deadzone(analog_1y, deadzone/2);
+      analog_2x = analog_deadzone(analog_2x, deadzone/2);
+      analog_2y = analog_deadzone(analog_2y, deadzone/2);
 
       // add to accumulator and post to the state machine
       // if a scan from the host machine is ongoing, wait
@@ -3,6 +3,7 @@
 #include "core/buttons.h"
 #include "core/router/router.h"
 #include "core/input_event.h"
+#include "core/analog.h"
 #include "pico/time.h"
 #include "app_config.h"
 
@@ -221,13 +222,13 @@ void output_sony_ds5(uint8_t dev_addr, uint8_t instance, device_output_config_t*
     uint8_t l2_start_resistance_value = (perc_threshold * 255) / 100;
     uint8_t r2_start_resistance_value = (perc_threshold * 255) / 100;
 
-    uint8_t l2_trigger_start_resistance = (uint8_t)(0x94 * (l2_start_resistance_value / 255.0));
+    uint8_t l2_trigger_start_resistance = analog_scale_by_u8(0x94, l2_start_resistance_value);
     uint8_t l2_trigger_effect_force =
-      (uint8_t)((0xb4 - l2_trigger_start_resistance) * (l2_start_resistance_value / 255.0) + l2_trigger_start_resistance);
+      analog_scale_by_u8(0xb4 - l2_trigger_start_resistance, l2_start_resistance_value) + l2_trigger_start_resistance;
 
-    uint8_t r2_trigger_start_resistance = (uint8_t)(0x94 * (r2_start_resistance_value / 255.0));
+    uint8_t r2_trigger_start_resistance = analog_scale_by_u8(0x94, r2_start_resistance_value);
     uint8_t r2_trigger_effect_force =
-      (uint8_t)((0xb4 - r2_trigger_start_resistance) * (r2_start_resistance_value / 255.0) + r2_trigger_start_resistance);
+      analog_scale_by_u8(0xb4 - r2_trigger_start_resistance, r2_start_resistance_value) + r2_trigger_start_resistance;
 
     // Configure left trigger haptics
     ds5_fb.trigger_l.motor_mode = 0x02; // Resistance mode
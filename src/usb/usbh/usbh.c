@@ -25,7 +25,12 @@ extern void xinput_task(void);
 #if CFG_TUH_BTD
 #include "btd/hci_transport_h2_tinyusb.h"
 #include "bt/transport/bt_transport.h"
+#include "pico/time.h"
 extern const bt_transport_t bt_transport_usb;
+
+// Dongle receive counters are logged at most this often, and only after
+// packets were lost or every buffer of a queue was waiting for BTstack
+#define BTD_STATS_LOG_MS    5000
 #endif
 
 // PIO USB pin definitions (configurable per board)
@@ -99,6 +104,34 @@ void usbh_init(void)
     printf("[usbh] Initialization complete\n");
 }
 
+#if CFG_TUH_BTD
+static void btd_log_stats(void)
+{
+    static uint32_t last_ms;
+    static uint32_t last_drops;
+    static uint32_t last_stalls;
+
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    if (now - last_ms < BTD_STATS_LOG_MS) return;
+    last_ms = now;
+
+    hci_usb_stats_t s;
+    hci_transport_h2_tinyusb_get_stats(&s);
+    uint32_t drops = s.evt_drops + s.acl_drops;
+    uint32_t stalls = s.evt_stalls + s.acl_stalls;
+    if (drops == last_drops && stalls == last_stalls) return;
+    last_drops = drops;
+    last_stalls = stalls;
+
+    printf("[usbh] BT rx evt: %lu pkts %lu drops %lu stalls depth %u/%u, "
+           "acl: %lu pkts %lu drops %lu stalls depth %u/%u\n",
+           (unsigned long)s.evt_packets, (unsigned long)s.evt_drops,
+           (unsigned long)s.evt_stalls, s.evt_depth, s.evt_max_depth,
+           (unsigned long)s.acl_packets, (unsigned long)s.acl_drops,
+           (unsigned long)s.acl_stalls, s.acl_depth, s.acl_max_depth);
+}
+#endif
+
 void usbh_task(void)
 {
     // TinyUSB host polling
@@ -115,6 +148,7 @@ void usbh_task(void)
 #if CFG_TUH_BTD
     hci_transport_h2_tinyusb_process();
     bt_task();
+    btd_log_stats();
 #endif
 }
 